@@ -113,6 +113,63 @@ PyAPI_FUNC(int) _PyCode_CheckLineNumber(PyCodeObject* co,
 PyAPI_FUNC(PyObject*) PyCode_Optimize(PyObject *code, PyObject* consts,
                                       PyObject *names, PyObject *lineno_obj);
 
+/* Stand-in for a code object nested in another one, whose marshalled body
+   (see Python/marshal.c) is only read when a function is made from it.
+   Such stubs are only found in the co_consts of code objects loaded with
+   marshal.loads(data, True); making a function from them and the co_consts
+   attribute replace them with the real code objects (marshal does it when
+   loading any code that uses them otherwise).  Code objects themselves are
+   always complete. */
+typedef struct {
+    PyObject_HEAD
+    int lc_argcount;
+    int lc_kwonlyargcount;
+    int lc_nlocals;
+    int lc_stacksize;
+    int lc_flags;
+    int lc_firstlineno;
+    PyObject *lc_varnames;
+    PyObject *lc_freevars;
+    PyObject *lc_cellvars;
+    PyObject *lc_filename;      /* co_filename of the code object */
+    PyObject *lc_name;
+    /* The fields below are cleared once lc_code is set */
+    PyObject *lc_owner;         /* bytes holding lc_body, or None if static */
+    const char *lc_body;        /* code, consts[1:], names and lnotab */
+    Py_ssize_t lc_size;
+    PyObject *lc_const0;        /* consts[0], or NULL if there are none */
+    PyObject *lc_body_filename; /* co_filename when the body was marshalled */
+    PyObject *lc_code;          /* the code object, once materialized */
+} PyLazyCodeObject;
+
+PyAPI_DATA(PyTypeObject) _PyLazyCode_Type;
+
+#define _PyLazyCode_Check(op) (Py_TYPE(op) == &_PyLazyCode_Type)
+
+/* Create a stub for the marshalled body of size bytes at body, held by the
+   bytes object owner (Py_None if the body is static data). */
+PyAPI_FUNC(PyObject *) _PyLazyCode_New(
+        int, int, int, int, int, PyObject *, PyObject *, PyObject *,
+        PyObject *, PyObject *, int, PyObject *, const char *, Py_ssize_t,
+        PyObject *);
+
+/* Return a new reference to the code object of a stub, unmarshalling its
+   body on the first call.  Any other object is returned unchanged. */
+PyAPI_FUNC(PyObject *) _PyLazyCode_Materialize(PyObject *);
+
+/* Replace the stubs in co->co_consts with their code objects.  Return 0 on
+   success, -1 with an exception set on failure. */
+PyAPI_FUNC(int) _PyCode_MaterializeConsts(PyCodeObject *co);
+
+/* Unmarshal the body of a stub (in Python/marshal.c), leaving the code
+   objects nested in it as stubs too.  Return 0 and new references on
+   success, -1 with an exception set. */
+PyAPI_FUNC(int) _PyMarshal_ReadCodeBody(const char *body, Py_ssize_t size,
+                                        PyObject *const0, PyObject *filename,
+                                        PyObject *owner,
+                                        PyObject **code, PyObject **consts,
+                                        PyObject **names, PyObject **lnotab);
+
 #ifdef __cplusplus
 }
 #endif
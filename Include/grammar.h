@@ -64,6 +64,11 @@ typedef struct {
     labellist	 g_ll;
     int		 g_start;	/* Start symbol of the grammar */
     int		 g_accel;	/* Set if accelerators present */
+
+    /* Label lookup tables, installed with the accelerators */
+    int		*g_tokenlabel;	/* Label of each token type, or -1 */
+    int		 g_nkeywords;
+    int		*g_keywords;	/* Labels of keywords, sorted by name */
 } grammar;
 
 /* FUNCTIONS */
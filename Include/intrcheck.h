@@ -9,6 +9,7 @@ PyAPI_FUNC(int) PyOS_InterruptOccurred(void);
 PyAPI_FUNC(void) PyOS_InitInterrupts(void);
 PyAPI_FUNC(void) PyOS_AfterFork(void);
 PyAPI_FUNC(int) _PyOS_IsMainThread(void);
+PyAPI_FUNC(int) _PyOS_SignalPending(void);
 
 #ifdef MS_WINDOWS
 /* windows.h is not included by Python.h so use void* instead of HANDLE */
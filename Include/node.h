@@ -22,6 +22,20 @@ PyAPI_FUNC(int) PyNode_AddChild(node *n, int type,
 PyAPI_FUNC(void) PyNode_Free(node *n);
 #ifndef Py_LIMITED_API
 PyAPI_FUNC(Py_ssize_t) _PyNode_SizeOf(node *n);
+
+/* A node arena holds the nodes of a parse tree and their strings, which
+   are all freed at once with the arena instead of one by one with
+   PyNode_Free().  The parser builds the trees it hands to the compiler in
+   an arena. */
+typedef struct _node_arena node_arena;
+
+PyAPI_FUNC(node_arena *) _PyNodeArena_New(void);
+PyAPI_FUNC(void) _PyNodeArena_Free(node_arena *);
+PyAPI_FUNC(void *) _PyNodeArena_Malloc(node_arena *, size_t size);
+PyAPI_FUNC(node *) _PyNode_NewInArena(node_arena *, int type);
+PyAPI_FUNC(int) _PyNode_AddChildInArena(node_arena *, node *n, int type,
+                                        char *str, int lineno,
+                                        int col_offset);
 #endif
 
 /* Node access functions */
@@ -96,6 +96,28 @@ PyAPI_FUNC(node *) PyParser_ParseStringObject(
     perrdetail *err_ret,
     int *flags);
 
+/* Variants of the above which build the tree in a node arena, if it is
+   not NULL.  The tree must not be released with PyNode_Free(). */
+PyAPI_FUNC(node *) _PyParser_ParseStringObjectInArena(
+    const char *s,
+    PyObject *filename,
+    grammar *g,
+    int start,
+    perrdetail *err_ret,
+    int *flags,
+    node_arena *arena);
+PyAPI_FUNC(node *) _PyParser_ParseFileObjectInArena(
+    FILE *fp,
+    PyObject *filename,
+    const char *enc,
+    grammar *g,
+    int start,
+    const char *ps1,
+    const char *ps2,
+    perrdetail *err_ret,
+    int *flags,
+    node_arena *arena);
+
 /* Note that the following functions are defined in pythonrun.c,
    not in parsetok.c */
 PyAPI_FUNC(void) PyParser_SetError(perrdetail *);
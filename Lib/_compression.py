@@ -0,0 +1,92 @@
+"""Internal classes used by the gzip, lzma and bz2 modules"""
+
+import collections
+
+
+class ParallelCompressor:
+    """Compressor which compresses blocks of its input on several threads.
+
+    The input is cut into blocks of block_size bytes, which are handed to
+    the compress_block() method in a pool of threads; their outputs are
+    returned in order by compress() and flush(), like the compressor objects
+    of the zlib, bz2 and lzma modules do.  Those modules release the GIL
+    while compressing, so the blocks are really compressed in parallel.
+
+    compress_block() is given the block and the last `history` bytes of the
+    input which precede it, for formats able to use them as a dictionary.
+    """
+
+    def __init__(self, block_size, threads, history=0):
+        from concurrent.futures import ThreadPoolExecutor
+        self._block_size = block_size
+        self._history_size = history
+        self._history = b''
+        self._buffer = b''
+        self._submitted = False
+        self._executor = ThreadPoolExecutor(threads)
+        self._pending = collections.deque()
+        # Bound the memory used by blocks waiting for a thread
+        self._max_pending = 2 * threads
+
+    def compress_block(self, block, history):
+        raise NotImplementedError
+
+    def _submit(self, block):
+        # Wait for the oldest block first if too many are pending, and
+        # return its output
+        out = b''
+        if len(self._pending) >= self._max_pending:
+            out = self._pending.popleft().result()
+        self._submitted = True
+        self._pending.append(self._executor.submit(self.compress_block,
+                                                   block, self._history))
+        if self._history_size:
+            self._history = (self._history + block)[-self._history_size:]
+        return out
+
+    def _collect(self, wait):
+        pending = self._pending
+        out = []
+        while pending and (wait or pending[0].done()):
+            out.append(pending.popleft().result())
+        return b''.join(out)
+
+    def compress(self, data):
+        """Compress data, returning the output of the blocks done so far."""
+        view = memoryview(data).cast('B')
+        size = self._block_size
+        out = []
+        start = 0
+        if self._buffer:
+            # Complete the block left by the previous call first
+            start = min(size - len(self._buffer), len(view))
+            self._buffer += bytes(view[:start])
+            if len(self._buffer) < size:
+                return self._collect(False)
+            out.append(self._submit(self._buffer))
+        end = len(view) - (len(view) - start) % size
+        for start in range(start, end, size):
+            out.append(self._submit(bytes(view[start:start + size])))
+        self._buffer = bytes(view[end:])
+        out.append(self._collect(False))
+        return b''.join(out)
+
+    def flush(self, finish=True):
+        """Compress the buffered input and wait for every block.
+
+        When finish is true the threads are stopped and the compressor
+        cannot be used anymore.
+        """
+        out = b''
+        # An empty input still gives a stream, for formats which need one
+        if self._buffer or (finish and not self._submitted):
+            out = self._submit(self._buffer)
+            self._buffer = b''
+        out += self._collect(True)
+        if finish:
+            self._executor.shutdown()
+        return out
+
+    def reset_history(self):
+        """Do not prime the following blocks with the preceding input."""
+        self._history = b''
@@ -17,7 +17,6 @@ to modify the meaning of the API call itself.
 import collections
 import concurrent.futures
 import heapq
-import inspect
 import logging
 import os
 import socket
@@ -27,6 +26,7 @@ import time
 import traceback
 import sys
 
+from . import constants
 from . import coroutines
 from . import events
 from . import futures
@@ -51,9 +51,11 @@ _MIN_CANCELLED_TIMER_HANDLES_FRACTION = 0.5
 
 def _format_handle(handle):
     cb = handle._callback
-    if inspect.ismethod(cb) and isinstance(cb.__self__, tasks.Task):
+    # the bound method may be implemented in C (_asyncio.Task._step)
+    task = getattr(cb, '__self__', None)
+    if isinstance(task, (tasks.Task, tasks._PyTask)):
         # format the task
-        return repr(cb.__self__)
+        return repr(task)
     else:
         return str(handle)
 
@@ -274,7 +276,7 @@ class BaseEventLoop(events.AbstractEventLoop):
         """
         self._check_closed()
 
-        new_task = not isinstance(future, futures.Future)
+        new_task = not futures.isfuture(future)
         future = tasks.async(future, loop=self)
         if new_task:
             # An exception is raised if the future didn't complete, so there
@@ -637,6 +639,103 @@ class BaseEventLoop(events.AbstractEventLoop):
         yield from waiter
         return transport, protocol
 
+    @coroutine
+    def sendfile(self, transport, file, offset=0, count=None,
+                 *, fallback=True):
+        """Send a file to transport.
+
+        Return the total number of bytes which were sent.
+
+        The method uses high-performance os.sendfile() if available.
+
+        file must be a regular file object opened in binary mode.
+
+        offset tells from where to start reading the file. If specified,
+        count is the total number of bytes to transmit as opposed to
+        sending the file until EOF is reached. File position is updated on
+        return or also in case of error in which case file.tell()
+        can be used to figure out the number of bytes
+        which were sent.
+
+        fallback set to True makes asyncio to manually read and send
+        the file when the platform does not support the sendfile syscall
+        (e.g. Windows or SSL socket on Unix).
+
+        Raise SendfileNotAvailableError if the system does not support
+        sendfile syscall and fallback is False.
+        """
+        if not getattr(transport, '_sendfile_compatible', False):
+            raise RuntimeError(
+                "sendfile is not supported for transport %r" % transport)
+        if transport._closing:
+            raise RuntimeError("Transport is closing")
+        self._check_sendfile_params(file, offset, count)
+        try:
+            return (yield from self._sendfile_native(transport, file,
+                                                     offset, count))
+        except events.SendfileNotAvailableError:
+            if not fallback:
+                raise
+        return (yield from self._sendfile_fallback(transport, file,
+                                                   offset, count))
+
+    def _check_sendfile_params(self, file, offset, count):
+        if 'b' not in getattr(file, 'mode', 'b'):
+            raise ValueError("file should be opened in binary mode")
+        if not isinstance(offset, int):
+            raise TypeError(
+                "offset must be a non-negative integer (got %r)" % offset)
+        if offset < 0:
+            raise ValueError(
+                "offset must be a non-negative integer (got %r)" % offset)
+        if count is not None:
+            if not isinstance(count, int):
+                raise TypeError(
+                    "count must be a positive integer (got %r)" % count)
+            if count <= 0:
+                raise ValueError(
+                    "count must be a positive integer (got %r)" % count)
+
+    @coroutine
+    def _sendfile_native(self, transport, file, offset, count):
+        raise events.SendfileNotAvailableError(
+            "sendfile syscall is not supported")
+
+    @coroutine
+    def _sendfile_fallback(self, transport, file, offset, count):
+        file.seek(offset)
+        blocksize = constants.SENDFILE_FALLBACK_READBUFFER_SIZE
+        if count:
+            blocksize = min(count, blocksize)
+        buf = bytearray(blocksize)
+        total_sent = 0
+        try:
+            while True:
+                if count:
+                    blocksize = min(count - total_sent, blocksize)
+                    if blocksize <= 0:
+                        return total_sent
+                view = memoryview(buf)[:blocksize]
+                read = yield from self.run_in_executor(None, file.readinto,
+                                                       view)
+                if not read:
+                    return total_sent
+                if transport._conn_lost:
+                    raise ConnectionError('Connection is closed')
+                # write() copies what it cannot send immediately
+                transport.write(view[:read])
+                total_sent += read
+                if transport.get_write_buffer_size() > blocksize:
+                    # Flow control: wait until the transport sent the
+                    # data before reading the next chunk.
+                    try:
+                        yield from transport._make_empty_waiter()
+                    finally:
+                        transport._reset_empty_waiter()
+        finally:
+            if total_sent:
+                file.seek(offset + total_sent)
+
     @coroutine
     def create_datagram_endpoint(self, protocol_factory,
                                  local_addr=None, remote_addr=None, *,
@@ -1093,8 +1192,9 @@ class BaseEventLoop(events.AbstractEventLoop):
         # they will be run the next time (after another I/O poll).
         # Use an idiom that is thread-safe without using locks.
         ntodo = len(self._ready)
+        popleft = self._ready.popleft
         for i in range(ntodo):
-            handle = self._ready.popleft()
+            handle = popleft()
             if handle._cancelled:
                 continue
             if self._debug:
@@ -5,3 +5,7 @@ LOG_THRESHOLD_FOR_CONNLOST_WRITES = 5
 
 # Seconds to wait before retrying accept().
 ACCEPT_RETRY_DELAY = 1
+
+# Size of the chunks read from the file when loop.sendfile() cannot use
+# os.sendfile() and falls back to read() + write().
+SENDFILE_FALLBACK_READBUFFER_SIZE = 256 * 1024
@@ -139,7 +139,7 @@ def coroutine(func):
         @functools.wraps(func)
         def coro(*args, **kw):
             res = func(*args, **kw)
-            if isinstance(res, futures.Future) or inspect.isgenerator(res):
+            if futures.isfuture(res) or inspect.isgenerator(res):
                 res = yield from res
             return res
 
@@ -2,7 +2,7 @@
 
 __all__ = ['AbstractEventLoopPolicy',
            'AbstractEventLoop', 'AbstractServer',
-           'Handle', 'TimerHandle',
+           'Handle', 'TimerHandle', 'SendfileNotAvailableError',
            'get_event_loop_policy', 'set_event_loop_policy',
            'get_event_loop', 'set_event_loop', 'new_event_loop',
            'get_child_watcher', 'set_child_watcher',
@@ -21,6 +21,14 @@ import traceback
 _PY34 = sys.version_info >= (3, 4)
 
 
+class SendfileNotAvailableError(RuntimeError):
+    """Sendfile syscall is not available.
+
+    Raised if OS does not support sendfile syscall for given socket or
+    file type.
+    """
+
+
 def _get_function_source(func):
     if _PY34:
         func = inspect.unwrap(func)
@@ -69,6 +77,25 @@ def _format_callback(func, args, suffix=''):
     return func_repr
 
 
+def _handle_repr_info(handle):
+    info = [handle.__class__.__name__]
+    if handle._cancelled:
+        info.append('cancelled')
+    if handle._callback is not None:
+        info.append(_format_callback(handle._callback, handle._args))
+    if handle._source_traceback:
+        frame = handle._source_traceback[-1]
+        info.append('created at %s:%s' % (frame[0], frame[1]))
+    return info
+
+
+def _timer_handle_repr_info(handle):
+    info = _handle_repr_info(handle)
+    pos = 2 if handle._cancelled else 1
+    info.insert(pos, 'when=%s' % handle._when)
+    return info
+
+
 class Handle:
     """Object returned by callback registration methods."""
 
@@ -76,7 +103,8 @@ class Handle:
                  '_source_traceback', '_repr', '__weakref__')
 
     def __init__(self, callback, args, loop):
-        assert not isinstance(callback, Handle), 'A Handle is not a callback'
+        assert not isinstance(callback, (Handle, _PyHandle)), \
+            'A Handle is not a callback'
         self._loop = loop
         self._callback = callback
         self._args = args
@@ -88,15 +116,7 @@ class Handle:
             self._source_traceback = None
 
     def _repr_info(self):
-        info = [self.__class__.__name__]
-        if self._cancelled:
-            info.append('cancelled')
-        if self._callback is not None:
-            info.append(_format_callback(self._callback, self._args))
-        if self._source_traceback:
-            frame = self._source_traceback[-1]
-            info.append('created at %s:%s' % (frame[0], frame[1]))
-        return info
+        return _handle_repr_info(self)
 
     def __repr__(self):
         if self._repr is not None:
@@ -146,10 +166,7 @@ class TimerHandle(Handle):
         self._scheduled = False
 
     def _repr_info(self):
-        info = super()._repr_info()
-        pos = 2 if self._cancelled else 1
-        info.insert(pos, 'when=%s' % self._when)
-        return info
+        return _timer_handle_repr_info(self)
 
     def __hash__(self):
         return hash(self._when)
@@ -171,7 +188,7 @@ class TimerHandle(Handle):
         return self.__eq__(other)
 
     def __eq__(self, other):
-        if isinstance(other, TimerHandle):
+        if isinstance(other, (TimerHandle, _PyTimerHandle)):
             return (self._when == other._when and
                     self._callback == other._callback and
                     self._args == other._args and
@@ -188,6 +205,22 @@ class TimerHandle(Handle):
         super().cancel()
 
 
+# Keep references to the Python implementation: the C accelerator
+# replaces both classes below.
+_PyHandle = Handle
+_PyTimerHandle = TimerHandle
+
+
+try:
+    import _asyncio
+except ImportError:
+    pass
+else:
+    # _CHandle and _CTimerHandle are needed for tests.
+    Handle = _CHandle = _asyncio.Handle
+    TimerHandle = _CTimerHandle = _asyncio.TimerHandle
+
+
 class AbstractServer:
     """Abstract server returned by create_server()."""
 
@@ -355,6 +388,14 @@ class AbstractEventLoop:
                                  family=0, proto=0, flags=0):
         raise NotImplementedError
 
+    def sendfile(self, transport, file, offset=0, count=None,
+                 *, fallback=True):
+        """Send a file through a transport.
+
+        Return an amount of sent bytes.
+        """
+        raise NotImplementedError
+
     # Pipes and subprocesses.
 
     def connect_read_pipe(self, protocol_factory, pipe):
@@ -1,7 +1,7 @@
 """Abstract Protocol class."""
 
-__all__ = ['BaseProtocol', 'Protocol', 'DatagramProtocol',
-           'SubprocessProtocol']
+__all__ = ['BaseProtocol', 'Protocol', 'BufferedProtocol',
+           'DatagramProtocol', 'SubprocessProtocol']
 
 
 class BaseProtocol:
@@ -95,6 +95,51 @@ class Protocol(BaseProtocol):
         """
 
 
+class BufferedProtocol(BaseProtocol):
+    """Interface for stream protocol with manual buffer control.
+
+    Instead of receiving a new bytes object in data_received(), the
+    protocol provides the buffer the transport receives data into, which
+    avoids an allocation and a copy per received chunk.  Transports which
+    do not support it call data_received() instead, so a protocol usually
+    implements both interfaces.
+
+    State machine of calls:
+
+      start -> CM [-> GB [-> BU?]]* [-> ER?] -> CL -> end
+
+    * CM: connection_made()
+    * GB: get_buffer()
+    * BU: buffer_updated()
+    * ER: eof_received()
+    * CL: connection_lost()
+    """
+
+    def get_buffer(self, sizehint):
+        """Called to allocate a new receive buffer.
+
+        sizehint is the recommended minimal size for the returned
+        buffer, or -1 if the transport has no preference.  The method
+        must return an object implementing the writable buffer protocol,
+        it is an error to return a zero-sized buffer.
+        """
+
+    def buffer_updated(self, nbytes):
+        """Called when the buffer was updated with the received data.
+
+        nbytes is the total number of bytes that were written to the
+        buffer returned by the last get_buffer() call.
+        """
+
+    def eof_received(self):
+        """Called when the other end calls write_eof() or equivalent.
+
+        If this returns a false value (including None), the transport
+        will close itself.  If it returns a true value, closing the
+        transport is up to the protocol.
+        """
+
+
 class DatagramProtocol(BaseProtocol):
     """Interface for datagram protocol."""
 
@@ -9,6 +9,8 @@ __all__ = ['BaseSelectorEventLoop']
 import collections
 import errno
 import functools
+import io
+import os
 import socket
 try:
     import ssl
@@ -19,8 +21,10 @@ from . import base_events
 from . import constants
 from . import events
 from . import futures
+from . import protocols
 from . import selectors
 from . import transports
+from .coroutines import coroutine
 from .log import logger
 
 
@@ -422,6 +426,75 @@ class BaseSelectorEventLoop(base_events.BaseEventLoop):
         else:
             fut.set_result((conn, address))
 
+    @coroutine
+    def _sendfile_native(self, transp, file, offset, count):
+        if not hasattr(os, 'sendfile'):
+            raise events.SendfileNotAvailableError(
+                "os.sendfile() is not available")
+        try:
+            fileno = file.fileno()
+        except (AttributeError, io.UnsupportedOperation) as err:
+            raise events.SendfileNotAvailableError("not a regular file")
+        try:
+            fsize = os.fstat(fileno).st_size
+        except OSError:
+            raise events.SendfileNotAvailableError("not a regular file")
+        blocksize = count if count else fsize
+        if not blocksize:
+            return 0  # empty file
+
+        try:
+            # Data written before sendfile() must go out first
+            yield from transp._make_empty_waiter()
+            transp._reset_empty_waiter()
+            return (yield from self._sendfile_native_impl(
+                transp, file, fileno, offset, count, blocksize))
+        finally:
+            transp._reset_empty_waiter()
+
+    @coroutine
+    def _sendfile_native_impl(self, transp, file, fileno, offset, count,
+                              blocksize):
+        # os.sendfile() copies the file to the socket in the kernel.  When
+        # the socket buffer is full, wait until the socket is writable:
+        # the waiter is set on the transport so that losing the connection
+        # wakes us up.
+        blocksize = min(blocksize, 2**30)
+        total_sent = 0
+        try:
+            while True:
+                if count:
+                    blocksize = min(count - total_sent, blocksize)
+                    if blocksize <= 0:
+                        break
+                if transp._conn_lost:
+                    raise ConnectionError('Connection is closed')
+                try:
+                    sent = os.sendfile(transp._sock_fd, fileno, offset,
+                                       blocksize)
+                except (BlockingIOError, InterruptedError):
+                    waiter = transp._make_empty_waiter(writable=True)
+                    try:
+                        yield from waiter
+                    finally:
+                        transp._reset_empty_waiter()
+                    continue
+                except OSError as exc:
+                    if (total_sent == 0 and
+                            exc.errno in (errno.ENOTSOCK, errno.EINVAL)):
+                        # The file or the socket type is not supported
+                        raise events.SendfileNotAvailableError(
+                            "os.sendfile() call failed") from exc
+                    raise
+                if sent == 0:
+                    break  # EOF
+                offset += sent
+                total_sent += sent
+        finally:
+            if total_sent > 0:
+                file.seek(offset)
+        return total_sent
+
     def _process_events(self, event_list):
         for key, mask in event_list:
             fileobj, (reader, writer) = key.fileobj, key.data
@@ -551,11 +624,17 @@ class _SelectorTransport(transports._FlowControlMixin,
 
 class _SelectorSocketTransport(_SelectorTransport):
 
+    _sendfile_compatible = True
+
     def __init__(self, loop, sock, protocol, waiter=None,
                  extra=None, server=None):
         super().__init__(loop, sock, protocol, extra, server)
         self._eof = False
         self._paused = False
+        # Buffered protocols let recv_into() fill their own buffer
+        self._buffered = isinstance(protocol, protocols.BufferedProtocol)
+        self._empty_waiter = None
+        self._empty_waiter_writable = False
 
         self._loop.add_reader(self._sock_fd, self._read_ready)
         self._loop.call_soon(self._protocol.connection_made, self)
@@ -584,6 +663,9 @@ class _SelectorSocketTransport(_SelectorTransport):
             logger.debug("%r resumes reading", self)
 
     def _read_ready(self):
+        if self._buffered:
+            self._read_ready_into()
+            return
         try:
             data = self._sock.recv(self.max_size)
         except (BlockingIOError, InterruptedError):
@@ -594,16 +676,42 @@ class _SelectorSocketTransport(_SelectorTransport):
             if data:
                 self._protocol.data_received(data)
             else:
-                if self._loop.get_debug():
-                    logger.debug("%r received EOF", self)
-                keep_open = self._protocol.eof_received()
-                if keep_open:
-                    # We're keeping the connection open so the
-                    # protocol can write more, but we still can't
-                    # receive more, so remove the reader callback.
-                    self._loop.remove_reader(self._sock_fd)
-                else:
-                    self.close()
+                self._read_eof()
+
+    def _read_ready_into(self):
+        try:
+            buf = self._protocol.get_buffer(-1)
+            if not len(buf):
+                raise RuntimeError('get_buffer() returned an empty buffer')
+        except Exception as exc:
+            self._fatal_error(
+                exc, 'Fatal error: protocol.get_buffer() call failed.')
+            return
+
+        try:
+            nbytes = self._sock.recv_into(buf)
+        except (BlockingIOError, InterruptedError):
+            return
+        except Exception as exc:
+            self._fatal_error(exc, 'Fatal read error on socket transport')
+            return
+
+        if nbytes:
+            self._protocol.buffer_updated(nbytes)
+        else:
+            self._read_eof()
+
+    def _read_eof(self):
+        if self._loop.get_debug():
+            logger.debug("%r received EOF", self)
+        keep_open = self._protocol.eof_received()
+        if keep_open:
+            # We're keeping the connection open so the
+            # protocol can write more, but we still can't
+            # receive more, so remove the reader callback.
+            self._loop.remove_reader(self._sock_fd)
+        else:
+            self.close()
 
     def write(self, data):
         if not isinstance(data, (bytes, bytearray, memoryview)):
@@ -611,6 +719,8 @@ class _SelectorSocketTransport(_SelectorTransport):
                             type(data))
         if self._eof:
             raise RuntimeError('Cannot call write() after write_eof()')
+        if self._empty_waiter is not None:
+            raise RuntimeError('unable to write; sendfile is in progress')
         if not data:
             return
 
@@ -651,12 +761,18 @@ class _SelectorSocketTransport(_SelectorTransport):
             self._loop.remove_writer(self._sock_fd)
             self._buffer.clear()
             self._fatal_error(exc, 'Fatal write error on socket transport')
+            if (self._empty_waiter is not None and
+                    not self._empty_waiter.done()):
+                self._empty_waiter.set_exception(exc)
         else:
             if n:
                 del self._buffer[:n]
             self._maybe_resume_protocol()  # May append to buffer.
             if not self._buffer:
                 self._loop.remove_writer(self._sock_fd)
+                if (self._empty_waiter is not None and
+                        not self._empty_waiter.done()):
+                    self._empty_waiter.set_result(None)
                 if self._closing:
                     self._call_connection_lost(None)
                 elif self._eof:
@@ -669,6 +785,41 @@ class _SelectorSocketTransport(_SelectorTransport):
         if not self._buffer:
             self._sock.shutdown(socket.SHUT_WR)
 
+    def _call_connection_lost(self, exc):
+        super()._call_connection_lost(exc)
+        if self._empty_waiter is not None and not self._empty_waiter.done():
+            self._empty_waiter.set_exception(
+                ConnectionError("Connection is closed by peer"))
+
+    def _make_empty_waiter(self, writable=False):
+        """Return a future done when the write buffer is empty.
+
+        Used by loop.sendfile(): write() is refused until
+        _reset_empty_waiter() is called.  With writable=True, the future is
+        done when the socket becomes writable again.
+        """
+        if self._empty_waiter is not None:
+            raise RuntimeError("Empty waiter is already set")
+        self._empty_waiter = futures.Future(loop=self._loop)
+        self._empty_waiter_writable = writable
+        if writable:
+            self._loop.add_writer(self._sock_fd, self._empty_waiter_ready)
+        elif not self._buffer:
+            self._empty_waiter.set_result(None)
+        return self._empty_waiter
+
+    def _empty_waiter_ready(self):
+        self._loop.remove_writer(self._sock_fd)
+        if self._empty_waiter is not None and not self._empty_waiter.done():
+            self._empty_waiter.set_result(None)
+
+    def _reset_empty_waiter(self):
+        if (self._empty_waiter is not None and self._empty_waiter_writable
+                and not self._empty_waiter.done() and self._sock is not None):
+            # Cancelled while waiting for the socket to become writable
+            self._loop.remove_writer(self._sock_fd)
+        self._empty_waiter = None
+
     def can_write_eof(self):
         return True
 
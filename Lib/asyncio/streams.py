@@ -19,6 +19,8 @@ from .log import logger
 
 
 _DEFAULT_LIMIT = 2**16
+# Size of the buffer StreamReader lends to buffered transports
+_RECV_BUFFER_SIZE = 2**16
 
 
 class IncompleteReadError(EOFError):
@@ -197,13 +199,17 @@ class FlowControlMixin(protocols.Protocol):
         yield from waiter
 
 
-class StreamReaderProtocol(FlowControlMixin, protocols.Protocol):
+class StreamReaderProtocol(FlowControlMixin, protocols.Protocol,
+                           protocols.BufferedProtocol):
     """Helper class to adapt between Protocol and StreamReader.
 
     (This is a helper class instead of making StreamReader itself a
     Protocol subclass, because the StreamReader has other potential
     uses, and to prevent the user of the StreamReader to accidentally
     call inappropriate methods of the protocol.)
+
+    Transports supporting BufferedProtocol receive data directly into a
+    buffer owned by the StreamReader; the others call data_received().
     """
 
     def __init__(self, stream_reader, client_connected_cb=None, loop=None):
@@ -233,6 +239,12 @@ class StreamReaderProtocol(FlowControlMixin, protocols.Protocol):
     def data_received(self, data):
         self._stream_reader.feed_data(data)
 
+    def get_buffer(self, sizehint):
+        return self._stream_reader._get_buffer(sizehint)
+
+    def buffer_updated(self, nbytes):
+        self._stream_reader._buffer_updated(nbytes)
+
     def eof_received(self):
         self._stream_reader.feed_eof()
 
@@ -314,6 +326,8 @@ class StreamReader:
         self._exception = None
         self._transport = None
         self._paused = False
+        # Receive buffer handed out by _get_buffer(), allocated on demand
+        self._recv_buffer = None
 
     def exception(self):
         return self._exception
@@ -355,7 +369,27 @@ class StreamReader:
             return
 
         self._buffer.extend(data)
+        self._data_appended()
+
+    def _get_buffer(self, sizehint):
+        """Return a writable buffer to receive data into.
+
+        The same preallocated buffer is returned on every call; the
+        transport reports how much of it it filled with _buffer_updated().
+        """
+        assert not self._eof, '_get_buffer after feed_eof'
+        if self._recv_buffer is None or len(self._recv_buffer) < sizehint:
+            size = max(sizehint, _RECV_BUFFER_SIZE)
+            self._recv_buffer = memoryview(bytearray(size))
+        return self._recv_buffer
+
+    def _buffer_updated(self, nbytes):
+        if not nbytes:
+            return
+        self._buffer += self._recv_buffer[:nbytes]
+        self._data_appended()
 
+    def _data_appended(self):
         waiter = self._waiter
         if waiter is not None:
             self._waiter = None
@@ -10,7 +10,9 @@ __all__ = ["BZ2File", "BZ2Compressor", "BZ2Decompressor",
 __author__ = "Nadeem Vawda <nadeem.vawda@gmail.com>"
 
 import io
+import os
 import warnings
+import _compression
 
 try:
     from threading import RLock
@@ -30,6 +32,36 @@ _BUFFER_SIZE = 8192
 _builtin_open = open
 
 
+class _ParallelBZ2Compressor(_compression.ParallelCompressor):
+    """bzip2 compressor using several threads, like pbzip2.
+
+    Each block of input is compressed to a separate bzip2 stream, with the
+    block size of the compression level; the concatenation of the streams
+    is a multi-stream bzip2 file.
+    """
+
+    def __init__(self, compresslevel, threads):
+        # Reject a bad compresslevel here, as BZ2Compressor does, rather
+        # than from a worker thread
+        BZ2Compressor(compresslevel)
+        super().__init__(compresslevel * 100000, threads)
+        self._level = compresslevel
+
+    def compress_block(self, block, history):
+        comp = BZ2Compressor(self._level)
+        return comp.compress(block) + comp.flush()
+
+
+def _new_compressor(compresslevel, threads):
+    if threads == 0:
+        threads = os.cpu_count() or 1
+    if threads < 0:
+        raise ValueError("threads must not be negative")
+    if threads > 1:
+        return _ParallelBZ2Compressor(compresslevel, threads)
+    return BZ2Compressor(compresslevel)
+
+
 class BZ2File(io.BufferedIOBase):
 
     """A file object providing transparent bzip2 (de)compression.
@@ -41,7 +73,8 @@ class BZ2File(io.BufferedIOBase):
     returned as bytes, and data to be written should be given as bytes.
     """
 
-    def __init__(self, filename, mode="r", buffering=None, compresslevel=9):
+    def __init__(self, filename, mode="r", buffering=None, compresslevel=9,
+                 threads=1):
         """Open a bzip2-compressed file.
 
         If filename is a str or bytes object, it gives the name
@@ -57,6 +90,10 @@ class BZ2File(io.BufferedIOBase):
         If mode is 'w', 'x' or 'a', compresslevel can be a number between 1
         and 9 specifying the level of compression: 1 produces the least
         compression, and 9 (default) produces the most compression.
+        threads is the number of threads compressing the data, or 0 for
+        one per CPU; it must be 1 if mode is 'r'.  With more than one
+        thread, each block of input is compressed in parallel to a separate
+        bzip2 stream.
 
         If mode is 'r', the input file may be the concatenation of
         multiple compressed streams.
@@ -78,6 +115,9 @@ class BZ2File(io.BufferedIOBase):
             raise ValueError("compresslevel must be between 1 and 9")
 
         if mode in ("", "r", "rb"):
+            if threads != 1:
+                raise ValueError("Cannot specify threads "
+                                 "when opening a file for reading")
             mode = "rb"
             mode_code = _MODE_READ
             self._decompressor = BZ2Decompressor()
@@ -86,15 +126,15 @@ class BZ2File(io.BufferedIOBase):
         elif mode in ("w", "wb"):
             mode = "wb"
             mode_code = _MODE_WRITE
-            self._compressor = BZ2Compressor(compresslevel)
+            self._compressor = _new_compressor(compresslevel, threads)
         elif mode in ("x", "xb"):
             mode = "xb"
             mode_code = _MODE_WRITE
-            self._compressor = BZ2Compressor(compresslevel)
+            self._compressor = _new_compressor(compresslevel, threads)
         elif mode in ("a", "ab"):
             mode = "ab"
             mode_code = _MODE_WRITE
-            self._compressor = BZ2Compressor(compresslevel)
+            self._compressor = _new_compressor(compresslevel, threads)
         else:
             raise ValueError("Invalid mode: %r" % (mode,))
 
@@ -448,7 +488,7 @@ class BZ2File(io.BufferedIOBase):
 
 
 def open(filename, mode="rb", compresslevel=9,
-         encoding=None, errors=None, newline=None):
+         encoding=None, errors=None, newline=None, threads=1):
     """Open a bzip2-compressed file in binary or text mode.
 
     The filename argument can be an actual filename (a str or bytes
@@ -459,8 +499,9 @@ def open(filename, mode="rb", compresslevel=9,
     The default mode is "rb", and the default compresslevel is 9.
 
     For binary mode, this function is equivalent to the BZ2File
-    constructor: BZ2File(filename, mode, compresslevel). In this case,
-    the encoding, errors and newline arguments must not be provided.
+    constructor: BZ2File(filename, mode, compresslevel, threads=threads).
+    In this case, the encoding, errors and newline arguments must not be
+    provided.
 
     For text mode, a BZ2File object is created, and wrapped in an
     io.TextIOWrapper instance with the specified encoding, error
@@ -479,7 +520,8 @@ def open(filename, mode="rb", compresslevel=9,
             raise ValueError("Argument 'newline' not supported in binary mode")
 
     bz_mode = mode.replace("t", "")
-    binary_file = BZ2File(filename, bz_mode, compresslevel=compresslevel)
+    binary_file = BZ2File(filename, bz_mode, compresslevel=compresslevel,
+                          threads=threads)
 
     if "t" in mode:
         return io.TextIOWrapper(binary_file, encoding, errors, newline)
@@ -487,14 +529,15 @@ def open(filename, mode="rb", compresslevel=9,
         return binary_file
 
 
-def compress(data, compresslevel=9):
+def compress(data, compresslevel=9, threads=1):
     """Compress a block of data.
 
     compresslevel, if given, must be a number between 1 and 9.
+    threads is the number of threads compressing the data, see BZ2File.
 
     For incremental compression, use a BZ2Compressor object instead.
     """
-    comp = BZ2Compressor(compresslevel)
+    comp = _new_compressor(compresslevel, threads)
     return comp.compress(data) + comp.flush()
 
 
@@ -14,6 +14,7 @@ import os
 import sys
 import importlib.util
 import py_compile
+import stat
 import struct
 
 try:
@@ -50,7 +51,8 @@ def _walk_dir(dir, ddir=None, maxlevels=10, quiet=0):
                                  maxlevels=maxlevels - 1, quiet=quiet)
 
 def compile_dir(dir, maxlevels=10, ddir=None, force=False, rx=None,
-                quiet=0, legacy=False, optimize=-1, workers=1):
+                quiet=0, legacy=False, optimize=-1, workers=1,
+                invalidation_mode=py_compile.PycInvalidationMode.TIMESTAMP):
     """Byte-compile all modules in the given directory tree.
 
     Arguments (only dir is required):
@@ -65,34 +67,116 @@ def compile_dir(dir, maxlevels=10, ddir=None, force=False, rx=None,
     legacy:    if True, produce legacy pyc paths instead of PEP 3147 paths
     optimize:  optimization level or -1 for level of the interpreter
     workers:   maximum number of parallel workers
+    invalidation_mode: how the byte-code files are checked against their
+               source, a py_compile.PycInvalidationMode member
     """
     files = _walk_dir(dir, quiet=quiet, maxlevels=maxlevels,
                       ddir=ddir)
     success = 1
     if workers is not None and workers != 1:
-        if workers < 0:
-            raise ValueError('workers must be greater or equal to 0')
-        if ProcessPoolExecutor is None:
-            raise NotImplementedError('multiprocessing support not available')
-
-        workers = workers or None
-        with ProcessPoolExecutor(max_workers=workers) as executor:
-            results = executor.map(partial(compile_file,
-                                           ddir=ddir, force=force,
-                                           rx=rx, quiet=quiet,
-                                           legacy=legacy,
-                                           optimize=optimize),
-                                   files)
-            success = min(results, default=1)
+        success = _compile_parallel(files, ddir, force, rx, quiet, legacy,
+                                    optimize, workers, invalidation_mode)
     else:
         for file in files:
             if not compile_file(file, ddir, force, rx, quiet,
-                                legacy, optimize):
+                                legacy, optimize, invalidation_mode):
                 success = 0
     return success
 
+# Number of files handed to a worker at once by _compile_parallel().
+_CHUNKSIZE = 4
+
+def _compile_parallel(files, ddir, force, rx, quiet, legacy, optimize,
+                      workers, invalidation_mode):
+    """Byte-compile files with a pool of worker processes.
+
+    The workers take files from a single queue as they become idle.  Files
+    which are up to date are filtered out beforehand, and the others are
+    queued biggest first so that no worker is left compiling a big file
+    after the others are done.
+    """
+    if workers < 0:
+        raise ValueError('workers must be greater or equal to 0')
+    if ProcessPoolExecutor is None:
+        raise NotImplementedError('multiprocessing support not available')
+
+    stale = []
+    seen = set()
+    for fullname in files:
+        # Compiling a file twice at once could fail to write its byte-code.
+        if fullname in seen:
+            continue
+        seen.add(fullname)
+        if rx is not None and rx.search(fullname):
+            continue
+        if not fullname.endswith('.py'):
+            continue
+        try:
+            st = os.stat(fullname)
+        except OSError:
+            continue
+        if not stat.S_ISREG(st.st_mode):
+            continue
+        cfile = _cache_path(fullname, legacy, optimize)
+        if not force and _is_up_to_date(fullname, cfile, st,
+                                        invalidation_mode):
+            continue
+        stale.append((st.st_size, fullname))
+    if not stale:
+        return 1
+    stale.sort(reverse=True)
+
+    workers = workers or None
+    with ProcessPoolExecutor(max_workers=workers) as executor:
+        results = executor.map(partial(compile_file,
+                                       ddir=ddir, force=force,
+                                       rx=rx, quiet=quiet,
+                                       legacy=legacy,
+                                       optimize=optimize,
+                                       invalidation_mode=invalidation_mode),
+                               [fullname for size, fullname in stale],
+                               chunksize=_CHUNKSIZE)
+        return min(results, default=1)
+
+def _cache_path(fullname, legacy, optimize):
+    """Return the path of the byte-code file of the source file fullname."""
+    if legacy:
+        return fullname + ('c' if __debug__ else 'o')
+    elif optimize >= 0:
+        return importlib.util.cache_from_source(fullname,
+                                                debug_override=not optimize)
+    else:
+        return importlib.util.cache_from_source(fullname)
+
+def _is_up_to_date(fullname, cfile, source_stat, invalidation_mode):
+    """Return true if the header of the byte-code file cfile matches the
+    magic number of the interpreter and the source file fullname as of
+    invalidation_mode: its mtime and size, given by source_stat, or the hash
+    of its contents."""
+    mode = py_compile.PycInvalidationMode
+    if invalidation_mode == mode.TIMESTAMP:
+        expect = struct.pack('<4sLLL', importlib.util.MAGIC_NUMBER, 0,
+                             int(source_stat.st_mtime) & 0xFFFFFFFF,
+                             source_stat.st_size & 0xFFFFFFFF)
+    else:
+        flags = 0b01 if invalidation_mode == mode.UNCHECKED_HASH else 0b11
+        try:
+            with open(fullname, 'rb') as source:
+                source_hash = importlib.util.source_hash(source.read())
+        except OSError:
+            return False
+        expect = (importlib.util.MAGIC_NUMBER + struct.pack('<L', flags) +
+                  source_hash)
+    try:
+        with open(cfile, 'rb') as chandle:
+            actual = chandle.read(16)
+    except OSError:
+        return False
+    return expect == actual
+
 def compile_file(fullname, ddir=None, force=False, rx=None, quiet=0,
-                 legacy=False, optimize=-1):
+                 legacy=False, optimize=-1,
+                 invalidation_mode=py_compile.PycInvalidationMode.TIMESTAMP):
     """Byte-compile one file.
 
     Arguments (only fullname is required):
@@ -105,6 +189,8 @@ def compile_file(fullname, ddir=None, force=False, rx=None, quiet=0,
                no output with 2
     legacy:    if True, produce legacy pyc paths instead of PEP 3147 paths
     optimize:  optimization level or -1 for level of the interpreter
+    invalidation_mode: how the byte-code file is checked against its
+               source, a py_compile.PycInvalidationMode member
     """
     success = 1
     name = os.path.basename(fullname)
@@ -117,25 +203,13 @@ def compile_file(fullname, ddir=None, force=False, rx=None, quiet=0,
         if mo:
             return success
     if os.path.isfile(fullname):
-        if legacy:
-            cfile = fullname + ('c' if __debug__ else 'o')
-        else:
-            if optimize >= 0:
-                cfile = importlib.util.cache_from_source(
-                                fullname, debug_override=not optimize)
-            else:
-                cfile = importlib.util.cache_from_source(fullname)
-            cache_dir = os.path.dirname(cfile)
+        cfile = _cache_path(fullname, legacy, optimize)
         head, tail = name[:-3], name[-3:]
         if tail == '.py':
             if not force:
                 try:
-                    mtime = int(os.stat(fullname).st_mtime)
-                    expect = struct.pack('<4sl', importlib.util.MAGIC_NUMBER,
-                                         mtime)
-                    with open(cfile, 'rb') as chandle:
-                        actual = chandle.read(8)
-                    if expect == actual:
+                    if _is_up_to_date(fullname, cfile, os.stat(fullname),
+                                      invalidation_mode):
                         return success
                 except OSError:
                     pass
@@ -143,7 +217,8 @@ def compile_file(fullname, ddir=None, force=False, rx=None, quiet=0,
                 print('Compiling {!r}...'.format(fullname))
             try:
                 ok = py_compile.compile(fullname, cfile, dfile, True,
-                                        optimize=optimize)
+                                        optimize=optimize,
+                                        invalidation_mode=invalidation_mode)
             except py_compile.PyCompileError as err:
                 success = 0
                 if quiet >= 2:
@@ -172,7 +247,8 @@ def compile_file(fullname, ddir=None, force=False, rx=None, quiet=0,
     return success
 
 def compile_path(skip_curdir=1, maxlevels=0, force=False, quiet=0,
-                 legacy=False, optimize=-1):
+                 legacy=False, optimize=-1,
+                 invalidation_mode=py_compile.PycInvalidationMode.TIMESTAMP):
     """Byte-compile all module on sys.path.
 
     Arguments (all optional):
@@ -183,6 +259,7 @@ def compile_path(skip_curdir=1, maxlevels=0, force=False, quiet=0,
     quiet: as for compile_dir() (default 0)
     legacy: as for compile_dir() (default False)
     optimize: as for compile_dir() (default -1)
+    invalidation_mode: as for compile_dir() (default TIMESTAMP)
     """
     success = 1
     for dir in sys.path:
@@ -190,12 +267,20 @@ def compile_path(skip_curdir=1, maxlevels=0, force=False, quiet=0,
             if quiet < 2:
                 print('Skipping current directory')
         else:
-            success = success and compile_dir(dir, maxlevels, None,
-                                              force, quiet=quiet,
-                                              legacy=legacy, optimize=optimize)
+            success = success and compile_dir(
+                dir, maxlevels, None, force, quiet=quiet, legacy=legacy,
+                optimize=optimize, invalidation_mode=invalidation_mode)
     return success
 
 
+def _iter_dests(dests, maxlevels, quiet):
+    for dest in dests:
+        if os.path.isfile(dest):
+            yield dest
+        else:
+            yield from _walk_dir(dest, maxlevels=maxlevels, quiet=quiet)
+
+
 def main():
     """Script main program."""
     import argparse
@@ -235,6 +320,13 @@ def main():
                               'to the equivalent of -l sys.path'))
     parser.add_argument('-j', '--workers', default=1,
                         type=int, help='Run compileall concurrently')
+    invalidation_modes = [mode.name.lower().replace('_', '-')
+                          for mode in py_compile.PycInvalidationMode]
+    parser.add_argument('--invalidation-mode', default='timestamp',
+                        choices=sorted(invalidation_modes),
+                        help=('how the byte-code files are checked against '
+                              'their source on import: with its timestamp '
+                              '(the default) or a hash, checked or not'))
 
     args = parser.parse_args()
     compile_dests = args.compile_dest
@@ -266,23 +358,36 @@ def main():
     if args.workers is not None:
         args.workers = args.workers or None
 
+    ivl_mode = args.invalidation_mode.replace('-', '_').upper()
+    invalidation_mode = py_compile.PycInvalidationMode[ivl_mode]
+
     success = True
     try:
-        if compile_dests:
+        if compile_dests and args.workers != 1 and len(compile_dests) > 1:
+            # Compile the files of all the destinations with a single pool
+            # of workers.
+            files = _iter_dests(compile_dests, maxlevels, args.quiet)
+            return _compile_parallel(files, args.ddir, args.force, args.rx,
+                                     args.quiet, args.legacy, -1,
+                                     args.workers or 0, invalidation_mode)
+        elif compile_dests:
             for dest in compile_dests:
                 if os.path.isfile(dest):
                     if not compile_file(dest, args.ddir, args.force, args.rx,
-                                        args.quiet, args.legacy):
+                                        args.quiet, args.legacy,
+                                        invalidation_mode=invalidation_mode):
                         success = False
                 else:
                     if not compile_dir(dest, maxlevels, args.ddir,
                                        args.force, args.rx, args.quiet,
-                                       args.legacy, workers=args.workers):
+                                       args.legacy, workers=args.workers,
+                                       invalidation_mode=invalidation_mode):
                         success = False
             return success
         else:
             return compile_path(legacy=args.legacy, force=args.force,
-                                quiet=args.quiet)
+                                quiet=args.quiet,
+                                invalidation_mode=invalidation_mode)
     except KeyboardInterrupt:
         if args.quiet < 2:
             print("\n[interrupted]")
@@ -29,10 +29,61 @@ class IncrementalEncoder(codecs.IncrementalEncoder):
         assert self.errors == 'strict'
         return base64.encodebytes(input)
 
+# Everything but the base64 alphabet and the pad character, which
+# the decoder skips
+_ignored = bytes(set(range(256)).difference(
+    b'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/='))
+
 class IncrementalDecoder(codecs.IncrementalDecoder):
+    """Decodes the input as it comes, whatever the size of the chunks.
+
+    Base64 characters are kept until they make up groups of four, and each
+    complete group is decoded right away, including the padded group which
+    ends a stream.  The input may be several concatenated streams, so the
+    groups after padding are decoded too; stray pad characters between
+    groups are skipped.
+    """
+    def __init__(self, errors='strict'):
+        assert errors == 'strict'
+        codecs.IncrementalDecoder.__init__(self, errors)
+        self.buffer = b''
+
     def decode(self, input, final=False):
-        assert self.errors == 'strict'
-        return base64.decodebytes(input)
+        data = self.buffer + bytes(input).translate(None, _ignored)
+        size = len(data)
+        pos = 0
+        out = []
+        while pos < size:
+            if data[pos] == 0x3d:   # '='
+                pos += 1
+                continue
+            pad = data.find(b'=', pos)
+            if pad < 0:
+                end = size
+            else:
+                # Up to the end of the group holding the pad character
+                end = pad - (pad - pos) % 4 + 4
+            if end > size or pad < 0:
+                if final:
+                    end = size
+                else:
+                    end = min(end, size)
+                    end -= (end - pos) % 4
+                    if end == pos:
+                        break
+            out.append(base64.decodebytes(data[pos:end]))
+            pos = end
+        self.buffer = data[pos:]
+        return b''.join(out)
+
+    def reset(self):
+        self.buffer = b''
+
+    def getstate(self):
+        return (self.buffer, 0)
+
+    def setstate(self, state):
+        self.buffer = state[0]
 
 class StreamWriter(Codec, codecs.StreamWriter):
     charbuffertype = bytes
@@ -9,6 +9,7 @@ import struct, sys, time, os
 import zlib
 import builtins
 import io
+import _compression
 
 __all__ = ["GzipFile", "open", "compress", "decompress"]
 
@@ -17,7 +18,7 @@ FTEXT, FHCRC, FEXTRA, FNAME, FCOMMENT = 1, 2, 4, 8, 16
 READ, WRITE = 1, 2
 
 def open(filename, mode="rb", compresslevel=9,
-         encoding=None, errors=None, newline=None):
+         encoding=None, errors=None, newline=None, threads=1):
     """Open a gzip-compressed file in binary or text mode.
 
     The filename argument can be an actual filename (a str or bytes object), or
@@ -31,6 +32,8 @@ def open(filename, mode="rb", compresslevel=9,
     GzipFile(filename, mode, compresslevel). In this case, the encoding, errors
     and newline arguments must not be provided.
 
+    The threads argument is passed to the GzipFile constructor.
+
     For text mode, a GzipFile object is created, and wrapped in an
     io.TextIOWrapper instance with the specified encoding, error handling
     behavior, and line ending(s).
@@ -49,9 +52,11 @@ def open(filename, mode="rb", compresslevel=9,
 
     gz_mode = mode.replace("t", "")
     if isinstance(filename, (str, bytes)):
-        binary_file = GzipFile(filename, gz_mode, compresslevel)
+        binary_file = GzipFile(filename, gz_mode, compresslevel,
+                               threads=threads)
     elif hasattr(filename, "read") or hasattr(filename, "write"):
-        binary_file = GzipFile(None, gz_mode, compresslevel, filename)
+        binary_file = GzipFile(None, gz_mode, compresslevel, filename,
+                               threads=threads)
     else:
         raise TypeError("filename must be a str or bytes object, or a file")
 
@@ -121,9 +126,51 @@ class _PaddedFile:
         return getattr(self.file, name)
 
 
+class _ParallelDeflater(_compression.ParallelCompressor):
+    """Raw deflate compressor using several threads, like pigz.
+
+    Each block of input is compressed on its own, with the 32 KiB of input
+    preceding it as preset dictionary, and ends with a sync flush.  Since
+    that leaves the output on a byte boundary without ending the deflate
+    stream, the concatenation of the blocks followed by an empty final block
+    is a single standard deflate stream.
+    """
+
+    block_size = 128 * 1024
+
+    def __init__(self, compresslevel, threads):
+        self._level = compresslevel
+        # Reject a bad compresslevel here, as zlib.compressobj() does, rather
+        # than from a worker thread
+        self._compressobj()
+        super().__init__(self.block_size, threads, history=32 * 1024)
+
+    def _compressobj(self, zdict=None):
+        if zdict:
+            return zlib.compressobj(self._level, zlib.DEFLATED,
+                                    -zlib.MAX_WBITS, zlib.DEF_MEM_LEVEL, 0,
+                                    zdict)
+        return zlib.compressobj(self._level, zlib.DEFLATED,
+                                -zlib.MAX_WBITS, zlib.DEF_MEM_LEVEL, 0)
+
+    def compress_block(self, block, history):
+        compressobj = self._compressobj(history)
+        return compressobj.compress(block) + compressobj.flush(zlib.Z_SYNC_FLUSH)
+
+    def flush(self, mode=zlib.Z_FINISH):
+        if mode == zlib.Z_NO_FLUSH:
+            return b''
+        out = super().flush(mode == zlib.Z_FINISH)
+        if mode == zlib.Z_FULL_FLUSH:
+            self.reset_history()
+        elif mode == zlib.Z_FINISH:
+            out += self._compressobj().flush()
+        return out
+
+
 class GzipFile(io.BufferedIOBase):
     """The GzipFile class simulates most of the methods of a file object with
-    the exception of the readinto() and truncate() methods.
+    the exception of the truncate() method.
 
     This class only supports opening files in binary mode. If you need to open a
     compressed file in text mode, use the gzip.open() function.
@@ -134,7 +181,7 @@ class GzipFile(io.BufferedIOBase):
     max_read_chunk = 10 * 1024 * 1024   # 10Mb
 
     def __init__(self, filename=None, mode=None,
-                 compresslevel=9, fileobj=None, mtime=None):
+                 compresslevel=9, fileobj=None, mtime=None, threads=1):
         """Constructor for the GzipFile class.
 
         At least one of fileobj and filename must be given a
@@ -171,6 +218,11 @@ class GzipFile(io.BufferedIOBase):
         return value of time.time() and of the st_mtime member of the
         object returned by os.stat().
 
+        The threads argument is the number of threads compressing the data
+        when writing, or 0 for one per CPU.  It must be 1 when reading.  With more than one thread, the
+        data is cut into blocks of 128 KiB compressed in parallel, which
+        gives a standard gzip stream that is slightly larger.
+
         """
 
         if mode and ('t' in mode or 'U' in mode):
@@ -187,6 +239,9 @@ class GzipFile(io.BufferedIOBase):
             mode = getattr(fileobj, 'mode', 'rb')
 
         if mode.startswith('r'):
+            if threads != 1:
+                raise ValueError("Cannot specify threads "
+                                 "when opening a file for reading")
             self.mode = READ
             # Set flag indicating start of a new member
             self._new_member = True
@@ -204,11 +259,18 @@ class GzipFile(io.BufferedIOBase):
         elif mode.startswith(('w', 'a', 'x')):
             self.mode = WRITE
             self._init_write(filename)
-            self.compress = zlib.compressobj(compresslevel,
-                                             zlib.DEFLATED,
-                                             -zlib.MAX_WBITS,
-                                             zlib.DEF_MEM_LEVEL,
-                                             0)
+            if threads == 0:
+                threads = os.cpu_count() or 1
+            if threads < 0:
+                raise ValueError("threads must not be negative")
+            if threads > 1:
+                self.compress = _ParallelDeflater(compresslevel, threads)
+            else:
+                self.compress = zlib.compressobj(compresslevel,
+                                                 zlib.DEFLATED,
+                                                 -zlib.MAX_WBITS,
+                                                 zlib.DEF_MEM_LEVEL,
+                                                 0)
         else:
             raise ValueError("Invalid mode: {!r}".format(mode))
 
@@ -397,6 +459,66 @@ class GzipFile(io.BufferedIOBase):
         self.offset += size
         return chunk
 
+    def readinto(self, b):
+        self._check_closed()
+        if self.mode != READ:
+            import errno
+            raise OSError(errno.EBADF,
+                          "readinto() on write-only GzipFile object")
+
+        with memoryview(b) as view, view.cast('B') as byte_view:
+            size = len(byte_view)
+            n = 0
+            more = True
+            while n < size:
+                if self.extrasize > 0:
+                    # Hand out the data already decompressed by read(),
+                    # peek() or a new member's header first
+                    offset = self.offset - self.extrastart
+                    k = min(size - n, self.extrasize)
+                    byte_view[n:n + k] = self.extrabuf[offset:offset + k]
+                    self.extrasize -= k
+                    self.offset += k
+                    n += k
+                elif not more:
+                    break
+                else:
+                    written = self._read_into(byte_view[n:])
+                    if written < 0:
+                        # The flushed data, if any, is left in extrabuf
+                        more = False
+                    else:
+                        n += written
+        return n
+
+    def _read_into(self, view):
+        # Decompress straight into view rather than into extrabuf.  Returns
+        # the number of bytes written, or -1 at the end of the file.
+        if self.fileobj is None:
+            return -1
+        if not self._new_member:
+            buf = self.fileobj.read(min(max(len(view), 1024),
+                                        self.max_read_chunk))
+            if buf:
+                written = self.decompress.decompress_into(buf, view)
+                with view[:written] as data:
+                    self.crc = zlib.crc32(data, self.crc) & 0xffffffff
+                self.size += written
+                self.offset += written
+                self.extrabuf = b""
+                self.extrastart = self.offset
+                if self.decompress.unconsumed_tail:
+                    # The view is full: give the rest back to the file
+                    self.fileobj.prepend(self.decompress.unconsumed_tail, True)
+                elif self.decompress.unused_data:
+                    # End of a member, as in _read()
+                    self.fileobj.prepend(self.decompress.unused_data, True)
+                    self._read_eof()
+                    self._new_member = True
+                return written
+        # Member headers and the end of the file are left to _read()
+        return 0 if self._read() else -1
+
     def peek(self, n):
         if self.mode != READ:
             import errno
@@ -615,12 +737,15 @@ class GzipFile(io.BufferedIOBase):
         return b''.join(bufs) # Return resulting line
 
 
-def compress(data, compresslevel=9):
+def compress(data, compresslevel=9, threads=1):
     """Compress data in one shot and return the compressed string.
     Optional argument is the compression level, in range of 0-9.
+    Optional argument threads is the number of threads compressing the data,
+    see GzipFile.
     """
     buf = io.BytesIO()
-    with GzipFile(fileobj=buf, mode='wb', compresslevel=compresslevel) as f:
+    with GzipFile(fileobj=buf, mode='wb', compresslevel=compresslevel,
+                  threads=threads) as f:
         f.write(data)
     return buf.getvalue()
 
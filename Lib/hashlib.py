@@ -60,7 +60,8 @@ algorithms_guaranteed = set(__always_supported)
 algorithms_available = set(__always_supported)
 
 __all__ = __always_supported + ('new', 'algorithms_guaranteed',
-                                'algorithms_available', 'pbkdf2_hmac')
+                                'algorithms_available', 'pbkdf2_hmac',
+                                'file_digest', 'digest_many')
 
 
 __builtin_constructor_cache = {}
@@ -138,6 +139,63 @@ except ImportError:
     new = __py_new
     __get_hash = __get_builtin_constructor
 
+def file_digest(fileobj, digest, *, _bufsize=2**18):
+    """Hash the contents of a file-like object or file descriptor.
+
+    *fileobj* must be a file-like object opened for reading in binary mode,
+    or an integer file descriptor.  *digest* is either a hash algorithm name
+    as accepted by new(), or a callable returning a new hash object.
+
+    The file is read with readinto() into a single large buffer which is
+    reused for each chunk, and the hash objects release the GIL while
+    hashing it, so other threads can run while a large file is hashed.
+    Returns the hash object.  BlockingIOError is raised if the file is in
+    non-blocking mode and has no data ready.
+    """
+    if isinstance(digest, str):
+        digestobj = new(digest)
+    else:
+        digestobj = digest()
+
+    if isinstance(fileobj, int):
+        fileobj = open(fileobj, 'rb', buffering=0, closefd=False)
+    elif not (hasattr(fileobj, 'readinto') and
+              hasattr(fileobj, 'readable') and fileobj.readable()):
+        raise ValueError("%r is not a file-like object in binary reading "
+                         "mode." % fileobj)
+
+    buf = bytearray(_bufsize)
+    view = memoryview(buf)
+    while True:
+        size = fileobj.readinto(buf)
+        if size is None:
+            # A non-blocking file with no data ready: this is not the end
+            # of the file, and hashing what was read so far would be wrong
+            raise BlockingIOError("file_digest() cannot read a "
+                                  "non-blocking file without data ready")
+        if not size:
+            break
+        digestobj.update(view[:size])
+
+    return digestobj
+
+
+def digest_many(name, messages):
+    """Return a list with the digest of each bytes-like object in messages,
+    computed with the named algorithm.
+
+    For the always supported algorithms the whole batch is hashed in a single
+    call with the GIL released, which is much faster than creating a hash
+    object for each of many short messages.
+    """
+    try:
+        constructor = __get_builtin_constructor(name)
+    except ValueError:
+        return [new(name, message).digest() for message in messages]
+    many = getattr(constructor.__self__, constructor.__name__ + '_many')
+    return many(messages)
+
+
 try:
     # OpenSSL's PKCS5_PBKDF2_HMAC requires OpenSSL 1.0+ with HMAC and SHA
     from _hashlib import pbkdf2_hmac
@@ -271,9 +271,12 @@ def find_module(name, path=None):
         if is_builtin(name):
             return None, None, ('', '', C_BUILTIN)
         elif is_frozen(name):
-            return None, None, ('', '', PY_FROZEN)
-        else:
-            path = sys.path
+            # Modules of the standard library frozen at build time are found
+            # as their source files.
+            spec = machinery.FrozenImporter.find_spec(name)
+            if spec is not None and not spec.has_location:
+                return None, None, ('', '', PY_FROZEN)
+        path = sys.path
 
     for entry in path:
         package_directory = os.path.join(entry, name)
@@ -420,16 +420,32 @@ def _call_with_frames_removed(f, *args, **kwds):
 #     Python 3.4a4  3300 (more changes to __qualname__ computation)
 #     Python 3.4rc2 3310 (alter __qualname__ computation)
 #     Python 3.5a0  3320 (matrix multiplication operator)
+#     Python 3.5a0  3330 (marshal version 5: lazily loaded nested code)
+#     Python 3.5a0  3340 (flags field in the header, hash-based pycs)
 #
 # MAGIC must change whenever the bytecode emitted by the compiler may no
 # longer be understood by older implementations of the eval loop (usually
 # due to the addition of new opcodes).
 
-MAGIC_NUMBER = (3320).to_bytes(2, 'little') + b'\r\n'
+MAGIC_NUMBER = (3340).to_bytes(2, 'little') + b'\r\n'
 _RAW_MAGIC_NUMBER = int.from_bytes(MAGIC_NUMBER, 'little')  # For import.c
 
 _PYCACHE = '__pycache__'
 
+# Bits of the flags field of the header of bytecode files.  A hash-based
+# bytecode file holds the hash of its source instead of its mtime and size,
+# and is only checked against its source when _PYC_CHECK_SOURCE is set too.
+_PYC_HASH_BASED = 0b01
+_PYC_CHECK_SOURCE = 0b10
+
+# The index of a directory's contents kept by FileFinder in its __pycache__
+# subdirectory.  It is only kept if the directory was last modified at
+# least _INDEX_RACY_NS nanoseconds before the index was written, since later
+# changes made within the granularity of the file system's timestamps would
+# go unnoticed.
+_DIR_INDEX = '__index__.{}.idx'
+_INDEX_RACY_NS = 2 * 10**9
+
 SOURCE_SUFFIXES = ['.py']  # _setup() adds .pyw as needed.
 
 DEBUG_BYTECODE_SUFFIXES = ['.pyc']
@@ -597,10 +613,66 @@ def _load_module_shim(self, fullname):
         return _load(spec)
 
 
+def _classify_pyc(data, name, exc_details):
+    """Check the magic number and the flags in the header of the passed-in
+    bytecode and return the flags.
+
+    ImportError is raised when the magic number or the flags are incorrect.
+    EOFError is raised when the data is found to be truncated.
+
+    """
+    magic = data[:4]
+    if magic != MAGIC_NUMBER:
+        message = 'bad magic number in {!r}: {!r}'.format(name, magic)
+        _verbose_message(message)
+        raise ImportError(message, **exc_details)
+    if len(data) < 16:
+        message = 'reached EOF while reading pyc header of {!r}'.format(name)
+        _verbose_message(message)
+        raise EOFError(message)
+    flags = _r_long(data[4:8])
+    if flags & ~(_PYC_HASH_BASED | _PYC_CHECK_SOURCE):
+        message = 'invalid flags {!r} in {!r}'.format(flags, name)
+        raise ImportError(message, **exc_details)
+    return flags
+
+
+def _validate_timestamp_pyc(data, source_mtime, source_size, name,
+                            exc_details):
+    """Validate the header of a timestamp-based bytecode file against the
+    mtime and, if it is not None, the size of its source.
+
+    ImportError is raised when the bytecode is found to be stale.
+
+    """
+    if _r_long(data[8:12]) != (source_mtime & 0xFFFFFFFF):
+        message = 'bytecode is stale for {!r}'.format(name)
+        _verbose_message(message)
+        raise ImportError(message, **exc_details)
+    if (source_size is not None and
+            _r_long(data[12:16]) != (source_size & 0xFFFFFFFF)):
+        raise ImportError('bytecode is stale for {!r}'.format(name),
+                          **exc_details)
+
+
+def _validate_hash_pyc(data, source_hash, name, exc_details):
+    """Validate the header of a hash-based bytecode file against the hash of
+    its source.
+
+    ImportError is raised when the bytecode is found to be stale.
+
+    """
+    if data[8:16] != source_hash:
+        raise ImportError(
+            'hash in bytecode doesn\'t match hash of source {!r}'.format(name),
+            **exc_details)
+
+
 def _validate_bytecode_header(data, source_stats=None, name=None, path=None):
     """Validate the header of the passed-in bytecode against source_stats (if
     given) and returning the bytecode that can be compiled by compile().
 
+    The header of hash-based bytecode is not checked against source_stats.
     All other arguments are used to enhance error reporting.
 
     ImportError is raised when the magic number is incorrect or the bytecode is
@@ -616,45 +688,26 @@ def _validate_bytecode_header(data, source_stats=None, name=None, path=None):
         name = '<bytecode>'
     if path is not None:
         exc_details['path'] = path
-    magic = data[:4]
-    raw_timestamp = data[4:8]
-    raw_size = data[8:12]
-    if magic != MAGIC_NUMBER:
-        message = 'bad magic number in {!r}: {!r}'.format(name, magic)
-        _verbose_message(message)
-        raise ImportError(message, **exc_details)
-    elif len(raw_timestamp) != 4:
-        message = 'reached EOF while reading timestamp in {!r}'.format(name)
-        _verbose_message(message)
-        raise EOFError(message)
-    elif len(raw_size) != 4:
-        message = 'reached EOF while reading size of source in {!r}'.format(name)
-        _verbose_message(message)
-        raise EOFError(message)
-    if source_stats is not None:
+    flags = _classify_pyc(data, name, exc_details)
+    if source_stats is not None and not flags & _PYC_HASH_BASED:
         try:
             source_mtime = int(source_stats['mtime'])
         except KeyError:
             pass
         else:
-            if _r_long(raw_timestamp) != source_mtime:
-                message = 'bytecode is stale for {!r}'.format(name)
-                _verbose_message(message)
-                raise ImportError(message, **exc_details)
-        try:
-            source_size = source_stats['size'] & 0xFFFFFFFF
-        except KeyError:
-            pass
-        else:
-            if _r_long(raw_size) != source_size:
-                raise ImportError('bytecode is stale for {!r}'.format(name),
-                                  **exc_details)
-    return data[12:]
+            _validate_timestamp_pyc(data, source_mtime,
+                                    source_stats.get('size'), name,
+                                    exc_details)
+    return data[16:]
 
 
 def _compile_bytecode(data, name=None, bytecode_path=None, source_path=None):
-    """Compile bytecode as returned by _validate_bytecode_header()."""
-    code = marshal.loads(data)
+    """Compile bytecode as returned by _validate_bytecode_header().
+
+    The code objects nested in the module's code are only unmarshalled when
+    a function is made from them, from a copy of their data kept until then.
+    """
+    code = marshal.loads(data, True)
     if isinstance(code, _code_type):
         _verbose_message('code object from {!r}', bytecode_path)
         if source_path is not None:
@@ -668,12 +721,32 @@ def _code_to_bytecode(code, mtime=0, source_size=0):
     """Compile a code object into bytecode for writing out to a byte-compiled
     file."""
     data = bytearray(MAGIC_NUMBER)
+    data.extend(_w_long(0))
     data.extend(_w_long(mtime))
     data.extend(_w_long(source_size))
     data.extend(marshal.dumps(code))
     return data
 
 
+def _code_to_hash_pyc(code, source_hash, checked=True):
+    """Compile a code object into bytecode for writing out to a hash-based
+    byte-compiled file."""
+    data = bytearray(MAGIC_NUMBER)
+    flags = _PYC_HASH_BASED | (_PYC_CHECK_SOURCE if checked else 0)
+    data.extend(_w_long(flags))
+    assert len(source_hash) == 8
+    data.extend(source_hash)
+    data.extend(marshal.dumps(code))
+    return data
+
+
+def _check_hash_based_pycs():
+    """Return how hash-based bytecode files are checked against their
+    source: 'default' checks those which ask for it, 'always' and 'never'
+    check all or none of them."""
+    return sys._xoptions.get('check_hash_based_pycs', 'default')
+
+
 def decode_source(source_bytes):
     """Decode bytes representing source code and return the string.
 
@@ -1264,6 +1337,32 @@ class BuiltinImporter:
         return False
 
 
+_frozen_stdlib_dir = None
+
+def _frozen_stdlib_source(fullname):
+    """Return the path of the source file of a frozen module, or None if it
+    is not a module of the standard library.
+
+    The standard library is the first directory of sys.path holding os.py,
+    like the landmark which the interpreter uses to compute sys.prefix.
+
+    """
+    global _frozen_stdlib_dir
+    if _frozen_stdlib_dir is None:
+        for entry in sys.path:
+            if entry and _path_isfile(_path_join(entry, 'os.py')):
+                _frozen_stdlib_dir = entry
+                break
+        else:
+            return None
+    path = _path_join(_frozen_stdlib_dir, *fullname.split('.'))
+    if _imp.is_frozen_package(fullname):
+        path = _path_join(path, '__init__.py')
+    else:
+        path += '.py'
+    return path if _path_isfile(path) else None
+
+
 class FrozenImporter:
 
     """Meta path import for frozen modules.
@@ -1284,10 +1383,20 @@ class FrozenImporter:
 
     @classmethod
     def find_spec(cls, fullname, path=None, target=None):
-        if _imp.is_frozen(fullname):
+        if not _imp.is_frozen(fullname):
+            return None
+        # Modules of the standard library frozen by configure
+        # --with-frozen-stdlib keep the location of their source file.
+        origin = _frozen_stdlib_source(fullname)
+        if origin is None:
             return spec_from_loader(fullname, cls, origin='frozen')
-        else:
+        if sys._xoptions.get('frozen_modules') == 'off':
             return None
+        spec = spec_from_loader(fullname, cls, origin=origin)
+        spec.has_location = True
+        if spec.submodule_search_locations is not None:
+            spec.submodule_search_locations.append(_path_split(origin)[0])
+        return spec
 
     @classmethod
     def find_module(cls, fullname, path=None):
@@ -1296,15 +1405,18 @@ class FrozenImporter:
         This method is deprecated.  Use find_spec() instead.
 
         """
-        return cls if _imp.is_frozen(fullname) else None
+        return cls if cls.find_spec(fullname) is not None else None
 
     @staticmethod
     def exec_module(module):
-        name = module.__spec__.name
+        spec = module.__spec__
+        name = spec.name
         if not _imp.is_frozen(name):
             raise ImportError('{!r} is not a frozen module'.format(name),
                               name=name)
         code = _call_with_frames_removed(_imp.get_frozen_object, name)
+        if spec.has_location:
+            _imp._fix_co_filename(code, spec.origin)
         exec(code, module.__dict__)
 
     @classmethod
@@ -1483,52 +1595,86 @@ class SourceLoader(_LoaderBasics):
     def get_code(self, fullname):
         """Concrete implementation of InspectLoader.get_code.
 
-        Reading of bytecode requires path_stats to be implemented. To write
-        bytecode, set_data must also be implemented.
+        Reading of timestamp-based bytecode requires path_stats to be
+        implemented. To write bytecode, set_data must also be implemented.
 
         """
         source_path = self.get_filename(fullname)
         source_mtime = None
+        source_bytes = None
+        source_hash = None
+        hash_based = False
+        check_source = True
         try:
             bytecode_path = cache_from_source(source_path)
         except NotImplementedError:
             bytecode_path = None
         else:
             try:
-                st = self.path_stats(source_path)
-            except IOError:
-                pass
-            else:
-                source_mtime = int(st['mtime'])
+                data = self.get_data(bytecode_path)
+            except OSError:
+                data = None
+            if data is not None:
+                exc_details = {'name': fullname, 'path': bytecode_path}
                 try:
-                    data = self.get_data(bytecode_path)
-                except OSError:
+                    flags = _classify_pyc(data, fullname, exc_details)
+                    hash_based = flags & _PYC_HASH_BASED != 0
+                    if hash_based:
+                        # The source is neither read nor even stat()ed when
+                        # the bytecode is not checked against it.
+                        check_source = flags & _PYC_CHECK_SOURCE != 0
+                        check = _check_hash_based_pycs()
+                        if check != 'never' and (check_source or
+                                                 check == 'always'):
+                            source_bytes = self.get_data(source_path)
+                            source_hash = _imp.source_hash(_RAW_MAGIC_NUMBER,
+                                                           source_bytes)
+                            _validate_hash_pyc(data, source_hash, fullname,
+                                               exc_details)
+                    else:
+                        st = self.path_stats(source_path)
+                        source_mtime = int(st['mtime'])
+                        _validate_timestamp_pyc(data, source_mtime,
+                                                st.get('size'), fullname,
+                                                exc_details)
+                except (ImportError, EOFError, OSError):
                     pass
                 else:
-                    try:
-                        bytes_data = _validate_bytecode_header(data,
-                                source_stats=st, name=fullname,
-                                path=bytecode_path)
-                    except (ImportError, EOFError):
-                        pass
-                    else:
-                        _verbose_message('{} matches {}', bytecode_path,
-                                        source_path)
-                        return _compile_bytecode(bytes_data, name=fullname,
-                                                 bytecode_path=bytecode_path,
-                                                 source_path=source_path)
-        source_bytes = self.get_data(source_path)
+                    _verbose_message('{} matches {}', bytecode_path,
+                                    source_path)
+                    return _compile_bytecode(data[16:], name=fullname,
+                                             bytecode_path=bytecode_path,
+                                             source_path=source_path)
+            if not hash_based and source_mtime is None:
+                # Stat the source before reading it, so that changes made
+                # after it is read make the bytecode written stale.
+                try:
+                    source_mtime = int(self.path_stats(source_path)['mtime'])
+                except IOError:
+                    pass
+        if source_bytes is None:
+            source_bytes = self.get_data(source_path)
         code_object = self.source_to_code(source_bytes, source_path)
         _verbose_message('code object from {}', source_path)
-        if (not sys.dont_write_bytecode and bytecode_path is not None and
-                source_mtime is not None):
-            data = _code_to_bytecode(code_object, source_mtime,
-                    len(source_bytes))
-            try:
-                self._cache_bytecode(source_path, bytecode_path, data)
-                _verbose_message('wrote {!r}', bytecode_path)
-            except NotImplementedError:
-                pass
+        if not sys.dont_write_bytecode and bytecode_path is not None:
+            if hash_based:
+                # Keep the bytecode file hash-based, as it was written.
+                if source_hash is None:
+                    source_hash = _imp.source_hash(_RAW_MAGIC_NUMBER,
+                                                   source_bytes)
+                data = _code_to_hash_pyc(code_object, source_hash,
+                                         check_source)
+            elif source_mtime is not None:
+                data = _code_to_bytecode(code_object, source_mtime,
+                                         len(source_bytes))
+            else:
+                data = None
+            if data is not None:
+                try:
+                    self._cache_bytecode(source_path, bytecode_path, data)
+                    _verbose_message('wrote {!r}', bytecode_path)
+                except NotImplementedError:
+                    pass
         return code_object
 
 
@@ -1921,6 +2067,19 @@ class PathFinder:
         return spec.loader
 
 
+def _lower_suffixes(names):
+    """Return the set of names with their suffixes made lowercase."""
+    lower_suffix_names = set()
+    for item in names:
+        name, dot, suffix = item.partition('.')
+        if dot:
+            new_name = '{}.{}'.format(name, suffix.lower())
+        else:
+            new_name = name
+        lower_suffix_names.add(new_name)
+    return lower_suffix_names
+
+
 class FileFinder:
 
     """File-based finder.
@@ -1943,10 +2102,15 @@ class FileFinder:
         self._path_mtime = -1
         self._path_cache = set()
         self._relaxed_path_cache = set()
+        # Names in _path_cache known to be regular files.
+        self._path_files = set()
+        self._use_index = True
 
     def invalidate_caches(self):
-        """Invalidate the directory mtime."""
+        """Invalidate the directory mtime and the on-disk index of the
+        directory."""
         self._path_mtime = -1
+        self._use_index = False
 
     find_module = _find_module_shim
 
@@ -1973,19 +2137,22 @@ class FileFinder:
         is_namespace = False
         tail_module = fullname.rpartition('.')[2]
         try:
-            mtime = _path_stat(self.path or _os.getcwd()).st_mtime
+            stat_info = _path_stat(self.path or _os.getcwd())
         except OSError:
-            mtime = -1
+            stat_info = None
+        mtime = -1 if stat_info is None else stat_info.st_mtime
         if mtime != self._path_mtime:
-            self._fill_cache()
+            self._fill_cache(stat_info)
             self._path_mtime = mtime
         # tail_module keeps the original casing, for __file__ and friends
         if _relax_case():
             cache = self._relaxed_path_cache
             cache_module = tail_module.lower()
+            files = ()
         else:
             cache = self._path_cache
             cache_module = tail_module
+            files = self._path_files
         # Check if the module is the name of a directory (and thus a package).
         if cache_module in cache:
             base_path = _path_join(self.path, tail_module)
@@ -2003,7 +2170,7 @@ class FileFinder:
             full_path = _path_join(self.path, tail_module + suffix)
             _verbose_message('trying {}'.format(full_path), verbosity=2)
             if cache_module + suffix in cache:
-                if _path_isfile(full_path):
+                if cache_module + suffix in files or _path_isfile(full_path):
                     return self._get_spec(loader_class, fullname, full_path, None, target)
         if is_namespace:
             _verbose_message('possible namespace for {}'.format(base_path))
@@ -2012,37 +2179,112 @@ class FileFinder:
             return spec
         return None
 
-    def _fill_cache(self):
-        """Fill the cache of potential modules and packages for this directory."""
+    def _fill_cache(self, stat_info):
+        """Fill the cache of potential modules and packages for this directory.
+
+        stat_info is the result of stat() on the directory, or None if it
+        failed.  The directory's contents are read from its on-disk index when
+        that is up to date, saving the listing of the directory and the stat()
+        calls which would otherwise check that modules found are files.
+
+        """
         path = self.path
-        try:
-            contents = _os.listdir(path or _os.getcwd())
-        except (FileNotFoundError, PermissionError, NotADirectoryError):
-            # Directory has either been removed, turned into a file, or made
-            # unreadable.
-            contents = []
+        index = None
+        if self._use_index and stat_info is not None:
+            index = self._read_index(stat_info)
+        self._use_index = True
+        if index is not None:
+            contents, files = index
+        else:
+            try:
+                contents = _os.listdir(path or _os.getcwd())
+            except (FileNotFoundError, PermissionError, NotADirectoryError):
+                # Directory has either been removed, turned into a file, or made
+                # unreadable.
+                contents = []
+            files = ()
+            if stat_info is not None and _PYCACHE in contents:
+                files = self._write_index(stat_info, contents)
         # We store two cached versions, to handle runtime changes of the
         # PYTHONCASEOK environment variable.
         if not sys.platform.startswith('win'):
             self._path_cache = set(contents)
+            self._path_files = set(files)
         else:
             # Windows users can import modules with case-insensitive file
             # suffixes (for legacy reasons). Make the suffix lowercase here
             # so it's done once instead of for every import. This is safe as
             # the specified suffixes to check against are always specified in a
             # case-sensitive manner.
-            lower_suffix_contents = set()
-            for item in contents:
-                name, dot, suffix = item.partition('.')
-                if dot:
-                    new_name = '{}.{}'.format(name, suffix.lower())
-                else:
-                    new_name = name
-                lower_suffix_contents.add(new_name)
-            self._path_cache = lower_suffix_contents
+            self._path_cache = _lower_suffixes(contents)
+            self._path_files = _lower_suffixes(files)
         if sys.platform.startswith(_CASE_INSENSITIVE_PLATFORMS):
             self._relaxed_path_cache = {fn.lower() for fn in contents}
 
+    def _index_path(self):
+        tag = sys.implementation.cache_tag
+        if tag is None:
+            return None
+        return _path_join(self.path, _PYCACHE, _DIR_INDEX.format(tag))
+
+    def _read_index(self, stat_info):
+        """Return the contents of the directory and the names of the module
+        files in it which are regular files, as recorded in its index, or None
+        if the index is missing or out of date."""
+        index_path = self._index_path()
+        if index_path is None:
+            return None
+        try:
+            with _io.FileIO(index_path, 'r') as file:
+                data = file.read()
+        except OSError:
+            return None
+        if data[:4] != MAGIC_NUMBER:
+            return None
+        try:
+            key, contents, files = marshal.loads(memoryview(data)[4:])
+        except (EOFError, ValueError, TypeError):
+            return None
+        if key != (stat_info.st_ino, stat_info.st_mtime_ns, stat_info.st_size):
+            return None
+        if type(contents) is not tuple or type(files) is not tuple:
+            return None
+        _verbose_message('directory index read from {!r}', index_path,
+                         verbosity=2)
+        return contents, files
+
+    def _write_index(self, stat_info, contents):
+        """Write the index of the directory, whose contents have just been
+        listed, to its __pycache__ subdirectory.
+
+        Return the names of the module files in the directory which are
+        regular files, found while writing the index.
+
+        """
+        index_path = self._index_path()
+        if (sys.dont_write_bytecode or index_path is None or
+                not _os.access(_path_split(index_path)[0], _os.W_OK)):
+            return ()
+        suffixes = tuple(suffix for suffix, _ in self._loaders)
+        files = tuple(name for name in contents if name.endswith(suffixes) and
+                      _path_isfile(_path_join(self.path, name)))
+        key = stat_info.st_ino, stat_info.st_mtime_ns, stat_info.st_size
+        data = bytearray(MAGIC_NUMBER)
+        data.extend(marshal.dumps((key, tuple(contents), files)))
+        try:
+            _write_atomic(index_path, data)
+            if (_path_stat(index_path).st_mtime_ns <
+                    stat_info.st_mtime_ns + _INDEX_RACY_NS):
+                # The directory was modified too recently for the index to
+                # be trusted; leave it to be written by a later search.
+                _os.unlink(index_path)
+            else:
+                _verbose_message('wrote {!r}', index_path)
+        except OSError as exc:
+            # Same as for bytecode: failing to write the index is not fatal.
+            _verbose_message('could not write {!r}: {!r}', index_path, exc)
+        return files
+
     @classmethod
     def path_hook(cls, *loader_details):
         """A class method which returns a closure to use on sys.path_hook
@@ -1,6 +1,7 @@
 """Utility code for constructing importers, etc."""
 from . import abc
 from ._bootstrap import MAGIC_NUMBER
+from ._bootstrap import _RAW_MAGIC_NUMBER
 from ._bootstrap import cache_from_source
 from ._bootstrap import decode_source
 from ._bootstrap import module_from_spec
@@ -11,12 +12,18 @@ from ._bootstrap import _resolve_name
 from ._bootstrap import _find_spec
 
 from contextlib import contextmanager
+import _imp
 import functools
 import sys
 import types
 import warnings
 
 
+def source_hash(source_bytes):
+    "Return the hash of *source_bytes* as used in hash-based pyc files."
+    return _imp.source_hash(_RAW_MAGIC_NUMBER, source_bytes)
+
+
 def resolve_name(name, package):
     """Resolve a relative module name to an absolute one."""
     if not name.startswith('.'):
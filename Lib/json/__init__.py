@@ -97,12 +97,14 @@ Using json.tool from the shell to validate and pretty-print::
 """
 __version__ = '2.0.9'
 __all__ = [
-    'dump', 'dumps', 'load', 'loads',
+    'dump', 'dumps', 'dumps_bytes', 'load', 'loads', 'iterload',
     'JSONDecoder', 'JSONEncoder',
 ]
 
 __author__ = 'Bob Ippolito <bob@redivi.com>'
 
+import io
+
 from .decoder import JSONDecoder
 from .encoder import JSONEncoder
 
@@ -122,6 +124,9 @@ def dump(obj, fp, skipkeys=False, ensure_ascii=True, check_circular=True,
     """Serialize ``obj`` as a JSON formatted stream to ``fp`` (a
     ``.write()``-supporting file-like object).
 
+    If ``fp`` is a binary file (an ``io.BufferedIOBase`` instance), the
+    document is written to it encoded to UTF-8, as by ``dumps_bytes()``.
+
     If ``skipkeys`` is true then ``dict`` keys that are not basic types
     (``str``, ``int``, ``float``, ``bool``, ``None``) will be skipped
     instead of raising a ``TypeError``.
@@ -165,17 +170,25 @@ def dump(obj, fp, skipkeys=False, ensure_ascii=True, check_circular=True,
         check_circular and allow_nan and
         cls is None and indent is None and separators is None and
         default is None and not sort_keys and not kw):
-        iterable = _default_encoder.iterencode(obj)
+        encoder = _default_encoder
     else:
         if cls is None:
             cls = JSONEncoder
-        iterable = cls(skipkeys=skipkeys, ensure_ascii=ensure_ascii,
+        encoder = cls(skipkeys=skipkeys, ensure_ascii=ensure_ascii,
             check_circular=check_circular, allow_nan=allow_nan, indent=indent,
             separators=separators,
-            default=default, sort_keys=sort_keys, **kw).iterencode(obj)
+            default=default, sort_keys=sort_keys, **kw)
+    if isinstance(fp, io.BufferedIOBase):
+        if type(encoder) is JSONEncoder:
+            fp.write(encoder.encode_bytes(obj))
+        else:
+            # Go through iterencode(), which the subclass may override
+            for chunk in encoder.iterencode(obj):
+                fp.write(chunk.encode('utf-8'))
+        return
     # could accelerate with writelines in some versions of Python, at
     # a debuggability cost
-    for chunk in iterable:
+    for chunk in encoder.iterencode(obj):
         fp.write(chunk)
 
 
@@ -237,6 +250,32 @@ def dumps(obj, skipkeys=False, ensure_ascii=True, check_circular=True,
         **kw).encode(obj)
 
 
+def dumps_bytes(obj, skipkeys=False, ensure_ascii=True, check_circular=True,
+        allow_nan=True, cls=None, indent=None, separators=None,
+        default=None, sort_keys=False, **kw):
+    """Serialize ``obj`` to a JSON formatted ``bytes`` object encoded to
+    UTF-8.
+
+    The arguments have the same meaning as in ``dumps()``.  The result is
+    equal to ``dumps(obj, ...).encode('utf-8')``, but the C accelerator
+    writes the UTF-8 output directly instead of building a ``str`` first.
+
+    """
+    # cached encoder
+    if (not skipkeys and ensure_ascii and
+        check_circular and allow_nan and
+        cls is None and indent is None and separators is None and
+        default is None and not sort_keys and not kw):
+        return _default_encoder.encode_bytes(obj)
+    if cls is None:
+        cls = JSONEncoder
+    return cls(
+        skipkeys=skipkeys, ensure_ascii=ensure_ascii,
+        check_circular=check_circular, allow_nan=allow_nan, indent=indent,
+        separators=separators, default=default, sort_keys=sort_keys,
+        **kw).encode_bytes(obj)
+
+
 _default_decoder = JSONDecoder(object_hook=None, object_pairs_hook=None)
 
 
@@ -329,3 +368,44 @@ def loads(s, encoding=None, cls=None, object_hook=None, parse_float=None,
     if parse_constant is not None:
         kw['parse_constant'] = parse_constant
     return cls(**kw).decode(s)
+
+
+def iterload(fp, *, mode='values', cls=None, object_hook=None,
+        parse_float=None, parse_int=None, parse_constant=None,
+        object_pairs_hook=None, chunk_size=65536, **kw):
+    """Iterate over the JSON values read incrementally from ``fp``, a
+    ``.read()``-supporting file-like object containing a stream of JSON
+    documents separated by whitespace (for example JSON Lines).
+
+    ``fp`` may be opened in binary mode (the stream must be encoded to
+    UTF-8) or in text mode.  It is read by chunks of ``chunk_size``, so that
+    a large stream is never held in memory at once.
+
+    ``mode`` is ``'values'`` to yield the top-level values, ``'items'`` to
+    yield the elements of top-level arrays one at a time, or ``'events'`` to
+    yield ``(event, value)`` tuples; see :meth:`JSONDecoder.stream_parser`.
+
+    The other arguments have the same meaning as in ``load()``.
+
+    """
+    if cls is None:
+        cls = JSONDecoder
+    if object_hook is not None:
+        kw['object_hook'] = object_hook
+    if object_pairs_hook is not None:
+        kw['object_pairs_hook'] = object_pairs_hook
+    if parse_float is not None:
+        kw['parse_float'] = parse_float
+    if parse_int is not None:
+        kw['parse_int'] = parse_int
+    if parse_constant is not None:
+        kw['parse_constant'] = parse_constant
+    parser = cls(**kw).stream_parser(mode)
+    while True:
+        chunk = fp.read(chunk_size)
+        if not chunk:
+            break
+        if isinstance(chunk, str):
+            chunk = chunk.encode('utf-8')
+        yield from parser.feed(chunk)
+    yield from parser.close()
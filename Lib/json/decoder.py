@@ -360,3 +360,20 @@ class JSONDecoder(object):
         except StopIteration as err:
             raise ValueError(errmsg("Expecting value", s, err.value)) from None
         return obj, end
+
+    def stream_parser(self, mode='values'):
+        """Return an incremental parser for a stream of JSON values
+        encoded to UTF-8, using the options of this decoder.
+
+        Feed the parser chunks of ``bytes`` with its ``feed()`` method,
+        which returns the list of values completed by the chunk, and call
+        its ``close()`` method at the end of the stream.  Values may be
+        separated by whitespace, as in the JSON Lines format.
+
+        ``mode`` selects what is returned: ``'values'`` returns the top-level
+        values, ``'items'`` returns the elements of top-level arrays as soon
+        as they are complete, and ``'events'`` returns ``(event, value)``
+        tuples without building any container.
+
+        """
+        return scanner.make_stream_parser(self, mode)
@@ -5,8 +5,12 @@ try:
     from _json import make_scanner as c_make_scanner
 except ImportError:
     c_make_scanner = None
+try:
+    from _json import make_stream_parser as c_make_stream_parser
+except ImportError:
+    c_make_stream_parser = None
 
-__all__ = ['make_scanner']
+__all__ = ['make_scanner', 'make_stream_parser']
 
 NUMBER_RE = re.compile(
     r'(-?(?:0|[1-9]\d*))(\.\d+)?([eE][-+]?\d+)?',
@@ -71,3 +75,324 @@ def py_make_scanner(context):
     return _scan_once
 
 make_scanner = c_make_scanner or py_make_scanner
+
+
+# States of the stream parser
+_VALUE = 0          # expecting a value
+_ARRAY_FIRST = 1    # after '[': expecting a value or ']'
+_OBJECT_FIRST = 2   # after '{': expecting a key or '}'
+_KEY = 3            # after ',' in an object: expecting a key
+_COLON = 4          # after a key: expecting ':'
+_COMMA = 5          # after an item: expecting ',' or the end
+_SEPARATOR = 6      # after a top-level value: expecting whitespace
+
+_EXPECTING = [
+    "Expecting value",
+    "Expecting value",
+    "Expecting property name enclosed in double quotes",
+    "Expecting property name enclosed in double quotes",
+    "Expecting ':' delimiter",
+    "Expecting ',' delimiter",
+    "Extra data",
+]
+
+_STREAM_MEMO_MAX = 4096
+
+WHITESPACE_BYTES = re.compile(rb'[ \t\n\r]*')
+NUMBER_BYTES_RE = re.compile(rb'(-?(?:0|[1-9]\d*))(\.\d+)?([eE][-+]?\d+)?')
+NUMBER_CHARS = re.compile(rb'[-+.eE0-9]*')
+CONTROL_BYTES = re.compile(rb'[\x00-\x1f]')
+LITERALS = {
+    ord('t'): (b'true', True, False),
+    ord('f'): (b'false', False, False),
+    ord('n'): (b'null', None, False),
+    ord('N'): (b'NaN', 'NaN', True),
+    ord('I'): (b'Infinity', 'Infinity', True),
+}
+
+
+class py_make_stream_parser(object):
+    """Incremental parser for a stream of JSON values encoded to UTF-8.
+
+    The parser is a state machine over the bytes fed but not consumed yet:
+    it stops at the beginning of an incomplete token until more data is fed.
+    Containers being built are kept on an explicit stack, with the pending
+    key of each object pushed on top of it.
+    """
+
+    def __init__(self, context, mode='values'):
+        if mode not in ('values', 'items', 'events'):
+            raise ValueError('invalid mode: %r' % (mode,))
+        self._mode = mode
+        self._events = mode == 'events'
+        self._base = 1 if mode == 'items' else 0
+        self._strict = context.strict
+        self._object_hook = context.object_hook
+        self._object_pairs_hook = context.object_pairs_hook
+        self._parse_float = context.parse_float
+        self._parse_int = context.parse_int
+        self._parse_constant = context.parse_constant
+        self._parse_string = context.parse_string
+        self._memo = context.memo
+        self._parsing = False
+        self._reset()
+
+    def _reset(self):
+        self._state = _VALUE
+        self._buf = bytearray()
+        self._pos = 0
+        self._consumed = 0
+        self._lineno = 1
+        self._linestart = 0
+        self._scan_pos = 0
+        self._kinds = []
+        self._stack = []
+
+    def feed(self, data):
+        """Parse the bytes-like object data and return the values
+        completed by it."""
+        if self._parsing:
+            raise RuntimeError('reentrant call to feed()')
+        data = memoryview(data).cast('B')
+        if self._pos:
+            del self._buf[:self._pos]
+            self._consumed += self._pos
+            if self._scan_pos:
+                self._scan_pos -= self._pos
+            self._pos = 0
+        self._buf += data
+        return self._run(False)
+
+    def close(self):
+        """Return the values left at the end of the stream, and reset the
+        parser.  Raise ValueError if the stream ends in the middle of a
+        value."""
+        if self._parsing:
+            raise RuntimeError('reentrant call to close()')
+        result = self._run(True)
+        self._reset()
+        return result
+
+    def _run(self, final):
+        self._result = result = []
+        self._parsing = True
+        try:
+            self._parse(final)
+            if final and self._kinds:
+                self._error(_EXPECTING[self._state], len(self._buf))
+        except:
+            self._reset()
+            raise
+        finally:
+            self._parsing = False
+            self._result = None
+        return result
+
+    def _error(self, msg, idx):
+        offset = self._consumed + idx
+        raise ValueError('%s: line %d column %d (byte %d)'
+                         % (msg, self._lineno, offset - self._linestart + 1,
+                            offset))
+
+    def _emit(self, obj):
+        self._result.append(obj)
+        if len(self._memo) > _STREAM_MEMO_MAX:
+            self._memo.clear()
+
+    def _item_done(self):
+        self._state = _COMMA if self._kinds else _SEPARATOR
+
+    def _add_value(self, value):
+        self._item_done()
+        if len(self._kinds) == self._base:
+            self._emit(value)
+        elif self._kinds[-1] == '[':
+            self._stack[-1].append(value)
+        else:
+            key = self._stack.pop()
+            if self._object_pairs_hook is not None:
+                self._stack[-1].append((key, value))
+            else:
+                self._stack[-1][key] = value
+
+    def _scalar(self, value):
+        if self._events:
+            self._item_done()
+            self._emit(('value', value))
+        else:
+            self._add_value(value)
+
+    def _start_container(self, kind):
+        if self._events:
+            self._emit(('start_array' if kind == '[' else 'start_object', None))
+        elif len(self._kinds) >= self._base:
+            if kind == '[' or self._object_pairs_hook is not None:
+                self._stack.append([])
+            else:
+                self._stack.append({})
+        self._kinds.append(kind)
+        self._state = _ARRAY_FIRST if kind == '[' else _OBJECT_FIRST
+
+    def _end_container(self):
+        kind = self._kinds.pop()
+        if self._events:
+            self._item_done()
+            self._emit(('end_array' if kind == '[' else 'end_object', None))
+        elif len(self._kinds) < self._base:
+            # end of a top-level array in items mode
+            self._item_done()
+        else:
+            container = self._stack.pop()
+            if kind == '{':
+                if self._object_pairs_hook is not None:
+                    container = self._object_pairs_hook(container)
+                elif self._object_hook is not None:
+                    container = self._object_hook(container)
+            self._add_value(container)
+
+    def _scan_string(self, start, final):
+        # Return the index of the closing quote of the string starting at
+        # start, or -1 if it is incomplete.
+        buf = self._buf
+        i = self._scan_pos or start + 1
+        while True:
+            end = buf.find(b'"', i)
+            if end < 0:
+                if final:
+                    self._error("Unterminated string starting at", start)
+                self._scan_pos = len(buf)
+                return -1
+            k = end - 1
+            while buf[k] == 0x5c:
+                k -= 1
+            if (end - k) % 2:
+                break
+            i = end + 1
+        self._scan_pos = 0
+        if self._strict:
+            m = CONTROL_BYTES.search(buf, start + 1, end)
+            if m is not None:
+                self._error("Invalid control character at", m.start())
+        return end
+
+    def _decode_string(self, start, end):
+        buf = self._buf
+        if buf.find(b'\\', start + 1, end) < 0:
+            return buf[start + 1:end].decode('utf-8')
+        raw = buf[start:end + 1].decode('utf-8')
+        return self._parse_string(raw, 1, self._strict)[0]
+
+    def _parse_value(self, idx, final):
+        # Parse the value starting at idx, return the index following it or
+        # -1 if it is incomplete.
+        buf = self._buf
+        c = buf[idx]
+        if self._base and not self._kinds and c != 0x5b:
+            self._error("Expecting '['", idx)
+        if c == 0x7b or c == 0x5b:
+            self._start_container(chr(c))
+            return idx + 1
+        if c == 0x22:
+            end = self._scan_string(idx, final)
+            if end < 0:
+                return -1
+            self._scalar(self._decode_string(idx, end))
+            return end + 1
+        if c in LITERALS:
+            literal, value, constant = LITERALS[c]
+            avail = buf[idx:idx + len(literal)]
+            if avail == literal:
+                self._scalar(self._parse_constant(value) if constant
+                             else value)
+                return idx + len(literal)
+            if not final and literal.startswith(avail):
+                return -1
+        elif c == 0x2d or 0x30 <= c <= 0x39:
+            if c == 0x2d:
+                avail = buf[idx:idx + 9]
+                if avail == b'-Infinity':
+                    self._scalar(self._parse_constant('-Infinity'))
+                    return idx + 9
+                if not final and b'-Infinity'.startswith(avail):
+                    return -1
+            # The number may continue in the next chunk
+            if NUMBER_CHARS.match(buf, idx).end() == len(buf) and not final:
+                return -1
+            m = NUMBER_BYTES_RE.match(buf, idx)
+            if m is not None:
+                integer, frac, exp = m.groups()
+                if frac or exp:
+                    res = self._parse_float(
+                        (integer + (frac or b'') + (exp or b'')).decode())
+                else:
+                    res = self._parse_int(integer.decode())
+                self._scalar(res)
+                return m.end()
+        self._error("Expecting value", idx)
+
+    def _parse(self, final):
+        buf = self._buf
+        idx = self._pos
+        try:
+            while True:
+                end = WHITESPACE_BYTES.match(buf, idx).end()
+                if end != idx:
+                    nl = buf.rfind(b'\n', idx, end)
+                    if nl >= 0:
+                        self._lineno += buf.count(b'\n', idx, end)
+                        self._linestart = self._consumed + nl + 1
+                    idx = end
+                    if self._state == _SEPARATOR:
+                        self._state = _VALUE
+                if idx >= len(buf):
+                    break
+                c = buf[idx]
+                state = self._state
+                if state == _SEPARATOR:
+                    # Top-level values are separated by whitespace
+                    self._error("Extra data", idx)
+                elif state == _COLON:
+                    if c != 0x3a:
+                        self._error("Expecting ':' delimiter", idx)
+                    idx += 1
+                    self._state = _VALUE
+                elif state == _COMMA:
+                    kind = self._kinds[-1]
+                    if c == 0x2c:
+                        idx += 1
+                        self._state = _VALUE if kind == '[' else _KEY
+                    elif c == (0x5d if kind == '[' else 0x7d):
+                        idx += 1
+                        self._end_container()
+                    else:
+                        self._error("Expecting ',' delimiter", idx)
+                elif state == _OBJECT_FIRST and c == 0x7d:
+                    idx += 1
+                    self._end_container()
+                elif state == _OBJECT_FIRST or state == _KEY:
+                    if c != 0x22:
+                        self._error("Expecting property name enclosed in "
+                                    "double quotes", idx)
+                    end = self._scan_string(idx, final)
+                    if end < 0:
+                        break
+                    key = self._decode_string(idx, end)
+                    key = self._memo.setdefault(key, key)
+                    if self._events:
+                        self._emit(('key', key))
+                    else:
+                        self._stack.append(key)
+                    idx = end + 1
+                    self._state = _COLON
+                elif state == _ARRAY_FIRST and c == 0x5d:
+                    idx += 1
+                    self._end_container()
+                else:
+                    end = self._parse_value(idx, final)
+                    if end < 0:
+                        break
+                    idx = end
+        finally:
+            self._pos = idx
+
+make_stream_parser = c_make_stream_parser or py_make_stream_parser
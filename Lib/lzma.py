@@ -47,7 +47,8 @@ class LZMAFile(io.BufferedIOBase):
     """
 
     def __init__(self, filename=None, mode="r", *,
-                 format=None, check=-1, preset=None, filters=None):
+                 format=None, check=-1, preset=None, filters=None,
+                 threads=1):
         """Open an LZMA-compressed file in binary mode.
 
         filename can be either an actual file name (given as a str or
@@ -88,6 +89,9 @@ class LZMAFile(io.BufferedIOBase):
         filters (if provided) should be a sequence of dicts. Each dict
         should have an entry for "id" indicating ID of the filter, plus
         additional entries for options to the filter.
+
+        threads is the number of threads compressing the data when
+        writing a FORMAT_XZ file, or 0 for one per CPU.
         """
         self._fp = None
         self._closefp = False
@@ -102,6 +106,9 @@ class LZMAFile(io.BufferedIOBase):
             if preset is not None:
                 raise ValueError("Cannot specify a preset compression "
                                  "level when opening a file for reading")
+            if threads != 1:
+                raise ValueError("Cannot specify threads "
+                                 "when opening a file for reading")
             if format is None:
                 format = FORMAT_AUTO
             mode_code = _MODE_READ
@@ -117,7 +124,8 @@ class LZMAFile(io.BufferedIOBase):
                 format = FORMAT_XZ
             mode_code = _MODE_WRITE
             self._compressor = LZMACompressor(format=format, check=check,
-                                              preset=preset, filters=filters)
+                                              preset=preset, filters=filters,
+                                              threads=threads)
         else:
             raise ValueError("Invalid mode: {!r}".format(mode))
 
@@ -426,7 +434,7 @@ class LZMAFile(io.BufferedIOBase):
 
 def open(filename, mode="rb", *,
          format=None, check=-1, preset=None, filters=None,
-         encoding=None, errors=None, newline=None):
+         encoding=None, errors=None, newline=None, threads=1):
     """Open an LZMA-compressed file in binary or text mode.
 
     filename can be either an actual file name (given as a str or bytes
@@ -437,7 +445,7 @@ def open(filename, mode="rb", *,
     "a", or "ab" for binary mode, or "rt", "wt", "xt", or "at" for text
     mode.
 
-    The format, check, preset and filters arguments specify the
+    The format, check, preset, filters and threads arguments specify the
     compression settings, as for LZMACompressor, LZMADecompressor and
     LZMAFile.
 
@@ -463,7 +471,7 @@ def open(filename, mode="rb", *,
 
     lz_mode = mode.replace("t", "")
     binary_file = LZMAFile(filename, lz_mode, format=format, check=check,
-                           preset=preset, filters=filters)
+                           preset=preset, filters=filters, threads=threads)
 
     if "t" in mode:
         return io.TextIOWrapper(binary_file, encoding, errors, newline)
@@ -471,15 +479,17 @@ def open(filename, mode="rb", *,
         return binary_file
 
 
-def compress(data, format=FORMAT_XZ, check=-1, preset=None, filters=None):
+def compress(data, format=FORMAT_XZ, check=-1, preset=None, filters=None,
+             threads=1):
     """Compress a block of data.
 
     Refer to LZMACompressor's docstring for a description of the
-    optional arguments *format*, *check*, *preset* and *filters*.
+    optional arguments *format*, *check*, *preset*, *filters* and
+    *threads*.
 
     For incremental compression, use an LZMACompressor instead.
     """
-    comp = LZMACompressor(format, check, preset, filters)
+    comp = LZMACompressor(format, check, preset, filters, threads)
     return comp.compress(data) + comp.flush()
 
 
@@ -11,6 +11,7 @@ __all__ = [ 'Client', 'Listener', 'Pipe', 'wait' ]
 
 import io
 import os
+import pickle
 import sys
 import socket
 import struct
@@ -199,11 +200,33 @@ class _ConnectionBase:
             raise ValueError("buffer length < offset + size")
         self._send_bytes(m[offset:offset + size])
 
+    # Buffers at least this large are sent out-of-band by send(), as
+    # separate messages following the pickle data.
+    _buffer_threshold = 64 * 1024
+
     def send(self, obj):
         """Send a (picklable) object"""
         self._check_closed()
         self._check_writable()
-        self._send_bytes(ForkingPickler.dumps(obj))
+        buffers = []
+        def buffer_callback(buf):
+            with buf.raw() as m:
+                if m.nbytes < self._buffer_threshold:
+                    return True
+            buffers.append(buf)
+            return False
+        data = ForkingPickler.dumps(obj, pickle.HIGHEST_PROTOCOL,
+                                    buffer_callback=buffer_callback)
+        if not buffers:
+            self._send_bytes(data)
+            return
+        # A pickle never starts with a null byte: this header announces
+        # the number of out-of-band buffers following the pickle data.
+        self._send_bytes(b'\0' + struct.pack("!i", len(buffers)))
+        self._send_bytes(data)
+        for buf in buffers:
+            with buf.raw() as m:
+                self._send_bytes(m)
 
     def recv_bytes(self, maxlength=None):
         """
@@ -248,7 +271,16 @@ class _ConnectionBase:
         self._check_closed()
         self._check_readable()
         buf = self._recv_bytes()
-        return ForkingPickler.loads(buf.getbuffer())
+        buffers = None
+        if buf.tell() == 5 and buf.getbuffer()[0] == 0:
+            n, = struct.unpack("!i", buf.getvalue()[1:])
+            buf = self._recv_bytes()
+            buffers = [self._recv_buffer() for i in range(n)]
+        return ForkingPickler.loads(buf.getbuffer(), buffers=buffers)
+
+    def _recv_buffer(self):
+        # Receive an out-of-band buffer sent by send()
+        return self._recv_bytes().getbuffer()
 
     def poll(self, timeout=0.0):
         """Whether there is any input available to be read"""
@@ -416,6 +448,25 @@ class Connection(_ConnectionBase):
             return None
         return self._recv(size)
 
+    if not _winapi:
+        def _recv_buffer(self, readv=os.readv):
+            # Read the payload directly into the bytearray handed to the
+            # unpickler, without going through an intermediate BytesIO.
+            size, = struct.unpack("!i", self._recv(4).getvalue())
+            buf = bytearray(size)
+            m = memoryview(buf)
+            handle = self._handle
+            pos = 0
+            while pos < size:
+                try:
+                    n = readv(handle, [m[pos:]])
+                except InterruptedError:
+                    continue
+                if n == 0:
+                    raise OSError("got end of file during message")
+                pos += n
+            return buf
+
     def _poll(self, timeout):
         r = wait([self], timeout)
         return bool(r)
@@ -34,10 +34,6 @@ from . import get_context
 # Register some things for pickling
 #
 
-def reduce_array(a):
-    return array.array, (a.typecode, a.tobytes())
-reduction.register(array.array, reduce_array)
-
 view_types = [type(getattr({}, name)()) for name in ('items','keys','values')]
 if view_types[0] is not list:       # only needed in Py3.0
     def rebuild_as_list(obj):
@@ -7,6 +7,7 @@
 # Licensed to PSF under a Contributor Agreement.
 #
 
+import array
 import copyreg
 import functools
 import io
@@ -32,11 +33,14 @@ HAVE_SEND_HANDLE = (sys.platform == 'win32' or
 class ForkingPickler(pickle.Pickler):
     '''Pickler subclass used by multiprocessing.'''
     _extra_reducers = {}
+    _buffer_reducers = {}
     _copyreg_dispatch_table = copyreg.dispatch_table
 
-    def __init__(self, *args):
-        super().__init__(*args)
+    def __init__(self, *args, **kwds):
+        super().__init__(*args, **kwds)
         self.dispatch_table = self._copyreg_dispatch_table.copy()
+        if kwds.get('buffer_callback') is not None:
+            self.dispatch_table.update(self._buffer_reducers)
         self.dispatch_table.update(self._extra_reducers)
 
     @classmethod
@@ -45,9 +49,9 @@ class ForkingPickler(pickle.Pickler):
         cls._extra_reducers[type] = reduce
 
     @classmethod
-    def dumps(cls, obj, protocol=None):
+    def dumps(cls, obj, protocol=None, buffer_callback=None):
         buf = io.BytesIO()
-        cls(buf, protocol).dump(obj)
+        cls(buf, protocol, buffer_callback=buffer_callback).dump(obj)
         return buf.getbuffer()
 
     loads = pickle.loads
@@ -58,6 +62,30 @@ def dump(obj, file, protocol=None):
     '''Replacement for pickle.dump() using ForkingPickler.'''
     ForkingPickler(file, protocol).dump(obj)
 
+#
+# Reducers exposing the memory of common buffer types as out-of-band
+# buffers; only used when the pickler has a buffer_callback
+#
+
+def _rebuild_bytearray(buf):
+    if type(buf) is bytearray:
+        return buf
+    return bytearray(buf)
+
+def _reduce_bytearray(b):
+    return _rebuild_bytearray, (pickle.PickleBuffer(b),)
+
+def _rebuild_array(typecode, buf):
+    a = array.array(typecode)
+    a.frombytes(buf)
+    return a
+
+def _reduce_array(a):
+    return _rebuild_array, (a.typecode, pickle.PickleBuffer(a))
+
+ForkingPickler._buffer_reducers[bytearray] = _reduce_bytearray
+ForkingPickler._buffer_reducers[array.array] = _reduce_array
+
 #
 # Platform specific definitions
 #
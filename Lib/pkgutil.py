@@ -40,7 +40,7 @@ def read_code(stream):
     if magic != importlib.util.MAGIC_NUMBER:
         return None
 
-    stream.read(8) # Skip timestamp and size
+    stream.read(12) # Skip flags and timestamp/size or source hash
     return marshal.load(stream)
 
 
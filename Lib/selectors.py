@@ -7,6 +7,7 @@ This module allows high-level and efficient I/O multiplexing, built upon the
 
 from abc import ABCMeta, abstractmethod
 from collections import namedtuple, Mapping
+import errno
 import math
 import select
 import sys
@@ -326,29 +327,67 @@ class SelectSelector(_BaseSelectorImpl):
         return ready
 
 
-if hasattr(select, 'poll'):
+class _PollLikeSelector(_BaseSelectorImpl):
+    """Base class shared between poll, epoll and devpoll selectors."""
+    _selector_cls = None
+    _EVENT_READ = None
+    _EVENT_WRITE = None
 
-    class PollSelector(_BaseSelectorImpl):
-        """Poll-based selector."""
+    def __init__(self):
+        super().__init__()
+        self._selector = self._selector_cls()
 
-        def __init__(self):
-            super().__init__()
-            self._poll = select.poll()
+    def _poller_events(self, events):
+        poller_events = 0
+        if events & EVENT_READ:
+            poller_events |= self._EVENT_READ
+        if events & EVENT_WRITE:
+            poller_events |= self._EVENT_WRITE
+        return poller_events
 
-        def register(self, fileobj, events, data=None):
-            key = super().register(fileobj, events, data)
-            poll_events = 0
-            if events & EVENT_READ:
-                poll_events |= select.POLLIN
-            if events & EVENT_WRITE:
-                poll_events |= select.POLLOUT
-            self._poll.register(key.fd, poll_events)
-            return key
+    def register(self, fileobj, events, data=None):
+        key = super().register(fileobj, events, data)
+        self._selector.register(key.fd, self._poller_events(events))
+        return key
 
-        def unregister(self, fileobj):
-            key = super().unregister(fileobj)
-            self._poll.unregister(key.fd)
-            return key
+    def unregister(self, fileobj):
+        key = super().unregister(fileobj)
+        try:
+            self._selector.unregister(key.fd)
+        except OSError as exc:
+            # This can happen if the FD was closed since it was registered
+            # (EBADF), or closed and reused for another file (ENOENT).
+            if exc.errno not in (errno.EBADF, errno.ENOENT):
+                raise
+        return key
+
+    def modify(self, fileobj, events, data=None):
+        try:
+            key = self._fd_to_key[self._fileobj_lookup(fileobj)]
+        except KeyError:
+            raise KeyError("{!r} is not registered".format(fileobj)) from None
+        if events != key.events:
+            if (not events) or (events & ~(EVENT_READ | EVENT_WRITE)):
+                raise ValueError("Invalid events: {!r}".format(events))
+            # Update the interest set of the kernel object in place with a
+            # single system call, rather than unregister() + register().
+            self._selector.modify(key.fd, self._poller_events(events))
+            key = key._replace(events=events, data=data)
+            self._fd_to_key[key.fd] = key
+        elif data != key.data:
+            # Use a shortcut to update the data.
+            key = key._replace(data=data)
+            self._fd_to_key[key.fd] = key
+        return key
+
+
+if hasattr(select, 'poll'):
+
+    class PollSelector(_PollLikeSelector):
+        """Poll-based selector."""
+        _selector_cls = select.poll
+        _EVENT_READ = select.POLLIN
+        _EVENT_WRITE = select.POLLOUT
 
         def select(self, timeout=None):
             if timeout is None:
@@ -361,7 +400,7 @@ if hasattr(select, 'poll'):
                 timeout = math.ceil(timeout * 1e3)
             ready = []
             try:
-                fd_event_list = self._poll.poll(timeout)
+                fd_event_list = self._selector.poll(timeout)
             except InterruptedError:
                 return ready
             for fd, event in fd_event_list:
@@ -379,35 +418,14 @@ if hasattr(select, 'poll'):
 
 if hasattr(select, 'epoll'):
 
-    class EpollSelector(_BaseSelectorImpl):
+    class EpollSelector(_PollLikeSelector):
         """Epoll-based selector."""
-
-        def __init__(self):
-            super().__init__()
-            self._epoll = select.epoll()
+        _selector_cls = select.epoll
+        _EVENT_READ = select.EPOLLIN
+        _EVENT_WRITE = select.EPOLLOUT
 
         def fileno(self):
-            return self._epoll.fileno()
-
-        def register(self, fileobj, events, data=None):
-            key = super().register(fileobj, events, data)
-            epoll_events = 0
-            if events & EVENT_READ:
-                epoll_events |= select.EPOLLIN
-            if events & EVENT_WRITE:
-                epoll_events |= select.EPOLLOUT
-            self._epoll.register(key.fd, epoll_events)
-            return key
-
-        def unregister(self, fileobj):
-            key = super().unregister(fileobj)
-            try:
-                self._epoll.unregister(key.fd)
-            except OSError:
-                # This can happen if the FD was closed since it
-                # was registered.
-                pass
-            return key
+            return self._selector.fileno()
 
         def select(self, timeout=None):
             if timeout is None:
@@ -426,7 +444,7 @@ if hasattr(select, 'epoll'):
 
             ready = []
             try:
-                fd_event_list = self._epoll.poll(timeout, max_ev)
+                fd_event_list = self._selector.poll(timeout, max_ev)
             except InterruptedError:
                 return ready
             for fd, event in fd_event_list:
@@ -442,36 +460,20 @@ if hasattr(select, 'epoll'):
             return ready
 
         def close(self):
-            self._epoll.close()
+            self._selector.close()
             super().close()
 
 
 if hasattr(select, 'devpoll'):
 
-    class DevpollSelector(_BaseSelectorImpl):
+    class DevpollSelector(_PollLikeSelector):
         """Solaris /dev/poll selector."""
-
-        def __init__(self):
-            super().__init__()
-            self._devpoll = select.devpoll()
+        _selector_cls = select.devpoll
+        _EVENT_READ = select.POLLIN
+        _EVENT_WRITE = select.POLLOUT
 
         def fileno(self):
-            return self._devpoll.fileno()
-
-        def register(self, fileobj, events, data=None):
-            key = super().register(fileobj, events, data)
-            poll_events = 0
-            if events & EVENT_READ:
-                poll_events |= select.POLLIN
-            if events & EVENT_WRITE:
-                poll_events |= select.POLLOUT
-            self._devpoll.register(key.fd, poll_events)
-            return key
-
-        def unregister(self, fileobj):
-            key = super().unregister(fileobj)
-            self._devpoll.unregister(key.fd)
-            return key
+            return self._selector.fileno()
 
         def select(self, timeout=None):
             if timeout is None:
@@ -484,7 +486,7 @@ if hasattr(select, 'devpoll'):
                 timeout = math.ceil(timeout * 1e3)
             ready = []
             try:
-                fd_event_list = self._devpoll.poll(timeout)
+                fd_event_list = self._selector.poll(timeout)
             except InterruptedError:
                 return ready
             for fd, event in fd_event_list:
@@ -500,7 +502,7 @@ if hasattr(select, 'devpoll'):
             return ready
 
         def close(self):
-            self._devpoll.close()
+            self._selector.close()
             super().close()
 
 
@@ -409,9 +409,62 @@ def _generate_overlap_table(prefix):
             table[i] = idx + 1
     return table
 
+def _sequence(data):
+    # internal: the items of a sequence, with groups expanded in place
+    for op, av in data:
+        if op is SUBPATTERN:
+            yield from _sequence(av[1].data)
+        else:
+            yield op, av
+
+def _has_groupref(op, av):
+    # internal: check if an item contains a backreference, whose width
+    # isn't counted by getwidth()
+    if op is GROUPREF or op is GROUPREF_EXISTS:
+        return True
+    if op is SUBPATTERN:
+        subpatterns = [av[1]]
+    elif op is BRANCH:
+        subpatterns = av[1]
+    elif op in _REPEATING_CODES:
+        subpatterns = [av[2]]
+    else:
+        return False
+    return any(_has_groupref(op, av)
+               for p in subpatterns for op, av in p.data)
+
+def _get_required(pattern):
+    # internal: find the longest run of literals contained in every match,
+    # and its minimal and maximal offset from the start of the match (the
+    # maximal one is MAXREPEAT if unbounded)
+    required = []
+    offset = (0, 0)
+    run = []
+    lo = hi = 0
+    for op, av in _sequence(pattern.data):
+        if op is LITERAL:
+            if not run:
+                start = lo, hi
+            run.append(av)
+            if len(run) > len(required):
+                required = run
+                offset = start
+            lo += 1
+            hi += 1
+        else:
+            run = []
+            i, j = sre_parse.SubPattern(pattern.pattern, [(op, av)]).getwidth()
+            if _has_groupref(op, av):
+                j = MAXREPEAT
+            lo += i
+            hi += j
+    lo, hi = offset
+    return required, min(lo, MAXREPEAT - 1), min(hi, MAXREPEAT)
+
 def _compile_info(code, pattern, flags):
     # internal: compile an info block.  in the current version,
-    # this contains min/max pattern width, and an optional literal
+    # this contains min/max pattern width, an optional literal
+    # found anywhere in the pattern, and an optional literal
     # prefix or a character map
     lo, hi = pattern.getwidth()
     if lo == 0:
@@ -472,10 +525,18 @@ def _compile_info(code, pattern, flags):
                     charset = c
             elif op is IN:
                 charset = av
+    # look for a literal elsewhere in the pattern
+    required = []
+    if not (flags & SRE_FLAG_IGNORECASE):
+        required, required_lo, required_hi = _get_required(pattern)
+        if len(required) <= len(prefix):
+            required = []
 ##     if prefix:
 ##         print("*** PREFIX", prefix, prefix_skip)
 ##     if charset:
 ##         print("*** CHARSET", charset)
+##     if required:
+##         print("*** REQUIRED", required, required_lo, required_hi)
     # add an info block
     emit = code.append
     emit(INFO)
@@ -488,6 +549,8 @@ def _compile_info(code, pattern, flags):
             mask = mask | SRE_INFO_LITERAL
     elif charset:
         mask = mask | SRE_INFO_CHARSET
+    if required:
+        mask = mask | SRE_INFO_REQUIRED
     emit(mask)
     # pattern length
     if lo < MAXCODE:
@@ -499,6 +562,12 @@ def _compile_info(code, pattern, flags):
         emit(hi)
     else:
         emit(0)
+    # add required literal
+    if required:
+        emit(len(required)) # length
+        emit(required_lo) # minimal offset
+        emit(required_hi) # maximal offset
+        code.extend(required)
     # add literal prefix
     if prefix:
         emit(len(prefix)) # length
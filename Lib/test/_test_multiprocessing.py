@@ -2194,6 +2194,40 @@ class _TestConnection(BaseTestCase):
 
         p.join()
 
+    @classmethod
+    def _echo_objects(cls, conn):
+        for obj in iter(conn.recv, SENTINEL):
+            conn.send(obj)
+        conn.close()
+
+    def test_send_recv_buffers(self):
+        conn, child_conn = self.Pipe()
+
+        p = self.Process(target=self._echo_objects, args=(child_conn,))
+        p.daemon = True
+        p.start()
+
+        # Large buffers are sent out-of-band
+        big = [bytearray(b'x' * 100000), array.array('d', range(20000)),
+               bytearray(b'small'), b'y' * 100000]
+        conn.send(big)
+        res = conn.recv()
+        self.assertEqual(res, big)
+        self.assertEqual([type(x) for x in res], [type(x) for x in big])
+
+        if self.TYPE == 'processes':
+            conn.send(big)
+            self.assertEqual(conn.recv_bytes(), b'\0' + struct.pack('!i', 2))
+            data = conn.recv_bytes()
+            self.assertNotIn(b'x' * 100, data)
+            self.assertIn(b'small', data)
+            self.assertEqual(conn.recv_bytes(), big[0])
+            self.assertEqual(conn.recv_bytes(), big[1].tobytes())
+
+        conn.send(SENTINEL)                                # tell child to quit
+        child_conn.close()
+        p.join()
+
     def test_duplex_false(self):
         reader, writer = self.Pipe(duplex=False)
         self.assertEqual(writer.send(1), None)
@@ -738,6 +738,18 @@ class AbstractPickleTests(unittest.TestCase):
             t2 = self.loads(p)
             self.assert_is_copy(t, t2)
 
+    def test_memo_many_objects(self):
+        # Enough objects to resize the memo table several times
+        objs = [(i, str(i)) for i in range(10000)]
+        data = [objs, objs[::-1]]
+        for proto in protocols:
+            loaded = self.loads(self.dumps(data, proto))
+            self.assert_is_copy(data, loaded)
+            first, second = loaded
+            for i in range(len(objs)):
+                self.assertIs(first[i], second[-1 - i])
+                self.assertIs(first[i][1], second[-1 - i][1])
+
     def test_bytes(self):
         for proto in protocols:
             for s in b'', b'xyz', b'xyz'*100:
@@ -750,6 +762,42 @@ class AbstractPickleTests(unittest.TestCase):
                 p = self.dumps(s, proto)
                 self.assert_is_copy(s, self.loads(p))
 
+    def test_bytearray(self):
+        for proto in protocols:
+            for s in b'', b'xyz', b'xyz'*100:
+                b = bytearray(s)
+                p = self.dumps(b, proto)
+                bb = self.loads(p)
+                self.assertIsNot(bb, b)
+                self.assert_is_copy(b, bb)
+                if proto >= 5:
+                    self.assertIn(pickle.BYTEARRAY8, p)
+
+    def test_truncated_bytearray(self):
+        for proto in protocols:
+            if proto < 5:
+                continue
+            for s in b'xyz' * 100, b'xyz' * 100000:
+                p = self.dumps(bytearray(s), proto)
+                pos = p.index(pickle.BYTEARRAY8)
+                # Cut in the length, then in the payload
+                for end in pos + 5, len(p) - len(s) // 2:
+                    with self.assertRaises((EOFError, pickle.UnpicklingError)):
+                        self.loads(p[:end])
+
+    def test_picklebuffer_in_band(self):
+        for s in b'', b'xyz', b'xyz'*100:
+            for proto in protocols:
+                for obj in s, bytearray(s):
+                    if proto < 5:
+                        with self.assertRaises(pickle.PicklingError):
+                            self.dumps(pickle.PickleBuffer(obj), proto)
+                        continue
+                    p = self.dumps([pickle.PickleBuffer(obj)] * 2, proto)
+                    new = self.loads(p)
+                    self.assert_is_copy(obj, new[0])
+                    self.assertIs(new[0], new[1])
+
     def test_ints(self):
         import sys
         for proto in protocols:
@@ -1501,22 +1549,32 @@ class AbstractPickleTests(unittest.TestCase):
     def check_frame_opcodes(self, pickled):
         """
         Check the arguments of FRAME opcodes in a protocol 4+ pickle.
+
+        Bytes-like payloads larger than FRAME_SIZE_TARGET are written
+        outside of any frame; every other opcode but PROTO must be framed.
         """
         frame_opcode_size = 9
-        last_arg = last_pos = None
+        frameless_opcodes = {'BINBYTES', 'BINBYTES8', 'BYTEARRAY8'}
+        frame_end = None
         for op, arg, pos in pickletools.genops(pickled):
-            if op.name != 'FRAME':
-                continue
-            if last_pos is not None:
-                # The previous frame's size should be equal to the number
-                # of bytes up to the current frame.
-                frame_size = pos - last_pos - frame_opcode_size
-                self.assertEqual(frame_size, last_arg)
-            last_arg, last_pos = arg, pos
+            if frame_end is not None:
+                self.assertLessEqual(pos, frame_end)
+                if pos == frame_end:
+                    frame_end = None
+            if frame_end is not None:
+                self.assertNotEqual(op.name, 'FRAME')
+                if op.name in frameless_opcodes:
+                    self.assertLess(len(arg), self.FRAME_SIZE_TARGET)
+            elif op.name == 'FRAME':
+                frame_end = pos + frame_opcode_size + arg
+            elif op.name in frameless_opcodes:
+                self.assertGreaterEqual(len(arg), self.FRAME_SIZE_TARGET)
+            else:
+                self.assertEqual(op.name, 'PROTO')
         # The last frame's size should be equal to the number of bytes up
         # to the pickle's end.
-        frame_size = len(pickled) - last_pos - frame_opcode_size
-        self.assertEqual(frame_size, last_arg)
+        if frame_end is not None:
+            self.assertEqual(frame_end, len(pickled))
 
     def test_framing_many_objects(self):
         obj = list(range(10**5))
@@ -1541,8 +1599,7 @@ class AbstractPickleTests(unittest.TestCase):
                 pickled = self.dumps(obj, proto)
                 unpickled = self.loads(pickled)
                 self.assertEqual(obj, unpickled)
-                n_frames = count_opcode(pickle.FRAME, pickled)
-                self.assertGreaterEqual(n_frames, len(obj))
+                # Large bytes objects are written outside of frames
                 self.check_frame_opcodes(pickled)
 
     def test_optional_frames(self):
@@ -1987,7 +2044,7 @@ class AbstractPickleModuleTests(unittest.TestCase):
 
     def test_highest_protocol(self):
         # Of course this needs to be changed when HIGHEST_PROTOCOL changes.
-        self.assertEqual(pickle.HIGHEST_PROTOCOL, 4)
+        self.assertEqual(pickle.HIGHEST_PROTOCOL, 5)
 
     def test_callapi(self):
         f = io.BytesIO()
@@ -1999,6 +2056,55 @@ class AbstractPickleModuleTests(unittest.TestCase):
         pickle.Pickler(f, -1)
         pickle.Pickler(f, protocol=-1)
 
+    def _opcodes(self, pickled):
+        return [(op.name, arg) for op, arg, pos in pickletools.genops(pickled)
+                if op.name != 'FRAME']
+
+    def test_dumps_workers(self):
+        data = [(i, i / 3, str(i), -i * 10**20, '\xe9%d' % i, '\U0001f600%d' % i,
+                 '\udc80', bytes([i % 256]) * 3, None, True, [i, {i: 'x'}])
+                for i in range(2500)]
+        records = {str(i): {'id': i, 'tags': ['a', 'b']} for i in range(3000)}
+        for obj in data, records:
+            for proto in 2, 4, pickle.HIGHEST_PROTOCOL:
+                expected = pickle.dumps(obj, proto)
+                for workers in 1, 2, 3:
+                    pickled = pickle.dumps(obj, proto, workers=workers)
+                    self.assertEqual(pickle.loads(pickled), obj)
+                    self.assertEqual(self._opcodes(pickled),
+                                     self._opcodes(expected))
+        f = io.BytesIO()
+        pickle.dump(data, f, 4, workers=2)
+        self.assertEqual(pickle.loads(f.getvalue()), data)
+
+    def test_dumps_workers_fallback(self):
+        shared = [1, 2]
+        obj = list(range(3000)) + [shared] * 3000
+        unpickled = pickle.loads(pickle.dumps(obj, 4, workers=4))
+        self.assertEqual(unpickled, obj)
+        self.assertIs(unpickled[3000], unpickled[-1])
+
+        obj = [[]] * 3000
+        obj.append(obj)
+        unpickled = pickle.loads(pickle.dumps(obj, 4, workers=4))
+        self.assertIs(unpickled[-1], unpickled)
+
+        deep = 0
+        for i in range(300):
+            deep = [deep]
+        for obj in ([float('nan'), float('inf')] * 3000,
+                    [C() for i in range(3000)],
+                    [(i, [i]) for i in range(3000)] + [deep]):
+            pickled = pickle.dumps(obj, 4, workers=2)
+            self.assertEqual(len(pickle.loads(pickled)), len(obj))
+
+    def test_bad_workers(self):
+        for dumps in pickle.dumps, pickle._dumps:
+            self.assertRaises(TypeError, dumps, [], workers=2.0)
+            self.assertRaises(TypeError, dumps, [], workers='2')
+            self.assertRaises(ValueError, dumps, [], workers=0)
+            self.assertRaises(ValueError, dumps, [], workers=-1)
+
     def test_bad_init(self):
         # Test issue3664 (pickle can segfault from a badly initialized Pickler).
         # Override initialization without calling __init__() of the superclass.
@@ -2145,6 +2251,26 @@ class AbstractPicklerUnpicklerObjectTests(unittest.TestCase):
         self.assertEqual(unpickled_data2, data)
         self.assertTrue(unpickled_data2 is unpickled_data1)
 
+    def test_priming_unpickler_memo_dict(self):
+        # An empty or sparse memo dict must leave room for later PUTs.
+        data = [[1], [2], [3]] * 3
+        for proto in protocols:
+            f = io.BytesIO()
+            self.pickler_class(f, proto).dump(data)
+            pickled = f.getvalue()
+            unpickler = self.unpickler_class(io.BytesIO(pickled))
+            unpickler.memo = {}
+            self.assertEqual(unpickler.load(), data)
+
+        obj = ['spam']
+        unpickler = self.unpickler_class(io.BytesIO(b'\x80\x02h\x05.'))
+        unpickler.memo = {5: obj}
+        self.assertIs(unpickler.load(), obj)
+        pickled = b']q\x02(j\xe8\x03\x00\x00h\x05e.'
+        unpickler = self.unpickler_class(io.BytesIO(pickled))
+        unpickler.memo = {5: obj, 1000: 'x'}
+        self.assertEqual(unpickler.load(), ['x', obj])
+
     def test_reusing_unpickler_objects(self):
         data1 = ["abcdefg", "abcdefg", 44]
         f = io.BytesIO()
@@ -2209,6 +2335,88 @@ class AbstractPicklerUnpicklerObjectTests(unittest.TestCase):
                 unpickler = self.unpickler_class(f)
                 self.assertEqual(unpickler.load(), data)
 
+    def _dumps_with_buffers(self, obj, protocol=5, buffer_callback=None):
+        f = io.BytesIO()
+        self.pickler_class(f, protocol,
+                           buffer_callback=buffer_callback).dump(obj)
+        return f.getvalue()
+
+    def _loads_with_buffers(self, data, buffers=None):
+        return self.unpickler_class(io.BytesIO(data), buffers=buffers).load()
+
+    def test_buffers_out_of_band(self):
+        for obj in b'xyz' * 100, bytearray(b'xyz' * 100):
+            buffers = []
+            pb = pickle.PickleBuffer(obj)
+            data = self._dumps_with_buffers([pb, pb],
+                                            buffer_callback=buffers.append)
+            # The payload was not copied in the pickle stream
+            self.assertNotIn(b'xyz', data)
+            self.assertEqual(buffers, [pb, pb])
+            new = self._loads_with_buffers(data, buffers)
+            self.assertEqual(new, [pb, pb])
+            self.assertIs(new[0], pb)
+            new = self._loads_with_buffers(data, [obj, bytearray(obj)])
+            self.assertIs(new[0], obj)
+
+    def test_buffers_in_band_callback(self):
+        # A callback returning a true value keeps the buffer in-band
+        obj = bytearray(b'abc')
+        buffers = []
+        def callback(pb):
+            buffers.append(pb)
+            return True
+        data = self._dumps_with_buffers(pickle.PickleBuffer(obj),
+                                        buffer_callback=callback)
+        self.assertEqual(len(buffers), 1)
+        new = self._loads_with_buffers(data)
+        self.assertIs(type(new), bytearray)
+        self.assertEqual(new, obj)
+
+    def test_buffers_readonly(self):
+        buffers = []
+        data = self._dumps_with_buffers(pickle.PickleBuffer(b'abc'),
+                                        buffer_callback=buffers.append)
+        new = self._loads_with_buffers(data, [bytearray(b'abc')])
+        with memoryview(new) as m:
+            self.assertTrue(m.readonly)
+            self.assertEqual(m.tobytes(), b'abc')
+        new = self._loads_with_buffers(data, buffers)
+        self.assertIs(new, buffers[0])
+
+    def test_buffers_errors(self):
+        pb = pickle.PickleBuffer(b'abc')
+        for proto in range(5):
+            with self.assertRaises(ValueError):
+                self._dumps_with_buffers(pb, proto, buffer_callback=len)
+        data = self._dumps_with_buffers([pb, pb, pickle.PickleBuffer(b'x')],
+                                        buffer_callback=lambda pb: False)
+        with self.assertRaises(pickle.UnpicklingError):
+            self._loads_with_buffers(data)
+        with self.assertRaises(pickle.UnpicklingError):
+            self._loads_with_buffers(data, [b'abc', b'abc'])
+        self.assertEqual(self._loads_with_buffers(data, [b'abc', b'ab', b'x']),
+                         [b'abc', b'ab', b'x'])
+        # Non-contiguous buffers can't be pickled
+        m = memoryview(bytearray(b'abcdef'))[::2]
+        with self.assertRaises(pickle.PicklingError):
+            self._dumps_with_buffers(pickle.PickleBuffer(m))
+        with self.assertRaises(pickle.PicklingError):
+            self._dumps_with_buffers(pickle.PickleBuffer(m),
+                                     buffer_callback=len)
+
+    def test_large_bytes_file(self):
+        # Large payloads are written to and read from the file directly
+        data = [b'x' * (1 << 20), bytearray(b'y' * (1 << 20)), b'z']
+        for proto in protocols:
+            f = io.BytesIO()
+            self.pickler_class(f, proto).dump(data)
+            f.seek(0)
+            new = self.unpickler_class(f).load()
+            self.assertEqual(new, data)
+            self.assertEqual([type(x) for x in new], [bytes, bytearray, bytes])
+            self.assertEqual(f.read(), b'')
+
 
 # Tests for dispatch_table attribute
 
@@ -210,6 +210,50 @@ class BaseTest:
                 if loc != -1:
                     self.assertEqual(i[loc:loc+len(j)], j)
 
+    def test_find_long_needles(self):
+        # Long needles in long haystacks are looked for with the two-way
+        # algorithm, and short ones by blocks: check needles which are
+        # almost found at each position around a block
+        def reference_count(haystack, needle, maxcount):
+            count = i = 0
+            while i <= len(haystack) - len(needle) and count < maxcount:
+                if haystack[i:i + len(needle)] == needle:
+                    count += 1
+                    i += len(needle)
+                else:
+                    i += 1
+            return count
+
+        for m in (2, 3, 16, 17, 32, 33, 100):
+            needle = 'a' * (m - 1) + 'b'
+            for n in range(m - 1, m + 40, 3):
+                for pos in range(0, n - m + 1, 5):
+                    haystack = 'a' * pos + needle + 'a' * (n - m - pos)
+                    self.checkequal(pos, haystack, 'find', needle)
+                    self.checkequal(1, haystack, 'count', needle)
+                self.checkequal(-1, 'a' * n, 'find', needle)
+                self.checkequal(0, 'a' * n, 'count', needle)
+
+        for needle in ('ab' * 60 + 'ba' + 'ab' * 60,
+                       'a' * 120 + 'b' + 'a' * 120,
+                       'abcdefgh' * 20 + 'x',
+                       'abaabaaabaaaab' * 10):
+            for haystack in ((needle[:-1] + 'x') * 20,
+                             'ab' * 2000,
+                             'a' * 4000,
+                             'ab' * 1500 + needle + 'ab' * 1500,
+                             needle * 3 + 'a' * 3000 + needle):
+                count = reference_count(haystack, needle, sys.maxsize)
+                self.checkequal(count, haystack, 'count', needle)
+                self.checkequal(count > 0, haystack, '__contains__', needle)
+                if count:
+                    pos = self.fixtype(haystack).find(self.fixtype(needle))
+                    self.assertEqual(haystack[pos:pos + len(needle)], needle)
+                    before = haystack[:pos + len(needle) - 1]
+                    self.assertEqual(reference_count(before, needle, 1), 0)
+                else:
+                    self.checkequal(-1, haystack, 'find', needle)
+
     def test_rfind(self):
         self.checkequal(9,  'abcdefghiabc', 'rfind', 'abc')
         self.checkequal(12, 'abcdefghiabc', 'rfind', '')
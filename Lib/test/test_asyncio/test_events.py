@@ -23,6 +23,7 @@ import weakref
 
 
 import asyncio
+from asyncio import events
 from asyncio import proactor_events
 from asyncio import selector_events
 from asyncio import test_utils
@@ -1890,6 +1891,17 @@ class HandleTests(test_utils.TestCase):
             'source_traceback': h._source_traceback,
         })
 
+    def test_handle_cancel_from_callback(self):
+        def callback():
+            h.cancel()
+
+        h = asyncio.Handle(callback, (), self.loop)
+        h._run()
+        self.assertTrue(h._cancelled)
+        self.assertIsNone(h._callback)
+        self.assertIsNone(h._args)
+        self.assertFalse(self.loop.call_exception_handler.called)
+
     def test_handle_weakref(self):
         wd = weakref.WeakValueDictionary()
         h = asyncio.Handle(lambda: None, (), self.loop)
@@ -2102,6 +2114,37 @@ class TimerTests(unittest.TestCase):
         self.assertIs(NotImplemented, h1.__ne__(h3))
 
 
+def patch_python_handles(testcase):
+    # HandleTests and TimerTests exercise the C implementation when it is
+    # available, run them again against the pure Python handles.
+    patcher = mock.patch.multiple(events, Handle=events._PyHandle,
+                                  TimerHandle=events._PyTimerHandle)
+    patcher.start()
+    testcase.addCleanup(patcher.stop)
+    patcher = mock.patch.multiple(asyncio, Handle=events._PyHandle,
+                                  TimerHandle=events._PyTimerHandle)
+    patcher.start()
+    testcase.addCleanup(patcher.stop)
+
+
+@unittest.skipUnless(hasattr(events, '_CHandle'),
+                     'requires the C _asyncio module')
+class PyHandleTests(HandleTests):
+
+    def setUp(self):
+        super().setUp()
+        patch_python_handles(self)
+
+
+@unittest.skipUnless(hasattr(events, '_CTimerHandle'),
+                     'requires the C _asyncio module')
+class PyTimerTests(TimerTests):
+
+    def setUp(self):
+        super().setUp()
+        patch_python_handles(self)
+
+
 class AbstractEventLoopTests(unittest.TestCase):
 
     def test_not_implemented(self):
@@ -2145,6 +2188,8 @@ class AbstractEventLoopTests(unittest.TestCase):
             NotImplementedError, loop.create_server, f)
         self.assertRaises(
             NotImplementedError, loop.create_datagram_endpoint, f)
+        self.assertRaises(
+            NotImplementedError, loop.sendfile, f, f)
         self.assertRaises(
             NotImplementedError, loop.add_reader, 1, f)
         self.assertRaises(
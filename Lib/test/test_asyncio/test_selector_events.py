@@ -1086,6 +1086,109 @@ class SelectorSocketTransportTests(test_utils.TestCase):
         tr.close()
 
 
+class SelectorSocketTransportBufferedProtocolTests(test_utils.TestCase):
+
+    def setUp(self):
+        self.loop = self.new_test_loop()
+
+        self.protocol = test_utils.make_test_protocol(
+            asyncio.BufferedProtocol)
+        self.buf = bytearray(1)
+        self.protocol.get_buffer.side_effect = lambda hint: self.buf
+
+        self.sock = mock.Mock(socket.socket)
+        self.sock_fd = self.sock.fileno.return_value = 7
+
+    def socket_transport(self):
+        return _SelectorSocketTransport(self.loop, self.sock, self.protocol)
+
+    def test_ctor(self):
+        tr = self.socket_transport()
+        self.loop.assert_reader(7, tr._read_ready)
+        test_utils.run_briefly(self.loop)
+        self.protocol.connection_made.assert_called_with(tr)
+
+    def test_get_buffer_error(self):
+        transport = self.socket_transport()
+        transport._fatal_error = mock.Mock()
+
+        self.loop.call_exception_handler = mock.Mock()
+        self.protocol.get_buffer.side_effect = LookupError()
+
+        transport._read_ready()
+
+        self.assertTrue(transport._fatal_error.called)
+        self.assertTrue(self.protocol.get_buffer.called)
+        self.assertFalse(self.protocol.buffer_updated.called)
+        self.assertFalse(self.sock.recv_into.called)
+
+    def test_get_buffer_zerosized(self):
+        transport = self.socket_transport()
+        transport._fatal_error = mock.Mock()
+
+        self.buf = bytearray()
+        transport._read_ready()
+
+        self.assertTrue(transport._fatal_error.called)
+        self.assertIsInstance(transport._fatal_error.call_args[0][0],
+                              RuntimeError)
+        self.assertFalse(self.protocol.buffer_updated.called)
+        self.assertFalse(self.sock.recv_into.called)
+
+    def test_read_ready(self):
+        transport = self.socket_transport()
+
+        self.sock.recv_into.return_value = 1
+        transport._read_ready()
+
+        self.sock.recv_into.assert_called_with(self.buf)
+        self.protocol.buffer_updated.assert_called_with(1)
+        self.assertFalse(self.sock.recv.called)
+
+    def test_read_ready_eof(self):
+        transport = self.socket_transport()
+        transport.close = mock.Mock()
+
+        self.sock.recv_into.return_value = 0
+        transport._read_ready()
+
+        self.protocol.eof_received.assert_called_with()
+        self.assertFalse(self.protocol.buffer_updated.called)
+        transport.close.assert_called_with()
+
+    def test_read_ready_eof_keep_open(self):
+        transport = self.socket_transport()
+        transport.close = mock.Mock()
+
+        self.sock.recv_into.return_value = 0
+        self.protocol.eof_received.return_value = True
+        transport._read_ready()
+
+        self.protocol.eof_received.assert_called_with()
+        self.assertFalse(transport.close.called)
+
+    def test_read_ready_tryagain(self):
+        transport = self.socket_transport()
+        transport._fatal_error = mock.Mock()
+
+        self.sock.recv_into.side_effect = BlockingIOError
+        transport._read_ready()
+
+        self.assertFalse(transport._fatal_error.called)
+        self.assertFalse(self.protocol.buffer_updated.called)
+
+    def test_read_ready_err(self):
+        transport = self.socket_transport()
+        transport._fatal_error = mock.Mock()
+
+        err = self.sock.recv_into.side_effect = OSError()
+        transport._read_ready()
+
+        transport._fatal_error.assert_called_with(
+                                   err,
+                                   'Fatal read error on socket transport')
+
+
 @unittest.skipIf(ssl is None, 'No ssl module')
 class SelectorSslTransportTests(test_utils.TestCase):
 
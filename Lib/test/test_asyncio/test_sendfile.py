@@ -0,0 +1,221 @@
+"""Tests for loop.sendfile()."""
+
+import io
+import os
+import socket
+import unittest
+from unittest import mock
+
+import asyncio
+from asyncio import base_events
+from asyncio import constants
+from asyncio import test_utils
+from test import support
+
+
+class MySendfileProto(asyncio.Protocol):
+
+    def __init__(self, loop):
+        self.transport = None
+        self.data = bytearray()
+        self.done = asyncio.Future(loop=loop)
+
+    def connection_made(self, transport):
+        self.transport = transport
+
+    def data_received(self, data):
+        self.data.extend(data)
+
+    def connection_lost(self, exc):
+        if not self.done.done():
+            self.done.set_result(None)
+
+
+class SendfileTests(test_utils.TestCase):
+
+    # 4 MiB are more than the socket buffers: the sender has to wait for
+    # the socket to become writable again.
+    DATA = b"SendfileBaseTests" * (4 * 1024 * 1024 // 17)
+
+    @classmethod
+    def setUpClass(cls):
+        with open(support.TESTFN, 'wb') as fp:
+            fp.write(cls.DATA)
+        super().setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        support.unlink(support.TESTFN)
+        super().tearDownClass()
+
+    def setUp(self):
+        self.file = open(support.TESTFN, 'rb')
+        self.addCleanup(self.file.close)
+        self.loop = asyncio.SelectorEventLoop()
+        self.set_event_loop(self.loop)
+
+    def run_loop(self, coro):
+        return self.loop.run_until_complete(coro)
+
+    def prepare(self):
+        srv_proto = MySendfileProto(loop=self.loop)
+        server = self.run_loop(self.loop.create_server(
+            lambda: srv_proto, support.HOST, 0))
+        port = server.sockets[0].getsockname()[1]
+        cli_proto = MySendfileProto(loop=self.loop)
+        tr, pr = self.run_loop(self.loop.create_connection(
+            lambda: cli_proto, support.HOST, port))
+
+        def cleanup():
+            srv_proto.transport.close()
+            cli_proto.transport.close()
+            self.run_loop(srv_proto.done)
+            self.run_loop(cli_proto.done)
+
+            server.close()
+            self.run_loop(server.wait_closed())
+
+        self.addCleanup(cleanup)
+        return srv_proto, cli_proto
+
+    def test_sendfile(self):
+        srv_proto, cli_proto = self.prepare()
+        ret = self.run_loop(
+            self.loop.sendfile(cli_proto.transport, self.file))
+        cli_proto.transport.close()
+        self.run_loop(srv_proto.done)
+        self.assertEqual(ret, len(self.DATA))
+        self.assertEqual(len(srv_proto.data), len(self.DATA))
+        self.assertEqual(srv_proto.data, self.DATA)
+        self.assertEqual(self.file.tell(), len(self.DATA))
+
+    def test_sendfile_native_used(self):
+        if not hasattr(os, 'sendfile'):
+            self.skipTest("requires os.sendfile()")
+        srv_proto, cli_proto = self.prepare()
+        with mock.patch.object(self.loop, '_sendfile_fallback') as fallback:
+            ret = self.run_loop(
+                self.loop.sendfile(cli_proto.transport, self.file))
+        self.assertFalse(fallback.called)
+        self.assertEqual(ret, len(self.DATA))
+
+    def test_sendfile_offset_and_count(self):
+        srv_proto, cli_proto = self.prepare()
+        ret = self.run_loop(
+            self.loop.sendfile(cli_proto.transport, self.file,
+                               1000, 100))
+        cli_proto.transport.close()
+        self.run_loop(srv_proto.done)
+        self.assertEqual(ret, 100)
+        self.assertEqual(srv_proto.data, self.DATA[1000:1100])
+        self.assertEqual(self.file.tell(), 1100)
+
+    def test_sendfile_after_write(self):
+        srv_proto, cli_proto = self.prepare()
+        cli_proto.transport.write(b'header\n')
+        ret = self.run_loop(
+            self.loop.sendfile(cli_proto.transport, self.file))
+        cli_proto.transport.write(b'trailer\n')
+        cli_proto.transport.close()
+        self.run_loop(srv_proto.done)
+        self.assertEqual(ret, len(self.DATA))
+        self.assertEqual(srv_proto.data,
+                         b'header\n' + self.DATA + b'trailer\n')
+
+    def test_sendfile_empty_file(self):
+        srv_proto, cli_proto = self.prepare()
+        ret = self.run_loop(
+            self.loop.sendfile(cli_proto.transport, io.BytesIO()))
+        self.assertEqual(ret, 0)
+
+    def test_sendfile_fallback(self):
+        srv_proto, cli_proto = self.prepare()
+        # BytesIO has no file descriptor: os.sendfile() cannot be used
+        f = io.BytesIO(self.DATA)
+        f.seek(10)
+        ret = self.run_loop(
+            self.loop.sendfile(cli_proto.transport, f, 1000))
+        cli_proto.transport.close()
+        self.run_loop(srv_proto.done)
+        self.assertEqual(ret, len(self.DATA) - 1000)
+        self.assertEqual(srv_proto.data, self.DATA[1000:])
+        self.assertEqual(f.tell(), len(self.DATA))
+
+    def test_sendfile_fallback_zero_offset(self):
+        srv_proto, cli_proto = self.prepare()
+        # Like os.sendfile(), the fallback starts at offset, even if it
+        # is 0, rather than at the current position of the file
+        f = io.BytesIO(self.DATA)
+        f.seek(10)
+        ret = self.run_loop(
+            self.loop.sendfile(cli_proto.transport, f))
+        cli_proto.transport.close()
+        self.run_loop(srv_proto.done)
+        self.assertEqual(ret, len(self.DATA))
+        self.assertEqual(srv_proto.data, self.DATA)
+
+    def test_sendfile_fallback_count(self):
+        srv_proto, cli_proto = self.prepare()
+        count = constants.SENDFILE_FALLBACK_READBUFFER_SIZE + 100
+        with mock.patch.object(base_events.BaseEventLoop,
+                               '_sendfile_native',
+                               side_effect=asyncio.SendfileNotAvailableError):
+            ret = self.run_loop(
+                self.loop.sendfile(cli_proto.transport, self.file, 5,
+                                   count))
+        cli_proto.transport.close()
+        self.run_loop(srv_proto.done)
+        self.assertEqual(ret, count)
+        self.assertEqual(srv_proto.data, self.DATA[5:5 + count])
+        self.assertEqual(self.file.tell(), 5 + count)
+
+    def test_sendfile_no_fallback(self):
+        srv_proto, cli_proto = self.prepare()
+        with self.assertRaises(asyncio.SendfileNotAvailableError):
+            self.run_loop(
+                self.loop.sendfile(cli_proto.transport, io.BytesIO(b'x'),
+                                   fallback=False))
+
+    def test_sendfile_write_refused_while_sending(self):
+        srv_proto, cli_proto = self.prepare()
+
+        @asyncio.coroutine
+        def write_soon():
+            yield
+            with self.assertRaisesRegex(RuntimeError, 'sendfile is in'):
+                cli_proto.transport.write(b'data')
+
+        task = asyncio.Task(write_soon(), loop=self.loop)
+        self.run_loop(self.loop.sendfile(cli_proto.transport, self.file))
+        self.run_loop(task)
+
+    def test_sendfile_invalid_arguments(self):
+        srv_proto, cli_proto = self.prepare()
+        tr = cli_proto.transport
+        with open(support.TESTFN, 'r') as text_file:
+            with self.assertRaisesRegex(ValueError, 'binary mode'):
+                self.run_loop(self.loop.sendfile(tr, text_file))
+        with self.assertRaisesRegex(ValueError, 'offset'):
+            self.run_loop(self.loop.sendfile(tr, self.file, -1))
+        with self.assertRaisesRegex(TypeError, 'offset'):
+            self.run_loop(self.loop.sendfile(tr, self.file, 1.0))
+        with self.assertRaisesRegex(ValueError, 'count'):
+            self.run_loop(self.loop.sendfile(tr, self.file, 0, 0))
+        with self.assertRaisesRegex(TypeError, 'count'):
+            self.run_loop(self.loop.sendfile(tr, self.file, 0, '1'))
+
+    def test_sendfile_closing_transport(self):
+        srv_proto, cli_proto = self.prepare()
+        cli_proto.transport.close()
+        with self.assertRaisesRegex(RuntimeError, 'closing'):
+            self.run_loop(
+                self.loop.sendfile(cli_proto.transport, self.file))
+
+    def test_sendfile_unsupported_transport(self):
+        transport = mock.Mock(spec=asyncio.Transport)
+        with self.assertRaisesRegex(RuntimeError, 'not supported'):
+            self.run_loop(self.loop.sendfile(transport, self.file))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -128,6 +128,42 @@ class StreamReaderTests(test_utils.TestCase):
         stream.feed_data(self.DATA)
         self.assertEqual(self.DATA, stream._buffer)
 
+    def test_protocol_get_buffer(self):
+        # Buffered transports receive data into a buffer of the reader.
+        stream = asyncio.StreamReader(loop=self.loop)
+        protocol = asyncio.StreamReaderProtocol(stream, loop=self.loop)
+        self.assertIsInstance(protocol, asyncio.BufferedProtocol)
+
+        buf = protocol.get_buffer(-1)
+        self.assertGreater(len(buf), len(self.DATA))
+        buf[:len(self.DATA)] = self.DATA
+        protocol.buffer_updated(len(self.DATA))
+        self.assertEqual(self.DATA, stream._buffer)
+
+        # the buffer is reused, the received data is kept
+        buf = protocol.get_buffer(-1)
+        buf[:5] = b'line4'
+        protocol.buffer_updated(5)
+        self.assertEqual(self.DATA + b'line4', stream._buffer)
+
+        # honour the size hint
+        buf = protocol.get_buffer(2**20)
+        self.assertGreaterEqual(len(buf), 2**20)
+
+    def test_protocol_buffer_updated_wakes_reader(self):
+        stream = asyncio.StreamReader(loop=self.loop)
+        protocol = asyncio.StreamReaderProtocol(stream, loop=self.loop)
+        read_task = asyncio.Task(stream.readline(), loop=self.loop)
+
+        def cb():
+            buf = protocol.get_buffer(-1)
+            buf[:len(self.DATA)] = self.DATA
+            protocol.buffer_updated(len(self.DATA))
+        self.loop.call_soon(cb)
+
+        line = self.loop.run_until_complete(read_task)
+        self.assertEqual(b'line1\n', line)
+
     def test_read_zero(self):
         # Read zero bytes.
         stream = asyncio.StreamReader(loop=self.loop)
@@ -10,6 +10,7 @@ from unittest import mock
 
 import asyncio
 from asyncio import coroutines
+from asyncio import tasks
 from asyncio import test_utils
 try:
     from test import support
@@ -1702,6 +1703,22 @@ class TaskTests(test_utils.TestCase):
         self.loop.run_until_complete(task)
 
 
+@unittest.skipUnless(hasattr(tasks, '_CTask'),
+                     'requires the C _asyncio module')
+class PyTaskTests(TaskTests):
+    # TaskTests exercise the C implementation when it is available, run
+    # them again against the pure Python Task.
+
+    def setUp(self):
+        super().setUp()
+        patcher = mock.patch.multiple(tasks, Task=tasks._PyTask)
+        patcher.start()
+        self.addCleanup(patcher.stop)
+        patcher = mock.patch.object(asyncio, 'Task', tasks._PyTask)
+        patcher.start()
+        self.addCleanup(patcher.stop)
+
+
 class GatherTestsBase:
 
     def setUp(self):
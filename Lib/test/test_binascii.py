@@ -111,6 +111,18 @@ class BinASCIITest(unittest.TestCase):
         # empty strings. TBD: shouldn't it raise an exception instead ?
         self.assertEqual(binascii.a2b_base64(self.type2test(fillers)), b'')
 
+    def test_base64_lengths(self):
+        # Blocks of characters are decoded at once; check every length
+        # and a character to skip at every position
+        for n in range(50):
+            raw = bytes(i * 37 & 0xff for i in range(n))
+            a = binascii.b2a_base64(self.type2test(raw))
+            self.assertEqual(binascii.a2b_base64(self.type2test(a)), raw)
+            for i in range(len(a) - 1):
+                noisy = a[:i] + b'*' + a[i:]
+                self.assertEqual(binascii.a2b_base64(self.type2test(noisy)),
+                                 raw)
+
     def test_uu(self):
         MAX_UU = 45
         lines = []
@@ -164,6 +176,19 @@ class BinASCIITest(unittest.TestCase):
 
         self.assertEqual(binascii.hexlify(b'a'), b'61')
 
+    def test_hex_lengths(self):
+        for n in range(40):
+            raw = bytes(i * 37 & 0xff for i in range(n))
+            h = binascii.hexlify(self.type2test(raw))
+            self.assertEqual(h, ''.join('%02x' % c for c in raw).encode())
+            self.assertEqual(binascii.unhexlify(self.type2test(h.upper())),
+                             raw)
+            for i in range(len(h)):
+                for c in b'g/:@`\x80':
+                    bad = h[:i] + bytes([c]) + h[i+1:]
+                    self.assertRaises(binascii.Error, binascii.unhexlify,
+                                      self.type2test(bad))
+
     def test_qp(self):
         # A test for SF bug 534347 (segfaults without the proper fix)
         try:
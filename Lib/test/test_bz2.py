@@ -250,6 +250,25 @@ class BZ2FileTest(BaseTest):
         with open(self.filename, 'rb') as f:
             self.assertEqual(self.decompress(f.read()), self.TEXT)
 
+    def testWriteThreads(self):
+        text = self.TEXT * 30000
+        with BZ2File(self.filename, "w", compresslevel=1, threads=3) as bz2f:
+            for i in range(0, len(text), 65536):
+                bz2f.write(text[i:i + 65536])
+        with open(self.filename, 'rb') as f:
+            data = f.read()
+        # One stream per block of 100k bytes
+        self.assertEqual(data.count(b'BZh1'), (len(text) + 99999) // 100000)
+        self.assertEqual(bz2.decompress(data), text)
+        with BZ2File(self.filename) as bz2f:
+            self.assertEqual(bz2f.read(), text)
+        self.assertRaises(ValueError, BZ2File, self.filename, "w",
+                          threads=-1)
+        # Cannot specify threads with mode="r".
+        for threads in (0, 2):
+            self.assertRaises(ValueError, BZ2File, BytesIO(data),
+                              threads=threads)
+
     def testWriteNonDefaultCompressLevel(self):
         expected = bz2.compress(self.TEXT, compresslevel=5)
         with BZ2File(self.filename, "w", compresslevel=5) as bz2f:
@@ -680,6 +699,32 @@ class BZ2DecompressorTest(BaseTest):
         self.assertEqual(text, self.TEXT)
         self.assertEqual(bz2d.unused_data, unused_data)
 
+    def testDecompressInto(self):
+        bz2d = BZ2Decompressor()
+        buf = bytearray(100)
+        chunks = []
+        data = self.DATA
+        while not bz2d.eof:
+            n = bz2d.decompress_into(data, buf)
+            chunks.append(bytes(buf[:n]))
+            data = bz2d.unconsumed_tail
+        self.assertEqual(b''.join(chunks), self.TEXT)
+        self.assertEqual(bz2d.unconsumed_tail, b'')
+        self.assertRaises(EOFError, bz2d.decompress_into, b'', buf)
+
+    def testDecompressIntoUnusedData(self):
+        bz2d = BZ2Decompressor()
+        self.assertEqual(bz2d.unconsumed_tail, b'')
+        self.assertEqual(bz2d.decompress_into(self.DATA, bytearray()), 0)
+        self.assertEqual(bz2d.unconsumed_tail, self.DATA)
+        self.assertRaises(TypeError, bz2d.decompress_into, self.DATA, b'x')
+        buf = bytearray(len(self.TEXT) + 1)
+        n = bz2d.decompress_into(self.DATA + b'unused', buf)
+        self.assertEqual(buf[:n], self.TEXT)
+        self.assertTrue(bz2d.eof)
+        self.assertEqual(bz2d.unused_data, b'unused')
+        self.assertEqual(bz2d.unconsumed_tail, b'')
+
     def testEOFError(self):
         bz2d = BZ2Decompressor()
         text = bz2d.decompress(self.DATA)
@@ -717,6 +762,16 @@ class CompressDecompressTest(BaseTest):
         text = bz2.compress(b'')
         self.assertEqual(text, self.EMPTY_DATA)
 
+    def testCompressThreads(self):
+        for size in (0, 1000, 900000, 900001, 2000000):
+            text = (self.TEXT * (size // len(self.TEXT) + 1))[:size]
+            for threads in (0, 2):
+                data = bz2.compress(text, threads=threads)
+                self.assertEqual(self.decompress(data), text)
+        self.assertEqual(bz2.compress(b'', threads=2), self.EMPTY_DATA)
+        for level in (0, 10):
+            self.assertRaises(ValueError, bz2.compress, b'', level, threads=2)
+
     def testDecompress(self):
         text = bz2.decompress(self.DATA)
         self.assertEqual(text, self.TEXT)
@@ -1,3 +1,4 @@
+import binascii
 import codecs
 import contextlib
 import io
@@ -2508,6 +2509,36 @@ class TransformCodecTest(unittest.TestCase):
                 sout = reader.readline()
                 self.assertEqual(sout, b"\x80")
 
+    def test_base64_incremental_decoder(self):
+        data = bytes(range(256)) * 4
+        encoded = codecs.encode(data, 'base64')
+        for size in (1, 3, 4, 7, 77, 1000):
+            with self.subTest(size=size):
+                chunks = [encoded[i:i+size]
+                          for i in range(0, len(encoded), size)]
+                self.assertEqual(
+                    b''.join(codecs.iterdecode(chunks, 'base64')), data)
+        decoder = codecs.getincrementaldecoder('base64')()
+        self.assertEqual(decoder.decode(b'YW'), b'')
+        self.assertEqual(decoder.decode(b'Jj\nZA'), b'abc')
+        self.assertEqual(decoder.decode(b'='), b'')
+        self.assertEqual(decoder.decode(b'='), b'd')
+        self.assertEqual(decoder.decode(b'', True), b'')
+        decoder.decode(b'YW')
+        self.assertRaises(binascii.Error, decoder.decode, b'J', True)
+        # Concatenated padded streams are decoded one group at a time,
+        # without waiting for the final call
+        decoder = codecs.getincrementaldecoder('base64')()
+        self.assertEqual(decoder.decode(b'YQ==Yg'), b'a')
+        self.assertEqual(decoder.decode(b'='), b'')
+        self.assertEqual(decoder.decode(b'=\n==YWJj'), b'babc')
+        self.assertEqual(decoder.getstate(), (b'', 0))
+        for _ in range(1000):
+            self.assertEqual(decoder.decode(b'YQ=='), b'a')
+            self.assertEqual(decoder.getstate(), (b'', 0))
+        self.assertEqual(decoder.decode(b'', True), b'')
+        self.assertRaises(binascii.Error, decoder.decode, b'YQ=', True)
+
     def test_buffer_api_usage(self):
         # We check all the transform codecs accept memoryview input
         # for encoding and decoding
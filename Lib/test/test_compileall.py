@@ -40,9 +40,9 @@ class CompileallTests(unittest.TestCase):
 
     def data(self):
         with open(self.bc_path, 'rb') as file:
-            data = file.read(8)
+            data = file.read(12)
         mtime = int(os.stat(self.source_path).st_mtime)
-        compare = struct.pack('<4sl', importlib.util.MAGIC_NUMBER, mtime)
+        compare = struct.pack('<4sll', importlib.util.MAGIC_NUMBER, 0, mtime)
         return data, compare
 
     @unittest.skipUnless(hasattr(os, 'stat'), 'test needs os.stat()')
@@ -62,13 +62,26 @@ class CompileallTests(unittest.TestCase):
 
     def test_mtime(self):
         # Test a change in mtime leads to a new .pyc.
-        self.recreation_check(struct.pack('<4sl', importlib.util.MAGIC_NUMBER,
-                                          1))
+        self.recreation_check(struct.pack('<4sll', importlib.util.MAGIC_NUMBER,
+                                          0, 1))
 
     def test_magic_number(self):
         # Test a change in mtime leads to a new .pyc.
         self.recreation_check(b'\0\0\0\0')
 
+    def test_size(self):
+        # Test a change in the size of the source leads to a new .pyc.
+        py_compile.compile(self.source_path)
+        with open(self.bc_path, 'rb') as file:
+            bc = bytearray(file.read())
+        bc[12:16] = struct.pack('<L', 1)
+        with open(self.bc_path, 'wb') as file:
+            file.write(bc)
+        compileall.compile_dir(self.directory, force=False, quiet=True)
+        with open(self.bc_path, 'rb') as file:
+            size = struct.unpack('<L', file.read(16)[12:])[0]
+        self.assertEqual(size, os.stat(self.source_path).st_size)
+
     def test_compile_files(self):
         # Test compiling a single file, and complete directory
         for fn in (self.bc_path, self.bc_path2):
@@ -118,6 +131,19 @@ class CompileallTests(unittest.TestCase):
         compileall.compile_dir(self.directory, quiet=True, workers=5)
         self.assertTrue(pool_mock.called)
 
+    @mock.patch('compileall.ProcessPoolExecutor')
+    def test_compile_pool_up_to_date(self, pool_mock):
+        # Files which are up to date are not handed to the workers.
+        compileall.compile_dir(self.directory, quiet=True)
+        self.assertTrue(compileall.compile_dir(self.directory, quiet=True,
+                                               workers=5))
+        self.assertFalse(pool_mock.called)
+        os.unlink(self.bc_path2)
+        compileall.compile_dir(self.directory, quiet=True, workers=5)
+        executor = pool_mock.return_value.__enter__.return_value
+        self.assertEqual(list(executor.map.call_args[0][1]),
+                         [self.source_path2])
+
     def test_compile_workers_non_positive(self):
         with self.assertRaisesRegex(ValueError,
                                     "workers must be greater or equal to 0"):
@@ -295,6 +321,36 @@ class CommandLineTests(unittest.TestCase):
         mtime2 = os.stat(pycpath).st_mtime
         self.assertNotEqual(mtime, mtime2)
 
+    def test_invalidation_mode(self):
+        for mode, flags in (('checked-hash', 0b11), ('unchecked-hash', 0b01),
+                            ('timestamp', 0)):
+            with self.subTest(mode=mode):
+                self.assertRunOK('-q', '--invalidation-mode', mode,
+                                 self.pkgdir)
+                pycpath = importlib.util.cache_from_source(self.barfn)
+                with open(pycpath, 'rb') as fp:
+                    header = fp.read(8)
+                self.assertEqual(header[4:],
+                                 struct.pack('<L', flags))
+
+    def test_hash_based_up_to_date(self):
+        # Hash-based pycs are up to date as long as the content of their
+        # source doesn't change, whatever its mtime.
+        self.assertRunOK('-q', '--invalidation-mode', 'checked-hash',
+                         self.pkgdir)
+        pycpath = importlib.util.cache_from_source(self.barfn)
+        os.utime(pycpath, (time.time()-60,)*2)
+        mtime = os.stat(pycpath).st_mtime
+        os.utime(self.barfn, None)
+        self.assertRunOK('-q', '--invalidation-mode', 'checked-hash',
+                         self.pkgdir)
+        self.assertEqual(os.stat(pycpath).st_mtime, mtime)
+        with open(self.barfn, 'a') as fp:
+            fp.write('x = 1\n')
+        self.assertRunOK('-q', '--invalidation-mode', 'checked-hash',
+                         self.pkgdir)
+        self.assertNotEqual(os.stat(pycpath).st_mtime, mtime)
+
     def test_recursion_control(self):
         subpackage = os.path.join(self.pkgdir, 'spam')
         os.mkdir(subpackage)
@@ -469,6 +525,20 @@ class CommandLineTests(unittest.TestCase):
         for file in files:
             self.assertCompiled(file)
 
+    @skipUnless(_have_multiprocessing, "requires multiprocessing")
+    def test_workers_multiple_dests(self):
+        # The files of all the destinations are compiled by the same workers.
+        bar2fn = script_helper.make_script(self.directory, 'bar2', '')
+        otherdir = os.path.join(self.directory, 'other')
+        os.mkdir(otherdir)
+        otherfn = script_helper.make_script(otherdir, 'baz', '')
+        self.assertRunOK('-j', '2', self.pkgdir, otherdir, bar2fn,
+                         self.initfn)
+        self.assertCompiled(self.initfn)
+        self.assertCompiled(self.barfn)
+        self.assertCompiled(otherfn)
+        self.assertCompiled(bar2fn)
+
     @mock.patch('compileall.compile_dir')
     def test_workers_available_cores(self, compile_dir):
         with mock.patch("sys.argv",
@@ -3,9 +3,11 @@
 
 import unittest
 from test import support
+import array
 import os
 import io
 import struct
+zlib = support.import_module('zlib')
 gzip = support.import_module('gzip')
 
 data1 = b"""  int length=DEFAULTALLOC, err = Z_OK;
@@ -79,6 +81,39 @@ class TestGzip(BaseTest):
                 self.assertEqual(f.tell(), nread)
         self.assertEqual(b''.join(blocks), data1 * 50)
 
+    def test_readinto(self):
+        # Two members, padded with zeroes
+        with open(self.filename, 'wb') as f:
+            f.write(gzip.compress(data1 * 50) + gzip.compress(data2 * 50) +
+                    b'\0' * 10)
+        for size in (1, 100, 2000, 100000):
+            blocks = []
+            nread = 0
+            buf = bytearray(size)
+            with gzip.GzipFile(self.filename, 'r') as f:
+                blocks.append(f.read(10))
+                nread = 10
+                while True:
+                    n = f.readinto(buf)
+                    if not n:
+                        break
+                    blocks.append(bytes(buf[:n]))
+                    nread += n
+                    self.assertEqual(f.tell(), nread)
+            self.assertEqual(b''.join(blocks), data1 * 50 + data2 * 50)
+
+    def test_readinto_mixed(self):
+        self.test_write()
+        buf = array.array('I', bytes(1600))
+        with gzip.GzipFile(self.filename, 'r') as f:
+            self.assertEqual(f.peek(1)[:10], data1[:10])
+            self.assertEqual(f.readinto(buf), len(buf) * buf.itemsize)
+            self.assertEqual(f.read(100), (data1 * 50)[1600:1700])
+            self.assertEqual(f.readinto(bytearray()), 0)
+        self.assertEqual(buf.tobytes(), (data1 * 50)[:1600])
+        with gzip.GzipFile(self.filename, 'w') as f:
+            self.assertRaises(OSError, f.readinto, bytearray(10))
+
     def test_io_on_closed_object(self):
         # Test that I/O operations on closed GzipFile objects raise a
         # ValueError, just like the corresponding functions on file objects.
@@ -399,6 +434,65 @@ class TestGzip(BaseTest):
             datac = gzip.compress(data)
             self.assertEqual(gzip.decompress(datac), data)
 
+    def test_compress_threads(self):
+        block = gzip._ParallelDeflater.block_size
+        data = (data1 + data2) * (3 * block // len(data1 + data2))
+        for size in (0, 1, block - 1, block, block + 1, len(data)):
+            for args in [(), (0,), (1,), (9,)]:
+                datac = gzip.compress(data[:size], *args, threads=3)
+                self.assertEqual(gzip.decompress(datac), data[:size])
+                # A single standard gzip member
+                self.assertEqual(zlib.decompress(datac, 16 + zlib.MAX_WBITS),
+                                 data[:size])
+        self.assertEqual(gzip.compress(data, threads=0)[10:],
+                         gzip.compress(data, threads=os.cpu_count() or 1)[10:])
+        self.assertRaises(ValueError, gzip.compress, data, threads=-1)
+        for level in (-2, 10):
+            with self.assertRaises(ValueError):
+                gzip._ParallelDeflater(level, 2)
+            self.assertRaises(ValueError, gzip.compress, data, level, threads=2)
+
+    def test_compress_threads_pending(self):
+        # A large input does not queue all its blocks at once
+        class Deflater(gzip._ParallelDeflater):
+            block_size = 1000
+            def _submit(self, block):
+                pending.append(len(self._pending))
+                return super()._submit(block)
+        data = data1 * 3000
+        for chunks in ([data], [data[:500], data[500:1700], data[1700:]]):
+            pending = []
+            deflater = Deflater(6, 2)
+            datac = b''.join([deflater.compress(chunk) for chunk in chunks])
+            datac += deflater.flush()
+            self.assertEqual(zlib.decompressobj(-zlib.MAX_WBITS)
+                             .decompress(datac), data)
+            self.assertEqual(len(pending), -(-len(data) // 1000))
+            self.assertLessEqual(max(pending), 4)
+
+    def test_write_threads(self):
+        chunks = [data1 * 3000, data2, b'', data2 * 5000, data1 * 100]
+        with gzip.GzipFile(self.filename, 'wb', threads=2) as f:
+            for chunk, flush in zip(chunks, (None, zlib.Z_SYNC_FLUSH, None,
+                                            zlib.Z_FULL_FLUSH, None)):
+                f.write(chunk)
+                if flush is not None:
+                    f.flush(flush)
+        with gzip.open(self.filename, 'rb') as f:
+            self.assertEqual(f.read(), b''.join(chunks))
+        with gzip.open(self.filename, 'wb', threads=2) as f:
+            f.write(memoryview(data1 * 10000))
+        with gzip.open(self.filename, 'rb') as f:
+            self.assertEqual(f.read(), data1 * 10000)
+        # Cannot specify threads when reading
+        datac = gzip.compress(data1)
+        for threads in (0, 2):
+            self.assertRaises(ValueError, gzip.GzipFile,
+                              fileobj=io.BytesIO(datac), threads=threads)
+            with self.assertRaises(ValueError):
+                gzip.GzipFile(fileobj=io.BytesIO(datac), mode='rb',
+                              threads=threads)
+
     def test_read_truncated(self):
         data = data1*50
         # Drop the CRC (4 bytes) and file size (4 bytes).
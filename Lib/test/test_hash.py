@@ -23,7 +23,7 @@ def lcg(x, length=16):
     return bytes(out)
 
 def pysiphash(uint64):
-    """Convert SipHash24 output to Py_hash_t
+    """Convert SipHash13 or SipHash24 output to Py_hash_t
     """
     assert 0 <= uint64 < (1 << 64)
     # simple unsigned to signed int64
@@ -41,9 +41,9 @@ def pysiphash(uint64):
     return int32, int64
 
 def skip_unless_internalhash(test):
-    """Skip decorator for tests that depend on SipHash24 or FNV"""
-    ok = sys.hash_info.algorithm in {"fnv", "siphash24"}
-    msg = "Requires SipHash24 or FNV"
+    """Skip decorator for tests that depend on SipHash or FNV"""
+    ok = sys.hash_info.algorithm in {"fnv", "siphash13", "siphash24"}
+    msg = "Requires SipHash13, SipHash24 or FNV"
     return test if ok else unittest.skip(msg)(test)
 
 
@@ -88,6 +88,15 @@ class HashEqualityTestCase(unittest.TestCase):
                 unaligned = memoryview(b)[i:128+j]
                 self.assertEqual(hash(aligned), hash(unaligned))
 
+    def test_short_buffers(self):
+        # Short strings are hashed with loads which may overlap each other,
+        # the result must not depend on the bytes around the buffer.
+        b = bytes(range(1, 41))
+        for n in range(1, 33):
+            for pad in range(1, 9):
+                buf = b'\xff' * pad + b[:n] + b'\xee' * pad
+                self.same_hash(b[:n], memoryview(buf)[pad:pad+n])
+
 
 _default_hash = object.__hash__
 class DefaultHash(object): pass
@@ -219,6 +228,19 @@ class StringlikeHashRandomizationTests(HashRandomizationTests):
             # seed 42, 'äú∑ℇ'
             [-1677110816, -2947981342227738144, -1860207793, -4296699217652516017],
         ],
+        'siphash13': [
+            # NOTE: PyUCS2 layout depends on endianess
+            # seed 0, 'abc'
+            [69611762, -4594863902769663758, 69611762, -4594863902769663758],
+            # seed 42, 'abc'
+            [-975800855, 3869580338025362921, -975800855, 3869580338025362921],
+            # seed 42, 'abcdefghijk'
+            [-595844228, 7764564197781545852, -595844228, 7764564197781545852],
+            # seed 0, 'äú∑ℇ'
+            [-1093288643, -2810468059467891395, -1041341092, 4925090034378237276],
+            # seed 42, 'äú∑ℇ'
+            [-585999602, -2845126246016066802, -817336969, -2219421378907968137],
+        ],
         'fnv': [
             # seed 0, 'abc'
             [-1600925533, 1453079729188098211, -1600925533,
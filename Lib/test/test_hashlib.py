@@ -8,6 +8,7 @@
 
 import array
 import hashlib
+import io
 import itertools
 import os
 import sys
@@ -433,6 +434,89 @@ class HashLibTestCase(unittest.TestCase):
 
         self.assertEqual(expected_hash, hasher.hexdigest())
 
+    @unittest.skipUnless(threading, 'Threading required for this test.')
+    @support.reap_threads
+    def test_threaded_hashing_all_algorithms(self):
+        # Same as above for every constructor: the builtin implementations
+        # release the GIL for large updates too.
+        data = b'swineflu' * 20000
+        chunk_sizes = (len(data), len(data) // 4, 4096, 2048)
+        for cons in self.hash_constructors:
+            hasher = cons()
+            expected_hash = cons(data * len(chunk_sizes)).hexdigest()
+
+            def hash_in_chunks(chunk_size):
+                for index in range(0, len(data), chunk_size):
+                    hasher.update(data[index:index+chunk_size])
+
+            threads = [threading.Thread(target=hash_in_chunks, args=(size,))
+                       for size in chunk_sizes]
+            for thread in threads:
+                thread.start()
+            for thread in threads:
+                thread.join()
+            self.assertEqual(expected_hash, hasher.hexdigest())
+
+    def test_file_digest(self):
+        data = b'a' * 65536 + b'b' * 1000 + b'c'
+        self.addCleanup(support.unlink, support.TESTFN)
+        with open(support.TESTFN, 'wb') as f:
+            f.write(data)
+
+        for name in self.supported_hash_names:
+            expected = hashlib.new(name, data).hexdigest()
+            for digest in (name, getattr(hashlib, name.lower())):
+                with open(support.TESTFN, 'rb') as f:
+                    d = hashlib.file_digest(f, digest, _bufsize=4096)
+                    self.assertEqual(d.hexdigest(), expected)
+                with open(support.TESTFN, 'rb', buffering=0) as f:
+                    d = hashlib.file_digest(f.fileno(), digest)
+                    self.assertEqual(d.hexdigest(), expected)
+                    # the descriptor is not closed
+                    self.assertFalse(f.closed)
+                    os.fstat(f.fileno())
+                d = hashlib.file_digest(io.BytesIO(data), digest, _bufsize=1000)
+                self.assertEqual(d.hexdigest(), expected)
+
+        with open(support.TESTFN, 'r') as f:
+            self.assertRaises(ValueError, hashlib.file_digest, f, 'sha256')
+        with open(support.TESTFN, 'wb') as f:
+            self.assertRaises(ValueError, hashlib.file_digest, f, 'sha256')
+        self.assertRaises(ValueError, hashlib.file_digest, object(), 'sha256')
+
+    @unittest.skipUnless(hasattr(os, 'set_blocking'), 'needs os.set_blocking()')
+    def test_file_digest_nonblocking(self):
+        r, w = os.pipe()
+        self.addCleanup(os.close, r)
+        self.addCleanup(os.close, w)
+        os.set_blocking(r, False)
+        os.write(w, b'abc')
+        # readinto() returns None once the pipe is drained, which must not
+        # be mistaken for the end of the file
+        self.assertRaises(BlockingIOError, hashlib.file_digest, r, 'sha256')
+        with open(r, 'rb', buffering=0, closefd=False) as f:
+            self.assertRaises(BlockingIOError, hashlib.file_digest, f, 'sha256')
+
+    def test_digest_many(self):
+        messages = [b'', b'abc', bytearray(b'x' * 1000), memoryview(b'y' * 55),
+                    array.array('b', range(64))] + [os.urandom(n)
+                                                    for n in range(0, 300, 13)]
+        for name in self.supported_hash_names:
+            expected = [hashlib.new(name, m).digest() for m in messages]
+            self.assertEqual(hashlib.digest_many(name, messages), expected)
+            # large enough to release the GIL, and any iterable
+            big = (b'z' * n for n in range(0, 5000, 100))
+            self.assertEqual(hashlib.digest_many(name, big),
+                             [hashlib.new(name, b'z' * n).digest()
+                              for n in range(0, 5000, 100)])
+            self.assertEqual(hashlib.digest_many(name, []), [])
+            self.assertRaises(TypeError, hashlib.digest_many, name,
+                              [b'abc', 'abc'])
+            self.assertRaises(TypeError, hashlib.digest_many, name,
+                              [b'abc', 1])
+            self.assertRaises(TypeError, hashlib.digest_many, name, 1)
+        self.assertRaises(ValueError, hashlib.digest_many, 'spam', [b'abc'])
+
 
 class KDFTests(unittest.TestCase):
 
@@ -427,6 +427,11 @@ constant = 1
 def func():
     pass
 func_filename = func.__code__.co_filename
+def outer():
+    def inner():
+        pass
+    return inner
+inner_filename = outer().__code__.co_filename
 """
     dir_name = os.path.abspath(TESTFN)
     file_name = os.path.join(dir_name, module_name) + os.extsep + "py"
@@ -473,6 +478,7 @@ func_filename = func.__code__.co_filename
         self.assertEqual(mod.module_filename, self.file_name)
         self.assertEqual(mod.code_filename, self.file_name)
         self.assertEqual(mod.func_filename, self.file_name)
+        self.assertEqual(mod.inner_filename, self.file_name)
 
     def test_module_without_source(self):
         target = "another_module.py"
@@ -488,7 +494,7 @@ func_filename = func.__code__.co_filename
     def test_foreign_code(self):
         py_compile.compile(self.file_name)
         with open(self.compiled_name, "rb") as f:
-            header = f.read(12)
+            header = f.read(16)
             code = marshal.load(f)
         constants = list(code.co_consts)
         foreign_code = importlib.import_module.__code__
@@ -3,7 +3,12 @@ from .. import util
 
 machinery = util.import_importlib('importlib.machinery')
 
+import importlib.machinery
+import os
+import sysconfig
+import traceback
 import unittest
+from test import script_helper
 
 
 class FindSpecTests(abc.FinderTests):
@@ -80,5 +85,75 @@ class FinderTests(abc.FinderTests):
  ) = util.test_both(FinderTests, machinery=machinery)
 
 
+@unittest.skipUnless(sysconfig.get_config_var('Py_FROZEN_STDLIB'),
+                     'requires configure --with-frozen-stdlib')
+class FrozenStdlibTests:
+
+    """Test modules of the standard library frozen at build time."""
+
+    def find(self, name):
+        return self.machinery.FrozenImporter.find_spec(name)
+
+    def test_module(self):
+        spec = self.find('os')
+        source = self.machinery.PathFinder.find_spec('os')
+        self.assertIs(spec.loader, self.machinery.FrozenImporter)
+        self.assertTrue(spec.has_location)
+        self.assertEqual(spec.origin, source.origin)
+        self.assertEqual(spec.cached, source.cached)
+        self.assertIsNone(spec.submodule_search_locations)
+
+    def test_package(self):
+        spec = self.find('encodings')
+        source = self.machinery.PathFinder.find_spec('encodings')
+        self.assertEqual(spec.origin, source.origin)
+        self.assertEqual(spec.submodule_search_locations,
+                         source.submodule_search_locations)
+
+    def test_not_frozen(self):
+        self.assertIsNone(self.find('tabnanny'))
+        self.assertEqual(self.find('__hello__').origin, 'frozen')
+
+
+(Frozen_FrozenStdlibTests,
+ Source_FrozenStdlibTests
+ ) = util.test_both(FrozenStdlibTests, machinery=machinery)
+
+
+@unittest.skipUnless(sysconfig.get_config_var('Py_FROZEN_STDLIB'),
+                     'requires configure --with-frozen-stdlib')
+class FrozenStdlibStartupTests(unittest.TestCase):
+
+    """Test the modules of the standard library imported at startup."""
+
+    def test_attributes(self):
+        source = importlib.machinery.PathFinder.find_spec('os')
+        self.assertIs(os.__loader__, importlib.machinery.FrozenImporter)
+        self.assertEqual(os.__file__, source.origin)
+        self.assertEqual(os.__cached__, source.cached)
+        # Submodules of frozen packages are found on the file system.
+        encodings = importlib.import_module('encodings')
+        idna = importlib.import_module('encodings.idna')
+        self.assertEqual(os.path.dirname(idna.__file__),
+                         encodings.__path__[0])
+
+    def test_traceback(self):
+        try:
+            os.makedirs(os.path.join(__file__, 'dir'))
+        except OSError as exc:
+            frames = traceback.extract_tb(exc.__traceback__)
+        else:
+            self.fail('OSError not raised')
+        filename, lineno, name, line = frames[-1]
+        self.assertEqual(filename, os.__file__)
+        self.assertIn('mkdir', line)
+
+    def test_frozen_modules_off(self):
+        script_helper.assert_python_ok('-X', 'frozen_modules=off', '-c',
+            'import os, importlib.machinery\n'
+            'assert isinstance(os.__loader__, '
+            'importlib.machinery.SourceFileLoader)')
+
+
 if __name__ == '__main__':
     unittest.main()
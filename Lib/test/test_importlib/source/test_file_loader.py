@@ -15,6 +15,7 @@ import stat
 import sys
 import types
 import unittest
+from unittest import mock
 import warnings
 
 from test.support import make_legacy_pyc, unload
@@ -224,6 +225,65 @@ class SimpleTest(abc.LoaderTests):
             # The pyc file was created.
             self.assertTrue(os.path.exists(compiled))
 
+    def _compile_hash_based(self, source, checked):
+        # Write a hash-based pyc for *source* and change the source behind
+        # its back, keeping the same size.
+        with open(source, 'wb') as f:
+            f.write(b'x = 5')
+        py_compile.compile(source, invalidation_mode=(
+                py_compile.PycInvalidationMode.CHECKED_HASH if checked else
+                py_compile.PycInvalidationMode.UNCHECKED_HASH))
+        with open(source, 'wb') as f:
+            f.write(b'x = 6')
+
+    def _load_x(self, source):
+        loader = self.machinery.SourceFileLoader('_temp', source)
+        module = types.ModuleType('_temp')
+        module.__spec__ = self.util.spec_from_loader('_temp', loader)
+        loader.exec_module(module)
+        return module.x
+
+    @util.writes_bytecode_files
+    def test_checked_hash_based_pyc(self):
+        with util.create_modules('_temp') as mapping:
+            source = mapping['_temp']
+            self._compile_hash_based(source, checked=True)
+            self.assertEqual(self._load_x(source), 6)
+            # The pyc was recreated, still as a checked hash-based one.
+            with open(self.util.cache_from_source(source), 'rb') as f:
+                data = f.read()
+            self.assertEqual(data[:4], self.util.MAGIC_NUMBER)
+            self.assertEqual(self.importlib._r_long(data[4:8]), 0b11)
+            self.assertEqual(data[8:16], self.util.source_hash(b'x = 6'))
+
+    @util.writes_bytecode_files
+    def test_unchecked_hash_based_pyc(self):
+        with util.create_modules('_temp') as mapping:
+            source = mapping['_temp']
+            self._compile_hash_based(source, checked=False)
+            bytecode_path = self.util.cache_from_source(source)
+            with open(bytecode_path, 'rb') as f:
+                data = f.read()
+            self.assertEqual(self.importlib._r_long(data[4:8]), 0b01)
+            # The source is not looked at, so the stale pyc is used as is.
+            self.assertEqual(self._load_x(source), 5)
+            with open(bytecode_path, 'rb') as f:
+                self.assertEqual(f.read(), data)
+
+    @util.writes_bytecode_files
+    def test_check_hash_based_pycs_option(self):
+        # -X check_hash_based_pycs overrides the flags of the pyc.
+        with util.create_modules('_temp') as mapping:
+            source = mapping['_temp']
+            self._compile_hash_based(source, checked=False)
+            with mock.patch.dict(sys._xoptions,
+                                 check_hash_based_pycs='always'):
+                self.assertEqual(self._load_x(source), 6)
+            self._compile_hash_based(source, checked=True)
+            with mock.patch.dict(sys._xoptions,
+                                 check_hash_based_pycs='never'):
+                self.assertEqual(self._load_x(source), 5)
+
     def test_unloadable(self):
         loader = self.machinery.SourceFileLoader('good name', {})
         module = types.ModuleType('bad name')
@@ -302,21 +362,21 @@ class BadBytecodeTest:
     def _test_partial_timestamp(self, test, *, del_source=False):
         with util.create_modules('_temp') as mapping:
             bc_path = self.manipulate_bytecode('_temp', mapping,
-                                                lambda bc: bc[:7],
+                                                lambda bc: bc[:11],
                                                 del_source=del_source)
             test('_temp', mapping, bc_path)
 
     def _test_partial_size(self, test, *, del_source=False):
         with util.create_modules('_temp') as mapping:
             bc_path = self.manipulate_bytecode('_temp', mapping,
-                                                lambda bc: bc[:11],
+                                                lambda bc: bc[:15],
                                                 del_source=del_source)
             test('_temp', mapping, bc_path)
 
     def _test_no_marshal(self, *, del_source=False):
         with util.create_modules('_temp') as mapping:
             bc_path = self.manipulate_bytecode('_temp', mapping,
-                                                lambda bc: bc[:12],
+                                                lambda bc: bc[:16],
                                                 del_source=del_source)
             file_path = mapping['_temp'] if not del_source else bc_path
             with self.assertRaises(EOFError):
@@ -325,7 +385,7 @@ class BadBytecodeTest:
     def _test_non_code_marshal(self, *, del_source=False):
         with util.create_modules('_temp') as mapping:
             bytecode_path = self.manipulate_bytecode('_temp', mapping,
-                                    lambda bc: bc[:12] + marshal.dumps(b'abcd'),
+                                    lambda bc: bc[:16] + marshal.dumps(b'abcd'),
                                     del_source=del_source)
             file_path = mapping['_temp'] if not del_source else bytecode_path
             with self.assertRaises(ImportError) as cm:
@@ -336,7 +396,7 @@ class BadBytecodeTest:
     def _test_bad_marshal(self, *, del_source=False):
         with util.create_modules('_temp') as mapping:
             bytecode_path = self.manipulate_bytecode('_temp', mapping,
-                                                lambda bc: bc[:12] + b'<test>',
+                                                lambda bc: bc[:16] + b'<test>',
                                                 del_source=del_source)
             file_path = mapping['_temp'] if not del_source else bytecode_path
             with self.assertRaises(EOFError):
@@ -381,7 +441,7 @@ class SourceLoaderBadBytecodeTest:
         def test(name, mapping, bytecode_path):
             self.import_(mapping[name], name)
             with open(bytecode_path, 'rb') as file:
-                self.assertGreater(len(file.read()), 12)
+                self.assertGreater(len(file.read()), 16)
 
         self._test_empty_file(test)
 
@@ -389,7 +449,7 @@ class SourceLoaderBadBytecodeTest:
         def test(name, mapping, bytecode_path):
             self.import_(mapping[name], name)
             with open(bytecode_path, 'rb') as file:
-                self.assertGreater(len(file.read()), 12)
+                self.assertGreater(len(file.read()), 16)
 
         self._test_partial_magic(test)
 
@@ -400,7 +460,7 @@ class SourceLoaderBadBytecodeTest:
         def test(name, mapping, bytecode_path):
             self.import_(mapping[name], name)
             with open(bytecode_path, 'rb') as file:
-                self.assertGreater(len(file.read()), 12)
+                self.assertGreater(len(file.read()), 16)
 
         self._test_magic_only(test)
 
@@ -423,7 +483,7 @@ class SourceLoaderBadBytecodeTest:
         def test(name, mapping, bc_path):
             self.import_(mapping[name], name)
             with open(bc_path, 'rb') as file:
-                self.assertGreater(len(file.read()), 12)
+                self.assertGreater(len(file.read()), 16)
 
         self._test_partial_timestamp(test)
 
@@ -434,7 +494,7 @@ class SourceLoaderBadBytecodeTest:
         def test(name, mapping, bc_path):
             self.import_(mapping[name], name)
             with open(bc_path, 'rb') as file:
-                self.assertGreater(len(file.read()), 12)
+                self.assertGreater(len(file.read()), 16)
 
         self._test_partial_size(test)
 
@@ -464,13 +524,13 @@ class SourceLoaderBadBytecodeTest:
             py_compile.compile(mapping['_temp'])
             bytecode_path = self.util.cache_from_source(mapping['_temp'])
             with open(bytecode_path, 'r+b') as bytecode_file:
-                bytecode_file.seek(4)
+                bytecode_file.seek(8)
                 bytecode_file.write(zeros)
             self.import_(mapping['_temp'], '_temp')
             source_mtime = os.path.getmtime(mapping['_temp'])
             source_timestamp = self.importlib._w_long(source_mtime)
             with open(bytecode_path, 'rb') as bytecode_file:
-                bytecode_file.seek(4)
+                bytecode_file.seek(8)
                 self.assertEqual(bytecode_file.read(4), source_timestamp)
 
     # [bytecode read-only]
@@ -143,6 +143,56 @@ class FinderTests(abc.FinderTests):
         finder.invalidate_caches()
         self.assertEqual(finder._path_mtime, -1)
 
+    @util.writes_bytecode_files
+    def test_directory_index(self):
+        # The contents of a directory are recorded in an index in its
+        # __pycache__ subdirectory, which later finders read instead.
+        with util.create_modules('mod') as mapping:
+            root = mapping['.root']
+            pycache = os.path.join(root, '__pycache__')
+            os.mkdir(pycache)
+            # The index is only kept if the directory is older than it.
+            mtime = os.stat(root).st_mtime - 60
+            os.utime(root, (mtime, mtime))
+            found = self._find(self.get_finder(root), 'mod', loader_only=True)
+            self.assertIsNotNone(found)
+            self.assertEqual(len(os.listdir(pycache)), 1)
+            # Hide the renaming of the module from the index.
+            os.rename(mapping['mod'], os.path.join(root, 'other.py'))
+            os.utime(root, (mtime, mtime))
+            finder = self.get_finder(root)
+            found = self._find(finder, 'mod', loader_only=True)
+            self.assertIsNotNone(found)
+            # invalidate_caches() rebuilds the index.
+            finder.invalidate_caches()
+            self.assertEqual(self._find(finder, 'mod'), self.NOT_FOUND)
+            found = self._find(finder, 'other', loader_only=True)
+            self.assertIsNotNone(found)
+            finder = self.get_finder(root)
+            self.assertEqual(self._find(finder, 'mod'), self.NOT_FOUND)
+
+    @util.writes_bytecode_files
+    def test_directory_index_recently_modified(self):
+        # A directory modified too recently could still be modified within
+        # the granularity of its timestamp, so it is not indexed.
+        with util.create_modules('mod') as mapping:
+            pycache = os.path.join(mapping['.root'], '__pycache__')
+            os.mkdir(pycache)
+            finder = self.get_finder(mapping['.root'])
+            self.assertIsNotNone(self._find(finder, 'mod', loader_only=True))
+            self.assertEqual(os.listdir(pycache), [])
+
+    @util.writes_bytecode_files
+    def test_directory_index_without_pycache(self):
+        # No __pycache__ subdirectory is created just for the index.
+        with util.create_modules('mod') as mapping:
+            root = mapping['.root']
+            mtime = os.stat(root).st_mtime - 60
+            os.utime(root, (mtime, mtime))
+            finder = self.get_finder(root)
+            self.assertIsNotNone(self._find(finder, 'mod', loader_only=True))
+            self.assertEqual(os.listdir(root), ['mod.py'])
+
     # Regression test for http://bugs.python.org/issue14846
     def test_dir_removal_handling(self):
         mod = 'mod'
@@ -656,6 +656,7 @@ class SourceLoader(SourceOnlyLoader):
         if magic is None:
             magic = self.util.MAGIC_NUMBER
         data = bytearray(magic)
+        data.extend(self.init._w_long(0))
         data.extend(self.init._w_long(self.source_mtime))
         data.extend(self.init._w_long(self.source_size))
         code_object = compile(self.source, self.path, 'exec',
@@ -819,6 +820,7 @@ class SourceLoaderBytecodeTests(SourceLoaderTestHarness):
         if bytecode_written:
             self.assertIn(self.cached, self.loader.written)
             data = bytearray(self.util.MAGIC_NUMBER)
+            data.extend(self.init._w_long(0))
             data.extend(self.init._w_long(self.loader.source_mtime))
             data.extend(self.init._w_long(self.loader.source_size))
             data.extend(marshal.dumps(code_object))
@@ -859,6 +861,34 @@ class SourceLoaderBytecodeTests(SourceLoaderTestHarness):
         code_object = self.loader.get_code(self.name)
         self.verify_code(code_object, bytecode_written=True)
 
+    def test_unchecked_hash_based_pyc(self):
+        # Unchecked hash-based bytecode is used without looking at the source.
+        code_object = compile(self.loader.source, self.path, 'exec',
+                              dont_inherit=True)
+        self.loader.bytecode = bytes(self.init._bootstrap._code_to_hash_pyc(
+                code_object, b'\x00' * 8, checked=False))
+        def raise_OSError(*args):
+            raise OSError
+        self.loader.path_stats = raise_OSError
+        self.loader.get_data = lambda path: self.loader.bytecode
+        code_object = self.loader.get_code(self.name)
+        self.verify_code(code_object)
+        self.assertNotIn(self.cached, self.loader.written)
+
+    def test_checked_hash_based_pyc(self):
+        # Checked hash-based bytecode is recreated, still hash-based, when
+        # the hash of the source differs from the one it holds.
+        code_object = compile(self.loader.source, self.path, 'exec',
+                              dont_inherit=True)
+        self.loader.bytecode = bytes(self.init._bootstrap._code_to_hash_pyc(
+                code_object, b'\x00' * 8, checked=True))
+        code_object = self.loader.get_code(self.name)
+        self.verify_code(code_object)
+        source_hash = self.util.source_hash(self.loader.source)
+        expected = self.init._bootstrap._code_to_hash_pyc(
+                code_object, source_hash, checked=True)
+        self.assertEqual(self.loader.written[self.cached], bytes(expected))
+
     def test_dont_write_bytecode(self):
         # Bytecode is not written if sys.dont_write_bytecode is true.
         # Can assume it is false already thanks to the skipIf class decorator.
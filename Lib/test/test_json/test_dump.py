@@ -1,4 +1,4 @@
-from io import StringIO
+from io import BytesIO, StringIO
 from test.test_json import PyTest, CTest
 
 from test.support import bigmemtest, _1G
@@ -12,6 +12,39 @@ class TestDump:
     def test_dumps(self):
         self.assertEqual(self.dumps({}), '{}')
 
+    def test_dumps_bytes(self):
+        self.assertEqual(self.json.dumps_bytes({}), b'{}')
+        obj = {'b': [1, 2.5, -3, 2**70, None, True, False, '\xe9\u20ac'],
+               'a': {'x': ('\U0001f600', [])}}
+        for kwargs in ({}, {'ensure_ascii': False}, {'sort_keys': True},
+                       {'indent': 2, 'separators': (',', ':')},
+                       {'indent': '\t', 'ensure_ascii': False}):
+            self.assertEqual(self.json.dumps_bytes(obj, **kwargs),
+                             self.dumps(obj, **kwargs).encode('utf-8'))
+
+    def test_dumps_bytes_surrogates(self):
+        self.assertEqual(self.json.dumps_bytes('\ud800'), b'"\\ud800"')
+        self.assertRaises(UnicodeEncodeError, self.json.dumps_bytes,
+                          ['\ud800'], ensure_ascii=False)
+        self.assertEqual(self.dumps(['\ud800'], ensure_ascii=False),
+                         '["\ud800"]')
+
+    def test_dump_binary_file(self):
+        bio = BytesIO()
+        self.json.dump({'\xe9': [1]}, bio, ensure_ascii=False, indent=1)
+        self.assertEqual(bio.getvalue(), '{\n "\xe9": [\n  1\n ]\n}'.encode())
+
+    def test_dump_binary_file_custom_encoder(self):
+        class Encoder(self.json.JSONEncoder):
+            def iterencode(self, o, _one_shot=False):
+                yield '\xe9'
+                yield from super().iterencode(o, _one_shot)
+        bio = BytesIO()
+        self.json.dump([1], bio, cls=Encoder)
+        self.assertEqual(bio.getvalue(), '\xe9[1]'.encode())
+        self.assertEqual(self.json.dumps_bytes([1], cls=Encoder),
+                         '\xe9[1]'.encode())
+
     def test_encode_truefalse(self):
         self.assertEqual(self.dumps(
                  {True: False, False: True}, sort_keys=True),
@@ -12,13 +12,39 @@ class TestSpeedups(CTest):
         self.assertIs(self.json.encoder.encode_basestring_ascii,
                       self.json.encoder.c_encode_basestring_ascii)
 
+    def test_encode_basestring(self):
+        self.assertEqual(self.json.encoder.encode_basestring.__module__,
+                         "_json")
+        self.assertIs(self.json.encoder.encode_basestring,
+                      self.json.encoder.c_encode_basestring)
+
 
 class TestDecode(CTest):
     def test_make_scanner(self):
         self.assertRaises(AttributeError, self.json.scanner.c_make_scanner, 1)
 
+    def test_make_stream_parser(self):
+        self.assertIs(self.json.scanner.make_stream_parser,
+                      self.json.scanner.c_make_stream_parser)
+        self.assertRaises(AttributeError,
+                          self.json.scanner.c_make_stream_parser, 1)
+        self.assertRaises(TypeError,
+                          self.json.scanner.c_make_stream_parser,
+                          self.json.JSONDecoder(), 1)
+
     def test_make_encoder(self):
         self.assertRaises(TypeError, self.json.encoder.c_make_encoder,
             (True, False),
             b"\xCD\x7D\x3D\x4E\x12\x4C\xF9\x79\xD7\x52\xBA\x82\xF2\x27\x4A\x7D\xA0\xCA\x75",
             None)
+
+    def test_make_encoder_indent(self):
+        self.assertRaises(TypeError, self.json.encoder.c_make_encoder,
+            None, None, self.json.encoder.encode_basestring_ascii, 4,
+            ':', ',', False, False, True)
+        enc = self.json.encoder.c_make_encoder(
+            None, None, self.json.encoder.encode_basestring_ascii, '  ',
+            ': ', ',', False, False, True)
+        self.assertEqual(enc([1, {'a': 2}], 0), ['[\n  1,\n  {\n    "a": 2\n  }\n]'])
+        self.assertEqual(enc.encode_bytes({'a': [None]}),
+                         b'{\n  "a": [\n    null\n  ]\n}')
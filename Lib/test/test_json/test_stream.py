@@ -0,0 +1,192 @@
+import decimal
+from io import StringIO, BytesIO
+from collections import OrderedDict
+from test.test_json import PyTest, CTest
+
+
+DOC = (b'{"a": [1, -2.5e3, "x\\u00e9\\n", true, false, null, {}],'
+       b' "b\xc3\xa9": {"c": []}}\n'
+       b'[1, 2]\n 3 "s" 12\n')
+VALUES = [{'a': [1, -2500.0, 'x\xe9\n', True, False, None, {}],
+           'b\xe9': {'c': []}},
+          [1, 2], 3, 's', 12]
+
+
+class TestStream:
+    def parse(self, data, mode='values', step=None, **kw):
+        parser = self.json.JSONDecoder(**kw).stream_parser(mode)
+        result = []
+        step = step or len(data) or 1
+        for i in range(0, len(data), step):
+            result.extend(parser.feed(data[i:i + step]))
+        result.extend(parser.close())
+        return result
+
+    def test_values(self):
+        self.assertEqual(self.parse(DOC), VALUES)
+        self.assertEqual(self.parse(b''), [])
+        self.assertEqual(self.parse(b' \n\t'), [])
+
+    def test_chunks(self):
+        # The result must not depend on where the chunks are split
+        for step in (1, 2, 3, 5, 7, 16):
+            with self.subTest(step=step):
+                self.assertEqual(self.parse(DOC, step=step), VALUES)
+
+    def test_values_completed_by_feed(self):
+        parser = self.json.JSONDecoder().stream_parser()
+        self.assertEqual(parser.feed(b'{"a": 1}\n{"b"'), [{'a': 1}])
+        self.assertEqual(parser.feed(b': 2}\n[3'), [{'b': 2}])
+        self.assertEqual(parser.feed(b']\n12'), [[3]])
+        # A number may continue in the next chunk
+        self.assertEqual(parser.feed(b'3'), [])
+        self.assertEqual(parser.close(), [123])
+
+    def test_json_lines(self):
+        records = [{'id': i, 'name': 'n%d' % i, 'tags': ['t'] * (i % 3)}
+                   for i in range(100)]
+        data = b''.join(self.json.dumps_bytes(r) + b'\n' for r in records)
+        self.assertEqual(self.parse(data, step=100), records)
+
+    def test_numbers(self):
+        data = b'0 -0 1.5 -1e5 2E+3 1e-2 12345678901234567890123 NaN -Infinity'
+        for step in (1, 4, 100):
+            result = self.parse(data, step=step)
+            self.assertEqual(result[:7], [0, 0, 1.5, -1e5, 2e3, 1e-2,
+                                          12345678901234567890123])
+            self.assertNotEqual(result[7], result[7])
+            self.assertEqual(result[8], float('-inf'))
+        result = self.parse(b'1.1 2', step=1, parse_float=decimal.Decimal,
+                            parse_int=float)
+        self.assertEqual(result, [decimal.Decimal('1.1'), 2.0])
+        self.assertIsInstance(result[1], float)
+
+    def test_strings(self):
+        data = self.json.dumps_bytes(['€\U0001f600', 'a\\"b', '\\',
+                                      '\x00\x1f', 'x' * 1000],
+                                     ensure_ascii=False)
+        for step in (1, 3, 64):
+            self.assertEqual(self.parse(data, step=step),
+                             [['€\U0001f600', 'a\\"b', '\\',
+                               '\x00\x1f', 'x' * 1000]])
+        self.assertEqual(self.parse(b'"a\tb"', strict=False), ['a\tb'])
+
+    def test_items(self):
+        data = b'[{"a": 1}, [2], 3]\n[]\n["x"]'
+        for step in (1, 5, 100):
+            self.assertEqual(self.parse(data, 'items', step),
+                             [{'a': 1}, [2], 3, 'x'])
+        parser = self.json.JSONDecoder().stream_parser('items')
+        self.assertEqual(parser.feed(b'[1, [2, 3], {"a"'), [1, [2, 3]])
+        self.assertEqual(parser.feed(b': 4}]'), [{'a': 4}])
+        self.assertEqual(parser.close(), [])
+
+    def test_events(self):
+        self.assertEqual(self.parse(b'{"a": [1, {"b": null}]} 2', 'events', 1),
+                         [('start_object', None), ('key', 'a'),
+                          ('start_array', None), ('value', 1),
+                          ('start_object', None), ('key', 'b'),
+                          ('value', None), ('end_object', None),
+                          ('end_array', None), ('end_object', None),
+                          ('value', 2)])
+
+    def test_hooks(self):
+        data = b'{"b": 1, "a": {"c": 2}}'
+        self.assertEqual(self.parse(data, object_pairs_hook=list),
+                         [[('b', 1), ('a', [('c', 2)])]])
+        result = self.parse(data, object_pairs_hook=OrderedDict)
+        self.assertEqual(list(result[0]), ['b', 'a'])
+        self.assertIsInstance(result[0]['a'], OrderedDict)
+        self.assertEqual(self.parse(data, object_hook=len), [2])
+
+    def test_memo(self):
+        result = self.parse(b'{"key": 1} {"key": 2}', step=1)
+        key1, = result[0]
+        key2, = result[1]
+        self.assertIs(key1, key2)
+
+    def test_errors(self):
+        test_cases = [
+            (b'[1,', 'Expecting value', 3),
+            (b'{', 'Expecting property name enclosed in double quotes', 1),
+            (b'{"a"', "Expecting ':' delimiter", 4),
+            (b'{"a":1 "b"', "Expecting ',' delimiter", 7),
+            (b'[1]]', 'Extra data', 3),
+            (b'"abc', 'Unterminated string starting at', 0),
+            (b'tru', 'Expecting value', 0),
+            (b'[\xff]', 'Expecting value', 1),
+            (b'{1:2}', 'Expecting property name enclosed in double quotes',
+             1),
+            (b'"a\x01"', 'Invalid control character at', 2),
+            # Top-level values must be separated by whitespace
+            (b'1true', 'Extra data', 1),
+            (b'nulltrue', 'Extra data', 4),
+            (b'[1]2', 'Extra data', 3),
+            (b'{}{}', 'Extra data', 2),
+            (b'"a""b"', 'Extra data', 3),
+            (b'1 2[3]', 'Extra data', 3),
+        ]
+        for data, msg, idx in test_cases:
+            for step in (1, 100):
+                with self.subTest(data=data, step=step):
+                    with self.assertRaisesRegex(
+                            ValueError,
+                            r'^%s: line 1 column %d \(byte %d\)$'
+                            % (msg, idx + 1, idx)):
+                        self.parse(data, step=step)
+        with self.assertRaisesRegex(ValueError,
+                                    r'line 3 column 4 \(byte 7\)'):
+            self.parse(b'1\n2\n  [x]', step=2)
+        with self.assertRaisesRegex(ValueError, "Expecting '\\['"):
+            self.parse(b'3', 'items')
+        with self.assertRaisesRegex(ValueError, 'Extra data'):
+            self.parse(b'[1][2]', 'items')
+        with self.assertRaisesRegex(ValueError, 'invalid mode'):
+            self.json.JSONDecoder().stream_parser('spam')
+
+    def test_invalid_utf8(self):
+        with self.assertRaises(UnicodeDecodeError):
+            self.parse(b'["\xff"]')
+        with self.assertRaises(UnicodeDecodeError):
+            self.parse(b'{"\xc3": 1}')
+
+    def test_reset_after_error(self):
+        parser = self.json.JSONDecoder().stream_parser()
+        self.assertEqual(parser.feed(b'[1, 2'), [])
+        with self.assertRaises(ValueError):
+            parser.feed(b']]')
+        self.assertEqual(parser.feed(b'[3]'), [[3]])
+        self.assertEqual(parser.close(), [])
+
+    def test_feed_types(self):
+        parser = self.json.JSONDecoder().stream_parser()
+        self.assertEqual(parser.feed(bytearray(b'[1] ')), [[1]])
+        self.assertEqual(parser.feed(memoryview(b'[2] ')), [[2]])
+        self.assertRaises(TypeError, parser.feed, '[3]')
+
+    def test_iterload(self):
+        data = DOC.decode('utf-8')
+        self.assertEqual(list(self.json.iterload(BytesIO(DOC))), VALUES)
+        self.assertEqual(list(self.json.iterload(StringIO(data))), VALUES)
+        self.assertEqual(list(self.json.iterload(BytesIO(DOC),
+                                                 chunk_size=3)), VALUES)
+        self.assertEqual(list(self.json.iterload(BytesIO(b'[1, [2]] [3]'),
+                                                 mode='items')), [1, [2], 3])
+        self.assertEqual(list(self.json.iterload(BytesIO(b'{"a": 1}'),
+                                                 object_pairs_hook=list)),
+                         [[('a', 1)]])
+
+    def test_iterload_large_array(self):
+        count = 10000
+        data = ('[' + ', '.join('{"i": %d}' % i for i in range(count))
+                + ']').encode('ascii')
+        it = self.json.iterload(BytesIO(data), mode='items',
+                                chunk_size=1024)
+        self.assertEqual(next(it), {'i': 0})
+        for i, item in enumerate(it, 1):
+            self.assertEqual(item, {'i': i})
+        self.assertEqual(i, count - 1)
+
+
+class TestPyStream(TestStream, PyTest): pass
+class TestCStream(TestStream, CTest): pass
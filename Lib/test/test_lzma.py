@@ -27,6 +27,15 @@ class CompressorDecompressorTestCase(unittest.TestCase):
         # Can't specify a preset and a custom filter chain at the same time.
         with self.assertRaises(ValueError):
             LZMACompressor(preset=7, filters=[{"id": lzma.FILTER_LZMA2}])
+        # Only FORMAT_XZ can be compressed by several threads.
+        self.assertRaises(ValueError, LZMACompressor, threads=-1)
+        self.assertRaises(TypeError, LZMACompressor, threads=2.0)
+        with self.assertRaises(ValueError):
+            LZMACompressor(lzma.FORMAT_ALONE, threads=2)
+        for threads in (0, 1):
+            LZMACompressor(lzma.FORMAT_ALONE, threads=threads)
+            LZMACompressor(lzma.FORMAT_RAW, threads=threads,
+                           filters=FILTERS_RAW_1)
 
         self.assertRaises(TypeError, LZMADecompressor, ())
         self.assertRaises(TypeError, LZMADecompressor, memlimit=b"qw")
@@ -141,6 +150,33 @@ class CompressorDecompressorTestCase(unittest.TestCase):
         self._test_decompressor(lzd, COMPRESSED_XZ + extra, lzma.CHECK_CRC64,
                                 unused_data=extra)
 
+    def test_decompressor_into(self):
+        lzd = LZMADecompressor()
+        buf = bytearray(100)
+        out = []
+        data = COMPRESSED_XZ
+        while not lzd.eof:
+            n = lzd.decompress_into(data, buf)
+            out.append(bytes(buf[:n]))
+            data = lzd.unconsumed_tail
+        self.assertEqual(b"".join(out), INPUT)
+        self.assertEqual(lzd.check, lzma.CHECK_CRC64)
+        self.assertEqual(lzd.unconsumed_tail, b"")
+        self.assertRaises(EOFError, lzd.decompress_into, b"", buf)
+
+    def test_decompressor_into_unused_data(self):
+        lzd = LZMADecompressor()
+        self.assertEqual(lzd.unconsumed_tail, b"")
+        self.assertEqual(lzd.decompress_into(COMPRESSED_XZ, bytearray()), 0)
+        self.assertEqual(lzd.unconsumed_tail, COMPRESSED_XZ)
+        self.assertRaises(TypeError, lzd.decompress_into, COMPRESSED_XZ, b"x")
+        buf = bytearray(len(INPUT) + 1)
+        n = lzd.decompress_into(COMPRESSED_XZ + b"fooblibar", buf)
+        self.assertEqual(buf[:n], INPUT)
+        self.assertTrue(lzd.eof)
+        self.assertEqual(lzd.unused_data, b"fooblibar")
+        self.assertEqual(lzd.unconsumed_tail, b"")
+
     def test_decompressor_bad_input(self):
         lzd = LZMADecompressor()
         self.assertRaises(LZMAError, lzd.decompress, COMPRESSED_RAW_1)
@@ -162,6 +198,20 @@ class CompressorDecompressorTestCase(unittest.TestCase):
         lzd = LZMADecompressor()
         self._test_decompressor(lzd, cdata, lzma.CHECK_CRC64)
 
+    def test_roundtrip_xz_threads(self):
+        for threads in (0, 2):
+            lzc = LZMACompressor(threads=threads)
+            cdata = lzc.compress(INPUT) + lzc.flush()
+            lzd = LZMADecompressor()
+            self._test_decompressor(lzd, cdata, lzma.CHECK_CRC64)
+        # Preset 0 uses blocks of 768 KiB, so this data takes several
+        filters = [{"id": lzma.FILTER_LZMA2, "preset": 0}]
+        data = INPUT * (2 * 1024 * 1024 // len(INPUT))
+        lzc = LZMACompressor(filters=filters, threads=3)
+        cdata = b"".join(lzc.compress(data[i:i + 100000])
+                         for i in range(0, len(data), 100000)) + lzc.flush()
+        self.assertEqual(lzma.decompress(cdata), data)
+
     def test_roundtrip_alone(self):
         lzc = LZMACompressor(lzma.FORMAT_ALONE)
         cdata = lzc.compress(INPUT) + lzc.flush()
@@ -484,6 +534,17 @@ class FileTestCase(unittest.TestCase):
         with self.assertRaises(ValueError):
             LZMAFile(BytesIO(COMPRESSED_XZ), preset=3)
 
+    def test_init_threads(self):
+        with BytesIO() as dst:
+            with LZMAFile(dst, "w", threads=2) as f:
+                f.write(INPUT)
+            self.assertEqual(lzma.decompress(dst.getvalue()), INPUT)
+        with self.assertRaises(ValueError):
+            LZMAFile(BytesIO(), "w", format=lzma.FORMAT_ALONE, threads=2)
+        # Cannot specify threads with mode="r".
+        with self.assertRaises(ValueError):
+            LZMAFile(BytesIO(COMPRESSED_XZ), threads=2)
+
     def test_init_bad_filter_spec(self):
         with self.assertRaises(TypeError):
             LZMAFile(BytesIO(), "w", filters=[b"wobsite"])
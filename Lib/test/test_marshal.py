@@ -106,6 +106,145 @@ class CodeTestCase(unittest.TestCase):
             if isinstance(obj, types.CodeType):
                 self.assertIs(co.co_filename, obj.co_filename)
 
+class LazyCodeTestCase(unittest.TestCase):
+    source = '''if 1:
+        def f(x):
+            "doc of f"
+            def g():
+                return x + 1
+            return g()
+        class C:
+            def m(self):
+                return 'm'
+        '''
+
+    def setUp(self):
+        self.code = compile(self.source, 'lazy.py', 'exec')
+        self.data = marshal.dumps(self.code)
+
+    def check(self, code):
+        self.assertEqual(code, self.code)
+        ns = {}
+        exec(code, ns)
+        self.assertEqual(ns['f'].__doc__, 'doc of f')
+        self.assertEqual(ns['f'](1), 2)
+        self.assertEqual(ns['C']().m(), 'm')
+
+    def test_lazy(self):
+        self.check(marshal.loads(self.data, True))
+        self.check(marshal.loads(self.data, False))
+
+    def test_attributes(self):
+        code = marshal.loads(self.data, True)
+        self.assertEqual(code.co_consts, self.code.co_consts)
+        for lazy, eager in zip(code.co_consts, self.code.co_consts):
+            if isinstance(eager, types.CodeType):
+                self.assertIsInstance(lazy, types.CodeType)
+                self.assertEqual(lazy.co_name, eager.co_name)
+                self.assertEqual(lazy.co_code, eager.co_code)
+                self.assertEqual(lazy.co_consts, eager.co_consts)
+                self.assertEqual(lazy.co_names, eager.co_names)
+                self.assertEqual(lazy.co_lnotab, eager.co_lnotab)
+                self.assertEqual(hash(lazy), hash(eager))
+        self.assertIs(code.co_consts, code.co_consts)
+
+    def corrupt_body(self, data, name):
+        # Replace the first type code of the body of the code object named
+        # name, which follows its docstring and the size of the body
+        doc = ('doc of ' + name).encode()
+        i = data.index(doc) + len(doc) + 4
+        self.assertEqual(data[i], ord('s'))
+        return data[:i] + b'?' + data[i+1:]
+
+    def test_materialized_on_function_creation(self):
+        data = self.corrupt_body(self.data, 'f')
+        self.assertRaises(ValueError, marshal.loads, data)
+        code = marshal.loads(data, True)
+        ns = {}
+        with self.assertRaisesRegex(ValueError, 'bad marshal data'):
+            exec(code, ns)
+        # The error is raised again, not cached
+        with self.assertRaisesRegex(ValueError, 'bad marshal data'):
+            code.co_consts
+
+    def test_code_constant(self):
+        # A code object used as a plain constant is loaded as itself
+        code = compile('x = 1', 'lazy.py', 'exec')
+        consts = tuple(self.code if c == 1 else c for c in code.co_consts)
+        code = types.CodeType(code.co_argcount, code.co_kwonlyargcount,
+                              code.co_nlocals, code.co_stacksize,
+                              code.co_flags, code.co_code, consts,
+                              code.co_names, code.co_varnames,
+                              code.co_filename, code.co_name,
+                              code.co_firstlineno, code.co_lnotab)
+        ns = {}
+        exec(marshal.loads(marshal.dumps(code), True), ns)
+        self.assertIsInstance(ns['x'], types.CodeType)
+        self.check(ns['x'])
+
+    def test_dumps(self):
+        code = marshal.loads(self.data, True)
+        self.assertEqual(marshal.loads(marshal.dumps(code)), self.code)
+        self.assertEqual(marshal.loads(marshal.dumps(code, 4)), self.code)
+        code = marshal.loads(self.data, True)
+        ns = {}
+        exec(code, ns)
+        self.assertEqual(marshal.loads(marshal.dumps(code)), self.code)
+
+    def test_mutable_buffer(self):
+        data = bytearray(self.data)
+        code = marshal.loads(data, True)
+        data[:] = bytes(len(data))
+        self.check(code)
+
+    def test_data_not_kept(self):
+        # The lazy bodies are copied: the data can be freed right away
+        data = bytes(self.data)
+        refcount = sys.getrefcount(data)
+        code = marshal.loads(data, True)
+        self.assertEqual(sys.getrefcount(data), refcount)
+        self.check(code)
+
+    def test_released_buffer(self):
+        with memoryview(self.data) as m:
+            code = marshal.loads(m, True)
+        self.check(code)
+
+    def test_fix_co_filename(self):
+        import _imp
+        code = marshal.loads(self.data, True)
+        _imp._fix_co_filename(code, 'fixed.py')
+        ns = {}
+        exec(code, ns)
+        g = ns['f'].__code__.co_consts[1]
+        self.assertEqual(ns['f'].__code__.co_filename, 'fixed.py')
+        self.assertEqual(g.co_filename, 'fixed.py')
+
+    def test_version_4(self):
+        data = marshal.dumps(self.code, 4)
+        self.check(marshal.loads(data, True))
+        self.assertNotEqual(data, self.data)
+
+    def test_rewritten_bytecode_file(self):
+        # Functions not made yet must not depend on the bytecode file once
+        # it is imported: it may be rewritten or truncated meanwhile.
+        import importlib.machinery
+        import importlib.util
+        source = 'def outer():\n    def inner():\n        return 42\n' \
+                 '    return inner()\n'
+        self.addCleanup(support.unlink, support.TESTFN + 'c')
+        with open(support.TESTFN + 'c', 'wb') as f:
+            f.write(importlib.util.MAGIC_NUMBER + bytes(12))
+            f.write(marshal.dumps(compile(source, 'lazymod.py', 'exec')))
+        loader = importlib.machinery.SourcelessFileLoader(
+            'lazymod', support.TESTFN + 'c')
+        code = loader.get_code('lazymod')
+        with open(support.TESTFN + 'c', 'wb') as f:
+            pass
+        ns = {}
+        exec(code, ns)
+        self.assertEqual(ns['outer'](), 42)
+
 class ContainerTestCase(unittest.TestCase, HelperMixin):
     d = {'astring': 'foo@bar.baz.spam',
          'afloat': 7283.43,
@@ -440,6 +579,7 @@ def test_main():
                          FloatTestCase,
                          StringTestCase,
                          CodeTestCase,
+                         LazyCodeTestCase,
                          ContainerTestCase,
                          ExceptionTestCase,
                          BufferTestCase,
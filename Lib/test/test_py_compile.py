@@ -119,6 +119,26 @@ class PyCompileTests(unittest.TestCase):
         self.assertTrue(os.path.exists(cache_path))
         self.assertFalse(os.path.exists(pyc_path))
 
+    def test_invalidation_mode(self):
+        py_compile.compile(
+            self.source_path,
+            invalidation_mode=py_compile.PycInvalidationMode.CHECKED_HASH,
+        )
+        with open(self.cache_path, 'rb') as fp:
+            flags = importlib._bootstrap._classify_pyc(fp.read(), 'test', {})
+        self.assertEqual(flags, 0b11)
+        py_compile.compile(
+            self.source_path,
+            invalidation_mode=py_compile.PycInvalidationMode.UNCHECKED_HASH,
+        )
+        with open(self.cache_path, 'rb') as fp:
+            data = fp.read()
+        flags = importlib._bootstrap._classify_pyc(data, 'test', {})
+        self.assertEqual(flags, 0b1)
+        with open(self.source_path, 'rb') as fp:
+            source_hash = importlib.util.source_hash(fp.read())
+        self.assertEqual(data[8:16], source_hash)
+
 
 if __name__ == "__main__":
     unittest.main()
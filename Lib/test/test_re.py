@@ -4,6 +4,7 @@ import io
 import locale
 import re
 from re import Scanner
+import signal
 import sre_compile
 import sre_constants
 import sys
@@ -11,6 +12,10 @@ import string
 import traceback
 import unittest
 from weakref import proxy
+try:
+    import threading
+except ImportError:
+    threading = None
 
 # Misc tests from Tim Peters' re.doc
 
@@ -1478,6 +1483,119 @@ SUBPATTERN None
         self.assertIn(' at position 77', str(err))
         self.assertIn('(line 5, column 17)', str(err))
 
+    def test_nested_repeat_linear_time(self):
+        # Patterns without backreferences and lookarounds are matched
+        # by an automaton, so nested repeats do not backtrack exponentially.
+        s = 'a' * 100
+        self.assertIsNone(re.match(r'(a+)+b', s))
+        self.assertIsNone(re.search(r'(a|aa)+c', s))
+        self.assertIsNone(re.fullmatch(r'(?:a+)*b', s))
+        self.assertIsNone(re.search(r'(x+x+)+y', 'x' * 100))
+        self.assertIsNone(re.match(rb'(\w+\s?)+$', b'a' * 100 + b'!'))
+        m = re.search(r'(a+)+b', s + 'b')
+        self.assertEqual(m.span(), (0, 101))
+        self.assertEqual(m.span(1), (0, 100))
+
+    def test_automaton_groups(self):
+        # Leftmost-first semantics and group captures are the same
+        # as in the backtracking engine.
+        self.assertEqual(re.search(r'(a|ab)(c|bcd)(d*)', 'xabcd').groups(),
+                         ('a', 'bcd', ''))
+        self.assertEqual(re.match(r'(a*?)(a*)', 'aaa').groups(), ('', 'aaa'))
+        self.assertEqual(re.match(r'(?:(a)|(b))+', 'ab').groups(), ('a', 'b'))
+        self.assertEqual(re.match(r'(?:(a)|(b))+', 'ab').lastindex, 2)
+        self.assertEqual(re.fullmatch(r'(a|ab)(b*)', 'abb').groups(),
+                         ('a', 'bb'))
+        self.assertEqual(re.search(r'\b(\w+)$', 'foo bar\n').group(1), 'bar')
+        self.assertEqual(re.findall(r'(?m)^(\w)\w*$', 'ab\ncd\n\nef'),
+                         ['a', 'c', 'e'])
+        self.assertEqual(re.sub(r'(\d+)', r'<\1>', 'a12b3'), 'a<12>b<3>')
+        self.assertEqual(re.search(r'(?i)k+', 'KKk').span(), (0, 3))
+        self.assertEqual(re.compile(r'x*').search('axx', 1).span(), (1, 3))
+        self.assertEqual(re.compile(r'\w+$').search('ab cd', 0, 4).span(),
+                         (3, 4))
+
+    def test_required_literal(self):
+        # search() skips to the places where a literal that every match
+        # contains can be found.
+        for lookahead in '', '(?=.)':
+            p = re.compile(r'\d+ ERROR%s (\w+)' % lookahead)
+            self.assertEqual(p.search('1 WARN x 23 ERROR disk').span(), (9, 22))
+            self.assertEqual(p.findall('ERROR 1 ERROR a ERROR 2 ERROR b'),
+                             ['a', 'b'])
+            self.assertIsNone(p.search('1 ERROR'))
+            self.assertIsNone(p.search('1 ERROR x', 0, 8))
+            self.assertIsNone(p.search('1 ERROR x', 1))
+            self.assertIsNone(p.search('1 WARN x' * 1000))
+            p = re.compile(r'[a-z]\d{1,3}%sxy' % lookahead)
+            self.assertEqual(p.search('a1xy').span(), (0, 4))
+            self.assertEqual(p.search('a1xa12xa123xy').span(), (7, 13))
+            self.assertEqual(p.search('a1234xya123xy').span(), (7, 13))
+            self.assertIsNone(p.search('a1x€y'))
+            p = re.compile(p.pattern.encode())
+            self.assertEqual(p.search(bytearray(b'b12xy')).span(), (0, 5))
+            self.assertEqual(p.search(memoryview(b'b12xyz')[:5]).span(),
+                             (0, 5))
+            self.assertIsNone(p.search(memoryview(b'b12xyz')[:4]))
+        self.assertEqual(re.search(r'(a+)\1xy', 'aaaaaxy').span(), (1, 7))
+        self.assertEqual(re.search(r'\w€z', 'a€z').span(), (0, 3))
+        self.assertIsNone(re.search(r'\w€z', 'a\xe9z'))
+        self.assertEqual(re.search(r'(?i)\w+abc', 'xABC').span(), (0, 4))
+        long = 'x' * 100
+        self.assertEqual(re.search(r'\d' + long, '12' + long).span(),
+                         (1, 102))
+        self.assertIsNone(re.search(r'\d' + long, '1' + long[1:] + 'y'))
+
+    @unittest.skipUnless(threading, 'Threading required for this test.')
+    def test_match_in_threads(self):
+        # The GIL is released while matching long strings, the threads
+        # must not share the caches of a pattern
+        patterns = [re.compile(r'(a+)(b+|c+)d'), re.compile(r'(a|b|c)\1+d'),
+                    re.compile(rb'(a+)(b+|c+)d')]
+        subjects = ['ab' * 20000 + 'aaccd', 'abc' * 20000 + 'aabbbd']
+        expected = [[(p.search(s).span(), p.findall(s))
+                     for s in subjects] for p in patterns[:2]]
+        expected.append([(p.search(s.encode()).span(), p.findall(s.encode()))
+                         for s in subjects for p in patterns[2:]])
+        results = []
+        def worker():
+            for i in range(5):
+                found = [[(p.search(s).span(), p.findall(s))
+                          for s in subjects] for p in patterns[:2]]
+                found.append([(p.search(s.encode()).span(),
+                               p.findall(s.encode()))
+                              for s in subjects for p in patterns[2:]])
+                results.append(found)
+        threads = [threading.Thread(target=worker) for i in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertEqual(results, [expected] * 20)
+
+    @unittest.skipUnless(hasattr(signal, 'setitimer'),
+                         'requires signal.setitimer()')
+    def test_interrupted_by_signal(self):
+        # signal handlers run while matching, even with the GIL released
+        class Interrupted(Exception):
+            pass
+        def handler(signum, frame):
+            raise Interrupted
+        p = re.compile(r'(x+x+)+\1(?:y|z)')
+        scanner = p.scanner('x' * 50)
+        def reenter(signum, frame):
+            scanner.search()
+        old_handler = signal.signal(signal.SIGALRM, handler)
+        try:
+            signal.setitimer(signal.ITIMER_REAL, 0.05)
+            self.assertRaises(Interrupted, p.search, 'x' * 50)
+            signal.signal(signal.SIGALRM, reenter)
+            signal.setitimer(signal.ITIMER_REAL, 0.05)
+            self.assertRaises(ValueError, scanner.search)
+        finally:
+            signal.setitimer(signal.ITIMER_REAL, 0)
+            signal.signal(signal.SIGALRM, old_handler)
+
 
 class PatternReprTests(unittest.TestCase):
     def check(self, pattern, expected):
@@ -174,6 +174,22 @@ class BaseSelectorTestCase(unittest.TestCase):
         self.assertFalse(s.register.called)
         self.assertFalse(s.unregister.called)
 
+    def test_modify_select(self):
+        s = self.SELECTOR()
+        self.addCleanup(s.close)
+
+        rd, wr = self.make_socketpair()
+
+        s.register(rd, selectors.EVENT_READ)
+        self.assertEqual(s.select(0), [])
+
+        # the new interest set is used by the next select()
+        key = s.modify(rd, selectors.EVENT_READ | selectors.EVENT_WRITE)
+        self.assertEqual(s.select(0), [(key, selectors.EVENT_WRITE)])
+
+        s.modify(rd, selectors.EVENT_READ)
+        self.assertEqual(s.select(0), [])
+
     def test_close(self):
         s = self.SELECTOR()
         self.addCleanup(s.close)
@@ -416,6 +432,46 @@ class ScalableSelectorMixIn:
         self.assertEqual(NUM_FDS // 2, len(s.select()))
 
 
+class PollLikeSelectorMixIn:
+
+    def test_modify_in_place(self):
+        # modify() of poll-like selectors updates the interest set of the
+        # kernel object with a single call
+        s = self.SELECTOR()
+        self.addCleanup(s.close)
+
+        rd, wr = self.make_socketpair()
+
+        s.register(rd, selectors.EVENT_READ)
+        s.register = unittest.mock.Mock()
+        s.unregister = unittest.mock.Mock()
+        data = object()
+        key = s.modify(rd, selectors.EVENT_WRITE, data)
+        self.assertFalse(s.register.called)
+        self.assertFalse(s.unregister.called)
+        self.assertEqual(key.events, selectors.EVENT_WRITE)
+        self.assertIs(key.data, data)
+        self.assertEqual(key, s.get_key(rd))
+
+        # invalid events leave the registration untouched
+        self.assertRaises(ValueError, s.modify, rd, 0)
+        self.assertRaises(ValueError, s.modify, rd, 999999)
+        self.assertEqual(key, s.get_key(rd))
+
+    def test_unregister_error(self):
+        # only the errors of an fd closed since registration are ignored
+        s = self.SELECTOR()
+        self.addCleanup(s.close)
+
+        rd, wr = self.make_socketpair()
+
+        s.register(rd, selectors.EVENT_READ)
+        s._selector = unittest.mock.Mock()
+        s._selector.unregister.side_effect = OSError(errno.EINVAL, 'error')
+        self.assertRaises(OSError, s.unregister, rd)
+        self.assertRaises(KeyError, s.get_key, rd)
+
+
 class DefaultSelectorTestCase(BaseSelectorTestCase):
 
     SELECTOR = selectors.DefaultSelector
@@ -428,14 +484,16 @@ class SelectSelectorTestCase(BaseSelectorTestCase):
 
 @unittest.skipUnless(hasattr(selectors, 'PollSelector'),
                      "Test needs selectors.PollSelector")
-class PollSelectorTestCase(BaseSelectorTestCase, ScalableSelectorMixIn):
+class PollSelectorTestCase(BaseSelectorTestCase, ScalableSelectorMixIn,
+                           PollLikeSelectorMixIn):
 
     SELECTOR = getattr(selectors, 'PollSelector', None)
 
 
 @unittest.skipUnless(hasattr(selectors, 'EpollSelector'),
                      "Test needs selectors.EpollSelector")
-class EpollSelectorTestCase(BaseSelectorTestCase, ScalableSelectorMixIn):
+class EpollSelectorTestCase(BaseSelectorTestCase, ScalableSelectorMixIn,
+                            PollLikeSelectorMixIn):
 
     SELECTOR = getattr(selectors, 'EpollSelector', None)
 
@@ -449,7 +507,8 @@ class KqueueSelectorTestCase(BaseSelectorTestCase, ScalableSelectorMixIn):
 
 @unittest.skipUnless(hasattr(selectors, 'DevpollSelector'),
                      "Test needs selectors.DevpollSelector")
-class DevpollSelectorTestCase(BaseSelectorTestCase, ScalableSelectorMixIn):
+class DevpollSelectorTestCase(BaseSelectorTestCase, ScalableSelectorMixIn,
+                              PollLikeSelectorMixIn):
 
     SELECTOR = getattr(selectors, 'DevpollSelector', None)
 
@@ -200,6 +200,16 @@ class UnicodeTest(string_tests.CommonTest,
         self.assertRaises(TypeError, 'hello'.find)
         self.assertRaises(TypeError, 'hello'.find, 42)
 
+    def test_find_long_needles(self):
+        string_tests.CommonTest.test_find_long_needles(self)
+        # the two-way algorithm with UCS-2 and UCS-4 strings
+        for char in ('\u20ac', '\U0001f600'):
+            needle = char * 50 + 'b' + char * 50
+            haystack = char * 40000
+            self.assertEqual(haystack.find(needle), -1)
+            self.assertEqual((haystack + needle).find(needle), 40000)
+            self.assertEqual(((haystack + needle) * 2).count(needle), 2)
+
     def test_rfind(self):
         string_tests.CommonTest.test_rfind(self)
         # test implementation details of the memrchr fast path
@@ -1466,6 +1476,45 @@ class UnicodeTest(string_tests.CommonTest,
         for seq, res in sequences:
             self.assertEqual(seq.decode('utf-8'), res)
 
+    def test_utf8_decode_ascii_runs(self):
+        # Runs of ASCII characters are decoded by blocks: check non-ASCII
+        # characters and invalid bytes at each position around a block
+        for char in ('\xe9', '\u20ac', '\U0001f600'):
+            encoded = char.encode('utf-8')
+            for length in range(40):
+                for pos in range(length + 1):
+                    text = 'x' * pos + char + 'y' * (length - pos)
+                    data = b'x' * pos + encoded + b'y' * (length - pos)
+                    self.assertEqual(data.decode('utf-8'), text)
+                    self.assertEqual(data[pos:].decode('utf-8'), text[pos:])
+                    text = text + 'z' * 37
+                    self.assertEqual((data + b'z' * 37).decode('utf-8'), text)
+        for length in range(40):
+            for pos in range(length):
+                data = b'x' * pos + b'\xff' + b'y' * (length - pos)
+                with self.assertRaises(UnicodeDecodeError) as cm:
+                    data.decode('utf-8')
+                self.assertEqual(cm.exception.start, pos)
+                self.assertEqual(data.decode('utf-8', 'replace'),
+                                 'x' * pos + '\ufffd' + 'y' * (length - pos))
+
+    def test_widening(self):
+        # Characters are widened by blocks when a string is converted to a
+        # wider kind, and their maximum is looked for by blocks
+        for length in range(70):
+            for char in ('\xe9', '\u20ac', '\U0001f600'):
+                text = ''.join(chr(0x20 + i % 0x60) for i in range(length))
+                widened = text + char
+                self.assertEqual(widened[:length], text)
+                self.assertEqual(len(widened), length + 1)
+                self.assertEqual(widened[-1], char)
+                for pos in range(0, length, 7):
+                    wide = text[:pos] + char + text[pos:]
+                    self.assertEqual(max(wide), char)
+                    self.assertEqual(wide[:pos] + wide[pos + 1:], text)
+                    self.assertEqual(wide[pos + 1:].encode('ascii'),
+                                     text[pos:].encode('ascii'))
+
 
     def test_utf8_decode_invalid_sequences(self):
         # continuation bytes in a sequence of 2, 3, or 4 bytes
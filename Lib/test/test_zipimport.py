@@ -35,9 +35,16 @@ def make_pyc(co, mtime, size):
         else:
             mtime = int(-0x100000000 + int(mtime))
     pyc = (importlib.util.MAGIC_NUMBER +
-        struct.pack("<ii", int(mtime), size & 0xFFFFFFFF) + data)
+        struct.pack("<iii", 0, int(mtime), size & 0xFFFFFFFF) + data)
     return pyc
 
+def make_hash_pyc(co, checked):
+    # The hash is deliberately wrong, so that the pyc is only used when it
+    # is not checked against the source.
+    flags = 0b11 if checked else 0b01
+    return (importlib.util.MAGIC_NUMBER + struct.pack("<i", flags) +
+            b'\0' * 8 + marshal.dumps(co))
+
 def module_path_to_dotted_name(path):
     return path.replace(os.sep, '.')
 
@@ -190,11 +197,26 @@ class UncompressedZipImportTestCase(ImportHooksBaseTestCase):
         badtime_pyc = bytearray(test_pyc)
         # flip the second bit -- not the first as that one isn't stored in the
         # .py's mtime in the zip archive.
-        badtime_pyc[7] ^= 0x02
+        badtime_pyc[11] ^= 0x02
         files = {TESTMOD + ".py": (NOW, test_src),
                  TESTMOD + pyc_ext: (NOW, badtime_pyc)}
         self.doTest(".py", files, TESTMOD)
 
+    def testUncheckedHashBasedPyc(self):
+        files = {TESTMOD + ".py": (NOW, test_src),
+                 TESTMOD + pyc_ext: (NOW, make_hash_pyc(test_co, False))}
+        self.doTest(pyc_ext, files, TESTMOD)
+
+    def testCheckedHashBasedPyc(self):
+        # A checked hash-based pyc is not used when there is a source.
+        files = {TESTMOD + ".py": (NOW, test_src),
+                 TESTMOD + pyc_ext: (NOW, make_hash_pyc(test_co, True))}
+        self.doTest(".py", files, TESTMOD)
+
+    def testCheckedHashBasedPycOnly(self):
+        files = {TESTMOD + pyc_ext: (NOW, make_hash_pyc(test_co, True))}
+        self.doTest(pyc_ext, files, TESTMOD)
+
     def testPackage(self):
         packdir = TESTPACK + os.sep
         files = {packdir + "__init__" + pyc_ext: (NOW, test_pyc),
@@ -368,6 +368,42 @@ class CompressObjectTestCase(BaseCompressTestCase, unittest.TestCase):
         ddata += dco.decompress(dco.unconsumed_tail)
         self.assertEqual(dco.unconsumed_tail, b"")
 
+    def test_decompress_into(self):
+        data = HAMLET_SCENE * 8
+        comp = zlib.compress(data)
+        dco = zlib.decompressobj()
+        buf = bytearray(1000)
+        chunks = []
+        while not dco.eof:
+            n = dco.decompress_into(comp, buf)
+            chunks.append(bytes(buf[:n]))
+            comp = dco.unconsumed_tail
+        self.assertEqual(len(chunks), (len(data) + 999) // 1000)
+        self.assertEqual(b''.join(chunks), data)
+        self.assertTrue(dco.eof)
+        self.assertEqual(dco.unconsumed_tail, b'')
+        self.assertEqual(dco.flush(), b'')
+
+    def test_decompress_into_misc(self):
+        comp = zlib.compress(HAMLET_SCENE) + b'junk'
+        dco = zlib.decompressobj()
+        self.assertEqual(dco.decompress_into(comp, bytearray()), 0)
+        self.assertTrue(dco.unconsumed_tail)
+        buf = memoryview(bytearray(len(HAMLET_SCENE) + 10))
+        self.assertEqual(dco.decompress_into(dco.unconsumed_tail, buf[5:]),
+                         len(HAMLET_SCENE))
+        self.assertEqual(buf[5:-5], HAMLET_SCENE)
+        self.assertTrue(dco.eof)
+        self.assertEqual(dco.unused_data, b'junk')
+        self.assertRaises(TypeError, dco.decompress_into, comp, b'readonly')
+        # A preset dictionary is used as with decompress()
+        co = zlib.compressobj(zdict=HAMLET_SCENE)
+        comp = co.compress(HAMLET_SCENE[1000:1500]) + co.flush()
+        dco = zlib.decompressobj(zdict=HAMLET_SCENE)
+        buf = bytearray(600)
+        self.assertEqual(dco.decompress_into(comp, buf), 500)
+        self.assertEqual(buf[:500], HAMLET_SCENE[1000:1500])
+
     def test_flushes(self):
         # Test flush() with the various options, using all the
         # different levels in order to provide more variations.
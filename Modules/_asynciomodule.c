@@ -0,0 +1,3096 @@
+/* C implementation of asyncio.Future, asyncio.Task and of the Handle and
+   TimerHandle classes of asyncio.events.
+
+   The classes mirror Lib/asyncio/futures.py, Lib/asyncio/tasks.py and
+   Lib/asyncio/events.py; whenever the behaviour of one of them changes
+   the other one has to be updated as well.  The repr() and stack helpers
+   are shared with the Python implementation and are looked up lazily, the
+   first time a Future is created, to avoid a circular import with the
+   asyncio package (which imports this module).
+*/
+
+#include "Python.h"
+#include "structmember.h"
+
+
+/* identifiers used from some functions */
+_Py_IDENTIFIER(add);
+_Py_IDENTIFIER(add_done_callback);
+_Py_IDENTIFIER(call_exception_handler);
+_Py_IDENTIFIER(call_soon);
+_Py_IDENTIFIER(cancel);
+_Py_IDENTIFIER(cancelled);
+_Py_IDENTIFIER(exception);
+_Py_IDENTIFIER(get_debug);
+_Py_IDENTIFIER(result);
+_Py_IDENTIFIER(send);
+_Py_IDENTIFIER(throw);
+_Py_IDENTIFIER(WeakSet);
+_Py_IDENTIFIER(_blocking);
+_Py_IDENTIFIER(_loop);
+_Py_IDENTIFIER(_repr_info);
+_Py_IDENTIFIER(_step);
+_Py_IDENTIFIER(_timer_handle_cancelled);
+_Py_IDENTIFIER(_wakeup);
+_Py_IDENTIFIER(_when);
+_Py_IDENTIFIER(__name__);
+_Py_IDENTIFIER(PENDING);
+_Py_IDENTIFIER(CANCELLED);
+_Py_IDENTIFIER(FINISHED);
+
+
+/* State of the _asyncio module, shared by all Future and Task objects */
+static PyObject *all_tasks;         /* weakref.WeakSet of all Tasks */
+static PyObject *current_tasks;     /* {loop: task} for running Tasks */
+
+/* Lazily imported from the asyncio package and the stdlib */
+static int module_initialized = 0;
+static PyObject *traceback_extract_stack;
+static PyObject *asyncio_get_event_loop;
+static PyObject *asyncio_future_repr_info_func;
+static PyObject *asyncio_task_repr_info_func;
+static PyObject *asyncio_task_get_stack_func;
+static PyObject *asyncio_task_print_stack_func;
+static PyObject *asyncio_iscoroutine_func;
+static PyObject *asyncio_InvalidStateError;
+static PyObject *asyncio_CancelledError;
+static PyObject *asyncio_format_callback_func;
+static PyObject *asyncio_handle_repr_info_func;
+static PyObject *asyncio_timer_handle_repr_info_func;
+
+
+typedef enum {
+    STATE_PENDING,
+    STATE_CANCELLED,
+    STATE_FINISHED
+} fut_state;
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *fut_loop;
+    PyObject *fut_callbacks;
+    PyObject *fut_exception;
+    PyObject *fut_result;
+    PyObject *fut_source_tb;
+    fut_state fut_state;
+    int fut_log_tb;
+    int fut_blocking;
+    PyObject *dict;
+    PyObject *fut_weakreflist;
+} FutureObj;
+
+typedef struct {
+    FutureObj task_future;
+    PyObject *task_fut_waiter;
+    PyObject *task_coro;
+    int task_must_cancel;
+    int task_log_destroy_pending;
+} TaskObj;
+
+static PyTypeObject FutureType;
+static PyTypeObject TaskType;
+
+#define Future_CheckExact(obj) (Py_TYPE(obj) == &FutureType)
+#define Future_Check(obj) PyObject_TypeCheck(obj, &FutureType)
+#define Task_CheckExact(obj) (Py_TYPE(obj) == &TaskType)
+
+#define ENSURE_FUTURE_ALIVE(fut)                                \
+    do {                                                        \
+        if ((fut)->fut_loop == NULL) {                          \
+            PyErr_SetString(PyExc_RuntimeError,                 \
+                            "Future object is not initialized."); \
+            return NULL;                                        \
+        }                                                       \
+    } while(0);
+
+
+static int
+module_init(void)
+{
+    PyObject *module = NULL;
+
+    if (module_initialized) {
+        return 0;
+    }
+
+#define GET_MOD_ATTR(VAR, NAME)                         \
+    Py_CLEAR(VAR);                                      \
+    VAR = PyObject_GetAttrString(module, NAME);         \
+    if (VAR == NULL) {                                  \
+        goto fail;                                      \
+    }
+
+#define WITH_MOD(NAME)                                  \
+    Py_CLEAR(module);                                   \
+    module = PyImport_ImportModule(NAME);               \
+    if (module == NULL) {                               \
+        goto fail;                                      \
+    }
+
+    WITH_MOD("traceback")
+    GET_MOD_ATTR(traceback_extract_stack, "extract_stack")
+
+    WITH_MOD("concurrent.futures")
+    GET_MOD_ATTR(asyncio_CancelledError, "CancelledError")
+
+    WITH_MOD("asyncio.events")
+    GET_MOD_ATTR(asyncio_get_event_loop, "get_event_loop")
+    GET_MOD_ATTR(asyncio_format_callback_func, "_format_callback")
+    GET_MOD_ATTR(asyncio_handle_repr_info_func, "_handle_repr_info")
+    GET_MOD_ATTR(asyncio_timer_handle_repr_info_func,
+                 "_timer_handle_repr_info")
+
+    WITH_MOD("asyncio.futures")
+    GET_MOD_ATTR(asyncio_future_repr_info_func, "_future_repr_info")
+    GET_MOD_ATTR(asyncio_InvalidStateError, "InvalidStateError")
+
+    WITH_MOD("asyncio.coroutines")
+    GET_MOD_ATTR(asyncio_iscoroutine_func, "iscoroutine")
+
+    WITH_MOD("asyncio.tasks")
+    GET_MOD_ATTR(asyncio_task_repr_info_func, "_task_repr_info")
+    GET_MOD_ATTR(asyncio_task_get_stack_func, "_task_get_stack")
+    GET_MOD_ATTR(asyncio_task_print_stack_func, "_task_print_stack")
+
+#undef WITH_MOD
+#undef GET_MOD_ATTR
+
+    Py_DECREF(module);
+    module_initialized = 1;
+    return 0;
+
+fail:
+    Py_XDECREF(module);
+    return -1;
+}
+
+
+/* Return the name of the future's state, as a borrowed reference */
+static PyObject *
+future_state_name(FutureObj *fut)
+{
+    switch (fut->fut_state) {
+    case STATE_PENDING:
+        return _PyUnicode_FromId(&PyId_PENDING);
+    case STATE_CANCELLED:
+        return _PyUnicode_FromId(&PyId_CANCELLED);
+    case STATE_FINISHED:
+        return _PyUnicode_FromId(&PyId_FINISHED);
+    default:
+        assert(0);
+        return NULL;
+    }
+}
+
+/* Return 1 if obj is a Future, either a C Future or any object advertising
+   itself as duck-type compatible through the _blocking attribute.  This is
+   asyncio.futures.isfuture(). */
+static int
+isfuture(PyObject *obj)
+{
+    PyObject *res;
+    int is_future;
+
+    if (Future_Check(obj)) {
+        return 1;
+    }
+    if (!PyObject_HasAttr((PyObject *)Py_TYPE(obj),
+                          _PyUnicode_FromId(&PyId__blocking))) {
+        return 0;
+    }
+    res = _PyObject_GetAttrId(obj, &PyId__blocking);
+    if (res == NULL) {
+        return -1;
+    }
+    is_future = (res != Py_None);
+    Py_DECREF(res);
+    return is_future;
+}
+
+static int
+future_schedule_callbacks(FutureObj *fut)
+{
+    Py_ssize_t len;
+    Py_ssize_t i;
+    PyObject *iters;
+
+    if (fut->fut_callbacks == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "NULL callbacks");
+        return -1;
+    }
+
+    len = PyList_GET_SIZE(fut->fut_callbacks);
+    if (len == 0) {
+        return 0;
+    }
+
+    iters = PyList_GetSlice(fut->fut_callbacks, 0, len);
+    if (iters == NULL) {
+        return -1;
+    }
+    if (PyList_SetSlice(fut->fut_callbacks, 0, len, NULL) < 0) {
+        Py_DECREF(iters);
+        return -1;
+    }
+
+    for (i = 0; i < len; i++) {
+        PyObject *handle;
+        PyObject *cb = PyList_GET_ITEM(iters, i);
+
+        handle = _PyObject_CallMethodIdObjArgs(fut->fut_loop, &PyId_call_soon,
+                                               cb, fut, NULL);
+        if (handle == NULL) {
+            Py_DECREF(iters);
+            return -1;
+        }
+        Py_DECREF(handle);
+    }
+
+    Py_DECREF(iters);
+    return 0;
+}
+
+static int
+future_init(FutureObj *fut, PyObject *loop)
+{
+    PyObject *res;
+    int is_true;
+
+    if (module_init() < 0) {
+        return -1;
+    }
+
+    Py_CLEAR(fut->fut_loop);
+    Py_CLEAR(fut->fut_callbacks);
+    Py_CLEAR(fut->fut_result);
+    Py_CLEAR(fut->fut_exception);
+    Py_CLEAR(fut->fut_source_tb);
+    fut->fut_state = STATE_PENDING;
+    fut->fut_log_tb = 0;
+    fut->fut_blocking = 0;
+
+    if (loop == NULL || loop == Py_None) {
+        loop = PyObject_CallObject(asyncio_get_event_loop, NULL);
+        if (loop == NULL) {
+            return -1;
+        }
+    }
+    else {
+        Py_INCREF(loop);
+    }
+    fut->fut_loop = loop;
+
+    res = _PyObject_CallMethodId(fut->fut_loop, &PyId_get_debug, NULL);
+    if (res == NULL) {
+        return -1;
+    }
+    is_true = PyObject_IsTrue(res);
+    Py_DECREF(res);
+    if (is_true < 0) {
+        return -1;
+    }
+    if (is_true) {
+        fut->fut_source_tb = PyObject_CallObject(traceback_extract_stack,
+                                                 NULL);
+        if (fut->fut_source_tb == NULL) {
+            return -1;
+        }
+    }
+
+    fut->fut_callbacks = PyList_New(0);
+    if (fut->fut_callbacks == NULL) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static PyObject *
+future_set_result(FutureObj *fut, PyObject *res)
+{
+    if (fut->fut_state != STATE_PENDING) {
+        PyErr_Format(asyncio_InvalidStateError, "%U: %R",
+                     future_state_name(fut), fut);
+        return NULL;
+    }
+
+    assert(!fut->fut_result);
+    Py_INCREF(res);
+    fut->fut_result = res;
+    fut->fut_state = STATE_FINISHED;
+
+    if (future_schedule_callbacks(fut) == -1) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+future_set_exception(FutureObj *fut, PyObject *exc)
+{
+    PyObject *exc_val = NULL;
+
+    if (fut->fut_state != STATE_PENDING) {
+        PyErr_Format(asyncio_InvalidStateError, "%U: %R",
+                     future_state_name(fut), fut);
+        return NULL;
+    }
+
+    if (PyType_Check(exc)) {
+        exc_val = PyObject_CallObject(exc, NULL);
+        if (exc_val == NULL) {
+            return NULL;
+        }
+    }
+    else {
+        exc_val = exc;
+        Py_INCREF(exc_val);
+    }
+
+    assert(!fut->fut_exception);
+    fut->fut_exception = exc_val;
+    fut->fut_state = STATE_FINISHED;
+
+    if (future_schedule_callbacks(fut) == -1) {
+        return NULL;
+    }
+
+    fut->fut_log_tb = 1;
+    Py_RETURN_NONE;
+}
+
+/* Return a new reference to the result, or set an exception and return
+   NULL: the exception of the future, CancelledError or
+   InvalidStateError. */
+static PyObject *
+future_get_result(FutureObj *fut)
+{
+    PyObject *exc;
+
+    if (fut->fut_state == STATE_CANCELLED) {
+        PyErr_SetNone(asyncio_CancelledError);
+        return NULL;
+    }
+
+    if (fut->fut_state != STATE_FINISHED) {
+        PyErr_SetString(asyncio_InvalidStateError, "Result is not ready.");
+        return NULL;
+    }
+
+    fut->fut_log_tb = 0;
+    exc = fut->fut_exception;
+    if (exc != NULL) {
+        if (!PyExceptionInstance_Check(exc)) {
+            PyErr_SetString(PyExc_TypeError,
+                            "exceptions must derive from BaseException");
+            return NULL;
+        }
+        PyErr_SetObject(PyExceptionInstance_Class(exc), exc);
+        return NULL;
+    }
+
+    Py_INCREF(fut->fut_result);
+    return fut->fut_result;
+}
+
+static PyObject *
+future_add_done_callback(FutureObj *fut, PyObject *arg)
+{
+    ENSURE_FUTURE_ALIVE(fut)
+
+    if (fut->fut_state != STATE_PENDING) {
+        PyObject *handle = _PyObject_CallMethodIdObjArgs(fut->fut_loop,
+                                                         &PyId_call_soon,
+                                                         arg, fut, NULL);
+        if (handle == NULL) {
+            return NULL;
+        }
+        Py_DECREF(handle);
+    }
+    else {
+        if (PyList_Append(fut->fut_callbacks, arg) != 0) {
+            return NULL;
+        }
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+future_cancel(FutureObj *fut)
+{
+    if (fut->fut_state != STATE_PENDING) {
+        Py_RETURN_FALSE;
+    }
+    fut->fut_state = STATE_CANCELLED;
+
+    if (future_schedule_callbacks(fut) == -1) {
+        return NULL;
+    }
+
+    Py_RETURN_TRUE;
+}
+
+
+/*********************** Future ***********************/
+
+static int
+FutureObj_init(FutureObj *fut, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"loop", NULL};
+    PyObject *loop = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|$O:Future", kwlist,
+                                     &loop)) {
+        return -1;
+    }
+    return future_init(fut, loop);
+}
+
+static int
+FutureObj_clear(FutureObj *fut)
+{
+    Py_CLEAR(fut->fut_loop);
+    Py_CLEAR(fut->fut_callbacks);
+    Py_CLEAR(fut->fut_result);
+    Py_CLEAR(fut->fut_exception);
+    Py_CLEAR(fut->fut_source_tb);
+    Py_CLEAR(fut->dict);
+    return 0;
+}
+
+static int
+FutureObj_traverse(FutureObj *fut, visitproc visit, void *arg)
+{
+    Py_VISIT(fut->fut_loop);
+    Py_VISIT(fut->fut_callbacks);
+    Py_VISIT(fut->fut_result);
+    Py_VISIT(fut->fut_exception);
+    Py_VISIT(fut->fut_source_tb);
+    Py_VISIT(fut->dict);
+    return 0;
+}
+
+PyDoc_STRVAR(future_result_doc,
+"result() -> object\n\
+\n\
+Return the result this future represents.\n\
+\n\
+If the future has been cancelled, raises CancelledError.  If the\n\
+future's result isn't yet available, raises InvalidStateError.  If\n\
+the future is done and has an exception set, this exception is raised.");
+
+static PyObject *
+FutureObj_result(FutureObj *fut, PyObject *unused)
+{
+    return future_get_result(fut);
+}
+
+PyDoc_STRVAR(future_exception_doc,
+"exception() -> exception or None\n\
+\n\
+Return the exception that was set on this future.\n\
+\n\
+The exception (or None if no exception was set) is returned only if\n\
+the future is done.  If the future has been cancelled, raises\n\
+CancelledError.  If the future isn't done yet, raises\n\
+InvalidStateError.");
+
+static PyObject *
+FutureObj_exception(FutureObj *fut, PyObject *unused)
+{
+    if (fut->fut_state == STATE_CANCELLED) {
+        PyErr_SetNone(asyncio_CancelledError);
+        return NULL;
+    }
+
+    if (fut->fut_state != STATE_FINISHED) {
+        PyErr_SetString(asyncio_InvalidStateError, "Exception is not set.");
+        return NULL;
+    }
+
+    fut->fut_log_tb = 0;
+    if (fut->fut_exception != NULL) {
+        Py_INCREF(fut->fut_exception);
+        return fut->fut_exception;
+    }
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(future_set_result_doc,
+"set_result(result) -> None\n\
+\n\
+Mark the future done and set its result.\n\
+\n\
+If the future is already done when this method is called, raises\n\
+InvalidStateError.");
+
+static PyObject *
+FutureObj_set_result(FutureObj *fut, PyObject *res)
+{
+    ENSURE_FUTURE_ALIVE(fut)
+    return future_set_result(fut, res);
+}
+
+PyDoc_STRVAR(future_set_exception_doc,
+"set_exception(exception) -> None\n\
+\n\
+Mark the future done and set an exception.\n\
+\n\
+If the future is already done when this method is called, raises\n\
+InvalidStateError.");
+
+static PyObject *
+FutureObj_set_exception(FutureObj *fut, PyObject *exc)
+{
+    ENSURE_FUTURE_ALIVE(fut)
+    return future_set_exception(fut, exc);
+}
+
+static PyObject *
+FutureObj_set_result_unless_cancelled(FutureObj *fut, PyObject *res)
+{
+    ENSURE_FUTURE_ALIVE(fut)
+    if (fut->fut_state == STATE_CANCELLED) {
+        Py_RETURN_NONE;
+    }
+    return future_set_result(fut, res);
+}
+
+PyDoc_STRVAR(future_add_done_callback_doc,
+"add_done_callback(fn) -> None\n\
+\n\
+Add a callback to be run when the future becomes done.\n\
+\n\
+The callback is called with a single argument - the future object. If\n\
+the future is already done when this is called, the callback is\n\
+scheduled with call_soon.");
+
+static PyObject *
+FutureObj_add_done_callback(FutureObj *fut, PyObject *fn)
+{
+    return future_add_done_callback(fut, fn);
+}
+
+PyDoc_STRVAR(future_remove_done_callback_doc,
+"remove_done_callback(fn) -> int\n\
+\n\
+Remove all instances of a callback from the \"call when done\" list.\n\
+\n\
+Returns the number of callbacks removed.");
+
+static PyObject *
+FutureObj_remove_done_callback(FutureObj *fut, PyObject *fn)
+{
+    PyObject *newlist;
+    Py_ssize_t len, i, j = 0;
+
+    ENSURE_FUTURE_ALIVE(fut)
+
+    len = PyList_GET_SIZE(fut->fut_callbacks);
+    if (len == 0) {
+        return PyLong_FromSsize_t(0);
+    }
+
+    newlist = PyList_New(len);
+    if (newlist == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < PyList_GET_SIZE(fut->fut_callbacks); i++) {
+        int ret;
+        PyObject *item = PyList_GET_ITEM(fut->fut_callbacks, i);
+
+        Py_INCREF(item);
+        ret = PyObject_RichCompareBool(item, fn, Py_NE);
+        if (ret == 1) {
+            PyList_SET_ITEM(newlist, j, item);
+            j++;
+            continue;
+        }
+        Py_DECREF(item);
+        if (ret < 0) {
+            goto fail;
+        }
+    }
+
+    if (PyList_SetSlice(newlist, j, len, NULL) < 0) {
+        goto fail;
+    }
+    len = PyList_GET_SIZE(fut->fut_callbacks);
+    if (j < len &&
+        PyList_SetSlice(fut->fut_callbacks, 0, len, newlist) < 0) {
+        goto fail;
+    }
+    Py_DECREF(newlist);
+    return PyLong_FromSsize_t(len - j);
+
+fail:
+    Py_DECREF(newlist);
+    return NULL;
+}
+
+PyDoc_STRVAR(future_cancel_doc,
+"cancel() -> bool\n\
+\n\
+Cancel the future and schedule callbacks.\n\
+\n\
+If the future is already done or cancelled, return False.  Otherwise,\n\
+change the future's state to cancelled, schedule the callbacks and\n\
+return True.");
+
+static PyObject *
+FutureObj_cancel(FutureObj *fut, PyObject *unused)
+{
+    ENSURE_FUTURE_ALIVE(fut)
+    return future_cancel(fut);
+}
+
+PyDoc_STRVAR(future_cancelled_doc,
+"cancelled() -> bool\n\
+\n\
+Return True if the future was cancelled.");
+
+static PyObject *
+FutureObj_cancelled(FutureObj *fut, PyObject *unused)
+{
+    return PyBool_FromLong(fut->fut_state == STATE_CANCELLED);
+}
+
+PyDoc_STRVAR(future_done_doc,
+"done() -> bool\n\
+\n\
+Return True if the future is done.\n\
+\n\
+Done means either that a result / exception are available, or that the\n\
+future was cancelled.");
+
+static PyObject *
+FutureObj_done(FutureObj *fut, PyObject *unused)
+{
+    return PyBool_FromLong(fut->fut_state != STATE_PENDING);
+}
+
+static PyObject *
+FutureObj_schedule_callbacks(FutureObj *fut, PyObject *unused)
+{
+    ENSURE_FUTURE_ALIVE(fut)
+    if (future_schedule_callbacks(fut) == -1) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+/* Internal helper to copy state from another Future, which may be a
+   concurrent.futures.Future. */
+static PyObject *
+FutureObj_copy_state(FutureObj *fut, PyObject *other)
+{
+    PyObject *res, *exc;
+    int is_true;
+
+    ENSURE_FUTURE_ALIVE(fut)
+
+    if (fut->fut_state == STATE_CANCELLED) {
+        Py_RETURN_NONE;
+    }
+    assert(fut->fut_state == STATE_PENDING);
+
+    res = _PyObject_CallMethodId(other, &PyId_cancelled, NULL);
+    if (res == NULL) {
+        return NULL;
+    }
+    is_true = PyObject_IsTrue(res);
+    Py_DECREF(res);
+    if (is_true < 0) {
+        return NULL;
+    }
+    if (is_true) {
+        return future_cancel(fut);
+    }
+
+    exc = _PyObject_CallMethodId(other, &PyId_exception, NULL);
+    if (exc == NULL) {
+        return NULL;
+    }
+    if (exc != Py_None) {
+        res = future_set_exception(fut, exc);
+        Py_DECREF(exc);
+        return res;
+    }
+    Py_DECREF(exc);
+
+    res = _PyObject_CallMethodId(other, &PyId_result, NULL);
+    if (res == NULL) {
+        return NULL;
+    }
+    exc = future_set_result(fut, res);
+    Py_DECREF(res);
+    return exc;
+}
+
+static PyObject *
+FutureObj_repr_info(FutureObj *fut, PyObject *unused)
+{
+    if (module_init() < 0) {
+        return NULL;
+    }
+    return PyObject_CallFunctionObjArgs(asyncio_future_repr_info_func,
+                                        fut, NULL);
+}
+
+static PyObject *
+FutureObj_repr(FutureObj *fut)
+{
+    PyObject *rinfo, *sep, *rinfo_s, *name, *rstr = NULL;
+
+    rinfo = _PyObject_CallMethodId((PyObject *)fut, &PyId__repr_info, NULL);
+    if (rinfo == NULL) {
+        return NULL;
+    }
+
+    sep = PyUnicode_FromString(" ");
+    if (sep == NULL) {
+        Py_DECREF(rinfo);
+        return NULL;
+    }
+    rinfo_s = PyUnicode_Join(sep, rinfo);
+    Py_DECREF(sep);
+    Py_DECREF(rinfo);
+    if (rinfo_s == NULL) {
+        return NULL;
+    }
+
+    name = _PyObject_GetAttrId((PyObject *)Py_TYPE(fut), &PyId___name__);
+    if (name != NULL) {
+        rstr = PyUnicode_FromFormat("<%S %U>", name, rinfo_s);
+        Py_DECREF(name);
+    }
+    Py_DECREF(rinfo_s);
+    return rstr;
+}
+
+static void
+FutureObj_finalize(FutureObj *fut)
+{
+    PyObject *error_type, *error_value, *error_traceback;
+    PyObject *context;
+    PyObject *type_name;
+    PyObject *message = NULL;
+    PyObject *func;
+
+    if (!fut->fut_log_tb || fut->fut_loop == NULL) {
+        return;
+    }
+    assert(fut->fut_exception != NULL);
+    fut->fut_log_tb = 0;
+
+    /* Save the current exception, if any. */
+    PyErr_Fetch(&error_type, &error_value, &error_traceback);
+
+    context = PyDict_New();
+    if (context == NULL) {
+        goto finally;
+    }
+
+    type_name = _PyObject_GetAttrId((PyObject *)Py_TYPE(fut), &PyId___name__);
+    if (type_name == NULL) {
+        goto finally;
+    }
+    message = PyUnicode_FromFormat("%S exception was never retrieved",
+                                   type_name);
+    Py_DECREF(type_name);
+    if (message == NULL) {
+        goto finally;
+    }
+
+    if (PyDict_SetItemString(context, "message", message) < 0 ||
+        PyDict_SetItemString(context, "exception", fut->fut_exception) < 0 ||
+        PyDict_SetItemString(context, "future", (PyObject*)fut) < 0) {
+        goto finally;
+    }
+    if (fut->fut_source_tb != NULL && PyObject_IsTrue(fut->fut_source_tb) &&
+        PyDict_SetItemString(context, "source_traceback",
+                             fut->fut_source_tb) < 0) {
+        goto finally;
+    }
+
+    func = _PyObject_GetAttrId(fut->fut_loop, &PyId_call_exception_handler);
+    if (func != NULL) {
+        PyObject *res = PyObject_CallFunctionObjArgs(func, context, NULL);
+        if (res == NULL) {
+            PyErr_WriteUnraisable(func);
+        }
+        else {
+            Py_DECREF(res);
+        }
+        Py_DECREF(func);
+    }
+
+finally:
+    if (PyErr_Occurred()) {
+        PyErr_WriteUnraisable((PyObject *)fut);
+    }
+    Py_XDECREF(context);
+    Py_XDECREF(message);
+
+    /* Restore the saved exception. */
+    PyErr_Restore(error_type, error_value, error_traceback);
+}
+
+static void
+FutureObj_dealloc(PyObject *self)
+{
+    FutureObj *fut = (FutureObj *)self;
+
+    if (Future_CheckExact(fut)) {
+        /* When fut is a subclass of Future, the finalizer is called
+           from subtype_dealloc. */
+        if (PyObject_CallFinalizerFromDealloc(self) < 0) {
+            /* resurrected */
+            return;
+        }
+    }
+
+    PyObject_GC_UnTrack(self);
+
+    if (fut->fut_weakreflist != NULL) {
+        PyObject_ClearWeakRefs(self);
+    }
+
+    (void)FutureObj_clear(fut);
+    Py_TYPE(fut)->tp_free(fut);
+}
+
+static PyObject *
+FutureObj_get_blocking(FutureObj *fut)
+{
+    return PyBool_FromLong(fut->fut_blocking);
+}
+
+static int
+FutureObj_set_blocking(FutureObj *fut, PyObject *val)
+{
+    int is_true;
+
+    if (val == NULL) {
+        PyErr_SetString(PyExc_AttributeError, "cannot delete attribute");
+        return -1;
+    }
+    is_true = PyObject_IsTrue(val);
+    if (is_true < 0) {
+        return -1;
+    }
+    fut->fut_blocking = is_true;
+    return 0;
+}
+
+static PyObject *
+FutureObj_get_log_traceback(FutureObj *fut)
+{
+    return PyBool_FromLong(fut->fut_log_tb);
+}
+
+static int
+FutureObj_set_log_traceback(FutureObj *fut, PyObject *val)
+{
+    int is_true;
+
+    if (val == NULL) {
+        PyErr_SetString(PyExc_AttributeError, "cannot delete attribute");
+        return -1;
+    }
+    is_true = PyObject_IsTrue(val);
+    if (is_true < 0) {
+        return -1;
+    }
+    fut->fut_log_tb = is_true;
+    return 0;
+}
+
+#define FUTURE_GETTER(NAME, FIELD)                  \
+    static PyObject *                               \
+    FutureObj_get_ ## NAME(FutureObj *fut)          \
+    {                                               \
+        if (fut->FIELD == NULL) {                   \
+            Py_RETURN_NONE;                         \
+        }                                           \
+        Py_INCREF(fut->FIELD);                      \
+        return fut->FIELD;                          \
+    }
+
+FUTURE_GETTER(loop, fut_loop)
+FUTURE_GETTER(callbacks, fut_callbacks)
+FUTURE_GETTER(result, fut_result)
+FUTURE_GETTER(exception, fut_exception)
+FUTURE_GETTER(source_traceback, fut_source_tb)
+
+#undef FUTURE_GETTER
+
+static PyObject *
+FutureObj_get_state(FutureObj *fut)
+{
+    PyObject *ret = future_state_name(fut);
+    Py_XINCREF(ret);
+    return ret;
+}
+
+static PyObject *future_new_iter(PyObject *);
+
+static PyMethodDef FutureType_methods[] = {
+    {"result", (PyCFunction)FutureObj_result, METH_NOARGS,
+     future_result_doc},
+    {"exception", (PyCFunction)FutureObj_exception, METH_NOARGS,
+     future_exception_doc},
+    {"set_result", (PyCFunction)FutureObj_set_result, METH_O,
+     future_set_result_doc},
+    {"set_exception", (PyCFunction)FutureObj_set_exception, METH_O,
+     future_set_exception_doc},
+    {"add_done_callback", (PyCFunction)FutureObj_add_done_callback, METH_O,
+     future_add_done_callback_doc},
+    {"remove_done_callback", (PyCFunction)FutureObj_remove_done_callback,
+     METH_O, future_remove_done_callback_doc},
+    {"cancel", (PyCFunction)FutureObj_cancel, METH_NOARGS,
+     future_cancel_doc},
+    {"cancelled", (PyCFunction)FutureObj_cancelled, METH_NOARGS,
+     future_cancelled_doc},
+    {"done", (PyCFunction)FutureObj_done, METH_NOARGS, future_done_doc},
+    {"_set_result_unless_cancelled",
+     (PyCFunction)FutureObj_set_result_unless_cancelled, METH_O, NULL},
+    {"_schedule_callbacks", (PyCFunction)FutureObj_schedule_callbacks,
+     METH_NOARGS, NULL},
+    {"_copy_state", (PyCFunction)FutureObj_copy_state, METH_O, NULL},
+    {"_repr_info", (PyCFunction)FutureObj_repr_info, METH_NOARGS, NULL},
+    {NULL, NULL}        /* Sentinel */
+};
+
+static PyGetSetDef FutureType_getsetlist[] = {
+    {"_state", (getter)FutureObj_get_state, NULL, NULL},
+    {"_blocking", (getter)FutureObj_get_blocking,
+                  (setter)FutureObj_set_blocking, NULL},
+    {"_loop", (getter)FutureObj_get_loop, NULL, NULL},
+    {"_callbacks", (getter)FutureObj_get_callbacks, NULL, NULL},
+    {"_result", (getter)FutureObj_get_result, NULL, NULL},
+    {"_exception", (getter)FutureObj_get_exception, NULL, NULL},
+    {"_log_traceback", (getter)FutureObj_get_log_traceback,
+                       (setter)FutureObj_set_log_traceback, NULL},
+    {"_source_traceback", (getter)FutureObj_get_source_traceback, NULL, NULL},
+    {"__dict__", PyObject_GenericGetDict, PyObject_GenericSetDict},
+    {NULL}              /* Sentinel */
+};
+
+PyDoc_STRVAR(future_doc,
+"Future(*, loop=None)\n\
+--\n\
+\n\
+This class is *almost* compatible with concurrent.futures.Future.\n\
+\n\
+    Differences:\n\
+\n\
+    - result() and exception() do not take a timeout argument and\n\
+      raise an exception when the future isn't done yet.\n\
+\n\
+    - Callbacks registered with add_done_callback() are always called\n\
+      via the event loop's call_soon_threadsafe().\n\
+\n\
+    - This class is not compatible with the wait() and as_completed()\n\
+      methods in the concurrent.futures package.");
+
+static PyTypeObject FutureType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_asyncio.Future",                          /* tp_name */
+    sizeof(FutureObj),                          /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor)FutureObj_dealloc,              /* tp_dealloc */
+    0,                                          /* tp_print */
+    0,                                          /* tp_getattr */
+    0,                                          /* tp_setattr */
+    0,                                          /* tp_reserved */
+    (reprfunc)FutureObj_repr,                   /* tp_repr */
+    0,                                          /* tp_as_number */
+    0,                                          /* tp_as_sequence */
+    0,                                          /* tp_as_mapping */
+    0,                                          /* tp_hash */
+    0,                                          /* tp_call */
+    0,                                          /* tp_str */
+    PyObject_GenericGetAttr,                    /* tp_getattro */
+    0,                                          /* tp_setattro */
+    0,                                          /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_BASETYPE
+        | Py_TPFLAGS_HAVE_FINALIZE,             /* tp_flags */
+    future_doc,                                 /* tp_doc */
+    (traverseproc)FutureObj_traverse,           /* tp_traverse */
+    (inquiry)FutureObj_clear,                   /* tp_clear */
+    0,                                          /* tp_richcompare */
+    offsetof(FutureObj, fut_weakreflist),       /* tp_weaklistoffset */
+    (getiterfunc)future_new_iter,               /* tp_iter */
+    0,                                          /* tp_iternext */
+    FutureType_methods,                         /* tp_methods */
+    0,                                          /* tp_members */
+    FutureType_getsetlist,                      /* tp_getset */
+    0,                                          /* tp_base */
+    0,                                          /* tp_dict */
+    0,                                          /* tp_descr_get */
+    0,                                          /* tp_descr_set */
+    offsetof(FutureObj, dict),                  /* tp_dictoffset */
+    (initproc)FutureObj_init,                   /* tp_init */
+    PyType_GenericAlloc,                        /* tp_alloc */
+    PyType_GenericNew,                          /* tp_new */
+    PyObject_GC_Del,                            /* tp_free */
+    0,                                          /* tp_is_gc */
+    0,                                          /* tp_bases */
+    0,                                          /* tp_mro */
+    0,                                          /* tp_cache */
+    0,                                          /* tp_subclasses */
+    0,                                          /* tp_weaklist */
+    0,                                          /* tp_del */
+    0,                                          /* tp_version_tag */
+    (destructor)FutureObj_finalize,             /* tp_finalize */
+};
+
+
+/*********************** Future Iterator **************************/
+
+/* The iterator returned by Future.__iter__() behaves like the generator
+   of the Python implementation:
+
+       if not self.done():
+           self._blocking = True
+           yield self
+       assert self.done(), "yield from wasn't used with future"
+       return self.result()
+*/
+
+typedef struct {
+    PyObject_HEAD
+    FutureObj *future;
+    int yielded;
+} futureiterobject;
+
+/* Free list of future iterators: one is created for every "yield from"
+   on a future, which makes them the most frequently allocated object of
+   a busy event loop. */
+#define FI_FREELIST_MAXLEN 255
+static futureiterobject *fi_freelist = NULL;
+static Py_ssize_t fi_freelist_len = 0;
+
+static void
+FutureIter_dealloc(futureiterobject *it)
+{
+    PyObject_GC_UnTrack(it);
+    Py_CLEAR(it->future);
+
+    if (fi_freelist_len < FI_FREELIST_MAXLEN) {
+        fi_freelist_len++;
+        it->future = (FutureObj *)fi_freelist;
+        fi_freelist = it;
+    }
+    else {
+        PyObject_GC_Del(it);
+    }
+}
+
+static PyObject *
+FutureIter_iternext(futureiterobject *it)
+{
+    PyObject *res;
+    FutureObj *fut = it->future;
+
+    if (fut == NULL) {
+        return NULL;
+    }
+
+    if (fut->fut_state == STATE_PENDING) {
+        if (!it->yielded) {
+            it->yielded = 1;
+            fut->fut_blocking = 1;
+            Py_INCREF(fut);
+            return (PyObject *)fut;
+        }
+        it->future = NULL;
+        Py_DECREF(fut);
+        PyErr_SetString(PyExc_AssertionError,
+                        "yield from wasn't used with future");
+        return NULL;
+    }
+
+    it->future = NULL;
+    res = future_get_result(fut);
+    Py_DECREF(fut);
+    if (res == NULL) {
+        return NULL;
+    }
+    if (res != Py_None) {
+        /* The result may be a tuple or an exception: wrap it in a
+           StopIteration instance so that it is not interpreted as
+           constructor arguments. */
+        PyObject *e = PyObject_CallFunctionObjArgs(PyExc_StopIteration,
+                                                   res, NULL);
+        if (e != NULL) {
+            PyErr_SetObject(PyExc_StopIteration, e);
+            Py_DECREF(e);
+        }
+    }
+    Py_DECREF(res);
+    return NULL;
+}
+
+static PyObject *
+FutureIter_send(futureiterobject *self, PyObject *arg)
+{
+    PyObject *res;
+
+    if (!self->yielded && arg != Py_None && self->future != NULL) {
+        PyErr_SetString(PyExc_TypeError,
+                        "can't send non-None value to a "
+                        "just-started generator");
+        return NULL;
+    }
+    res = FutureIter_iternext(self);
+    if (res == NULL && !PyErr_Occurred()) {
+        PyErr_SetNone(PyExc_StopIteration);
+    }
+    return res;
+}
+
+static PyObject *
+FutureIter_throw(futureiterobject *self, PyObject *args)
+{
+    PyObject *type = NULL, *val = NULL, *tb = NULL;
+
+    if (!PyArg_UnpackTuple(args, "throw", 1, 3, &type, &val, &tb)) {
+        return NULL;
+    }
+
+    if (val == Py_None) {
+        val = NULL;
+    }
+    if (tb == Py_None) {
+        tb = NULL;
+    }
+    else if (tb != NULL && !PyTraceBack_Check(tb)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "throw() third argument must be a traceback");
+        return NULL;
+    }
+
+    Py_INCREF(type);
+    Py_XINCREF(val);
+    Py_XINCREF(tb);
+
+    if (PyExceptionClass_Check(type)) {
+        PyErr_NormalizeException(&type, &val, &tb);
+        if (tb != NULL) {
+            PyException_SetTraceback(val, tb);
+        }
+    }
+    else if (PyExceptionInstance_Check(type)) {
+        if (val != NULL) {
+            PyErr_SetString(PyExc_TypeError,
+                            "instance exception may not have a "
+                            "separate value");
+            goto fail;
+        }
+        val = type;
+        type = PyExceptionInstance_Class(type);
+        Py_INCREF(type);
+        if (tb == NULL) {
+            tb = PyException_GetTraceback(val);
+        }
+    }
+    else {
+        PyErr_SetString(PyExc_TypeError,
+                        "exceptions must be classes deriving "
+                        "BaseException");
+        goto fail;
+    }
+
+    /* The exception is raised at the yield point, which terminates the
+       iteration. */
+    Py_CLEAR(self->future);
+    PyErr_Restore(type, val, tb);
+    return NULL;
+
+fail:
+    Py_DECREF(type);
+    Py_XDECREF(val);
+    Py_XDECREF(tb);
+    return NULL;
+}
+
+static PyObject *
+FutureIter_close(futureiterobject *self, PyObject *unused)
+{
+    Py_CLEAR(self->future);
+    Py_RETURN_NONE;
+}
+
+static int
+FutureIter_traverse(futureiterobject *it, visitproc visit, void *arg)
+{
+    Py_VISIT(it->future);
+    return 0;
+}
+
+static PyMethodDef FutureIter_methods[] = {
+    {"send",  (PyCFunction)FutureIter_send, METH_O, NULL},
+    {"throw", (PyCFunction)FutureIter_throw, METH_VARARGS, NULL},
+    {"close", (PyCFunction)FutureIter_close, METH_NOARGS, NULL},
+    {NULL, NULL}        /* Sentinel */
+};
+
+static PyTypeObject FutureIterType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_asyncio.FutureIter",
+    sizeof(futureiterobject),                /* tp_basicsize */
+    0,                                       /* tp_itemsize */
+    (destructor)FutureIter_dealloc,          /* tp_dealloc */
+    0,                                       /* tp_print */
+    0,                                       /* tp_getattr */
+    0,                                       /* tp_setattr */
+    0,                                       /* tp_reserved */
+    0,                                       /* tp_repr */
+    0,                                       /* tp_as_number */
+    0,                                       /* tp_as_sequence */
+    0,                                       /* tp_as_mapping */
+    0,                                       /* tp_hash */
+    0,                                       /* tp_call */
+    0,                                       /* tp_str */
+    PyObject_GenericGetAttr,                 /* tp_getattro */
+    0,                                       /* tp_setattro */
+    0,                                       /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC, /* tp_flags */
+    0,                                       /* tp_doc */
+    (traverseproc)FutureIter_traverse,       /* tp_traverse */
+    0,                                       /* tp_clear */
+    0,                                       /* tp_richcompare */
+    0,                                       /* tp_weaklistoffset */
+    PyObject_SelfIter,                       /* tp_iter */
+    (iternextfunc)FutureIter_iternext,       /* tp_iternext */
+    FutureIter_methods,                      /* tp_methods */
+    0,                                       /* tp_members */
+};
+
+static PyObject *
+future_new_iter(PyObject *fut)
+{
+    futureiterobject *it;
+
+    if (!Future_Check(fut)) {
+        PyErr_BadInternalCall();
+        return NULL;
+    }
+    if (fi_freelist_len) {
+        fi_freelist_len--;
+        it = fi_freelist;
+        fi_freelist = (futureiterobject *)it->future;
+        it->future = NULL;
+        _Py_NewReference((PyObject *)it);
+    }
+    else {
+        it = PyObject_GC_New(futureiterobject, &FutureIterType);
+        if (it == NULL) {
+            return NULL;
+        }
+    }
+    Py_INCREF(fut);
+    it->future = (FutureObj *)fut;
+    it->yielded = 0;
+    PyObject_GC_Track(it);
+    return (PyObject *)it;
+}
+
+
+/*********************** Task **************************/
+
+/* Schedule task._step(*args) with loop.call_soon().  The bound method is
+   looked up on the task so that subclasses can override _step(). */
+static int
+task_call_step_soon(TaskObj *task, PyObject *exc)
+{
+    PyObject *step, *handle;
+
+    step = _PyObject_GetAttrId((PyObject *)task, &PyId__step);
+    if (step == NULL) {
+        return -1;
+    }
+    if (exc == NULL) {
+        handle = _PyObject_CallMethodIdObjArgs(task->task_future.fut_loop,
+                                               &PyId_call_soon, step, NULL);
+    }
+    else {
+        handle = _PyObject_CallMethodIdObjArgs(task->task_future.fut_loop,
+                                               &PyId_call_soon, step,
+                                               Py_None, exc, NULL);
+    }
+    Py_DECREF(step);
+    if (handle == NULL) {
+        return -1;
+    }
+    Py_DECREF(handle);
+    return 0;
+}
+
+/* Like task_call_step_soon(), passing a new RuntimeError as exc */
+static int
+task_set_error_soon(TaskObj *task, const char *format, ...)
+{
+    PyObject *msg, *exc;
+    int res;
+    va_list vargs;
+
+#ifdef HAVE_STDARG_PROTOTYPES
+    va_start(vargs, format);
+#else
+    va_start(vargs);
+#endif
+    msg = PyUnicode_FromFormatV(format, vargs);
+    va_end(vargs);
+    if (msg == NULL) {
+        return -1;
+    }
+
+    exc = PyObject_CallFunctionObjArgs(PyExc_RuntimeError, msg, NULL);
+    Py_DECREF(msg);
+    if (exc == NULL) {
+        return -1;
+    }
+
+    res = task_call_step_soon(task, exc);
+    Py_DECREF(exc);
+    return res;
+}
+
+static int
+TaskObj_init(TaskObj *task, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"coro", "loop", NULL};
+    PyObject *coro, *loop = Py_None;
+    PyObject *res;
+    int is_coro;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|$O:Task", kwlist,
+                                     &coro, &loop)) {
+        return -1;
+    }
+
+    if (future_init((FutureObj *)task, loop) < 0) {
+        return -1;
+    }
+
+    res = PyObject_CallFunctionObjArgs(asyncio_iscoroutine_func, coro, NULL);
+    if (res == NULL) {
+        return -1;
+    }
+    is_coro = PyObject_IsTrue(res);
+    Py_DECREF(res);
+    if (is_coro < 0) {
+        return -1;
+    }
+    if (!is_coro) {
+        /* Not a coroutine function! */
+        PyObject *r = PyObject_Repr(coro);
+        if (r != NULL) {
+            PyErr_SetObject(PyExc_AssertionError, r);
+            Py_DECREF(r);
+        }
+        return -1;
+    }
+
+    Py_CLEAR(task->task_coro);
+    task->task_coro = PyObject_GetIter(coro);
+    if (task->task_coro == NULL) {
+        return -1;
+    }
+    Py_CLEAR(task->task_fut_waiter);
+    task->task_must_cancel = 0;
+    task->task_log_destroy_pending = 1;
+
+    if (task_call_step_soon(task, NULL) < 0) {
+        return -1;
+    }
+
+    res = _PyObject_CallMethodIdObjArgs(all_tasks, &PyId_add, task, NULL);
+    if (res == NULL) {
+        return -1;
+    }
+    Py_DECREF(res);
+    return 0;
+}
+
+static int
+TaskObj_clear(TaskObj *task)
+{
+    (void)FutureObj_clear((FutureObj *)task);
+    Py_CLEAR(task->task_coro);
+    Py_CLEAR(task->task_fut_waiter);
+    return 0;
+}
+
+static int
+TaskObj_traverse(TaskObj *task, visitproc visit, void *arg)
+{
+    Py_VISIT(task->task_coro);
+    Py_VISIT(task->task_fut_waiter);
+    (void)FutureObj_traverse((FutureObj *)task, visit, arg);
+    return 0;
+}
+
+static PyObject *
+task_step_impl(TaskObj *task, PyObject *value, PyObject *exc)
+{
+    FutureObj *fut = (FutureObj *)task;
+    PyObject *coro = task->task_coro;
+    PyObject *loop = fut->fut_loop;
+    PyObject *result;
+    PyObject *ret = NULL;
+    PyObject *et, *ev, *tb;
+    int clear_exc = 0;
+    int is_true;
+
+    if (fut->fut_state != STATE_PENDING) {
+        PyErr_Format(PyExc_AssertionError,
+                     "_step(): already done: %R, %R, %R",
+                     task,
+                     value ? value : Py_None,
+                     exc ? exc : Py_None);
+        return NULL;
+    }
+
+    if (exc == Py_None) {
+        exc = NULL;
+    }
+
+    if (task->task_must_cancel) {
+        is_true = 0;
+        if (exc != NULL) {
+            is_true = PyObject_IsInstance(exc, asyncio_CancelledError);
+            if (is_true < 0) {
+                return NULL;
+            }
+        }
+        if (!is_true) {
+            exc = PyObject_CallObject(asyncio_CancelledError, NULL);
+            if (exc == NULL) {
+                return NULL;
+            }
+            clear_exc = 1;
+        }
+        task->task_must_cancel = 0;
+    }
+
+    Py_CLEAR(task->task_fut_waiter);
+
+    if (PyDict_SetItem(current_tasks, loop, (PyObject *)task) < 0) {
+        goto fail;
+    }
+
+    /* Call either coro.throw(exc) or coro.send(value). */
+    if (exc != NULL) {
+        result = _PyObject_CallMethodIdObjArgs(coro, &PyId_throw, exc, NULL);
+    }
+    else if (value != NULL && value != Py_None) {
+        if (PyGen_CheckExact(coro)) {
+            result = _PyGen_Send((PyGenObject *)coro, value);
+        }
+        else {
+            result = _PyObject_CallMethodIdObjArgs(coro, &PyId_send,
+                                                   value, NULL);
+        }
+    }
+    else if (PyGen_CheckExact(coro)) {
+        result = _PyGen_Send((PyGenObject *)coro, Py_None);
+    }
+    else {
+        result = (*Py_TYPE(coro)->tp_iternext)(coro);
+        if (result == NULL && !PyErr_Occurred()) {
+            PyErr_SetNone(PyExc_StopIteration);
+        }
+    }
+    if (clear_exc) {
+        Py_CLEAR(exc);
+    }
+
+    if (result == NULL) {
+        PyObject *o;
+
+        if (PyErr_ExceptionMatches(PyExc_StopIteration)) {
+            PyObject *val;
+            if (_PyGen_FetchStopIterationValue(&val) < 0) {
+                goto pop_and_fail;
+            }
+            o = future_set_result(fut, val);
+            Py_DECREF(val);
+            if (o == NULL) {
+                goto pop_and_fail;
+            }
+            Py_DECREF(o);
+            goto pop_and_return;
+        }
+
+        if (PyErr_ExceptionMatches(asyncio_CancelledError)) {
+            /* CancelledError */
+            PyErr_Clear();
+            o = future_cancel(fut);
+            if (o == NULL) {
+                goto pop_and_fail;
+            }
+            Py_DECREF(o);
+            goto pop_and_return;
+        }
+
+        /* Some other exception; pop it and call Task.set_exception() */
+        PyErr_Fetch(&et, &ev, &tb);
+        assert(et);
+        PyErr_NormalizeException(&et, &ev, &tb);
+        if (tb != NULL) {
+            PyException_SetTraceback(ev, tb);
+        }
+        o = future_set_exception(fut, ev);
+        if (o == NULL) {
+            Py_DECREF(et);
+            Py_XDECREF(tb);
+            Py_XDECREF(ev);
+            goto pop_and_fail;
+        }
+        Py_DECREF(o);
+
+        if (!PyErr_GivenExceptionMatches(et, PyExc_Exception)) {
+            /* We've got a BaseException; re-raise it */
+            PyErr_Restore(et, ev, tb);
+            goto pop_and_fail;
+        }
+
+        Py_DECREF(et);
+        Py_XDECREF(tb);
+        Py_XDECREF(ev);
+        goto pop_and_return;
+    }
+
+    if (result == (PyObject *)task) {
+        /* We have a task that wants to await on itself, which never
+           completes; let the task fail with a RuntimeError. */
+        goto bad_yield;
+    }
+
+    /* Check if `result` is a Future-compatible object */
+    is_true = isfuture(result);
+    if (is_true < 0) {
+        goto pop_and_fail_result;
+    }
+    if (is_true) {
+        PyObject *wakeup, *res;
+        int blocking;
+
+        /* Yielded Future must come from Future.__iter__(). */
+        if (Future_Check(result)) {
+            blocking = ((FutureObj *)result)->fut_blocking;
+        }
+        else {
+            PyObject *o = _PyObject_GetAttrId(result, &PyId__blocking);
+            if (o == NULL) {
+                goto pop_and_fail_result;
+            }
+            blocking = PyObject_IsTrue(o);
+            Py_DECREF(o);
+            if (blocking < 0) {
+                goto pop_and_fail_result;
+            }
+        }
+
+        if (!blocking) {
+            if (task_set_error_soon(
+                    task,
+                    "yield was used instead of yield from "
+                    "in task %R with %R", task, result) < 0) {
+                goto pop_and_fail_result;
+            }
+            Py_DECREF(result);
+            goto pop_and_return;
+        }
+
+        if (Future_Check(result)) {
+            ((FutureObj *)result)->fut_blocking = 0;
+        }
+        else if (_PyObject_SetAttrId(result, &PyId__blocking,
+                                     Py_False) < 0) {
+            goto pop_and_fail_result;
+        }
+
+        /* result.add_done_callback(task._wakeup) */
+        wakeup = _PyObject_GetAttrId((PyObject *)task, &PyId__wakeup);
+        if (wakeup == NULL) {
+            goto pop_and_fail_result;
+        }
+        if (Future_CheckExact(result) || Task_CheckExact(result)) {
+            res = future_add_done_callback((FutureObj *)result, wakeup);
+        }
+        else {
+            res = _PyObject_CallMethodIdObjArgs(result,
+                                                &PyId_add_done_callback,
+                                                wakeup, NULL);
+        }
+        Py_DECREF(wakeup);
+        if (res == NULL) {
+            goto pop_and_fail_result;
+        }
+        Py_DECREF(res);
+
+        /* task._fut_waiter = result; the reference is stolen */
+        task->task_fut_waiter = result;
+
+        if (task->task_must_cancel) {
+            PyObject *r = _PyObject_CallMethodId(result, &PyId_cancel, NULL);
+            if (r == NULL) {
+                goto pop_and_fail;
+            }
+            is_true = PyObject_IsTrue(r);
+            Py_DECREF(r);
+            if (is_true < 0) {
+                goto pop_and_fail;
+            }
+            if (is_true) {
+                task->task_must_cancel = 0;
+            }
+        }
+        goto pop_and_return;
+    }
+
+    if (result == Py_None) {
+        /* Bare yield relinquishes control for one event loop iteration. */
+        Py_DECREF(result);
+        if (task_call_step_soon(task, NULL) < 0) {
+            goto pop_and_fail;
+        }
+        goto pop_and_return;
+    }
+
+    if (PyGen_Check(result)) {
+        /* Yielding a generator is just wrong. */
+        if (task_set_error_soon(
+                task,
+                "yield was used instead of yield from for "
+                "generator in task %R with %S", task, result) < 0) {
+            goto pop_and_fail_result;
+        }
+        Py_DECREF(result);
+        goto pop_and_return;
+    }
+
+bad_yield:
+    /* Yielding something else is an error. */
+    if (task_set_error_soon(task, "Task got bad yield: %R", result) < 0) {
+        goto pop_and_fail_result;
+    }
+    Py_DECREF(result);
+
+pop_and_return:
+    Py_INCREF(Py_None);
+    ret = Py_None;
+    goto pop;
+
+pop_and_fail_result:
+    Py_DECREF(result);
+pop_and_fail:
+    ret = NULL;
+
+pop:
+    /* Remove the task from current_tasks, preserving any pending
+       exception. */
+    PyErr_Fetch(&et, &ev, &tb);
+    if (PyDict_DelItem(current_tasks, loop) < 0) {
+        Py_XDECREF(et);
+        Py_XDECREF(ev);
+        Py_XDECREF(tb);
+        Py_XDECREF(ret);
+        return NULL;
+    }
+    PyErr_Restore(et, ev, tb);
+    return ret;
+
+fail:
+    if (clear_exc) {
+        Py_DECREF(exc);
+    }
+    return NULL;
+}
+
+PyDoc_STRVAR(task_step_doc,
+"_step(value=None, exc=None) -> None\n\
+\n\
+Advance the wrapped coroutine by one step.");
+
+static PyObject *
+TaskObj_step(TaskObj *task, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"value", "exc", NULL};
+    PyObject *value = Py_None, *exc = Py_None;
+
+    ENSURE_FUTURE_ALIVE(&task->task_future)
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OO:_step", kwlist,
+                                     &value, &exc)) {
+        return NULL;
+    }
+    return task_step_impl(task, value, exc);
+}
+
+static PyObject *
+task_step(TaskObj *task, PyObject *value, PyObject *exc)
+{
+    if (Task_CheckExact(task)) {
+        return task_step_impl(task, value, exc);
+    }
+    /* Subclasses may override _step() */
+    return _PyObject_CallMethodIdObjArgs((PyObject *)task, &PyId__step,
+                                         value, exc, NULL);
+}
+
+static PyObject *
+TaskObj_wakeup(TaskObj *task, PyObject *fut)
+{
+    PyObject *value, *res;
+    PyObject *et, *ev, *tb;
+
+    ENSURE_FUTURE_ALIVE(&task->task_future)
+
+    if (Future_CheckExact(fut) || Task_CheckExact(fut)) {
+        value = future_get_result((FutureObj *)fut);
+    }
+    else {
+        value = _PyObject_CallMethodId(fut, &PyId_result, NULL);
+    }
+
+    if (value != NULL) {
+        res = task_step(task, value, Py_None);
+        Py_DECREF(value);
+        return res;
+    }
+
+    if (!PyErr_ExceptionMatches(PyExc_Exception)) {
+        return NULL;
+    }
+
+    /* This may also be a cancellation. */
+    PyErr_Fetch(&et, &ev, &tb);
+    PyErr_NormalizeException(&et, &ev, &tb);
+    if (tb != NULL) {
+        PyException_SetTraceback(ev, tb);
+    }
+    res = task_step(task, Py_None, ev);
+    Py_DECREF(et);
+    Py_XDECREF(ev);
+    Py_XDECREF(tb);
+    return res;
+}
+
+PyDoc_STRVAR(task_cancel_doc,
+"cancel() -> bool\n\
+\n\
+Request that this task cancel itself.\n\
+\n\
+This arranges for a CancelledError to be thrown into the\n\
+wrapped coroutine on the next cycle through the event loop.\n\
+The coroutine then has a chance to clean up or even deny\n\
+the request using try/except/finally.\n\
+\n\
+Unlike Future.cancel, this does not guarantee that the\n\
+task will be cancelled: the exception might be caught and\n\
+acted upon, delaying cancellation of the task or preventing\n\
+cancellation completely.  The task may also return a value or\n\
+raise a different exception.\n\
+\n\
+Immediately after this method is called, Task.cancelled() will\n\
+not return True (unless the task was already cancelled).  A\n\
+task will be marked as cancelled when the wrapped coroutine\n\
+terminates with a CancelledError exception (even if cancel()\n\
+was not called).");
+
+static PyObject *
+TaskObj_cancel(TaskObj *task, PyObject *unused)
+{
+    if (task->task_future.fut_state != STATE_PENDING) {
+        Py_RETURN_FALSE;
+    }
+
+    if (task->task_fut_waiter != NULL) {
+        PyObject *res;
+        int is_true;
+
+        res = _PyObject_CallMethodId(task->task_fut_waiter, &PyId_cancel,
+                                     NULL);
+        if (res == NULL) {
+            return NULL;
+        }
+        is_true = PyObject_IsTrue(res);
+        Py_DECREF(res);
+        if (is_true < 0) {
+            return NULL;
+        }
+        if (is_true) {
+            /* Leave task._fut_waiter; it may be a Task that catches and
+               ignores the cancellation so we may have to cancel it again
+               later. */
+            Py_RETURN_TRUE;
+        }
+    }
+
+    /* It must be the case that task._step is already scheduled. */
+    task->task_must_cancel = 1;
+    Py_RETURN_TRUE;
+}
+
+PyDoc_STRVAR(task_current_task_doc,
+"current_task(loop=None) -> Task or None\n\
+\n\
+Return the currently running task in an event loop or None.\n\
+\n\
+By default the current task for the current event loop is returned.\n\
+\n\
+None is returned when called not in the context of a Task.");
+
+static PyObject *
+TaskObj_current_task(PyObject *cls, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"loop", NULL};
+    PyObject *loop = Py_None;
+    PyObject *res;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O:current_task", kwlist,
+                                     &loop)) {
+        return NULL;
+    }
+    if (module_init() < 0) {
+        return NULL;
+    }
+
+    if (loop == Py_None) {
+        loop = PyObject_CallObject(asyncio_get_event_loop, NULL);
+        if (loop == NULL) {
+            return NULL;
+        }
+    }
+    else {
+        Py_INCREF(loop);
+    }
+
+    res = PyDict_GetItem(current_tasks, loop);
+    Py_DECREF(loop);
+    if (res == NULL) {
+        Py_RETURN_NONE;
+    }
+    Py_INCREF(res);
+    return res;
+}
+
+PyDoc_STRVAR(task_all_tasks_doc,
+"all_tasks(loop=None) -> set\n\
+\n\
+Return a set of all tasks for an event loop.\n\
+\n\
+By default all tasks for the current event loop are returned.");
+
+static PyObject *
+TaskObj_all_tasks(PyObject *cls, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"loop", NULL};
+    PyObject *loop = Py_None;
+    PyObject *set, *iter, *task;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O:all_tasks", kwlist,
+                                     &loop)) {
+        return NULL;
+    }
+    if (module_init() < 0) {
+        return NULL;
+    }
+
+    if (loop == Py_None) {
+        loop = PyObject_CallObject(asyncio_get_event_loop, NULL);
+        if (loop == NULL) {
+            return NULL;
+        }
+    }
+    else {
+        Py_INCREF(loop);
+    }
+
+    set = PySet_New(NULL);
+    if (set == NULL) {
+        goto fail;
+    }
+    iter = PyObject_GetIter(all_tasks);
+    if (iter == NULL) {
+        goto fail;
+    }
+    while ((task = PyIter_Next(iter)) != NULL) {
+        PyObject *task_loop;
+
+        if (Future_Check(task)) {
+            task_loop = ((FutureObj *)task)->fut_loop;
+            Py_XINCREF(task_loop);
+        }
+        else {
+            task_loop = _PyObject_GetAttrId(task, &PyId__loop);
+            if (task_loop == NULL) {
+                Py_DECREF(task);
+                Py_DECREF(iter);
+                goto fail;
+            }
+        }
+        if (task_loop == loop && PySet_Add(set, task) < 0) {
+            Py_DECREF(task_loop);
+            Py_DECREF(task);
+            Py_DECREF(iter);
+            goto fail;
+        }
+        Py_XDECREF(task_loop);
+        Py_DECREF(task);
+    }
+    Py_DECREF(iter);
+    if (PyErr_Occurred()) {
+        goto fail;
+    }
+    Py_DECREF(loop);
+    return set;
+
+fail:
+    Py_XDECREF(set);
+    Py_DECREF(loop);
+    return NULL;
+}
+
+static PyObject *
+TaskObj_repr_info(TaskObj *task, PyObject *unused)
+{
+    if (module_init() < 0) {
+        return NULL;
+    }
+    return PyObject_CallFunctionObjArgs(asyncio_task_repr_info_func,
+                                        task, NULL);
+}
+
+PyDoc_STRVAR(task_get_stack_doc,
+"get_stack(*, limit=None) -> list\n\
+\n\
+Return the list of stack frames for this task's coroutine.\n\
+\n\
+If the coroutine is not done, this returns the stack where it is\n\
+suspended.  If the coroutine has completed successfully or was\n\
+cancelled, this returns an empty list.  If the coroutine was\n\
+terminated by an exception, this returns the list of traceback\n\
+frames.\n\
+\n\
+The frames are always ordered from oldest to newest.\n\
+\n\
+The optional limit gives the maximum number of frames to\n\
+return; by default all available frames are returned.  Its\n\
+meaning differs depending on whether a stack or a traceback is\n\
+returned: the newest frames of a stack are returned, but the\n\
+oldest frames of a traceback are returned.  (This matches the\n\
+behavior of the traceback module.)\n\
+\n\
+For reasons beyond our control, only one stack frame is\n\
+returned for a suspended coroutine.");
+
+static PyObject *
+TaskObj_get_stack(TaskObj *task, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"limit", NULL};
+    PyObject *limit = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|$O:get_stack", kwlist,
+                                     &limit)) {
+        return NULL;
+    }
+    if (module_init() < 0) {
+        return NULL;
+    }
+    return PyObject_CallFunctionObjArgs(asyncio_task_get_stack_func,
+                                        task, limit, NULL);
+}
+
+PyDoc_STRVAR(task_print_stack_doc,
+"print_stack(*, limit=None, file=None) -> None\n\
+\n\
+Print the stack or traceback for this task's coroutine.\n\
+\n\
+This produces output similar to that of the traceback module,\n\
+for the frames retrieved by get_stack().  The limit argument\n\
+is passed to get_stack().  The file argument is an I/O stream\n\
+to which the output is written; by default output is written\n\
+to sys.stderr.");
+
+static PyObject *
+TaskObj_print_stack(TaskObj *task, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"limit", "file", NULL};
+    PyObject *limit = Py_None, *file = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|$OO:print_stack", kwlist,
+                                     &limit, &file)) {
+        return NULL;
+    }
+    if (module_init() < 0) {
+        return NULL;
+    }
+    return PyObject_CallFunctionObjArgs(asyncio_task_print_stack_func,
+                                        task, limit, file, NULL);
+}
+
+static void
+TaskObj_finalize(TaskObj *task)
+{
+    PyObject *error_type, *error_value, *error_traceback;
+    PyObject *context = NULL;
+    PyObject *message = NULL;
+    PyObject *func;
+    FutureObj *fut = (FutureObj *)task;
+
+    if (fut->fut_state != STATE_PENDING || fut->fut_loop == NULL ||
+        !task->task_log_destroy_pending) {
+        goto done;
+    }
+
+    /* Save the current exception, if any. */
+    PyErr_Fetch(&error_type, &error_value, &error_traceback);
+
+    context = PyDict_New();
+    if (context == NULL) {
+        goto finally;
+    }
+
+    message = PyUnicode_FromString("Task was destroyed but it is pending!");
+    if (message == NULL) {
+        goto finally;
+    }
+
+    if (PyDict_SetItemString(context, "message", message) < 0 ||
+        PyDict_SetItemString(context, "task", (PyObject*)task) < 0) {
+        goto finally;
+    }
+    if (fut->fut_source_tb != NULL && PyObject_IsTrue(fut->fut_source_tb) &&
+        PyDict_SetItemString(context, "source_traceback",
+                             fut->fut_source_tb) < 0) {
+        goto finally;
+    }
+
+    func = _PyObject_GetAttrId(fut->fut_loop, &PyId_call_exception_handler);
+    if (func != NULL) {
+        PyObject *res = PyObject_CallFunctionObjArgs(func, context, NULL);
+        if (res == NULL) {
+            PyErr_WriteUnraisable(func);
+        }
+        else {
+            Py_DECREF(res);
+        }
+        Py_DECREF(func);
+    }
+
+finally:
+    if (PyErr_Occurred()) {
+        PyErr_WriteUnraisable((PyObject *)task);
+    }
+    Py_XDECREF(context);
+    Py_XDECREF(message);
+
+    /* Restore the saved exception. */
+    PyErr_Restore(error_type, error_value, error_traceback);
+
+done:
+    FutureObj_finalize((FutureObj*)task);
+}
+
+static void
+TaskObj_dealloc(PyObject *self)
+{
+    TaskObj *task = (TaskObj *)self;
+
+    if (Task_CheckExact(self)) {
+        /* When task is a subclass of Task, the finalizer is called
+           from subtype_dealloc. */
+        if (PyObject_CallFinalizerFromDealloc(self) < 0) {
+            /* resurrected */
+            return;
+        }
+    }
+
+    PyObject_GC_UnTrack(self);
+
+    if (task->task_future.fut_weakreflist != NULL) {
+        PyObject_ClearWeakRefs(self);
+    }
+
+    (void)TaskObj_clear(task);
+    Py_TYPE(task)->tp_free(task);
+}
+
+static PyObject *
+TaskObj_get_log_destroy_pending(TaskObj *task)
+{
+    return PyBool_FromLong(task->task_log_destroy_pending);
+}
+
+static int
+TaskObj_set_log_destroy_pending(TaskObj *task, PyObject *val)
+{
+    int is_true;
+
+    if (val == NULL) {
+        PyErr_SetString(PyExc_AttributeError, "cannot delete attribute");
+        return -1;
+    }
+    is_true = PyObject_IsTrue(val);
+    if (is_true < 0) {
+        return -1;
+    }
+    task->task_log_destroy_pending = is_true;
+    return 0;
+}
+
+static PyObject *
+TaskObj_get_must_cancel(TaskObj *task)
+{
+    return PyBool_FromLong(task->task_must_cancel);
+}
+
+static PyObject *
+TaskObj_get_coro(TaskObj *task)
+{
+    if (task->task_coro == NULL) {
+        Py_RETURN_NONE;
+    }
+    Py_INCREF(task->task_coro);
+    return task->task_coro;
+}
+
+static PyObject *
+TaskObj_get_fut_waiter(TaskObj *task)
+{
+    if (task->task_fut_waiter == NULL) {
+        Py_RETURN_NONE;
+    }
+    Py_INCREF(task->task_fut_waiter);
+    return task->task_fut_waiter;
+}
+
+static PyMethodDef TaskType_methods[] = {
+    {"current_task", (PyCFunction)TaskObj_current_task,
+     METH_VARARGS | METH_KEYWORDS | METH_CLASS, task_current_task_doc},
+    {"all_tasks", (PyCFunction)TaskObj_all_tasks,
+     METH_VARARGS | METH_KEYWORDS | METH_CLASS, task_all_tasks_doc},
+    {"cancel", (PyCFunction)TaskObj_cancel, METH_NOARGS, task_cancel_doc},
+    {"get_stack", (PyCFunction)TaskObj_get_stack,
+     METH_VARARGS | METH_KEYWORDS, task_get_stack_doc},
+    {"print_stack", (PyCFunction)TaskObj_print_stack,
+     METH_VARARGS | METH_KEYWORDS, task_print_stack_doc},
+    {"_step", (PyCFunction)TaskObj_step, METH_VARARGS | METH_KEYWORDS,
+     task_step_doc},
+    {"_wakeup", (PyCFunction)TaskObj_wakeup, METH_O, NULL},
+    {"_repr_info", (PyCFunction)TaskObj_repr_info, METH_NOARGS, NULL},
+    {NULL, NULL}        /* Sentinel */
+};
+
+static PyGetSetDef TaskType_getsetlist[] = {
+    {"_log_destroy_pending", (getter)TaskObj_get_log_destroy_pending,
+                             (setter)TaskObj_set_log_destroy_pending, NULL},
+    {"_must_cancel", (getter)TaskObj_get_must_cancel, NULL, NULL},
+    {"_coro", (getter)TaskObj_get_coro, NULL, NULL},
+    {"_fut_waiter", (getter)TaskObj_get_fut_waiter, NULL, NULL},
+    {NULL}              /* Sentinel */
+};
+
+PyDoc_STRVAR(task_doc,
+"Task(coro, *, loop=None)\n\
+--\n\
+\n\
+A coroutine wrapped in a Future.");
+
+static PyTypeObject TaskType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_asyncio.Task",                            /* tp_name */
+    sizeof(TaskObj),                            /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor)TaskObj_dealloc,                /* tp_dealloc */
+    0,                                          /* tp_print */
+    0,                                          /* tp_getattr */
+    0,                                          /* tp_setattr */
+    0,                                          /* tp_reserved */
+    (reprfunc)FutureObj_repr,                   /* tp_repr */
+    0,                                          /* tp_as_number */
+    0,                                          /* tp_as_sequence */
+    0,                                          /* tp_as_mapping */
+    0,                                          /* tp_hash */
+    0,                                          /* tp_call */
+    0,                                          /* tp_str */
+    PyObject_GenericGetAttr,                    /* tp_getattro */
+    0,                                          /* tp_setattro */
+    0,                                          /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_BASETYPE
+        | Py_TPFLAGS_HAVE_FINALIZE,             /* tp_flags */
+    task_doc,                                   /* tp_doc */
+    (traverseproc)TaskObj_traverse,             /* tp_traverse */
+    (inquiry)TaskObj_clear,                     /* tp_clear */
+    0,                                          /* tp_richcompare */
+    0,                                          /* tp_weaklistoffset */
+    (getiterfunc)future_new_iter,               /* tp_iter */
+    0,                                          /* tp_iternext */
+    TaskType_methods,                           /* tp_methods */
+    0,                                          /* tp_members */
+    TaskType_getsetlist,                        /* tp_getset */
+    &FutureType,                                /* tp_base */
+    0,                                          /* tp_dict */
+    0,                                          /* tp_descr_get */
+    0,                                          /* tp_descr_set */
+    0,                                          /* tp_dictoffset */
+    (initproc)TaskObj_init,                     /* tp_init */
+    PyType_GenericAlloc,                        /* tp_alloc */
+    PyType_GenericNew,                          /* tp_new */
+    PyObject_GC_Del,                            /* tp_free */
+    0,                                          /* tp_is_gc */
+    0,                                          /* tp_bases */
+    0,                                          /* tp_mro */
+    0,                                          /* tp_cache */
+    0,                                          /* tp_subclasses */
+    0,                                          /* tp_weaklist */
+    0,                                          /* tp_del */
+    0,                                          /* tp_version_tag */
+    (destructor)TaskObj_finalize,               /* tp_finalize */
+};
+
+
+/*********************** Handle **************************/
+
+/* Handle and TimerHandle mirror the classes of Lib/asyncio/events.py.
+   Every callback run by the event loop goes through a Handle, so creating
+   and running them is on the hot path of any busy loop: exact Handles are
+   recycled through a free list and the TimerHandle comparisons used by the
+   heap of scheduled callbacks have a fast path for float deadlines. */
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *h_callback;
+    PyObject *h_args;
+    PyObject *h_loop;
+    PyObject *h_source_tb;
+    PyObject *h_repr;
+    int h_cancelled;
+    PyObject *h_weakreflist;
+} HandleObj;
+
+typedef struct {
+    HandleObj th_handle;
+    PyObject *th_when;
+    int th_scheduled;
+} TimerHandleObj;
+
+static PyTypeObject HandleType;
+static PyTypeObject TimerHandleType;
+
+#define Handle_Check(obj) PyObject_TypeCheck(obj, &HandleType)
+#define TimerHandle_Check(obj) PyObject_TypeCheck(obj, &TimerHandleType)
+
+/* Attributes cleared by cancel() read as None, as in Python */
+#define OR_NONE(obj) ((obj) != NULL ? (obj) : Py_None)
+
+#define H_FREELIST_MAXLEN 255
+static HandleObj *h_freelist = NULL;
+static Py_ssize_t h_freelist_len = 0;
+
+static int
+handle_init(HandleObj *h, PyObject *callback, PyObject *args,
+            PyObject *loop)
+{
+    PyObject *res, *tmp;
+    int is_true;
+
+    if (Handle_Check(callback)) {
+        PyErr_SetString(PyExc_AssertionError, "A Handle is not a callback");
+        return -1;
+    }
+
+#define SET_FIELD(FIELD, VALUE)                 \
+    tmp = (FIELD);                              \
+    Py_INCREF(VALUE);                           \
+    (FIELD) = (VALUE);                          \
+    Py_XDECREF(tmp);
+
+    SET_FIELD(h->h_loop, loop)
+    SET_FIELD(h->h_callback, callback)
+    SET_FIELD(h->h_args, args)
+#undef SET_FIELD
+    Py_CLEAR(h->h_repr);
+    Py_CLEAR(h->h_source_tb);
+    h->h_cancelled = 0;
+
+    res = _PyObject_CallMethodId(loop, &PyId_get_debug, NULL);
+    if (res == NULL) {
+        return -1;
+    }
+    is_true = PyObject_IsTrue(res);
+    Py_DECREF(res);
+    if (is_true < 0) {
+        return -1;
+    }
+    if (is_true) {
+        if (module_init() < 0) {
+            return -1;
+        }
+        /* Called from C, extract_stack() starts at the frame which
+           created the handle. */
+        h->h_source_tb = PyObject_CallObject(traceback_extract_stack, NULL);
+        if (h->h_source_tb == NULL) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static PyObject *
+handle_repr_info(PyObject *self, PyObject *func)
+{
+    if (module_init() < 0) {
+        return NULL;
+    }
+    return PyObject_CallFunctionObjArgs(func, self, NULL);
+}
+
+static PyObject *
+HandleObj_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    HandleObj *h;
+
+    if (type != &HandleType || h_freelist == NULL) {
+        return type->tp_alloc(type, 0);
+    }
+    h_freelist_len--;
+    h = h_freelist;
+    h_freelist = (HandleObj *)h->h_callback;
+    h->h_callback = NULL;
+    _Py_NewReference((PyObject *)h);
+    PyObject_GC_Track(h);
+    return (PyObject *)h;
+}
+
+static int
+HandleObj_init(HandleObj *h, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"callback", "args", "loop", NULL};
+    PyObject *callback, *cb_args, *loop;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOO:Handle", kwlist,
+                                     &callback, &cb_args, &loop)) {
+        return -1;
+    }
+    return handle_init(h, callback, cb_args, loop);
+}
+
+static int
+HandleObj_clear(HandleObj *h)
+{
+    Py_CLEAR(h->h_callback);
+    Py_CLEAR(h->h_args);
+    Py_CLEAR(h->h_loop);
+    Py_CLEAR(h->h_source_tb);
+    Py_CLEAR(h->h_repr);
+    return 0;
+}
+
+static int
+HandleObj_traverse(HandleObj *h, visitproc visit, void *arg)
+{
+    Py_VISIT(h->h_callback);
+    Py_VISIT(h->h_args);
+    Py_VISIT(h->h_loop);
+    Py_VISIT(h->h_source_tb);
+    return 0;
+}
+
+static void
+HandleObj_dealloc(HandleObj *h)
+{
+    PyObject_GC_UnTrack(h);
+    if (h->h_weakreflist != NULL) {
+        PyObject_ClearWeakRefs((PyObject *)h);
+    }
+    (void)HandleObj_clear(h);
+
+    if (Py_TYPE(h) == &HandleType && h_freelist_len < H_FREELIST_MAXLEN) {
+        h_freelist_len++;
+        h->h_callback = (PyObject *)h_freelist;
+        h_freelist = h;
+    }
+    else {
+        Py_TYPE(h)->tp_free(h);
+    }
+}
+
+static PyObject *
+HandleObj_repr(PyObject *self)
+{
+    HandleObj *h = (HandleObj *)self;
+    PyObject *info, *sep, *joined, *res;
+
+    if (h->h_repr != NULL && h->h_repr != Py_None) {
+        Py_INCREF(h->h_repr);
+        return h->h_repr;
+    }
+
+    info = _PyObject_CallMethodId(self, &PyId__repr_info, NULL);
+    if (info == NULL) {
+        return NULL;
+    }
+    sep = PyUnicode_FromString(" ");
+    if (sep == NULL) {
+        Py_DECREF(info);
+        return NULL;
+    }
+    joined = PyUnicode_Join(sep, info);
+    Py_DECREF(sep);
+    Py_DECREF(info);
+    if (joined == NULL) {
+        return NULL;
+    }
+    res = PyUnicode_FromFormat("<%U>", joined);
+    Py_DECREF(joined);
+    return res;
+}
+
+static PyObject *
+HandleObj_repr_info(PyObject *self, PyObject *unused)
+{
+    return handle_repr_info(self, asyncio_handle_repr_info_func);
+}
+
+PyDoc_STRVAR(handle_cancel_doc,
+"cancel() -> None\n\
+\n\
+Cancel the callback.  Does nothing if it was already cancelled.");
+
+static PyObject *
+HandleObj_cancel(HandleObj *h, PyObject *unused)
+{
+    PyObject *res;
+    int is_true;
+
+    if (h->h_cancelled) {
+        Py_RETURN_NONE;
+    }
+    h->h_cancelled = 1;
+
+    if (h->h_loop != NULL) {
+        res = _PyObject_CallMethodId(h->h_loop, &PyId_get_debug, NULL);
+        if (res == NULL) {
+            return NULL;
+        }
+        is_true = PyObject_IsTrue(res);
+        Py_DECREF(res);
+        if (is_true < 0) {
+            return NULL;
+        }
+        if (is_true) {
+            /* Keep a representation in debug mode to keep callback and
+               parameters. For example, to log the warning
+               "Executing <Handle...> took 2.5 second" */
+            res = PyObject_Repr((PyObject *)h);
+            if (res == NULL) {
+                return NULL;
+            }
+            Py_XDECREF(h->h_repr);
+            h->h_repr = res;
+        }
+    }
+    Py_CLEAR(h->h_callback);
+    Py_CLEAR(h->h_args);
+    Py_RETURN_NONE;
+}
+
+/* Report an exception raised by the callback to the loop's exception
+   handler, as Handle._run() does in Python.  The exception is fetched
+   from the error indicator. */
+static PyObject *
+handle_report_exception(HandleObj *h, PyObject *callback, PyObject *args)
+{
+    PyObject *et, *ev, *tb;
+    PyObject *cb_repr = NULL, *message = NULL, *context = NULL;
+    PyObject *res = NULL;
+
+    PyErr_Fetch(&et, &ev, &tb);
+    PyErr_NormalizeException(&et, &ev, &tb);
+    if (tb != NULL) {
+        PyException_SetTraceback(ev, tb);
+    }
+
+    if (module_init() < 0) {
+        goto finally;
+    }
+    cb_repr = PyObject_CallFunctionObjArgs(asyncio_format_callback_func,
+                                           callback, args, NULL);
+    if (cb_repr == NULL) {
+        goto finally;
+    }
+    message = PyUnicode_FromFormat("Exception in callback %S", cb_repr);
+    if (message == NULL) {
+        goto finally;
+    }
+    context = PyDict_New();
+    if (context == NULL) {
+        goto finally;
+    }
+    if (PyDict_SetItemString(context, "message", message) < 0 ||
+        PyDict_SetItemString(context, "exception", ev) < 0 ||
+        PyDict_SetItemString(context, "handle", (PyObject *)h) < 0) {
+        goto finally;
+    }
+    if (h->h_source_tb != NULL && PyObject_IsTrue(h->h_source_tb) &&
+        PyDict_SetItemString(context, "source_traceback",
+                             h->h_source_tb) < 0) {
+        goto finally;
+    }
+    res = _PyObject_CallMethodIdObjArgs(OR_NONE(h->h_loop),
+                                        &PyId_call_exception_handler,
+                                        context, NULL);
+
+finally:
+    Py_XDECREF(et);
+    Py_XDECREF(ev);
+    Py_XDECREF(tb);
+    Py_XDECREF(cb_repr);
+    Py_XDECREF(message);
+    Py_XDECREF(context);
+    return res;
+}
+
+static PyObject *
+HandleObj_run(HandleObj *h, PyObject *unused)
+{
+    PyObject *callback, *args, *call_args, *res;
+
+    /* The callback may cancel its own handle: keep references to the
+       callback and its arguments during the call. */
+    callback = OR_NONE(h->h_callback);
+    args = OR_NONE(h->h_args);
+    Py_INCREF(callback);
+    Py_INCREF(args);
+
+    if (PyTuple_CheckExact(args)) {
+        Py_INCREF(args);
+        call_args = args;
+    }
+    else {
+        call_args = PySequence_Tuple(args);
+    }
+    if (call_args != NULL) {
+        res = PyObject_Call(callback, call_args, NULL);
+        Py_DECREF(call_args);
+    }
+    else {
+        res = NULL;
+    }
+
+    if (res == NULL && PyErr_ExceptionMatches(PyExc_Exception)) {
+        res = handle_report_exception(h, callback, args);
+    }
+    Py_DECREF(callback);
+    Py_DECREF(args);
+    if (res == NULL) {
+        return NULL;
+    }
+    Py_DECREF(res);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+HandleObj_get_cancelled(HandleObj *h)
+{
+    return PyBool_FromLong(h->h_cancelled);
+}
+
+static int
+HandleObj_set_cancelled(HandleObj *h, PyObject *val)
+{
+    int is_true;
+
+    if (val == NULL) {
+        PyErr_SetString(PyExc_AttributeError, "cannot delete attribute");
+        return -1;
+    }
+    is_true = PyObject_IsTrue(val);
+    if (is_true < 0) {
+        return -1;
+    }
+    h->h_cancelled = is_true;
+    return 0;
+}
+
+static PyMethodDef HandleType_methods[] = {
+    {"cancel", (PyCFunction)HandleObj_cancel, METH_NOARGS,
+     handle_cancel_doc},
+    {"_run", (PyCFunction)HandleObj_run, METH_NOARGS, NULL},
+    {"_repr_info", (PyCFunction)HandleObj_repr_info, METH_NOARGS, NULL},
+    {NULL, NULL}        /* Sentinel */
+};
+
+static PyMemberDef HandleType_members[] = {
+    {"_callback", T_OBJECT, offsetof(HandleObj, h_callback), 0, NULL},
+    {"_args", T_OBJECT, offsetof(HandleObj, h_args), 0, NULL},
+    {"_loop", T_OBJECT, offsetof(HandleObj, h_loop), 0, NULL},
+    {"_source_traceback", T_OBJECT, offsetof(HandleObj, h_source_tb), 0,
+     NULL},
+    {"_repr", T_OBJECT, offsetof(HandleObj, h_repr), 0, NULL},
+    {NULL}              /* Sentinel */
+};
+
+static PyGetSetDef HandleType_getsetlist[] = {
+    {"_cancelled", (getter)HandleObj_get_cancelled,
+                   (setter)HandleObj_set_cancelled, NULL},
+    {NULL}              /* Sentinel */
+};
+
+PyDoc_STRVAR(handle_doc,
+"Handle(callback, args, loop)\n\
+--\n\
+\n\
+Object returned by callback registration methods.");
+
+static PyTypeObject HandleType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_asyncio.Handle",                          /* tp_name */
+    sizeof(HandleObj),                          /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor)HandleObj_dealloc,              /* tp_dealloc */
+    0,                                          /* tp_print */
+    0,                                          /* tp_getattr */
+    0,                                          /* tp_setattr */
+    0,                                          /* tp_reserved */
+    (reprfunc)HandleObj_repr,                   /* tp_repr */
+    0,                                          /* tp_as_number */
+    0,                                          /* tp_as_sequence */
+    0,                                          /* tp_as_mapping */
+    0,                                          /* tp_hash */
+    0,                                          /* tp_call */
+    0,                                          /* tp_str */
+    PyObject_GenericGetAttr,                    /* tp_getattro */
+    0,                                          /* tp_setattro */
+    0,                                          /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC
+        | Py_TPFLAGS_BASETYPE,                  /* tp_flags */
+    handle_doc,                                 /* tp_doc */
+    (traverseproc)HandleObj_traverse,           /* tp_traverse */
+    (inquiry)HandleObj_clear,                   /* tp_clear */
+    0,                                          /* tp_richcompare */
+    offsetof(HandleObj, h_weakreflist),         /* tp_weaklistoffset */
+    0,                                          /* tp_iter */
+    0,                                          /* tp_iternext */
+    HandleType_methods,                         /* tp_methods */
+    HandleType_members,                         /* tp_members */
+    HandleType_getsetlist,                      /* tp_getset */
+    0,                                          /* tp_base */
+    0,                                          /* tp_dict */
+    0,                                          /* tp_descr_get */
+    0,                                          /* tp_descr_set */
+    0,                                          /* tp_dictoffset */
+    (initproc)HandleObj_init,                   /* tp_init */
+    PyType_GenericAlloc,                        /* tp_alloc */
+    HandleObj_new,                              /* tp_new */
+    PyObject_GC_Del,                            /* tp_free */
+};
+
+
+/*********************** TimerHandle **************************/
+
+static int
+TimerHandleObj_init(TimerHandleObj *th, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"when", "callback", "args", "loop", NULL};
+    PyObject *when, *callback, *cb_args, *loop, *tmp;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOOO:TimerHandle", kwlist,
+                                     &when, &callback, &cb_args, &loop)) {
+        return -1;
+    }
+    if (when == Py_None) {
+        PyErr_SetNone(PyExc_AssertionError);
+        return -1;
+    }
+    if (handle_init((HandleObj *)th, callback, cb_args, loop) < 0) {
+        return -1;
+    }
+    tmp = th->th_when;
+    Py_INCREF(when);
+    th->th_when = when;
+    Py_XDECREF(tmp);
+    th->th_scheduled = 0;
+    return 0;
+}
+
+static int
+TimerHandleObj_clear(TimerHandleObj *th)
+{
+    Py_CLEAR(th->th_when);
+    return HandleObj_clear((HandleObj *)th);
+}
+
+static int
+TimerHandleObj_traverse(TimerHandleObj *th, visitproc visit, void *arg)
+{
+    Py_VISIT(th->th_when);
+    return HandleObj_traverse((HandleObj *)th, visit, arg);
+}
+
+static void
+TimerHandleObj_dealloc(TimerHandleObj *th)
+{
+    PyObject_GC_UnTrack(th);
+    Py_CLEAR(th->th_when);
+    HandleObj_dealloc((HandleObj *)th);
+}
+
+/* Compare the deadlines of two timers with op (Py_LT or Py_GT).  This is
+   what heapq calls when the loop schedules a callback. */
+static PyObject *
+timer_handle_compare_when(TimerHandleObj *self, PyObject *other, int op)
+{
+    PyObject *when = OR_NONE(self->th_when);
+    PyObject *other_when, *res;
+
+    if (TimerHandle_Check(other)) {
+        other_when = OR_NONE(((TimerHandleObj *)other)->th_when);
+        if (PyFloat_CheckExact(when) && PyFloat_CheckExact(other_when)) {
+            double a = PyFloat_AS_DOUBLE(when);
+            double b = PyFloat_AS_DOUBLE(other_when);
+            return PyBool_FromLong(op == Py_LT ? a < b : a > b);
+        }
+        Py_INCREF(other_when);
+    }
+    else {
+        other_when = _PyObject_GetAttrId(other, &PyId__when);
+        if (other_when == NULL) {
+            return NULL;
+        }
+    }
+    res = PyObject_RichCompare(when, other_when, op);
+    Py_DECREF(other_when);
+    return res;
+}
+
+/* Return 1 if both timers are equal, 0 if not, -1 on error */
+static int
+timer_handle_eq(TimerHandleObj *self, TimerHandleObj *other)
+{
+    HandleObj *a = (HandleObj *)self, *b = (HandleObj *)other;
+    int r;
+
+    r = PyObject_RichCompareBool(OR_NONE(self->th_when),
+                                 OR_NONE(other->th_when), Py_EQ);
+    if (r <= 0) {
+        return r;
+    }
+    r = PyObject_RichCompareBool(OR_NONE(a->h_callback),
+                                 OR_NONE(b->h_callback), Py_EQ);
+    if (r <= 0) {
+        return r;
+    }
+    r = PyObject_RichCompareBool(OR_NONE(a->h_args), OR_NONE(b->h_args),
+                                 Py_EQ);
+    if (r <= 0) {
+        return r;
+    }
+    return a->h_cancelled == b->h_cancelled;
+}
+
+static PyObject *
+TimerHandleObj_richcompare(TimerHandleObj *self, PyObject *other, int op)
+{
+    PyObject *res;
+    int r;
+
+    if (op == Py_LT || op == Py_GT) {
+        return timer_handle_compare_when(self, other, op);
+    }
+
+    if (op == Py_LE || op == Py_GE) {
+        res = timer_handle_compare_when(self, other,
+                                        op == Py_LE ? Py_LT : Py_GT);
+        if (res == NULL) {
+            return NULL;
+        }
+        r = PyObject_IsTrue(res);
+        if (r > 0) {
+            return res;
+        }
+        Py_DECREF(res);
+        if (r < 0) {
+            return NULL;
+        }
+        op = Py_EQ;
+    }
+
+    if (!TimerHandle_Check(other)) {
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+    r = timer_handle_eq(self, (TimerHandleObj *)other);
+    if (r < 0) {
+        return NULL;
+    }
+    return PyBool_FromLong(op == Py_NE ? !r : r);
+}
+
+static Py_hash_t
+TimerHandleObj_hash(TimerHandleObj *th)
+{
+    return PyObject_Hash(OR_NONE(th->th_when));
+}
+
+static PyObject *
+TimerHandleObj_repr_info(PyObject *self, PyObject *unused)
+{
+    return handle_repr_info(self, asyncio_timer_handle_repr_info_func);
+}
+
+static PyObject *
+TimerHandleObj_cancel(TimerHandleObj *th, PyObject *unused)
+{
+    HandleObj *h = (HandleObj *)th;
+
+    if (!h->h_cancelled && h->h_loop != NULL) {
+        PyObject *res;
+
+        res = _PyObject_CallMethodIdObjArgs(h->h_loop,
+                                            &PyId__timer_handle_cancelled,
+                                            th, NULL);
+        if (res == NULL) {
+            return NULL;
+        }
+        Py_DECREF(res);
+    }
+    return HandleObj_cancel(h, NULL);
+}
+
+static PyObject *
+TimerHandleObj_get_scheduled(TimerHandleObj *th)
+{
+    return PyBool_FromLong(th->th_scheduled);
+}
+
+static int
+TimerHandleObj_set_scheduled(TimerHandleObj *th, PyObject *val)
+{
+    int is_true;
+
+    if (val == NULL) {
+        PyErr_SetString(PyExc_AttributeError, "cannot delete attribute");
+        return -1;
+    }
+    is_true = PyObject_IsTrue(val);
+    if (is_true < 0) {
+        return -1;
+    }
+    th->th_scheduled = is_true;
+    return 0;
+}
+
+static PyMethodDef TimerHandleType_methods[] = {
+    {"cancel", (PyCFunction)TimerHandleObj_cancel, METH_NOARGS,
+     handle_cancel_doc},
+    {"_repr_info", (PyCFunction)TimerHandleObj_repr_info, METH_NOARGS,
+     NULL},
+    {NULL, NULL}        /* Sentinel */
+};
+
+static PyMemberDef TimerHandleType_members[] = {
+    {"_when", T_OBJECT, offsetof(TimerHandleObj, th_when), 0, NULL},
+    {NULL}              /* Sentinel */
+};
+
+static PyGetSetDef TimerHandleType_getsetlist[] = {
+    {"_scheduled", (getter)TimerHandleObj_get_scheduled,
+                   (setter)TimerHandleObj_set_scheduled, NULL},
+    {NULL}              /* Sentinel */
+};
+
+PyDoc_STRVAR(timer_handle_doc,
+"TimerHandle(when, callback, args, loop)\n\
+--\n\
+\n\
+Object returned by timed callback registration methods.");
+
+static PyTypeObject TimerHandleType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_asyncio.TimerHandle",                     /* tp_name */
+    sizeof(TimerHandleObj),                     /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor)TimerHandleObj_dealloc,         /* tp_dealloc */
+    0,                                          /* tp_print */
+    0,                                          /* tp_getattr */
+    0,                                          /* tp_setattr */
+    0,                                          /* tp_reserved */
+    (reprfunc)HandleObj_repr,                   /* tp_repr */
+    0,                                          /* tp_as_number */
+    0,                                          /* tp_as_sequence */
+    0,                                          /* tp_as_mapping */
+    (hashfunc)TimerHandleObj_hash,              /* tp_hash */
+    0,                                          /* tp_call */
+    0,                                          /* tp_str */
+    PyObject_GenericGetAttr,                    /* tp_getattro */
+    0,                                          /* tp_setattro */
+    0,                                          /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC
+        | Py_TPFLAGS_BASETYPE,                  /* tp_flags */
+    timer_handle_doc,                           /* tp_doc */
+    (traverseproc)TimerHandleObj_traverse,      /* tp_traverse */
+    (inquiry)TimerHandleObj_clear,              /* tp_clear */
+    (richcmpfunc)TimerHandleObj_richcompare,    /* tp_richcompare */
+    0,                                          /* tp_weaklistoffset */
+    0,                                          /* tp_iter */
+    0,                                          /* tp_iternext */
+    TimerHandleType_methods,                    /* tp_methods */
+    TimerHandleType_members,                    /* tp_members */
+    TimerHandleType_getsetlist,                 /* tp_getset */
+    &HandleType,                                /* tp_base */
+    0,                                          /* tp_dict */
+    0,                                          /* tp_descr_get */
+    0,                                          /* tp_descr_set */
+    0,                                          /* tp_dictoffset */
+    (initproc)TimerHandleObj_init,              /* tp_init */
+    PyType_GenericAlloc,                        /* tp_alloc */
+    PyType_GenericNew,                          /* tp_new */
+    PyObject_GC_Del,                            /* tp_free */
+};
+
+
+/*********************** Module **************************/
+
+static void
+module_free(void *m)
+{
+    Py_CLEAR(traceback_extract_stack);
+    Py_CLEAR(asyncio_get_event_loop);
+    Py_CLEAR(asyncio_future_repr_info_func);
+    Py_CLEAR(asyncio_task_repr_info_func);
+    Py_CLEAR(asyncio_task_get_stack_func);
+    Py_CLEAR(asyncio_task_print_stack_func);
+    Py_CLEAR(asyncio_iscoroutine_func);
+    Py_CLEAR(asyncio_InvalidStateError);
+    Py_CLEAR(asyncio_CancelledError);
+    Py_CLEAR(asyncio_format_callback_func);
+    Py_CLEAR(asyncio_handle_repr_info_func);
+    Py_CLEAR(asyncio_timer_handle_repr_info_func);
+    Py_CLEAR(current_tasks);
+    Py_CLEAR(all_tasks);
+    module_initialized = 0;
+
+    while (fi_freelist != NULL) {
+        futureiterobject *it = fi_freelist;
+        fi_freelist = (futureiterobject *)it->future;
+        PyObject_GC_Del(it);
+    }
+    fi_freelist_len = 0;
+
+    while (h_freelist != NULL) {
+        HandleObj *h = h_freelist;
+        h_freelist = (HandleObj *)h->h_callback;
+        PyObject_GC_Del(h);
+    }
+    h_freelist_len = 0;
+}
+
+PyDoc_STRVAR(module_doc, "Accelerator module for asyncio");
+
+static struct PyModuleDef _asynciomodule = {
+    PyModuleDef_HEAD_INIT,      /* m_base */
+    "_asyncio",                 /* m_name */
+    module_doc,                 /* m_doc */
+    -1,                         /* m_size */
+    NULL,                       /* m_methods */
+    NULL,                       /* m_reload */
+    NULL,                       /* m_traverse */
+    NULL,                       /* m_clear */
+    (freefunc)module_free       /* m_free */
+};
+
+
+PyMODINIT_FUNC
+PyInit__asyncio(void)
+{
+    PyObject *m, *weakref;
+
+    if (PyType_Ready(&FutureType) < 0) {
+        return NULL;
+    }
+    if (PyType_Ready(&FutureIterType) < 0) {
+        return NULL;
+    }
+    if (PyType_Ready(&TaskType) < 0) {
+        return NULL;
+    }
+    if (PyType_Ready(&HandleType) < 0) {
+        return NULL;
+    }
+    if (PyType_Ready(&TimerHandleType) < 0) {
+        return NULL;
+    }
+
+    if (current_tasks == NULL) {
+        current_tasks = PyDict_New();
+        if (current_tasks == NULL) {
+            return NULL;
+        }
+    }
+    if (all_tasks == NULL) {
+        weakref = PyImport_ImportModule("weakref");
+        if (weakref == NULL) {
+            return NULL;
+        }
+        all_tasks = _PyObject_CallMethodId(weakref, &PyId_WeakSet, NULL);
+        Py_DECREF(weakref);
+        if (all_tasks == NULL) {
+            return NULL;
+        }
+    }
+
+    /* Weak set containing all tasks alive and dictionary containing the
+       tasks currently active in all running event loops, as in the
+       Python implementation. */
+    if (PyDict_SetItemString(TaskType.tp_dict, "_all_tasks",
+                             all_tasks) < 0 ||
+        PyDict_SetItemString(TaskType.tp_dict, "_current_tasks",
+                             current_tasks) < 0) {
+        return NULL;
+    }
+
+    m = PyModule_Create(&_asynciomodule);
+    if (m == NULL) {
+        return NULL;
+    }
+
+    Py_INCREF(&FutureType);
+    if (PyModule_AddObject(m, "Future", (PyObject *)&FutureType) < 0) {
+        Py_DECREF(&FutureType);
+        Py_DECREF(m);
+        return NULL;
+    }
+
+    Py_INCREF(&TaskType);
+    if (PyModule_AddObject(m, "Task", (PyObject *)&TaskType) < 0) {
+        Py_DECREF(&TaskType);
+        Py_DECREF(m);
+        return NULL;
+    }
+
+    Py_INCREF(&HandleType);
+    if (PyModule_AddObject(m, "Handle", (PyObject *)&HandleType) < 0) {
+        Py_DECREF(&HandleType);
+        Py_DECREF(m);
+        return NULL;
+    }
+
+    Py_INCREF(&TimerHandleType);
+    if (PyModule_AddObject(m, "TimerHandle",
+                           (PyObject *)&TimerHandleType) < 0) {
+        Py_DECREF(&TimerHandleType);
+        Py_DECREF(m);
+        return NULL;
+    }
+
+    return m;
+}
@@ -51,6 +51,7 @@ typedef struct {
     bz_stream bzs;
     char eof;           /* T_BOOL expects a char */
     PyObject *unused_data;
+    PyObject *unconsumed_tail;
 #ifdef WITH_THREAD
     PyThread_type_lock lock;
 #endif
@@ -467,6 +468,61 @@ error:
     return NULL;
 }
 
+/* Decompress data into the caller's buffer, keeping the input which did not
+   fit in d->unconsumed_tail.  Returns the number of bytes written. */
+static PyObject *
+decompress_into(BZ2Decompressor *d, char *data, size_t len, Py_buffer *buffer)
+{
+    size_t out_len = (size_t)buffer->len;
+    PyObject *tail;
+
+    d->bzs.next_in = data;
+    d->bzs.avail_in = (unsigned int)Py_MIN(len, UINT_MAX);
+    len -= d->bzs.avail_in;
+    d->bzs.next_out = buffer->buf;
+    d->bzs.avail_out = (unsigned int)Py_MIN(out_len, UINT_MAX);
+    out_len -= d->bzs.avail_out;
+    while (d->bzs.avail_out > 0) {
+        int bzerror;
+
+        Py_BEGIN_ALLOW_THREADS
+        bzerror = BZ2_bzDecompress(&d->bzs);
+        Py_END_ALLOW_THREADS
+        if (catch_bz2_error(bzerror))
+            return NULL;
+        if (bzerror == BZ_STREAM_END) {
+            d->eof = 1;
+            len += d->bzs.avail_in;
+            d->bzs.avail_in = 0;
+            if (len > 0) { /* Save leftover input to unused_data */
+                Py_CLEAR(d->unused_data);
+                d->unused_data = PyBytes_FromStringAndSize(d->bzs.next_in, len);
+                if (d->unused_data == NULL)
+                    return NULL;
+                len = 0;
+            }
+            break;
+        }
+        if (d->bzs.avail_in == 0) {
+            if (len == 0)
+                break;
+            d->bzs.avail_in = (unsigned int)Py_MIN(len, UINT_MAX);
+            len -= d->bzs.avail_in;
+        }
+        if (d->bzs.avail_out == 0) {
+            d->bzs.avail_out = (unsigned int)Py_MIN(out_len, UINT_MAX);
+            out_len -= d->bzs.avail_out;
+        }
+    }
+    /* Save the input left over once the buffer is full */
+    tail = PyBytes_FromStringAndSize(d->bzs.next_in, len + d->bzs.avail_in);
+    if (tail == NULL)
+        return NULL;
+    Py_DECREF(d->unconsumed_tail);
+    d->unconsumed_tail = tail;
+    return PyLong_FromSsize_t(d->bzs.next_out - (char *)buffer->buf);
+}
+
 /*[clinic input]
 _bz2.BZ2Decompressor.decompress
 
@@ -497,6 +553,37 @@ _bz2_BZ2Decompressor_decompress_impl(BZ2Decompressor *self, Py_buffer *data)
     return result;
 }
 
+/*[clinic input]
+_bz2.BZ2Decompressor.decompress_into
+
+    data: Py_buffer
+    buffer: Py_buffer(types='bytearray rwbuffer')
+    /
+
+Decompress data into buffer and return the number of bytes written.
+
+No bytes object is created for the output.  Once buffer is full, the input
+data left over is saved in the unconsumed_tail attribute and must be passed
+again to a later call.  More output may be pending even when unconsumed_tail
+is empty, so call this method again with b'' until it does not fill buffer
+or the end of stream is reached.
+[clinic start generated code]*/
+
+static PyObject *
+_bz2_BZ2Decompressor_decompress_into_impl(BZ2Decompressor *self, Py_buffer *data, Py_buffer *buffer)
+/*[clinic end generated code: output=14e2ad052eb7babb input=e805214f662a3076]*/
+{
+    PyObject *result = NULL;
+
+    ACQUIRE_LOCK(self);
+    if (self->eof)
+        PyErr_SetString(PyExc_EOFError, "End of stream already reached");
+    else
+        result = decompress_into(self, data->buf, data->len, buffer);
+    RELEASE_LOCK(self);
+    return result;
+}
+
 static PyObject *
 BZ2Decompressor_getstate(BZ2Decompressor *self, PyObject *noargs)
 {
@@ -530,6 +617,9 @@ _bz2_BZ2Decompressor___init___impl(BZ2Decompressor *self)
     self->unused_data = PyBytes_FromStringAndSize("", 0);
     if (self->unused_data == NULL)
         goto error;
+    self->unconsumed_tail = PyBytes_FromStringAndSize("", 0);
+    if (self->unconsumed_tail == NULL)
+        goto error;
 
     bzerror = BZ2_bzDecompressInit(&self->bzs, 0, 0);
     if (catch_bz2_error(bzerror))
@@ -539,6 +629,7 @@ _bz2_BZ2Decompressor___init___impl(BZ2Decompressor *self)
 
 error:
     Py_CLEAR(self->unused_data);
+    Py_CLEAR(self->unconsumed_tail);
 #ifdef WITH_THREAD
     PyThread_free_lock(self->lock);
     self->lock = NULL;
@@ -551,6 +642,7 @@ BZ2Decompressor_dealloc(BZ2Decompressor *self)
 {
     BZ2_bzDecompressEnd(&self->bzs);
     Py_CLEAR(self->unused_data);
+    Py_CLEAR(self->unconsumed_tail);
 #ifdef WITH_THREAD
     if (self->lock != NULL)
         PyThread_free_lock(self->lock);
@@ -560,6 +652,7 @@ BZ2Decompressor_dealloc(BZ2Decompressor *self)
 
 static PyMethodDef BZ2Decompressor_methods[] = {
     _BZ2_BZ2DECOMPRESSOR_DECOMPRESS_METHODDEF
+    _BZ2_BZ2DECOMPRESSOR_DECOMPRESS_INTO_METHODDEF
     {"__getstate__", (PyCFunction)BZ2Decompressor_getstate, METH_NOARGS},
     {NULL}
 };
@@ -570,11 +663,17 @@ PyDoc_STRVAR(BZ2Decompressor_eof__doc__,
 PyDoc_STRVAR(BZ2Decompressor_unused_data__doc__,
 "Data found after the end of the compressed stream.");
 
+PyDoc_STRVAR(BZ2Decompressor_unconsumed_tail__doc__,
+"Data left over by the last decompress_into() call, which filled its buffer.");
+
 static PyMemberDef BZ2Decompressor_members[] = {
     {"eof", T_BOOL, offsetof(BZ2Decompressor, eof),
      READONLY, BZ2Decompressor_eof__doc__},
     {"unused_data", T_OBJECT_EX, offsetof(BZ2Decompressor, unused_data),
      READONLY, BZ2Decompressor_unused_data__doc__},
+    {"unconsumed_tail", T_OBJECT_EX,
+     offsetof(BZ2Decompressor, unconsumed_tail),
+     READONLY, BZ2Decompressor_unconsumed_tail__doc__},
     {NULL}
 };
 
@@ -1,6 +1,5 @@
 #include "Python.h"
 #include "structmember.h"
-#include "accu.h"
 
 #ifdef __GNUC__
 #define UNUSED __attribute__((__unused__))
@@ -51,6 +50,11 @@ typedef struct _PyEncoderObject {
     int allow_nan;
 } PyEncoderObject;
 
+/* Values of PyEncoderObject.fast_encode: strings are escaped in C when the
+   encoder is one of the _json functions instead of calling it. */
+#define FAST_ENCODE_ASCII 1
+#define FAST_ENCODE_UNICODE 2
+
 static PyMemberDef encoder_members[] = {
     {"markers", T_OBJECT, offsetof(PyEncoderObject, markers), READONLY, "markers"},
     {"default", T_OBJECT, offsetof(PyEncoderObject, defaultfn), READONLY, "default"},
@@ -76,12 +80,25 @@ join_list_unicode(PyObject *lst)
     return PyUnicode_Join(sep, lst);
 }
 
+/* The encoder writes the JSON document as UTF-8 directly into a bytes
+   object which is over-allocated as it grows.  For str output the buffer
+   is decoded once at the end, and lone surrogates are passed through; for
+   bytes output they are rejected as by str.encode('utf-8'). */
+typedef struct {
+    PyObject *buffer;
+    Py_ssize_t pos;
+    Py_ssize_t allocated;
+    int surrogatepass;
+} _JSONWriter;
+
 /* Forward decls */
 
 static PyObject *
 ascii_escape_unicode(PyObject *pystr);
 static PyObject *
 py_encode_basestring_ascii(PyObject* self UNUSED, PyObject *pystr);
+static PyObject *
+py_encode_basestring(PyObject* self UNUSED, PyObject *pystr);
 void init_json(void);
 static PyObject *
 scan_once_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx, Py_ssize_t *next_idx_ptr);
@@ -104,18 +121,16 @@ encoder_dealloc(PyObject *self);
 static int
 encoder_clear(PyObject *self);
 static int
-encoder_listencode_list(PyEncoderObject *s, _PyAccu *acc, PyObject *seq, Py_ssize_t indent_level);
+encoder_listencode_list(PyEncoderObject *s, _JSONWriter *writer, PyObject *seq, Py_ssize_t indent_level);
 static int
-encoder_listencode_obj(PyEncoderObject *s, _PyAccu *acc, PyObject *obj, Py_ssize_t indent_level);
+encoder_listencode_obj(PyEncoderObject *s, _JSONWriter *writer, PyObject *obj, Py_ssize_t indent_level);
 static int
-encoder_listencode_dict(PyEncoderObject *s, _PyAccu *acc, PyObject *dct, Py_ssize_t indent_level);
+encoder_listencode_dict(PyEncoderObject *s, _JSONWriter *writer, PyObject *dct, Py_ssize_t indent_level);
 static PyObject *
 _encoded_const(PyObject *obj);
 static void
 raise_errmsg(char *msg, PyObject *s, Py_ssize_t end);
 static PyObject *
-encoder_encode_string(PyEncoderObject *s, PyObject *obj);
-static PyObject *
 encoder_encode_long(PyEncoderObject* s UNUSED, PyObject *obj);
 static PyObject *
 encoder_encode_float(PyEncoderObject *s, PyObject *obj);
@@ -218,6 +233,215 @@ ascii_escape_unicode(PyObject *pystr)
     return rval;
 }
 
+static int
+json_writer_init(_JSONWriter *writer, int surrogatepass)
+{
+    writer->allocated = 512;
+    writer->buffer = PyBytes_FromStringAndSize(NULL, writer->allocated);
+    if (writer->buffer == NULL)
+        return -1;
+    writer->pos = 0;
+    writer->surrogatepass = surrogatepass;
+    return 0;
+}
+
+static void
+json_writer_dealloc(_JSONWriter *writer)
+{
+    Py_CLEAR(writer->buffer);
+}
+
+static char *
+json_writer_prepare(_JSONWriter *writer, Py_ssize_t size)
+{
+    /* Make room for size more bytes and return the current position */
+    if (size > writer->allocated - writer->pos) {
+        Py_ssize_t newsize;
+        if (size > PY_SSIZE_T_MAX - writer->pos) {
+            PyErr_NoMemory();
+            return NULL;
+        }
+        newsize = writer->pos + size;
+        /* Over-allocate by 50% to amortize the cost of resizing */
+        if (newsize <= PY_SSIZE_T_MAX - newsize / 2)
+            newsize += newsize / 2;
+        if (_PyBytes_Resize(&writer->buffer, newsize) < 0)
+            return NULL;
+        writer->allocated = newsize;
+    }
+    return PyBytes_AS_STRING(writer->buffer) + writer->pos;
+}
+
+static int
+json_writer_write(_JSONWriter *writer, const char *str, Py_ssize_t size)
+{
+    char *p = json_writer_prepare(writer, size);
+    if (p == NULL)
+        return -1;
+    memcpy(p, str, size);
+    writer->pos += size;
+    return 0;
+}
+
+static int
+json_writer_write_unicode(_JSONWriter *writer, PyObject *str)
+{
+    /* Write str encoded to UTF-8 */
+    char *utf8;
+    Py_ssize_t size;
+
+    if (PyUnicode_READY(str) == -1)
+        return -1;
+    if (PyUnicode_IS_ASCII(str))
+        return json_writer_write(writer, PyUnicode_DATA(str),
+                                 PyUnicode_GET_LENGTH(str));
+    utf8 = PyUnicode_AsUTF8AndSize(str, &size);
+    if (utf8 == NULL) {
+        PyObject *bytes;
+        int rval;
+        if (!writer->surrogatepass ||
+            !PyErr_ExceptionMatches(PyExc_UnicodeEncodeError))
+            return -1;
+        PyErr_Clear();
+        bytes = _PyUnicode_AsUTF8String(str, "surrogatepass");
+        if (bytes == NULL)
+            return -1;
+        rval = json_writer_write(writer, PyBytes_AS_STRING(bytes),
+                                 PyBytes_GET_SIZE(bytes));
+        Py_DECREF(bytes);
+        return rval;
+    }
+    return json_writer_write(writer, utf8, size);
+}
+
+static void
+raise_surrogate_error(PyObject *pystr, Py_ssize_t pos)
+{
+    PyObject *exc;
+    exc = PyObject_CallFunction(PyExc_UnicodeEncodeError, "sOnns", "utf-8",
+                                pystr, pos, pos + 1, "surrogates not allowed");
+    if (exc != NULL) {
+        PyErr_SetObject(PyExc_UnicodeEncodeError, exc);
+        Py_DECREF(exc);
+    }
+}
+
+static int
+json_writer_write_escaped(_JSONWriter *writer, PyObject *pystr, int ascii_only)
+{
+    /* Write the quoted and escaped JSON representation of the PyUnicode
+       pystr.  If ascii_only is false, non-ASCII characters are written
+       as UTF-8 instead of \uXXXX escapes. */
+    Py_ssize_t i;
+    Py_ssize_t input_chars;
+    Py_ssize_t output_size;
+    Py_ssize_t chars;
+    void *input;
+    unsigned char *output;
+    int kind;
+
+    if (PyUnicode_READY(pystr) == -1)
+        return -1;
+
+    input_chars = PyUnicode_GET_LENGTH(pystr);
+    input = PyUnicode_DATA(pystr);
+    kind = PyUnicode_KIND(pystr);
+
+    /* Compute the output size */
+    for (i = 0, output_size = 2; i < input_chars; i++) {
+        Py_UCS4 c = PyUnicode_READ(kind, input, i);
+        Py_ssize_t d;
+        if (S_CHAR(c))
+            d = 1;
+        else {
+            switch(c) {
+            case '\\': case '"': case '\b': case '\f':
+            case '\n': case '\r': case '\t':
+                d = 2; break;
+            default:
+                if (ascii_only || c < ' ')
+                    d = c >= 0x10000 ? 12 : 6;
+                else if (c < 0x80)
+                    d = 1;
+                else if (c < 0x800)
+                    d = 2;
+                else if (c < 0x10000) {
+                    if (Py_UNICODE_IS_SURROGATE(c) && !writer->surrogatepass) {
+                        raise_surrogate_error(pystr, i);
+                        return -1;
+                    }
+                    d = 3;
+                }
+                else
+                    d = 4;
+            }
+        }
+        if (output_size > PY_SSIZE_T_MAX - d) {
+            PyErr_SetString(PyExc_OverflowError, "string is too long to escape");
+            return -1;
+        }
+        output_size += d;
+    }
+
+    output = (unsigned char *)json_writer_prepare(writer, output_size);
+    if (output == NULL)
+        return -1;
+    chars = 0;
+    output[chars++] = '"';
+    for (i = 0; i < input_chars; i++) {
+        Py_UCS4 c = PyUnicode_READ(kind, input, i);
+        if (S_CHAR(c)) {
+            output[chars++] = c;
+        }
+        else if (ascii_only || c < ' ' || c == '\\' || c == '"') {
+            chars = ascii_escape_unichar(c, output, chars);
+        }
+        else if (c < 0x80) {
+            output[chars++] = c;
+        }
+        else if (c < 0x800) {
+            output[chars++] = (unsigned char)(0xc0 | (c >> 6));
+            output[chars++] = (unsigned char)(0x80 | (c & 0x3f));
+        }
+        else if (c < 0x10000) {
+            output[chars++] = (unsigned char)(0xe0 | (c >> 12));
+            output[chars++] = (unsigned char)(0x80 | ((c >> 6) & 0x3f));
+            output[chars++] = (unsigned char)(0x80 | (c & 0x3f));
+        }
+        else {
+            output[chars++] = (unsigned char)(0xf0 | (c >> 18));
+            output[chars++] = (unsigned char)(0x80 | ((c >> 12) & 0x3f));
+            output[chars++] = (unsigned char)(0x80 | ((c >> 6) & 0x3f));
+            output[chars++] = (unsigned char)(0x80 | (c & 0x3f));
+        }
+    }
+    output[chars++] = '"';
+    assert(chars == output_size);
+    writer->pos += chars;
+    return 0;
+}
+
+static PyObject *
+json_writer_finish_bytes(_JSONWriter *writer)
+{
+    PyObject *rval;
+    if (_PyBytes_Resize(&writer->buffer, writer->pos) < 0)
+        return NULL;
+    rval = writer->buffer;
+    writer->buffer = NULL;
+    return rval;
+}
+
+static PyObject *
+json_writer_finish_unicode(_JSONWriter *writer)
+{
+    PyObject *rval;
+    rval = PyUnicode_DecodeUTF8(PyBytes_AS_STRING(writer->buffer), writer->pos,
+                                writer->surrogatepass ? "surrogatepass" : NULL);
+    json_writer_dealloc(writer);
+    return rval;
+}
+
 static void
 raise_errmsg(char *msg, PyObject *s, Py_ssize_t end)
 {
@@ -530,6 +754,33 @@ py_encode_basestring_ascii(PyObject* self UNUSED, PyObject *pystr)
     return rval;
 }
 
+PyDoc_STRVAR(pydoc_encode_basestring,
+    "encode_basestring(string) -> string\n"
+    "\n"
+    "Return a JSON representation of a Python string"
+);
+
+static PyObject *
+py_encode_basestring(PyObject* self UNUSED, PyObject *pystr)
+{
+    _JSONWriter writer;
+    /* Return a JSON representation of a Python string */
+    /* METH_O */
+    if (!PyUnicode_Check(pystr)) {
+        PyErr_Format(PyExc_TypeError,
+                     "first argument must be a string, not %.80s",
+                     Py_TYPE(pystr)->tp_name);
+        return NULL;
+    }
+    if (json_writer_init(&writer, 1))
+        return NULL;
+    if (json_writer_write_escaped(&writer, pystr, 0)) {
+        json_writer_dealloc(&writer);
+        return NULL;
+    }
+    return json_writer_finish_unicode(&writer);
+}
+
 static void
 scanner_dealloc(PyObject *self)
 {
@@ -1179,130 +1430,1043 @@ PyTypeObject PyScannerType = {
     0,/* PyObject_GC_Del, */              /* tp_free */
 };
 
-static PyObject *
-encoder_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+/* Incremental parser for a stream of JSON values encoded to UTF-8.
+
+   The parser is a state machine over a buffer of bytes which have been fed
+   but not consumed yet: it never recurses, and it stops at the beginning of
+   an incomplete token until more data is fed.  Strings are decoded (and so
+   validated) as UTF-8 in place; everything else must be ASCII.  Containers
+   being built are kept on an explicit stack, with the pending key of each
+   object pushed on top of it. */
+
+#define STREAM_MODE_VALUES 0
+#define STREAM_MODE_ITEMS 1
+#define STREAM_MODE_EVENTS 2
+
+/* Parser states */
+#define STREAM_VALUE 0          /* expecting a value */
+#define STREAM_ARRAY_FIRST 1    /* after '[': expecting a value or ']' */
+#define STREAM_OBJECT_FIRST 2   /* after '{': expecting a key or '}' */
+#define STREAM_KEY 3            /* after ',' in an object: expecting a key */
+#define STREAM_COLON 4          /* after a key: expecting ':' */
+#define STREAM_COMMA 5          /* after an item: expecting ',' or the end */
+#define STREAM_SEPARATOR 6      /* after a top-level value: expecting
+                                   whitespace */
+
+/* The key memo is shared by all the values of the stream, but it is
+   cleared when it grows larger than this. */
+#define STREAM_MEMO_MAX 4096
+
+typedef struct _PyStreamParserObject {
+    PyObject_HEAD
+    PyScannerObject *scanner;
+    int mode;
+    int strict;
+    int parsing;
+    int state;
+    char *buf;              /* data fed but not consumed yet */
+    Py_ssize_t pos;
+    Py_ssize_t len;
+    Py_ssize_t allocated;
+    Py_ssize_t consumed;    /* stream offset of buf[0] */
+    Py_ssize_t lineno;
+    Py_ssize_t linestart;   /* stream offset of the current line */
+    Py_ssize_t scan_offset; /* where to resume scanning an incomplete string */
+    int scan_escape;
+    char *kinds;            /* '[' or '{' for each open container */
+    Py_ssize_t depth;
+    Py_ssize_t kinds_allocated;
+    PyObject *stack;
+    PyObject *result;
+} PyStreamParserObject;
+
+static PyTypeObject PyStreamParserType;
+
+#define PyStreamParser_Check(op) PyObject_TypeCheck(op, &PyStreamParserType)
+
+_Py_IDENTIFIER(start_object);
+_Py_IDENTIFIER(end_object);
+_Py_IDENTIFIER(start_array);
+_Py_IDENTIFIER(end_array);
+_Py_IDENTIFIER(key);
+_Py_IDENTIFIER(value);
+
+static void
+stream_reset(PyStreamParserObject *s)
 {
-    PyEncoderObject *s;
-    s = (PyEncoderObject *)type->tp_alloc(type, 0);
-    if (s != NULL) {
-        s->markers = NULL;
-        s->defaultfn = NULL;
-        s->encoder = NULL;
-        s->indent = NULL;
-        s->key_separator = NULL;
-        s->item_separator = NULL;
-        s->sort_keys = NULL;
-        s->skipkeys = NULL;
-    }
-    return (PyObject *)s;
+    s->state = STREAM_VALUE;
+    s->pos = s->len = 0;
+    s->consumed = 0;
+    s->lineno = 1;
+    s->linestart = 0;
+    s->scan_offset = 0;
+    s->scan_escape = 0;
+    s->depth = 0;
+    if (s->stack != NULL)
+        PyList_SetSlice(s->stack, 0, PyList_GET_SIZE(s->stack), NULL);
 }
 
-static int
-encoder_init(PyObject *self, PyObject *args, PyObject *kwds)
+static void
+stream_error(PyStreamParserObject *s, const char *msg, Py_ssize_t idx)
 {
-    /* initialize Encoder object */
-    static char *kwlist[] = {"markers", "default", "encoder", "indent", "key_separator", "item_separator", "sort_keys", "skipkeys", "allow_nan", NULL};
-
-    PyEncoderObject *s;
-    PyObject *markers, *defaultfn, *encoder, *indent, *key_separator;
-    PyObject *item_separator, *sort_keys, *skipkeys, *allow_nan;
-
-    assert(PyEncoder_Check(self));
-    s = (PyEncoderObject *)self;
+    Py_ssize_t offset = s->consumed + idx;
+    PyErr_Format(PyExc_ValueError, "%s: line %zd column %zd (byte %zd)",
+                 msg, s->lineno, offset - s->linestart + 1, offset);
+}
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOOOOOOOO:make_encoder", kwlist,
-        &markers, &defaultfn, &encoder, &indent, &key_separator, &item_separator,
-        &sort_keys, &skipkeys, &allow_nan))
+static int
+stream_emit(PyStreamParserObject *s, PyObject *obj)
+{
+    /* Append obj to the values returned by feed(), stealing a reference */
+    int rval;
+    if (obj == NULL)
         return -1;
+    rval = PyList_Append(s->result, obj);
+    Py_DECREF(obj);
+    if (PyDict_Size(s->scanner->memo) > STREAM_MEMO_MAX)
+        PyDict_Clear(s->scanner->memo);
+    return rval;
+}
 
-    s->markers = markers;
-    s->defaultfn = defaultfn;
-    s->encoder = encoder;
-    s->indent = indent;
-    s->key_separator = key_separator;
-    s->item_separator = item_separator;
-    s->sort_keys = sort_keys;
-    s->skipkeys = skipkeys;
-    s->fast_encode = (PyCFunction_Check(s->encoder) && PyCFunction_GetFunction(s->encoder) == (PyCFunction)py_encode_basestring_ascii);
-    s->allow_nan = PyObject_IsTrue(allow_nan);
+static int
+stream_event(PyStreamParserObject *s, _Py_Identifier *event, PyObject *value)
+{
+    PyObject *name = _PyUnicode_FromId(event);
+    if (name == NULL)
+        return -1;
+    return stream_emit(s, PyTuple_Pack(2, name, value ? value : Py_None));
+}
 
-    Py_INCREF(s->markers);
-    Py_INCREF(s->defaultfn);
-    Py_INCREF(s->encoder);
-    Py_INCREF(s->indent);
-    Py_INCREF(s->key_separator);
-    Py_INCREF(s->item_separator);
-    Py_INCREF(s->sort_keys);
-    Py_INCREF(s->skipkeys);
-    return 0;
+static void
+stream_item_done(PyStreamParserObject *s)
+{
+    s->state = s->depth ? STREAM_COMMA : STREAM_SEPARATOR;
 }
 
-static PyObject *
-encoder_call(PyObject *self, PyObject *args, PyObject *kwds)
+static int
+stream_add_value(PyStreamParserObject *s, PyObject *value)
 {
-    /* Python callable interface to encode_listencode_obj */
-    static char *kwlist[] = {"obj", "_current_indent_level", NULL};
-    PyObject *obj;
-    Py_ssize_t indent_level;
-    PyEncoderObject *s;
-    _PyAccu acc;
+    /* Store a complete value (stolen) in its parent container, or return it
+       from feed() if it is at the top of the values built */
+    PyObject *container;
+    Py_ssize_t n;
+    int rval;
 
-    assert(PyEncoder_Check(self));
-    s = (PyEncoderObject *)self;
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "On:_iterencode", kwlist,
-        &obj, &indent_level))
-        return NULL;
-    if (_PyAccu_Init(&acc))
-        return NULL;
-    if (encoder_listencode_obj(s, &acc, obj, indent_level)) {
-        _PyAccu_Destroy(&acc);
-        return NULL;
+    if (value == NULL)
+        return -1;
+    stream_item_done(s);
+    if (s->depth == (s->mode == STREAM_MODE_ITEMS))
+        return stream_emit(s, value);
+    n = PyList_GET_SIZE(s->stack);
+    if (s->kinds[s->depth - 1] == '[') {
+        rval = PyList_Append(PyList_GET_ITEM(s->stack, n - 1), value);
+    }
+    else {
+        PyObject *key = PyList_GET_ITEM(s->stack, n - 1);
+        container = PyList_GET_ITEM(s->stack, n - 2);
+        if (s->scanner->object_pairs_hook != Py_None) {
+            PyObject *item = PyTuple_Pack(2, key, value);
+            if (item == NULL) {
+                Py_DECREF(value);
+                return -1;
+            }
+            rval = PyList_Append(container, item);
+            Py_DECREF(item);
+        }
+        else {
+            rval = PyDict_SetItem(container, key, value);
+        }
+        if (rval == 0)
+            rval = PyList_SetSlice(s->stack, n - 1, n, NULL);
     }
-    return _PyAccu_FinishAsList(&acc);
+    Py_DECREF(value);
+    return rval;
 }
 
-static PyObject *
-_encoded_const(PyObject *obj)
+static int
+stream_start_container(PyStreamParserObject *s, char kind)
 {
-    /* Return the JSON string representation of None, True, False */
-    if (obj == Py_None) {
-        static PyObject *s_null = NULL;
-        if (s_null == NULL) {
-            s_null = PyUnicode_InternFromString("null");
-        }
-        Py_INCREF(s_null);
-        return s_null;
-    }
-    else if (obj == Py_True) {
-        static PyObject *s_true = NULL;
-        if (s_true == NULL) {
-            s_true = PyUnicode_InternFromString("true");
+    if (s->depth == s->kinds_allocated) {
+        Py_ssize_t newsize = s->kinds_allocated ? s->kinds_allocated * 2 : 16;
+        char *kinds = PyMem_Realloc(s->kinds, newsize);
+        if (kinds == NULL) {
+            PyErr_NoMemory();
+            return -1;
         }
-        Py_INCREF(s_true);
-        return s_true;
+        s->kinds = kinds;
+        s->kinds_allocated = newsize;
     }
-    else if (obj == Py_False) {
-        static PyObject *s_false = NULL;
-        if (s_false == NULL) {
-            s_false = PyUnicode_InternFromString("false");
-        }
-        Py_INCREF(s_false);
-        return s_false;
+    if (s->mode == STREAM_MODE_EVENTS) {
+        if (stream_event(s, kind == '[' ? &PyId_start_array : &PyId_start_object,
+                         NULL))
+            return -1;
     }
-    else {
-        PyErr_SetString(PyExc_ValueError, "not a const");
-        return NULL;
+    else if (s->depth >= (s->mode == STREAM_MODE_ITEMS)) {
+        PyObject *container;
+        int rval;
+        if (kind == '[' || s->scanner->object_pairs_hook != Py_None)
+            container = PyList_New(0);
+        else
+            container = PyDict_New();
+        if (container == NULL)
+            return -1;
+        rval = PyList_Append(s->stack, container);
+        Py_DECREF(container);
+        if (rval)
+            return -1;
     }
+    s->kinds[s->depth++] = kind;
+    s->state = kind == '[' ? STREAM_ARRAY_FIRST : STREAM_OBJECT_FIRST;
+    return 0;
 }
 
-static PyObject *
-encoder_encode_long(PyEncoderObject* s UNUSED, PyObject *obj)
+static int
+stream_end_container(PyStreamParserObject *s)
 {
-    /* Return the JSON representation of a PyLong and PyLong subclasses.
-       Calls int() on PyLong subclasses in case the str() was changed.
-       Added specifically to deal with IntEnum.  See Issue18264. */
-    PyObject *encoded, *longobj;
-    if (PyLong_CheckExact(obj)) {
+    char kind = s->kinds[--s->depth];
+    PyObject *container, *hook;
+    Py_ssize_t n;
+
+    if (s->mode == STREAM_MODE_EVENTS) {
+        stream_item_done(s);
+        return stream_event(s, kind == '[' ? &PyId_end_array : &PyId_end_object,
+                            NULL);
+    }
+    if (s->depth < (s->mode == STREAM_MODE_ITEMS)) {
+        /* end of a top-level array in items mode */
+        stream_item_done(s);
+        return 0;
+    }
+    n = PyList_GET_SIZE(s->stack);
+    container = PyList_GET_ITEM(s->stack, n - 1);
+    Py_INCREF(container);
+    if (PyList_SetSlice(s->stack, n - 1, n, NULL)) {
+        Py_DECREF(container);
+        return -1;
+    }
+    if (kind == '{') {
+        if (s->scanner->object_pairs_hook != Py_None)
+            hook = s->scanner->object_pairs_hook;
+        else if (s->scanner->object_hook != Py_None)
+            hook = s->scanner->object_hook;
+        else
+            hook = NULL;
+        if (hook != NULL) {
+            PyObject *val = PyObject_CallFunctionObjArgs(hook, container, NULL);
+            Py_DECREF(container);
+            container = val;
+        }
+    }
+    return stream_add_value(s, container);
+}
+
+static int
+stream_scalar(PyStreamParserObject *s, PyObject *value)
+{
+    /* A string, number or constant value (stolen) was parsed */
+    int rval;
+    if (value == NULL)
+        return -1;
+    if (s->mode != STREAM_MODE_EVENTS)
+        return stream_add_value(s, value);
+    stream_item_done(s);
+    rval = stream_event(s, &PyId_value, value);
+    Py_DECREF(value);
+    return rval;
+}
+
+static Py_ssize_t
+stream_scan_string(PyStreamParserObject *s, Py_ssize_t start, int final,
+                   int *has_escape)
+{
+    /* Find the closing quote of the string starting at buf[start].
+       Returns its index, -1 if the string is incomplete or -2 on error. */
+    const unsigned char *buf = (const unsigned char *)s->buf;
+    Py_ssize_t i = start + (s->scan_offset ? s->scan_offset : 1);
+    int escape = s->scan_escape;
+
+    while (i < s->len) {
+        unsigned char c = buf[i];
+        if (c == '"') {
+            s->scan_offset = 0;
+            s->scan_escape = 0;
+            *has_escape = escape;
+            return i;
+        }
+        if (c == '\\') {
+            if (i + 1 >= s->len)
+                break;
+            escape = 1;
+            i += 2;
+            continue;
+        }
+        if (c < ' ' && s->strict) {
+            stream_error(s, "Invalid control character at", i);
+            return -2;
+        }
+        i++;
+    }
+    if (final) {
+        stream_error(s, "Unterminated string starting at", start);
+        return -2;
+    }
+    s->scan_offset = i - start;
+    s->scan_escape = escape;
+    return -1;
+}
+
+static PyObject *
+stream_decode_string(PyStreamParserObject *s, Py_ssize_t start, Py_ssize_t end,
+                     int has_escape)
+{
+    /* Decode the string between the quotes at buf[start] and buf[end] */
+    PyObject *raw, *rval;
+    Py_ssize_t next_end;
+
+    if (!has_escape)
+        return PyUnicode_DecodeUTF8(s->buf + start + 1, end - start - 1, NULL);
+    raw = PyUnicode_DecodeUTF8(s->buf + start, end - start + 1, NULL);
+    if (raw == NULL)
+        return NULL;
+    rval = scanstring_unicode(raw, 1, s->strict, &next_end);
+    Py_DECREF(raw);
+    return rval;
+}
+
+static int
+stream_match(PyStreamParserObject *s, Py_ssize_t idx, const char *literal,
+             int final)
+{
+    /* Returns 1 if buf[idx:] starts with literal, 0 if it may once more data
+       is fed, and -1 otherwise */
+    Py_ssize_t n = strlen(literal);
+    Py_ssize_t avail = s->len - idx;
+    if (avail >= n)
+        return memcmp(s->buf + idx, literal, n) == 0 ? 1 : -1;
+    if (final || memcmp(s->buf + idx, literal, avail) != 0)
+        return -1;
+    return 0;
+}
+
+#define IS_DIGIT(c) ((c) >= '0' && (c) <= '9')
+
+static PyObject *
+stream_number(PyStreamParserObject *s, Py_ssize_t start, Py_ssize_t *next_idx_ptr)
+{
+    /* Read a JSON number from buf[start:], as _match_number_unicode() does.
+       Returns NULL with no exception set if there is no number there. */
+    const unsigned char *buf = (const unsigned char *)s->buf;
+    Py_ssize_t end = s->len;
+    Py_ssize_t idx = start;
+    int is_float = 0;
+    PyObject *rval, *numstr, *custom_func;
+
+    if (buf[idx] == '-') {
+        idx++;
+        if (idx >= end)
+            return NULL;
+    }
+    if (buf[idx] >= '1' && buf[idx] <= '9') {
+        idx++;
+        while (idx < end && IS_DIGIT(buf[idx])) idx++;
+    }
+    else if (buf[idx] == '0') {
+        idx++;
+    }
+    else {
+        return NULL;
+    }
+    if (idx < end - 1 && buf[idx] == '.' && IS_DIGIT(buf[idx + 1])) {
+        is_float = 1;
+        idx += 2;
+        while (idx < end && IS_DIGIT(buf[idx])) idx++;
+    }
+    if (idx < end - 1 && (buf[idx] == 'e' || buf[idx] == 'E')) {
+        Py_ssize_t e_start = idx;
+        idx++;
+        if (idx < end - 1 && (buf[idx] == '-' || buf[idx] == '+')) idx++;
+        while (idx < end && IS_DIGIT(buf[idx])) idx++;
+        if (IS_DIGIT(buf[idx - 1]))
+            is_float = 1;
+        else
+            idx = e_start;
+    }
+    *next_idx_ptr = idx;
+
+    if (is_float && s->scanner->parse_float != (PyObject *)&PyFloat_Type)
+        custom_func = s->scanner->parse_float;
+    else if (!is_float && s->scanner->parse_int != (PyObject *)&PyLong_Type)
+        custom_func = s->scanner->parse_int;
+    else
+        custom_func = NULL;
+
+    if (custom_func) {
+        numstr = PyUnicode_FromStringAndSize(s->buf + start, idx - start);
+        if (numstr == NULL)
+            return NULL;
+        rval = PyObject_CallFunctionObjArgs(custom_func, numstr, NULL);
+    }
+    else if (!is_float && idx - start <= 18) {
+        /* fits in a C long long */
+        PY_LONG_LONG v = 0;
+        Py_ssize_t i = start + (buf[start] == '-');
+        for (; i < idx; i++)
+            v = v * 10 + (buf[i] - '0');
+        return PyLong_FromLongLong(buf[start] == '-' ? -v : v);
+    }
+    else {
+        numstr = PyBytes_FromStringAndSize(s->buf + start, idx - start);
+        if (numstr == NULL)
+            return NULL;
+        if (is_float)
+            rval = PyFloat_FromString(numstr);
+        else
+            rval = PyLong_FromString(PyBytes_AS_STRING(numstr), NULL, 10);
+    }
+    Py_DECREF(numstr);
+    return rval;
+}
+
+static Py_ssize_t
+stream_parse_value(PyStreamParserObject *s, Py_ssize_t idx, int final)
+{
+    /* Parse the value starting at buf[idx].  Returns the index following
+       it, -1 if it is incomplete or -2 on error. */
+    const unsigned char *buf = (const unsigned char *)s->buf;
+    unsigned char c = buf[idx];
+    Py_ssize_t end;
+    int m;
+
+    if (s->mode == STREAM_MODE_ITEMS && s->depth == 0 && c != '[') {
+        stream_error(s, "Expecting '['", idx);
+        return -2;
+    }
+    switch (c) {
+    case '{':
+    case '[':
+        if (stream_start_container(s, c))
+            return -2;
+        return idx + 1;
+    case '"': {
+        int has_escape;
+        end = stream_scan_string(s, idx, final, &has_escape);
+        if (end < 0)
+            return end;
+        if (stream_scalar(s, stream_decode_string(s, idx, end, has_escape)))
+            return -2;
+        return end + 1;
+    }
+    case 't':
+    case 'f':
+    case 'n':
+    case 'N':
+    case 'I': {
+        static const char * const literals[] = {
+            "true", "false", "null", "NaN", "Infinity"};
+        const char *literal;
+        PyObject *value;
+        switch (c) {
+        case 't': literal = literals[0]; value = Py_True; break;
+        case 'f': literal = literals[1]; value = Py_False; break;
+        case 'n': literal = literals[2]; value = Py_None; break;
+        case 'N': literal = literals[3]; value = NULL; break;
+        default: literal = literals[4]; value = NULL; break;
+        }
+        m = stream_match(s, idx, literal, final);
+        if (m == 0)
+            return -1;
+        if (m < 0)
+            break;
+        if (value != NULL) {
+            Py_INCREF(value);
+        }
+        else {
+            Py_ssize_t next_idx;
+            value = _parse_constant(s->scanner, (char *)literal, idx,
+                                    &next_idx);
+        }
+        if (stream_scalar(s, value))
+            return -2;
+        return idx + strlen(literal);
+    }
+    default:
+        if (c == '-' || IS_DIGIT(c)) {
+            PyObject *value;
+            Py_ssize_t next_idx;
+            if (c == '-') {
+                m = stream_match(s, idx, "-Infinity", final);
+                if (m == 0)
+                    return -1;
+                if (m > 0) {
+                    value = _parse_constant(s->scanner, "-Infinity", idx,
+                                            &next_idx);
+                    if (stream_scalar(s, value))
+                        return -2;
+                    return idx + 9;
+                }
+            }
+            /* The number may continue in the next chunk */
+            end = idx + 1;
+            while (end < s->len &&
+                   (IS_DIGIT(buf[end]) || buf[end] == '.' || buf[end] == 'e' ||
+                    buf[end] == 'E' || buf[end] == '+' || buf[end] == '-'))
+                end++;
+            if (end == s->len && !final)
+                return -1;
+            value = stream_number(s, idx, &next_idx);
+            if (value == NULL) {
+                if (PyErr_Occurred())
+                    return -2;
+                break;
+            }
+            if (stream_scalar(s, value))
+                return -2;
+            return next_idx;
+        }
+    }
+    stream_error(s, "Expecting value", idx);
+    return -2;
+}
+
+static int
+stream_parse(PyStreamParserObject *s, int final)
+{
+    /* Parse as much of the buffer as possible */
+    const unsigned char *buf = (const unsigned char *)s->buf;
+    Py_ssize_t idx = s->pos;
+    Py_ssize_t next;
+    unsigned char c;
+
+    while (1) {
+        if (idx < s->len && IS_WHITESPACE(buf[idx])) {
+            do {
+                if (buf[idx] == '\n') {
+                    s->lineno++;
+                    s->linestart = s->consumed + idx + 1;
+                }
+                idx++;
+            } while (idx < s->len && IS_WHITESPACE(buf[idx]));
+            if (s->state == STREAM_SEPARATOR)
+                s->state = STREAM_VALUE;
+        }
+        if (idx >= s->len)
+            break;
+        c = buf[idx];
+        switch (s->state) {
+        case STREAM_SEPARATOR:
+            /* Top-level values are separated by whitespace */
+            stream_error(s, "Extra data", idx);
+            goto bail;
+        case STREAM_COLON:
+            if (c != ':') {
+                stream_error(s, "Expecting ':' delimiter", idx);
+                goto bail;
+            }
+            idx++;
+            s->state = STREAM_VALUE;
+            continue;
+        case STREAM_COMMA:
+            if (c == ',') {
+                idx++;
+                s->state = s->kinds[s->depth - 1] == '[' ? STREAM_VALUE : STREAM_KEY;
+                continue;
+            }
+            if (c == (s->kinds[s->depth - 1] == '[' ? ']' : '}')) {
+                idx++;
+                if (stream_end_container(s))
+                    goto bail;
+                continue;
+            }
+            stream_error(s, "Expecting ',' delimiter", idx);
+            goto bail;
+        case STREAM_OBJECT_FIRST:
+            if (c == '}') {
+                idx++;
+                if (stream_end_container(s))
+                    goto bail;
+                continue;
+            }
+            /* fall through */
+        case STREAM_KEY: {
+            PyObject *key, *memokey;
+            int has_escape;
+            if (c != '"') {
+                stream_error(s, "Expecting property name enclosed in double quotes", idx);
+                goto bail;
+            }
+            next = stream_scan_string(s, idx, final, &has_escape);
+            if (next == -1)
+                goto incomplete;
+            if (next < 0)
+                goto bail;
+            key = stream_decode_string(s, idx, next, has_escape);
+            if (key == NULL)
+                goto bail;
+            memokey = PyDict_GetItem(s->scanner->memo, key);
+            if (memokey != NULL) {
+                Py_INCREF(memokey);
+                Py_DECREF(key);
+                key = memokey;
+            }
+            else if (PyDict_SetItem(s->scanner->memo, key, key) < 0) {
+                Py_DECREF(key);
+                goto bail;
+            }
+            if (s->mode == STREAM_MODE_EVENTS) {
+                if (stream_event(s, &PyId_key, key)) {
+                    Py_DECREF(key);
+                    goto bail;
+                }
+            }
+            else if (PyList_Append(s->stack, key)) {
+                Py_DECREF(key);
+                goto bail;
+            }
+            Py_DECREF(key);
+            idx = next + 1;
+            s->state = STREAM_COLON;
+            continue;
+        }
+        case STREAM_ARRAY_FIRST:
+            if (c == ']') {
+                idx++;
+                if (stream_end_container(s))
+                    goto bail;
+                continue;
+            }
+            /* fall through */
+        default:
+            next = stream_parse_value(s, idx, final);
+            if (next == -1)
+                goto incomplete;
+            if (next < 0)
+                goto bail;
+            idx = next;
+        }
+    }
+incomplete:
+    s->pos = idx;
+    return 0;
+
+bail:
+    s->pos = idx;
+    return -1;
+}
+
+static PyObject *
+stream_parser_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyStreamParserObject *s;
+    s = (PyStreamParserObject *)type->tp_alloc(type, 0);
+    if (s == NULL)
+        return NULL;
+    s->stack = PyList_New(0);
+    if (s->stack == NULL) {
+        Py_DECREF(s);
+        return NULL;
+    }
+    stream_reset(s);
+    return (PyObject *)s;
+}
+
+static int
+stream_parser_init(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"context", "mode", NULL};
+    PyStreamParserObject *s = (PyStreamParserObject *)self;
+    PyObject *ctx, *scanner;
+    const char *mode = "values";
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|s:make_stream_parser",
+                                     kwlist, &ctx, &mode))
+        return -1;
+    if (strcmp(mode, "values") == 0)
+        s->mode = STREAM_MODE_VALUES;
+    else if (strcmp(mode, "items") == 0)
+        s->mode = STREAM_MODE_ITEMS;
+    else if (strcmp(mode, "events") == 0)
+        s->mode = STREAM_MODE_EVENTS;
+    else {
+        PyErr_Format(PyExc_ValueError, "invalid mode: '%s'", mode);
+        return -1;
+    }
+    scanner = PyObject_CallFunctionObjArgs((PyObject *)&PyScannerType, ctx,
+                                           NULL);
+    if (scanner == NULL)
+        return -1;
+    Py_XDECREF(s->scanner);
+    s->scanner = (PyScannerObject *)scanner;
+    s->strict = PyObject_IsTrue(s->scanner->strict);
+    if (s->strict < 0)
+        return -1;
+    stream_reset(s);
+    return 0;
+}
+
+static PyObject *
+stream_parser_run(PyStreamParserObject *s, int final)
+{
+    PyObject *result;
+
+    if (s->scanner == NULL) {
+        PyErr_SetString(PyExc_ValueError, "uninitialized stream parser");
+        return NULL;
+    }
+    result = PyList_New(0);
+    if (result == NULL)
+        return NULL;
+    s->result = result;
+    s->parsing = 1;
+    if (stream_parse(s, final))
+        goto error;
+    if (final && s->depth) {
+        static const char * const messages[] = {
+            "Expecting value",
+            "Expecting value",
+            "Expecting property name enclosed in double quotes",
+            "Expecting property name enclosed in double quotes",
+            "Expecting ':' delimiter",
+            "Expecting ',' delimiter",
+            "Extra data",
+        };
+        stream_error(s, messages[s->state], s->len);
+        goto error;
+    }
+    s->parsing = 0;
+    s->result = NULL;
+    return result;
+
+error:
+    s->parsing = 0;
+    s->result = NULL;
+    Py_DECREF(result);
+    stream_reset(s);
+    return NULL;
+}
+
+PyDoc_STRVAR(stream_parser_feed_doc,
+"feed(data) -> list\n\
+\n\
+Parse the bytes-like object data and return the values completed by it.");
+
+static PyObject *
+stream_parser_feed(PyObject *self, PyObject *args)
+{
+    PyStreamParserObject *s = (PyStreamParserObject *)self;
+    Py_buffer data;
+
+    if (!PyArg_ParseTuple(args, "y*:feed", &data))
+        return NULL;
+    if (s->parsing) {
+        PyErr_SetString(PyExc_RuntimeError, "reentrant call to feed()");
+        PyBuffer_Release(&data);
+        return NULL;
+    }
+    /* Drop the consumed data and append the new one */
+    if (s->pos) {
+        memmove(s->buf, s->buf + s->pos, s->len - s->pos);
+        s->consumed += s->pos;
+        s->len -= s->pos;
+        s->pos = 0;
+    }
+    if (data.len > s->allocated - s->len) {
+        Py_ssize_t newsize;
+        char *buf;
+        if (data.len > PY_SSIZE_T_MAX / 2 - s->len) {
+            PyBuffer_Release(&data);
+            return PyErr_NoMemory();
+        }
+        newsize = (s->len + data.len) * 2;
+        buf = PyMem_Realloc(s->buf, newsize);
+        if (buf == NULL) {
+            PyBuffer_Release(&data);
+            return PyErr_NoMemory();
+        }
+        s->buf = buf;
+        s->allocated = newsize;
+    }
+    memcpy(s->buf + s->len, data.buf, data.len);
+    s->len += data.len;
+    PyBuffer_Release(&data);
+    return stream_parser_run(s, 0);
+}
+
+PyDoc_STRVAR(stream_parser_close_doc,
+"close() -> list\n\
+\n\
+Return the values left at the end of the stream, and reset the parser.\n\
+Raise ValueError if the stream ends in the middle of a value.");
+
+static PyObject *
+stream_parser_close(PyObject *self, PyObject *unused)
+{
+    PyStreamParserObject *s = (PyStreamParserObject *)self;
+    PyObject *result;
+
+    if (s->parsing) {
+        PyErr_SetString(PyExc_RuntimeError, "reentrant call to close()");
+        return NULL;
+    }
+    result = stream_parser_run(s, 1);
+    if (result != NULL)
+        stream_reset(s);
+    return result;
+}
+
+static int
+stream_parser_traverse(PyObject *self, visitproc visit, void *arg)
+{
+    PyStreamParserObject *s = (PyStreamParserObject *)self;
+    Py_VISIT(s->scanner);
+    Py_VISIT(s->stack);
+    return 0;
+}
+
+static int
+stream_parser_clear(PyObject *self)
+{
+    PyStreamParserObject *s = (PyStreamParserObject *)self;
+    Py_CLEAR(s->scanner);
+    Py_CLEAR(s->stack);
+    return 0;
+}
+
+static void
+stream_parser_dealloc(PyObject *self)
+{
+    PyStreamParserObject *s = (PyStreamParserObject *)self;
+    PyObject_GC_UnTrack(self);
+    stream_parser_clear(self);
+    PyMem_Free(s->buf);
+    PyMem_Free(s->kinds);
+    Py_TYPE(self)->tp_free(self);
+}
+
+static PyMethodDef stream_parser_methods[] = {
+    {"feed", (PyCFunction)stream_parser_feed, METH_VARARGS,
+        stream_parser_feed_doc},
+    {"close", (PyCFunction)stream_parser_close, METH_NOARGS,
+        stream_parser_close_doc},
+    {NULL, NULL}
+};
+
+PyDoc_STRVAR(stream_parser_doc,
+"make_stream_parser(context, mode='values')\n\
+\n\
+Incremental parser for a stream of JSON values encoded to UTF-8.");
+
+static
+PyTypeObject PyStreamParserType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_json.StreamParser",  /* tp_name */
+    sizeof(PyStreamParserObject), /* tp_basicsize */
+    0,                    /* tp_itemsize */
+    stream_parser_dealloc, /* tp_dealloc */
+    0,                    /* tp_print */
+    0,                    /* tp_getattr */
+    0,                    /* tp_setattr */
+    0,                    /* tp_compare */
+    0,                    /* tp_repr */
+    0,                    /* tp_as_number */
+    0,                    /* tp_as_sequence */
+    0,                    /* tp_as_mapping */
+    0,                    /* tp_hash */
+    0,                    /* tp_call */
+    0,                    /* tp_str */
+    0,                    /* tp_getattro */
+    0,                    /* tp_setattro */
+    0,                    /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,   /* tp_flags */
+    stream_parser_doc,    /* tp_doc */
+    stream_parser_traverse, /* tp_traverse */
+    stream_parser_clear,  /* tp_clear */
+    0,                    /* tp_richcompare */
+    0,                    /* tp_weaklistoffset */
+    0,                    /* tp_iter */
+    0,                    /* tp_iternext */
+    stream_parser_methods, /* tp_methods */
+    0,                    /* tp_members */
+    0,                    /* tp_getset */
+    0,                    /* tp_base */
+    0,                    /* tp_dict */
+    0,                    /* tp_descr_get */
+    0,                    /* tp_descr_set */
+    0,                    /* tp_dictoffset */
+    stream_parser_init,   /* tp_init */
+    0,                    /* tp_alloc */
+    stream_parser_new,    /* tp_new */
+    0,                    /* tp_free */
+};
+
+static PyObject *
+encoder_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyEncoderObject *s;
+    s = (PyEncoderObject *)type->tp_alloc(type, 0);
+    if (s != NULL) {
+        s->markers = NULL;
+        s->defaultfn = NULL;
+        s->encoder = NULL;
+        s->indent = NULL;
+        s->key_separator = NULL;
+        s->item_separator = NULL;
+        s->sort_keys = NULL;
+        s->skipkeys = NULL;
+    }
+    return (PyObject *)s;
+}
+
+static int
+encoder_init(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    /* initialize Encoder object */
+    static char *kwlist[] = {"markers", "default", "encoder", "indent", "key_separator", "item_separator", "sort_keys", "skipkeys", "allow_nan", NULL};
+
+    PyEncoderObject *s;
+    PyObject *markers, *defaultfn, *encoder, *indent, *key_separator;
+    PyObject *item_separator, *sort_keys, *skipkeys, *allow_nan;
+
+    assert(PyEncoder_Check(self));
+    s = (PyEncoderObject *)self;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOOOOOOOO:make_encoder", kwlist,
+        &markers, &defaultfn, &encoder, &indent, &key_separator, &item_separator,
+        &sort_keys, &skipkeys, &allow_nan))
+        return -1;
+
+    if (indent != Py_None && !PyUnicode_Check(indent)) {
+        PyErr_Format(PyExc_TypeError,
+                     "make_encoder() argument 4 must be str or None, not %.200s",
+                     Py_TYPE(indent)->tp_name);
+        return -1;
+    }
+    if (!PyUnicode_Check(key_separator) || !PyUnicode_Check(item_separator)) {
+        PyErr_SetString(PyExc_TypeError, "separators must be str");
+        return -1;
+    }
+
+    s->markers = markers;
+    s->defaultfn = defaultfn;
+    s->encoder = encoder;
+    s->indent = indent;
+    s->key_separator = key_separator;
+    s->item_separator = item_separator;
+    s->sort_keys = sort_keys;
+    s->skipkeys = skipkeys;
+    s->fast_encode = 0;
+    if (PyCFunction_Check(s->encoder)) {
+        PyCFunction f = PyCFunction_GetFunction(s->encoder);
+        if (f == (PyCFunction)py_encode_basestring_ascii)
+            s->fast_encode = FAST_ENCODE_ASCII;
+        else if (f == (PyCFunction)py_encode_basestring)
+            s->fast_encode = FAST_ENCODE_UNICODE;
+    }
+    s->allow_nan = PyObject_IsTrue(allow_nan);
+
+    Py_INCREF(s->markers);
+    Py_INCREF(s->defaultfn);
+    Py_INCREF(s->encoder);
+    Py_INCREF(s->indent);
+    Py_INCREF(s->key_separator);
+    Py_INCREF(s->item_separator);
+    Py_INCREF(s->sort_keys);
+    Py_INCREF(s->skipkeys);
+    return 0;
+}
+
+static PyObject *
+encoder_call(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    /* Python callable interface to encode_listencode_obj */
+    static char *kwlist[] = {"obj", "_current_indent_level", NULL};
+    PyObject *obj;
+    PyObject *rval;
+    Py_ssize_t indent_level;
+    PyEncoderObject *s;
+    _JSONWriter writer;
+
+    assert(PyEncoder_Check(self));
+    s = (PyEncoderObject *)self;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "On:_iterencode", kwlist,
+        &obj, &indent_level))
+        return NULL;
+    /* Lone surrogates are allowed in str output */
+    if (json_writer_init(&writer, 1))
+        return NULL;
+    if (encoder_listencode_obj(s, &writer, obj, indent_level)) {
+        json_writer_dealloc(&writer);
+        return NULL;
+    }
+    rval = json_writer_finish_unicode(&writer);
+    if (rval == NULL)
+        return NULL;
+    return Py_BuildValue("[N]", rval);
+}
+
+PyDoc_STRVAR(encoder_encode_bytes_doc,
+"encode_bytes(obj) -> bytes\n\
+\n\
+Return the JSON representation of obj encoded to UTF-8.");
+
+static PyObject *
+encoder_encode_bytes(PyObject *self, PyObject *obj)
+{
+    PyEncoderObject *s;
+    _JSONWriter writer;
+
+    assert(PyEncoder_Check(self));
+    s = (PyEncoderObject *)self;
+    if (json_writer_init(&writer, 0))
+        return NULL;
+    if (encoder_listencode_obj(s, &writer, obj, 0)) {
+        json_writer_dealloc(&writer);
+        return NULL;
+    }
+    return json_writer_finish_bytes(&writer);
+}
+
+static PyObject *
+_encoded_const(PyObject *obj)
+{
+    /* Return the JSON string representation of None, True, False */
+    if (obj == Py_None) {
+        static PyObject *s_null = NULL;
+        if (s_null == NULL) {
+            s_null = PyUnicode_InternFromString("null");
+        }
+        Py_INCREF(s_null);
+        return s_null;
+    }
+    else if (obj == Py_True) {
+        static PyObject *s_true = NULL;
+        if (s_true == NULL) {
+            s_true = PyUnicode_InternFromString("true");
+        }
+        Py_INCREF(s_true);
+        return s_true;
+    }
+    else if (obj == Py_False) {
+        static PyObject *s_false = NULL;
+        if (s_false == NULL) {
+            s_false = PyUnicode_InternFromString("false");
+        }
+        Py_INCREF(s_false);
+        return s_false;
+    }
+    else {
+        PyErr_SetString(PyExc_ValueError, "not a const");
+        return NULL;
+    }
+}
+
+static PyObject *
+encoder_encode_long(PyEncoderObject* s UNUSED, PyObject *obj)
+{
+    /* Return the JSON representation of a PyLong and PyLong subclasses.
+       Calls int() on PyLong subclasses in case the str() was changed.
+       Added specifically to deal with IntEnum.  See Issue18264. */
+    PyObject *encoded, *longobj;
+    if (PyLong_CheckExact(obj)) {
         encoded = PyObject_Str(obj);
     }
     else {
@@ -1367,69 +2531,142 @@ encoder_encode_float(PyEncoderObject *s, PyObject *obj)
     return encoded;
 }
 
-static PyObject *
-encoder_encode_string(PyEncoderObject *s, PyObject *obj)
+static int
+_steal_write(_JSONWriter *writer, PyObject *stolen)
+{
+    /* Write str stolen and then decrement its reference count */
+    int rval;
+    if (stolen == NULL)
+        return -1;
+    rval = json_writer_write_unicode(writer, stolen);
+    Py_DECREF(stolen);
+    return rval;
+}
+
+static int
+encoder_write_string(PyEncoderObject *s, _JSONWriter *writer, PyObject *obj)
 {
-    /* Return the JSON representation of a string */
+    /* Write the JSON representation of a string */
+    PyObject *encoded;
+
     if (s->fast_encode)
-        return py_encode_basestring_ascii(NULL, obj);
-    else
-        return PyObject_CallFunctionObjArgs(s->encoder, obj, NULL);
+        return json_writer_write_escaped(writer, obj,
+                                         s->fast_encode == FAST_ENCODE_ASCII);
+    encoded = PyObject_CallFunctionObjArgs(s->encoder, obj, NULL);
+    if (encoded == NULL)
+        return -1;
+    if (!PyUnicode_Check(encoded)) {
+        PyErr_Format(PyExc_TypeError,
+                     "encoder() must return a string, not %.80s",
+                     Py_TYPE(encoded)->tp_name);
+        Py_DECREF(encoded);
+        return -1;
+    }
+    return _steal_write(writer, encoded);
 }
 
 static int
-_steal_accumulate(_PyAccu *acc, PyObject *stolen)
+encoder_write_long(PyEncoderObject *s, _JSONWriter *writer, PyObject *obj)
 {
-    /* Append stolen and then decrement its reference count */
-    int rval = _PyAccu_Accumulate(acc, stolen);
-    Py_DECREF(stolen);
-    return rval;
+    /* Write the JSON representation of an int, formatting the digits of
+       exact ints which fit in a C long long in place */
+    if (PyLong_CheckExact(obj)) {
+        char buf[sizeof(PY_LONG_LONG) * 3 + 2];
+        char *p = buf + sizeof(buf);
+        unsigned PY_LONG_LONG u;
+        int overflow;
+        PY_LONG_LONG v = PyLong_AsLongLongAndOverflow(obj, &overflow);
+
+        if (v == -1 && PyErr_Occurred())
+            return -1;
+        if (!overflow) {
+            u = v < 0 ? (unsigned PY_LONG_LONG)0 - v : (unsigned PY_LONG_LONG)v;
+            do {
+                *--p = '0' + (char)(u % 10);
+                u /= 10;
+            } while (u);
+            if (v < 0)
+                *--p = '-';
+            return json_writer_write(writer, p, buf + sizeof(buf) - p);
+        }
+    }
+    return _steal_write(writer, encoder_encode_long(s, obj));
+}
+
+static int
+encoder_write_float(PyEncoderObject *s, _JSONWriter *writer, PyObject *obj)
+{
+    /* Write the JSON representation of a float */
+    double x = PyFloat_AS_DOUBLE(obj);
+
+    if (PyFloat_CheckExact(obj) && Py_IS_FINITE(x)) {
+        /* Same format as float.__repr__() */
+        int rval;
+        char *buf = PyOS_double_to_string(x, 'r', 0, Py_DTSF_ADD_DOT_0, NULL);
+        if (buf == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        rval = json_writer_write(writer, buf, strlen(buf));
+        PyMem_Free(buf);
+        return rval;
+    }
+    return _steal_write(writer, encoder_encode_float(s, obj));
+}
+
+static int
+encoder_write_newline_indent(PyEncoderObject *s, _JSONWriter *writer,
+                             Py_ssize_t indent_level)
+{
+    /* Write '\n' + indent * indent_level */
+    Py_ssize_t i;
+
+    if (json_writer_write(writer, "\n", 1))
+        return -1;
+    for (i = 0; i < indent_level; i++) {
+        if (json_writer_write_unicode(writer, s->indent))
+            return -1;
+    }
+    return 0;
 }
 
 static int
-encoder_listencode_obj(PyEncoderObject *s, _PyAccu *acc,
+encoder_listencode_obj(PyEncoderObject *s, _JSONWriter *writer,
                        PyObject *obj, Py_ssize_t indent_level)
 {
     /* Encode Python object obj to a JSON term */
     PyObject *newobj;
     int rv;
 
-    if (obj == Py_None || obj == Py_True || obj == Py_False) {
-        PyObject *cstr = _encoded_const(obj);
-        if (cstr == NULL)
-            return -1;
-        return _steal_accumulate(acc, cstr);
+    if (obj == Py_None) {
+        return json_writer_write(writer, "null", 4);
     }
-    else if (PyUnicode_Check(obj))
-    {
-        PyObject *encoded = encoder_encode_string(s, obj);
-        if (encoded == NULL)
-            return -1;
-        return _steal_accumulate(acc, encoded);
+    else if (obj == Py_True) {
+        return json_writer_write(writer, "true", 4);
+    }
+    else if (obj == Py_False) {
+        return json_writer_write(writer, "false", 5);
+    }
+    else if (PyUnicode_Check(obj)) {
+        return encoder_write_string(s, writer, obj);
     }
     else if (PyLong_Check(obj)) {
-        PyObject *encoded = encoder_encode_long(s, obj);
-        if (encoded == NULL)
-            return -1;
-        return _steal_accumulate(acc, encoded);
+        return encoder_write_long(s, writer, obj);
     }
     else if (PyFloat_Check(obj)) {
-        PyObject *encoded = encoder_encode_float(s, obj);
-        if (encoded == NULL)
-            return -1;
-        return _steal_accumulate(acc, encoded);
+        return encoder_write_float(s, writer, obj);
     }
     else if (PyList_Check(obj) || PyTuple_Check(obj)) {
         if (Py_EnterRecursiveCall(" while encoding a JSON object"))
             return -1;
-        rv = encoder_listencode_list(s, acc, obj, indent_level);
+        rv = encoder_listencode_list(s, writer, obj, indent_level);
         Py_LeaveRecursiveCall();
         return rv;
     }
     else if (PyDict_Check(obj)) {
         if (Py_EnterRecursiveCall(" while encoding a JSON object"))
             return -1;
-        rv = encoder_listencode_dict(s, acc, obj, indent_level);
+        rv = encoder_listencode_dict(s, writer, obj, indent_level);
         Py_LeaveRecursiveCall();
         return rv;
     }
@@ -1460,7 +2697,7 @@ encoder_listencode_obj(PyEncoderObject *s, _PyAccu *acc,
 
         if (Py_EnterRecursiveCall(" while encoding a JSON object"))
             return -1;
-        rv = encoder_listencode_obj(s, acc, newobj, indent_level);
+        rv = encoder_listencode_obj(s, writer, newobj, indent_level);
         Py_LeaveRecursiveCall();
 
         Py_DECREF(newobj);
@@ -1480,13 +2717,10 @@ encoder_listencode_obj(PyEncoderObject *s, _PyAccu *acc,
 }
 
 static int
-encoder_listencode_dict(PyEncoderObject *s, _PyAccu *acc,
+encoder_listencode_dict(PyEncoderObject *s, _JSONWriter *writer,
                         PyObject *dct, Py_ssize_t indent_level)
 {
     /* Encode Python dict dct a JSON term */
-    static PyObject *open_dict = NULL;
-    static PyObject *close_dict = NULL;
-    static PyObject *empty_dict = NULL;
     PyObject *kstr = NULL;
     PyObject *ident = NULL;
     PyObject *it = NULL;
@@ -1495,15 +2729,8 @@ encoder_listencode_dict(PyEncoderObject *s, _PyAccu *acc,
     int skipkeys;
     Py_ssize_t idx;
 
-    if (open_dict == NULL || close_dict == NULL || empty_dict == NULL) {
-        open_dict = PyUnicode_InternFromString("{");
-        close_dict = PyUnicode_InternFromString("}");
-        empty_dict = PyUnicode_InternFromString("{}");
-        if (open_dict == NULL || close_dict == NULL || empty_dict == NULL)
-            return -1;
-    }
     if (Py_SIZE(dct) == 0)
-        return _PyAccu_Accumulate(acc, empty_dict);
+        return json_writer_write(writer, "{}", 2);
 
     if (s->markers != Py_None) {
         int has_key;
@@ -1521,17 +2748,13 @@ encoder_listencode_dict(PyEncoderObject *s, _PyAccu *acc,
         }
     }
 
-    if (_PyAccu_Accumulate(acc, open_dict))
+    if (json_writer_write(writer, "{", 1))
         goto bail;
 
     if (s->indent != Py_None) {
-        /* TODO: DOES NOT RUN */
         indent_level += 1;
-        /*
-            newline_indent = '\n' + (' ' * (_indent * _current_indent_level))
-            separator = _item_separator + newline_indent
-            buf += newline_indent
-        */
+        if (encoder_write_newline_indent(s, writer, indent_level))
+            goto bail;
     }
 
     if (PyObject_IsTrue(s->sort_keys)) {
@@ -1571,7 +2794,7 @@ encoder_listencode_dict(PyEncoderObject *s, _PyAccu *acc,
     skipkeys = PyObject_IsTrue(s->skipkeys);
     idx = 0;
     while ((item = PyIter_Next(it)) != NULL) {
-        PyObject *encoded, *key, *value;
+        PyObject *key, *value;
         if (!PyTuple_Check(item) || Py_SIZE(item) != 2) {
             PyErr_SetString(PyExc_ValueError, "items must return 2-tuples");
             goto bail;
@@ -1610,24 +2833,22 @@ encoder_listencode_dict(PyEncoderObject *s, _PyAccu *acc,
         }
 
         if (idx) {
-            if (_PyAccu_Accumulate(acc, s->item_separator))
+            if (json_writer_write_unicode(writer, s->item_separator))
                 goto bail;
+            if (s->indent != Py_None) {
+                if (encoder_write_newline_indent(s, writer, indent_level))
+                    goto bail;
+            }
         }
 
-        encoded = encoder_encode_string(s, kstr);
-        Py_CLEAR(kstr);
-        if (encoded == NULL)
-            goto bail;
-        if (_PyAccu_Accumulate(acc, encoded)) {
-            Py_DECREF(encoded);
+        if (encoder_write_string(s, writer, kstr))
             goto bail;
-        }
-        Py_DECREF(encoded);
-        if (_PyAccu_Accumulate(acc, s->key_separator))
+        Py_CLEAR(kstr);
+        if (json_writer_write_unicode(writer, s->key_separator))
             goto bail;
 
         value = PyTuple_GET_ITEM(item, 1);
-        if (encoder_listencode_obj(s, acc, value, indent_level))
+        if (encoder_listencode_obj(s, writer, value, indent_level))
             goto bail;
         idx += 1;
         Py_DECREF(item);
@@ -1641,13 +2862,12 @@ encoder_listencode_dict(PyEncoderObject *s, _PyAccu *acc,
             goto bail;
         Py_CLEAR(ident);
     }
-    /* TODO DOES NOT RUN; dead code
     if (s->indent != Py_None) {
         indent_level -= 1;
-
-        yield '\n' + (' ' * (_indent * _current_indent_level))
-    }*/
-    if (_PyAccu_Accumulate(acc, close_dict))
+        if (encoder_write_newline_indent(s, writer, indent_level))
+            goto bail;
+    }
+    if (json_writer_write(writer, "}", 1))
         goto bail;
     return 0;
 
@@ -1661,31 +2881,21 @@ bail:
 
 
 static int
-encoder_listencode_list(PyEncoderObject *s, _PyAccu *acc,
+encoder_listencode_list(PyEncoderObject *s, _JSONWriter *writer,
                         PyObject *seq, Py_ssize_t indent_level)
 {
     /* Encode Python list seq to a JSON term */
-    static PyObject *open_array = NULL;
-    static PyObject *close_array = NULL;
-    static PyObject *empty_array = NULL;
     PyObject *ident = NULL;
     PyObject *s_fast = NULL;
     Py_ssize_t i;
 
-    if (open_array == NULL || close_array == NULL || empty_array == NULL) {
-        open_array = PyUnicode_InternFromString("[");
-        close_array = PyUnicode_InternFromString("]");
-        empty_array = PyUnicode_InternFromString("[]");
-        if (open_array == NULL || close_array == NULL || empty_array == NULL)
-            return -1;
-    }
     ident = NULL;
     s_fast = PySequence_Fast(seq, "_iterencode_list needs a sequence");
     if (s_fast == NULL)
         return -1;
     if (PySequence_Fast_GET_SIZE(s_fast) == 0) {
         Py_DECREF(s_fast);
-        return _PyAccu_Accumulate(acc, empty_array);
+        return json_writer_write(writer, "[]", 2);
     }
 
     if (s->markers != Py_None) {
@@ -1704,24 +2914,24 @@ encoder_listencode_list(PyEncoderObject *s, _PyAccu *acc,
         }
     }
 
-    if (_PyAccu_Accumulate(acc, open_array))
+    if (json_writer_write(writer, "[", 1))
         goto bail;
     if (s->indent != Py_None) {
-        /* TODO: DOES NOT RUN */
         indent_level += 1;
-        /*
-            newline_indent = '\n' + (' ' * (_indent * _current_indent_level))
-            separator = _item_separator + newline_indent
-            buf += newline_indent
-        */
+        if (encoder_write_newline_indent(s, writer, indent_level))
+            goto bail;
     }
     for (i = 0; i < PySequence_Fast_GET_SIZE(s_fast); i++) {
         PyObject *obj = PySequence_Fast_GET_ITEM(s_fast, i);
         if (i) {
-            if (_PyAccu_Accumulate(acc, s->item_separator))
+            if (json_writer_write_unicode(writer, s->item_separator))
                 goto bail;
+            if (s->indent != Py_None) {
+                if (encoder_write_newline_indent(s, writer, indent_level))
+                    goto bail;
+            }
         }
-        if (encoder_listencode_obj(s, acc, obj, indent_level))
+        if (encoder_listencode_obj(s, writer, obj, indent_level))
             goto bail;
     }
     if (ident != NULL) {
@@ -1730,13 +2940,12 @@ encoder_listencode_list(PyEncoderObject *s, _PyAccu *acc,
         Py_CLEAR(ident);
     }
 
-    /* TODO: DOES NOT RUN
     if (s->indent != Py_None) {
         indent_level -= 1;
-
-        yield '\n' + (' ' * (_indent * _current_indent_level))
-    }*/
-    if (_PyAccu_Accumulate(acc, close_array))
+        if (encoder_write_newline_indent(s, writer, indent_level))
+            goto bail;
+    }
+    if (json_writer_write(writer, "]", 1))
         goto bail;
     Py_DECREF(s_fast);
     return 0;
@@ -1790,6 +2999,12 @@ encoder_clear(PyObject *self)
     return 0;
 }
 
+static PyMethodDef encoder_methods[] = {
+    {"encode_bytes", (PyCFunction)encoder_encode_bytes, METH_O,
+        encoder_encode_bytes_doc},
+    {NULL, NULL}
+};
+
 PyDoc_STRVAR(encoder_doc, "_iterencode(obj, _current_indent_level) -> iterable");
 
 static
@@ -1821,7 +3036,7 @@ PyTypeObject PyEncoderType = {
     0,                    /* tp_weaklistoffset */
     0,                    /* tp_iter */
     0,                    /* tp_iternext */
-    0,                    /* tp_methods */
+    encoder_methods,      /* tp_methods */
     encoder_members,      /* tp_members */
     0,                    /* tp_getset */
     0,                    /* tp_base */
@@ -1840,6 +3055,10 @@ static PyMethodDef speedups_methods[] = {
         (PyCFunction)py_encode_basestring_ascii,
         METH_O,
         pydoc_encode_basestring_ascii},
+    {"encode_basestring",
+        (PyCFunction)py_encode_basestring,
+        METH_O,
+        pydoc_encode_basestring},
     {"scanstring",
         (PyCFunction)py_scanstring,
         METH_VARARGS,
@@ -1874,6 +3093,8 @@ PyInit__json(void)
     PyEncoderType.tp_new = PyType_GenericNew;
     if (PyType_Ready(&PyEncoderType) < 0)
         goto fail;
+    if (PyType_Ready(&PyStreamParserType) < 0)
+        goto fail;
     Py_INCREF((PyObject*)&PyScannerType);
     if (PyModule_AddObject(m, "make_scanner", (PyObject*)&PyScannerType) < 0) {
         Py_DECREF((PyObject*)&PyScannerType);
@@ -1884,6 +3105,11 @@ PyInit__json(void)
         Py_DECREF((PyObject*)&PyEncoderType);
         goto fail;
     }
+    Py_INCREF((PyObject*)&PyStreamParserType);
+    if (PyModule_AddObject(m, "make_stream_parser", (PyObject*)&PyStreamParserType) < 0) {
+        Py_DECREF((PyObject*)&PyStreamParserType);
+        goto fail;
+    }
     return m;
   fail:
     Py_DECREF(m);
@@ -18,6 +18,11 @@
 
 #include <lzma.h>
 
+/* liblzma 5.2 added the multi-threaded .xz encoder */
+#if LZMA_VERSION >= 50020002
+#define HAVE_LZMA_MT 1
+#endif
+
 
 #ifndef PY_LONG_LONG
 #error "This module requires PY_LONG_LONG to be defined"
@@ -66,6 +71,7 @@ typedef struct {
     int check;
     char eof;
     PyObject *unused_data;
+    PyObject *unconsumed_tail;
 #ifdef WITH_THREAD
     PyThread_type_lock lock;
 #endif
@@ -612,9 +618,37 @@ Compressor_getstate(Compressor *self, PyObject *noargs)
 
 static int
 Compressor_init_xz(lzma_stream *lzs, int check, uint32_t preset,
-                   PyObject *filterspecs)
+                   PyObject *filterspecs, uint32_t threads)
 {
     lzma_ret lzret;
+#ifdef HAVE_LZMA_MT
+    lzma_mt mt;
+
+    if (threads == 0)
+        threads = lzma_cputhreads();
+    if (threads > 1) {
+        /* The input is cut into blocks compressed independently by a
+           pool of threads, the output is still a single .xz stream. */
+        lzma_filter filters[LZMA_FILTERS_MAX + 1];
+
+        memset(&mt, 0, sizeof(mt));
+        mt.threads = threads;
+        mt.check = check;
+        if (filterspecs == Py_None) {
+            mt.preset = preset;
+            lzret = lzma_stream_encoder_mt(lzs, &mt);
+        } else {
+            if (parse_filter_chain_spec(filters, filterspecs) == -1)
+                return -1;
+            mt.filters = filters;
+            lzret = lzma_stream_encoder_mt(lzs, &mt);
+            free_filter_chain(filters);
+        }
+        if (catch_lzma_error(lzret))
+            return -1;
+        return 0;
+    }
+#endif
 
     if (filterspecs == Py_None) {
         lzret = lzma_easy_encoder(lzs, preset, check);
@@ -710,6 +744,10 @@ _lzma.LZMACompressor.__init__
         have an entry for "id" indicating the ID of the filter, plus
         additional entries for options to the filter.
 
+    threads: int = 1
+        The number of threads compressing the data, or 0 for one per
+        CPU.  Only FORMAT_XZ supports more than one thread.
+
 Create a compressor object for compressing data incrementally.
 
 The settings used by the compressor can be specified either as a
@@ -724,18 +762,33 @@ For one-shot compression, use the compress() function instead.
 static int
 Compressor_init(Compressor *self, PyObject *args, PyObject *kwargs)
 {
-    static char *arg_names[] = {"format", "check", "preset", "filters", NULL};
+    static char *arg_names[] = {"format", "check", "preset", "filters",
+                                "threads", NULL};
     int format = FORMAT_XZ;
     int check = -1;
     uint32_t preset = LZMA_PRESET_DEFAULT;
     PyObject *preset_obj = Py_None;
     PyObject *filterspecs = Py_None;
+    int threads = 1;
 
     if (!PyArg_ParseTupleAndKeywords(args, kwargs,
-                                     "|iiOO:LZMACompressor", arg_names,
+                                     "|iiOOi:LZMACompressor", arg_names,
                                      &format, &check, &preset_obj,
-                                     &filterspecs))
+                                     &filterspecs, &threads))
+        return -1;
+
+    if (threads < 0) {
+        PyErr_SetString(PyExc_ValueError, "threads must not be negative");
+        return -1;
+    }
+
+    /* 0 asks for one thread per CPU, which is a single thread for the
+       formats without a multi-threaded encoder. */
+    if (format != FORMAT_XZ && threads > 1) {
+        PyErr_SetString(PyExc_ValueError,
+                        "Only FORMAT_XZ supports several threads");
         return -1;
+    }
 
     if (format != FORMAT_XZ && check != -1 && check != LZMA_CHECK_NONE) {
         PyErr_SetString(PyExc_ValueError,
@@ -771,7 +824,8 @@ Compressor_init(Compressor *self, PyObject *args, PyObject *kwargs)
         case FORMAT_XZ:
             if (check == -1)
                 check = LZMA_CHECK_CRC64;
-            if (Compressor_init_xz(&self->lzs, check, preset, filterspecs) != 0)
+            if (Compressor_init_xz(&self->lzs, check, preset, filterspecs,
+                                   (uint32_t)threads) != 0)
                 break;
             return 0;
 
@@ -817,7 +871,8 @@ static PyMethodDef Compressor_methods[] = {
 };
 
 PyDoc_STRVAR(Compressor_doc,
-"LZMACompressor(format=FORMAT_XZ, check=-1, preset=None, filters=None)\n"
+"LZMACompressor(format=FORMAT_XZ, check=-1, preset=None, filters=None,\n"
+"               threads=1)\n"
 "\n"
 "Create a compressor object for compressing data incrementally.\n"
 "\n"
@@ -842,6 +897,10 @@ PyDoc_STRVAR(Compressor_doc,
 "have an entry for \"id\" indicating the ID of the filter, plus\n"
 "additional entries for options to the filter.\n"
 "\n"
+"threads is the number of threads compressing the data, or 0 for one\n"
+"per CPU. With more than one thread, FORMAT_XZ data is cut into blocks\n"
+"compressed in parallel. Other formats only support one thread.\n"
+"\n"
 "For one-shot compression, use the compress() function instead.\n");
 
 static PyTypeObject Compressor_type = {
@@ -941,6 +1000,55 @@ error:
     return NULL;
 }
 
+/* Decompress data into the caller's buffer, keeping the input which did not
+   fit in d->unconsumed_tail.  Returns the number of bytes written. */
+static PyObject *
+decompress_into(Decompressor *d, uint8_t *data, size_t len, Py_buffer *buffer)
+{
+    PyObject *tail;
+
+    d->lzs.next_in = data;
+    d->lzs.avail_in = len;
+    d->lzs.next_out = buffer->buf;
+    d->lzs.avail_out = buffer->len;
+    while (d->lzs.avail_out > 0) {
+        lzma_ret lzret;
+
+        Py_BEGIN_ALLOW_THREADS
+        lzret = lzma_code(&d->lzs, LZMA_RUN);
+        Py_END_ALLOW_THREADS
+        /* LZMA_BUF_ERROR only means that no more output can be produced
+           from the input given so far */
+        if (lzret == LZMA_BUF_ERROR)
+            break;
+        if (catch_lzma_error(lzret))
+            return NULL;
+        if (lzret == LZMA_GET_CHECK || lzret == LZMA_NO_CHECK)
+            d->check = lzma_get_check(&d->lzs);
+        if (lzret == LZMA_STREAM_END) {
+            d->eof = 1;
+            if (d->lzs.avail_in > 0) {
+                Py_CLEAR(d->unused_data);
+                d->unused_data = PyBytes_FromStringAndSize(
+                        (char *)d->lzs.next_in, d->lzs.avail_in);
+                if (d->unused_data == NULL)
+                    return NULL;
+                d->lzs.avail_in = 0;
+            }
+            break;
+        } else if (d->lzs.avail_in == 0) {
+            break;
+        }
+    }
+    /* Save the input left over once the buffer is full */
+    tail = PyBytes_FromStringAndSize((char *)d->lzs.next_in, d->lzs.avail_in);
+    if (tail == NULL)
+        return NULL;
+    Py_DECREF(d->unconsumed_tail);
+    d->unconsumed_tail = tail;
+    return PyLong_FromSsize_t((char *)d->lzs.next_out - (char *)buffer->buf);
+}
+
 /*[clinic input]
 _lzma.LZMADecompressor.decompress
 
@@ -972,6 +1080,38 @@ _lzma_LZMADecompressor_decompress_impl(Decompressor *self, Py_buffer *data)
     return result;
 }
 
+/*[clinic input]
+_lzma.LZMADecompressor.decompress_into
+
+    self: self(type="Decompressor *")
+    data: Py_buffer
+    buffer: Py_buffer(types='bytearray rwbuffer')
+    /
+
+Decompress data into buffer and return the number of bytes written.
+
+No bytes object is created for the output.  Once buffer is full, the input
+data left over is saved in the unconsumed_tail attribute and must be passed
+again to a later call.  More output may be pending even when unconsumed_tail
+is empty, so call this method again with b'' until it does not fill buffer
+or the end of stream is reached.
+[clinic start generated code]*/
+
+static PyObject *
+_lzma_LZMADecompressor_decompress_into_impl(Decompressor *self, Py_buffer *data, Py_buffer *buffer)
+/*[clinic end generated code: output=36bbed48a6399eb8 input=370f40b958250e6c]*/
+{
+    PyObject *result = NULL;
+
+    ACQUIRE_LOCK(self);
+    if (self->eof)
+        PyErr_SetString(PyExc_EOFError, "Already at end of stream");
+    else
+        result = decompress_into(self, data->buf, data->len, buffer);
+    RELEASE_LOCK(self);
+    return result;
+}
+
 static PyObject *
 Decompressor_getstate(Decompressor *self, PyObject *noargs)
 {
@@ -1068,6 +1208,9 @@ _lzma_LZMADecompressor___init___impl(Decompressor *self, int format, PyObject *m
     self->unused_data = PyBytes_FromStringAndSize(NULL, 0);
     if (self->unused_data == NULL)
         goto error;
+    self->unconsumed_tail = PyBytes_FromStringAndSize(NULL, 0);
+    if (self->unconsumed_tail == NULL)
+        goto error;
 
     switch (format) {
         case FORMAT_AUTO:
@@ -1103,6 +1246,7 @@ _lzma_LZMADecompressor___init___impl(Decompressor *self, int format, PyObject *m
 
 error:
     Py_CLEAR(self->unused_data);
+    Py_CLEAR(self->unconsumed_tail);
 #ifdef WITH_THREAD
     PyThread_free_lock(self->lock);
     self->lock = NULL;
@@ -1115,6 +1259,7 @@ Decompressor_dealloc(Decompressor *self)
 {
     lzma_end(&self->lzs);
     Py_CLEAR(self->unused_data);
+    Py_CLEAR(self->unconsumed_tail);
 #ifdef WITH_THREAD
     if (self->lock != NULL)
         PyThread_free_lock(self->lock);
@@ -1124,6 +1269,7 @@ Decompressor_dealloc(Decompressor *self)
 
 static PyMethodDef Decompressor_methods[] = {
     _LZMA_LZMADECOMPRESSOR_DECOMPRESS_METHODDEF
+    _LZMA_LZMADECOMPRESSOR_DECOMPRESS_INTO_METHODDEF
     {"__getstate__", (PyCFunction)Decompressor_getstate, METH_NOARGS},
     {NULL}
 };
@@ -1137,6 +1283,9 @@ PyDoc_STRVAR(Decompressor_eof_doc,
 PyDoc_STRVAR(Decompressor_unused_data_doc,
 "Data found after the end of the compressed stream.");
 
+PyDoc_STRVAR(Decompressor_unconsumed_tail_doc,
+"Data left over by the last decompress_into() call, which filled its buffer.");
+
 static PyMemberDef Decompressor_members[] = {
     {"check", T_INT, offsetof(Decompressor, check), READONLY,
      Decompressor_check_doc},
@@ -1144,6 +1293,8 @@ static PyMemberDef Decompressor_members[] = {
      Decompressor_eof_doc},
     {"unused_data", T_OBJECT_EX, offsetof(Decompressor, unused_data), READONLY,
      Decompressor_unused_data_doc},
+    {"unconsumed_tail", T_OBJECT_EX, offsetof(Decompressor, unconsumed_tail),
+     READONLY, Decompressor_unconsumed_tail_doc},
     {NULL}
 };
 
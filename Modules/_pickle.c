@@ -1,5 +1,8 @@
 #include "Python.h"
 #include "structmember.h"
+#ifdef WITH_THREAD
+#include "pythread.h"
+#endif
 
 PyDoc_STRVAR(pickle_module_doc,
 "Optimized C implementation for the Python pickle module.");
@@ -11,12 +14,13 @@ class _pickle.Pickler "PicklerObject *" "&Pickler_Type"
 class _pickle.PicklerMemoProxy "PicklerMemoProxyObject *" "&PicklerMemoProxyType"
 class _pickle.Unpickler "UnpicklerObject *" "&Unpickler_Type"
 class _pickle.UnpicklerMemoProxy "UnpicklerMemoProxyObject *" "&UnpicklerMemoProxyType"
+class _pickle.PickleBuffer "PickleBufferObject *" "&PickleBuffer_Type"
 [clinic start generated code]*/
-/*[clinic end generated code: output=da39a3ee5e6b4b0d input=11c45248a41dd3fc]*/
+/*[clinic end generated code: output=da39a3ee5e6b4b0d input=7c77e18bc095bafd]*/
 
 /* Bump this when new opcodes are added to the pickle protocol. */
 enum {
-    HIGHEST_PROTOCOL = 4,
+    HIGHEST_PROTOCOL = 5,
     DEFAULT_PROTOCOL = 3
 };
 
@@ -93,7 +97,12 @@ enum opcode {
     NEWOBJ_EX        = '\x92',
     STACK_GLOBAL     = '\x93',
     MEMOIZE          = '\x94',
-    FRAME            = '\x95'
+    FRAME            = '\x95',
+
+    /* Protocol 5 */
+    BYTEARRAY8       = '\x96',
+    NEXT_BUFFER      = '\x97',
+    READONLY_BUFFER  = '\x98'
 };
 
 enum {
@@ -522,6 +531,8 @@ typedef struct {
     Py_ssize_t mt_used;
     Py_ssize_t mt_allocated;
     PyMemoEntry *mt_table;
+    PyObject *mt_miss_key;      /* Key of the last failed lookup, or NULL */
+    PyMemoEntry *mt_miss_entry; /* Free slot where mt_miss_key belongs */
 } PyMemoTable;
 
 typedef struct PicklerObject {
@@ -555,6 +566,8 @@ typedef struct PicklerObject {
     int fix_imports;            /* Indicate whether Pickler should fix
                                    the name of globals for Python 2.x. */
     PyObject *fast_memo;
+    PyObject *buffer_callback;  /* Callable for out-of-band buffers, or NULL
+                                   to serialize all buffers in-band. */
 } PicklerObject;
 
 typedef struct UnpicklerObject {
@@ -579,6 +592,10 @@ typedef struct UnpicklerObject {
     PyObject *read;             /* read() method of the input stream. */
     PyObject *readline;         /* readline() method of the input stream. */
     PyObject *peek;             /* peek() method of the input stream, or NULL */
+    PyObject *readinto;         /* readinto() method of the input stream, or
+                                   NULL */
+    PyObject *buffers;          /* Iterator over the out-of-band buffers, or
+                                   NULL if none were given. */
 
     char *encoding;             /* Name of the encoding to be used for
                                    decoding strings pickled using Python
@@ -611,17 +628,254 @@ static int save_reduce(PicklerObject *, PyObject *, PyObject *);
 static PyTypeObject Pickler_Type;
 static PyTypeObject Unpickler_Type;
 
+/* PickleBuffer: a wrapper around an object supporting the buffer protocol,
+   which asks protocol 5 picklers to serialize the buffer out-of-band. */
+
+typedef struct {
+    PyObject_HEAD
+    /* The view exported by the original object, view.obj is NULL once
+       released */
+    Py_buffer view;
+    PyObject *weakreflist;
+} PickleBufferObject;
+
+static PyTypeObject PickleBuffer_Type;
+
+#define PickleBuffer_Check(op) (Py_TYPE(op) == &PickleBuffer_Type)
+
+/* Return the view of a PickleBuffer, or NULL with an exception set if it
+   was released. */
+static Py_buffer *
+PickleBuffer_GetView(PickleBufferObject *self)
+{
+    if (self->view.obj == NULL) {
+        PyErr_SetString(PyExc_ValueError,
+                        "operation forbidden on released PickleBuffer object");
+        return NULL;
+    }
+    return &self->view;
+}
+
 #include "clinic/_pickle.c.h"
 
+/*************************************************************************/
+/* PickleBuffer type */
+
+/*[clinic input]
+@classmethod
+_pickle.PickleBuffer.__new__ as PickleBuffer_new
+
+  buffer: object
+
+Wrapper for potentially out-of-band buffers.
+[clinic start generated code]*/
+
+static PyObject *
+PickleBuffer_new_impl(PyTypeObject *type, PyObject *buffer)
+/*[clinic end generated code: output=78961d111d01cd2e input=bb1b01490659a0ad]*/
+{
+    PickleBufferObject *self;
+
+    self = PyObject_GC_New(PickleBufferObject, type);
+    if (self == NULL)
+        return NULL;
+    self->view.obj = NULL;
+    self->weakreflist = NULL;
+    if (PyObject_GetBuffer(buffer, &self->view, PyBUF_FULL_RO) < 0) {
+        Py_DECREF(self);
+        return NULL;
+    }
+    PyObject_GC_Track(self);
+    return (PyObject *)self;
+}
+
+static void
+PickleBuffer_dealloc(PickleBufferObject *self)
+{
+    PyObject_GC_UnTrack(self);
+    if (self->weakreflist != NULL)
+        PyObject_ClearWeakRefs((PyObject *)self);
+    PyBuffer_Release(&self->view);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static int
+PickleBuffer_traverse(PickleBufferObject *self, visitproc visit, void *arg)
+{
+    Py_VISIT(self->view.obj);
+    return 0;
+}
+
+static int
+PickleBuffer_clear(PickleBufferObject *self)
+{
+    PyBuffer_Release(&self->view);
+    return 0;
+}
+
+static int
+PickleBuffer_getbuffer(PickleBufferObject *self, Py_buffer *view, int flags)
+{
+    if (PickleBuffer_GetView(self) == NULL)
+        return -1;
+    /* Export the original object's buffer directly, with the requested
+       flags. */
+    return PyObject_GetBuffer(self->view.obj, view, flags);
+}
+
+static PyBufferProcs PickleBuffer_as_buffer = {
+    (getbufferproc)PickleBuffer_getbuffer,
+    NULL,
+};
+
+/*[clinic input]
+_pickle.PickleBuffer.raw
+
+Return a memoryview of the raw memory underlying this buffer.
+
+The memoryview has format 'B' and one dimension.  BufferError is
+raised if the buffer is not contiguous.
+[clinic start generated code]*/
+
+static PyObject *
+_pickle_PickleBuffer_raw_impl(PickleBufferObject *self)
+/*[clinic end generated code: output=c78b3fd04355aba5 input=267616216c8c5eff]*/
+{
+    PyObject *m;
+    PyMemoryViewObject *mv;
+    Py_buffer *view = PickleBuffer_GetView(self);
+
+    if (view == NULL)
+        return NULL;
+    if (view->suboffsets != NULL || !PyBuffer_IsContiguous(view, 'A')) {
+        PyErr_SetString(PyExc_BufferError,
+                        "cannot extract raw buffer from non-contiguous "
+                        "buffer");
+        return NULL;
+    }
+    m = PyMemoryView_FromObject((PyObject *)self);
+    if (m == NULL)
+        return NULL;
+    /* Turn the memoryview into a one-dimensional view of bytes */
+    mv = (PyMemoryViewObject *)m;
+    assert(mv->view.suboffsets == NULL);
+    mv->view.format = "B";
+    mv->view.ndim = 1;
+    mv->view.itemsize = 1;
+    mv->view.shape = &mv->view.len;
+    mv->view.strides = &mv->view.itemsize;
+    mv->flags = _Py_MEMORYVIEW_C | _Py_MEMORYVIEW_FORTRAN;
+    return m;
+}
+
+/*[clinic input]
+_pickle.PickleBuffer.release
+
+Release the underlying buffer exposed by the PickleBuffer object.
+[clinic start generated code]*/
+
+static PyObject *
+_pickle_PickleBuffer_release_impl(PickleBufferObject *self)
+/*[clinic end generated code: output=cc7900aaba67e761 input=b9a5e91e3bdd0dc7]*/
+{
+    PyBuffer_Release(&self->view);
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef PickleBuffer_methods[] = {
+    _PICKLE_PICKLEBUFFER_RAW_METHODDEF
+    _PICKLE_PICKLEBUFFER_RELEASE_METHODDEF
+    {NULL, NULL}
+};
+
+static PyTypeObject PickleBuffer_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "pickle.PickleBuffer",              /*tp_name*/
+    sizeof(PickleBufferObject),         /*tp_basicsize*/
+    0,                                  /*tp_itemsize*/
+    (destructor)PickleBuffer_dealloc,   /*tp_dealloc*/
+    0,                                  /*tp_print*/
+    0,                                  /*tp_getattr*/
+    0,                                  /*tp_setattr*/
+    0,                                  /*tp_reserved*/
+    0,                                  /*tp_repr*/
+    0,                                  /*tp_as_number*/
+    0,                                  /*tp_as_sequence*/
+    0,                                  /*tp_as_mapping*/
+    0,                                  /*tp_hash*/
+    0,                                  /*tp_call*/
+    0,                                  /*tp_str*/
+    0,                                  /*tp_getattro*/
+    0,                                  /*tp_setattro*/
+    &PickleBuffer_as_buffer,            /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC, /*tp_flags*/
+    PickleBuffer_new__doc__,            /*tp_doc*/
+    (traverseproc)PickleBuffer_traverse, /*tp_traverse*/
+    (inquiry)PickleBuffer_clear,        /*tp_clear*/
+    0,                                  /*tp_richcompare*/
+    offsetof(PickleBufferObject, weakreflist), /*tp_weaklistoffset*/
+    0,                                  /*tp_iter*/
+    0,                                  /*tp_iternext*/
+    PickleBuffer_methods,               /*tp_methods*/
+    0,                                  /*tp_members*/
+    0,                                  /*tp_getset*/
+    0,                                  /*tp_base*/
+    0,                                  /*tp_dict*/
+    0,                                  /*tp_descr_get*/
+    0,                                  /*tp_descr_set*/
+    0,                                  /*tp_dictoffset*/
+    0,                                  /*tp_init*/
+    0,                                  /*tp_alloc*/
+    PickleBuffer_new,                   /*tp_new*/
+};
+
+
 /*************************************************************************
  A custom hashtable mapping void* to Python ints. This is used by the pickler
  for memoization. Using a custom hashtable rather than PyDict allows us to skip
  a bunch of unnecessary object creation. This makes a huge performance
- difference. */
+ difference.
+
+ The table uses open addressing with linear probing: consecutive probes stay
+ in the same cache lines, and since entries are never deleted, a lookup can
+ stop at the first free slot.  Object addresses are strongly patterned (they
+ are aligned, and objects of the same type tend to be allocated at regular
+ intervals), so they are scrambled with a multiplicative hash before being
+ reduced to a table index.
+
+ Nearly every object is looked up before it is pickled and inserted right
+ after, without any other insertion in between for atoms such as strings.
+ The table remembers where the last failed lookup stopped, so that the
+ following PyMemoTable_Set() for the same key does not need to probe
+ again. */
 
 #define MT_MINSIZE 8
-#define PERTURB_SHIFT 5
 
+#if SIZEOF_SIZE_T > 4
+#  define MT_HASH_MULTIPLIER ((size_t)0x9E3779B97F4A7C15ULL)
+#else
+#  define MT_HASH_MULTIPLIER ((size_t)0x9E3779B9UL)
+#endif
+
+/* The low bits of a pointer are always zero, and multiplication only
+   propagates bits upwards: fold the high half of the product back into
+   the low bits used as the table index. */
+Py_LOCAL_INLINE(size_t)
+_PyMemoTable_Hash(PyObject *key)
+{
+    size_t h = ((size_t)key >> 3) * MT_HASH_MULTIPLIER;
+    return h ^ (h >> (SIZEOF_SIZE_T * 4));
+}
+
+/* Hint the CPU to fetch the slot where key would be stored.  This is only
+   a hint: the table may be resized before the slot is accessed. */
+#if defined(__GNUC__) && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 1))
+#  define MT_PREFETCH(self, key) \
+    __builtin_prefetch(&(self)->mt_table[ \
+        _PyMemoTable_Hash(key) & (size_t)(self)->mt_mask])
+#else
+#  define MT_PREFETCH(self, key) ((void)0)
+#endif
 
 static PyMemoTable *
 PyMemoTable_New(void)
@@ -635,6 +889,8 @@ PyMemoTable_New(void)
     memo->mt_used = 0;
     memo->mt_allocated = MT_MINSIZE;
     memo->mt_mask = MT_MINSIZE - 1;
+    memo->mt_miss_key = NULL;
+    memo->mt_miss_entry = NULL;
     memo->mt_table = PyMem_MALLOC(MT_MINSIZE * sizeof(PyMemoEntry));
     if (memo->mt_table == NULL) {
         PyMem_FREE(memo);
@@ -690,6 +946,8 @@ PyMemoTable_Clear(PyMemoTable *self)
         Py_XDECREF(self->mt_table[i].me_key);
     }
     self->mt_used = 0;
+    self->mt_miss_key = NULL;
+    self->mt_miss_entry = NULL;
     memset(self->mt_table, 0, self->mt_allocated * sizeof(PyMemoEntry));
     return 0;
 }
@@ -707,29 +965,44 @@ PyMemoTable_Del(PyMemoTable *self)
 
 /* Since entries cannot be deleted from this hashtable, _PyMemoTable_Lookup()
    can be considerably simpler than dictobject.c's lookdict(). */
-static PyMemoEntry *
+Py_LOCAL_INLINE(PyMemoEntry *)
 _PyMemoTable_Lookup(PyMemoTable *self, PyObject *key)
 {
-    size_t i;
-    size_t perturb;
     size_t mask = (size_t)self->mt_mask;
+    size_t i = _PyMemoTable_Hash(key) & mask;
     PyMemoEntry *table = self->mt_table;
     PyMemoEntry *entry;
-    Py_hash_t hash = (Py_hash_t)key >> 3;
-
-    i = hash & mask;
-    entry = &table[i];
-    if (entry->me_key == NULL || entry->me_key == key)
-        return entry;
 
-    for (perturb = hash; ; perturb >>= PERTURB_SHIFT) {
-        i = (i << 2) + i + perturb + 1;
-        entry = &table[i & mask];
-        if (entry->me_key == NULL || entry->me_key == key)
+    for (;;) {
+        entry = &table[i];
+        if (entry->me_key == key || entry->me_key == NULL)
             return entry;
+        i = (i + 1) & mask;
+    }
+}
+
+/* Move the mt_used entries of oldtable to the new, empty mt_table in one
+   pass.  The keys are known to be distinct, so there is no need to compare
+   them: just find a free slot. */
+static void
+_PyMemoTable_MoveEntries(PyMemoTable *self, PyMemoEntry *oldtable)
+{
+    PyMemoEntry *oldentry, *newentry;
+    PyMemoEntry *newtable = self->mt_table;
+    size_t mask = (size_t)self->mt_mask;
+    Py_ssize_t to_process = self->mt_used;
+
+    for (oldentry = oldtable; to_process > 0; oldentry++) {
+        if (oldentry->me_key != NULL) {
+            size_t i = _PyMemoTable_Hash(oldentry->me_key) & mask;
+            to_process--;
+            while (newtable[i].me_key != NULL)
+                i = (i + 1) & mask;
+            newentry = &newtable[i];
+            newentry->me_key = oldentry->me_key;
+            newentry->me_value = oldentry->me_value;
+        }
     }
-    assert(0);  /* Never reached */
-    return NULL;
 }
 
 /* Returns -1 on failure, 0 on success. */
@@ -737,9 +1010,8 @@ static int
 _PyMemoTable_ResizeTable(PyMemoTable *self, Py_ssize_t min_size)
 {
     PyMemoEntry *oldtable = NULL;
-    PyMemoEntry *oldentry, *newentry;
+    PyMemoEntry *newtable;
     Py_ssize_t new_size = MT_MINSIZE;
-    Py_ssize_t to_process;
 
     assert(min_size > 0);
 
@@ -755,29 +1027,19 @@ _PyMemoTable_ResizeTable(PyMemoTable *self, Py_ssize_t min_size)
 
     /* Allocate new table. */
     oldtable = self->mt_table;
-    self->mt_table = PyMem_MALLOC(new_size * sizeof(PyMemoEntry));
-    if (self->mt_table == NULL) {
-        self->mt_table = oldtable;
+    newtable = PyMem_MALLOC(new_size * sizeof(PyMemoEntry));
+    if (newtable == NULL) {
         PyErr_NoMemory();
         return -1;
     }
+    memset(newtable, 0, sizeof(PyMemoEntry) * new_size);
+    self->mt_table = newtable;
     self->mt_allocated = new_size;
     self->mt_mask = new_size - 1;
-    memset(self->mt_table, 0, sizeof(PyMemoEntry) * new_size);
+    self->mt_miss_key = NULL;
+    self->mt_miss_entry = NULL;
 
-    /* Copy entries from the old table. */
-    to_process = self->mt_used;
-    for (oldentry = oldtable; to_process > 0; oldentry++) {
-        if (oldentry->me_key != NULL) {
-            to_process--;
-            /* newentry is a pointer to a chunk of the new
-               mt_table, so we're setting the key:value pair
-               in-place. */
-            newentry = _PyMemoTable_Lookup(self, oldentry->me_key);
-            newentry->me_key = oldentry->me_key;
-            newentry->me_value = oldentry->me_value;
-        }
-    }
+    _PyMemoTable_MoveEntries(self, oldtable);
 
     /* Deallocate the old table. */
     PyMem_FREE(oldtable);
@@ -789,8 +1051,11 @@ static Py_ssize_t *
 PyMemoTable_Get(PyMemoTable *self, PyObject *key)
 {
     PyMemoEntry *entry = _PyMemoTable_Lookup(self, key);
-    if (entry->me_key == NULL)
+    if (entry->me_key == NULL) {
+        self->mt_miss_key = key;
+        self->mt_miss_entry = entry;
         return NULL;
+    }
     return &entry->me_value;
 }
 
@@ -802,18 +1067,26 @@ PyMemoTable_Set(PyMemoTable *self, PyObject *key, Py_ssize_t value)
 
     assert(key != NULL);
 
-    entry = _PyMemoTable_Lookup(self, key);
-    if (entry->me_key != NULL) {
-        entry->me_value = value;
-        return 0;
+    /* If the last lookup failed for the same key and its free slot has not
+       been taken since, the key still belongs there: keys are never
+       deleted, so the probe sequence leading to the slot is unchanged. */
+    entry = self->mt_miss_entry;
+    if (key != self->mt_miss_key || entry->me_key != NULL) {
+        entry = _PyMemoTable_Lookup(self, key);
+        if (entry->me_key != NULL) {
+            entry->me_value = value;
+            return 0;
+        }
     }
+    self->mt_miss_key = NULL;
     Py_INCREF(key);
     entry->me_key = key;
     entry->me_value = value;
     self->mt_used++;
 
     /* If we added a key, we can safely resize. Otherwise just return!
-     * If used >= 2/3 size, adjust size. Normally, this quaduples the size.
+     * Linear probing degrades quickly when the table gets crowded: if
+     * used >= 1/2 size, quadruple the size.
      *
      * Quadrupling the size improves average table sparseness
      * (reducing collisions) at the cost of some memory. It also halves
@@ -822,14 +1095,14 @@ PyMemoTable_Set(PyMemoTable *self, PyObject *key, Py_ssize_t value)
      * Very large memo tables (over 50K items) use doubling instead.
      * This may help applications with severe memory constraints.
      */
-    if (!(self->mt_used * 3 >= (self->mt_mask + 1) * 2))
+    if (!(self->mt_used * 2 >= self->mt_allocated))
         return 0;
     return _PyMemoTable_ResizeTable(self,
-        (self->mt_used > 50000 ? 2 : 4) * self->mt_used);
+        (self->mt_used > 50000 ? 2 : 4) * self->mt_allocated);
 }
 
 #undef MT_MINSIZE
-#undef PERTURB_SHIFT
+#undef MT_HASH_MULTIPLIER
 
 /*************************************************************************/
 
@@ -982,6 +1255,63 @@ _Pickler_Write(PicklerObject *self, const char *s, Py_ssize_t data_len)
     return data_len;
 }
 
+/* Write an opcode header followed by a potentially large payload.  A
+   payload larger than a frame is written outside of any frame; when
+   pickling to a file, it is passed directly to the file's write() method
+   instead of being copied into the output buffer.  `payload` is the object
+   owning `data`, or NULL if a bytes copy has to be made for write(). */
+static int
+_Pickler_write_bytes(PicklerObject *self,
+                     const char *header, Py_ssize_t header_size,
+                     const char *data, Py_ssize_t data_size,
+                     PyObject *payload)
+{
+    int bypass_buffer = (data_size >= FRAME_SIZE_TARGET);
+    int framing = self->framing;
+
+    if (bypass_buffer) {
+        assert(self->output_buffer != NULL);
+        /* Commit the previous frame and disable framing temporarily */
+        if (_Pickler_CommitFrame(self) < 0)
+            return -1;
+        self->framing = 0;
+    }
+
+    if (_Pickler_Write(self, header, header_size) < 0)
+        return -1;
+
+    if (bypass_buffer && self->write != NULL) {
+        PyObject *result;
+
+        /* Dump the output buffer, then stream the payload to the file */
+        if (_Pickler_FlushToFile(self) < 0)
+            return -1;
+        if (payload == NULL) {
+            payload = PyBytes_FromStringAndSize(data, data_size);
+            if (payload == NULL)
+                return -1;
+        }
+        else {
+            Py_INCREF(payload);
+        }
+        result = _Pickle_FastCall(self->write, payload);
+        if (result == NULL)
+            return -1;
+        Py_DECREF(result);
+
+        /* Reinitialize the buffer for the following writes */
+        if (_Pickler_ClearBuffer(self) < 0)
+            return -1;
+    }
+    else {
+        if (_Pickler_Write(self, data, data_size) < 0)
+            return -1;
+    }
+
+    self->framing = framing;
+    return 0;
+}
+
 static PicklerObject *
 _Pickler_New(void)
 {
@@ -1002,6 +1332,7 @@ _Pickler_New(void)
     self->fast_nesting = 0;
     self->fix_imports = 0;
     self->fast_memo = NULL;
+    self->buffer_callback = NULL;
     self->max_output_len = WRITE_BUF_SIZE;
     self->output_len = 0;
 
@@ -1043,6 +1374,49 @@ _Pickler_SetProtocol(PicklerObject *self, PyObject *protocol, int fix_imports)
     return 0;
 }
 
+/* Returns -1 (with an exception set) on failure, 0 on success.  The
+   protocol must have been set first. */
+static int
+_Pickler_SetBufferCallback(PicklerObject *self, PyObject *buffer_callback)
+{
+    if (buffer_callback == Py_None)
+        buffer_callback = NULL;
+    if (buffer_callback != NULL && self->proto < 5) {
+        PyErr_SetString(PyExc_ValueError,
+                        "buffer_callback needs protocol >= 5");
+        return -1;
+    }
+    Py_XINCREF(buffer_callback);
+    Py_CLEAR(self->buffer_callback);
+    self->buffer_callback = buffer_callback;
+    return 0;
+}
+
+/* Convert the workers argument of dump() and dumps().  Returns -1 (with an
+   exception set) on failure, 0 on success. */
+static int
+_Pickle_ParseWorkers(PyObject *workers, Py_ssize_t *nworkers)
+{
+    if (workers == Py_None) {
+        *nworkers = 1;
+        return 0;
+    }
+    if (!PyLong_Check(workers)) {
+        PyErr_Format(PyExc_TypeError,
+                     "workers must be an integer or None, not %.200s",
+                     Py_TYPE(workers)->tp_name);
+        return -1;
+    }
+    *nworkers = PyLong_AsSsize_t(workers);
+    if (*nworkers == -1 && PyErr_Occurred())
+        return -1;
+    if (*nworkers <= 0) {
+        PyErr_SetString(PyExc_ValueError, "workers must be positive");
+        return -1;
+    }
+    return 0;
+}
+
 /* Returns -1 (with an exception set) on failure, 0 on success. This may
    be called once on a freshly created Pickler. */
 static int
@@ -1205,6 +1579,73 @@ _Unpickler_Read(UnpicklerObject *self, char **s, Py_ssize_t n)
     return n;
 }
 
+/* Read `n` bytes from the unpickler's data source into the memory at `buf`.
+
+   The bytes already in the input buffer are copied; when reading from a
+   file, the remaining ones are read straight into `buf` with the file's
+   readinto() method if it has one.  This avoids an intermediate bytes
+   object for large payloads.
+
+   Returns -1 (with an exception set) on failure, `n` on success. */
+static Py_ssize_t
+_Unpickler_ReadInto(UnpicklerObject *self, char *buf, Py_ssize_t n)
+{
+    Py_ssize_t in_buffer = self->input_len - self->next_read_idx;
+    Py_ssize_t read_size, remaining = n;
+    PyObject *data;
+
+    if (in_buffer > 0) {
+        Py_ssize_t to_read = Py_MIN(in_buffer, n);
+        memcpy(buf, self->input_buffer + self->next_read_idx, to_read);
+        self->next_read_idx += to_read;
+        buf += to_read;
+        remaining -= to_read;
+        if (remaining == 0)
+            return n;
+    }
+    if (!self->read) {
+        PyErr_Format(PyExc_EOFError, "Ran out of input");
+        return -1;
+    }
+    /* Give back the data prefetched with peek() but not consumed */
+    if (_Unpickler_SkipConsumed(self) < 0)
+        return -1;
+
+    if (self->readinto == NULL) {
+        data = _Pickle_FastCall(self->read, PyLong_FromSsize_t(remaining));
+        if (data == NULL)
+            return -1;
+        if (!PyBytes_Check(data)) {
+            PyErr_Format(PyExc_ValueError,
+                         "read() returned non-bytes object (%R)",
+                         Py_TYPE(data));
+            Py_DECREF(data);
+            return -1;
+        }
+        read_size = PyBytes_GET_SIZE(data);
+        if (read_size >= remaining)
+            memcpy(buf, PyBytes_AS_STRING(data), remaining);
+        Py_DECREF(data);
+    }
+    else {
+        PyObject *view = PyMemoryView_FromMemory(buf, remaining, PyBUF_WRITE);
+        if (view == NULL)
+            return -1;
+        data = _Pickle_FastCall(self->readinto, view);
+        if (data == NULL)
+            return -1;
+        read_size = PyLong_AsSsize_t(data);
+        Py_DECREF(data);
+        if (read_size == -1 && PyErr_Occurred())
+            return -1;
+    }
+    if (read_size < remaining) {
+        PyErr_Format(PyExc_EOFError, "Ran out of input");
+        return -1;
+    }
+    return n;
+}
+
 static Py_ssize_t
 _Unpickler_CopyLine(UnpicklerObject *self, char *line, Py_ssize_t len,
                     char **result)
@@ -1265,6 +1706,10 @@ _Unpickler_ResizeMemoList(UnpicklerObject *self, Py_ssize_t new_size)
 
     assert(new_size > self->memo_size);
 
+    if (new_size > PY_SSIZE_T_MAX / (Py_ssize_t)sizeof(PyObject *)) {
+        PyErr_NoMemory();
+        return -1;
+    }
     memo = PyMem_REALLOC(self->memo, new_size * sizeof(PyObject *));
     if (memo == NULL) {
         PyErr_NoMemory();
@@ -1294,8 +1739,19 @@ _Unpickler_MemoPut(UnpicklerObject *self, Py_ssize_t idx, PyObject *value)
 {
     PyObject *old_item;
 
+    assert(idx >= 0);
     if (idx >= self->memo_size) {
-        if (_Unpickler_ResizeMemoList(self, idx * 2) < 0)
+        /* Grow geometrically, as the pickler's memo table does, so that a
+           stream of sequential PUTs is amortized O(1) even when the memo
+           starts out empty. */
+        Py_ssize_t new_size = self->memo_size < 8 ? 8 : self->memo_size;
+        while (new_size <= idx && new_size > 0)
+            new_size <<= 1;
+        if (new_size <= 0) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        if (_Unpickler_ResizeMemoList(self, new_size) < 0)
             return -1;
         assert(idx < self->memo_size);
     }
@@ -1358,6 +1814,8 @@ _Unpickler_New(void)
     self->read = NULL;
     self->readline = NULL;
     self->peek = NULL;
+    self->readinto = NULL;
+    self->buffers = NULL;
     self->encoding = NULL;
     self->errors = NULL;
     self->marks = NULL;
@@ -1386,6 +1844,7 @@ _Unpickler_SetInputStream(UnpicklerObject *self, PyObject *file)
 {
     _Py_IDENTIFIER(peek);
     _Py_IDENTIFIER(read);
+    _Py_IDENTIFIER(readinto);
     _Py_IDENTIFIER(readline);
 
     self->peek = _PyObject_GetAttrId(file, &PyId_peek);
@@ -1395,6 +1854,13 @@ _Unpickler_SetInputStream(UnpicklerObject *self, PyObject *file)
         else
             return -1;
     }
+    self->readinto = _PyObject_GetAttrId(file, &PyId_readinto);
+    if (self->readinto == NULL) {
+        if (PyErr_ExceptionMatches(PyExc_AttributeError))
+            PyErr_Clear();
+        else
+            return -1;
+    }
     self->read = _PyObject_GetAttrId(file, &PyId_read);
     self->readline = _PyObject_GetAttrId(file, &PyId_readline);
     if (self->readline == NULL || self->read == NULL) {
@@ -1404,11 +1870,28 @@ _Unpickler_SetInputStream(UnpicklerObject *self, PyObject *file)
         Py_CLEAR(self->read);
         Py_CLEAR(self->readline);
         Py_CLEAR(self->peek);
+        Py_CLEAR(self->readinto);
         return -1;
     }
     return 0;
 }
 
+/* Returns -1 (with an exception set) on failure, 0 on success. This may
+   be called once on a freshly created Unpickler. */
+static int
+_Unpickler_SetBuffers(UnpicklerObject *self, PyObject *buffers)
+{
+    if (buffers == NULL || buffers == Py_None) {
+        self->buffers = NULL;
+    }
+    else {
+        self->buffers = PyObject_GetIter(buffers);
+        if (self->buffers == NULL)
+            return -1;
+    }
+    return 0;
+}
+
 /* Returns -1 (with an exception set) on failure, 0 on success. This may
    be called once on a freshly created Pickler. */
 static int
@@ -1430,38 +1913,31 @@ _Unpickler_SetInputEncoding(UnpicklerObject *self,
     return 0;
 }
 
-/* Generate a GET opcode for an object stored in the memo. */
+/* Generate a GET opcode for the memo entry idx. */
 static int
-memo_get(PicklerObject *self, PyObject *key)
+memo_get_index(PicklerObject *self, Py_ssize_t idx)
 {
-    Py_ssize_t *value;
     char pdata[30];
     Py_ssize_t len;
 
-    value = PyMemoTable_Get(self->memo, key);
-    if (value == NULL)  {
-        PyErr_SetObject(PyExc_KeyError, key);
-        return -1;
-    }
-
     if (!self->bin) {
         pdata[0] = GET;
         PyOS_snprintf(pdata + 1, sizeof(pdata) - 1,
-                      "%" PY_FORMAT_SIZE_T "d\n", *value);
+                      "%" PY_FORMAT_SIZE_T "d\n", idx);
         len = strlen(pdata);
     }
     else {
-        if (*value < 256) {
+        if (idx < 256) {
             pdata[0] = BINGET;
-            pdata[1] = (unsigned char)(*value & 0xff);
+            pdata[1] = (unsigned char)(idx & 0xff);
             len = 2;
         }
-        else if ((size_t)*value <= 0xffffffffUL) {
+        else if ((size_t)idx <= 0xffffffffUL) {
             pdata[0] = LONG_BINGET;
-            pdata[1] = (unsigned char)(*value & 0xff);
-            pdata[2] = (unsigned char)((*value >> 8) & 0xff);
-            pdata[3] = (unsigned char)((*value >> 16) & 0xff);
-            pdata[4] = (unsigned char)((*value >> 24) & 0xff);
+            pdata[1] = (unsigned char)(idx & 0xff);
+            pdata[2] = (unsigned char)((idx >> 8) & 0xff);
+            pdata[3] = (unsigned char)((idx >> 16) & 0xff);
+            pdata[4] = (unsigned char)((idx >> 24) & 0xff);
             len = 5;
         }
         else { /* unlikely */
@@ -1478,6 +1954,20 @@ memo_get(PicklerObject *self, PyObject *key)
     return 0;
 }
 
+/* Generate a GET opcode for an object stored in the memo. */
+static int
+memo_get(PicklerObject *self, PyObject *key)
+{
+    Py_ssize_t *value;
+
+    value = PyMemoTable_Get(self->memo, key);
+    if (value == NULL)  {
+        PyErr_SetObject(PyExc_KeyError, key);
+        return -1;
+    }
+    return memo_get_index(self, *value);
+}
+
 /* Store an object in the memo, assign it a new unique ID based on the number
    of objects currently stored in the memo and generate a PUT opcode. */
 static int
@@ -2000,6 +2490,50 @@ done:
     return 0;
 }
 
+/* Write the data of a bytes-like object as a bytes object (protocol >= 3),
+   and memoize `obj`. */
+static int
+_save_bytes_data(PicklerObject *self, PyObject *obj, const char *data,
+                 Py_ssize_t size)
+{
+    char header[9];
+    Py_ssize_t len;
+
+    assert(self->proto >= 3);
+    if (size <= 0xff) {
+        header[0] = SHORT_BINBYTES;
+        header[1] = (unsigned char)size;
+        len = 2;
+    }
+    else if ((size_t)size <= 0xffffffffUL) {
+        header[0] = BINBYTES;
+        header[1] = (unsigned char)(size & 0xff);
+        header[2] = (unsigned char)((size >> 8) & 0xff);
+        header[3] = (unsigned char)((size >> 16) & 0xff);
+        header[4] = (unsigned char)((size >> 24) & 0xff);
+        len = 5;
+    }
+    else if (self->proto >= 4) {
+        header[0] = BINBYTES8;
+        _write_size64(header + 1, size);
+        len = 9;
+    }
+    else {
+        PyErr_SetString(PyExc_OverflowError,
+                        "cannot serialize a bytes object larger than 4 GiB");
+        return -1;          /* string too large */
+    }
+
+    if (_Pickler_write_bytes(self, header, len, data, size,
+                             PyBytes_CheckExact(obj) ? obj : NULL) < 0)
+        return -1;
+
+    if (memo_put(self, obj) < 0)
+        return -1;
+
+    return 0;
+}
+
 static int
 save_bytes(PicklerObject *self, PyObject *obj)
 {
@@ -2046,49 +2580,99 @@ save_bytes(PicklerObject *self, PyObject *obj)
         return status;
     }
     else {
-        Py_ssize_t size;
-        char header[9];
-        Py_ssize_t len;
+        return _save_bytes_data(self, obj, PyBytes_AS_STRING(obj),
+                                PyBytes_GET_SIZE(obj));
+    }
+}
 
-        size = PyBytes_GET_SIZE(obj);
-        if (size < 0)
-            return -1;
+/* Write the data of a bytes-like object as a bytearray object (protocol
+   >= 5), and memoize `obj`. */
+static int
+_save_bytearray_data(PicklerObject *self, PyObject *obj, const char *data,
+                     Py_ssize_t size)
+{
+    char header[9];
 
-        if (size <= 0xff) {
-            header[0] = SHORT_BINBYTES;
-            header[1] = (unsigned char)size;
-            len = 2;
-        }
-        else if ((size_t)size <= 0xffffffffUL) {
-            header[0] = BINBYTES;
-            header[1] = (unsigned char)(size & 0xff);
-            header[2] = (unsigned char)((size >> 8) & 0xff);
-            header[3] = (unsigned char)((size >> 16) & 0xff);
-            header[4] = (unsigned char)((size >> 24) & 0xff);
-            len = 5;
-        }
-        else if (self->proto >= 4) {
-            header[0] = BINBYTES8;
-            _write_size64(header + 1, size);
-            len = 9;
-        }
-        else {
-            PyErr_SetString(PyExc_OverflowError,
-                            "cannot serialize a bytes object larger than 4 GiB");
-            return -1;          /* string too large */
-        }
+    assert(self->proto >= 5);
+    header[0] = BYTEARRAY8;
+    _write_size64(header + 1, size);
 
-        if (_Pickler_Write(self, header, len) < 0)
-            return -1;
+    if (_Pickler_write_bytes(self, header, 9, data, size,
+                             PyByteArray_CheckExact(obj) ? obj : NULL) < 0)
+        return -1;
 
-        if (_Pickler_Write(self, PyBytes_AS_STRING(obj), size) < 0)
-            return -1;
+    if (memo_put(self, obj) < 0)
+        return -1;
 
-        if (memo_put(self, obj) < 0)
+    return 0;
+}
+
+static int
+save_bytearray(PicklerObject *self, PyObject *obj)
+{
+    assert(self->proto >= 5);
+    return _save_bytearray_data(self, obj, PyByteArray_AS_STRING(obj),
+                                PyByteArray_GET_SIZE(obj));
+}
+
+static int
+save_picklebuffer(PicklerObject *self, PyObject *obj)
+{
+    Py_buffer *view;
+    int in_band = 1;
+
+    if (self->proto < 5) {
+        PickleState *st = _Pickle_GetGlobalState();
+        PyErr_SetString(st->PicklingError,
+                        "PickleBuffer can only be pickled with protocol >= 5");
+        return -1;
+    }
+    view = PickleBuffer_GetView((PickleBufferObject *)obj);
+    if (view == NULL)
+        return -1;
+    if (view->suboffsets != NULL || !PyBuffer_IsContiguous(view, 'A')) {
+        PickleState *st = _Pickle_GetGlobalState();
+        PyErr_SetString(st->PicklingError,
+                        "PickleBuffer can not be pickled when pointing to a "
+                        "non-contiguous buffer");
+        return -1;
+    }
+    if (self->buffer_callback != NULL) {
+        PyObject *ret;
+
+        Py_INCREF(obj);
+        ret = _Pickle_FastCall(self->buffer_callback, obj);
+        if (ret == NULL)
+            return -1;
+        in_band = PyObject_IsTrue(ret);
+        Py_DECREF(ret);
+        if (in_band == -1)
             return -1;
+    }
+    if (in_band) {
+        /* Write the data in-band, as an object of the appropriate
+           mutability */
+        if (view->readonly)
+            return _save_bytes_data(self, obj, (const char *)view->buf,
+                                    view->len);
+        else
+            return _save_bytearray_data(self, obj, (const char *)view->buf,
+                                        view->len);
+    }
+    else {
+        /* Write the data out-of-band; the unpickler will take the next
+           buffer supplied by the caller */
+        const char next_buffer_op = NEXT_BUFFER;
+        const char readonly_buffer_op = READONLY_BUFFER;
 
-        return 0;
+        if (_Pickler_Write(self, &next_buffer_op, 1) < 0)
+            return -1;
+        if (view->readonly) {
+            if (_Pickler_Write(self, &readonly_buffer_op, 1) < 0)
+                return -1;
+        }
     }
+    return 0;
 }
 
 /* A copy of PyUnicode_EncodeRawUnicodeEscape() that also translates
@@ -2541,6 +3125,10 @@ batch_list_exact(PicklerObject *self, PyObject *obj)
             return -1;
         while (total < PyList_GET_SIZE(obj)) {
             item = PyList_GET_ITEM(obj, total);
+            /* Fetch the memo slot of the next item while this one is
+               being saved. */
+            if (total + 1 < PyList_GET_SIZE(obj))
+                MT_PREFETCH(self->memo, PyList_GET_ITEM(obj, total + 1));
             if (save(self, item, 0) < 0)
                 return -1;
             total++;
@@ -3685,6 +4273,7 @@ save(PicklerObject *self, PyObject *obj, int pers_save)
     PyTypeObject *type;
     PyObject *reduce_func = NULL;
     PyObject *reduce_value = NULL;
+    Py_ssize_t *memo_value;
     int status = 0;
 
     if (_Pickler_OpcodeBoundary(self) < 0)
@@ -3734,8 +4323,9 @@ save(PicklerObject *self, PyObject *obj, int pers_save)
     /* Check the memo to see if it has the object. If so, generate
        a GET (or BINGET) opcode, instead of pickling the object
        once again. */
-    if (PyMemoTable_Get(self->memo, obj)) {
-        if (memo_get(self, obj) < 0)
+    memo_value = PyMemoTable_Get(self->memo, obj);
+    if (memo_value != NULL) {
+        if (memo_get_index(self, *memo_value) < 0)
             goto error;
         goto done;
     }
@@ -3772,151 +4362,982 @@ save(PicklerObject *self, PyObject *obj, int pers_save)
         status = save_type(self, obj);
         goto done;
     }
-    else if (type == &PyFunction_Type) {
-        status = save_global(self, obj, NULL);
+    else if (type == &PyFunction_Type) {
+        status = save_global(self, obj, NULL);
+        goto done;
+    }
+    else if (type == &PickleBuffer_Type) {
+        status = save_picklebuffer(self, obj);
+        goto done;
+    }
+
+    /* XXX: This part needs some unit tests. */
+
+    /* Get a reduction callable, and call it.  This may come from
+     * self.dispatch_table, copyreg.dispatch_table, the object's
+     * __reduce_ex__ method, or the object's __reduce__ method.
+     */
+    if (self->dispatch_table == NULL) {
+        PickleState *st = _Pickle_GetGlobalState();
+        reduce_func = PyDict_GetItemWithError(st->dispatch_table,
+                                              (PyObject *)type);
+        if (reduce_func == NULL) {
+            if (PyErr_Occurred()) {
+                goto error;
+            }
+        } else {
+            /* PyDict_GetItemWithError() returns a borrowed reference.
+               Increase the reference count to be consistent with
+               PyObject_GetItem and _PyObject_GetAttrId used below. */
+            Py_INCREF(reduce_func);
+        }
+    } else {
+        reduce_func = PyObject_GetItem(self->dispatch_table,
+                                       (PyObject *)type);
+        if (reduce_func == NULL) {
+            if (PyErr_ExceptionMatches(PyExc_KeyError))
+                PyErr_Clear();
+            else
+                goto error;
+        }
+    }
+    if (reduce_func != NULL) {
+        Py_INCREF(obj);
+        reduce_value = _Pickle_FastCall(reduce_func, obj);
+    }
+    else if (type == &PyByteArray_Type && self->proto >= 5) {
+        /* Checked after the dispatch tables, so that a reducer can still
+           be registered for bytearray objects. */
+        status = save_bytearray(self, obj);
+        goto done;
+    }
+    else if (PyType_IsSubtype(type, &PyType_Type)) {
+        status = save_global(self, obj, NULL);
+        goto done;
+    }
+    else {
+        _Py_IDENTIFIER(__reduce__);
+        _Py_IDENTIFIER(__reduce_ex__);
+
+
+        /* XXX: If the __reduce__ method is defined, __reduce_ex__ is
+           automatically defined as __reduce__. While this is convenient, this
+           make it impossible to know which method was actually called. Of
+           course, this is not a big deal. But still, it would be nice to let
+           the user know which method was called when something go
+           wrong. Incidentally, this means if __reduce_ex__ is not defined, we
+           don't actually have to check for a __reduce__ method. */
+
+        /* Check for a __reduce_ex__ method. */
+        reduce_func = _PyObject_GetAttrId(obj, &PyId___reduce_ex__);
+        if (reduce_func != NULL) {
+            PyObject *proto;
+            proto = PyLong_FromLong(self->proto);
+            if (proto != NULL) {
+                reduce_value = _Pickle_FastCall(reduce_func, proto);
+            }
+        }
+        else {
+            PickleState *st = _Pickle_GetGlobalState();
+
+            if (PyErr_ExceptionMatches(PyExc_AttributeError)) {
+                PyErr_Clear();
+            }
+            else {
+                goto error;
+            }
+            /* Check for a __reduce__ method. */
+            reduce_func = _PyObject_GetAttrId(obj, &PyId___reduce__);
+            if (reduce_func != NULL) {
+                PyObject *empty_tuple = PyTuple_New(0);
+                reduce_value = PyObject_Call(reduce_func, empty_tuple,
+                                             NULL);
+                Py_DECREF(empty_tuple);
+            }
+            else {
+                PyErr_Format(st->PicklingError,
+                             "can't pickle '%.200s' object: %R",
+                             type->tp_name, obj);
+                goto error;
+            }
+        }
+    }
+
+    if (reduce_value == NULL)
+        goto error;
+
+    if (PyUnicode_Check(reduce_value)) {
+        status = save_global(self, obj, reduce_value);
+        goto done;
+    }
+
+    if (!PyTuple_Check(reduce_value)) {
+        PickleState *st = _Pickle_GetGlobalState();
+        PyErr_SetString(st->PicklingError,
+                        "__reduce__ must return a string or tuple");
+        goto error;
+    }
+
+    status = save_reduce(self, reduce_value, obj);
+
+    if (0) {
+  error:
+        status = -1;
+    }
+  done:
+
+    Py_LeaveRecursiveCall();
+    Py_XDECREF(reduce_func);
+    Py_XDECREF(reduce_value);
+
+    return status;
+}
+
+static int
+dump(PicklerObject *self, PyObject *obj)
+{
+    const char stop_op = STOP;
+
+    if (self->proto >= 2) {
+        char header[2];
+
+        header[0] = PROTO;
+        assert(self->proto >= 0 && self->proto < 256);
+        header[1] = (unsigned char)self->proto;
+        if (_Pickler_Write(self, header, 2) < 0)
+            return -1;
+        if (self->proto >= 4)
+            self->framing = 1;
+    }
+
+    if (save(self, obj, 0) < 0 ||
+        _Pickler_Write(self, &stop_op, 1) < 0)
+        return -1;
+
+    return 0;
+}
+
+#ifdef WITH_THREAD
+
+/*************************************************************************
+ Parallel pickling.
+
+ dump() and dumps() can pickle the items of a large list or dict in several
+ threads.  Each worker serializes a contiguous range of items, in the same
+ batches as batch_list_exact() and batch_dict_exact(), into a private buffer
+ with a private memo.  The main thread then splices the buffers into frames,
+ writing the GET opcodes of each range with indices following the objects
+ memoized by the previous ranges.  The first batch is saved before the
+ workers start, and the objects it memoizes (typically the keys of similar
+ dicts) are shared by all the ranges.
+
+ Workers do not use the Python C API: they only handle exact None, bool,
+ int, float, str, bytes, tuple, list and dict objects, never touch
+ reference counts and allocate memory with PyMem_RawMalloc().  The calling
+ thread keeps the GIL until all the workers are done, so no other thread
+ can modify the objects while they are read.  If a worker meets anything
+ else, or if a list or dict is reachable from two ranges (it would be
+ duplicated), the object is pickled again by dump().
+*/
+
+/* Nesting limit of the containers saved by a worker */
+#define PICKLE_WORKER_MAX_DEPTH 200
+
+/* A position in the output of a worker where a GET opcode has to be
+   written, or where the current frame can be committed. */
+typedef struct {
+    Py_ssize_t pos;
+    Py_ssize_t memo_index;      /* Value of the object in the worker memo,
+                                   or PICKLE_WORKER_BOUNDARY */
+} PickleWorkerEvent;
+
+#define PICKLE_WORKER_BOUNDARY PY_SSIZE_T_MIN
+
+typedef struct {
+    PyObject **items;           /* Borrowed items, or key/value pairs */
+    Py_ssize_t start;           /* Range of items or pairs to save */
+    Py_ssize_t stop;
+    int dict_items;             /* Save SETITEMS batches of pairs */
+    int float_ok;               /* _PyFloat_Pack8() cannot fail */
+    PyObject *container;        /* The object passed to dump() */
+    char *output;
+    Py_ssize_t output_len;
+    Py_ssize_t output_size;
+    Py_ssize_t last_boundary;
+    PickleWorkerEvent *events;
+    Py_ssize_t events_len;
+    Py_ssize_t events_size;
+    PyMemoTable memo;           /* Keys are borrowed references.  Values
+                                   are the order in which the worker
+                                   memoized the objects, or -1 - i for the
+                                   object with index i in the pickle which
+                                   was memoized by the first batch */
+    Py_ssize_t memo_seeded;     /* Number of objects of the first batch */
+    int depth;
+    int failed;
+    PyThread_type_lock done;
+} PickleWorker;
+
+static int _PickleWorker_Save(PickleWorker *w, PyObject *obj);
+
+static int
+_PickleWorker_Fail(PickleWorker *w)
+{
+    w->failed = 1;
+    return -1;
+}
+
+/* Make room for n more bytes in the output and return a pointer to them. */
+static char *
+_PickleWorker_Reserve(PickleWorker *w, Py_ssize_t n)
+{
+    if (n > w->output_size - w->output_len) {
+        char *output;
+        Py_ssize_t size;
+
+        if (w->output_len >= PY_SSIZE_T_MAX / 2 - n) {
+            w->failed = 1;
+            return NULL;
+        }
+        size = Py_MAX((w->output_len + n) / 2 * 3, 4096);
+        output = PyMem_RawRealloc(w->output, size);
+        if (output == NULL) {
+            w->failed = 1;
+            return NULL;
+        }
+        w->output = output;
+        w->output_size = size;
+    }
+    return w->output + w->output_len;
+}
+
+static int
+_PickleWorker_Write(PickleWorker *w, const char *s, Py_ssize_t n)
+{
+    char *p = _PickleWorker_Reserve(w, n);
+    if (p == NULL)
+        return -1;
+    memcpy(p, s, n);
+    w->output_len += n;
+    return 0;
+}
+
+static int
+_PickleWorker_AddEvent(PickleWorker *w, Py_ssize_t memo_index)
+{
+    if (w->events_len == w->events_size) {
+        PickleWorkerEvent *events;
+        Py_ssize_t size = w->events_size ? w->events_size * 2 : 64;
+
+        if (size > PY_SSIZE_T_MAX / (Py_ssize_t)sizeof(PickleWorkerEvent))
+            return _PickleWorker_Fail(w);
+        events = PyMem_RawRealloc(w->events,
+                                  size * sizeof(PickleWorkerEvent));
+        if (events == NULL)
+            return _PickleWorker_Fail(w);
+        w->events = events;
+        w->events_size = size;
+    }
+    w->events[w->events_len].pos = w->output_len;
+    w->events[w->events_len].memo_index = memo_index;
+    w->events_len++;
+    return 0;
+}
+
+/* Store obj in the worker memo and write a MEMOIZE opcode. */
+static int
+_PickleWorker_MemoPut(PickleWorker *w, PyObject *obj)
+{
+    PyMemoTable *memo = &w->memo;
+    PyMemoEntry *entry;
+    const char memoize_op = MEMOIZE;
+
+    entry = _PyMemoTable_Lookup(memo, obj);
+    assert(entry->me_key == NULL);
+    entry->me_key = obj;
+    entry->me_value = memo->mt_used++ - w->memo_seeded;
+
+    /* Same growth policy as PyMemoTable_Set() */
+    if (memo->mt_used * 2 >= memo->mt_allocated) {
+        PyMemoEntry *oldtable = memo->mt_table;
+        Py_ssize_t size = memo->mt_allocated * (memo->mt_used > 50000 ? 2 : 4);
+
+        if (size > PY_SSIZE_T_MAX / (Py_ssize_t)sizeof(PyMemoEntry))
+            return _PickleWorker_Fail(w);
+        memo->mt_table = PyMem_RawMalloc(size * sizeof(PyMemoEntry));
+        if (memo->mt_table == NULL) {
+            memo->mt_table = oldtable;
+            return _PickleWorker_Fail(w);
+        }
+        memset(memo->mt_table, 0, size * sizeof(PyMemoEntry));
+        memo->mt_allocated = size;
+        memo->mt_mask = size - 1;
+        _PyMemoTable_MoveEntries(memo, oldtable);
+        PyMem_RawFree(oldtable);
+    }
+    return _PickleWorker_Write(w, &memoize_op, 1);
+}
+
+/* The same opcodes as save_long() with protocol >= 2 */
+static int
+_PickleWorker_SaveLong(PickleWorker *w, PyObject *obj)
+{
+    int overflow;
+    long val = PyLong_AsLongAndOverflow(obj, &overflow);
+    size_t nbits, nbytes;
+    unsigned char *pdata;
+    char *p;
+
+    if (!overflow &&
+        (sizeof(long) <= 4 ||
+         (val <= 0x7fffffffL && val >= (-0x7fffffffL - 1)))) {
+        char data[5];
+        Py_ssize_t len;
+
+        data[1] = (unsigned char)(val & 0xff);
+        data[2] = (unsigned char)((val >> 8) & 0xff);
+        data[3] = (unsigned char)((val >> 16) & 0xff);
+        data[4] = (unsigned char)((val >> 24) & 0xff);
+        if ((data[4] == 0) && (data[3] == 0)) {
+            if (data[2] == 0) {
+                data[0] = BININT1;
+                len = 2;
+            }
+            else {
+                data[0] = BININT2;
+                len = 3;
+            }
+        }
+        else {
+            data[0] = BININT;
+            len = 5;
+        }
+        return _PickleWorker_Write(w, data, len);
+    }
+
+    /* Keep clear of the overflow errors of _PyLong_NumBits() and of
+       "int too large to pickle". */
+    if (Py_ABS(Py_SIZE(obj)) > 0x7fffffffL / PyLong_SHIFT)
+        return _PickleWorker_Fail(w);
+    nbits = _PyLong_NumBits(obj);
+    nbytes = (nbits >> 3) + 1;
+
+    /* Leave room for the largest header, the data is moved after the
+       header once its final size is known. */
+    p = _PickleWorker_Reserve(w, 5 + (Py_ssize_t)nbytes);
+    if (p == NULL)
+        return -1;
+    pdata = (unsigned char *)p + 5;
+    if (_PyLong_AsByteArray((PyLongObject *)obj, pdata, nbytes,
+                            1 /* little endian */ , 1 /* signed */ ) < 0)
+        return _PickleWorker_Fail(w);
+    if (_PyLong_Sign(obj) < 0 &&
+        nbytes > 1 &&
+        pdata[nbytes - 1] == 0xff &&
+        (pdata[nbytes - 2] & 0x80) != 0) {
+        nbytes--;
+    }
+    if (nbytes < 256) {
+        p[0] = LONG1;
+        p[1] = (unsigned char)nbytes;
+        memmove(p + 2, pdata, nbytes);
+        w->output_len += 2 + nbytes;
+    }
+    else {
+        p[0] = LONG4;
+        p[1] = (unsigned char)(nbytes & 0xff);
+        p[2] = (unsigned char)((nbytes >> 8) & 0xff);
+        p[3] = (unsigned char)((nbytes >> 16) & 0xff);
+        p[4] = (unsigned char)((nbytes >> 24) & 0xff);
+        w->output_len += 5 + nbytes;
+    }
+    return 0;
+}
+
+static int
+_PickleWorker_SaveFloat(PickleWorker *w, PyObject *obj)
+{
+    double x = PyFloat_AS_DOUBLE(obj);
+    char pdata[9];
+
+    if (!w->float_ok && !Py_IS_FINITE(x))
+        return _PickleWorker_Fail(w);
+    pdata[0] = BINFLOAT;
+    if (_PyFloat_Pack8(x, (unsigned char *)&pdata[1], 0) < 0)
+        return _PickleWorker_Fail(w);
+    return _PickleWorker_Write(w, pdata, 9);
+}
+
+/* Write the header of a counted string opcode, like write_utf8() and
+   _save_bytes_data() do with protocol 4. */
+static int
+_PickleWorker_WriteHeader(PickleWorker *w, Py_ssize_t size,
+                          char short_op, char op, char op8)
+{
+    char header[9];
+    Py_ssize_t len;
+
+    if (size <= 0xff) {
+        header[0] = short_op;
+        header[1] = (unsigned char)(size & 0xff);
+        len = 2;
+    }
+    else if ((size_t)size <= 0xffffffffUL) {
+        header[0] = op;
+        header[1] = (unsigned char)(size & 0xff);
+        header[2] = (unsigned char)((size >> 8) & 0xff);
+        header[3] = (unsigned char)((size >> 16) & 0xff);
+        header[4] = (unsigned char)((size >> 24) & 0xff);
+        len = 5;
+    }
+    else {
+        header[0] = op8;
+        _write_size64(header + 1, size);
+        len = 9;
+    }
+    return _PickleWorker_Write(w, header, len);
+}
+
+/* Encode a string to UTF-8 with the "surrogatepass" error handler, as
+   write_unicode_binary() does, without creating any object. */
+static int
+_PickleWorker_SaveUnicode(PickleWorker *w, PyObject *obj)
+{
+    Py_ssize_t i, len, size;
+    int kind;
+    void *data;
+    unsigned char *p;
+
+    if (!PyUnicode_IS_READY(obj))
+        return _PickleWorker_Fail(w);
+    if (PyUnicode_IS_ASCII(obj) ||
+        ((PyCompactUnicodeObject *)obj)->utf8 != NULL) {
+        /* The data of ASCII strings is valid UTF-8, others may have
+           their UTF-8 representation cached. */
+        const char *utf8;
+
+        if (PyUnicode_IS_ASCII(obj)) {
+            utf8 = (const char *)PyUnicode_DATA(obj);
+            size = PyUnicode_GET_LENGTH(obj);
+        }
+        else {
+            utf8 = ((PyCompactUnicodeObject *)obj)->utf8;
+            size = ((PyCompactUnicodeObject *)obj)->utf8_length;
+        }
+        if (_PickleWorker_WriteHeader(w, size, SHORT_BINUNICODE,
+                                      BINUNICODE, BINUNICODE8) < 0 ||
+            _PickleWorker_Write(w, utf8, size) < 0)
+            return -1;
+        return _PickleWorker_MemoPut(w, obj);
+    }
+
+    kind = PyUnicode_KIND(obj);
+    data = PyUnicode_DATA(obj);
+    len = PyUnicode_GET_LENGTH(obj);
+    size = 0;
+    for (i = 0; i < len; i++) {
+        Py_UCS4 ch = PyUnicode_READ(kind, data, i);
+        size += (ch < 0x80) ? 1 : (ch < 0x800) ? 2 : (ch < 0x10000) ? 3 : 4;
+    }
+    if (_PickleWorker_WriteHeader(w, size, SHORT_BINUNICODE,
+                                  BINUNICODE, BINUNICODE8) < 0)
+        return -1;
+    p = (unsigned char *)_PickleWorker_Reserve(w, size);
+    if (p == NULL)
+        return -1;
+    for (i = 0; i < len; i++) {
+        Py_UCS4 ch = PyUnicode_READ(kind, data, i);
+        if (ch < 0x80) {
+            *p++ = (unsigned char)ch;
+        }
+        else if (ch < 0x800) {
+            *p++ = (unsigned char)(0xc0 | (ch >> 6));
+            *p++ = (unsigned char)(0x80 | (ch & 0x3f));
+        }
+        else if (ch < 0x10000) {
+            *p++ = (unsigned char)(0xe0 | (ch >> 12));
+            *p++ = (unsigned char)(0x80 | ((ch >> 6) & 0x3f));
+            *p++ = (unsigned char)(0x80 | (ch & 0x3f));
+        }
+        else {
+            *p++ = (unsigned char)(0xf0 | (ch >> 18));
+            *p++ = (unsigned char)(0x80 | ((ch >> 12) & 0x3f));
+            *p++ = (unsigned char)(0x80 | ((ch >> 6) & 0x3f));
+            *p++ = (unsigned char)(0x80 | (ch & 0x3f));
+        }
+    }
+    w->output_len += size;
+    return _PickleWorker_MemoPut(w, obj);
+}
+
+static int
+_PickleWorker_SaveBytes(PickleWorker *w, PyObject *obj)
+{
+    Py_ssize_t size = PyBytes_GET_SIZE(obj);
+
+    /* dump() writes large payloads outside of frames */
+    if (size >= FRAME_SIZE_TARGET)
+        return _PickleWorker_Fail(w);
+    if (_PickleWorker_WriteHeader(w, size, SHORT_BINBYTES,
+                                  BINBYTES, BINBYTES8) < 0 ||
+        _PickleWorker_Write(w, PyBytes_AS_STRING(obj), size) < 0)
+        return -1;
+    return _PickleWorker_MemoPut(w, obj);
+}
+
+/* The same opcodes as save_tuple() with protocol >= 2, except that
+   recursive tuples are left to dump(). */
+static int
+_PickleWorker_SaveTuple(PickleWorker *w, PyObject *obj)
+{
+    Py_ssize_t i, len = PyTuple_GET_SIZE(obj);
+    const char mark_op = MARK;
+    const char tuple_op = TUPLE;
+    const char len2opcode[] = {EMPTY_TUPLE, TUPLE1, TUPLE2, TUPLE3};
+
+    if (len == 0)
+        return _PickleWorker_Write(w, len2opcode, 1);
+
+    if (len > 3 && _PickleWorker_Write(w, &mark_op, 1) < 0)
+        return -1;
+    for (i = 0; i < len; i++) {
+        if (_PickleWorker_Save(w, PyTuple_GET_ITEM(obj, i)) < 0)
+            return -1;
+    }
+    if (_PyMemoTable_Lookup(&w->memo, obj)->me_key != NULL)
+        return _PickleWorker_Fail(w);
+    if (_PickleWorker_Write(w, len > 3 ? &tuple_op : len2opcode + len, 1) < 0)
+        return -1;
+    return _PickleWorker_MemoPut(w, obj);
+}
+
+/* The same opcodes as save_list() and batch_list_exact() */
+static int
+_PickleWorker_SaveList(PickleWorker *w, PyObject *obj)
+{
+    Py_ssize_t this_batch, total;
+    const char empty_list_op = EMPTY_LIST;
+    const char append_op = APPEND;
+    const char appends_op = APPENDS;
+    const char mark_op = MARK;
+
+    if (_PickleWorker_Write(w, &empty_list_op, 1) < 0 ||
+        _PickleWorker_MemoPut(w, obj) < 0)
+        return -1;
+    if (PyList_GET_SIZE(obj) == 0)
+        return 0;
+    if (PyList_GET_SIZE(obj) == 1) {
+        if (_PickleWorker_Save(w, PyList_GET_ITEM(obj, 0)) < 0)
+            return -1;
+        return _PickleWorker_Write(w, &append_op, 1);
+    }
+
+    total = 0;
+    do {
+        this_batch = 0;
+        if (_PickleWorker_Write(w, &mark_op, 1) < 0)
+            return -1;
+        while (total < PyList_GET_SIZE(obj)) {
+            if (_PickleWorker_Save(w, PyList_GET_ITEM(obj, total)) < 0)
+                return -1;
+            total++;
+            if (++this_batch == BATCHSIZE)
+                break;
+        }
+        if (_PickleWorker_Write(w, &appends_op, 1) < 0)
+            return -1;
+    } while (total < PyList_GET_SIZE(obj));
+    return 0;
+}
+
+/* The same opcodes as save_dict() and batch_dict_exact() */
+static int
+_PickleWorker_SaveDict(PickleWorker *w, PyObject *obj)
+{
+    PyObject *key = NULL, *value = NULL;
+    Py_ssize_t ppos = 0;
+    int i;
+    const char empty_dict_op = EMPTY_DICT;
+    const char mark_op = MARK;
+    const char setitem_op = SETITEM;
+    const char setitems_op = SETITEMS;
+
+    if (_PickleWorker_Write(w, &empty_dict_op, 1) < 0 ||
+        _PickleWorker_MemoPut(w, obj) < 0)
+        return -1;
+    if (PyDict_Size(obj) == 0)
+        return 0;
+    if (PyDict_Size(obj) == 1) {
+        PyDict_Next(obj, &ppos, &key, &value);
+        if (_PickleWorker_Save(w, key) < 0 ||
+            _PickleWorker_Save(w, value) < 0)
+            return -1;
+        return _PickleWorker_Write(w, &setitem_op, 1);
+    }
+
+    do {
+        i = 0;
+        if (_PickleWorker_Write(w, &mark_op, 1) < 0)
+            return -1;
+        while (PyDict_Next(obj, &ppos, &key, &value)) {
+            if (_PickleWorker_Save(w, key) < 0 ||
+                _PickleWorker_Save(w, value) < 0)
+                return -1;
+            if (++i == BATCHSIZE)
+                break;
+        }
+        if (_PickleWorker_Write(w, &setitems_op, 1) < 0)
+            return -1;
+    } while (i == BATCHSIZE);
+    return 0;
+}
+
+static int
+_PickleWorker_Save(PickleWorker *w, PyObject *obj)
+{
+    PyTypeObject *type = Py_TYPE(obj);
+    PyMemoEntry *entry;
+    int status;
+
+    /* Like _Pickler_OpcodeBoundary(), let the main thread commit a frame
+       here if enough data was written since the last boundary. */
+    if (w->output_len - w->last_boundary >= FRAME_SIZE_TARGET) {
+        if (_PickleWorker_AddEvent(w, PICKLE_WORKER_BOUNDARY) < 0)
+            return -1;
+        w->last_boundary = w->output_len;
+    }
+
+    if (obj == Py_None) {
+        const char none_op = NONE;
+        return _PickleWorker_Write(w, &none_op, 1);
+    }
+    else if (obj == Py_False || obj == Py_True) {
+        const char bool_op = (obj == Py_True) ? NEWTRUE : NEWFALSE;
+        return _PickleWorker_Write(w, &bool_op, 1);
+    }
+    else if (type == &PyLong_Type) {
+        return _PickleWorker_SaveLong(w, obj);
+    }
+    else if (type == &PyFloat_Type) {
+        return _PickleWorker_SaveFloat(w, obj);
+    }
+
+    entry = _PyMemoTable_Lookup(&w->memo, obj);
+    if (entry->me_key != NULL)
+        return _PickleWorker_AddEvent(w, entry->me_value);
+
+    if (type == &PyUnicode_Type)
+        return _PickleWorker_SaveUnicode(w, obj);
+    else if (type == &PyBytes_Type)
+        return _PickleWorker_SaveBytes(w, obj);
+
+    if (obj == w->container || w->depth >= PICKLE_WORKER_MAX_DEPTH)
+        return _PickleWorker_Fail(w);
+    w->depth++;
+    if (type == &PyTuple_Type)
+        status = _PickleWorker_SaveTuple(w, obj);
+    else if (type == &PyList_Type)
+        status = _PickleWorker_SaveList(w, obj);
+    else if (type == &PyDict_Type)
+        status = _PickleWorker_SaveDict(w, obj);
+    else
+        status = _PickleWorker_Fail(w);
+    w->depth--;
+    return status;
+}
+
+/* Save the items of the worker from start to stop, in batches of
+   MARK ... APPENDS or MARK ... SETITEMS.  Advance start. */
+static void
+_PickleWorker_Run(PickleWorker *w, Py_ssize_t stop)
+{
+    Py_ssize_t i = w->start;
+    const char mark_op = MARK;
+    const char end_op = w->dict_items ? SETITEMS : APPENDS;
+
+    while (i < stop) {
+        Py_ssize_t batch_end = Py_MIN(i + BATCHSIZE, stop);
+
+        if (_PickleWorker_Write(w, &mark_op, 1) < 0)
+            return;
+        for (; i < batch_end; i++) {
+            if (w->dict_items) {
+                if (_PickleWorker_Save(w, w->items[2 * i]) < 0 ||
+                    _PickleWorker_Save(w, w->items[2 * i + 1]) < 0)
+                    return;
+            }
+            else if (_PickleWorker_Save(w, w->items[i]) < 0)
+                return;
+        }
+        if (_PickleWorker_Write(w, &end_op, 1) < 0)
+            return;
+    }
+    w->start = i;
+}
+
+static void
+_PickleWorker_Main(void *arg)
+{
+    PickleWorker *w = (PickleWorker *)arg;
+
+    _PickleWorker_Run(w, w->stop);
+    PyThread_release_lock(w->done);
+}
+
+/* Write the output of a worker, whose memo indices start at base. */
+static int
+_Pickler_SpliceWorker(PicklerObject *self, PickleWorker *w, Py_ssize_t base)
+{
+    Py_ssize_t i, pos = 0;
+
+    for (i = 0; i < w->events_len; i++) {
+        PickleWorkerEvent *event = &w->events[i];
+
+        if (event->pos > pos) {
+            if (_Pickler_Write(self, w->output + pos, event->pos - pos) < 0)
+                return -1;
+            pos = event->pos;
+        }
+        if (event->memo_index == PICKLE_WORKER_BOUNDARY) {
+            if (_Pickler_OpcodeBoundary(self) < 0)
+                return -1;
+        }
+        else if (memo_get_index(self, event->memo_index >= 0 ?
+                                      base + event->memo_index :
+                                      -1 - event->memo_index) < 0)
+            return -1;
+    }
+    if (w->output_len > pos &&
+        _Pickler_Write(self, w->output + pos, w->output_len - pos) < 0)
+        return -1;
+    return 0;
+}
+
+/* Return 1 if a list or a dict was saved by two workers: its identity
+   would not be preserved. */
+static int
+_PickleWorker_ShareContainers(PickleWorker *workers, Py_ssize_t nworkers)
+{
+    Py_ssize_t i, j, k;
+
+    for (i = 1; i < nworkers; i++) {
+        PyMemoTable *memo = &workers[i].memo;
+
+        for (j = 0; j < memo->mt_allocated; j++) {
+            PyObject *key = memo->mt_table[j].me_key;
+
+            /* Objects of the first batch are shared by reference */
+            if (key == NULL || memo->mt_table[j].me_value < 0 ||
+                (Py_TYPE(key) != &PyList_Type && Py_TYPE(key) != &PyDict_Type))
+                continue;
+            for (k = 0; k < i; k++) {
+                if (_PyMemoTable_Lookup(&workers[k].memo, key)->me_key != NULL)
+                    return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* Pickle obj like dump(), saving the items of a large list or dict in up
+   to nworkers threads. */
+static int
+dump_parallel(PicklerObject *self, PyObject *obj, Py_ssize_t nworkers)
+{
+    PickleWorker *workers = NULL;
+    PyObject **items = NULL;
+    Py_ssize_t i, j, n, nbatches, base;
+    int dict_items = PyDict_CheckExact(obj);
+    int status = -1, float_ok;
+    unsigned char packed[8];
+    char header[3];
+    const char mark_op = MARK;
+    const char setitems_op = SETITEMS;
+    const char stop_op = STOP;
+
+    if (nworkers <= 1 || self->proto < 4 || self->fast ||
+        self->pers_func != NULL || self->buffer_callback != NULL ||
+        PyMemoTable_Size(self->memo) != 0 ||
+        !(dict_items || PyList_CheckExact(obj)))
+        return dump(self, obj);
+    n = dict_items ? PyDict_Size(obj) : PyList_GET_SIZE(obj);
+    nbatches = (n + BATCHSIZE - 1) / BATCHSIZE;
+    if (nbatches < 2)
+        return dump(self, obj);
+    if (nworkers > nbatches)
+        nworkers = nbatches;
+
+    if (dict_items) {
+        PyObject *key, *value;
+        Py_ssize_t ppos = 0;
+
+        if (n > PY_SSIZE_T_MAX / (Py_ssize_t)(2 * sizeof(PyObject *))) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        items = PyMem_Malloc(2 * n * sizeof(PyObject *));
+        if (items == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        for (i = 0; PyDict_Next(obj, &ppos, &key, &value); i++) {
+            items[2 * i] = key;
+            items[2 * i + 1] = value;
+        }
+    }
+    workers = PyMem_Malloc(nworkers * sizeof(PickleWorker));
+    if (workers == NULL) {
+        PyErr_NoMemory();
         goto done;
     }
+    memset(workers, 0, nworkers * sizeof(PickleWorker));
 
-    /* XXX: This part needs some unit tests. */
+    /* _PyFloat_Pack8() only fails for infinities and NaNs, and only if
+       the platform does not use IEEE 754 doubles. */
+    float_ok = (_PyFloat_Pack8(Py_HUGE_VAL, packed, 0) == 0);
+    if (!float_ok)
+        PyErr_Clear();
 
-    /* Get a reduction callable, and call it.  This may come from
-     * self.dispatch_table, copyreg.dispatch_table, the object's
-     * __reduce_ex__ method, or the object's __reduce__ method.
-     */
-    if (self->dispatch_table == NULL) {
-        PickleState *st = _Pickle_GetGlobalState();
-        reduce_func = PyDict_GetItemWithError(st->dispatch_table,
-                                              (PyObject *)type);
-        if (reduce_func == NULL) {
-            if (PyErr_Occurred()) {
-                goto error;
-            }
-        } else {
-            /* PyDict_GetItemWithError() returns a borrowed reference.
-               Increase the reference count to be consistent with
-               PyObject_GetItem and _PyObject_GetAttrId used below. */
-            Py_INCREF(reduce_func);
-        }
-    } else {
-        reduce_func = PyObject_GetItem(self->dispatch_table,
-                                       (PyObject *)type);
-        if (reduce_func == NULL) {
-            if (PyErr_ExceptionMatches(PyExc_KeyError))
-                PyErr_Clear();
-            else
-                goto error;
+    for (i = 0; i < nworkers; i++) {
+        PickleWorker *w = &workers[i];
+
+        w->items = dict_items ? items : ((PyListObject *)obj)->ob_item;
+        w->dict_items = dict_items;
+        w->start = Py_MIN(nbatches * i / nworkers * BATCHSIZE, n);
+        w->stop = Py_MIN(nbatches * (i + 1) / nworkers * BATCHSIZE, n);
+        w->float_ok = float_ok;
+        w->container = obj;
+        w->memo.mt_allocated = 64;
+        w->memo.mt_mask = 63;
+        w->memo.mt_table = PyMem_RawMalloc(64 * sizeof(PyMemoEntry));
+        if (w->memo.mt_table == NULL) {
+            PyErr_NoMemory();
+            goto done;
         }
+        memset(w->memo.mt_table, 0, 64 * sizeof(PyMemoEntry));
     }
-    if (reduce_func != NULL) {
-        Py_INCREF(obj);
-        reduce_value = _Pickle_FastCall(reduce_func, obj);
-    }
-    else if (PyType_IsSubtype(type, &PyType_Type)) {
-        status = save_global(self, obj, NULL);
+
+    /* Save the first batch before starting the workers: the objects it
+       memoizes, such as the keys of similar dicts, can be referenced from
+       all the ranges by their final (small) memo index. */
+    _PickleWorker_Run(&workers[0], workers[0].start + BATCHSIZE);
+    if (workers[0].failed) {
+        status = dump(self, obj);
         goto done;
     }
-    else {
-        _Py_IDENTIFIER(__reduce__);
-        _Py_IDENTIFIER(__reduce_ex__);
+    for (i = 1; i < nworkers; i++) {
+        PickleWorker *w = &workers[i];
+        PyMemoTable *seed = &workers[0].memo;
 
+        PyMem_RawFree(w->memo.mt_table);
+        w->memo.mt_table = PyMem_RawMalloc(seed->mt_allocated *
+                                           sizeof(PyMemoEntry));
+        if (w->memo.mt_table == NULL) {
+            PyErr_NoMemory();
+            goto done;
+        }
+        w->memo.mt_allocated = seed->mt_allocated;
+        w->memo.mt_mask = seed->mt_mask;
+        w->memo.mt_used = w->memo_seeded = seed->mt_used;
+        for (j = 0; j < seed->mt_allocated; j++) {
+            /* The first batch is saved right after the container, which
+               has index 0. */
+            w->memo.mt_table[j].me_key = seed->mt_table[j].me_key;
+            w->memo.mt_table[j].me_value = -2 - seed->mt_table[j].me_value;
+        }
+    }
 
-        /* XXX: If the __reduce__ method is defined, __reduce_ex__ is
-           automatically defined as __reduce__. While this is convenient, this
-           make it impossible to know which method was actually called. Of
-           course, this is not a big deal. But still, it would be nice to let
-           the user know which method was called when something go
-           wrong. Incidentally, this means if __reduce_ex__ is not defined, we
-           don't actually have to check for a __reduce__ method. */
+    /* The main thread saves the first range, and the ranges of the
+       workers which could not be started. */
+    for (i = 1; i < nworkers; i++) {
+        PickleWorker *w = &workers[i];
 
-        /* Check for a __reduce_ex__ method. */
-        reduce_func = _PyObject_GetAttrId(obj, &PyId___reduce_ex__);
-        if (reduce_func != NULL) {
-            PyObject *proto;
-            proto = PyLong_FromLong(self->proto);
-            if (proto != NULL) {
-                reduce_value = _Pickle_FastCall(reduce_func, proto);
-            }
+        w->done = PyThread_allocate_lock();
+        if (w->done == NULL)
+            continue;
+        PyThread_acquire_lock(w->done, WAIT_LOCK);
+        if (PyThread_start_new_thread(_PickleWorker_Main, w) == -1) {
+            PyThread_release_lock(w->done);
+            PyThread_free_lock(w->done);
+            w->done = NULL;
         }
-        else {
-            PickleState *st = _Pickle_GetGlobalState();
+    }
+    for (i = 0; i < nworkers; i++) {
+        if (workers[i].done == NULL)
+            _PickleWorker_Run(&workers[i], workers[i].stop);
+    }
+    for (i = 1; i < nworkers; i++) {
+        PickleWorker *w = &workers[i];
 
-            if (PyErr_ExceptionMatches(PyExc_AttributeError)) {
-                PyErr_Clear();
-            }
-            else {
-                goto error;
-            }
-            /* Check for a __reduce__ method. */
-            reduce_func = _PyObject_GetAttrId(obj, &PyId___reduce__);
-            if (reduce_func != NULL) {
-                PyObject *empty_tuple = PyTuple_New(0);
-                reduce_value = PyObject_Call(reduce_func, empty_tuple,
-                                             NULL);
-                Py_DECREF(empty_tuple);
-            }
-            else {
-                PyErr_Format(st->PicklingError,
-                             "can't pickle '%.200s' object: %R",
-                             type->tp_name, obj);
-                goto error;
-            }
+        if (w->done != NULL) {
+            PyThread_acquire_lock(w->done, WAIT_LOCK);
+            PyThread_release_lock(w->done);
+            PyThread_free_lock(w->done);
+            w->done = NULL;
         }
     }
 
-    if (reduce_value == NULL)
-        goto error;
-
-    if (PyUnicode_Check(reduce_value)) {
-        status = save_global(self, obj, reduce_value);
+    for (i = 0; i < nworkers; i++) {
+        if (workers[i].failed) {
+            status = dump(self, obj);
+            goto done;
+        }
+    }
+    if (_PickleWorker_ShareContainers(workers, nworkers)) {
+        status = dump(self, obj);
         goto done;
     }
 
-    if (!PyTuple_Check(reduce_value)) {
-        PickleState *st = _Pickle_GetGlobalState();
-        PyErr_SetString(st->PicklingError,
-                        "__reduce__ must return a string or tuple");
-        goto error;
+    /* PROTO, EMPTY_LIST or EMPTY_DICT, then memoize the container */
+    header[0] = PROTO;
+    header[1] = (unsigned char)self->proto;
+    header[2] = dict_items ? EMPTY_DICT : EMPTY_LIST;
+    if (_Pickler_Write(self, header, 2) < 0)
+        goto done;
+    self->framing = 1;
+    if (_Pickler_Write(self, header + 2, 1) < 0 ||
+        memo_put(self, obj) < 0)
+        goto done;
+    base = PyMemoTable_Size(self->memo);
+    for (i = 0; i < nworkers; i++) {
+        if (_Pickler_SpliceWorker(self, &workers[i], base) < 0)
+            goto done;
+        base += workers[i].memo.mt_used - workers[i].memo_seeded;
     }
-
-    status = save_reduce(self, reduce_value, obj);
-
-    if (0) {
-  error:
-        status = -1;
+    /* batch_dict_exact() ends with an empty batch if the last one is
+       full. */
+    if (dict_items && n % BATCHSIZE == 0) {
+        if (_Pickler_Write(self, &mark_op, 1) < 0 ||
+            _Pickler_Write(self, &setitems_op, 1) < 0)
+            goto done;
     }
-  done:
-
-    Py_LeaveRecursiveCall();
-    Py_XDECREF(reduce_func);
-    Py_XDECREF(reduce_value);
+    if (_Pickler_Write(self, &stop_op, 1) < 0)
+        goto done;
+    status = 0;
 
+  done:
+    if (workers != NULL) {
+        for (i = 0; i < nworkers; i++) {
+            PyMem_RawFree(workers[i].output);
+            PyMem_RawFree(workers[i].events);
+            PyMem_RawFree(workers[i].memo.mt_table);
+        }
+        PyMem_Free(workers);
+    }
+    PyMem_Free(items);
     return status;
 }
 
+#else /* !WITH_THREAD */
+
 static int
-dump(PicklerObject *self, PyObject *obj)
+dump_parallel(PicklerObject *self, PyObject *obj, Py_ssize_t nworkers)
 {
-    const char stop_op = STOP;
-
-    if (self->proto >= 2) {
-        char header[2];
-
-        header[0] = PROTO;
-        assert(self->proto >= 0 && self->proto < 256);
-        header[1] = (unsigned char)self->proto;
-        if (_Pickler_Write(self, header, 2) < 0)
-            return -1;
-        if (self->proto >= 4)
-            self->framing = 1;
-    }
-
-    if (save(self, obj, 0) < 0 ||
-        _Pickler_Write(self, &stop_op, 1) < 0)
-        return -1;
-
-    return 0;
+    return dump(self, obj);
 }
 
+#endif /* WITH_THREAD */
+
 /*[clinic input]
 
 _pickle.Pickler.clear_memo
@@ -4020,6 +5441,7 @@ Pickler_dealloc(PicklerObject *self)
     Py_XDECREF(self->pers_func);
     Py_XDECREF(self->dispatch_table);
     Py_XDECREF(self->fast_memo);
+    Py_XDECREF(self->buffer_callback);
 
     PyMemoTable_Del(self->memo);
 
@@ -4033,6 +5455,7 @@ Pickler_traverse(PicklerObject *self, visitproc visit, void *arg)
     Py_VISIT(self->pers_func);
     Py_VISIT(self->dispatch_table);
     Py_VISIT(self->fast_memo);
+    Py_VISIT(self->buffer_callback);
     return 0;
 }
 
@@ -4044,6 +5467,7 @@ Pickler_clear(PicklerObject *self)
     Py_CLEAR(self->pers_func);
     Py_CLEAR(self->dispatch_table);
     Py_CLEAR(self->fast_memo);
+    Py_CLEAR(self->buffer_callback);
 
     if (self->memo != NULL) {
         PyMemoTable *memo = self->memo;
@@ -4061,11 +5485,12 @@ _pickle.Pickler.__init__
   file: object
   protocol: object = NULL
   fix_imports: bool = True
+  buffer_callback: object = None
 
 This takes a binary file for writing a pickle data stream.
 
 The optional *protocol* argument tells the pickler to use the given
-protocol; supported protocols are 0, 1, 2, 3 and 4.  The default
+protocol; supported protocols are 0, 1, 2, 3, 4 and 5.  The default
 protocol is 3; a backward-incompatible protocol designed for Python 3.
 
 Specifying a negative protocol version selects the highest protocol
@@ -4080,11 +5505,22 @@ this interface.
 If *fix_imports* is True and protocol is less than 3, pickle will try
 to map the new Python 3 names to the old module names used in Python
 2, so that the pickle data stream is readable with Python 2.
+
+If *buffer_callback* is None (the default), buffer views are
+serialized into *file* as part of the pickle stream.
+
+If *buffer_callback* is not None, then it can be called any number
+of times with a buffer view.  If the callback returns a false value
+(such as None), the given buffer is out-of-band; otherwise the
+buffer is serialized in-band, i.e. inside the pickle stream.
+
+It is an error if *buffer_callback* is not None and *protocol*
+is None or smaller than 5.
 [clinic start generated code]*/
 
 static int
-_pickle_Pickler___init___impl(PicklerObject *self, PyObject *file, PyObject *protocol, int fix_imports)
-/*[clinic end generated code: output=56e229f3b1f4332f input=b8cdeb7e3f5ee674]*/
+_pickle_Pickler___init___impl(PicklerObject *self, PyObject *file, PyObject *protocol, int fix_imports, PyObject *buffer_callback)
+/*[clinic end generated code: output=057a35d000ff3feb input=8a125a64f75adf8d]*/
 {
     _Py_IDENTIFIER(persistent_id);
     _Py_IDENTIFIER(dispatch_table);
@@ -4099,6 +5535,9 @@ _pickle_Pickler___init___impl(PicklerObject *self, PyObject *file, PyObject *pro
     if (_Pickler_SetOutputStream(self, file) < 0)
         return -1;
 
+    if (_Pickler_SetBufferCallback(self, buffer_callback) < 0)
+        return -1;
+
     /* memo and output_buffer may have already been created in _Pickler_New */
     if (self->memo == NULL) {
         self->memo = PyMemoTable_New();
@@ -4886,17 +6325,101 @@ load_counted_binbytes(UnpicklerObject *self, int nbytes)
         return -1;
     }
 
-    if (_Unpickler_Read(self, &s, size) < 0)
-        return -1;
-
-    bytes = PyBytes_FromStringAndSize(s, size);
+    bytes = PyBytes_FromStringAndSize(NULL, size);
     if (bytes == NULL)
         return -1;
+    if (_Unpickler_ReadInto(self, PyBytes_AS_STRING(bytes), size) < 0) {
+        Py_DECREF(bytes);
+        return -1;
+    }
 
     PDATA_PUSH(self->stack, bytes, -1);
     return 0;
 }
 
+static int
+load_counted_bytearray(UnpicklerObject *self)
+{
+    PyObject *bytearray;
+    Py_ssize_t size;
+    char *s;
+
+    if (_Unpickler_Read(self, &s, 8) < 0)
+        return -1;
+
+    size = calc_binsize(s, 8);
+    if (size < 0) {
+        PyErr_Format(PyExc_OverflowError,
+                     "BYTEARRAY8 exceeds system's maximum size of %zd bytes",
+                     PY_SSIZE_T_MAX);
+        return -1;
+    }
+
+    bytearray = PyByteArray_FromStringAndSize(NULL, size);
+    if (bytearray == NULL)
+        return -1;
+    if (_Unpickler_ReadInto(self, PyByteArray_AS_STRING(bytearray),
+                            size) < 0) {
+        Py_DECREF(bytearray);
+        return -1;
+    }
+
+    PDATA_PUSH(self->stack, bytearray, -1);
+    return 0;
+}
+
+static int
+load_next_buffer(UnpicklerObject *self)
+{
+    PyObject *buf;
+
+    if (self->buffers == NULL) {
+        PickleState *st = _Pickle_GetGlobalState();
+        PyErr_SetString(st->UnpicklingError,
+                        "pickle stream refers to out-of-band data "
+                        "but no *buffers* argument was given");
+        return -1;
+    }
+    buf = PyIter_Next(self->buffers);
+    if (buf == NULL) {
+        if (!PyErr_Occurred()) {
+            PickleState *st = _Pickle_GetGlobalState();
+            PyErr_SetString(st->UnpicklingError,
+                            "not enough out-of-band buffers");
+        }
+        return -1;
+    }
+
+    PDATA_PUSH(self->stack, buf, -1);
+    return 0;
+}
+
+static int
+load_readonly_buffer(UnpicklerObject *self)
+{
+    Py_ssize_t len = Py_SIZE(self->stack);
+    PyObject *obj, *view;
+
+    if (len <= 0)
+        return stack_underflow();
+
+    obj = self->stack->data[len - 1];
+    view = PyMemoryView_FromObject(obj);
+    if (view == NULL)
+        return -1;
+    if (!PyMemoryView_GET_BUFFER(view)->readonly) {
+        /* The supplied buffer is writable: replace it with a read-only
+           view of it */
+        PyMemoryView_GET_BUFFER(view)->readonly = 1;
+        self->stack->data[len - 1] = view;
+        Py_DECREF(obj);
+    }
+    else {
+        Py_DECREF(view);
+    }
+    return 0;
+}
+
 static int
 load_unicode(UnpicklerObject *self)
 {
@@ -6143,6 +7666,9 @@ load(UnpicklerObject *self)
         OP_ARG(SHORT_BINBYTES, load_counted_binbytes, 1)
         OP_ARG(BINBYTES, load_counted_binbytes, 4)
         OP_ARG(BINBYTES8, load_counted_binbytes, 8)
+        OP(BYTEARRAY8, load_counted_bytearray)
+        OP(NEXT_BUFFER, load_next_buffer)
+        OP(READONLY_BUFFER, load_readonly_buffer)
         OP_ARG(SHORT_BINSTRING, load_counted_binstring, 1)
         OP_ARG(BINSTRING, load_counted_binstring, 4)
         OP(STRING, load_string)
@@ -6404,6 +7930,8 @@ Unpickler_dealloc(UnpicklerObject *self)
     Py_XDECREF(self->readline);
     Py_XDECREF(self->read);
     Py_XDECREF(self->peek);
+    Py_XDECREF(self->readinto);
+    Py_XDECREF(self->buffers);
     Py_XDECREF(self->stack);
     Py_XDECREF(self->pers_func);
     if (self->buffer.buf != NULL) {
@@ -6426,6 +7954,8 @@ Unpickler_traverse(UnpicklerObject *self, visitproc visit, void *arg)
     Py_VISIT(self->readline);
     Py_VISIT(self->read);
     Py_VISIT(self->peek);
+    Py_VISIT(self->readinto);
+    Py_VISIT(self->buffers);
     Py_VISIT(self->stack);
     Py_VISIT(self->pers_func);
     return 0;
@@ -6437,6 +7967,8 @@ Unpickler_clear(UnpicklerObject *self)
     Py_CLEAR(self->readline);
     Py_CLEAR(self->read);
     Py_CLEAR(self->peek);
+    Py_CLEAR(self->readinto);
+    Py_CLEAR(self->buffers);
     Py_CLEAR(self->stack);
     Py_CLEAR(self->pers_func);
     if (self->buffer.buf != NULL) {
@@ -6466,6 +7998,7 @@ _pickle.Unpickler.__init__
   fix_imports: bool = True
   encoding: str = 'ASCII'
   errors: str = 'strict'
+  buffers: object(c_default="NULL") = ()
 
 This takes a binary file for reading a pickle data stream.
 
@@ -6487,11 +8020,16 @@ map the old Python 2 names to the new names used in Python 3.  The
 instances pickled by Python 2; these default to 'ASCII' and 'strict',
 respectively.  The *encoding* can be 'bytes' to read these 8-bit
 string instances as bytes objects.
+
+If *buffers* is not None, it should be an iterable of buffer-enabled
+objects that is consumed each time the pickle stream references an
+out-of-band buffer view.  Such buffers have been given in order to
+the *buffer_callback* of a Pickler object.
 [clinic start generated code]*/
 
 static int
-_pickle_Unpickler___init___impl(UnpicklerObject *self, PyObject *file, int fix_imports, const char *encoding, const char *errors)
-/*[clinic end generated code: output=b9ed1d84d315f3b5 input=30b4dc9e976b890c]*/
+_pickle_Unpickler___init___impl(UnpicklerObject *self, PyObject *file, int fix_imports, const char *encoding, const char *errors, PyObject *buffers)
+/*[clinic end generated code: output=2c09d9d833785d64 input=a7c58f6ce4b1f5e0]*/
 {
     _Py_IDENTIFIER(persistent_load);
 
@@ -6505,6 +8043,9 @@ _pickle_Unpickler___init___impl(UnpicklerObject *self, PyObject *file, int fix_i
     if (_Unpickler_SetInputEncoding(self, encoding, errors) < 0)
         return -1;
 
+    if (_Unpickler_SetBuffers(self, buffers) < 0)
+        return -1;
+
     self->fix_imports = fix_imports;
     if (self->fix_imports == -1)
         return -1;
@@ -6726,6 +8267,7 @@ Unpickler_set_memo(UnpicklerObject *self, PyObject *obj)
 {
     PyObject **new_memo;
     Py_ssize_t new_memo_size = 0;
+    Py_ssize_t new_memo_len = 0;
     Py_ssize_t i;
 
     if (obj == NULL) {
@@ -6747,34 +8289,51 @@ Unpickler_set_memo(UnpicklerObject *self, PyObject *obj)
             Py_XINCREF(unpickler->memo[i]);
             new_memo[i] = unpickler->memo[i];
         }
+        new_memo_len = unpickler->memo_len;
     }
     else if (PyDict_Check(obj)) {
-        Py_ssize_t i = 0;
+        Py_ssize_t pos = 0;
+        Py_ssize_t max_idx = -1;
         PyObject *key, *value;
 
-        new_memo_size = PyDict_Size(obj);
-        new_memo = _Unpickler_NewMemo(new_memo_size);
-        if (new_memo == NULL)
-            return -1;
-
-        while (PyDict_Next(obj, &i, &key, &value)) {
+        /* The keys may be sparse, so size the new array from the largest
+           key rather than from the number of entries. */
+        while (PyDict_Next(obj, &pos, &key, &value)) {
             Py_ssize_t idx;
             if (!PyLong_Check(key)) {
                 PyErr_SetString(PyExc_TypeError,
                                 "memo key must be integers");
-                goto error;
+                return -1;
             }
             idx = PyLong_AsSsize_t(key);
             if (idx == -1 && PyErr_Occurred())
-                goto error;
+                return -1;
             if (idx < 0) {
                 PyErr_SetString(PyExc_ValueError,
                                 "memo key must be positive integers.");
-                goto error;
+                return -1;
             }
-            if (_Unpickler_MemoPut(self, idx, value) < 0)
-                goto error;
+            if (idx > max_idx)
+                max_idx = idx;
+        }
+        if (max_idx == PY_SSIZE_T_MAX ||
+            max_idx >= PY_SSIZE_T_MAX / (Py_ssize_t)sizeof(PyObject *)) {
+            PyErr_NoMemory();
+            return -1;
+        }
+
+        new_memo_size = max_idx + 1;
+        new_memo = _Unpickler_NewMemo(new_memo_size);
+        if (new_memo == NULL)
+            return -1;
+
+        pos = 0;
+        while (PyDict_Next(obj, &pos, &key, &value)) {
+            Py_ssize_t idx = PyLong_AsSsize_t(key);
+            Py_INCREF(value);
+            new_memo[idx] = value;
         }
+        new_memo_len = PyDict_Size(obj);
     }
     else {
         PyErr_Format(PyExc_TypeError,
@@ -6785,19 +8344,10 @@ Unpickler_set_memo(UnpicklerObject *self, PyObject *obj)
 
     _Unpickler_MemoCleanup(self);
     self->memo_size = new_memo_size;
+    self->memo_len = new_memo_len;
     self->memo = new_memo;
 
     return 0;
-
-  error:
-    if (new_memo_size) {
-        i = new_memo_size;
-        while (--i >= 0) {
-            Py_XDECREF(new_memo[i]);
-        }
-        PyMem_FREE(new_memo);
-    }
-    return -1;
 }
 
 static PyObject *
@@ -6894,6 +8444,8 @@ _pickle.dump
   protocol: object = NULL
   *
   fix_imports: bool = True
+  buffer_callback: object = None
+  workers: object = None
 
 Write a pickled representation of obj to the open file object file.
 
@@ -6901,7 +8453,7 @@ This is equivalent to ``Pickler(file, protocol).dump(obj)``, but may
 be more efficient.
 
 The optional *protocol* argument tells the pickler to use the given
-protocol supported protocols are 0, 1, 2, 3 and 4.  The default
+protocol supported protocols are 0, 1, 2, 3, 4 and 5.  The default
 protocol is 3; a backward-incompatible protocol designed for Python 3.
 
 Specifying a negative protocol version selects the highest protocol
@@ -6916,12 +8468,21 @@ this interface.
 If *fix_imports* is True and protocol is less than 3, pickle will try
 to map the new Python 3 names to the old module names used in Python
 2, so that the pickle data stream is readable with Python 2.
+
+If *buffer_callback* is None (the default), buffer views are serialized
+into *file* as part of the pickle stream.  It is an error if
+*buffer_callback* is not None and *protocol* is None or smaller than 5.
+
+If *workers* is greater than 1 and *protocol* is 4 or higher, the items
+of a large list or dict are pickled in up to *workers* threads.  Shared
+references to immutable objects may then be pickled several times.
 [clinic start generated code]*/
 
 static PyObject *
-_pickle_dump_impl(PyModuleDef *module, PyObject *obj, PyObject *file, PyObject *protocol, int fix_imports)
-/*[clinic end generated code: output=a606e626d553850d input=e9e5fdd48de92eae]*/
+_pickle_dump_impl(PyModuleDef *module, PyObject *obj, PyObject *file, PyObject *protocol, int fix_imports, PyObject *buffer_callback, PyObject *workers)
+/*[clinic end generated code: output=b6328f219cb351d1 input=1f7dee491c149047]*/
 {
+    Py_ssize_t nworkers;
     PicklerObject *pickler = _Pickler_New();
 
     if (pickler == NULL)
@@ -6933,7 +8494,13 @@ _pickle_dump_impl(PyModuleDef *module, PyObject *obj, PyObject *file, PyObject *
     if (_Pickler_SetOutputStream(pickler, file) < 0)
         goto error;
 
-    if (dump(pickler, obj) < 0)
+    if (_Pickler_SetBufferCallback(pickler, buffer_callback) < 0)
+        goto error;
+
+    if (_Pickle_ParseWorkers(workers, &nworkers) < 0)
+        goto error;
+
+    if (dump_parallel(pickler, obj, nworkers) < 0)
         goto error;
 
     if (_Pickler_FlushToFile(pickler) < 0)
@@ -6955,11 +8522,13 @@ _pickle.dumps
   protocol: object = NULL
   *
   fix_imports: bool = True
+  buffer_callback: object = None
+  workers: object = None
 
 Return the pickled representation of the object as a bytes object.
 
 The optional *protocol* argument tells the pickler to use the given
-protocol; supported protocols are 0, 1, 2, 3 and 4.  The default
+protocol; supported protocols are 0, 1, 2, 3, 4 and 5.  The default
 protocol is 3; a backward-incompatible protocol designed for Python 3.
 
 Specifying a negative protocol version selects the highest protocol
@@ -6969,13 +8538,22 @@ version of Python needed to read the pickle produced.
 If *fix_imports* is True and *protocol* is less than 3, pickle will
 try to map the new Python 3 names to the old module names used in
 Python 2, so that the pickle data stream is readable with Python 2.
+
+If *buffer_callback* is None (the default), buffer views are serialized
+into the pickle stream.  It is an error if *buffer_callback* is not None
+and *protocol* is None or smaller than 5.
+
+If *workers* is greater than 1 and *protocol* is 4 or higher, the items
+of a large list or dict are pickled in up to *workers* threads.  Shared
+references to immutable objects may then be pickled several times.
 [clinic start generated code]*/
 
 static PyObject *
-_pickle_dumps_impl(PyModuleDef *module, PyObject *obj, PyObject *protocol, int fix_imports)
-/*[clinic end generated code: output=777f0deefe5b88ee input=293dbeda181580b7]*/
+_pickle_dumps_impl(PyModuleDef *module, PyObject *obj, PyObject *protocol, int fix_imports, PyObject *buffer_callback, PyObject *workers)
+/*[clinic end generated code: output=f45594afacad880c input=ea962e8f3f76d111]*/
 {
     PyObject *result;
+    Py_ssize_t nworkers;
     PicklerObject *pickler = _Pickler_New();
 
     if (pickler == NULL)
@@ -6984,7 +8562,13 @@ _pickle_dumps_impl(PyModuleDef *module, PyObject *obj, PyObject *protocol, int f
     if (_Pickler_SetProtocol(pickler, protocol, fix_imports) < 0)
         goto error;
 
-    if (dump(pickler, obj) < 0)
+    if (_Pickler_SetBufferCallback(pickler, buffer_callback) < 0)
+        goto error;
+
+    if (_Pickle_ParseWorkers(workers, &nworkers) < 0)
+        goto error;
+
+    if (dump_parallel(pickler, obj, nworkers) < 0)
         goto error;
 
     result = _Pickler_GetString(pickler);
@@ -7005,6 +8589,7 @@ _pickle.load
   fix_imports: bool = True
   encoding: str = 'ASCII'
   errors: str = 'strict'
+  buffers: object(c_default="NULL") = ()
 
 Read and return an object from the pickle data stored in a file.
 
@@ -7029,11 +8614,16 @@ map the old Python 2 names to the new names used in Python 3.  The
 instances pickled by Python 2; these default to 'ASCII' and 'strict',
 respectively.  The *encoding* can be 'bytes' to read these 8-bit
 string instances as bytes objects.
+
+If *buffers* is not None, it should be an iterable of buffer-enabled
+objects that is consumed each time the pickle stream references an
+out-of-band buffer view.  Such buffers have been given in order to
+the *buffer_callback* of a Pickler object.
 [clinic start generated code]*/
 
 static PyObject *
-_pickle_load_impl(PyModuleDef *module, PyObject *file, int fix_imports, const char *encoding, const char *errors)
-/*[clinic end generated code: output=568c61356c172654 input=da97372e38e510a6]*/
+_pickle_load_impl(PyModuleDef *module, PyObject *file, int fix_imports, const char *encoding, const char *errors, PyObject *buffers)
+/*[clinic end generated code: output=571de5c768b429d4 input=462d78e6b1dc96c6]*/
 {
     PyObject *result;
     UnpicklerObject *unpickler = _Unpickler_New();
@@ -7047,6 +8637,9 @@ _pickle_load_impl(PyModuleDef *module, PyObject *file, int fix_imports, const ch
     if (_Unpickler_SetInputEncoding(unpickler, encoding, errors) < 0)
         goto error;
 
+    if (_Unpickler_SetBuffers(unpickler, buffers) < 0)
+        goto error;
+
     unpickler->fix_imports = fix_imports;
 
     result = load(unpickler);
@@ -7067,6 +8660,7 @@ _pickle.loads
   fix_imports: bool = True
   encoding: str = 'ASCII'
   errors: str = 'strict'
+  buffers: object(c_default="NULL") = ()
 
 Read and return an object from the given pickle data.
 
@@ -7082,11 +8676,16 @@ map the old Python 2 names to the new names used in Python 3.  The
 instances pickled by Python 2; these default to 'ASCII' and 'strict',
 respectively.  The *encoding* can be 'bytes' to read these 8-bit
 string instances as bytes objects.
+
+If *buffers* is not None, it should be an iterable of buffer-enabled
+objects that is consumed each time the pickle stream references an
+out-of-band buffer view.  Such buffers have been given in order to
+the *buffer_callback* of a Pickler object.
 [clinic start generated code]*/
 
 static PyObject *
-_pickle_loads_impl(PyModuleDef *module, PyObject *data, int fix_imports, const char *encoding, const char *errors)
-/*[clinic end generated code: output=0b3845ad110b2522 input=f57f0fdaa2b4cb8b]*/
+_pickle_loads_impl(PyModuleDef *module, PyObject *data, int fix_imports, const char *encoding, const char *errors, PyObject *buffers)
+/*[clinic end generated code: output=821daef8e0fd58df input=d5a916e3c79bc942]*/
 {
     PyObject *result;
     UnpicklerObject *unpickler = _Unpickler_New();
@@ -7100,6 +8699,9 @@ _pickle_loads_impl(PyModuleDef *module, PyObject *data, int fix_imports, const c
     if (_Unpickler_SetInputEncoding(unpickler, encoding, errors) < 0)
         goto error;
 
+    if (_Unpickler_SetBuffers(unpickler, buffers) < 0)
+        goto error;
+
     unpickler->fix_imports = fix_imports;
 
     result = load(unpickler);
@@ -7185,6 +8787,8 @@ PyInit__pickle(void)
         return NULL;
     if (PyType_Ready(&UnpicklerMemoProxyType) < 0)
         return NULL;
+    if (PyType_Ready(&PickleBuffer_Type) < 0)
+        return NULL;
 
     /* Create the module and add the functions. */
     m = PyModule_Create(&_picklemodule);
@@ -7197,6 +8801,10 @@ PyInit__pickle(void)
     Py_INCREF(&Unpickler_Type);
     if (PyModule_AddObject(m, "Unpickler", (PyObject *)&Unpickler_Type) < 0)
         return NULL;
+    Py_INCREF(&PickleBuffer_Type);
+    if (PyModule_AddObject(m, "PickleBuffer",
+                           (PyObject *)&PickleBuffer_Type) < 0)
+        return NULL;
 
     st = _Pickle_GetState(m);
 
@@ -65,9 +65,17 @@ static char copyright[] =
 /* enables fast searching */
 #define USE_FAST_SEARCH
 
+/* longest part of a required literal looked for with fast searching */
+#define SRE_REQUIRED_MAX 64
+
 /* enables copy/deepcopy handling (work in progress) */
 #undef USE_BUILTIN_COPY
 
+#if defined(USE_FAST_SEARCH)
+/* required literals are looked for with stringlib's fastsearch */
+#include "../Objects/stringlib/sse2.h"
+#endif
+
 /* -------------------------------------------------------------------- */
 
 #if defined(_MSC_VER)
@@ -205,7 +213,7 @@ static void
 data_stack_dealloc(SRE_STATE* state)
 {
     if (state->data_stack) {
-        PyMem_FREE(state->data_stack);
+        PyMem_RawFree(state->data_stack);
         state->data_stack = NULL;
     }
     state->data_stack_size = state->data_stack_base = 0;
@@ -221,7 +229,7 @@ data_stack_grow(SRE_STATE* state, Py_ssize_t size)
         void* stack;
         cursize = minsize+minsize/4+1024;
         TRACE(("allocate/grow stack %" PY_FORMAT_SIZE_T "d\n", cursize));
-        stack = PyMem_REALLOC(state->data_stack, cursize);
+        stack = PyMem_RawRealloc(state->data_stack, cursize);
         if (!stack) {
             data_stack_dealloc(state);
             return SRE_ERROR_MEMORY;
@@ -232,6 +240,1130 @@ data_stack_grow(SRE_STATE* state, Py_ssize_t size)
     return 0;
 }
 
+/* The engines call sre_checkpoint() every so often.  Matching an
+   immutable string can go on without the GIL: it is released at the
+   first checkpoint, so that short matches don't pay for it, and only
+   taken back to run signal handlers.  Memory used while matching is
+   allocated with PyMem_RawMalloc(). */
+
+static int
+sre_checkpoint(SRE_STATE* state)
+{
+#ifdef WITH_THREAD
+    if (state->tstate) {
+        if (!_PyOS_SignalPending())
+            return 0;
+        PyEval_RestoreThread(state->tstate);
+        state->tstate = NULL;
+        if (PyErr_CheckSignals())
+            return SRE_ERROR_INTERRUPTED;
+        state->tstate = PyEval_SaveThread();
+        return 0;
+    }
+#endif
+    if (PyErr_CheckSignals())
+        return SRE_ERROR_INTERRUPTED;
+#ifdef WITH_THREAD
+    if (state->release_gil)
+        state->tstate = PyEval_SaveThread();
+#endif
+    return 0;
+}
+
+LOCAL(void)
+sre_acquire_gil(SRE_STATE* state)
+{
+#ifdef WITH_THREAD
+    if (state->tstate) {
+        PyEval_RestoreThread(state->tstate);
+        state->tstate = NULL;
+    }
+#endif
+}
+
+/* -------------------------------------------------------------------- */
+/* linear time matching */
+
+/* Patterns without backreferences and lookaround assertions are also
+   compiled into a Thompson NFA.  A lazily built DFA simulating it finds
+   where the match ends, and the DFA of the reversed NFA, run backwards
+   from there, finds where it starts.  Both take time linear in the
+   length of the string.  If the pattern has groups, a Pike VM run over
+   the matched span recovers them.  The NFA threads are kept in priority
+   order, so that the result is the one the backtracking engine in
+   sre_lib.h would have found. */
+
+/* NFA instructions */
+#define SRE_NFA_CHAR 0 /* consume a character accepted by op/arg/set */
+#define SRE_NFA_SPLIT 1 /* continue at out, and with lower priority out1 */
+#define SRE_NFA_JUMP 2 /* continue at out */
+#define SRE_NFA_MARK 3 /* store the position in mark[arg] */
+#define SRE_NFA_AT 4 /* check the position code in arg */
+#define SRE_NFA_MATCH 5
+
+/* what the position codes need to know about a position */
+#define SRE_CTX_BEGIN 1 /* at the beginning of the string */
+#define SRE_CTX_END 2 /* at the end of the string */
+#define SRE_CTX_NEWLINE_END 4 /* before a newline ending the string */
+#define SRE_CTX_LINEBREAK 8 /* next to a newline */
+#define SRE_CTX_WORD 16 /* next to a word character */
+#define SRE_CTX_UNI_WORD 32 /* next to a unicode word character */
+
+/* DFA state flags, besides the context of the character consumed */
+#define SRE_DFA_MATCH 64 /* the NFA matched before that character */
+#define SRE_DFA_DEAD 128 /* no threads left */
+
+/* larger patterns are left to the backtracking engine */
+#define SRE_NFA_MAX_SIZE 10000
+#define SRE_NFA_MAX_CAPS (1024*1024)
+
+/* memory a DFA may use before its states are thrown away */
+#define SRE_DFA_MAX_MEMORY (1024*1024)
+
+/* characters consumed by the DFA or the Pike VM between checkpoints */
+#define SRE_CHECK_INTERVAL 4096
+
+typedef struct {
+    int kind;
+    int out, out1;
+    SRE_CODE op; /* opcode testing the character */
+    SRE_CODE arg; /* literal, category, mark or position code */
+    SRE_CODE* set; /* charset for IN and IN_IGNORE */
+} SRE_NFA_INST;
+
+typedef struct SRE_DFA_STATE_T {
+    struct SRE_DFA_STATE_T* hash_next;
+    Py_uhash_t hash;
+    int flags;
+    int n;
+    int* inst; /* NFA threads, highest priority first */
+    struct SRE_DFA_STATE_T* next[1]; /* cached transitions, by class */
+} SRE_DFA_STATE;
+
+typedef struct {
+    SRE_NFA_INST* prog;
+    int first; /* leftmost-first: drop the threads that lost to a match */
+    SRE_DFA_STATE** table;
+    size_t tablesize;
+    size_t nstates;
+    size_t memory;
+    size_t flushes;
+} SRE_DFA;
+
+typedef struct {
+    int n;
+    int* pc;
+    Py_ssize_t* caps;
+} SRE_PIKE_LIST;
+
+typedef struct SRE_NFA_T {
+    SRE_NFA_INST* prog; /* the pattern */
+    int size;
+    int start; /* anchored entry point */
+    int search; /* entry point after a non-greedy .* */
+    SRE_NFA_INST* rprog; /* the reversed pattern */
+    int rsize;
+    int rstart;
+    int ctxmask; /* context used by the position codes */
+    int nclasses; /* equivalence classes of the 8-bit characters */
+    unsigned char classes[256];
+    SRE_DFA first; /* for match and search */
+    SRE_DFA all; /* for fullmatch */
+    SRE_DFA reverse; /* for finding where a match starts */
+    /* scratch space */
+    unsigned int gen;
+    unsigned int* seen;
+    int* stack;
+    int* queue;
+    int* kernel;
+    /* Pike VM (allocated on first use) */
+    Py_ssize_t ncaps; /* marks, and the last index */
+    SRE_PIKE_LIST pike[2];
+    Py_ssize_t* caps;
+    int* pstack;
+    Py_ssize_t* pvalues;
+    /* the caches and scratch space can only be used by one thread while
+       the GIL is released; other threads get copies of the NFA sharing
+       the program of the pattern's one, which keeps them for reuse */
+    int busy;
+    struct SRE_NFA_T* parent;
+    struct SRE_NFA_T* spare;
+} SRE_NFA;
+
+LOCAL(int) sre_ucs4_charset(SRE_STATE* state, SRE_CODE* set, SRE_CODE ch);
+
+LOCAL(int)
+sre_nfa_char(SRE_STATE* state, SRE_NFA_INST* inst, SRE_CODE ch)
+{
+    /* check if a character instruction accepts ch */
+
+    switch (inst->op) {
+    case SRE_OP_LITERAL:
+        return ch == inst->arg;
+    case SRE_OP_NOT_LITERAL:
+        return ch != inst->arg;
+    case SRE_OP_LITERAL_IGNORE:
+        return (SRE_CODE) state->lower(ch) == inst->arg;
+    case SRE_OP_NOT_LITERAL_IGNORE:
+        return (SRE_CODE) state->lower(ch) != inst->arg;
+    case SRE_OP_IN:
+        return sre_ucs4_charset(state, inst->set, ch);
+    case SRE_OP_IN_IGNORE:
+        return sre_ucs4_charset(state, inst->set,
+                                (SRE_CODE) state->lower(ch));
+    case SRE_OP_CATEGORY:
+        return sre_category(inst->arg, ch);
+    case SRE_OP_ANY:
+        return !SRE_IS_LINEBREAK(ch);
+    case SRE_OP_ANY_ALL:
+        return 1;
+    }
+    return 0;
+}
+
+LOCAL(int)
+sre_nfa_at(SRE_CODE at, int before, int after)
+{
+    /* check a position code, given the context on either side */
+
+    switch (at) {
+    case SRE_AT_BEGINNING:
+    case SRE_AT_BEGINNING_STRING:
+        return (before & SRE_CTX_BEGIN) != 0;
+    case SRE_AT_BEGINNING_LINE:
+        return (before & (SRE_CTX_BEGIN | SRE_CTX_LINEBREAK)) != 0;
+    case SRE_AT_END:
+        return (after & (SRE_CTX_END | SRE_CTX_NEWLINE_END)) != 0;
+    case SRE_AT_END_LINE:
+        return (after & (SRE_CTX_END | SRE_CTX_LINEBREAK)) != 0;
+    case SRE_AT_END_STRING:
+        return (after & SRE_CTX_END) != 0;
+    case SRE_AT_BOUNDARY:
+    case SRE_AT_NON_BOUNDARY:
+        if ((before & SRE_CTX_BEGIN) && (after & SRE_CTX_END))
+            return 0;
+        return (!(before & SRE_CTX_WORD) != !(after & SRE_CTX_WORD)) ==
+            (at == SRE_AT_BOUNDARY);
+    case SRE_AT_UNI_BOUNDARY:
+    case SRE_AT_UNI_NON_BOUNDARY:
+        if ((before & SRE_CTX_BEGIN) && (after & SRE_CTX_END))
+            return 0;
+        return (!(before & SRE_CTX_UNI_WORD) !=
+                !(after & SRE_CTX_UNI_WORD)) ==
+            (at == SRE_AT_UNI_BOUNDARY);
+    }
+    return 0;
+}
+
+LOCAL(int)
+sre_nfa_context(SRE_NFA* nfa, SRE_CODE ch)
+{
+    /* context given by a neighbouring character */
+
+    int ctx = 0;
+    if (SRE_IS_LINEBREAK(ch))
+        ctx |= SRE_CTX_LINEBREAK;
+    if (SRE_IS_WORD(ch))
+        ctx |= SRE_CTX_WORD;
+    if ((nfa->ctxmask & SRE_CTX_UNI_WORD) && SRE_UNI_IS_WORD(ch))
+        ctx |= SRE_CTX_UNI_WORD;
+    return ctx & nfa->ctxmask;
+}
+
+/* NFA construction.  The code is translated back to front: each item
+   is built knowing the instruction that follows it. */
+
+typedef struct {
+    SRE_NFA_INST* prog;
+    int size, allocated;
+    int reverse; /* build the reversed pattern */
+    int counting; /* inside REPEAT_ONE or a non-greedy REPEAT, where the
+                     backtracking engine does not restore marks */
+    SRE_CODE* raw; /* literal matched the way SRE(count) does it */
+    int ctxmask;
+    SRE_TOLOWER_HOOK lower;
+} SRE_NFA_BUILDER;
+
+static int nfa_sequence(SRE_NFA_BUILDER*, SRE_CODE*, SRE_CODE*, int);
+
+static int
+nfa_emit(SRE_NFA_BUILDER* b, int kind, int out, int out1)
+{
+    SRE_NFA_INST* inst;
+
+    if (b->size >= SRE_NFA_MAX_SIZE)
+        return -1;
+    if (b->size >= b->allocated) {
+        int allocated = b->allocated ? 2 * b->allocated : 64;
+        inst = (SRE_NFA_INST*) PyMem_Realloc(
+            b->prog, allocated * sizeof(SRE_NFA_INST));
+        if (!inst)
+            return -1;
+        b->prog = inst;
+        b->allocated = allocated;
+    }
+    inst = &b->prog[b->size];
+    inst->kind = kind;
+    inst->out = out;
+    inst->out1 = out1;
+    inst->op = inst->arg = 0;
+    inst->set = NULL;
+    return b->size++;
+}
+
+static SRE_CODE*
+nfa_next_item(SRE_CODE* code)
+{
+    /* skip over an item, or return NULL if it is not supported */
+
+    switch (code[0]) {
+    case SRE_OP_ANY:
+    case SRE_OP_ANY_ALL:
+        return code + 1;
+    case SRE_OP_MARK:
+    case SRE_OP_AT:
+    case SRE_OP_CATEGORY:
+    case SRE_OP_LITERAL:
+    case SRE_OP_NOT_LITERAL:
+    case SRE_OP_LITERAL_IGNORE:
+    case SRE_OP_NOT_LITERAL_IGNORE:
+        return code + 2;
+    case SRE_OP_IN:
+    case SRE_OP_IN_IGNORE:
+    case SRE_OP_REPEAT_ONE:
+    case SRE_OP_MIN_REPEAT_ONE:
+        return code + 1 + code[1];
+    case SRE_OP_REPEAT:
+        /* <REPEAT> <skip> <1=min> <2=max> item <UNTIL> */
+        return code + 2 + code[1];
+    case SRE_OP_BRANCH:
+        /* <BRANCH> <0=skip> code <JUMP> ... <NULL> */
+        for (code++; code[0]; code += code[0])
+            ;
+        return code + 1;
+    }
+    return NULL;
+}
+
+static int
+nfa_nullable(SRE_CODE* code, SRE_CODE* end)
+{
+    /* check if a sequence of items can match an empty string */
+
+    SRE_CODE* p;
+
+    for (; code < end; code = nfa_next_item(code)) {
+        switch (code[0]) {
+        case SRE_OP_MARK:
+        case SRE_OP_AT:
+            break;
+        case SRE_OP_BRANCH:
+            for (p = code + 1; p[0]; p += p[0])
+                if (nfa_nullable(p + 1, p + p[0] - 2))
+                    break;
+            if (!p[0])
+                return 0;
+            break;
+        case SRE_OP_REPEAT_ONE:
+        case SRE_OP_MIN_REPEAT_ONE:
+            if (code[2] > 0)
+                return 0;
+            break;
+        case SRE_OP_REPEAT:
+            if (code[2] > 0 && !nfa_nullable(code + 4, code + 1 + code[1]))
+                return 0;
+            break;
+        default:
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int
+nfa_char(SRE_NFA_BUILDER* b, SRE_CODE* code, int next)
+{
+    int pc;
+    SRE_NFA_INST* inst;
+
+    switch (code[0]) {
+    case SRE_OP_ANY:
+    case SRE_OP_ANY_ALL:
+    case SRE_OP_CATEGORY:
+    case SRE_OP_LITERAL:
+    case SRE_OP_NOT_LITERAL:
+    case SRE_OP_LITERAL_IGNORE:
+    case SRE_OP_NOT_LITERAL_IGNORE:
+    case SRE_OP_IN:
+    case SRE_OP_IN_IGNORE:
+        break;
+    default:
+        return -1;
+    }
+    pc = nfa_emit(b, SRE_NFA_CHAR, next, -1);
+    if (pc < 0)
+        return -1;
+    inst = &b->prog[pc];
+    inst->op = code[0];
+    switch (code[0]) {
+    case SRE_OP_LITERAL_IGNORE:
+    case SRE_OP_NOT_LITERAL_IGNORE:
+        /* SRE(match) lowers both sides, SRE(count) only the string */
+        inst->arg = code == b->raw ? code[1] : b->lower(code[1]);
+        break;
+    case SRE_OP_CATEGORY:
+    case SRE_OP_LITERAL:
+    case SRE_OP_NOT_LITERAL:
+        inst->arg = code[1];
+        break;
+    case SRE_OP_IN:
+    case SRE_OP_IN_IGNORE:
+        inst->set = code + 2;
+        break;
+    }
+    return pc;
+}
+
+static int
+nfa_repeat(SRE_NFA_BUILDER* b, SRE_CODE* item, SRE_CODE* end,
+           SRE_CODE min, SRE_CODE max, int greedy, int next)
+{
+    SRE_CODE i;
+    int pc, body;
+
+    /* each copy of the item adds instructions, so the size limit stops
+       these loops long before they could overflow */
+    if (max == SRE_MAXREPEAT) {
+        pc = nfa_emit(b, SRE_NFA_SPLIT, -1, -1);
+        if (pc < 0)
+            return -1;
+        body = nfa_sequence(b, item, end, pc);
+        if (body < 0)
+            return -1;
+        b->prog[pc].out = greedy ? body : next;
+        b->prog[pc].out1 = greedy ? next : body;
+        next = pc;
+    } else {
+        int tail = next;
+        for (i = min; i < max; i++) {
+            body = nfa_sequence(b, item, end, next);
+            if (body < 0)
+                return -1;
+            if (greedy)
+                next = nfa_emit(b, SRE_NFA_SPLIT, body, tail);
+            else
+                next = nfa_emit(b, SRE_NFA_SPLIT, tail, body);
+            if (next < 0)
+                return -1;
+        }
+    }
+    for (i = 0; i < min; i++) {
+        next = nfa_sequence(b, item, end, next);
+        if (next < 0)
+            return -1;
+    }
+    return next;
+}
+
+static int
+nfa_item(SRE_NFA_BUILDER* b, SRE_CODE* code, int next)
+{
+    int pc, counting, prev, target;
+    SRE_CODE* until;
+
+    switch (code[0]) {
+
+    case SRE_OP_MARK:
+        if (b->counting)
+            return -1;
+        if (b->reverse)
+            return next;
+        pc = nfa_emit(b, SRE_NFA_MARK, next, -1);
+        if (pc >= 0)
+            b->prog[pc].arg = code[1];
+        return pc;
+
+    case SRE_OP_AT:
+        switch (code[1]) {
+        case SRE_AT_BEGINNING:
+        case SRE_AT_BEGINNING_STRING:
+            b->ctxmask |= SRE_CTX_BEGIN;
+            break;
+        case SRE_AT_BEGINNING_LINE:
+            b->ctxmask |= SRE_CTX_BEGIN | SRE_CTX_LINEBREAK;
+            break;
+        case SRE_AT_END:
+            b->ctxmask |= SRE_CTX_END | SRE_CTX_NEWLINE_END;
+            break;
+        case SRE_AT_END_LINE:
+            b->ctxmask |= SRE_CTX_END | SRE_CTX_LINEBREAK;
+            break;
+        case SRE_AT_END_STRING:
+            b->ctxmask |= SRE_CTX_END;
+            break;
+        case SRE_AT_BOUNDARY:
+        case SRE_AT_NON_BOUNDARY:
+            b->ctxmask |= SRE_CTX_BEGIN | SRE_CTX_END | SRE_CTX_WORD;
+            break;
+        case SRE_AT_UNI_BOUNDARY:
+        case SRE_AT_UNI_NON_BOUNDARY:
+            b->ctxmask |= SRE_CTX_BEGIN | SRE_CTX_END | SRE_CTX_UNI_WORD;
+            break;
+        default:
+            return -1;
+        }
+        pc = nfa_emit(b, SRE_NFA_AT, next, -1);
+        if (pc >= 0)
+            b->prog[pc].arg = code[1];
+        return pc;
+
+    case SRE_OP_BRANCH:
+        /* <BRANCH> <0=skip> code <JUMP> ... <NULL> */
+        pc = prev = -1;
+        for (code++; code[0]; code += code[0]) {
+            target = nfa_sequence(b, code + 1, code + code[0] - 2, next);
+            if (target < 0)
+                return -1;
+            if (code[code[0]]) {
+                target = nfa_emit(b, SRE_NFA_SPLIT, target, -1);
+                if (target < 0)
+                    return -1;
+            }
+            if (prev < 0)
+                pc = target;
+            else
+                b->prog[prev].out1 = target;
+            prev = target;
+        }
+        return pc;
+
+    case SRE_OP_REPEAT_ONE:
+    case SRE_OP_MIN_REPEAT_ONE:
+        /* <REPEAT_ONE> <skip> <1=min> <2=max> item <SUCCESS> tail */
+        counting = b->counting;
+        b->counting = 1;
+        b->raw = code + 4;
+        pc = nfa_repeat(b, code + 4, code + code[1], code[2], code[3],
+                        code[0] == SRE_OP_REPEAT_ONE, next);
+        b->counting = counting;
+        b->raw = NULL;
+        return pc;
+
+    case SRE_OP_REPEAT:
+        /* <REPEAT> <skip> <1=min> <2=max> item <UNTIL> tail */
+        until = code + 1 + code[1];
+        /* the backtracking engine stops repeating an item when it
+           matches an empty string; leave that to it */
+        if (nfa_nullable(code + 4, until))
+            return -1;
+        counting = b->counting;
+        if (until[0] == SRE_OP_MIN_UNTIL)
+            b->counting = 1;
+        pc = nfa_repeat(b, code + 4, until, code[2], code[3],
+                        until[0] == SRE_OP_MAX_UNTIL, next);
+        b->counting = counting;
+        return pc;
+    }
+
+    return nfa_char(b, code, next);
+}
+
+static int
+nfa_sequence(SRE_NFA_BUILDER* b, SRE_CODE* code, SRE_CODE* end, int next)
+{
+    /* build the items in code..end, followed by next; returns the entry
+       point, or -1 if the items are not supported */
+
+    SRE_CODE** items;
+    SRE_CODE* p;
+    Py_ssize_t i, n = 0;
+
+    for (p = code; p < end; p = nfa_next_item(p)) {
+        if (!p)
+            return -1;
+        n++;
+    }
+
+    if (b->reverse) {
+        for (p = code; p < end && next >= 0; p = nfa_next_item(p))
+            next = nfa_item(b, p, next);
+        return next;
+    }
+
+    if (n == 1)
+        return nfa_item(b, code, next);
+    items = PyMem_New(SRE_CODE*, n);
+    if (!items)
+        return -1;
+    for (i = 0, p = code; p < end; p = nfa_next_item(p))
+        items[i++] = p;
+    for (i = n - 1; i >= 0 && next >= 0; i--)
+        next = nfa_item(b, items[i], next);
+    PyMem_Del(items);
+    return next;
+}
+
+static void
+sre_dfa_flush(SRE_DFA* dfa)
+{
+    size_t i;
+    SRE_DFA_STATE* s;
+    SRE_DFA_STATE* next;
+
+    for (i = 0; i < dfa->tablesize; i++) {
+        for (s = dfa->table[i]; s; s = next) {
+            next = s->hash_next;
+            PyMem_RawFree(s);
+        }
+        dfa->table[i] = NULL;
+    }
+    dfa->nstates = 0;
+    dfa->memory = dfa->tablesize * sizeof(SRE_DFA_STATE*);
+    dfa->flushes++;
+}
+
+static void
+sre_nfa_free(SRE_NFA* nfa)
+{
+    if (!nfa)
+        return;
+    sre_nfa_free(nfa->spare);
+    sre_dfa_flush(&nfa->first);
+    sre_dfa_flush(&nfa->all);
+    sre_dfa_flush(&nfa->reverse);
+    PyMem_RawFree(nfa->first.table);
+    PyMem_RawFree(nfa->all.table);
+    PyMem_RawFree(nfa->reverse.table);
+    if (!nfa->parent) {
+        PyMem_Free(nfa->prog);
+        PyMem_Free(nfa->rprog);
+    }
+    PyMem_Free(nfa->seen);
+    PyMem_Free(nfa->stack);
+    PyMem_Free(nfa->queue);
+    PyMem_Free(nfa->kernel);
+    PyMem_RawFree(nfa->pike[0].pc);
+    PyMem_RawFree(nfa->pike[0].caps);
+    PyMem_RawFree(nfa->pike[1].pc);
+    PyMem_RawFree(nfa->pike[1].caps);
+    PyMem_RawFree(nfa->caps);
+    PyMem_RawFree(nfa->pstack);
+    PyMem_RawFree(nfa->pvalues);
+    PyMem_Free(nfa);
+}
+
+static int
+sre_nfa_scratch(SRE_NFA* nfa)
+{
+    size_t size = Py_MAX(nfa->size, nfa->rsize);
+
+    nfa->seen = PyMem_New(unsigned int, size);
+    nfa->stack = PyMem_New(int, 2 * size + 1);
+    nfa->queue = PyMem_New(int, size);
+    nfa->kernel = PyMem_New(int, size);
+    if (!nfa->seen || !nfa->stack || !nfa->queue || !nfa->kernel)
+        return 0;
+    memset(nfa->seen, 0, size * sizeof(unsigned int));
+    return 1;
+}
+
+static SRE_NFA*
+sre_nfa_acquire(SRE_NFA* nfa)
+{
+    /* get an NFA whose caches no other thread uses.  called with the
+       GIL held; returns NULL if out of memory */
+
+    SRE_NFA* copy;
+
+    if (!nfa->busy) {
+        nfa->busy = 1;
+        return nfa;
+    }
+    copy = nfa->spare;
+    if (copy) {
+        nfa->spare = copy->spare;
+        copy->spare = NULL;
+        return copy;
+    }
+    copy = PyMem_New(SRE_NFA, 1);
+    if (!copy)
+        return NULL;
+    memcpy(copy, nfa, sizeof(*copy));
+    copy->busy = 0;
+    memset(&copy->first, 0, sizeof(copy->first));
+    memset(&copy->all, 0, sizeof(copy->all));
+    memset(&copy->reverse, 0, sizeof(copy->reverse));
+    copy->first.prog = copy->all.prog = nfa->prog;
+    copy->first.first = 1;
+    copy->reverse.prog = nfa->rprog;
+    copy->gen = 0;
+    copy->seen = NULL;
+    copy->stack = copy->queue = copy->kernel = NULL;
+    memset(copy->pike, 0, sizeof(copy->pike));
+    copy->caps = NULL;
+    copy->pstack = NULL;
+    copy->pvalues = NULL;
+    copy->parent = nfa;
+    copy->spare = NULL;
+    if (!sre_nfa_scratch(copy)) {
+        sre_nfa_free(copy);
+        return NULL;
+    }
+    return copy;
+}
+
+static void
+sre_nfa_release(SRE_NFA* nfa, SRE_NFA* used)
+{
+    /* give back an NFA returned by sre_nfa_acquire(nfa) */
+
+    if (used == nfa)
+        nfa->busy = 0;
+    else if (used) {
+        used->spare = nfa->spare;
+        nfa->spare = used;
+    }
+}
+
+static void
+sre_nfa_refine(SRE_NFA* nfa, int* values, int nvalues)
+{
+    /* split the character classes by the given values */
+
+    int map[512];
+    int c, key, n = 0;
+
+    assert(nfa->nclasses * nvalues <= 512);
+    for (key = 0; key < nfa->nclasses * nvalues; key++)
+        map[key] = -1;
+    for (c = 0; c < 256; c++) {
+        key = nfa->classes[c] * nvalues + values[c];
+        if (map[key] < 0)
+            map[key] = n++;
+        nfa->classes[c] = (unsigned char) map[key];
+    }
+    nfa->nclasses = n;
+}
+
+static void
+sre_nfa_classes(SRE_NFA* nfa, PatternObject* pattern)
+{
+    /* group the 8-bit characters no instruction can tell apart, so that
+       the DFA states need one transition per group */
+
+    SRE_STATE state;
+    SRE_NFA_INST* inst;
+    int values[256];
+    int c, i, j;
+
+    memset(&state, 0, sizeof(state));
+    if (pattern->flags & SRE_FLAG_UNICODE) {
+        state.lower = sre_lower_unicode;
+        state.upper = sre_upper_unicode;
+    }
+    else {
+        state.lower = sre_lower;
+        state.upper = sre_upper;
+    }
+
+    memset(nfa->classes, 0, sizeof(nfa->classes));
+    nfa->nclasses = 1;
+    for (c = 0; c < 256; c++)
+        values[c] = sre_nfa_context(nfa, c);
+    sre_nfa_refine(nfa, values, 64);
+
+    for (i = 0; i < nfa->size; i++) {
+        inst = &nfa->prog[i];
+        if (inst->kind != SRE_NFA_CHAR || inst->op == SRE_OP_ANY_ALL)
+            continue;
+        /* unrolled repeats test the same thing many times over */
+        for (j = i - 1; j >= 0 && j >= i - 64; j--)
+            if (nfa->prog[j].kind == SRE_NFA_CHAR &&
+                nfa->prog[j].op == inst->op &&
+                nfa->prog[j].arg == inst->arg &&
+                nfa->prog[j].set == inst->set)
+                break;
+        if (j >= 0 && j >= i - 64)
+            continue;
+        for (c = 0; c < 256; c++)
+            values[c] = sre_nfa_char(&state, inst, c);
+        sre_nfa_refine(nfa, values, 2);
+        if (nfa->nclasses == 256)
+            break;
+    }
+}
+
+static SRE_NFA*
+sre_nfa_new(PatternObject* pattern)
+{
+    /* returns NULL if the pattern is left to the backtracking engine */
+
+    SRE_NFA_BUILDER b, rb;
+    SRE_NFA* nfa;
+    SRE_CODE* code = pattern->code;
+    SRE_CODE* end = code + pattern->codesize - 1;
+    int start, search, any, rstart;
+
+    if (pattern->flags & SRE_FLAG_LOCALE)
+        return NULL;
+    if (pattern->codesize < 1 || end[0] != SRE_OP_SUCCESS)
+        return NULL;
+    if (code[0] == SRE_OP_INFO) {
+        /* literal strings are found in linear time already */
+        if (code[2] & SRE_INFO_LITERAL)
+            return NULL;
+        code += code[1] + 1;
+    }
+
+    memset(&b, 0, sizeof(b));
+    b.lower = (pattern->flags & SRE_FLAG_UNICODE) ?
+        sre_lower_unicode : sre_lower;
+    rb = b;
+    rb.reverse = 1;
+
+    start = nfa_emit(&b, SRE_NFA_MATCH, -1, -1);
+    if (start >= 0)
+        start = nfa_sequence(&b, code, end, start);
+    search = start >= 0 ? nfa_emit(&b, SRE_NFA_SPLIT, start, -1) : -1;
+    any = search >= 0 ? nfa_emit(&b, SRE_NFA_CHAR, search, -1) : -1;
+    rstart = any >= 0 ? nfa_emit(&rb, SRE_NFA_MATCH, -1, -1) : -1;
+    if (rstart >= 0)
+        rstart = nfa_sequence(&rb, code, end, rstart);
+    if (rstart < 0 ||
+        (size_t) b.size * (2 * pattern->groups + 1) > SRE_NFA_MAX_CAPS) {
+        PyMem_Free(b.prog);
+        PyMem_Free(rb.prog);
+        return NULL;
+    }
+    b.prog[search].out1 = any;
+    b.prog[any].op = SRE_OP_ANY_ALL;
+
+    nfa = PyMem_New(SRE_NFA, 1);
+    if (!nfa) {
+        PyMem_Free(b.prog);
+        PyMem_Free(rb.prog);
+        return NULL;
+    }
+    memset(nfa, 0, sizeof(*nfa));
+    nfa->prog = b.prog;
+    nfa->size = b.size;
+    nfa->start = start;
+    nfa->search = search;
+    nfa->rprog = rb.prog;
+    nfa->rsize = rb.size;
+    nfa->rstart = rstart;
+    nfa->ctxmask = b.ctxmask;
+    nfa->ncaps = 2 * pattern->groups + 1;
+    nfa->first.prog = nfa->all.prog = nfa->prog;
+    nfa->first.first = 1;
+    nfa->reverse.prog = nfa->rprog;
+
+    if (!sre_nfa_scratch(nfa)) {
+        sre_nfa_free(nfa);
+        return NULL;
+    }
+
+    sre_nfa_classes(nfa, pattern);
+
+    return nfa;
+}
+
+LOCAL(unsigned int)
+sre_nfa_generation(SRE_NFA* nfa)
+{
+    /* marks in nfa->seen older than the returned value are stale */
+
+    if (++nfa->gen == 0) {
+        memset(nfa->seen, 0,
+               Py_MAX(nfa->size, nfa->rsize) * sizeof(unsigned int));
+        nfa->gen = 1;
+    }
+    return nfa->gen;
+}
+
+/* lazy DFA */
+
+static SRE_DFA_STATE*
+sre_dfa_intern(SRE_NFA* nfa, SRE_DFA* dfa, int* list, int n, int flags)
+{
+    /* find or create the state for the given threads */
+
+    Py_uhash_t hash;
+    SRE_DFA_STATE* s;
+    size_t size, i;
+    int k;
+
+    if (n == 0)
+        flags |= SRE_DFA_DEAD;
+    hash = (Py_uhash_t) flags;
+    for (k = 0; k < n; k++)
+        hash = (hash * 1000003U) ^ (Py_uhash_t) list[k];
+
+    if (dfa->table) {
+        s = dfa->table[hash & (dfa->tablesize - 1)];
+        for (; s; s = s->hash_next)
+            if (s->hash == hash && s->flags == flags && s->n == n &&
+                memcmp(s->inst, list, n * sizeof(int)) == 0)
+                return s;
+    }
+
+    size = sizeof(SRE_DFA_STATE) +
+        (nfa->nclasses - 1) * sizeof(SRE_DFA_STATE*) + n * sizeof(int);
+    if (dfa->memory + size > SRE_DFA_MAX_MEMORY && dfa->nstates > 0)
+        sre_dfa_flush(dfa);
+
+    if (dfa->nstates >= dfa->tablesize) {
+        /* grow the hash table */
+        size_t tablesize = dfa->tablesize ? 2 * dfa->tablesize : 64;
+        SRE_DFA_STATE** table = (SRE_DFA_STATE**) PyMem_RawMalloc(
+            tablesize * sizeof(SRE_DFA_STATE*));
+        SRE_DFA_STATE* next;
+        if (!table)
+            return NULL;
+        memset(table, 0, tablesize * sizeof(SRE_DFA_STATE*));
+        for (i = 0; i < dfa->tablesize; i++) {
+            for (s = dfa->table[i]; s; s = next) {
+                next = s->hash_next;
+                s->hash_next = table[s->hash & (tablesize - 1)];
+                table[s->hash & (tablesize - 1)] = s;
+            }
+        }
+        PyMem_RawFree(dfa->table);
+        dfa->memory += (tablesize - dfa->tablesize) * sizeof(SRE_DFA_STATE*);
+        dfa->table = table;
+        dfa->tablesize = tablesize;
+    }
+
+    s = (SRE_DFA_STATE*) PyMem_RawMalloc(size);
+    if (!s)
+        return NULL;
+    s->hash = hash;
+    s->flags = flags;
+    s->n = n;
+    memset(s->next, 0, nfa->nclasses * sizeof(SRE_DFA_STATE*));
+    s->inst = (int*) &s->next[nfa->nclasses];
+    memcpy(s->inst, list, n * sizeof(int));
+    s->hash_next = dfa->table[hash & (dfa->tablesize - 1)];
+    dfa->table[hash & (dfa->tablesize - 1)] = s;
+    dfa->nstates++;
+    dfa->memory += size;
+    return s;
+}
+
+static int
+sre_dfa_closure(SRE_NFA* nfa, SRE_DFA* dfa, SRE_DFA_STATE* s,
+                int before, int after, int* pcount)
+{
+    /* follow the empty transitions from the threads of s, at a position
+       with the given context on either side.  the character
+       instructions reached are stored in nfa->queue in priority order.
+       returns 1 if the NFA matches here */
+
+    SRE_NFA_INST* prog = dfa->prog;
+    unsigned int gen = sre_nfa_generation(nfa);
+    int* stack = nfa->stack;
+    int i, pc, sp, count = 0, matched = 0;
+
+    for (i = 0; i < s->n; i++) {
+        stack[0] = s->inst[i];
+        sp = 1;
+        while (sp > 0) {
+            pc = stack[--sp];
+            if (nfa->seen[pc] == gen)
+                continue;
+            nfa->seen[pc] = gen;
+            switch (prog[pc].kind) {
+            case SRE_NFA_CHAR:
+                nfa->queue[count++] = pc;
+                break;
+            case SRE_NFA_MATCH:
+                matched = 1;
+                if (dfa->first) {
+                    /* the remaining threads have lower priority */
+                    *pcount = count;
+                    return 1;
+                }
+                break;
+            case SRE_NFA_SPLIT:
+                stack[sp++] = prog[pc].out1;
+                stack[sp++] = prog[pc].out;
+                break;
+            case SRE_NFA_AT:
+                if (sre_nfa_at(prog[pc].arg, before, after))
+                    stack[sp++] = prog[pc].out;
+                break;
+            default:
+                stack[sp++] = prog[pc].out;
+                break;
+            }
+        }
+    }
+    *pcount = count;
+    return matched;
+}
+
+LOCAL(SRE_DFA_STATE*)
+sre_dfa_start(SRE_NFA* nfa, SRE_DFA* dfa, int pc, int ctx)
+{
+    return sre_dfa_intern(nfa, dfa, &pc, 1, ctx & nfa->ctxmask);
+}
+
+static SRE_DFA_STATE*
+sre_dfa_step(SRE_STATE* state, SRE_DFA* dfa, SRE_DFA_STATE* s,
+             SRE_CODE ch, int before, int after, int ctx, int cache)
+{
+    /* consume ch, which has the context ctx; before and after describe
+       the position in front of it.  if cache is set, the transition is
+       remembered for the other characters in the class of ch */
+
+    SRE_NFA* nfa = state->nfa;
+    SRE_NFA_INST* inst;
+    SRE_DFA_STATE* t;
+    size_t flushes = dfa->flushes;
+    unsigned int gen;
+    int i, count, n = 0;
+
+    if (sre_dfa_closure(nfa, dfa, s, before, after, &count))
+        ctx |= SRE_DFA_MATCH;
+    gen = sre_nfa_generation(nfa);
+    for (i = 0; i < count; i++) {
+        inst = &dfa->prog[nfa->queue[i]];
+        if (nfa->seen[inst->out] != gen && sre_nfa_char(state, inst, ch)) {
+            nfa->seen[inst->out] = gen;
+            nfa->kernel[n++] = inst->out;
+        }
+    }
+    t = sre_dfa_intern(nfa, dfa, nfa->kernel, n, ctx);
+    if (t && cache && dfa->flushes == flushes)
+        s->next[nfa->classes[ch]] = t;
+    return t;
+}
+
+LOCAL(int)
+sre_dfa_accepts(SRE_NFA* nfa, SRE_DFA* dfa, SRE_DFA_STATE* s,
+                int before, int after)
+{
+    int count;
+    return sre_dfa_closure(nfa, dfa, s, before, after, &count);
+}
+
+/* Pike VM */
+
+static int
+sre_pike_alloc(SRE_NFA* nfa)
+{
+    size_t size = nfa->size;
+    Py_ssize_t ncaps = nfa->ncaps;
+    int i;
+
+    if (nfa->caps)
+        return 1;
+    for (i = 0; i < 2; i++) {
+        nfa->pike[i].pc = PyMem_RawMalloc(size * sizeof(int));
+        nfa->pike[i].caps = PyMem_RawMalloc(size * ncaps *
+                                            sizeof(Py_ssize_t));
+    }
+    nfa->pstack = PyMem_RawMalloc((3 * size + 1) * sizeof(int));
+    nfa->pvalues = PyMem_RawMalloc((3 * size + 1) * sizeof(Py_ssize_t));
+    nfa->caps = PyMem_RawMalloc(ncaps * sizeof(Py_ssize_t));
+    if (nfa->pike[0].pc && nfa->pike[0].caps && nfa->pike[1].pc &&
+        nfa->pike[1].caps && nfa->pstack && nfa->pvalues && nfa->caps)
+        return 1;
+    for (i = 0; i < 2; i++) {
+        PyMem_RawFree(nfa->pike[i].pc);
+        PyMem_RawFree(nfa->pike[i].caps);
+        nfa->pike[i].pc = NULL;
+        nfa->pike[i].caps = NULL;
+    }
+    PyMem_RawFree(nfa->pstack);
+    PyMem_RawFree(nfa->pvalues);
+    PyMem_RawFree(nfa->caps);
+    nfa->pstack = NULL;
+    nfa->pvalues = NULL;
+    nfa->caps = NULL;
+    return 0;
+}
+
+static void
+sre_pike_add(SRE_NFA* nfa, SRE_PIKE_LIST* list, int pc, Py_ssize_t* caps,
+             Py_ssize_t pos, int before, int after, unsigned int gen)
+{
+    /* add the threads reached from pc to list, with their marks */
+
+    SRE_NFA_INST* inst;
+    Py_ssize_t ncaps = nfa->ncaps;
+    Py_ssize_t* cur = nfa->caps;
+    int* stack = nfa->pstack;
+    Py_ssize_t* values = nfa->pvalues;
+    int sp = 0;
+
+    memcpy(cur, caps, ncaps * sizeof(Py_ssize_t));
+    stack[sp++] = pc;
+    while (sp > 0) {
+        pc = stack[--sp];
+        if (pc < 0) {
+            /* restore a mark */
+            cur[-pc - 1] = values[sp];
+            continue;
+        }
+        if (nfa->seen[pc] == gen)
+            continue;
+        nfa->seen[pc] = gen;
+        inst = &nfa->prog[pc];
+        switch (inst->kind) {
+        case SRE_NFA_CHAR:
+        case SRE_NFA_MATCH:
+            list->pc[list->n] = pc;
+            memcpy(list->caps + list->n * ncaps, cur,
+                   ncaps * sizeof(Py_ssize_t));
+            list->n++;
+            break;
+        case SRE_NFA_SPLIT:
+            stack[sp++] = inst->out1;
+            stack[sp++] = inst->out;
+            break;
+        case SRE_NFA_AT:
+            if (sre_nfa_at(inst->arg, before, after))
+                stack[sp++] = inst->out;
+            break;
+        case SRE_NFA_MARK:
+            values[sp] = cur[inst->arg];
+            stack[sp++] = -(int) inst->arg - 1;
+            cur[inst->arg] = pos;
+            if (inst->arg & 1) {
+                values[sp] = cur[ncaps - 1];
+                stack[sp++] = -(int) ncaps;
+                cur[ncaps - 1] = inst->arg / 2 + 1;
+            }
+            stack[sp++] = inst->out;
+            break;
+        default:
+            stack[sp++] = inst->out;
+            break;
+        }
+    }
+}
+
+LOCAL(void)
+sre_pike_result(SRE_STATE* state, Py_ssize_t* caps)
+{
+    /* store the marks found by the Pike VM */
+
+    Py_ssize_t i, ncaps = state->nfa->ncaps - 1;
+
+    state->lastmark = -1;
+    for (i = 0; i < ncaps; i++) {
+        if (caps[i] < 0)
+            state->mark[i] = NULL;
+        else {
+            state->mark[i] = (char*) state->beginning +
+                caps[i] * state->charsize;
+            state->lastmark = i;
+        }
+    }
+    state->lastindex = caps[ncaps];
+}
+
 /* generate 8-bit version */
 
 #define SRE_CHAR Py_UCS1
@@ -405,6 +1537,9 @@ state_init(SRE_STATE* state, PatternObject* pattern, PyObject* string,
         state->upper = sre_upper;
     }
 
+    state->nfa = pattern->nfa;
+    state->release_gil = PyUnicode_Check(string) || PyBytes_Check(string);
+
     return string;
   err:
     PyMem_Del(state->mark);
@@ -503,29 +1638,76 @@ pattern_dealloc(PatternObject* self)
     Py_XDECREF(self->pattern);
     Py_XDECREF(self->groupindex);
     Py_XDECREF(self->indexgroup);
+    sre_nfa_free(self->nfa);
     PyObject_DEL(self);
 }
 
 LOCAL(Py_ssize_t)
 sre_match(SRE_STATE* state, SRE_CODE* pattern, int match_all)
 {
-    if (state->charsize == 1)
-        return sre_ucs1_match(state, pattern, match_all);
-    if (state->charsize == 2)
-        return sre_ucs2_match(state, pattern, match_all);
-    assert(state->charsize == 4);
-    return sre_ucs4_match(state, pattern, match_all);
+    SRE_NFA* nfa = state->nfa;
+    Py_ssize_t status;
+
+    if (nfa && state->start <= state->end)
+        state->nfa = sre_nfa_acquire(nfa);
+    else
+        state->nfa = NULL;
+    if (state->nfa) {
+        if (state->charsize == 1)
+            status = sre_ucs1_dfa_match(state, match_all);
+        else if (state->charsize == 2)
+            status = sre_ucs2_dfa_match(state, match_all);
+        else
+            status = sre_ucs4_dfa_match(state, match_all);
+    }
+    else if (state->charsize == 1)
+        status = sre_ucs1_match(state, pattern, match_all);
+    else if (state->charsize == 2)
+        status = sre_ucs2_match(state, pattern, match_all);
+    else {
+        assert(state->charsize == 4);
+        status = sre_ucs4_match(state, pattern, match_all);
+    }
+    sre_acquire_gil(state);
+    if (nfa) {
+        sre_nfa_release(nfa, state->nfa);
+        state->nfa = nfa;
+    }
+    return status;
 }
 
 LOCAL(Py_ssize_t)
 sre_search(SRE_STATE* state, SRE_CODE* pattern)
 {
-    if (state->charsize == 1)
-        return sre_ucs1_search(state, pattern);
-    if (state->charsize == 2)
-        return sre_ucs2_search(state, pattern);
-    assert(state->charsize == 4);
-    return sre_ucs4_search(state, pattern);
+    SRE_NFA* nfa = state->nfa;
+    Py_ssize_t status;
+
+    if (nfa && state->start <= state->end)
+        state->nfa = sre_nfa_acquire(nfa);
+    else
+        state->nfa = NULL;
+    if (state->nfa) {
+        if (state->charsize == 1)
+            status = sre_ucs1_dfa_search(state, pattern);
+        else if (state->charsize == 2)
+            status = sre_ucs2_dfa_search(state, pattern);
+        else
+            status = sre_ucs4_dfa_search(state, pattern);
+    }
+    else if (state->charsize == 1)
+        status = sre_ucs1_search(state, pattern);
+    else if (state->charsize == 2)
+        status = sre_ucs2_search(state, pattern);
+    else {
+        assert(state->charsize == 4);
+        status = sre_ucs4_search(state, pattern);
+    }
+    sre_acquire_gil(state);
+    if (nfa) {
+        sre_nfa_release(nfa, state->nfa);
+        state->nfa = nfa;
+    }
+    return status;
 }
 
 static PyObject *
@@ -1197,6 +2379,7 @@ pattern_copy(PatternObject* self, PyObject *unused)
     memcpy((char*) copy + offset, (char*) self + offset,
            sizeof(PatternObject) + self->codesize * sizeof(SRE_CODE) - offset);
     copy->weakreflist = NULL;
+    copy->nfa = sre_nfa_new(copy);
 
     return (PyObject*) copy;
 #else
@@ -1442,6 +2625,7 @@ _compile(PyObject* self_, PyObject* args)
     self->pattern = NULL;
     self->groupindex = NULL;
     self->indexgroup = NULL;
+    self->nfa = NULL;
 
     self->codesize = n;
 
@@ -1498,6 +2682,10 @@ _compile(PyObject* self_, PyObject* args)
         return NULL;
     }
 
+    /* patterns without backreferences and lookarounds can be matched in
+       linear time */
+    self->nfa = sre_nfa_new(self);
+
     return (PyObject*) self;
 }
 
@@ -1735,8 +2923,8 @@ _validate_inner(SRE_CODE *code, SRE_CODE *end, Py_ssize_t groups)
             {
                 /* A minimal info field is
                    <INFO> <1=skip> <2=flags> <3=min> <4=max>;
-                   If SRE_INFO_PREFIX or SRE_INFO_CHARSET is in the flags,
-                   more follows. */
+                   If SRE_INFO_REQUIRED, SRE_INFO_PREFIX or SRE_INFO_CHARSET
+                   is in the flags, more follows. */
                 SRE_CODE flags, i;
                 SRE_CODE *newcode;
                 GET_SKIP;
@@ -1747,7 +2935,8 @@ _validate_inner(SRE_CODE *code, SRE_CODE *end, Py_ssize_t groups)
                 /* Check that only valid flags are present */
                 if ((flags & ~(SRE_INFO_PREFIX |
                                SRE_INFO_LITERAL |
-                               SRE_INFO_CHARSET)) != 0)
+                               SRE_INFO_CHARSET |
+                               SRE_INFO_REQUIRED)) != 0)
                     FAIL;
                 /* PREFIX and CHARSET are mutually exclusive */
                 if ((flags & SRE_INFO_PREFIX) &&
@@ -1757,6 +2946,19 @@ _validate_inner(SRE_CODE *code, SRE_CODE *end, Py_ssize_t groups)
                 if ((flags & SRE_INFO_LITERAL) &&
                     !(flags & SRE_INFO_PREFIX))
                     FAIL;
+                /* Validate the required literal */
+                if (flags & SRE_INFO_REQUIRED) {
+                    SRE_CODE required_len;
+                    GET_ARG; required_len = arg;
+                    if (required_len == 0)
+                        FAIL;
+                    GET_ARG;
+                    GET_ARG;
+                    /* Here comes the literal */
+                    if (required_len > (Py_uintptr_t)(newcode - code))
+                        FAIL;
+                    code += required_len;
+                }
                 /* Validate the prefix */
                 if (flags & SRE_INFO_PREFIX) {
                     SRE_CODE prefix_len;
@@ -2578,11 +3780,18 @@ scanner_match(ScannerObject* self, PyObject *unused)
     PyObject* match;
     Py_ssize_t status;
 
+    if (self->executing) {
+        PyErr_SetString(PyExc_ValueError, "scanner already executing");
+        return NULL;
+    }
+
     state_reset(state);
 
     state->ptr = state->start;
 
+    self->executing = 1;
     status = sre_match(state, PatternObject_GetCode(self->pattern), 0);
+    self->executing = 0;
     if (PyErr_Occurred())
         return NULL;
 
@@ -2605,11 +3814,18 @@ scanner_search(ScannerObject* self, PyObject *unused)
     PyObject* match;
     Py_ssize_t status;
 
+    if (self->executing) {
+        PyErr_SetString(PyExc_ValueError, "scanner already executing");
+        return NULL;
+    }
+
     state_reset(state);
 
     state->ptr = state->start;
 
+    self->executing = 1;
     status = sre_search(state, PatternObject_GetCode(self->pattern));
+    self->executing = 0;
     if (PyErr_Occurred())
         return NULL;
 
@@ -2692,6 +3908,7 @@ pattern_scanner(PatternObject* pattern, PyObject* args, PyObject* kw)
     if (!self)
         return NULL;
     self->pattern = NULL;
+    self->executing = 0;
 
     string = state_init(&self->state, pattern, string, start, end);
     if (!string) {
@@ -59,6 +59,7 @@
 #ifdef USE_ZLIB_CRC32
 #include "zlib.h"
 #endif
+#include "../Objects/stringlib/sse2.h"
 
 static PyObject *Error;
 static PyObject *Incomplete;
@@ -416,6 +417,60 @@ binascii_find_valid(unsigned char *s, Py_ssize_t slen, int num)
     return ret;
 }
 
+#ifdef HAVE_SSE2_INTRINSICS
+/* Decodes blocks of 16 base64 characters (no padding, whitespace or
+   other characters) into 12 bytes each, and returns the number of
+   characters consumed, a multiple of 16. */
+static Py_ssize_t
+base64_decode_sse2(const unsigned char *ascii_data, Py_ssize_t ascii_len,
+                   unsigned char *bin_data)
+{
+    const unsigned char *start = ascii_data;
+    const __m128i minus1 = _mm_set1_epi8(-1);
+
+    for (; ascii_len >= 16; ascii_len -= 16, ascii_data += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i *)ascii_data);
+        __m128i x, in, value, valid;
+        unsigned int w[4];
+        int i;
+
+        /* c - base is in [0, n] exactly for the characters of a range,
+           whatever the wrap-around of the other ones */
+#define RANGE(base, n, offset) \
+        x = _mm_sub_epi8(c, _mm_set1_epi8(base)); \
+        in = _mm_and_si128(_mm_cmpgt_epi8(x, minus1), \
+                           _mm_cmplt_epi8(x, _mm_set1_epi8((n) + 1))); \
+        valid = _mm_or_si128(valid, in); \
+        value = _mm_or_si128(value, _mm_and_si128(in, \
+            _mm_add_epi8(x, _mm_set1_epi8(offset))))
+
+        valid = value = _mm_setzero_si128();
+        RANGE('A', 25, 0);
+        RANGE('a', 25, 26);
+        RANGE('0', 9, 52);
+        RANGE('+', 0, 62);
+        RANGE('/', 0, 63);
+#undef RANGE
+        if (_mm_movemask_epi8(valid) != 0xffff)
+            break;
+
+        /* 6-bit values a, b, c, d -> 12 bits (a << 6 | b) and (c << 6 | d)
+           in 16-bit lanes -> 24 bits in 32-bit lanes */
+        value = _mm_or_si128(
+            _mm_slli_epi16(_mm_and_si128(value, _mm_set1_epi16(0xff)), 6),
+            _mm_srli_epi16(value, 8));
+        value = _mm_madd_epi16(value, _mm_set1_epi32(0x00011000));
+        _mm_storeu_si128((__m128i *)w, value);
+        for (i = 0; i < 4; i++) {
+            *bin_data++ = (unsigned char)(w[i] >> 16);
+            *bin_data++ = (unsigned char)(w[i] >> 8);
+            *bin_data++ = (unsigned char)w[i];
+        }
+    }
+    return ascii_data - start;
+}
+#endif
+
 /*[clinic input]
 binascii.a2b_base64
 
@@ -454,6 +509,43 @@ binascii_a2b_base64_impl(PyModuleDef *module, Py_buffer *data)
     bin_len = 0;
 
     for( ; ascii_len > 0; ascii_len--, ascii_data++) {
+        /* Fast path: whole quads of base64 characters between the noise */
+        if (quad_pos == 0 && ascii_len >= 4) {
+            Py_ssize_t n;
+#ifdef HAVE_SSE2_INTRINSICS
+            n = base64_decode_sse2(ascii_data, ascii_len, bin_data);
+            ascii_data += n;
+            ascii_len -= n;
+            bin_data += n / 4 * 3;
+            bin_len += n / 4 * 3;
+#endif
+            for (n = 0; ascii_len - n >= 4; n += 4) {
+                const unsigned char *q = ascii_data + n;
+                unsigned int v;
+                if ((q[0] | q[1] | q[2] | q[3]) > 0x7f ||
+                    q[0] == BASE64_PAD || q[1] == BASE64_PAD ||
+                    q[2] == BASE64_PAD || q[3] == BASE64_PAD)
+                    break;
+                v = ((unsigned char)table_a2b_base64[q[0]] |
+                     (unsigned char)table_a2b_base64[q[1]] |
+                     (unsigned char)table_a2b_base64[q[2]] |
+                     (unsigned char)table_a2b_base64[q[3]]);
+                if (v > 0x3f)
+                    break;
+                v = (table_a2b_base64[q[0]] << 18) |
+                    (table_a2b_base64[q[1]] << 12) |
+                    (table_a2b_base64[q[2]] << 6) | table_a2b_base64[q[3]];
+                *bin_data++ = (unsigned char)(v >> 16);
+                *bin_data++ = (unsigned char)(v >> 8);
+                *bin_data++ = (unsigned char)v;
+                bin_len += 3;
+            }
+            ascii_data += n;
+            ascii_len -= n;
+            if (ascii_len == 0)
+                break;
+        }
+
         this_ch = *ascii_data;
 
         if (this_ch > 0x7f ||
@@ -554,13 +646,24 @@ binascii_b2a_base64_impl(PyModuleDef *module, Py_buffer *data)
         return NULL;
     }
 
-    /* We're lazy and allocate too much (fixed up later).
-       "+3" leaves room for up to two pad characters and a trailing
-       newline.  Note that 'b' gets encoded as 'Yg==\n' (1 in, 5 out). */
-    if ( (rv=PyBytes_FromStringAndSize(NULL, bin_len*2 + 3)) == NULL )
+    /* 4 characters for each group of 3 bytes, including the last
+       one, padded, and a trailing newline.  Note that 'b' gets encoded
+       as 'Yg==\n' (1 in, 5 out). */
+    if ( (rv=PyBytes_FromStringAndSize(NULL,
+                                       (bin_len + 2) / 3 * 4 + 1)) == NULL )
         return NULL;
     ascii_data = (unsigned char *)PyBytes_AS_STRING(rv);
 
+    /* Whole groups of 3 bytes first */
+    for( ; bin_len >= 3 ; bin_len -= 3, bin_data += 3 ) {
+        leftchar = (bin_data[0] << 16) | (bin_data[1] << 8) | bin_data[2];
+        *ascii_data++ = table_b2a_base64[leftchar >> 18];
+        *ascii_data++ = table_b2a_base64[(leftchar >> 12) & 0x3f];
+        *ascii_data++ = table_b2a_base64[(leftchar >> 6) & 0x3f];
+        *ascii_data++ = table_b2a_base64[leftchar & 0x3f];
+    }
+    leftchar = 0;
+
     for( ; bin_len > 0 ; bin_len--, bin_data++ ) {
         /* Shift the data into our buffer */
         leftchar = (leftchar << 8) | *bin_data;
@@ -583,11 +686,8 @@ binascii_b2a_base64_impl(PyModuleDef *module, Py_buffer *data)
     }
     *ascii_data++ = '\n';       /* Append a courtesy newline */
 
-    if (_PyBytes_Resize(&rv,
-                       (ascii_data -
-                        (unsigned char *)PyBytes_AS_STRING(rv))) < 0) {
-        Py_CLEAR(rv);
-    }
+    assert(ascii_data - (unsigned char *)PyBytes_AS_STRING(rv) ==
+           PyBytes_GET_SIZE(rv));
     return rv;
 }
 
@@ -1136,8 +1236,32 @@ binascii_b2a_hex_impl(PyModuleDef *module, Py_buffer *data)
         return NULL;
     retbuf = PyBytes_AS_STRING(retval);
 
+    i = j = 0;
+#ifdef HAVE_SSE2_INTRINSICS
+    {
+        /* 16 bytes at a time: split the nibbles and add '0', or
+           'a' - 10 to those above 9 */
+        const __m128i mask = _mm_set1_epi8(0xf);
+        const __m128i nine = _mm_set1_epi8(9);
+        const __m128i zero = _mm_set1_epi8('0');
+        const __m128i letter = _mm_set1_epi8('a' - '0' - 10);
+        for (; i + 16 <= arglen; i += 16, j += 32) {
+            __m128i in = _mm_loadu_si128((const __m128i *)(argbuf + i));
+            __m128i hi = _mm_and_si128(_mm_srli_epi16(in, 4), mask);
+            __m128i lo = _mm_and_si128(in, mask);
+            hi = _mm_add_epi8(_mm_add_epi8(hi, zero),
+                              _mm_and_si128(_mm_cmpgt_epi8(hi, nine), letter));
+            lo = _mm_add_epi8(_mm_add_epi8(lo, zero),
+                              _mm_and_si128(_mm_cmpgt_epi8(lo, nine), letter));
+            _mm_storeu_si128((__m128i *)(retbuf + j),
+                             _mm_unpacklo_epi8(hi, lo));
+            _mm_storeu_si128((__m128i *)(retbuf + j + 16),
+                             _mm_unpackhi_epi8(hi, lo));
+        }
+    }
+#endif
     /* make hex version of string, taken from shamodule.c */
-    for (i=j=0; i < arglen; i++) {
+    for (; i < arglen; i++) {
         unsigned char c;
         c = (argbuf[i] >> 4) & 0xf;
         retbuf[j++] = Py_hexdigits[c];
@@ -1204,7 +1328,43 @@ binascii_a2b_hex_impl(PyModuleDef *module, Py_buffer *hexstr)
         return NULL;
     retbuf = PyBytes_AS_STRING(retval);
 
-    for (i=j=0; i < arglen; i += 2) {
+    i = j = 0;
+#ifdef HAVE_SSE2_INTRINSICS
+    {
+        /* 32 digits at a time; any other character leaves the rest to
+           the loop below, which reports it */
+        const __m128i minus1 = _mm_set1_epi8(-1);
+        const __m128i ten = _mm_set1_epi8(10);
+        const __m128i six = _mm_set1_epi8(6);
+        for (; i + 32 <= arglen; i += 32, j += 16) {
+            __m128i v[2];
+            int k, valid = 0xffff;
+            for (k = 0; k < 2; k++) {
+                __m128i c = _mm_loadu_si128(
+                    (const __m128i *)(argbuf + i + 16 * k));
+                __m128i d = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+                __m128i l = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)),
+                                         _mm_set1_epi8('a'));
+                __m128i isd = _mm_and_si128(_mm_cmpgt_epi8(d, minus1),
+                                            _mm_cmplt_epi8(d, ten));
+                __m128i isl = _mm_and_si128(_mm_cmpgt_epi8(l, minus1),
+                                            _mm_cmplt_epi8(l, six));
+                valid &= _mm_movemask_epi8(_mm_or_si128(isd, isl));
+                v[k] = _mm_or_si128(_mm_and_si128(isd, d),
+                                    _mm_and_si128(isl, _mm_add_epi8(l, ten)));
+                /* digit pairs (hi, lo) in 16-bit lanes -> hi << 4 | lo */
+                v[k] = _mm_and_si128(_mm_or_si128(_mm_slli_epi16(v[k], 4),
+                                                  _mm_srli_epi16(v[k], 8)),
+                                     _mm_set1_epi16(0xff));
+            }
+            if (valid != 0xffff)
+                break;
+            _mm_storeu_si128((__m128i *)(retbuf + j),
+                             _mm_packus_epi16(v[0], v[1]));
+        }
+    }
+#endif
+    for (; i < arglen; i += 2) {
         int top = to_int(Py_CHARMASK(argbuf[i]));
         int bot = to_int(Py_CHARMASK(argbuf[i+1]));
         if (top == -1 || bot == -1) {
@@ -132,6 +132,48 @@ exit:
     return return_value;
 }
 
+PyDoc_STRVAR(_bz2_BZ2Decompressor_decompress_into__doc__,
+"decompress_into($self, data, buffer, /)\n"
+"--\n"
+"\n"
+"Decompress data into buffer and return the number of bytes written.\n"
+"\n"
+"No bytes object is created for the output.  Once buffer is full, the input\n"
+"data left over is saved in the unconsumed_tail attribute and must be passed\n"
+"again to a later call.  More output may be pending even when unconsumed_tail\n"
+"is empty, so call this method again with b\'\' until it does not fill buffer\n"
+"or the end of stream is reached.");
+
+#define _BZ2_BZ2DECOMPRESSOR_DECOMPRESS_INTO_METHODDEF    \
+    {"decompress_into", (PyCFunction)_bz2_BZ2Decompressor_decompress_into, METH_VARARGS, _bz2_BZ2Decompressor_decompress_into__doc__},
+
+static PyObject *
+_bz2_BZ2Decompressor_decompress_into_impl(BZ2Decompressor *self, Py_buffer *data, Py_buffer *buffer);
+
+static PyObject *
+_bz2_BZ2Decompressor_decompress_into(BZ2Decompressor *self, PyObject *args)
+{
+    PyObject *return_value = NULL;
+    Py_buffer data = {NULL, NULL};
+    Py_buffer buffer = {NULL, NULL};
+
+    if (!PyArg_ParseTuple(args,
+        "y*w*:decompress_into",
+        &data, &buffer))
+        goto exit;
+    return_value = _bz2_BZ2Decompressor_decompress_into_impl(self, &data, &buffer);
+
+exit:
+    /* Cleanup for data */
+    if (data.obj)
+       PyBuffer_Release(&data);
+    /* Cleanup for buffer */
+    if (buffer.obj)
+       PyBuffer_Release(&buffer);
+
+    return return_value;
+}
+
 PyDoc_STRVAR(_bz2_BZ2Decompressor___init____doc__,
 "BZ2Decompressor()\n"
 "--\n"
@@ -159,4 +201,4 @@ _bz2_BZ2Decompressor___init__(PyObject *self, PyObject *args, PyObject *kwargs)
 exit:
     return return_value;
 }
-/*[clinic end generated code: output=21ca4405519a0931 input=a9049054013a1b77]*/
+/*[clinic end generated code: output=8486d2f01c1a989a input=a9049054013a1b77]*/
@@ -99,6 +99,48 @@ exit:
     return return_value;
 }
 
+PyDoc_STRVAR(_lzma_LZMADecompressor_decompress_into__doc__,
+"decompress_into($self, data, buffer, /)\n"
+"--\n"
+"\n"
+"Decompress data into buffer and return the number of bytes written.\n"
+"\n"
+"No bytes object is created for the output.  Once buffer is full, the input\n"
+"data left over is saved in the unconsumed_tail attribute and must be passed\n"
+"again to a later call.  More output may be pending even when unconsumed_tail\n"
+"is empty, so call this method again with b\'\' until it does not fill buffer\n"
+"or the end of stream is reached.");
+
+#define _LZMA_LZMADECOMPRESSOR_DECOMPRESS_INTO_METHODDEF    \
+    {"decompress_into", (PyCFunction)_lzma_LZMADecompressor_decompress_into, METH_VARARGS, _lzma_LZMADecompressor_decompress_into__doc__},
+
+static PyObject *
+_lzma_LZMADecompressor_decompress_into_impl(Decompressor *self, Py_buffer *data, Py_buffer *buffer);
+
+static PyObject *
+_lzma_LZMADecompressor_decompress_into(Decompressor *self, PyObject *args)
+{
+    PyObject *return_value = NULL;
+    Py_buffer data = {NULL, NULL};
+    Py_buffer buffer = {NULL, NULL};
+
+    if (!PyArg_ParseTuple(args,
+        "y*w*:decompress_into",
+        &data, &buffer))
+        goto exit;
+    return_value = _lzma_LZMADecompressor_decompress_into_impl(self, &data, &buffer);
+
+exit:
+    /* Cleanup for data */
+    if (data.obj)
+       PyBuffer_Release(&data);
+    /* Cleanup for buffer */
+    if (buffer.obj)
+       PyBuffer_Release(&buffer);
+
+    return return_value;
+}
+
 PyDoc_STRVAR(_lzma_LZMADecompressor___init____doc__,
 "LZMADecompressor(format=FORMAT_AUTO, memlimit=None, filters=None)\n"
 "--\n"
@@ -242,4 +284,4 @@ exit:
 
     return return_value;
 }
-/*[clinic end generated code: output=808fec8216ac712b input=a9049054013a1b77]*/
+/*[clinic end generated code: output=f856008f8f0e6e0e input=a9049054013a1b77]*/
@@ -2,6 +2,71 @@
 preserve
 [clinic start generated code]*/
 
+PyDoc_STRVAR(PickleBuffer_new__doc__,
+"PickleBuffer(buffer)\n"
+"--\n"
+"\n"
+"Wrapper for potentially out-of-band buffers.");
+
+static PyObject *
+PickleBuffer_new_impl(PyTypeObject *type, PyObject *buffer);
+
+static PyObject *
+PickleBuffer_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    PyObject *return_value = NULL;
+    static char *_keywords[] = {"buffer", NULL};
+    PyObject *buffer;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs,
+        "O:PickleBuffer", _keywords,
+        &buffer))
+        goto exit;
+    return_value = PickleBuffer_new_impl(type, buffer);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_pickle_PickleBuffer_raw__doc__,
+"raw($self, /)\n"
+"--\n"
+"\n"
+"Return a memoryview of the raw memory underlying this buffer.\n"
+"\n"
+"The memoryview has format \'B\' and one dimension.  BufferError is\n"
+"raised if the buffer is not contiguous.");
+
+#define _PICKLE_PICKLEBUFFER_RAW_METHODDEF    \
+    {"raw", (PyCFunction)_pickle_PickleBuffer_raw, METH_NOARGS, _pickle_PickleBuffer_raw__doc__},
+
+static PyObject *
+_pickle_PickleBuffer_raw_impl(PickleBufferObject *self);
+
+static PyObject *
+_pickle_PickleBuffer_raw(PickleBufferObject *self, PyObject *Py_UNUSED(ignored))
+{
+    return _pickle_PickleBuffer_raw_impl(self);
+}
+
+PyDoc_STRVAR(_pickle_PickleBuffer_release__doc__,
+"release($self, /)\n"
+"--\n"
+"\n"
+"Release the underlying buffer exposed by the PickleBuffer object.");
+
+#define _PICKLE_PICKLEBUFFER_RELEASE_METHODDEF    \
+    {"release", (PyCFunction)_pickle_PickleBuffer_release, METH_NOARGS, _pickle_PickleBuffer_release__doc__},
+
+static PyObject *
+_pickle_PickleBuffer_release_impl(PickleBufferObject *self);
+
+static PyObject *
+_pickle_PickleBuffer_release(PickleBufferObject *self, PyObject *Py_UNUSED(ignored))
+{
+    return _pickle_PickleBuffer_release_impl(self);
+}
+
 PyDoc_STRVAR(_pickle_Pickler_clear_memo__doc__,
 "clear_memo($self, /)\n"
 "--\n"
@@ -62,13 +127,13 @@ exit:
 }
 
 PyDoc_STRVAR(_pickle_Pickler___init____doc__,
-"Pickler(file, protocol=None, fix_imports=True)\n"
+"Pickler(file, protocol=None, fix_imports=True, buffer_callback=None)\n"
 "--\n"
 "\n"
 "This takes a binary file for writing a pickle data stream.\n"
 "\n"
 "The optional *protocol* argument tells the pickler to use the given\n"
-"protocol; supported protocols are 0, 1, 2, 3 and 4.  The default\n"
+"protocol; supported protocols are 0, 1, 2, 3, 4 and 5.  The default\n"
 "protocol is 3; a backward-incompatible protocol designed for Python 3.\n"
 "\n"
 "Specifying a negative protocol version selects the highest protocol\n"
@@ -82,25 +147,37 @@ PyDoc_STRVAR(_pickle_Pickler___init____doc__,
 "\n"
 "If *fix_imports* is True and protocol is less than 3, pickle will try\n"
 "to map the new Python 3 names to the old module names used in Python\n"
-"2, so that the pickle data stream is readable with Python 2.");
+"2, so that the pickle data stream is readable with Python 2.\n"
+"\n"
+"If *buffer_callback* is None (the default), buffer views are\n"
+"serialized into *file* as part of the pickle stream.\n"
+"\n"
+"If *buffer_callback* is not None, then it can be called any number\n"
+"of times with a buffer view.  If the callback returns a false value\n"
+"(such as None), the given buffer is out-of-band; otherwise the\n"
+"buffer is serialized in-band, i.e. inside the pickle stream.\n"
+"\n"
+"It is an error if *buffer_callback* is not None and *protocol*\n"
+"is None or smaller than 5.");
 
 static int
-_pickle_Pickler___init___impl(PicklerObject *self, PyObject *file, PyObject *protocol, int fix_imports);
+_pickle_Pickler___init___impl(PicklerObject *self, PyObject *file, PyObject *protocol, int fix_imports, PyObject *buffer_callback);
 
 static int
 _pickle_Pickler___init__(PyObject *self, PyObject *args, PyObject *kwargs)
 {
     int return_value = -1;
-    static char *_keywords[] = {"file", "protocol", "fix_imports", NULL};
+    static char *_keywords[] = {"file", "protocol", "fix_imports", "buffer_callback", NULL};
     PyObject *file;
     PyObject *protocol = NULL;
     int fix_imports = 1;
+    PyObject *buffer_callback = Py_None;
 
     if (!PyArg_ParseTupleAndKeywords(args, kwargs,
-        "O|Op:Pickler", _keywords,
-        &file, &protocol, &fix_imports))
+        "O|OpO:Pickler", _keywords,
+        &file, &protocol, &fix_imports, &buffer_callback))
         goto exit;
-    return_value = _pickle_Pickler___init___impl((PicklerObject *)self, file, protocol, fix_imports);
+    return_value = _pickle_Pickler___init___impl((PicklerObject *)self, file, protocol, fix_imports, buffer_callback);
 
 exit:
     return return_value;
@@ -246,7 +323,8 @@ exit:
 }
 
 PyDoc_STRVAR(_pickle_Unpickler___init____doc__,
-"Unpickler(file, *, fix_imports=True, encoding=\'ASCII\', errors=\'strict\')\n"
+"Unpickler(file, *, fix_imports=True, encoding=\'ASCII\', errors=\'strict\',\n"
+"          buffers=())\n"
 "--\n"
 "\n"
 "This takes a binary file for reading a pickle data stream.\n"
@@ -268,26 +346,32 @@ PyDoc_STRVAR(_pickle_Unpickler___init____doc__,
 "*encoding* and *errors* tell pickle how to decode 8-bit string\n"
 "instances pickled by Python 2; these default to \'ASCII\' and \'strict\',\n"
 "respectively.  The *encoding* can be \'bytes\' to read these 8-bit\n"
-"string instances as bytes objects.");
+"string instances as bytes objects.\n"
+"\n"
+"If *buffers* is not None, it should be an iterable of buffer-enabled\n"
+"objects that is consumed each time the pickle stream references an\n"
+"out-of-band buffer view.  Such buffers have been given in order to\n"
+"the *buffer_callback* of a Pickler object.");
 
 static int
-_pickle_Unpickler___init___impl(UnpicklerObject *self, PyObject *file, int fix_imports, const char *encoding, const char *errors);
+_pickle_Unpickler___init___impl(UnpicklerObject *self, PyObject *file, int fix_imports, const char *encoding, const char *errors, PyObject *buffers);
 
 static int
 _pickle_Unpickler___init__(PyObject *self, PyObject *args, PyObject *kwargs)
 {
     int return_value = -1;
-    static char *_keywords[] = {"file", "fix_imports", "encoding", "errors", NULL};
+    static char *_keywords[] = {"file", "fix_imports", "encoding", "errors", "buffers", NULL};
     PyObject *file;
     int fix_imports = 1;
     const char *encoding = "ASCII";
     const char *errors = "strict";
+    PyObject *buffers = NULL;
 
     if (!PyArg_ParseTupleAndKeywords(args, kwargs,
-        "O|$pss:Unpickler", _keywords,
-        &file, &fix_imports, &encoding, &errors))
+        "O|$pssO:Unpickler", _keywords,
+        &file, &fix_imports, &encoding, &errors, &buffers))
         goto exit;
-    return_value = _pickle_Unpickler___init___impl((UnpicklerObject *)self, file, fix_imports, encoding, errors);
+    return_value = _pickle_Unpickler___init___impl((UnpicklerObject *)self, file, fix_imports, encoding, errors, buffers);
 
 exit:
     return return_value;
@@ -348,7 +432,8 @@ _pickle_UnpicklerMemoProxy___reduce__(UnpicklerMemoProxyObject *self, PyObject *
 }
 
 PyDoc_STRVAR(_pickle_dump__doc__,
-"dump($module, /, obj, file, protocol=None, *, fix_imports=True)\n"
+"dump($module, /, obj, file, protocol=None, *, fix_imports=True,\n"
+"     buffer_callback=None, workers=None)\n"
 "--\n"
 "\n"
 "Write a pickled representation of obj to the open file object file.\n"
@@ -357,7 +442,7 @@ PyDoc_STRVAR(_pickle_dump__doc__,
 "be more efficient.\n"
 "\n"
 "The optional *protocol* argument tells the pickler to use the given\n"
-"protocol supported protocols are 0, 1, 2, 3 and 4.  The default\n"
+"protocol supported protocols are 0, 1, 2, 3, 4 and 5.  The default\n"
 "protocol is 3; a backward-incompatible protocol designed for Python 3.\n"
 "\n"
 "Specifying a negative protocol version selects the highest protocol\n"
@@ -371,42 +456,53 @@ PyDoc_STRVAR(_pickle_dump__doc__,
 "\n"
 "If *fix_imports* is True and protocol is less than 3, pickle will try\n"
 "to map the new Python 3 names to the old module names used in Python\n"
-"2, so that the pickle data stream is readable with Python 2.");
+"2, so that the pickle data stream is readable with Python 2.\n"
+"\n"
+"If *buffer_callback* is None (the default), buffer views are serialized\n"
+"into *file* as part of the pickle stream.  It is an error if\n"
+"*buffer_callback* is not None and *protocol* is None or smaller than 5.\n"
+"\n"
+"If *workers* is greater than 1 and *protocol* is 4 or higher, the items\n"
+"of a large list or dict are pickled in up to *workers* threads.  Shared\n"
+"references to immutable objects may then be pickled several times.");
 
 #define _PICKLE_DUMP_METHODDEF    \
     {"dump", (PyCFunction)_pickle_dump, METH_VARARGS|METH_KEYWORDS, _pickle_dump__doc__},
 
 static PyObject *
-_pickle_dump_impl(PyModuleDef *module, PyObject *obj, PyObject *file, PyObject *protocol, int fix_imports);
+_pickle_dump_impl(PyModuleDef *module, PyObject *obj, PyObject *file, PyObject *protocol, int fix_imports, PyObject *buffer_callback, PyObject *workers);
 
 static PyObject *
 _pickle_dump(PyModuleDef *module, PyObject *args, PyObject *kwargs)
 {
     PyObject *return_value = NULL;
-    static char *_keywords[] = {"obj", "file", "protocol", "fix_imports", NULL};
+    static char *_keywords[] = {"obj", "file", "protocol", "fix_imports", "buffer_callback", "workers", NULL};
     PyObject *obj;
     PyObject *file;
     PyObject *protocol = NULL;
     int fix_imports = 1;
+    PyObject *buffer_callback = Py_None;
+    PyObject *workers = Py_None;
 
     if (!PyArg_ParseTupleAndKeywords(args, kwargs,
-        "OO|O$p:dump", _keywords,
-        &obj, &file, &protocol, &fix_imports))
+        "OO|O$pOO:dump", _keywords,
+        &obj, &file, &protocol, &fix_imports, &buffer_callback, &workers))
         goto exit;
-    return_value = _pickle_dump_impl(module, obj, file, protocol, fix_imports);
+    return_value = _pickle_dump_impl(module, obj, file, protocol, fix_imports, buffer_callback, workers);
 
 exit:
     return return_value;
 }
 
 PyDoc_STRVAR(_pickle_dumps__doc__,
-"dumps($module, /, obj, protocol=None, *, fix_imports=True)\n"
+"dumps($module, /, obj, protocol=None, *, fix_imports=True,\n"
+"      buffer_callback=None, workers=None)\n"
 "--\n"
 "\n"
 "Return the pickled representation of the object as a bytes object.\n"
 "\n"
 "The optional *protocol* argument tells the pickler to use the given\n"
-"protocol; supported protocols are 0, 1, 2, 3 and 4.  The default\n"
+"protocol; supported protocols are 0, 1, 2, 3, 4 and 5.  The default\n"
 "protocol is 3; a backward-incompatible protocol designed for Python 3.\n"
 "\n"
 "Specifying a negative protocol version selects the highest protocol\n"
@@ -415,28 +511,38 @@ PyDoc_STRVAR(_pickle_dumps__doc__,
 "\n"
 "If *fix_imports* is True and *protocol* is less than 3, pickle will\n"
 "try to map the new Python 3 names to the old module names used in\n"
-"Python 2, so that the pickle data stream is readable with Python 2.");
+"Python 2, so that the pickle data stream is readable with Python 2.\n"
+"\n"
+"If *buffer_callback* is None (the default), buffer views are serialized\n"
+"into the pickle stream.  It is an error if *buffer_callback* is not None\n"
+"and *protocol* is None or smaller than 5.\n"
+"\n"
+"If *workers* is greater than 1 and *protocol* is 4 or higher, the items\n"
+"of a large list or dict are pickled in up to *workers* threads.  Shared\n"
+"references to immutable objects may then be pickled several times.");
 
 #define _PICKLE_DUMPS_METHODDEF    \
     {"dumps", (PyCFunction)_pickle_dumps, METH_VARARGS|METH_KEYWORDS, _pickle_dumps__doc__},
 
 static PyObject *
-_pickle_dumps_impl(PyModuleDef *module, PyObject *obj, PyObject *protocol, int fix_imports);
+_pickle_dumps_impl(PyModuleDef *module, PyObject *obj, PyObject *protocol, int fix_imports, PyObject *buffer_callback, PyObject *workers);
 
 static PyObject *
 _pickle_dumps(PyModuleDef *module, PyObject *args, PyObject *kwargs)
 {
     PyObject *return_value = NULL;
-    static char *_keywords[] = {"obj", "protocol", "fix_imports", NULL};
+    static char *_keywords[] = {"obj", "protocol", "fix_imports", "buffer_callback", "workers", NULL};
     PyObject *obj;
     PyObject *protocol = NULL;
     int fix_imports = 1;
+    PyObject *buffer_callback = Py_None;
+    PyObject *workers = Py_None;
 
     if (!PyArg_ParseTupleAndKeywords(args, kwargs,
-        "O|O$p:dumps", _keywords,
-        &obj, &protocol, &fix_imports))
+        "O|O$pOO:dumps", _keywords,
+        &obj, &protocol, &fix_imports, &buffer_callback, &workers))
         goto exit;
-    return_value = _pickle_dumps_impl(module, obj, protocol, fix_imports);
+    return_value = _pickle_dumps_impl(module, obj, protocol, fix_imports, buffer_callback, workers);
 
 exit:
     return return_value;
@@ -444,7 +550,7 @@ exit:
 
 PyDoc_STRVAR(_pickle_load__doc__,
 "load($module, /, file, *, fix_imports=True, encoding=\'ASCII\',\n"
-"     errors=\'strict\')\n"
+"     errors=\'strict\', buffers=())\n"
 "--\n"
 "\n"
 "Read and return an object from the pickle data stored in a file.\n"
@@ -469,29 +575,35 @@ PyDoc_STRVAR(_pickle_load__doc__,
 "*encoding* and *errors* tell pickle how to decode 8-bit string\n"
 "instances pickled by Python 2; these default to \'ASCII\' and \'strict\',\n"
 "respectively.  The *encoding* can be \'bytes\' to read these 8-bit\n"
-"string instances as bytes objects.");
+"string instances as bytes objects.\n"
+"\n"
+"If *buffers* is not None, it should be an iterable of buffer-enabled\n"
+"objects that is consumed each time the pickle stream references an\n"
+"out-of-band buffer view.  Such buffers have been given in order to\n"
+"the *buffer_callback* of a Pickler object.");
 
 #define _PICKLE_LOAD_METHODDEF    \
     {"load", (PyCFunction)_pickle_load, METH_VARARGS|METH_KEYWORDS, _pickle_load__doc__},
 
 static PyObject *
-_pickle_load_impl(PyModuleDef *module, PyObject *file, int fix_imports, const char *encoding, const char *errors);
+_pickle_load_impl(PyModuleDef *module, PyObject *file, int fix_imports, const char *encoding, const char *errors, PyObject *buffers);
 
 static PyObject *
 _pickle_load(PyModuleDef *module, PyObject *args, PyObject *kwargs)
 {
     PyObject *return_value = NULL;
-    static char *_keywords[] = {"file", "fix_imports", "encoding", "errors", NULL};
+    static char *_keywords[] = {"file", "fix_imports", "encoding", "errors", "buffers", NULL};
     PyObject *file;
     int fix_imports = 1;
     const char *encoding = "ASCII";
     const char *errors = "strict";
+    PyObject *buffers = NULL;
 
     if (!PyArg_ParseTupleAndKeywords(args, kwargs,
-        "O|$pss:load", _keywords,
-        &file, &fix_imports, &encoding, &errors))
+        "O|$pssO:load", _keywords,
+        &file, &fix_imports, &encoding, &errors, &buffers))
         goto exit;
-    return_value = _pickle_load_impl(module, file, fix_imports, encoding, errors);
+    return_value = _pickle_load_impl(module, file, fix_imports, encoding, errors, buffers);
 
 exit:
     return return_value;
@@ -499,7 +611,7 @@ exit:
 
 PyDoc_STRVAR(_pickle_loads__doc__,
 "loads($module, /, data, *, fix_imports=True, encoding=\'ASCII\',\n"
-"      errors=\'strict\')\n"
+"      errors=\'strict\', buffers=())\n"
 "--\n"
 "\n"
 "Read and return an object from the given pickle data.\n"
@@ -515,31 +627,37 @@ PyDoc_STRVAR(_pickle_loads__doc__,
 "*encoding* and *errors* tell pickle how to decode 8-bit string\n"
 "instances pickled by Python 2; these default to \'ASCII\' and \'strict\',\n"
 "respectively.  The *encoding* can be \'bytes\' to read these 8-bit\n"
-"string instances as bytes objects.");
+"string instances as bytes objects.\n"
+"\n"
+"If *buffers* is not None, it should be an iterable of buffer-enabled\n"
+"objects that is consumed each time the pickle stream references an\n"
+"out-of-band buffer view.  Such buffers have been given in order to\n"
+"the *buffer_callback* of a Pickler object.");
 
 #define _PICKLE_LOADS_METHODDEF    \
     {"loads", (PyCFunction)_pickle_loads, METH_VARARGS|METH_KEYWORDS, _pickle_loads__doc__},
 
 static PyObject *
-_pickle_loads_impl(PyModuleDef *module, PyObject *data, int fix_imports, const char *encoding, const char *errors);
+_pickle_loads_impl(PyModuleDef *module, PyObject *data, int fix_imports, const char *encoding, const char *errors, PyObject *buffers);
 
 static PyObject *
 _pickle_loads(PyModuleDef *module, PyObject *args, PyObject *kwargs)
 {
     PyObject *return_value = NULL;
-    static char *_keywords[] = {"data", "fix_imports", "encoding", "errors", NULL};
+    static char *_keywords[] = {"data", "fix_imports", "encoding", "errors", "buffers", NULL};
     PyObject *data;
     int fix_imports = 1;
     const char *encoding = "ASCII";
     const char *errors = "strict";
+    PyObject *buffers = NULL;
 
     if (!PyArg_ParseTupleAndKeywords(args, kwargs,
-        "O|$pss:loads", _keywords,
-        &data, &fix_imports, &encoding, &errors))
+        "O|$pssO:loads", _keywords,
+        &data, &fix_imports, &encoding, &errors, &buffers))
         goto exit;
-    return_value = _pickle_loads_impl(module, data, fix_imports, encoding, errors);
+    return_value = _pickle_loads_impl(module, data, fix_imports, encoding, errors, buffers);
 
 exit:
     return return_value;
 }
-/*[clinic end generated code: output=3aba79576e240c62 input=a9049054013a1b77]*/
+/*[clinic end generated code: output=654507d66c78a8c3 input=a9049054013a1b77]*/
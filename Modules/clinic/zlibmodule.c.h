@@ -258,6 +258,53 @@ exit:
     return return_value;
 }
 
+PyDoc_STRVAR(zlib_Decompress_decompress_into__doc__,
+"decompress_into($self, data, buffer, /)\n"
+"--\n"
+"\n"
+"Decompress data into buffer and return the number of bytes written.\n"
+"\n"
+"  data\n"
+"    The binary data to decompress.\n"
+"  buffer\n"
+"    A writable bytes-like object receiving the decompressed data.\n"
+"    Once it is full, unconsumed input data will be stored in\n"
+"    the unconsumed_tail attribute.\n"
+"\n"
+"No bytes object is created for the output.  When buffer has been filled,\n"
+"more output may be pending: call this method again with unconsumed_tail\n"
+"(which may be empty) to get it.");
+
+#define ZLIB_DECOMPRESS_DECOMPRESS_INTO_METHODDEF    \
+    {"decompress_into", (PyCFunction)zlib_Decompress_decompress_into, METH_VARARGS, zlib_Decompress_decompress_into__doc__},
+
+static PyObject *
+zlib_Decompress_decompress_into_impl(compobject *self, Py_buffer *data, Py_buffer *buffer);
+
+static PyObject *
+zlib_Decompress_decompress_into(compobject *self, PyObject *args)
+{
+    PyObject *return_value = NULL;
+    Py_buffer data = {NULL, NULL};
+    Py_buffer buffer = {NULL, NULL};
+
+    if (!PyArg_ParseTuple(args,
+        "y*w*:decompress_into",
+        &data, &buffer))
+        goto exit;
+    return_value = zlib_Decompress_decompress_into_impl(self, &data, &buffer);
+
+exit:
+    /* Cleanup for data */
+    if (data.obj)
+       PyBuffer_Release(&data);
+    /* Cleanup for buffer */
+    if (buffer.obj)
+       PyBuffer_Release(&buffer);
+
+    return return_value;
+}
+
 PyDoc_STRVAR(zlib_Compress_flush__doc__,
 "flush($self, mode=zlib.Z_FINISH, /)\n"
 "--\n"
@@ -450,4 +497,4 @@ exit:
 
     return return_value;
 }
-/*[clinic end generated code: output=bc9473721ca7c962 input=a9049054013a1b77]*/
+/*[clinic end generated code: output=a85a21def50a3694 input=a9049054013a1b77]*/
@@ -59,3 +59,93 @@
  * to allow the user to optimize based on the platform they're using. */
 #define HASHLIB_GIL_MINSIZE 2048
 
+
+/*
+ * Digest each bytes-like object of the iterable messages with digest_func
+ * and return the list of the digests.  All the buffers are acquired up
+ * front, so the GIL is released once for the whole batch rather than once
+ * per message, and no hash object is created for any of them.
+ */
+typedef void (*hashlib_digest_func)(const unsigned char *buf, Py_ssize_t len,
+                                    unsigned char *digest);
+
+Py_LOCAL_INLINE(PyObject *)
+hashlib_digest_many(PyObject *messages, Py_ssize_t digest_size,
+                    hashlib_digest_func digest_func)
+{
+    PyObject *seq, *item, *result = NULL;
+    Py_buffer *views = NULL;
+    unsigned char *digests = NULL;
+    Py_ssize_t i, n, nviews = 0, total = 0;
+
+    seq = PySequence_Fast(messages, "messages must be an iterable");
+    if (seq == NULL)
+        return NULL;
+    n = PySequence_Fast_GET_SIZE(seq);
+    if (n > PY_SSIZE_T_MAX / digest_size) {
+        PyErr_NoMemory();
+        goto done;
+    }
+    views = PyMem_New(Py_buffer, n);
+    digests = (unsigned char *)PyMem_Malloc(n * digest_size);
+    if (views == NULL || digests == NULL) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    for (nviews = 0; nviews < n; nviews++) {
+        item = PySequence_Fast_GET_ITEM(seq, nviews);
+        if (PyUnicode_Check(item)) {
+            PyErr_SetString(PyExc_TypeError,
+                            "Unicode-objects must be encoded before hashing");
+            goto done;
+        }
+        if (!PyObject_CheckBuffer(item)) {
+            PyErr_SetString(PyExc_TypeError,
+                            "object supporting the buffer API required");
+            goto done;
+        }
+        if (PyObject_GetBuffer(item, &views[nviews], PyBUF_SIMPLE) == -1)
+            goto done;
+        if (views[nviews].ndim > 1) {
+            PyErr_SetString(PyExc_BufferError,
+                            "Buffer must be single dimension");
+            PyBuffer_Release(&views[nviews]);
+            goto done;
+        }
+        if (total < HASHLIB_GIL_MINSIZE)
+            total += views[nviews].len;
+    }
+
+    if (total >= HASHLIB_GIL_MINSIZE) {
+        Py_BEGIN_ALLOW_THREADS
+        for (i = 0; i < n; i++)
+            digest_func(views[i].buf, views[i].len, digests + i * digest_size);
+        Py_END_ALLOW_THREADS
+    }
+    else {
+        for (i = 0; i < n; i++)
+            digest_func(views[i].buf, views[i].len, digests + i * digest_size);
+    }
+
+    result = PyList_New(n);
+    if (result == NULL)
+        goto done;
+    for (i = 0; i < n; i++) {
+        item = PyBytes_FromStringAndSize((const char *)digests + i * digest_size,
+                                         digest_size);
+        if (item == NULL) {
+            Py_CLEAR(result);
+            goto done;
+        }
+        PyList_SET_ITEM(result, i, item);
+    }
+
+done:
+    for (i = 0; i < nviews; i++)
+        PyBuffer_Release(&views[i]);
+    PyMem_Free(views);
+    PyMem_Free(digests);
+    Py_DECREF(seq);
+    return result;
+}
@@ -51,6 +51,9 @@ typedef struct {
     PyObject_HEAD
 
     struct md5_state hash_state;
+#ifdef WITH_THREAD
+    PyThread_type_lock lock;
+#endif
 } MD5object;
 
 
@@ -322,7 +325,12 @@ static PyTypeObject MD5type;
 static MD5object *
 newMD5object(void)
 {
-    return (MD5object *)PyObject_New(MD5object, &MD5type);
+    MD5object *retval = (MD5object *)PyObject_New(MD5object, &MD5type);
+#ifdef WITH_THREAD
+    if (retval != NULL)
+        retval->lock = NULL;
+#endif
+    return retval;
 }
 
 
@@ -331,6 +339,12 @@ newMD5object(void)
 static void
 MD5_dealloc(PyObject *ptr)
 {
+#ifdef WITH_THREAD
+    MD5object *self = (MD5object *)ptr;
+
+    if (self->lock != NULL)
+        PyThread_free_lock(self->lock);
+#endif
     PyObject_Del(ptr);
 }
 
@@ -375,7 +389,9 @@ MD5Type_copy_impl(MD5object *self)
             return NULL;
     }
 
+    ENTER_HASHLIB(self);
     newobj->hash_state = self->hash_state;
+    LEAVE_HASHLIB(self);
     return (PyObject *)newobj;
 }
 
@@ -410,7 +426,9 @@ MD5Type_digest_impl(MD5object *self)
     unsigned char digest[MD5_DIGESTSIZE];
     struct md5_state temp;
 
+    ENTER_HASHLIB(self);
     temp = self->hash_state;
+    LEAVE_HASHLIB(self);
     md5_done(&temp, digest);
     return PyBytes_FromStringAndSize((const char *)digest, MD5_DIGESTSIZE);
 }
@@ -450,7 +468,9 @@ MD5Type_hexdigest_impl(MD5object *self)
     int i, j;
 
     /* Get the raw (binary) digest value */
+    ENTER_HASHLIB(self);
     temp = self->hash_state;
+    LEAVE_HASHLIB(self);
     md5_done(&temp, digest);
 
     /* Create a new string */
@@ -499,7 +519,24 @@ MD5Type_update(MD5object *self, PyObject *obj)
 
     GET_BUFFER_VIEW_OR_ERROUT(obj, &buf);
 
+#ifdef WITH_THREAD
+    if (self->lock == NULL && buf.len >= HASHLIB_GIL_MINSIZE) {
+        self->lock = PyThread_allocate_lock();
+        /* fail? lock = NULL and we fail over to non-threaded code. */
+    }
+
+    if (self->lock != NULL) {
+        Py_BEGIN_ALLOW_THREADS
+        PyThread_acquire_lock(self->lock, 1);
+        md5_process(&self->hash_state, buf.buf, buf.len);
+        PyThread_release_lock(self->lock);
+        Py_END_ALLOW_THREADS
+    } else {
+        md5_process(&self->hash_state, buf.buf, buf.len);
+    }
+#else
     md5_process(&self->hash_state, buf.buf, buf.len);
+#endif
 
     PyBuffer_Release(&buf);
     Py_INCREF(Py_None);
@@ -648,18 +685,68 @@ _md5_md5_impl(PyModuleDef *module, PyObject *string)
         return NULL;
     }
     if (string) {
-        md5_process(&new->hash_state, buf.buf, buf.len);
+        if (buf.len >= HASHLIB_GIL_MINSIZE) {
+            Py_BEGIN_ALLOW_THREADS
+            md5_process(&new->hash_state, buf.buf, buf.len);
+            Py_END_ALLOW_THREADS
+        }
+        else {
+            md5_process(&new->hash_state, buf.buf, buf.len);
+        }
         PyBuffer_Release(&buf);
     }
 
     return (PyObject *)new;
 }
 
+static void
+md5_digest_buffer(const unsigned char *buf, Py_ssize_t len,
+                  unsigned char *digest)
+{
+    struct md5_state md5;
+
+    md5_init(&md5);
+    md5_process(&md5, buf, len);
+    md5_done(&md5, digest);
+}
+
+/*[clinic input]
+_md5.md5_many
+
+    messages: object
+    /
+
+Return a list with the MD5 digest of each bytes-like object in messages.
+
+This is faster than creating a hash object per message when hashing many
+short messages; the GIL is released once for the whole batch.
+[clinic start generated code]*/
+
+PyDoc_STRVAR(_md5_md5_many__doc__,
+"md5_many($module, messages, /)\n"
+"--\n"
+"\n"
+"Return a list with the MD5 digest of each bytes-like object in messages.\n"
+"\n"
+"This is faster than creating a hash object per message when hashing many\n"
+"short messages; the GIL is released once for the whole batch.");
+
+#define _MD5_MD5_MANY_METHODDEF    \
+    {"md5_many", (PyCFunction)_md5_md5_many, METH_O, _md5_md5_many__doc__},
+
+static PyObject *
+_md5_md5_many(PyModuleDef *module, PyObject *messages)
+/*[clinic end generated code: output=e09f99b6abb1a788 input=ec7ebad4c9874e06]*/
+{
+    return hashlib_digest_many(messages, MD5_DIGESTSIZE, md5_digest_buffer);
+}
+
 
 /* List of functions exported by this module */
 
 static struct PyMethodDef MD5_functions[] = {
     _MD5_MD5_METHODDEF
+    _MD5_MD5_MANY_METHODDEF
     {NULL,      NULL}            /* Sentinel */
 };
 
@@ -1172,6 +1172,8 @@ static int select_have_broken_poll(void)
 typedef struct {
     PyObject_HEAD
     SOCKET epfd;                        /* epoll control file descriptor */
+    struct epoll_event *evs;            /* event buffer reused by poll() */
+    int evs_len;                        /* number of entries of evs */
 } pyEpoll_Object;
 
 static PyTypeObject pyEpoll_Type;
@@ -1262,6 +1264,7 @@ static void
 pyepoll_dealloc(pyEpoll_Object *self)
 {
     (void)pyepoll_internal_close(self);
+    PyMem_Free(self->evs);
     Py_TYPE(self)->tp_free(self);
 }
 
@@ -1443,6 +1446,7 @@ pyepoll_poll(pyEpoll_Object *self, PyObject *args, PyObject *kwds)
     int nfds, i;
     PyObject *elist = NULL, *etuple = NULL;
     struct epoll_event *evs = NULL;
+    int evs_len;
     static char *kwlist[] = {"timeout", "maxevents", NULL};
 
     if (self->epfd < 0)
@@ -1477,10 +1481,21 @@ pyepoll_poll(pyEpoll_Object *self, PyObject *args, PyObject *kwds)
         return NULL;
     }
 
-    evs = PyMem_New(struct epoll_event, maxevents);
-    if (evs == NULL) {
-        PyErr_NoMemory();
-        return NULL;
+    /* An event loop calls poll() on every iteration: reuse the buffer of
+       the previous call.  The buffer is detached from the object while
+       epoll_wait() runs, so concurrent calls from other threads allocate
+       their own. */
+    evs = self->evs;
+    evs_len = self->evs_len;
+    self->evs = NULL;
+    if (evs == NULL || evs_len < maxevents) {
+        PyMem_Free(evs);
+        evs = PyMem_New(struct epoll_event, maxevents);
+        if (evs == NULL) {
+            PyErr_NoMemory();
+            return NULL;
+        }
+        evs_len = maxevents;
     }
 
     Py_BEGIN_ALLOW_THREADS
@@ -1497,16 +1512,31 @@ pyepoll_poll(pyEpoll_Object *self, PyObject *args, PyObject *kwds)
     }
 
     for (i = 0; i < nfds; i++) {
-        etuple = Py_BuildValue("iI", evs[i].data.fd, evs[i].events);
-        if (etuple == NULL) {
+        PyObject *fd, *events;
+
+        fd = PyLong_FromLong(evs[i].data.fd);
+        events = PyLong_FromUnsignedLong(evs[i].events);
+        etuple = PyTuple_New(2);
+        if (fd == NULL || events == NULL || etuple == NULL) {
+            Py_XDECREF(fd);
+            Py_XDECREF(events);
+            Py_XDECREF(etuple);
             Py_CLEAR(elist);
             goto error;
         }
+        PyTuple_SET_ITEM(etuple, 0, fd);
+        PyTuple_SET_ITEM(etuple, 1, events);
         PyList_SET_ITEM(elist, i, etuple);
     }
 
     error:
-    PyMem_Free(evs);
+    if (self->evs == NULL) {
+        self->evs = evs;
+        self->evs_len = evs_len;
+    }
+    else {
+        PyMem_Free(evs);
+    }
     return elist;
 }
 
@@ -51,6 +51,9 @@ typedef struct {
     PyObject_HEAD
 
     struct sha1_state hash_state;
+#ifdef WITH_THREAD
+    PyThread_type_lock lock;
+#endif
 } SHA1object;
 
 
@@ -299,7 +302,12 @@ static PyTypeObject SHA1type;
 static SHA1object *
 newSHA1object(void)
 {
-    return (SHA1object *)PyObject_New(SHA1object, &SHA1type);
+    SHA1object *retval = (SHA1object *)PyObject_New(SHA1object, &SHA1type);
+#ifdef WITH_THREAD
+    if (retval != NULL)
+        retval->lock = NULL;
+#endif
+    return retval;
 }
 
 
@@ -308,6 +316,12 @@ newSHA1object(void)
 static void
 SHA1_dealloc(PyObject *ptr)
 {
+#ifdef WITH_THREAD
+    SHA1object *self = (SHA1object *)ptr;
+
+    if (self->lock != NULL)
+        PyThread_free_lock(self->lock);
+#endif
     PyObject_Del(ptr);
 }
 
@@ -347,7 +361,9 @@ SHA1Type_copy_impl(SHA1object *self)
     if ((newobj = newSHA1object()) == NULL)
         return NULL;
 
+    ENTER_HASHLIB(self);
     newobj->hash_state = self->hash_state;
+    LEAVE_HASHLIB(self);
     return (PyObject *)newobj;
 }
 
@@ -382,7 +398,9 @@ SHA1Type_digest_impl(SHA1object *self)
     unsigned char digest[SHA1_DIGESTSIZE];
     struct sha1_state temp;
 
+    ENTER_HASHLIB(self);
     temp = self->hash_state;
+    LEAVE_HASHLIB(self);
     sha1_done(&temp, digest);
     return PyBytes_FromStringAndSize((const char *)digest, SHA1_DIGESTSIZE);
 }
@@ -422,7 +440,9 @@ SHA1Type_hexdigest_impl(SHA1object *self)
     int i, j;
 
     /* Get the raw (binary) digest value */
+    ENTER_HASHLIB(self);
     temp = self->hash_state;
+    LEAVE_HASHLIB(self);
     sha1_done(&temp, digest);
 
     /* Create a new string */
@@ -471,7 +491,24 @@ SHA1Type_update(SHA1object *self, PyObject *obj)
 
     GET_BUFFER_VIEW_OR_ERROUT(obj, &buf);
 
+#ifdef WITH_THREAD
+    if (self->lock == NULL && buf.len >= HASHLIB_GIL_MINSIZE) {
+        self->lock = PyThread_allocate_lock();
+        /* fail? lock = NULL and we fail over to non-threaded code. */
+    }
+
+    if (self->lock != NULL) {
+        Py_BEGIN_ALLOW_THREADS
+        PyThread_acquire_lock(self->lock, 1);
+        sha1_process(&self->hash_state, buf.buf, buf.len);
+        PyThread_release_lock(self->lock);
+        Py_END_ALLOW_THREADS
+    } else {
+        sha1_process(&self->hash_state, buf.buf, buf.len);
+    }
+#else
     sha1_process(&self->hash_state, buf.buf, buf.len);
+#endif
 
     PyBuffer_Release(&buf);
     Py_INCREF(Py_None);
@@ -620,18 +657,68 @@ _sha1_sha1_impl(PyModuleDef *module, PyObject *string)
         return NULL;
     }
     if (string) {
-        sha1_process(&new->hash_state, buf.buf, buf.len);
+        if (buf.len >= HASHLIB_GIL_MINSIZE) {
+            Py_BEGIN_ALLOW_THREADS
+            sha1_process(&new->hash_state, buf.buf, buf.len);
+            Py_END_ALLOW_THREADS
+        }
+        else {
+            sha1_process(&new->hash_state, buf.buf, buf.len);
+        }
         PyBuffer_Release(&buf);
     }
 
     return (PyObject *)new;
 }
 
+static void
+sha1_digest_buffer(const unsigned char *buf, Py_ssize_t len,
+                   unsigned char *digest)
+{
+    struct sha1_state sha1;
+
+    sha1_init(&sha1);
+    sha1_process(&sha1, buf, len);
+    sha1_done(&sha1, digest);
+}
+
+/*[clinic input]
+_sha1.sha1_many
+
+    messages: object
+    /
+
+Return a list with the SHA1 digest of each bytes-like object in messages.
+
+This is faster than creating a hash object per message when hashing many
+short messages; the GIL is released once for the whole batch.
+[clinic start generated code]*/
+
+PyDoc_STRVAR(_sha1_sha1_many__doc__,
+"sha1_many($module, messages, /)\n"
+"--\n"
+"\n"
+"Return a list with the SHA1 digest of each bytes-like object in messages.\n"
+"\n"
+"This is faster than creating a hash object per message when hashing many\n"
+"short messages; the GIL is released once for the whole batch.");
+
+#define _SHA1_SHA1_MANY_METHODDEF    \
+    {"sha1_many", (PyCFunction)_sha1_sha1_many, METH_O, _sha1_sha1_many__doc__},
+
+static PyObject *
+_sha1_sha1_many(PyModuleDef *module, PyObject *messages)
+/*[clinic end generated code: output=be6db88e7feba13f input=a0f1638b084e572a]*/
+{
+    return hashlib_digest_many(messages, SHA1_DIGESTSIZE, sha1_digest_buffer);
+}
+
 
 /* List of functions exported by this module */
 
 static struct PyMethodDef SHA1_functions[] = {
     _SHA1_SHA1_METHODDEF
+    _SHA1_SHA1_MANY_METHODDEF
     {NULL,      NULL}            /* Sentinel */
 };
 
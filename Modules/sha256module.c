@@ -50,6 +50,9 @@ typedef struct {
     SHA_BYTE data[SHA_BLOCKSIZE];       /* SHA data buffer */
     int local;                          /* unprocessed amount in data */
     int digestsize;
+#ifdef WITH_THREAD
+    PyThread_type_lock lock;
+#endif
 } SHAobject;
 
 /* When run on a little-endian CPU we need to perform byte reversal on an
@@ -378,13 +381,23 @@ static PyTypeObject SHA256type;
 static SHAobject *
 newSHA224object(void)
 {
-    return (SHAobject *)PyObject_New(SHAobject, &SHA224type);
+    SHAobject *retval = (SHAobject *)PyObject_New(SHAobject, &SHA224type);
+#ifdef WITH_THREAD
+    if (retval != NULL)
+        retval->lock = NULL;
+#endif
+    return retval;
 }
 
 static SHAobject *
 newSHA256object(void)
 {
-    return (SHAobject *)PyObject_New(SHAobject, &SHA256type);
+    SHAobject *retval = (SHAobject *)PyObject_New(SHAobject, &SHA256type);
+#ifdef WITH_THREAD
+    if (retval != NULL)
+        retval->lock = NULL;
+#endif
+    return retval;
 }
 
 /* Internal methods for a hash object */
@@ -392,6 +405,12 @@ newSHA256object(void)
 static void
 SHA_dealloc(PyObject *ptr)
 {
+#ifdef WITH_THREAD
+    SHAobject *self = (SHAobject *)ptr;
+
+    if (self->lock != NULL)
+        PyThread_free_lock(self->lock);
+#endif
     PyObject_Del(ptr);
 }
 
@@ -436,7 +455,9 @@ SHA256Type_copy_impl(SHAobject *self)
             return NULL;
     }
 
+    ENTER_HASHLIB(self);
     SHAcopy(self, newobj);
+    LEAVE_HASHLIB(self);
     return (PyObject *)newobj;
 }
 
@@ -471,7 +492,9 @@ SHA256Type_digest_impl(SHAobject *self)
     unsigned char digest[SHA_DIGESTSIZE];
     SHAobject temp;
 
+    ENTER_HASHLIB(self);
     SHAcopy(self, &temp);
+    LEAVE_HASHLIB(self);
     sha_final(digest, &temp);
     return PyBytes_FromStringAndSize((const char *)digest, self->digestsize);
 }
@@ -511,7 +534,9 @@ SHA256Type_hexdigest_impl(SHAobject *self)
     int i, j;
 
     /* Get the raw (binary) digest value */
+    ENTER_HASHLIB(self);
     SHAcopy(self, &temp);
+    LEAVE_HASHLIB(self);
     sha_final(digest, &temp);
 
     /* Create a new string */
@@ -560,7 +585,24 @@ SHA256Type_update(SHAobject *self, PyObject *obj)
 
     GET_BUFFER_VIEW_OR_ERROUT(obj, &buf);
 
+#ifdef WITH_THREAD
+    if (self->lock == NULL && buf.len >= HASHLIB_GIL_MINSIZE) {
+        self->lock = PyThread_allocate_lock();
+        /* fail? lock = NULL and we fail over to non-threaded code. */
+    }
+
+    if (self->lock != NULL) {
+        Py_BEGIN_ALLOW_THREADS
+        PyThread_acquire_lock(self->lock, 1);
+        sha_update(self, buf.buf, buf.len);
+        PyThread_release_lock(self->lock);
+        Py_END_ALLOW_THREADS
+    } else {
+        sha_update(self, buf.buf, buf.len);
+    }
+#else
     sha_update(self, buf.buf, buf.len);
+#endif
 
     PyBuffer_Release(&buf);
     Py_INCREF(Py_None);
@@ -740,7 +782,14 @@ _sha256_sha256_impl(PyModuleDef *module, PyObject *string)
         return NULL;
     }
     if (string) {
-        sha_update(new, buf.buf, buf.len);
+        if (buf.len >= HASHLIB_GIL_MINSIZE) {
+            Py_BEGIN_ALLOW_THREADS
+            sha_update(new, buf.buf, buf.len);
+            Py_END_ALLOW_THREADS
+        }
+        else {
+            sha_update(new, buf.buf, buf.len);
+        }
         PyBuffer_Release(&buf);
     }
 
@@ -809,19 +858,121 @@ _sha256_sha224_impl(PyModuleDef *module, PyObject *string)
         return NULL;
     }
     if (string) {
-        sha_update(new, buf.buf, buf.len);
+        if (buf.len >= HASHLIB_GIL_MINSIZE) {
+            Py_BEGIN_ALLOW_THREADS
+            sha_update(new, buf.buf, buf.len);
+            Py_END_ALLOW_THREADS
+        }
+        else {
+            sha_update(new, buf.buf, buf.len);
+        }
         PyBuffer_Release(&buf);
     }
 
     return (PyObject *)new;
 }
 
+static void
+sha_digest_buffer(SHAobject *sha_info, const unsigned char *buf, Py_ssize_t len,
+                  unsigned char *digest)
+{
+    unsigned char full[SHA_DIGESTSIZE];
+
+    sha_update(sha_info, (SHA_BYTE *)buf, len);
+    sha_final(full, sha_info);
+    memcpy(digest, full, sha_info->digestsize);
+}
+
+static void
+sha256_digest_buffer(const unsigned char *buf, Py_ssize_t len,
+                     unsigned char *digest)
+{
+    SHAobject sha_info;
+
+    sha_init(&sha_info);
+    sha_digest_buffer(&sha_info, buf, len, digest);
+}
+
+static void
+sha224_digest_buffer(const unsigned char *buf, Py_ssize_t len,
+                     unsigned char *digest)
+{
+    SHAobject sha_info;
+
+    sha224_init(&sha_info);
+    sha_digest_buffer(&sha_info, buf, len, digest);
+}
+
+/*[clinic input]
+_sha256.sha256_many
+
+    messages: object
+    /
+
+Return a list with the SHA-256 digest of each bytes-like object in messages.
+
+This is faster than creating a hash object per message when hashing many
+short messages; the GIL is released once for the whole batch.
+[clinic start generated code]*/
+
+PyDoc_STRVAR(_sha256_sha256_many__doc__,
+"sha256_many($module, messages, /)\n"
+"--\n"
+"\n"
+"Return a list with the SHA-256 digest of each bytes-like object in messages.\n"
+"\n"
+"This is faster than creating a hash object per message when hashing many\n"
+"short messages; the GIL is released once for the whole batch.");
+
+#define _SHA256_SHA256_MANY_METHODDEF    \
+    {"sha256_many", (PyCFunction)_sha256_sha256_many, METH_O, _sha256_sha256_many__doc__},
+
+static PyObject *
+_sha256_sha256_many(PyModuleDef *module, PyObject *messages)
+/*[clinic end generated code: output=4214bf97b8da1559 input=255c31f0eac7246d]*/
+{
+    return hashlib_digest_many(messages, 32, sha256_digest_buffer);
+}
+
+/*[clinic input]
+_sha256.sha224_many
+
+    messages: object
+    /
+
+Return a list with the SHA-224 digest of each bytes-like object in messages.
+
+This is faster than creating a hash object per message when hashing many
+short messages; the GIL is released once for the whole batch.
+[clinic start generated code]*/
+
+PyDoc_STRVAR(_sha256_sha224_many__doc__,
+"sha224_many($module, messages, /)\n"
+"--\n"
+"\n"
+"Return a list with the SHA-224 digest of each bytes-like object in messages.\n"
+"\n"
+"This is faster than creating a hash object per message when hashing many\n"
+"short messages; the GIL is released once for the whole batch.");
+
+#define _SHA256_SHA224_MANY_METHODDEF    \
+    {"sha224_many", (PyCFunction)_sha256_sha224_many, METH_O, _sha256_sha224_many__doc__},
+
+static PyObject *
+_sha256_sha224_many(PyModuleDef *module, PyObject *messages)
+/*[clinic end generated code: output=0167a9a43065e4a9 input=8f8e52fe8e187d9b]*/
+{
+    return hashlib_digest_many(messages, 28, sha224_digest_buffer);
+}
+
 
 /* List of functions exported by this module */
 
 static struct PyMethodDef SHA_functions[] = {
     _SHA256_SHA256_METHODDEF
+    _SHA256_SHA256_MANY_METHODDEF
     _SHA256_SHA224_METHODDEF
+    _SHA256_SHA224_MANY_METHODDEF
     {NULL,      NULL}            /* Sentinel */
 };
 
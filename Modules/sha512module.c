@@ -53,6 +53,9 @@ typedef struct {
     SHA_BYTE data[SHA_BLOCKSIZE];       /* SHA data buffer */
     int local;                          /* unprocessed amount in data */
     int digestsize;
+#ifdef WITH_THREAD
+    PyThread_type_lock lock;
+#endif
 } SHAobject;
 
 /* When run on a little-endian CPU we need to perform byte reversal on an
@@ -445,13 +448,23 @@ static PyTypeObject SHA512type;
 static SHAobject *
 newSHA384object(void)
 {
-    return (SHAobject *)PyObject_New(SHAobject, &SHA384type);
+    SHAobject *retval = (SHAobject *)PyObject_New(SHAobject, &SHA384type);
+#ifdef WITH_THREAD
+    if (retval != NULL)
+        retval->lock = NULL;
+#endif
+    return retval;
 }
 
 static SHAobject *
 newSHA512object(void)
 {
-    return (SHAobject *)PyObject_New(SHAobject, &SHA512type);
+    SHAobject *retval = (SHAobject *)PyObject_New(SHAobject, &SHA512type);
+#ifdef WITH_THREAD
+    if (retval != NULL)
+        retval->lock = NULL;
+#endif
+    return retval;
 }
 
 /* Internal methods for a hash object */
@@ -459,6 +472,12 @@ newSHA512object(void)
 static void
 SHA512_dealloc(PyObject *ptr)
 {
+#ifdef WITH_THREAD
+    SHAobject *self = (SHAobject *)ptr;
+
+    if (self->lock != NULL)
+        PyThread_free_lock(self->lock);
+#endif
     PyObject_Del(ptr);
 }
 
@@ -503,7 +522,9 @@ SHA512Type_copy_impl(SHAobject *self)
             return NULL;
     }
 
+    ENTER_HASHLIB(self);
     SHAcopy(self, newobj);
+    LEAVE_HASHLIB(self);
     return (PyObject *)newobj;
 }
 
@@ -538,7 +559,9 @@ SHA512Type_digest_impl(SHAobject *self)
     unsigned char digest[SHA_DIGESTSIZE];
     SHAobject temp;
 
+    ENTER_HASHLIB(self);
     SHAcopy(self, &temp);
+    LEAVE_HASHLIB(self);
     sha512_final(digest, &temp);
     return PyBytes_FromStringAndSize((const char *)digest, self->digestsize);
 }
@@ -578,7 +601,9 @@ SHA512Type_hexdigest_impl(SHAobject *self)
     int i, j;
 
     /* Get the raw (binary) digest value */
+    ENTER_HASHLIB(self);
     SHAcopy(self, &temp);
+    LEAVE_HASHLIB(self);
     sha512_final(digest, &temp);
 
     /* Create a new string */
@@ -627,7 +652,24 @@ SHA512Type_update(SHAobject *self, PyObject *obj)
 
     GET_BUFFER_VIEW_OR_ERROUT(obj, &buf);
 
+#ifdef WITH_THREAD
+    if (self->lock == NULL && buf.len >= HASHLIB_GIL_MINSIZE) {
+        self->lock = PyThread_allocate_lock();
+        /* fail? lock = NULL and we fail over to non-threaded code. */
+    }
+
+    if (self->lock != NULL) {
+        Py_BEGIN_ALLOW_THREADS
+        PyThread_acquire_lock(self->lock, 1);
+        sha512_update(self, buf.buf, buf.len);
+        PyThread_release_lock(self->lock);
+        Py_END_ALLOW_THREADS
+    } else {
+        sha512_update(self, buf.buf, buf.len);
+    }
+#else
     sha512_update(self, buf.buf, buf.len);
+#endif
 
     PyBuffer_Release(&buf);
     Py_INCREF(Py_None);
@@ -827,7 +869,14 @@ _sha512_sha512_impl(PyModuleDef *module, PyObject *string)
         return NULL;
     }
     if (string) {
-        sha512_update(new, buf.buf, buf.len);
+        if (buf.len >= HASHLIB_GIL_MINSIZE) {
+            Py_BEGIN_ALLOW_THREADS
+            sha512_update(new, buf.buf, buf.len);
+            Py_END_ALLOW_THREADS
+        }
+        else {
+            sha512_update(new, buf.buf, buf.len);
+        }
         PyBuffer_Release(&buf);
     }
 
@@ -896,13 +945,113 @@ _sha512_sha384_impl(PyModuleDef *module, PyObject *string)
         return NULL;
     }
     if (string) {
-        sha512_update(new, buf.buf, buf.len);
+        if (buf.len >= HASHLIB_GIL_MINSIZE) {
+            Py_BEGIN_ALLOW_THREADS
+            sha512_update(new, buf.buf, buf.len);
+            Py_END_ALLOW_THREADS
+        }
+        else {
+            sha512_update(new, buf.buf, buf.len);
+        }
         PyBuffer_Release(&buf);
     }
 
     return (PyObject *)new;
 }
 
+static void
+sha_digest_buffer(SHAobject *sha_info, const unsigned char *buf, Py_ssize_t len,
+                  unsigned char *digest)
+{
+    unsigned char full[SHA_DIGESTSIZE];
+
+    sha512_update(sha_info, (SHA_BYTE *)buf, len);
+    sha512_final(full, sha_info);
+    memcpy(digest, full, sha_info->digestsize);
+}
+
+static void
+sha512_digest_buffer(const unsigned char *buf, Py_ssize_t len,
+                     unsigned char *digest)
+{
+    SHAobject sha_info;
+
+    sha512_init(&sha_info);
+    sha_digest_buffer(&sha_info, buf, len, digest);
+}
+
+static void
+sha384_digest_buffer(const unsigned char *buf, Py_ssize_t len,
+                     unsigned char *digest)
+{
+    SHAobject sha_info;
+
+    sha384_init(&sha_info);
+    sha_digest_buffer(&sha_info, buf, len, digest);
+}
+
+/*[clinic input]
+_sha512.sha512_many
+
+    messages: object
+    /
+
+Return a list with the SHA-512 digest of each bytes-like object in messages.
+
+This is faster than creating a hash object per message when hashing many
+short messages; the GIL is released once for the whole batch.
+[clinic start generated code]*/
+
+PyDoc_STRVAR(_sha512_sha512_many__doc__,
+"sha512_many($module, messages, /)\n"
+"--\n"
+"\n"
+"Return a list with the SHA-512 digest of each bytes-like object in messages.\n"
+"\n"
+"This is faster than creating a hash object per message when hashing many\n"
+"short messages; the GIL is released once for the whole batch.");
+
+#define _SHA512_SHA512_MANY_METHODDEF    \
+    {"sha512_many", (PyCFunction)_sha512_sha512_many, METH_O, _sha512_sha512_many__doc__},
+
+static PyObject *
+_sha512_sha512_many(PyModuleDef *module, PyObject *messages)
+/*[clinic end generated code: output=f579ab3960eda3e3 input=2707fb19f79688aa]*/
+{
+    return hashlib_digest_many(messages, 64, sha512_digest_buffer);
+}
+
+/*[clinic input]
+_sha512.sha384_many
+
+    messages: object
+    /
+
+Return a list with the SHA-384 digest of each bytes-like object in messages.
+
+This is faster than creating a hash object per message when hashing many
+short messages; the GIL is released once for the whole batch.
+[clinic start generated code]*/
+
+PyDoc_STRVAR(_sha512_sha384_many__doc__,
+"sha384_many($module, messages, /)\n"
+"--\n"
+"\n"
+"Return a list with the SHA-384 digest of each bytes-like object in messages.\n"
+"\n"
+"This is faster than creating a hash object per message when hashing many\n"
+"short messages; the GIL is released once for the whole batch.");
+
+#define _SHA512_SHA384_MANY_METHODDEF    \
+    {"sha384_many", (PyCFunction)_sha512_sha384_many, METH_O, _sha512_sha384_many__doc__},
+
+static PyObject *
+_sha512_sha384_many(PyModuleDef *module, PyObject *messages)
+/*[clinic end generated code: output=5b818e62901b0e91 input=93ca0377f6696cb2]*/
+{
+    return hashlib_digest_many(messages, 48, sha384_digest_buffer);
+}
+
 
 /*[clinic input]
 dump buffer
@@ -915,13 +1064,23 @@ dump buffer
 #ifndef _SHA512_SHA384_METHODDEF
     #define _SHA512_SHA384_METHODDEF
 #endif /* !defined(_SHA512_SHA384_METHODDEF) */
-/*[clinic end generated code: output=69d84aa9445b01d8 input=524ce2e021e4eba6]*/
+
+#ifndef _SHA512_SHA512_MANY_METHODDEF
+    #define _SHA512_SHA512_MANY_METHODDEF
+#endif /* !defined(_SHA512_SHA512_MANY_METHODDEF) */
+
+#ifndef _SHA512_SHA384_MANY_METHODDEF
+    #define _SHA512_SHA384_MANY_METHODDEF
+#endif /* !defined(_SHA512_SHA384_MANY_METHODDEF) */
+/*[clinic end generated code: output=2da048c783c174a0 input=524ce2e021e4eba6]*/
 
 /* List of functions exported by this module */
 
 static struct PyMethodDef SHA_functions[] = {
     _SHA512_SHA512_METHODDEF
+    _SHA512_SHA512_MANY_METHODDEF
     _SHA512_SHA384_METHODDEF
+    _SHA512_SHA384_MANY_METHODDEF
     {NULL,      NULL}            /* Sentinel */
 };
 
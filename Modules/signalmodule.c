@@ -1620,6 +1620,21 @@ _PyOS_IsMainThread(void)
 #endif
 }
 
+/* Returns nonzero if PyErr_CheckSignals() has handlers to run in this
+   thread.  Can be called without holding the GIL, so that code running
+   without it knows when to take it back. */
+int
+_PyOS_SignalPending(void)
+{
+    if (!is_tripped)
+        return 0;
+#ifdef WITH_THREAD
+    if (PyThread_get_thread_ident() != main_thread)
+        return 0;
+#endif
+    return 1;
+}
+
 #ifdef MS_WINDOWS
 void *_PyOS_SigintEvent(void)
 {
@@ -24,6 +24,8 @@
 # define SRE_MAXGROUPS ((SRE_CODE)PY_SSIZE_T_MAX / SIZEOF_SIZE_T / 2)
 #endif
 
+struct SRE_NFA_T;
+
 typedef struct {
     PyObject_VAR_HEAD
     Py_ssize_t groups; /* must be first! */
@@ -34,6 +36,8 @@ typedef struct {
     int flags; /* flags used when compiling pattern source */
     PyObject *weakreflist; /* List of weak references */
     int isbytes; /* pattern type (1 - bytes, 0 - string, -1 - None) */
+    /* automaton for linear time matching (NULL if not supported) */
+    struct SRE_NFA_T* nfa;
     /* pattern code */
     Py_ssize_t codesize;
     SRE_CODE code[1];
@@ -85,12 +89,22 @@ typedef struct {
     SRE_REPEAT *repeat;
     /* hooks */
     SRE_TOLOWER_HOOK lower, upper;
+    /* automaton of the pattern being matched (or NULL) */
+    struct SRE_NFA_T* nfa;
+    /* the GIL can be released while matching (immutable string) */
+    int release_gil;
+    /* thread state while the GIL is released (or NULL) */
+    PyThreadState* tstate;
+    /* operations since the last check for signals */
+    unsigned int sigcount;
 } SRE_STATE;
 
 typedef struct {
     PyObject_HEAD
     PyObject* pattern;
     SRE_STATE state;
+    /* another thread can't use the state while this one matches */
+    int executing;
 } ScannerObject;
 
 #endif
@@ -12,6 +12,14 @@
 
 /* This file is included three times, with different character settings */
 
+#if defined(USE_FAST_SEARCH)
+#define STRINGLIB(F) SRE(F)
+#define STRINGLIB_CHAR SRE_CHAR
+#define STRINGLIB_SIZEOF_CHAR SIZEOF_SRE_CHAR
+#define FASTSEARCH SRE(fastsearch)
+#include "../Objects/stringlib/fastsearch.h"
+#endif
+
 LOCAL(int)
 SRE(at)(SRE_STATE* state, SRE_CHAR* ptr, SRE_CODE at)
 {
@@ -510,7 +518,6 @@ SRE(match)(SRE_STATE* state, SRE_CODE* pattern, int match_all)
     Py_ssize_t alloc_pos, ctx_pos = -1;
     Py_ssize_t i, ret = 0;
     Py_ssize_t jump;
-    unsigned int sigcount=0;
 
     SRE(match_context)* ctx;
     SRE(match_context)* nextctx;
@@ -541,9 +548,10 @@ entrance:
     }
 
     for (;;) {
-        ++sigcount;
-        if ((0 == (sigcount & 0xfff)) && PyErr_CheckSignals())
-            RETURN_ERROR(SRE_ERROR_INTERRUPTED);
+        ++state->sigcount;
+        if ((0 == (state->sigcount & 0xfff)) &&
+            (ret = sre_checkpoint(state)) < 0)
+            RETURN_ERROR(ret);
 
         switch (*ctx->pattern++) {
 
@@ -879,11 +887,9 @@ entrance:
                    ctx->pattern[1], ctx->pattern[2]));
 
             /* install new repeat context */
-            ctx->u.rep = (SRE_REPEAT*) PyObject_MALLOC(sizeof(*ctx->u.rep));
-            if (!ctx->u.rep) {
-                PyErr_NoMemory();
-                RETURN_FAILURE;
-            }
+            ctx->u.rep = (SRE_REPEAT*) PyMem_RawMalloc(sizeof(*ctx->u.rep));
+            if (!ctx->u.rep)
+                RETURN_ERROR(SRE_ERROR_MEMORY);
             ctx->u.rep->count = -1;
             ctx->u.rep->pattern = ctx->pattern;
             ctx->u.rep->prev = state->repeat;
@@ -893,7 +899,7 @@ entrance:
             state->ptr = ctx->ptr;
             DO_JUMP(JUMP_REPEAT, jump_repeat, ctx->pattern+ctx->pattern[0]);
             state->repeat = ctx->u.rep->prev;
-            PyObject_FREE(ctx->u.rep);
+            PyMem_RawFree(ctx->u.rep);
 
             if (ret) {
                 RETURN_ON_ERROR(ret);
@@ -1202,6 +1208,67 @@ exit:
     return ret; /* should never get here */
 }
 
+#if defined(USE_FAST_SEARCH)
+
+LOCAL(Py_ssize_t)
+SRE(required_literal)(SRE_CODE* required, SRE_CHAR* literal)
+{
+    /* copy the start of a required literal <length> <lo> <hi> <literal data>
+       to literal, which holds SRE_REQUIRED_MAX characters.  returns its
+       length, or -1 if the literal doesn't fit in the character width */
+
+    Py_ssize_t i, n = required[0];
+
+    if (n > SRE_REQUIRED_MAX)
+        n = SRE_REQUIRED_MAX;
+    for (i = 0; i < n; i++) {
+        literal[i] = (SRE_CHAR) required[3 + i];
+#if SIZEOF_SRE_CHAR < 4
+        if ((SRE_CODE) literal[i] != required[3 + i])
+            return -1;
+#endif
+    }
+    return n;
+}
+
+LOCAL(SRE_CHAR*)
+SRE(skip_required)(SRE_STATE* state, SRE_CHAR* ptr, SRE_CODE* required,
+                   SRE_CHAR* literal, Py_ssize_t n, SRE_CHAR** pfound)
+{
+    /* skip to the first position from ptr where a match can start, given
+       that it contains the literal between <lo> and <hi> characters after
+       its start.  *pfound is the occurrence of the literal found last,
+       reused as long as it is far enough.  returns NULL if there's none */
+
+    SRE_CHAR* end = (SRE_CHAR *)state->end;
+    SRE_CHAR* found = *pfound;
+    SRE_CODE lo = required[1];
+    SRE_CODE hi = required[2];
+    Py_ssize_t i, size;
+
+    if (found == NULL || found < ptr || (SRE_CODE) (found - ptr) < lo) {
+        if (end - ptr < n || (size_t) (end - ptr - n) < lo)
+            return NULL;
+        /* fastsearch may read the character after the end of the string,
+           which may be outside of a buffer, so the last position is
+           checked separately */
+        size = end - (ptr + lo) - 1;
+        i = SRE(fastsearch)(ptr + lo, size, literal, n, -1, FAST_SEARCH);
+        if (i >= 0)
+            found = ptr + lo + i;
+        else if (memcmp(end - n, literal, n * sizeof(SRE_CHAR)) == 0)
+            found = end - n;
+        else
+            return NULL;
+        *pfound = found;
+    }
+    if (hi != SRE_MAXREPEAT && (SRE_CODE) (found - ptr) > hi)
+        ptr = found - hi;
+    return ptr;
+}
+
+#endif
+
 LOCAL(Py_ssize_t)
 SRE(search)(SRE_STATE* state, SRE_CODE* pattern)
 {
@@ -1213,11 +1280,18 @@ SRE(search)(SRE_STATE* state, SRE_CODE* pattern)
     SRE_CODE* prefix = NULL;
     SRE_CODE* charset = NULL;
     SRE_CODE* overlap = NULL;
+    SRE_CODE* required = NULL;
+#if defined(USE_FAST_SEARCH)
+    SRE_CHAR literal[SRE_REQUIRED_MAX];
+    SRE_CHAR* found = NULL;
+    Py_ssize_t literal_len = 0;
+#endif
     int flags = 0;
 
     if (pattern[0] == SRE_OP_INFO) {
         /* optimization info block */
         /* <INFO> <1=skip> <2=flags> <3=min> <4=max> <5=prefix info>  */
+        SRE_CODE* info = pattern + 5;
 
         flags = pattern[2];
 
@@ -1229,17 +1303,24 @@ SRE(search)(SRE_STATE* state, SRE_CODE* pattern)
                 end = ptr;
         }
 
+        if (flags & SRE_INFO_REQUIRED) {
+            /* pattern contains a known literal */
+            /* <length> <lo> <hi> <literal data> */
+            required = info;
+            info += 3 + info[0];
+        }
+
         if (flags & SRE_INFO_PREFIX) {
             /* pattern starts with a known prefix */
             /* <length> <skip> <prefix data> <overlap data> */
-            prefix_len = pattern[5];
-            prefix_skip = pattern[6];
-            prefix = pattern + 7;
+            prefix_len = info[0];
+            prefix_skip = info[1];
+            prefix = info + 2;
             overlap = prefix + prefix_len - 1;
         } else if (flags & SRE_INFO_CHARSET)
             /* pattern starts with a character from a known set */
             /* <charset> */
-            charset = pattern + 5;
+            charset = info;
 
         pattern += 1 + pattern[1];
     }
@@ -1247,8 +1328,20 @@ SRE(search)(SRE_STATE* state, SRE_CODE* pattern)
     TRACE(("prefix = %p %" PY_FORMAT_SIZE_T "d %" PY_FORMAT_SIZE_T "d\n",
            prefix, prefix_len, prefix_skip));
     TRACE(("charset = %p\n", charset));
+    TRACE(("required = %p\n", required));
 
 #if defined(USE_FAST_SEARCH)
+    if (required) {
+        /* skip to the first place where the literal allows a match */
+        literal_len = SRE(required_literal)(required, literal);
+        if (literal_len < 0)
+            return 0; /* literal can't match: doesn't fit in char width */
+        ptr = SRE(skip_required)(state, ptr, required,
+                                 literal, literal_len, &found);
+        if (ptr == NULL)
+            return 0;
+    }
+
     if (prefix_len > 1) {
         /* pattern starts with a known prefix.  use the overlap
            table to skip forward as fast as we possibly can */
@@ -1321,6 +1414,14 @@ SRE(search)(SRE_STATE* state, SRE_CODE* pattern)
             status = SRE(match)(state, pattern + 2, 0);
             if (status != 0)
                 break;
+#if defined(USE_FAST_SEARCH)
+            if (required) {
+                ptr = SRE(skip_required)(state, ptr, required,
+                                         literal, literal_len, &found);
+                if (ptr == NULL)
+                    return 0;
+            }
+#endif
         }
     } else if (charset) {
         /* pattern starts with a character from a known set */
@@ -1337,6 +1438,14 @@ SRE(search)(SRE_STATE* state, SRE_CODE* pattern)
             if (status != 0)
                 break;
             ptr++;
+#if defined(USE_FAST_SEARCH)
+            if (required) {
+                ptr = SRE(skip_required)(state, ptr, required,
+                                         literal, literal_len, &found);
+                if (ptr == NULL)
+                    return 0;
+            }
+#endif
         }
     } else
         /* general case */
@@ -1346,11 +1455,305 @@ SRE(search)(SRE_STATE* state, SRE_CODE* pattern)
             status = SRE(match)(state, pattern, 0);
             if (status != 0)
                 break;
+#if defined(USE_FAST_SEARCH)
+            if (required) {
+                ptr = SRE(skip_required)(state, ptr, required,
+                                         literal, literal_len, &found);
+                if (ptr == NULL)
+                    return 0;
+            }
+#endif
         }
 
     return status;
 }
 
+/* linear time matching, see sre_dfa_step() */
+
+LOCAL(int)
+SRE(context_before)(SRE_STATE* state, SRE_CHAR* ptr)
+{
+    if ((void*) ptr == state->beginning)
+        return SRE_CTX_BEGIN;
+    return sre_nfa_context(state->nfa, ptr[-1]);
+}
+
+LOCAL(int)
+SRE(context_after)(SRE_STATE* state, SRE_CHAR* ptr)
+{
+    SRE_CHAR* end = (SRE_CHAR *)state->end;
+    int ctx;
+
+    if (ptr >= end)
+        return SRE_CTX_END;
+    ctx = sre_nfa_context(state->nfa, ptr[0]);
+    if (ptr + 1 == end && SRE_IS_LINEBREAK(ptr[0]))
+        ctx |= SRE_CTX_NEWLINE_END & state->nfa->ctxmask;
+    return ctx;
+}
+
+LOCAL(Py_ssize_t)
+SRE(dfa_forward)(SRE_STATE* state, SRE_DFA* dfa, int pc, SRE_CHAR** pend)
+{
+    /* run a DFA forward from state->start.  returns 1 and sets *pend to
+       where the NFA matched last, 0 if it did not match, or an error
+       code */
+
+    SRE_NFA* nfa = state->nfa;
+    SRE_CHAR* ptr = (SRE_CHAR *)state->start;
+    SRE_CHAR* end = (SRE_CHAR *)state->end;
+    SRE_CHAR* match = NULL;
+    SRE_CHAR* check;
+    SRE_DFA_STATE* s;
+    SRE_DFA_STATE* t;
+    SRE_CODE ch;
+    Py_ssize_t status;
+    int ctx, after;
+
+    s = sre_dfa_start(nfa, dfa, pc, SRE(context_before)(state, ptr));
+    if (!s)
+        return SRE_ERROR_MEMORY;
+
+    check = end - ptr > SRE_CHECK_INTERVAL ? ptr + SRE_CHECK_INTERVAL : end;
+    while (ptr < end) {
+        if (ptr == check) {
+            status = sre_checkpoint(state);
+            if (status < 0)
+                return status;
+            check = end - ptr > SRE_CHECK_INTERVAL ?
+                ptr + SRE_CHECK_INTERVAL : end;
+        }
+        ch = *ptr++;
+        if ((SIZEOF_SRE_CHAR == 1 || ch < 256) && ptr < end &&
+            (t = s->next[nfa->classes[ch]]) != NULL)
+            s = t;
+        else {
+            /* the position before the last character is told apart
+               by the position codes, so don't cache its transitions */
+            ctx = after = sre_nfa_context(nfa, ch);
+            if (ptr == end && SRE_IS_LINEBREAK(ch))
+                after |= SRE_CTX_NEWLINE_END & nfa->ctxmask;
+            s = sre_dfa_step(state, dfa, s, ch, s->flags, after, ctx,
+                             ch < 256 && ptr < end);
+            if (!s)
+                return SRE_ERROR_MEMORY;
+        }
+        if (s->flags & (SRE_DFA_MATCH | SRE_DFA_DEAD)) {
+            if (s->flags & SRE_DFA_MATCH)
+                match = ptr - 1;
+            if (s->flags & SRE_DFA_DEAD)
+                break;
+        }
+    }
+
+    if (!(s->flags & SRE_DFA_DEAD) &&
+        sre_dfa_accepts(nfa, dfa, s, s->flags, SRE_CTX_END))
+        match = end;
+
+    if (!match)
+        return 0;
+    *pend = match;
+    return 1;
+}
+
+LOCAL(Py_ssize_t)
+SRE(dfa_reverse)(SRE_STATE* state, SRE_CHAR* ptr, SRE_CHAR** pstart)
+{
+    /* run the reversed NFA backwards from ptr, where a match ends, to
+       find the leftmost position from state->start on where it can
+       start */
+
+    SRE_NFA* nfa = state->nfa;
+    SRE_DFA* dfa = &nfa->reverse;
+    SRE_CHAR* stop = (SRE_CHAR *)state->start;
+    SRE_CHAR* end = (SRE_CHAR *)state->end;
+    SRE_CHAR* match = NULL;
+    SRE_CHAR* check;
+    SRE_DFA_STATE* s;
+    SRE_DFA_STATE* t;
+    SRE_CODE ch;
+    Py_ssize_t status;
+    int ctx;
+
+    s = sre_dfa_start(nfa, dfa, nfa->rstart, SRE(context_after)(state, ptr));
+    if (!s)
+        return SRE_ERROR_MEMORY;
+
+    check = ptr - stop > SRE_CHECK_INTERVAL ? ptr - SRE_CHECK_INTERVAL : stop;
+    while (ptr > stop) {
+        if (ptr == check) {
+            status = sre_checkpoint(state);
+            if (status < 0)
+                return status;
+            check = ptr - stop > SRE_CHECK_INTERVAL ?
+                ptr - SRE_CHECK_INTERVAL : stop;
+        }
+        ch = *--ptr;
+        if ((SIZEOF_SRE_CHAR == 1 || ch < 256) && ptr + 1 < end &&
+            (t = s->next[nfa->classes[ch]]) != NULL)
+            s = t;
+        else {
+            ctx = sre_nfa_context(nfa, ch);
+            s = sre_dfa_step(state, dfa, s, ch, ctx, s->flags,
+                             ptr + 1 == end && SRE_IS_LINEBREAK(ch) ?
+                             ctx | (SRE_CTX_NEWLINE_END & nfa->ctxmask) : ctx,
+                             ch < 256 && ptr + 1 < end);
+            if (!s)
+                return SRE_ERROR_MEMORY;
+        }
+        if (s->flags & (SRE_DFA_MATCH | SRE_DFA_DEAD)) {
+            if (s->flags & SRE_DFA_MATCH)
+                match = ptr + 1;
+            if (s->flags & SRE_DFA_DEAD)
+                break;
+        }
+    }
+
+    if (!(s->flags & SRE_DFA_DEAD) &&
+        sre_dfa_accepts(nfa, dfa, s, SRE(context_before)(state, ptr),
+                        s->flags))
+        match = ptr;
+
+    if (!match)
+        return 0;
+    *pstart = match;
+    return 1;
+}
+
+LOCAL(Py_ssize_t)
+SRE(pike)(SRE_STATE* state, SRE_CHAR* ptr, SRE_CHAR* stop, int match_all)
+{
+    /* find the marks of the match known to span ptr..stop */
+
+    SRE_NFA* nfa = state->nfa;
+    SRE_PIKE_LIST* clist = &nfa->pike[0];
+    SRE_PIKE_LIST* nlist = &nfa->pike[1];
+    SRE_PIKE_LIST* tmp;
+    SRE_NFA_INST* inst;
+    Py_ssize_t ncaps = nfa->ncaps;
+    Py_ssize_t pos = ptr - (SRE_CHAR *)state->beginning;
+    Py_ssize_t i, status;
+    unsigned int gen = 0;
+    int before = 0, after = 0;
+
+    if (!sre_pike_alloc(nfa))
+        return SRE_ERROR_MEMORY;
+
+    for (i = 0; i < ncaps; i++)
+        nlist->caps[i] = -1;
+    clist->n = 0;
+    sre_pike_add(nfa, clist, nfa->start, nlist->caps, pos,
+                 SRE(context_before)(state, ptr),
+                 SRE(context_after)(state, ptr), sre_nfa_generation(nfa));
+
+    for (;;) {
+        if (ptr < stop) {
+            before = sre_nfa_context(nfa, ptr[0]);
+            after = SRE(context_after)(state, ptr + 1);
+            gen = sre_nfa_generation(nfa);
+        }
+        nlist->n = 0;
+        for (i = 0; i < clist->n; i++) {
+            inst = &nfa->prog[clist->pc[i]];
+            if (inst->kind == SRE_NFA_MATCH) {
+                if (ptr == stop) {
+                    sre_pike_result(state, clist->caps + i * ncaps);
+                    return 1;
+                }
+                if (!match_all)
+                    break; /* the remaining threads lost */
+            }
+            else if (ptr < stop && sre_nfa_char(state, inst, ptr[0]))
+                sre_pike_add(nfa, nlist, inst->out, clist->caps + i * ncaps,
+                             pos + 1, before, after, gen);
+        }
+        if (ptr >= stop || nlist->n == 0)
+            break;
+        tmp = clist;
+        clist = nlist;
+        nlist = tmp;
+        ptr++;
+        pos++;
+        if ((pos & (SRE_CHECK_INTERVAL - 1)) == 0) {
+            status = sre_checkpoint(state);
+            if (status < 0)
+                return status;
+        }
+    }
+
+    /* the DFA and the Pike VM disagree */
+    return SRE_ERROR_STATE;
+}
+
+LOCAL(Py_ssize_t)
+SRE(dfa_found)(SRE_STATE* state, SRE_CHAR* start, SRE_CHAR* end,
+               int match_all)
+{
+    state->start = start;
+    state->ptr = end;
+    if (state->nfa->ncaps > 1)
+        return SRE(pike)(state, start, end, match_all);
+    state->lastmark = -1;
+    state->lastindex = -1;
+    return 1;
+}
+
+LOCAL(Py_ssize_t)
+SRE(dfa_match)(SRE_STATE* state, int match_all)
+{
+    SRE_NFA* nfa = state->nfa;
+    SRE_CHAR* end;
+    Py_ssize_t status;
+
+    status = SRE(dfa_forward)(state, match_all ? &nfa->all : &nfa->first,
+                              nfa->start, &end);
+    if (status > 0 && match_all && end != (SRE_CHAR *)state->end)
+        status = 0;
+    if (status <= 0)
+        return status;
+    return SRE(dfa_found)(state, (SRE_CHAR *)state->start, end, match_all);
+}
+
+LOCAL(Py_ssize_t)
+SRE(dfa_search)(SRE_STATE* state, SRE_CODE* pattern)
+{
+    SRE_NFA* nfa = state->nfa;
+    SRE_CHAR* start;
+    SRE_CHAR* end;
+    Py_ssize_t status;
+
+#if defined(USE_FAST_SEARCH)
+    if (pattern[0] == SRE_OP_INFO && (pattern[2] & SRE_INFO_REQUIRED)) {
+        /* skip to the first place where the literal allows a match */
+        SRE_CHAR literal[SRE_REQUIRED_MAX];
+        SRE_CHAR* found = NULL;
+        Py_ssize_t n = SRE(required_literal)(pattern + 5, literal);
+        if (n < 0)
+            return 0;
+        start = SRE(skip_required)(state, (SRE_CHAR *)state->start,
+                                   pattern + 5, literal, n, &found);
+        if (start == NULL)
+            return 0;
+        state->start = start;
+    }
+#endif
+
+    status = SRE(dfa_forward)(state, &nfa->first, nfa->search, &end);
+    if (status <= 0)
+        return status;
+    status = SRE(dfa_reverse)(state, end, &start);
+    if (status <= 0)
+        return status ? status : SRE_ERROR_STATE;
+    return SRE(dfa_found)(state, start, end, 0);
+}
+
+#if defined(USE_FAST_SEARCH)
+#undef STRINGLIB
+#undef STRINGLIB_CHAR
+#undef STRINGLIB_SIZEOF_CHAR
+#undef FASTSEARCH
+#endif
+
 #undef SRE_CHAR
 #undef SIZEOF_SRE_CHAR
 #undef SRE
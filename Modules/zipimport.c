@@ -1178,6 +1178,30 @@ eq_mtime(time_t t1, time_t t2)
     return d <= 1;
 }
 
+/* Bits of the flags field of the pyc header */
+#define PYC_HASH_BASED      0x1
+#define PYC_CHECK_SOURCE    0x2
+#define PYC_FLAGS_MASK      (PYC_HASH_BASED | PYC_CHECK_SOURCE)
+
+/* Return 1 if the source of a hash-based pyc with the given flags should be
+   checked, according to the -X check_hash_based_pycs option. */
+static int
+check_hash_based_pyc(long flags)
+{
+    PyObject *xoptions, *mode;
+
+    xoptions = PySys_GetXOptions();
+    mode = xoptions ? PyDict_GetItemString(xoptions, "check_hash_based_pycs")
+                    : NULL;
+    if (mode != NULL && PyUnicode_Check(mode)) {
+        if (PyUnicode_CompareWithASCIIString(mode, "always") == 0)
+            return 1;
+        if (PyUnicode_CompareWithASCIIString(mode, "never") == 0)
+            return 0;
+    }
+    return (flags & PYC_CHECK_SOURCE) != 0;
+}
+
 /* Given the contents of a .py[co] file in a buffer, unmarshal the data
    and return the code object. Return None if it the magic word doesn't
    match (we do this instead of raising an exception as we fall back
@@ -1190,7 +1214,9 @@ unmarshal_code(PyObject *pathname, PyObject *data, time_t mtime)
     char *buf = PyBytes_AsString(data);
     Py_ssize_t size = PyBytes_Size(data);
 
-    if (size <= 9) {
+    long flags;
+
+    if (size < 16) {
         PyErr_SetString(ZipImportError,
                         "bad pyc data");
         return NULL;
@@ -1204,8 +1230,26 @@ unmarshal_code(PyObject *pathname, PyObject *data, time_t mtime)
         return Py_None;  /* signal caller to try alternative */
     }
 
-    if (mtime != 0 && !eq_mtime(get_long((unsigned char *)buf + 4),
-                                mtime)) {
+    flags = get_long((unsigned char *)buf + 4);
+    if (flags & ~PYC_FLAGS_MASK) {
+        PyErr_Format(ZipImportError,
+                     "invalid flags %ld in %R", flags, pathname);
+        return NULL;
+    }
+    if (flags & PYC_HASH_BASED) {
+        /* The source hash can't be verified here since the source has not
+           been read yet, so a checked hash-based pyc is only used when
+           there is no source to fall back to. */
+        if (mtime != 0 && check_hash_based_pyc(flags)) {
+            if (Py_VerboseFlag)
+                PySys_FormatStderr("# %R is a checked hash-based pyc\n",
+                                   pathname);
+            Py_INCREF(Py_None);
+            return Py_None;  /* signal caller to try alternative */
+        }
+    }
+    else if (mtime != 0 && !eq_mtime(get_long((unsigned char *)buf + 8),
+                                     mtime)) {
         if (Py_VerboseFlag)
             PySys_FormatStderr("# %R has bad mtime\n",
                                pathname);
@@ -1215,7 +1259,7 @@ unmarshal_code(PyObject *pathname, PyObject *data, time_t mtime)
 
     /* XXX the pyc's size field is ignored; timestamp collisions are probably
        unimportant with zip files. */
-    code = PyMarshal_ReadObjectFromString(buf + 12, size - 12);
+    code = PyMarshal_ReadObjectFromString(buf + 16, size - 16);
     if (code == NULL)
         return NULL;
     if (!PyCode_Check(code)) {
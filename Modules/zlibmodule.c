@@ -642,8 +642,9 @@ zlib_Compress_compress_impl(compobject *self, Py_buffer *data)
     return RetVal;
 }
 
-/* Helper for objdecompress() and unflush(). Saves any unconsumed input data in
-   self->unused_data or self->unconsumed_tail, as appropriate. */
+/* Helper for objdecompress(), decompress_into() and unflush(). Saves any
+   unconsumed input data in self->unused_data or self->unconsumed_tail, as
+   appropriate. */
 static int
 save_unconsumed_input(compobject *self, int err)
 {
@@ -685,6 +686,32 @@ save_unconsumed_input(compobject *self, int err)
     return 0;
 }
 
+/* Helper for objdecompress() and decompress_into(). Hands self->zdict to
+   inflate() once it has asked for a dictionary. */
+static int
+set_inflate_zdict(compobject *self)
+{
+    Py_buffer zdict_buf;
+    int err;
+
+    if (PyObject_GetBuffer(self->zdict, &zdict_buf, PyBUF_SIMPLE) == -1)
+        return -1;
+    if ((size_t)zdict_buf.len > UINT_MAX) {
+        PyErr_SetString(PyExc_OverflowError,
+                "zdict length does not fit in an unsigned int");
+        PyBuffer_Release(&zdict_buf);
+        return -1;
+    }
+    err = inflateSetDictionary(&(self->zst),
+                               zdict_buf.buf, (unsigned int)zdict_buf.len);
+    PyBuffer_Release(&zdict_buf);
+    if (err != Z_OK) {
+        zlib_error(self->zst, err, "while decompressing data");
+        return -1;
+    }
+    return 0;
+}
+
 /*[clinic input]
 zlib.Decompress.decompress
 
@@ -737,26 +764,7 @@ zlib_Decompress_decompress_impl(compobject *self, Py_buffer *data, unsigned int
     Py_END_ALLOW_THREADS
 
     if (err == Z_NEED_DICT && self->zdict != NULL) {
-        Py_buffer zdict_buf;
-        if (PyObject_GetBuffer(self->zdict, &zdict_buf, PyBUF_SIMPLE) == -1) {
-            Py_DECREF(RetVal);
-            RetVal = NULL;
-            goto error;
-        }
-
-        if ((size_t)zdict_buf.len > UINT_MAX) {
-            PyErr_SetString(PyExc_OverflowError,
-                    "zdict length does not fit in an unsigned int");
-            PyBuffer_Release(&zdict_buf);
-            Py_CLEAR(RetVal);
-            goto error;
-        }
-
-        err = inflateSetDictionary(&(self->zst),
-                                   zdict_buf.buf, (unsigned int)zdict_buf.len);
-        PyBuffer_Release(&zdict_buf);
-        if (err != Z_OK) {
-            zlib_error(self->zst, err, "while decompressing data");
+        if (set_inflate_zdict(self) < 0) {
             Py_CLEAR(RetVal);
             goto error;
         }
@@ -825,6 +833,89 @@ zlib_Decompress_decompress_impl(compobject *self, Py_buffer *data, unsigned int
     return RetVal;
 }
 
+/*[clinic input]
+zlib.Decompress.decompress_into
+
+    data: Py_buffer
+        The binary data to decompress.
+    buffer: Py_buffer(types='bytearray rwbuffer')
+        A writable bytes-like object receiving the decompressed data.
+        Once it is full, unconsumed input data will be stored in
+        the unconsumed_tail attribute.
+    /
+
+Decompress data into buffer and return the number of bytes written.
+
+No bytes object is created for the output.  When buffer has been filled,
+more output may be pending: call this method again with unconsumed_tail
+(which may be empty) to get it.
+[clinic start generated code]*/
+
+static PyObject *
+zlib_Decompress_decompress_into_impl(compobject *self, Py_buffer *data, Py_buffer *buffer)
+/*[clinic end generated code: output=9ec94245991f8c05 input=30f2699ea11f142a]*/
+{
+    int err;
+    size_t left;
+    PyObject *RetVal = NULL;
+
+    if ((size_t)data->len > UINT_MAX) {
+        PyErr_SetString(PyExc_OverflowError,
+                        "Size does not fit in an unsigned int");
+        return NULL;
+    }
+
+    ENTER_ZLIB(self);
+
+    self->zst.avail_in = (unsigned int)data->len;
+    self->zst.next_in = data->buf;
+    /* On a 64-bit system, the buffer might not fit in avail_out (an unsigned
+       int).  Fill it in chunks of no more than UINT_MAX bytes each. */
+    left = (size_t)buffer->len;
+    self->zst.avail_out = (unsigned int)Py_MIN(left, UINT_MAX);
+    left -= self->zst.avail_out;
+    self->zst.next_out = (unsigned char *)buffer->buf;
+
+    Py_BEGIN_ALLOW_THREADS
+    err = inflate(&(self->zst), Z_SYNC_FLUSH);
+    Py_END_ALLOW_THREADS
+
+    if (err == Z_NEED_DICT && self->zdict != NULL) {
+        if (set_inflate_zdict(self) < 0)
+            goto error;
+        /* Repeat the call to inflate. */
+        Py_BEGIN_ALLOW_THREADS
+        err = inflate(&(self->zst), Z_SYNC_FLUSH);
+        Py_END_ALLOW_THREADS
+    }
+
+    while (err == Z_OK && self->zst.avail_out == 0 && left > 0) {
+        self->zst.avail_out = (unsigned int)Py_MIN(left, UINT_MAX);
+        left -= self->zst.avail_out;
+
+        Py_BEGIN_ALLOW_THREADS
+        err = inflate(&(self->zst), Z_SYNC_FLUSH);
+        Py_END_ALLOW_THREADS
+    }
+
+    if (save_unconsumed_input(self, err) < 0)
+        goto error;
+
+    if (err == Z_STREAM_END) {
+        self->eof = 1;
+    } else if (err != Z_OK && err != Z_BUF_ERROR) {
+        zlib_error(self->zst, err, "while decompressing data");
+        goto error;
+    }
+
+    RetVal = PyLong_FromSsize_t(
+            (char *)self->zst.next_out - (char *)buffer->buf);
+
+ error:
+    LEAVE_ZLIB(self);
+    return RetVal;
+}
+
 /*[clinic input]
 zlib.Compress.flush
 
@@ -1153,6 +1244,7 @@ static PyMethodDef comp_methods[] =
 static PyMethodDef Decomp_methods[] =
 {
     ZLIB_DECOMPRESS_DECOMPRESS_METHODDEF
+    ZLIB_DECOMPRESS_DECOMPRESS_INTO_METHODDEF
     ZLIB_DECOMPRESS_FLUSH_METHODDEF
 #ifdef HAVE_ZLIB_COPY
     ZLIB_DECOMPRESS_COPY_METHODDEF
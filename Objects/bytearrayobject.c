@@ -1100,6 +1100,7 @@ bytearray_dealloc(PyByteArrayObject *self)
 #define STRINGLIB_CHECK_EXACT PyByteArray_CheckExact
 #define STRINGLIB_MUTABLE 1
 
+#include "stringlib/sse2.h"
 #include "stringlib/fastsearch.h"
 #include "stringlib/count.h"
 #include "stringlib/find.h"
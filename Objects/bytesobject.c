@@ -604,6 +604,7 @@ PyBytes_AsStringAndSize(PyObject *obj,
 /* Methods */
 
 #include "stringlib/stringdefs.h"
+#include "stringlib/sse2.h"
 
 #include "stringlib/fastsearch.h"
 #include "stringlib/count.h"
@@ -212,7 +212,6 @@ static PyMemberDef code_memberlist[] = {
     {"co_stacksize",T_INT,              OFF(co_stacksize),      READONLY},
     {"co_flags",        T_INT,          OFF(co_flags),          READONLY},
     {"co_code",         T_OBJECT,       OFF(co_code),           READONLY},
-    {"co_consts",       T_OBJECT,       OFF(co_consts),         READONLY},
     {"co_names",        T_OBJECT,       OFF(co_names),          READONLY},
     {"co_varnames",     T_OBJECT,       OFF(co_varnames),       READONLY},
     {"co_freevars",     T_OBJECT,       OFF(co_freevars),       READONLY},
@@ -224,6 +223,20 @@ static PyMemberDef code_memberlist[] = {
     {NULL}      /* Sentinel */
 };
 
+static PyObject *
+code_getconsts(PyCodeObject *co, void *closure)
+{
+    if (_PyCode_MaterializeConsts(co) < 0)
+        return NULL;
+    Py_INCREF(co->co_consts);
+    return co->co_consts;
+}
+
+static PyGetSetDef code_getsetlist[] = {
+    {"co_consts",       (getter)code_getconsts,         NULL, NULL},
+    {NULL}      /* Sentinel */
+};
+
 /* Helper for code_new: return a shallow copy of a tuple that is
    guaranteed to contain exact strings, by converting string subclasses
    to exact strings and complaining if a non-string is found. */
@@ -424,6 +437,9 @@ code_richcompare(PyObject *self, PyObject *other, int op)
 
     co = (PyCodeObject *)self;
     cp = (PyCodeObject *)other;
+    if (_PyCode_MaterializeConsts(co) < 0 ||
+        _PyCode_MaterializeConsts(cp) < 0)
+        return NULL;
 
     eq = PyObject_RichCompareBool(co->co_name, cp->co_name, Py_EQ);
     if (eq <= 0) goto unequal;
@@ -473,6 +489,8 @@ static Py_hash_t
 code_hash(PyCodeObject *co)
 {
     Py_hash_t h, h0, h1, h2, h3, h4, h5, h6;
+    if (_PyCode_MaterializeConsts(co) < 0)
+        return -1;
     h0 = PyObject_Hash(co->co_name);
     if (h0 == -1) return -1;
     h1 = PyObject_Hash(co->co_code);
@@ -531,7 +549,7 @@ PyTypeObject PyCode_Type = {
     0,                                  /* tp_iternext */
     code_methods,                       /* tp_methods */
     code_memberlist,                    /* tp_members */
-    0,                                  /* tp_getset */
+    code_getsetlist,                    /* tp_getset */
     0,                                  /* tp_base */
     0,                                  /* tp_dict */
     0,                                  /* tp_descr_get */
@@ -542,6 +560,234 @@ PyTypeObject PyCode_Type = {
     code_new,                           /* tp_new */
 };
 
+/* Stubs of lazily loaded code objects */
+
+PyObject *
+_PyLazyCode_New(int argcount, int kwonlyargcount,
+                int nlocals, int stacksize, int flags,
+                PyObject *varnames, PyObject *freevars, PyObject *cellvars,
+                PyObject *filename, PyObject *name, int firstlineno,
+                PyObject *owner, const char *body, Py_ssize_t size,
+                PyObject *const0)
+{
+    PyLazyCodeObject *lc;
+
+    if (argcount < 0 || kwonlyargcount < 0 || nlocals < 0 ||
+        varnames == NULL || !PyTuple_Check(varnames) ||
+        freevars == NULL || !PyTuple_Check(freevars) ||
+        cellvars == NULL || !PyTuple_Check(cellvars) ||
+        name == NULL || !PyUnicode_Check(name) ||
+        filename == NULL || !PyUnicode_Check(filename) ||
+        owner == NULL || body == NULL || size < 0) {
+        PyErr_BadInternalCall();
+        return NULL;
+    }
+
+    lc = PyObject_NEW(PyLazyCodeObject, &_PyLazyCode_Type);
+    if (lc == NULL)
+        return NULL;
+    lc->lc_argcount = argcount;
+    lc->lc_kwonlyargcount = kwonlyargcount;
+    lc->lc_nlocals = nlocals;
+    lc->lc_stacksize = stacksize;
+    lc->lc_flags = flags;
+    lc->lc_firstlineno = firstlineno;
+    Py_INCREF(varnames);
+    lc->lc_varnames = varnames;
+    Py_INCREF(freevars);
+    lc->lc_freevars = freevars;
+    Py_INCREF(cellvars);
+    lc->lc_cellvars = cellvars;
+    Py_INCREF(filename);
+    lc->lc_filename = filename;
+    Py_INCREF(name);
+    lc->lc_name = name;
+    Py_INCREF(owner);
+    lc->lc_owner = owner;
+    lc->lc_body = body;
+    lc->lc_size = size;
+    Py_XINCREF(const0);
+    lc->lc_const0 = const0;
+    Py_INCREF(filename);
+    lc->lc_body_filename = filename;
+    lc->lc_code = NULL;
+    return (PyObject *)lc;
+}
+
+/* The code objects nested in a materialized body still carry the file name
+   it was marshalled with; give them the one _imp._fix_co_filename() may
+   have set since. */
+static void
+update_filenames(PyObject *consts, PyObject *oldname, PyObject *newname)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < PyTuple_GET_SIZE(consts); i++) {
+        PyObject *v = PyTuple_GET_ITEM(consts, i);
+        PyObject **filename;
+        if (_PyLazyCode_Check(v))
+            filename = &((PyLazyCodeObject *)v)->lc_filename;
+        else if (PyCode_Check(v))
+            filename = &((PyCodeObject *)v)->co_filename;
+        else
+            continue;
+        if (*filename == newname || PyUnicode_Compare(*filename, oldname))
+            continue;
+        Py_INCREF(newname);
+        Py_DECREF(*filename);
+        *filename = newname;
+        if (PyCode_Check(v))
+            update_filenames(((PyCodeObject *)v)->co_consts,
+                             oldname, newname);
+    }
+}
+
+PyObject *
+_PyLazyCode_Materialize(PyObject *op)
+{
+    PyLazyCodeObject *lc = (PyLazyCodeObject *)op;
+    PyObject *owner, *const0, *body_filename;
+    PyObject *code = NULL, *consts = NULL, *names = NULL, *lnotab = NULL;
+    PyCodeObject *co;
+
+    if (!_PyLazyCode_Check(op) || lc->lc_code != NULL) {
+        if (_PyLazyCode_Check(op))
+            op = lc->lc_code;
+        Py_INCREF(op);
+        return op;
+    }
+
+    /* Unmarshalling may run arbitrary code through the garbage collector,
+       which could materialize lc first and release its body. */
+    Py_INCREF(lc);
+    owner = lc->lc_owner;
+    Py_INCREF(owner);
+    const0 = lc->lc_const0;
+    Py_XINCREF(const0);
+    body_filename = lc->lc_body_filename;
+    Py_INCREF(body_filename);
+    if (_PyMarshal_ReadCodeBody(lc->lc_body, lc->lc_size, const0,
+                                body_filename, owner,
+                                &code, &consts, &names, &lnotab) < 0)
+        goto done;
+    if (!PyTuple_Check(consts) || !PyTuple_Check(names) ||
+        !PyBytes_Check(lnotab) || !PyObject_CheckReadBuffer(code)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "bad marshal data (invalid code object body)");
+        goto done;
+    }
+    if (lc->lc_code == NULL) {
+        co = PyCode_New(lc->lc_argcount, lc->lc_kwonlyargcount,
+                        lc->lc_nlocals, lc->lc_stacksize, lc->lc_flags,
+                        code, consts, names, lc->lc_varnames,
+                        lc->lc_freevars, lc->lc_cellvars, lc->lc_filename,
+                        lc->lc_name, lc->lc_firstlineno, lnotab);
+        if (co == NULL)
+            goto done;
+        if (co->co_filename != body_filename)
+            update_filenames(co->co_consts, body_filename, co->co_filename);
+        lc->lc_code = (PyObject *)co;
+        /* The body is not needed anymore: release the data holding it */
+        Py_CLEAR(lc->lc_owner);
+        lc->lc_body = NULL;
+        lc->lc_size = 0;
+        Py_CLEAR(lc->lc_const0);
+        Py_CLEAR(lc->lc_body_filename);
+    }
+
+  done:
+    Py_XDECREF(code);
+    Py_XDECREF(consts);
+    Py_XDECREF(names);
+    Py_XDECREF(lnotab);
+    Py_DECREF(owner);
+    Py_XDECREF(const0);
+    Py_DECREF(body_filename);
+    op = lc->lc_code;
+    Py_XINCREF(op);
+    Py_DECREF(lc);
+    return op;
+}
+
+/* Replace the stub at index i of co->co_consts with its code object, and
+   return a borrowed reference to the constant (NULL on failure). */
+static PyObject *
+materialize_const(PyCodeObject *co, Py_ssize_t i)
+{
+    PyObject *v = PyTuple_GET_ITEM(co->co_consts, i);
+    PyObject *code;
+
+    if (!_PyLazyCode_Check(v))
+        return v;
+    code = _PyLazyCode_Materialize(v);
+    if (code == NULL)
+        return NULL;
+    /* Like the interning of string constants in PyCode_New(), this changes
+       the tuple in place: it belongs to co. */
+    v = PyTuple_GET_ITEM(co->co_consts, i);
+    PyTuple_SET_ITEM(co->co_consts, i, code);
+    Py_DECREF(v);
+    return code;
+}
+
+int
+_PyCode_MaterializeConsts(PyCodeObject *co)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < PyTuple_GET_SIZE(co->co_consts); i++) {
+        if (materialize_const(co, i) == NULL)
+            return -1;
+    }
+    return 0;
+}
+
+static void
+lazycode_dealloc(PyLazyCodeObject *lc)
+{
+    Py_XDECREF(lc->lc_varnames);
+    Py_XDECREF(lc->lc_freevars);
+    Py_XDECREF(lc->lc_cellvars);
+    Py_XDECREF(lc->lc_filename);
+    Py_XDECREF(lc->lc_name);
+    Py_XDECREF(lc->lc_owner);
+    Py_XDECREF(lc->lc_const0);
+    Py_XDECREF(lc->lc_body_filename);
+    Py_XDECREF(lc->lc_code);
+    PyObject_DEL(lc);
+}
+
+static PyObject *
+lazycode_repr(PyLazyCodeObject *lc)
+{
+    return PyUnicode_FromFormat("<lazy code object %U at %p, file \"%U\", "
+                                "line %d>", lc->lc_name, lc, lc->lc_filename,
+                                lc->lc_firstlineno);
+}
+
+PyTypeObject _PyLazyCode_Type = {
+    PyVarObject_HEAD_INIT(&PyType_Type, 0)
+    "lazy_code",
+    sizeof(PyLazyCodeObject),
+    0,
+    (destructor)lazycode_dealloc,       /* tp_dealloc */
+    0,                                  /* tp_print */
+    0,                                  /* tp_getattr */
+    0,                                  /* tp_setattr */
+    0,                                  /* tp_reserved */
+    (reprfunc)lazycode_repr,            /* tp_repr */
+    0,                                  /* tp_as_number */
+    0,                                  /* tp_as_sequence */
+    0,                                  /* tp_as_mapping */
+    0,                                  /* tp_hash */
+    0,                                  /* tp_call */
+    0,                                  /* tp_str */
+    PyObject_GenericGetAttr,            /* tp_getattro */
+    0,                                  /* tp_setattro */
+    0,                                  /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                 /* tp_flags */
+};
+
 /* Use co_lnotab to compute the line number from a bytecode index, addrq.  See
    lnotab_notes.txt for the details of the lnotab representation.
 */
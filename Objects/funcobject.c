@@ -18,12 +18,19 @@ PyFunction_NewWithQualName(PyObject *code, PyObject *globals, PyObject *qualname
             return NULL;
     }
 
+    /* MAKE_FUNCTION passes the stubs of lazily loaded code objects (see
+       Include/code.h): functions always get a complete code object. */
+    code = _PyLazyCode_Materialize(code);
+    if (code == NULL)
+        return NULL;
+
     op = PyObject_GC_New(PyFunctionObject, &PyFunction_Type);
-    if (op == NULL)
+    if (op == NULL) {
+        Py_DECREF(code);
         return NULL;
+    }
 
     op->func_weakreflist = NULL;
-    Py_INCREF(code);
     op->func_code = code;
     Py_INCREF(globals);
     op->func_globals = globals;
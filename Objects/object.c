@@ -1652,6 +1652,9 @@ _Py_ReadyTypes(void)
     if (PyType_Ready(&PyCode_Type) < 0)
         Py_FatalError("Can't initialize code type");
 
+    if (PyType_Ready(&_PyLazyCode_Type) < 0)
+        Py_FatalError("Can't initialize lazy code type");
+
     if (PyType_Ready(&PyFrame_Type) < 0)
         Py_FatalError("Can't initialize frame type");
 
@@ -15,6 +15,53 @@
 /* 10xxxxxx */
 #define IS_CONTINUATION_BYTE(ch) ((ch) >= 0x80 && (ch) < 0xC0)
 
+#ifdef HAVE_SSE2_INTRINSICS
+/* Decode the run of ASCII characters at the start of [start, end) to dest,
+   16 bytes at a time, and return its length.  Stop at the first non-ASCII
+   byte, or when less than 16 bytes are left. */
+Py_LOCAL_INLINE(Py_ssize_t)
+STRINGLIB(ascii_decode_sse2)(const char *start, const char *end,
+                             STRINGLIB_CHAR *dest)
+{
+    const char *s = start;
+    STRINGLIB_CHAR *p = dest;
+#if STRINGLIB_SIZEOF_CHAR > 1
+    const __m128i zero = _mm_setzero_si128();
+#endif
+
+    while (end - s >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *) s);
+        int mask = _mm_movemask_epi8(v);
+        if (mask) {
+            /* Copy the ASCII characters before the non-ASCII byte */
+            while (!(mask & 1)) {
+                *p++ = (unsigned char) *s++;
+                mask >>= 1;
+            }
+            break;
+        }
+#if STRINGLIB_SIZEOF_CHAR == 1
+        _mm_storeu_si128((__m128i *) p, v);
+#elif STRINGLIB_SIZEOF_CHAR == 2
+        _mm_storeu_si128((__m128i *) p, _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128((__m128i *) (p + 8), _mm_unpackhi_epi8(v, zero));
+#else
+        {
+            __m128i lo = _mm_unpacklo_epi8(v, zero);
+            __m128i hi = _mm_unpackhi_epi8(v, zero);
+            _mm_storeu_si128((__m128i *) p, _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128((__m128i *) (p + 4), _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128((__m128i *) (p + 8), _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128((__m128i *) (p + 12), _mm_unpackhi_epi16(hi, zero));
+        }
+#endif
+        s += 16;
+        p += 16;
+    }
+    return s - start;
+}
+#endif
+
 Py_LOCAL_INLINE(Py_UCS4)
 STRINGLIB(utf8_decode)(const char **inptr, const char *end,
                        STRINGLIB_CHAR *dest,
@@ -22,13 +69,27 @@ STRINGLIB(utf8_decode)(const char **inptr, const char *end,
 {
     Py_UCS4 ch;
     const char *s = *inptr;
+#ifndef HAVE_SSE2_INTRINSICS
     const char *aligned_end = (const char *) _Py_ALIGN_DOWN(end, SIZEOF_LONG);
+#endif
     STRINGLIB_CHAR *p = dest + *outpos;
 
     while (s < end) {
         ch = (unsigned char)*s;
 
         if (ch < 0x80) {
+#ifdef HAVE_SSE2_INTRINSICS
+            /* Fast path for runs of ASCII characters.  Unaligned loads are
+               cheap with SSE2, so there is no need to wait for an aligned
+               address: this also speeds up the short runs of ASCII
+               characters between non-ASCII ones. */
+            Py_ssize_t n = STRINGLIB(ascii_decode_sse2)(s, end, p);
+            s += n;
+            p += n;
+            if (s == end)
+                break;
+            ch = (unsigned char)*s;
+#else
             /* Fast path for runs of ASCII characters. Given that common UTF-8
                input will consist of an overwhelming majority of ASCII
                characters, we try to optimize for this case by checking
@@ -84,6 +145,7 @@ STRINGLIB(utf8_decode)(const char **inptr, const char *end,
                     break;
                 ch = (unsigned char)*s;
             }
+#endif
             if (ch < 0x80) {
                 s++;
                 *p++ = ch;
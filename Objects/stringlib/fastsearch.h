@@ -4,7 +4,12 @@
 
 /* fast search/count implementation, based on a mix between boyer-
    moore and horspool, with a few more bells and whistles on the top.
-   for some more background, see: http://effbot.org/zone/stringlib.htm */
+   for some more background, see: http://effbot.org/zone/stringlib.htm
+
+   searching for long needles in long haystacks uses the two-way
+   algorithm of crochemore and perrin instead, which runs in linear time
+   whatever the needle, and short needles in strings of bytes are
+   looked for 16 positions at a time with sse2 when it's available. */
 
 /* note: fastsearch may access s[n], which isn't a problem when using
    Python's ordinary string types, but may cause problems if you're
@@ -80,6 +85,306 @@ STRINGLIB(fastsearch_memchr_1char)(const STRINGLIB_CHAR* s, Py_ssize_t n,
 #undef DO_MEMCHR
 }
 
+#if defined(HAVE_SSE2_INTRINSICS) && STRINGLIB_SIZEOF_CHAR == 1
+
+/* Longest needle looked for with SSE2 */
+#define SSE2_MAX_NEEDLE 32
+
+/* Look for the needle by comparing its first and last characters with
+   those of 16 windows of the haystack at a time, and only comparing the
+   rest of the needle for the windows where both match.  Windows too close
+   to the end of the haystack for a 16-byte load are checked one by one. */
+Py_LOCAL_INLINE(Py_ssize_t)
+STRINGLIB(sse2_find)(const STRINGLIB_CHAR* s, Py_ssize_t n,
+                     const STRINGLIB_CHAR* p, Py_ssize_t m,
+                     Py_ssize_t maxcount, int mode)
+{
+    const __m128i first = _mm_set1_epi8((char) p[0]);
+    const __m128i last = _mm_set1_epi8((char) p[m - 1]);
+    Py_ssize_t i = 0, j, next, count = 0;
+
+    while (i + m + 15 <= n) {
+        __m128i vfirst = _mm_loadu_si128((const __m128i *) (s + i));
+        __m128i vlast = _mm_loadu_si128((const __m128i *) (s + i + m - 1));
+        int mask = _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(vfirst, first),
+                          _mm_cmpeq_epi8(vlast, last)));
+        next = i + 16;
+        for (j = i; mask; j++, mask >>= 1) {
+            if ((mask & 1) && memcmp(s + j + 1, p + 1, m - 2) == 0) {
+                /* got a match! */
+                if (mode != FAST_COUNT)
+                    return j;
+                count++;
+                if (count == maxcount)
+                    return maxcount;
+                /* matches can't overlap */
+                next = j + m;
+                break;
+            }
+        }
+        i = next;
+    }
+    for (; i + m <= n; i++) {
+        if (s[i] == p[0] && s[i + m - 1] == p[m - 1] &&
+            memcmp(s + i + 1, p + 1, m - 2) == 0) {
+            if (mode != FAST_COUNT)
+                return i;
+            count++;
+            if (count == maxcount)
+                return maxcount;
+            i = i + m - 1;
+        }
+    }
+    if (mode != FAST_COUNT)
+        return -1;
+    return count;
+}
+
+#endif
+
+/* The two-way algorithm splits the needle in two halves at a "critical
+   factorization", then compares the right half from left to right and
+   the left half from left to right, and shifts the window by the period of
+   the needle on a mismatch in the left half.  It never compares a haystack
+   character more than twice, see
+   http://www-igm.univ-mlv.fr/~lecroq/string/node26.html
+
+   The windows are first skipped with a compressed Boyer-Moore table of
+   their last character, which is what makes it fast in practice. */
+
+#define TWO_WAY_TABLE_SIZE 64
+#define TWO_WAY_TABLE_MASK (TWO_WAY_TABLE_SIZE - 1)
+#define TWO_WAY_MAX_SHIFT 255
+
+typedef struct {
+    const STRINGLIB_CHAR *needle;
+    Py_ssize_t len_needle;
+    Py_ssize_t cut;             /* length of the left half */
+    Py_ssize_t period;
+    Py_ssize_t gap;
+    int is_periodic;
+    unsigned char table[TWO_WAY_TABLE_SIZE];
+} STRINGLIB(two_way_state);
+
+/* Return the start of the maximal suffix of the needle, for the ordering
+   of characters or its reverse, and store the period of that suffix. */
+static Py_ssize_t
+STRINGLIB(_lex_search)(const STRINGLIB_CHAR *needle, Py_ssize_t len_needle,
+                       Py_ssize_t *return_period, int invert_alphabet)
+{
+    Py_ssize_t max_suffix = 0;
+    Py_ssize_t candidate = 1;
+    Py_ssize_t k = 0;
+    Py_ssize_t period = 1;
+
+    while (candidate + k < len_needle) {
+        STRINGLIB_CHAR a = needle[candidate + k];
+        STRINGLIB_CHAR b = needle[max_suffix + k];
+        if (invert_alphabet ? (b < a) : (a < b)) {
+            /* The suffix at candidate is smaller: the next k + 1
+               characters can't start a maximal suffix either. */
+            candidate += k + 1;
+            k = 0;
+            period = candidate - max_suffix;
+        }
+        else if (a == b) {
+            if (k + 1 != period) {
+                k++;
+            }
+            else {
+                /* Matched a whole period */
+                candidate += period;
+                k = 0;
+            }
+        }
+        else {
+            /* The suffix at candidate is larger */
+            max_suffix = candidate;
+            candidate++;
+            k = 0;
+            period = 1;
+        }
+    }
+    *return_period = period;
+    return max_suffix;
+}
+
+static void
+STRINGLIB(_two_way_init)(STRINGLIB(two_way_state) *st,
+                         const STRINGLIB_CHAR *needle, Py_ssize_t len_needle)
+{
+    Py_ssize_t cut1, period1, cut2, period2, i, not_found_shift;
+
+    st->needle = needle;
+    st->len_needle = len_needle;
+
+    /* The later of the two maximal suffixes gives a critical
+       factorization */
+    cut1 = STRINGLIB(_lex_search)(needle, len_needle, &period1, 0);
+    cut2 = STRINGLIB(_lex_search)(needle, len_needle, &period2, 1);
+    if (cut1 > cut2) {
+        st->cut = cut1;
+        st->period = period1;
+    }
+    else {
+        st->cut = cut2;
+        st->period = period2;
+    }
+    assert(st->period + st->cut <= len_needle);
+
+    st->is_periodic = (memcmp(needle, needle + st->period,
+                              st->cut * STRINGLIB_SIZEOF_CHAR) == 0);
+    if (st->is_periodic) {
+        assert(st->cut < st->period);
+        st->gap = 0;
+    }
+    else {
+        STRINGLIB_CHAR last;
+
+        /* A lower bound of the period */
+        st->period = Py_MAX(st->cut, len_needle - st->cut) + 1;
+        /* The distance between the last character and the previous one
+           which has the same entry in the table */
+        st->gap = len_needle;
+        last = needle[len_needle - 1] & TWO_WAY_TABLE_MASK;
+        for (i = len_needle - 2; i >= 0; i--) {
+            if ((needle[i] & TWO_WAY_TABLE_MASK) == last) {
+                st->gap = len_needle - 1 - i;
+                break;
+            }
+        }
+    }
+
+    not_found_shift = Py_MIN(len_needle, TWO_WAY_MAX_SHIFT);
+    for (i = 0; i < TWO_WAY_TABLE_SIZE; i++)
+        st->table[i] = (unsigned char) not_found_shift;
+    for (i = len_needle - not_found_shift; i < len_needle; i++)
+        st->table[needle[i] & TWO_WAY_TABLE_MASK] =
+            (unsigned char) (len_needle - 1 - i);
+}
+
+static Py_ssize_t
+STRINGLIB(_two_way)(const STRINGLIB_CHAR *haystack, Py_ssize_t len_haystack,
+                    STRINGLIB(two_way_state) *st)
+{
+    const Py_ssize_t len_needle = st->len_needle;
+    const Py_ssize_t cut = st->cut;
+    const STRINGLIB_CHAR *needle = st->needle;
+    const STRINGLIB_CHAR *window_last = haystack + len_needle - 1;
+    const STRINGLIB_CHAR *haystack_end = haystack + len_haystack;
+    const unsigned char *table = st->table;
+    const STRINGLIB_CHAR *window;
+    Py_ssize_t i, shift;
+
+    if (st->is_periodic) {
+        const Py_ssize_t period = st->period;
+        /* Length of the prefix of the window known to match after a
+           shift by the period */
+        Py_ssize_t memory = 0;
+
+      periodicwindowloop:
+        while (window_last < haystack_end) {
+            assert(memory == 0);
+            for (;;) {
+                shift = table[*window_last & TWO_WAY_TABLE_MASK];
+                window_last += shift;
+                if (shift == 0)
+                    break;
+                if (window_last >= haystack_end)
+                    return -1;
+            }
+          no_shift:
+            window = window_last - len_needle + 1;
+            for (i = Py_MAX(cut, memory); i < len_needle; i++) {
+                if (needle[i] != window[i]) {
+                    window_last += i - cut + 1;
+                    memory = 0;
+                    goto periodicwindowloop;
+                }
+            }
+            for (i = memory; i < cut; i++) {
+                if (needle[i] != window[i]) {
+                    window_last += period;
+                    memory = len_needle - period;
+                    if (window_last >= haystack_end)
+                        return -1;
+                    shift = table[*window_last & TWO_WAY_TABLE_MASK];
+                    if (shift) {
+                        /* The last character can't match: skip at least
+                           as far as a mismatch of the right half would */
+                        Py_ssize_t mem_jump = Py_MAX(cut, memory) - cut + 1;
+                        memory = 0;
+                        window_last += Py_MAX(shift, mem_jump);
+                        goto periodicwindowloop;
+                    }
+                    goto no_shift;
+                }
+            }
+            return window - haystack;
+        }
+    }
+    else {
+        const Py_ssize_t gap = st->gap;
+        const Py_ssize_t period = Py_MAX(gap, st->period);
+        const Py_ssize_t gap_jump_end = Py_MIN(len_needle, cut + gap);
+
+      windowloop:
+        while (window_last < haystack_end) {
+            for (;;) {
+                shift = table[*window_last & TWO_WAY_TABLE_MASK];
+                window_last += shift;
+                if (shift == 0)
+                    break;
+                if (window_last >= haystack_end)
+                    return -1;
+            }
+            window = window_last - len_needle + 1;
+            for (i = cut; i < gap_jump_end; i++) {
+                if (needle[i] != window[i]) {
+                    window_last += gap;
+                    goto windowloop;
+                }
+            }
+            for (i = gap_jump_end; i < len_needle; i++) {
+                if (needle[i] != window[i]) {
+                    window_last += i - cut + 1;
+                    goto windowloop;
+                }
+            }
+            for (i = 0; i < cut; i++) {
+                if (needle[i] != window[i]) {
+                    window_last += period;
+                    goto windowloop;
+                }
+            }
+            return window - haystack;
+        }
+    }
+    return -1;
+}
+
+static Py_ssize_t
+STRINGLIB(two_way_find)(const STRINGLIB_CHAR *s, Py_ssize_t n,
+                        const STRINGLIB_CHAR *p, Py_ssize_t m,
+                        Py_ssize_t maxcount, int mode)
+{
+    STRINGLIB(two_way_state) st;
+    Py_ssize_t pos, count = 0;
+
+    STRINGLIB(_two_way_init)(&st, p, m);
+    if (mode != FAST_COUNT)
+        return STRINGLIB(_two_way)(s, n, &st);
+    while ((pos = STRINGLIB(_two_way)(s, n, &st)) != -1) {
+        count++;
+        if (count == maxcount)
+            return maxcount;
+        s += pos + m;
+        n -= pos + m;
+    }
+    return count;
+}
+
 Py_LOCAL_INLINE(Py_ssize_t)
 FASTSEARCH(const STRINGLIB_CHAR* s, Py_ssize_t n,
            const STRINGLIB_CHAR* p, Py_ssize_t m,
@@ -144,6 +449,24 @@ FASTSEARCH(const STRINGLIB_CHAR* s, Py_ssize_t n,
     if (mode != FAST_RSEARCH) {
         const STRINGLIB_CHAR *ss = s + m - 1;
         const STRINGLIB_CHAR *pp = p + m - 1;
+        /* Number of characters compared without finding a match, and the
+           number after which the two-way algorithm takes over */
+        Py_ssize_t hits = 0, max_hits = PY_SSIZE_T_MAX;
+
+#if defined(HAVE_SSE2_INTRINSICS) && STRINGLIB_SIZEOF_CHAR == 1
+        if (m <= SSE2_MAX_NEEDLE)
+            return STRINGLIB(sse2_find)(s, n, p, m, maxcount, mode);
+#endif
+        if (n >= 2500 && m >= 6 && (m >= 100 || n >= 30000)) {
+            /* For large problems, the setup cost of the two-way
+               algorithm is negligible if the needle is short enough
+               compared to the haystack.  Otherwise, only switch to it
+               when too many characters have been compared, which may
+               be quadratic. */
+            if ((m >> 2) * 3 < (n >> 2))
+                return STRINGLIB(two_way_find)(s, n, p, m, maxcount, mode);
+            max_hits = m / 4;
+        }
 
         /* create compressed boyer-moore delta 1 table */
 
@@ -173,6 +496,14 @@ FASTSEARCH(const STRINGLIB_CHAR* s, Py_ssize_t n,
                     i = i + mlast;
                     continue;
                 }
+                hits += j + 1;
+                if (hits > max_hits && w - i > 2000) {
+                    Py_ssize_t res = STRINGLIB(two_way_find)(
+                        s + i, n - i, p, m, maxcount - count, mode);
+                    if (mode == FAST_COUNT)
+                        return count + res;
+                    return res == -1 ? -1 : i + res;
+                }
                 /* miss: check if next character is part of pattern */
                 if (!STRINGLIB_BLOOM(mask, ss[i+1]))
                     i = i + m;
@@ -18,6 +18,23 @@ Py_LOCAL_INLINE(Py_UCS4)
 STRINGLIB(find_max_char)(const STRINGLIB_CHAR *begin, const STRINGLIB_CHAR *end)
 {
     const unsigned char *p = (const unsigned char *) begin;
+#ifdef HAVE_SSE2_INTRINSICS
+    /* Check the high bits of 64 bytes at a time */
+    while (end - p >= 64) {
+        const __m128i *v = (const __m128i *) p;
+        __m128i bits = _mm_or_si128(
+            _mm_or_si128(_mm_loadu_si128(v), _mm_loadu_si128(v + 1)),
+            _mm_or_si128(_mm_loadu_si128(v + 2), _mm_loadu_si128(v + 3)));
+        if (_mm_movemask_epi8(bits))
+            return 255;
+        p += 64;
+    }
+    while (p < end) {
+        if (*p++ & 0x80)
+            return 255;
+    }
+    return 127;
+#else
     const unsigned char *aligned_end =
             (const unsigned char *) _Py_ALIGN_DOWN(end, SIZEOF_LONG);
 
@@ -39,6 +56,7 @@ STRINGLIB(find_max_char)(const STRINGLIB_CHAR *begin, const STRINGLIB_CHAR *end)
             return 255;
     }
     return 127;
+#endif
 }
 
 #undef ASCII_CHAR_MASK
@@ -54,6 +72,28 @@ STRINGLIB(find_max_char)(const STRINGLIB_CHAR *begin, const STRINGLIB_CHAR *end)
 #define MAX_CHAR_UCS2  0xffff
 #define MAX_CHAR_UCS4  0x10ffff
 
+#ifdef HAVE_SSE2_INTRINSICS
+/* Characters are ORed together by blocks of 64 bytes */
+#define BLOCK_CHARS (64 / STRINGLIB_SIZEOF_CHAR)
+
+Py_LOCAL_INLINE(STRINGLIB_CHAR)
+STRINGLIB(or_block)(const STRINGLIB_CHAR *p)
+{
+    const __m128i *v = (const __m128i *) p;
+    __m128i bits = _mm_or_si128(
+        _mm_or_si128(_mm_loadu_si128(v), _mm_loadu_si128(v + 1)),
+        _mm_or_si128(_mm_loadu_si128(v + 2), _mm_loadu_si128(v + 3)));
+    bits = _mm_or_si128(bits, _mm_srli_si128(bits, 8));
+    bits = _mm_or_si128(bits, _mm_srli_si128(bits, 4));
+#if STRINGLIB_SIZEOF_CHAR == 2
+    bits = _mm_or_si128(bits, _mm_srli_si128(bits, 2));
+#endif
+    return (STRINGLIB_CHAR) _mm_cvtsi128_si32(bits);
+}
+#else
+#define BLOCK_CHARS 4
+#endif
+
 Py_LOCAL_INLINE(Py_UCS4)
 STRINGLIB(find_max_char)(const STRINGLIB_CHAR *begin, const STRINGLIB_CHAR *end)
 {
@@ -69,13 +109,18 @@ STRINGLIB(find_max_char)(const STRINGLIB_CHAR *begin, const STRINGLIB_CHAR *end)
     Py_UCS4 mask;
     Py_ssize_t n = end - begin;
     const STRINGLIB_CHAR *p = begin;
-    const STRINGLIB_CHAR *unrolled_end = begin + _Py_SIZE_ROUND_DOWN(n, 4);
+    const STRINGLIB_CHAR *unrolled_end =
+        begin + _Py_SIZE_ROUND_DOWN(n, BLOCK_CHARS);
     Py_UCS4 max_char;
 
     max_char = MAX_CHAR_ASCII;
     mask = MASK_ASCII;
     while (p < unrolled_end) {
+#ifdef HAVE_SSE2_INTRINSICS
+        STRINGLIB_CHAR bits = STRINGLIB(or_block)(p);
+#else
         STRINGLIB_CHAR bits = p[0] | p[1] | p[2] | p[3];
+#endif
         if (bits & mask) {
             if (mask == mask_limit) {
                 /* Limit reached */
@@ -94,7 +139,7 @@ STRINGLIB(find_max_char)(const STRINGLIB_CHAR *begin, const STRINGLIB_CHAR *end)
             /* We check the new mask on the same chars in the next iteration */
             continue;
         }
-        p += 4;
+        p += BLOCK_CHARS;
     }
     while (p < end) {
         if (p[0] & mask) {
@@ -127,6 +172,7 @@ STRINGLIB(find_max_char)(const STRINGLIB_CHAR *begin, const STRINGLIB_CHAR *end)
 #undef MAX_CHAR_UCS1
 #undef MAX_CHAR_UCS2
 #undef MAX_CHAR_UCS4
+#undef BLOCK_CHARS
 
 #endif /* STRINGLIB_SIZEOF_CHAR == 1 */
 #endif /* STRINGLIB_IS_UNICODE */
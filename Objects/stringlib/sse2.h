@@ -0,0 +1,15 @@
+/* stringlib: SSE2 support */
+
+#ifndef STRINGLIB_SSE2_H
+#define STRINGLIB_SSE2_H
+
+/* SSE2 is part of the x86-64 instruction set, so the SSE2 code paths of
+   stringlib need no check of the CPU at runtime.  Other platforms use the
+   portable loops. */
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_SSE2_INTRINSICS
+#include <emmintrin.h>
+#endif
+
+#endif /* !STRINGLIB_SSE2_H */
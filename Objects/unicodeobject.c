@@ -43,6 +43,8 @@ OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include "ucnhash.h"
 #include "bytes_methods.h"
 
+#include "stringlib/sse2.h"
+
 #ifdef MS_WINDOWS
 #include <windows.h>
 #endif
@@ -162,6 +164,44 @@ extern "C" {
             *_to++ = (to_type) *_iter++;                \
     } while (0)
 
+/* Convert UCS1 characters to UCS2 or UCS4, 16 characters at a time when
+   SSE2 is available. */
+static void
+ucs1_to_ucs2(const Py_UCS1 *begin, const Py_UCS1 *end, Py_UCS2 *to)
+{
+#ifdef HAVE_SSE2_INTRINSICS
+    const __m128i zero = _mm_setzero_si128();
+    while (end - begin >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *) begin);
+        _mm_storeu_si128((__m128i *) to, _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128((__m128i *) (to + 8), _mm_unpackhi_epi8(v, zero));
+        begin += 16;
+        to += 16;
+    }
+#endif
+    _PyUnicode_CONVERT_BYTES(Py_UCS1, Py_UCS2, begin, end, to);
+}
+
+static void
+ucs1_to_ucs4(const Py_UCS1 *begin, const Py_UCS1 *end, Py_UCS4 *to)
+{
+#ifdef HAVE_SSE2_INTRINSICS
+    const __m128i zero = _mm_setzero_si128();
+    while (end - begin >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *) begin);
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_si128((__m128i *) to, _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128((__m128i *) (to + 4), _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128((__m128i *) (to + 8), _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128((__m128i *) (to + 12), _mm_unpackhi_epi16(hi, zero));
+        begin += 16;
+        to += 16;
+    }
+#endif
+    _PyUnicode_CONVERT_BYTES(Py_UCS1, Py_UCS4, begin, end, to);
+}
+
 /* This dictionary holds all interned unicode strings.  Note that references
    to strings in this dictionary are *not* counted in the string's ob_refcnt.
    When the interned string reaches a refcnt of 0 the string deallocation
@@ -1254,8 +1294,7 @@ _copy_characters(PyObject *to, Py_ssize_t to_start,
     else if (from_kind == PyUnicode_1BYTE_KIND
              && to_kind == PyUnicode_2BYTE_KIND)
     {
-        _PyUnicode_CONVERT_BYTES(
-            Py_UCS1, Py_UCS2,
+        ucs1_to_ucs2(
             PyUnicode_1BYTE_DATA(from) + from_start,
             PyUnicode_1BYTE_DATA(from) + from_start + how_many,
             PyUnicode_2BYTE_DATA(to) + to_start
@@ -1264,8 +1303,7 @@ _copy_characters(PyObject *to, Py_ssize_t to_start,
     else if (from_kind == PyUnicode_1BYTE_KIND
              && to_kind == PyUnicode_4BYTE_KIND)
     {
-        _PyUnicode_CONVERT_BYTES(
-            Py_UCS1, Py_UCS4,
+        ucs1_to_ucs4(
             PyUnicode_1BYTE_DATA(from) + from_start,
             PyUnicode_1BYTE_DATA(from) + from_start + how_many,
             PyUnicode_4BYTE_DATA(to) + to_start
@@ -2190,8 +2228,7 @@ _PyUnicode_AsKind(PyObject *s, unsigned int kind)
         if (!result)
             return PyErr_NoMemory();
         assert(skind == PyUnicode_1BYTE_KIND);
-        _PyUnicode_CONVERT_BYTES(
-            Py_UCS1, Py_UCS2,
+        ucs1_to_ucs2(
             PyUnicode_1BYTE_DATA(s),
             PyUnicode_1BYTE_DATA(s) + len,
             result);
@@ -2209,8 +2246,7 @@ _PyUnicode_AsKind(PyObject *s, unsigned int kind)
         }
         else {
             assert(skind == PyUnicode_1BYTE_KIND);
-            _PyUnicode_CONVERT_BYTES(
-                Py_UCS1, Py_UCS4,
+            ucs1_to_ucs4(
                 PyUnicode_1BYTE_DATA(s),
                 PyUnicode_1BYTE_DATA(s) + len,
                 result);
@@ -2260,7 +2296,7 @@ as_ucs4(PyObject *string, Py_UCS4 *target, Py_ssize_t targetsize,
     }
     if (kind == PyUnicode_1BYTE_KIND) {
         Py_UCS1 *start = (Py_UCS1 *) data;
-        _PyUnicode_CONVERT_BYTES(Py_UCS1, Py_UCS4, start, start + len, target);
+        ucs1_to_ucs4(start, start + len, target);
     }
     else if (kind == PyUnicode_2BYTE_KIND) {
         Py_UCS2 *start = (Py_UCS2 *) data;
@@ -4624,6 +4660,14 @@ static Py_ssize_t
 ascii_decode(const char *start, const char *end, Py_UCS1 *dest)
 {
     const char *p = start;
+#ifdef HAVE_SSE2_INTRINSICS
+    Py_UCS1 *q = dest + asciilib_ascii_decode_sse2(start, end, dest);
+
+    p += q - dest;
+    while (p < end && !((unsigned char)*p & 0x80))
+        *q++ = *p++;
+    return p - start;
+#else
     const char *aligned_end = (const char *) _Py_ALIGN_DOWN(end, SIZEOF_LONG);
 
     /*
@@ -4682,6 +4726,7 @@ ascii_decode(const char *start, const char *end, Py_UCS1 *dest)
     }
     memcpy(dest, start, p - start);
     return p - start;
+#endif
 }
 
 PyObject *
@@ -13474,17 +13519,15 @@ _PyUnicodeWriter_WriteASCIIString(_PyUnicodeWriter *writer,
     }
     case PyUnicode_2BYTE_KIND:
     {
-        _PyUnicode_CONVERT_BYTES(
-            Py_UCS1, Py_UCS2,
-            ascii, ascii + len,
+        ucs1_to_ucs2(
+            (const Py_UCS1 *)ascii, (const Py_UCS1 *)ascii + len,
             (Py_UCS2 *)writer->data + writer->pos);
         break;
     }
     case PyUnicode_4BYTE_KIND:
     {
-        _PyUnicode_CONVERT_BYTES(
-            Py_UCS1, Py_UCS4,
-            ascii, ascii + len,
+        ucs1_to_ucs4(
+            (const Py_UCS1 *)ascii, (const Py_UCS1 *)ascii + len,
             (Py_UCS4 *)writer->data + writer->pos);
         break;
     }
@@ -48,6 +48,7 @@ extern PyObject* PyInit__struct(void);
 extern PyObject* PyInit__datetime(void);
 extern PyObject* PyInit__functools(void);
 extern PyObject* PyInit__json(void);
+extern PyObject* PyInit__asyncio(void);
 extern PyObject* PyInit_zlib(void);
 
 extern PyObject* PyInit__multibytecodec(void);
@@ -126,6 +127,7 @@ struct _inittab _PyImport_Inittab[] = {
     {"_datetime", PyInit__datetime},
     {"_functools", PyInit__functools},
     {"_json", PyInit__json},
+    {"_asyncio", PyInit__asyncio},
 
     {"xxsubtype", PyInit_xxsubtype},
     {"zipimport", PyInit_zipimport},
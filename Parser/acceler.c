@@ -19,6 +19,7 @@
 /* Forward references */
 static void fixdfa(grammar *, dfa *);
 static void fixstate(grammar *, state *);
+static void fixlabels(grammar *);
 
 void
 PyGrammar_AddAccelerators(grammar *g)
@@ -28,6 +29,7 @@ PyGrammar_AddAccelerators(grammar *g)
     d = g->g_dfa;
     for (i = g->g_ndfas; --i >= 0; d++)
         fixdfa(g, d);
+    fixlabels(g);
     g->g_accel = 1;
 }
 
@@ -48,6 +50,11 @@ PyGrammar_RemoveAccelerators(grammar *g)
             s->s_accel = NULL;
         }
     }
+    PyObject_FREE(g->g_tokenlabel);
+    g->g_tokenlabel = NULL;
+    PyObject_FREE(g->g_keywords);
+    g->g_keywords = NULL;
+    g->g_nkeywords = 0;
 }
 
 static void
@@ -123,3 +130,43 @@ fixstate(grammar *g, state *s)
     }
     PyObject_FREE(accel);
 }
+
+/* Build the tables the parser uses to find the label of a token: the label
+   of each token type, indexed by type, and the labels of the keywords sorted
+   by name, for a binary search.  This replaces two linear searches through
+   all the labels of the grammar for every token. */
+
+static void
+fixlabels(grammar *g)
+{
+    label *l = g->g_ll.ll_label;
+    int nl = g->g_ll.ll_nlabels;
+    int i, j, k;
+
+    g->g_tokenlabel = (int *) PyObject_MALLOC(N_TOKENS * sizeof(int));
+    g->g_keywords = (int *) PyObject_MALLOC((nl + 1) * sizeof(int));
+    if (g->g_tokenlabel == NULL || g->g_keywords == NULL) {
+        fprintf(stderr, "no mem to add parser accelerators\n");
+        exit(1);
+    }
+    for (i = 0; i < N_TOKENS; i++)
+        g->g_tokenlabel[i] = -1;
+    g->g_nkeywords = 0;
+    for (i = 0; i < nl; i++) {
+        int type = l[i].lb_type;
+        if (type == NAME && l[i].lb_str != NULL) {
+            /* Insertion sort: there are only a few dozen keywords */
+            for (j = g->g_nkeywords; j > 0; j--) {
+                k = g->g_keywords[j-1];
+                if (strcmp(l[k].lb_str, l[i].lb_str) <= 0)
+                    break;
+                g->g_keywords[j] = k;
+            }
+            g->g_keywords[j] = i;
+            g->g_nkeywords++;
+        }
+        else if (l[i].lb_str == NULL && type >= 0 && type < N_TOKENS &&
+                 g->g_tokenlabel[type] == -1)
+            g->g_tokenlabel[type] = i;
+    }
+}
@@ -75,8 +75,9 @@ fancy_roundup(int n)
                fancy_roundup(n))
 
 
-int
-PyNode_AddChild(node *n1, int type, char *str, int lineno, int col_offset)
+static int
+add_child(node_arena *arena, node *n1, int type, char *str, int lineno,
+          int col_offset)
 {
     const int nch = n1->n_nchildren;
     int current_capacity;
@@ -95,8 +96,16 @@ PyNode_AddChild(node *n1, int type, char *str, int lineno, int col_offset)
             return E_NOMEM;
         }
         n = n1->n_child;
-        n = (node *) PyObject_REALLOC(n,
-                                      required_capacity * sizeof(node));
+        if (arena != NULL) {
+            /* The old array is left in the arena */
+            n = (node *) _PyNodeArena_Malloc(arena,
+                                             required_capacity * sizeof(node));
+            if (n != NULL && nch > 0)
+                memcpy(n, n1->n_child, nch * sizeof(node));
+        }
+        else
+            n = (node *) PyObject_REALLOC(n,
+                                          required_capacity * sizeof(node));
         if (n == NULL)
             return E_NOMEM;
         n1->n_child = n;
@@ -112,6 +121,106 @@ PyNode_AddChild(node *n1, int type, char *str, int lineno, int col_offset)
     return 0;
 }
 
+int
+PyNode_AddChild(node *n1, int type, char *str, int lineno, int col_offset)
+{
+    return add_child(NULL, n1, type, str, lineno, col_offset);
+}
+
+int
+_PyNode_AddChildInArena(node_arena *arena, node *n1, int type, char *str,
+                        int lineno, int col_offset)
+{
+    return add_child(arena, n1, type, str, lineno, col_offset);
+}
+
+node *
+_PyNode_NewInArena(node_arena *arena, int type)
+{
+    node *n = (node *) _PyNodeArena_Malloc(arena, sizeof(node));
+    if (n == NULL)
+        return NULL;
+    n->n_type = type;
+    n->n_str = NULL;
+    n->n_lineno = 0;
+    n->n_nchildren = 0;
+    n->n_child = NULL;
+    return n;
+}
+
+/* Node arenas are lists of blocks, carved up from the start.  Allocations
+   bigger than a quarter of a block, such as the child arrays of long
+   statement lists, get a block of their own. */
+
+#define NODE_ARENA_BLOCK_SIZE (32 * 1024)
+
+typedef struct _node_block {
+    struct _node_block *b_next;
+    size_t b_size;
+    size_t b_offset;
+    /* Force the alignment of the data which follows */
+    union { void *p; double d; long l; } b_data[1];
+} node_block;
+
+struct _node_arena {
+    node_block *a_head;         /* The block being carved up */
+};
+
+node_arena *
+_PyNodeArena_New(void)
+{
+    node_arena *arena = (node_arena *) PyObject_MALLOC(sizeof(node_arena));
+    if (arena == NULL)
+        return NULL;
+    arena->a_head = NULL;
+    return arena;
+}
+
+void
+_PyNodeArena_Free(node_arena *arena)
+{
+    node_block *b = arena->a_head;
+    while (b != NULL) {
+        node_block *next = b->b_next;
+        PyObject_FREE(b);
+        b = next;
+    }
+    PyObject_FREE(arena);
+}
+
+void *
+_PyNodeArena_Malloc(node_arena *arena, size_t size)
+{
+    node_block *b = arena->a_head;
+    void *p;
+
+    size = _Py_SIZE_ROUND_UP(size, sizeof(b->b_data[0]));
+    if (b == NULL || b->b_size - b->b_offset < size) {
+        size_t block_size = NODE_ARENA_BLOCK_SIZE;
+        if (size > NODE_ARENA_BLOCK_SIZE / 4)
+            block_size = size;
+        if (block_size > PY_SIZE_MAX - sizeof(node_block))
+            return NULL;
+        b = (node_block *) PyObject_MALLOC(sizeof(node_block) + block_size);
+        if (b == NULL)
+            return NULL;
+        b->b_size = block_size;
+        b->b_offset = 0;
+        if (block_size == size && arena->a_head != NULL) {
+            /* Keep carving up the current block */
+            b->b_next = arena->a_head->b_next;
+            arena->a_head->b_next = b;
+        }
+        else {
+            b->b_next = arena->a_head;
+            arena->a_head = b;
+        }
+    }
+    p = (char *) b->b_data + b->b_offset;
+    b->b_offset += size;
+    return p;
+}
+
 /* Forward */
 static void freechildren(node *);
 static Py_ssize_t sizeofchildren(node *n);
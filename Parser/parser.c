@@ -70,6 +70,13 @@ s_pop(stack *s)
 
 parser_state *
 PyParser_New(grammar *g, int start)
+{
+    return _PyParser_NewInArena(g, start, NULL);
+}
+
+/* Create a parser which builds its tree in ARENA, if it is not NULL. */
+parser_state *
+_PyParser_NewInArena(grammar *g, int start, node_arena *arena)
 {
     parser_state *ps;
 
@@ -82,7 +89,11 @@ PyParser_New(grammar *g, int start)
 #ifdef PY_PARSER_REQUIRES_FUTURE_KEYWORD
     ps->p_flags = 0;
 #endif
-    ps->p_tree = PyNode_New(start);
+    ps->p_arena = arena;
+    if (arena != NULL)
+        ps->p_tree = _PyNode_NewInArena(arena, start);
+    else
+        ps->p_tree = PyNode_New(start);
     if (ps->p_tree == NULL) {
         PyMem_FREE(ps);
         return NULL;
@@ -97,7 +108,8 @@ PyParser_Delete(parser_state *ps)
 {
     /* NB If you want to save the parse tree,
        you must set p_tree to NULL before calling delparser! */
-    PyNode_Free(ps->p_tree);
+    if (ps->p_arena == NULL)
+        PyNode_Free(ps->p_tree);
     PyMem_FREE(ps);
 }
 
@@ -105,11 +117,13 @@ PyParser_Delete(parser_state *ps)
 /* PARSER STACK OPERATIONS */
 
 static int
-shift(stack *s, int type, char *str, int newstate, int lineno, int col_offset)
+shift(stack *s, node_arena *arena, int type, char *str, int newstate,
+      int lineno, int col_offset)
 {
     int err;
     assert(!s_empty(s));
-    err = PyNode_AddChild(s->s_top->s_parent, type, str, lineno, col_offset);
+    err = _PyNode_AddChildInArena(arena, s->s_top->s_parent, type, str,
+                                  lineno, col_offset);
     if (err)
         return err;
     s->s_top->s_state = newstate;
@@ -117,13 +131,15 @@ shift(stack *s, int type, char *str, int newstate, int lineno, int col_offset)
 }
 
 static int
-push(stack *s, int type, dfa *d, int newstate, int lineno, int col_offset)
+push(stack *s, node_arena *arena, int type, dfa *d, int newstate, int lineno,
+     int col_offset)
 {
     int err;
     node *n;
     n = s->s_top->s_parent;
     assert(!s_empty(s));
-    err = PyNode_AddChild(n, type, (char *)NULL, lineno, col_offset);
+    err = _PyNode_AddChildInArena(arena, n, type, (char *)NULL, lineno,
+                                  col_offset);
     if (err)
         return err;
     s->s_top->s_state = newstate;
@@ -137,42 +153,40 @@ static int
 classify(parser_state *ps, int type, const char *str)
 {
     grammar *g = ps->p_grammar;
-    int n = g->g_ll.ll_nlabels;
 
     if (type == NAME) {
-        const char *s = str;
+        /* Binary search of the keywords, sorted by the accelerators */
         label *l = g->g_ll.ll_label;
-        int i;
-        for (i = n; i > 0; i--, l++) {
-            if (l->lb_type != NAME || l->lb_str == NULL ||
-                l->lb_str[0] != s[0] ||
-                strcmp(l->lb_str, s) != 0)
-                continue;
+        int lo = 0, hi = g->g_nkeywords;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            int ilabel = g->g_keywords[mid];
+            int cmp = strcmp(l[ilabel].lb_str, str);
+            if (cmp < 0)
+                lo = mid + 1;
+            else if (cmp > 0)
+                hi = mid;
+            else {
 #ifdef PY_PARSER_REQUIRES_FUTURE_KEYWORD
 #if 0
-            /* Leaving this in as an example */
-            if (!(ps->p_flags & CO_FUTURE_WITH_STATEMENT)) {
-                if (s[0] == 'w' && strcmp(s, "with") == 0)
-                    break; /* not a keyword yet */
-                else if (s[0] == 'a' && strcmp(s, "as") == 0)
-                    break; /* not a keyword yet */
-            }
+                /* Leaving this in as an example */
+                if (!(ps->p_flags & CO_FUTURE_WITH_STATEMENT)) {
+                    if (str[0] == 'w' && strcmp(str, "with") == 0)
+                        break; /* not a keyword yet */
+                    else if (str[0] == 'a' && strcmp(str, "as") == 0)
+                        break; /* not a keyword yet */
+                }
 #endif
 #endif
-            D(printf("It's a keyword\n"));
-            return n - i;
+                D(printf("It's a keyword\n"));
+                return ilabel;
+            }
         }
     }
 
-    {
-        label *l = g->g_ll.ll_label;
-        int i;
-        for (i = n; i > 0; i--, l++) {
-            if (l->lb_type == type && l->lb_str == NULL) {
-                D(printf("It's a token we know\n"));
-                return n - i;
-            }
-        }
+    if (type >= 0 && type < N_TOKENS && g->g_tokenlabel[type] != -1) {
+        D(printf("It's a token we know\n"));
+        return g->g_tokenlabel[type];
     }
 
     D(printf("Illegal token\n"));
@@ -257,7 +271,7 @@ PyParser_AddToken(parser_state *ps, int type, char *str,
                     int arrow = x & ((1<<7)-1);
                     dfa *d1 = PyGrammar_FindDFA(
                         ps->p_grammar, nt);
-                    if ((err = push(&ps->p_stack, nt, d1,
+                    if ((err = push(&ps->p_stack, ps->p_arena, nt, d1,
                         arrow, lineno, col_offset)) > 0) {
                         D(printf(" MemError: push\n"));
                         return err;
@@ -267,7 +281,7 @@ PyParser_AddToken(parser_state *ps, int type, char *str,
                 }
 
                 /* Shift the token */
-                if ((err = shift(&ps->p_stack, type, str,
+                if ((err = shift(&ps->p_stack, ps->p_arena, type, str,
                                 x, lineno, col_offset)) > 0) {
                     D(printf(" MemError: shift.\n"));
                     return err;
@@ -25,12 +25,14 @@ typedef struct {
 	stack	 	p_stack;	/* Stack of parser states */
 	grammar		*p_grammar;	/* Grammar to use */
 	node		*p_tree;	/* Top of parse tree */
+	node_arena	*p_arena;	/* Arena of the tree, or NULL */
 #ifdef PY_PARSER_REQUIRES_FUTURE_KEYWORD
 	unsigned long	p_flags;	/* see co_flags in Include/code.h */
 #endif
 } parser_state;
 
 parser_state *PyParser_New(grammar *g, int start);
+parser_state *_PyParser_NewInArena(grammar *g, int start, node_arena *arena);
 void PyParser_Delete(parser_state *ps);
 int PyParser_AddToken(parser_state *ps, int type, char *str, int lineno, int col_offset,
                       int *expected_ret);
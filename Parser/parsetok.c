@@ -12,7 +12,8 @@
 
 
 /* Forward */
-static node *parsetok(struct tok_state *, grammar *, int, perrdetail *, int *);
+static node *parsetok(struct tok_state *, grammar *, int, perrdetail *, int *,
+                      node_arena *);
 static int initerr(perrdetail *err_ret, PyObject * filename);
 
 /* Parse input coming from a string.  Return error code, print some errors. */
@@ -44,6 +45,18 @@ node *
 PyParser_ParseStringObject(const char *s, PyObject *filename,
                            grammar *g, int start,
                            perrdetail *err_ret, int *flags)
+{
+    return _PyParser_ParseStringObjectInArena(s, filename, g, start,
+                                              err_ret, flags, NULL);
+}
+
+/* Like PyParser_ParseStringObject(), but build the tree in ARENA if it is
+   not NULL.  The tree is then freed with the arena, not with PyNode_Free(). */
+node *
+_PyParser_ParseStringObjectInArena(const char *s, PyObject *filename,
+                                   grammar *g, int start,
+                                   perrdetail *err_ret, int *flags,
+                                   node_arena *arena)
 {
     struct tok_state *tok;
     int exec_input = start == file_input;
@@ -64,7 +77,7 @@ PyParser_ParseStringObject(const char *s, PyObject *filename,
     Py_INCREF(err_ret->filename);
     tok->filename = err_ret->filename;
 #endif
-    return parsetok(tok, g, start, err_ret, flags);
+    return parsetok(tok, g, start, err_ret, flags, arena);
 }
 
 node *
@@ -117,6 +130,17 @@ PyParser_ParseFileObject(FILE *fp, PyObject *filename,
                          const char *enc, grammar *g, int start,
                          const char *ps1, const char *ps2,
                          perrdetail *err_ret, int *flags)
+{
+    return _PyParser_ParseFileObjectInArena(fp, filename, enc, g, start,
+                                            ps1, ps2, err_ret, flags, NULL);
+}
+
+node *
+_PyParser_ParseFileObjectInArena(FILE *fp, PyObject *filename,
+                                 const char *enc, grammar *g, int start,
+                                 const char *ps1, const char *ps2,
+                                 perrdetail *err_ret, int *flags,
+                                 node_arena *arena)
 {
     struct tok_state *tok;
 
@@ -131,7 +155,7 @@ PyParser_ParseFileObject(FILE *fp, PyObject *filename,
     Py_INCREF(err_ret->filename);
     tok->filename = err_ret->filename;
 #endif
-    return parsetok(tok, g, start, err_ret, flags);
+    return parsetok(tok, g, start, err_ret, flags, arena);
 }
 
 node *
@@ -178,17 +202,18 @@ warn(const char *msg, const char *filename, int lineno)
 #endif
 
 /* Parse input coming from the given tokenizer structure.
-   Return error code. */
+   Return error code.  If ARENA is not NULL, the nodes and token strings
+   are allocated in it. */
 
 static node *
 parsetok(struct tok_state *tok, grammar *g, int start, perrdetail *err_ret,
-         int *flags)
+         int *flags, node_arena *arena)
 {
     parser_state *ps;
     node *n;
     int started = 0;
 
-    if ((ps = PyParser_New(g, start)) == NULL) {
+    if ((ps = _PyParser_NewInArena(g, start, arena)) == NULL) {
         err_ret->error = E_NOMEM;
         PyTokenizer_Free(tok);
         return NULL;
@@ -226,26 +251,31 @@ parsetok(struct tok_state *tok, grammar *g, int start, perrdetail *err_ret,
         else
             started = 1;
         len = b - a; /* XXX this may compute NULL - NULL */
-        str = (char *) PyObject_MALLOC(len + 1);
+        if (arena != NULL)
+            str = (char *) _PyNodeArena_Malloc(arena, len + 1);
+        else
+            str = (char *) PyObject_MALLOC(len + 1);
         if (str == NULL) {
             err_ret->error = E_NOMEM;
             break;
         }
         if (len > 0)
-            strncpy(str, a, len);
+            memcpy(str, a, len);
         str[len] = '\0';
 
 #ifdef PY_PARSER_REQUIRES_FUTURE_KEYWORD
         if (type == NOTEQUAL) {
             if (!(ps->p_flags & CO_FUTURE_BARRY_AS_BDFL) &&
                             strcmp(str, "!=")) {
-                PyObject_FREE(str);
+                if (arena == NULL)
+                    PyObject_FREE(str);
                 err_ret->error = E_SYNTAX;
                 break;
             }
             else if ((ps->p_flags & CO_FUTURE_BARRY_AS_BDFL) &&
                             strcmp(str, "<>")) {
-                PyObject_FREE(str);
+                if (arena == NULL)
+                    PyObject_FREE(str);
                 err_ret->text = "with Barry as BDFL, use '<>' "
                                 "instead of '!='";
                 err_ret->error = E_SYNTAX;
@@ -264,7 +294,8 @@ parsetok(struct tok_state *tok, grammar *g, int start, perrdetail *err_ret,
                                tok->lineno, col_offset,
                                &(err_ret->expected))) != E_OK) {
             if (err_ret->error != E_DONE) {
-                PyObject_FREE(str);
+                if (arena == NULL)
+                    PyObject_FREE(str);
                 err_ret->token = type;
             }
             break;
@@ -293,7 +324,8 @@ parsetok(struct tok_state *tok, grammar *g, int start, perrdetail *err_ret,
 
                 if (c != '#') {
                     err_ret->error = E_BADSINGLE;
-                    PyNode_Free(n);
+                    if (arena == NULL)
+                        PyNode_Free(n);
                     n = NULL;
                     break;
                 }
@@ -333,12 +365,21 @@ parsetok(struct tok_state *tok, grammar *g, int start, perrdetail *err_ret,
         /* 'nodes->n_str' uses PyObject_*, while 'tok->encoding' was
          * allocated using PyMem_
          */
-        node* r = PyNode_New(encoding_decl);
-        if (r)
-            r->n_str = PyObject_MALLOC(strlen(tok->encoding)+1);
+        size_t size = strlen(tok->encoding) + 1;
+        node* r;
+        if (arena != NULL) {
+            r = _PyNode_NewInArena(arena, encoding_decl);
+            if (r)
+                r->n_str = (char *) _PyNodeArena_Malloc(arena, size);
+        }
+        else {
+            r = PyNode_New(encoding_decl);
+            if (r)
+                r->n_str = PyObject_MALLOC(size);
+        }
         if (!r || !r->n_str) {
             err_ret->error = E_NOMEM;
-            if (r)
+            if (r && arena == NULL)
                 PyObject_FREE(r);
             n = NULL;
             goto done;
@@ -1,11 +1,14 @@
 /* This is built as a stand-alone executable by the Makefile, and helps turn
-   Lib/importlib/_bootstrap.py into a frozen module in Python/importlib.h
+   Lib/importlib/_bootstrap.py into a frozen module in Python/importlib.h,
+   and the modules imported at startup into Python/frozen_stdlib.h when
+   Python is configured --with-frozen-stdlib.
 */
 
 #include <Python.h>
 #include <marshal.h>
 
 #include <stdio.h>
+#include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #ifndef MS_WINDOWS
@@ -30,83 +33,77 @@ const struct _frozen *PyImport_FrozenModules;
 
 const char header[] = "/* Auto-generated by Programs/_freeze_importlib.c */";
 
-int
-main(int argc, char *argv[])
+static const char usage[] =
+    "usage: _freeze_importlib <input> <output>\n"
+    "       _freeze_importlib -m <libdir> <output> <input>...\n";
+
+/* Read a whole source file into a newly allocated, NUL-terminated buffer. */
+static char *
+read_text(const char *inpath)
 {
-    char *inpath, *outpath;
-    FILE *infile = NULL, *outfile = NULL;
+    FILE *infile;
     struct stat st;
-    size_t text_size, data_size, n;
-    char *text = NULL;
-    unsigned char *data;
-    PyObject *code = NULL, *marshalled = NULL;
+    size_t text_size, n;
+    char *text;
 
-    PyImport_FrozenModules = _PyImport_FrozenModules;
-
-    if (argc != 3) {
-        fprintf(stderr, "need to specify input and output paths\n");
-        return 2;
-    }
-    inpath = argv[1];
-    outpath = argv[2];
     infile = fopen(inpath, "rb");
     if (infile == NULL) {
         fprintf(stderr, "cannot open '%s' for reading\n", inpath);
-        goto error;
+        return NULL;
     }
     if (fstat(fileno(infile), &st)) {
         fprintf(stderr, "cannot fstat '%s'\n", inpath);
-        goto error;
+        fclose(infile);
+        return NULL;
     }
     text_size = st.st_size;
     text = (char *) malloc(text_size + 1);
     if (text == NULL) {
         fprintf(stderr, "could not allocate %ld bytes\n", (long) text_size);
-        goto error;
+        fclose(infile);
+        return NULL;
     }
     n = fread(text, 1, text_size, infile);
     fclose(infile);
-    infile = NULL;
     if (n < text_size) {
         fprintf(stderr, "read too short: got %ld instead of %ld bytes\n",
                 (long) n, (long) text_size);
-        goto error;
+        free(text);
+        return NULL;
     }
     text[text_size] = '\0';
+    return text;
+}
 
-    Py_NoUserSiteDirectory++;
-    Py_NoSiteFlag++;
-    Py_IgnoreEnvironmentFlag++;
-
-    Py_SetProgramName(L"./_freeze_importlib");
-    /* Don't install importlib, since it could execute outdated bytecode. */
-    _Py_InitializeEx_Private(1, 0);
+/* Compile a source file and return its marshalled code object. */
+static PyObject *
+compile_file(const char *inpath, const char *filename)
+{
+    char *text;
+    PyObject *code, *marshalled;
 
-    code = Py_CompileStringExFlags(text, "<frozen importlib._bootstrap>",
-                                   Py_file_input, NULL, 0);
-    if (code == NULL)
-        goto error;
+    text = read_text(inpath);
+    if (text == NULL)
+        return NULL;
+    code = Py_CompileStringExFlags(text, filename, Py_file_input, NULL, 0);
     free(text);
-    text = NULL;
+    if (code == NULL)
+        return NULL;
 
     marshalled = PyMarshal_WriteObjectToString(code, Py_MARSHAL_VERSION);
-    Py_CLEAR(code);
-    if (marshalled == NULL)
-        goto error;
+    Py_DECREF(code);
+    assert(marshalled == NULL || PyBytes_CheckExact(marshalled));
+    return marshalled;
+}
 
-    assert(PyBytes_CheckExact(marshalled));
-    data = (unsigned char *) PyBytes_AS_STRING(marshalled);
-    data_size = PyBytes_GET_SIZE(marshalled);
+static void
+write_array(FILE *outfile, const char *varname, PyObject *marshalled)
+{
+    unsigned char *data = (unsigned char *) PyBytes_AS_STRING(marshalled);
+    size_t data_size = PyBytes_GET_SIZE(marshalled);
+    size_t n;
 
-    /* Open the file in text mode. The hg checkout should be using the eol extension,
-       which in turn should cause the EOL style match the C library's text mode */
-    outfile = fopen(outpath, "w");
-    if (outfile == NULL) {
-        fprintf(stderr, "cannot open '%s' for writing\n", outpath);
-        goto error;
-    }
-    fprintf(outfile, "%s\n", header);
-    fprintf(outfile, "const unsigned char _Py_M__importlib[] = {\n");
+    fprintf(outfile, "const unsigned char %s[] = {\n", varname);
     for (n = 0; n < data_size; n += 16) {
         size_t i, end = Py_MIN(n + 16, data_size);
         fprintf(outfile, "    ");
@@ -116,29 +113,167 @@ main(int argc, char *argv[])
         fprintf(outfile, "\n");
     }
     fprintf(outfile, "};\n");
+}
 
-    Py_CLEAR(marshalled);
+/* A stdlib module frozen by the -m option */
+typedef struct {
+    char *name;
+    char *varname;
+    int is_package;
+    PyObject *marshalled;
+} frozen_module;
 
-    Py_Finalize();
-    if (outfile) {
-        if (ferror(outfile)) {
-            fprintf(stderr, "error when writing to '%s'\n", outpath);
+/* Compile the stdlib module whose source file is inpath.  Its name is
+   derived from the path of the source relative to libdir. */
+static int
+compile_module(frozen_module *mod, const char *libdir, const char *inpath)
+{
+    size_t libdir_len = strlen(libdir);
+    size_t len;
+    char *p, *filename;
+
+    if (strncmp(inpath, libdir, libdir_len) != 0 ||
+        inpath[libdir_len] != '/') {
+        fprintf(stderr, "'%s' is not in '%s'\n", inpath, libdir);
+        return -1;
+    }
+    len = strlen(inpath + libdir_len + 1);
+    if (len < 3 || strcmp(inpath + libdir_len + 1 + len - 3, ".py") != 0) {
+        fprintf(stderr, "'%s' is not a Python source file\n", inpath);
+        return -1;
+    }
+    mod->name = (char *) malloc(len + 1);
+    mod->varname = (char *) malloc(len + 8);
+    filename = (char *) malloc(len + 10);
+    if (mod->name == NULL || mod->varname == NULL || filename == NULL) {
+        fprintf(stderr, "out of memory\n");
+        free(filename);
+        return -1;
+    }
+
+    strcpy(mod->name, inpath + libdir_len + 1);
+    len -= 3;
+    mod->name[len] = '\0';
+    if (len > 9 && strcmp(mod->name + len - 9, "/__init__") == 0) {
+        mod->name[len - 9] = '\0';
+        mod->is_package = 1;
+    }
+    for (p = mod->name; *p; p++) {
+        if (*p == '/')
+            *p = '.';
+    }
+    sprintf(mod->varname, "_Py_M__%s", mod->name);
+    for (p = mod->varname; *p; p++) {
+        if (*p == '.')
+            *p = '_';
+    }
+
+    sprintf(filename, "<frozen %s>", mod->name);
+    mod->marshalled = compile_file(inpath, filename);
+    free(filename);
+    return mod->marshalled == NULL ? -1 : 0;
+}
+
+/* Write the frozen stdlib modules, followed by the _Py_FROZEN_STDLIB macro
+   which expands to their entries in the table of frozen modules. */
+static void
+write_stdlib(FILE *outfile, frozen_module *mods, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+        write_array(outfile, mods[i].varname, mods[i].marshalled);
+    fprintf(outfile, "\n#define _Py_FROZEN_STDLIB");
+    for (i = 0; i < count; i++) {
+        fprintf(outfile, " \\\n    {\"%s\", %s, %s(int)sizeof(%s)},",
+                mods[i].name, mods[i].varname,
+                mods[i].is_package ? "-" : "", mods[i].varname);
+    }
+    fprintf(outfile, "\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+    char *outpath;
+    FILE *outfile = NULL;
+    PyObject *marshalled = NULL;
+    frozen_module *mods = NULL;
+    int i, count = 0, status = 1;
+
+    PyImport_FrozenModules = _PyImport_FrozenModules;
+
+    if (argc >= 4 && strcmp(argv[1], "-m") == 0) {
+        count = argc - 4;
+        outpath = argv[3];
+    }
+    else if (argc == 3)
+        outpath = argv[2];
+    else {
+        fprintf(stderr, "%s", usage);
+        return 2;
+    }
+
+    Py_NoUserSiteDirectory++;
+    Py_NoSiteFlag++;
+    Py_IgnoreEnvironmentFlag++;
+
+    Py_SetProgramName(L"./_freeze_importlib");
+    /* Don't install importlib, since it could execute outdated bytecode. */
+    _Py_InitializeEx_Private(1, 0);
+
+    if (count) {
+        mods = (frozen_module *) calloc(count, sizeof(frozen_module));
+        if (mods == NULL) {
+            fprintf(stderr, "out of memory\n");
             goto error;
         }
-        fclose(outfile);
+        for (i = 0; i < count; i++) {
+            if (compile_module(&mods[i], argv[2], argv[4 + i]) < 0)
+                goto error;
+        }
+    }
+    else {
+        marshalled = compile_file(argv[1], "<frozen importlib._bootstrap>");
+        if (marshalled == NULL)
+            goto error;
     }
-    return 0;
+
+    /* Open the file in text mode. The hg checkout should be using the eol extension,
+       which in turn should cause the EOL style match the C library's text mode */
+    outfile = fopen(outpath, "w");
+    if (outfile == NULL) {
+        fprintf(stderr, "cannot open '%s' for writing\n", outpath);
+        goto error;
+    }
+    fprintf(outfile, "%s\n", header);
+    if (count)
+        write_stdlib(outfile, mods, count);
+    else
+        write_array(outfile, "_Py_M__importlib", marshalled);
+
+    if (ferror(outfile)) {
+        fprintf(stderr, "error when writing to '%s'\n", outpath);
+        goto error;
+    }
+    fclose(outfile);
+    outfile = NULL;
+    status = 0;
 
 error:
-    PyErr_Print();
+    if (status != 0)
+        PyErr_Print();
+    Py_XDECREF(marshalled);
+    if (mods != NULL) {
+        for (i = 0; i < count; i++) {
+            free(mods[i].name);
+            free(mods[i].varname);
+            Py_XDECREF(mods[i].marshalled);
+        }
+        free(mods);
+    }
     Py_Finalize();
-    if (infile)
-        fclose(infile);
     if (outfile)
         fclose(outfile);
-    if (text)
-        free(text);
-    if (marshalled)
-        Py_DECREF(marshalled);
-    return 1;
+    return status;
 }
@@ -320,4 +320,40 @@ exit:
 #ifndef _IMP_LOAD_DYNAMIC_METHODDEF
     #define _IMP_LOAD_DYNAMIC_METHODDEF
 #endif /* !defined(_IMP_LOAD_DYNAMIC_METHODDEF) */
-/*[clinic end generated code: output=087a1f22e9febcc7 input=a9049054013a1b77]*/
+
+PyDoc_STRVAR(_imp_source_hash__doc__,
+"source_hash($module, key, source, /)\n"
+"--\n"
+"\n"
+"Return the keyed hash of source as stored in hash-based bytecode files.\n"
+"\n"
+"The hash is the 8 bytes of the SipHash-2-4 of source, keyed with key, in\n"
+"little-endian order.");
+
+#define _IMP_SOURCE_HASH_METHODDEF    \
+    {"source_hash", (PyCFunction)_imp_source_hash, METH_VARARGS, _imp_source_hash__doc__},
+
+static PyObject *
+_imp_source_hash_impl(PyModuleDef *module, long key, Py_buffer *source);
+
+static PyObject *
+_imp_source_hash(PyModuleDef *module, PyObject *args)
+{
+    PyObject *return_value = NULL;
+    long key;
+    Py_buffer source = {NULL, NULL};
+
+    if (!PyArg_ParseTuple(args,
+        "ly*:source_hash",
+        &key, &source))
+        goto exit;
+    return_value = _imp_source_hash_impl(module, key, &source);
+
+exit:
+    /* Cleanup for source */
+    if (source.obj)
+       PyBuffer_Release(&source);
+
+    return return_value;
+}
+/*[clinic end generated code: output=9e9d9ab51b271c95 input=a9049054013a1b77]*/
@@ -874,6 +874,16 @@ update_code_filenames(PyCodeObject *co, PyObject *oldname, PyObject *newname)
         if (PyCode_Check(tmp))
             update_code_filenames((PyCodeObject *)tmp,
                                   oldname, newname);
+        else if (_PyLazyCode_Check(tmp)) {
+            /* The code objects nested in it get the new name when it is
+               materialized */
+            PyLazyCodeObject *lc = (PyLazyCodeObject *)tmp;
+            if (PyUnicode_Compare(lc->lc_filename, oldname))
+                continue;
+            Py_INCREF(newname);
+            Py_DECREF(lc->lc_filename);
+            lc->lc_filename = newname;
+        }
     }
 }
 
@@ -1095,7 +1105,10 @@ get_frozen_object(PyObject *name)
     size = p->size;
     if (size < 0)
         size = -size;
-    return PyMarshal_ReadObjectFromString((const char *)p->code, size);
+    /* Frozen modules are static: nested code objects can be left in the
+       table until they are needed. */
+    return _PyMarshal_ReadLazyObjectFromString((const char *)p->code, size,
+                                               1);
 }
 
 static PyObject *
@@ -1147,7 +1160,7 @@ PyImport_ImportFrozenModuleObject(PyObject *name)
     ispackage = (size < 0);
     if (ispackage)
         size = -size;
-    co = PyMarshal_ReadObjectFromString((const char *)p->code, size);
+    co = _PyMarshal_ReadLazyObjectFromString((const char *)p->code, size, 1);
     if (co == NULL)
         return -1;
     if (!PyCode_Check(co)) {
@@ -1961,6 +1974,35 @@ _imp_load_dynamic_impl(PyModuleDef *module, PyObject *name, PyObject *path, PyOb
 
 #endif /* HAVE_DYNAMIC_LOADING */
 
+/*[clinic input]
+_imp.source_hash
+
+    key: long
+    source: Py_buffer
+    /
+
+Return the keyed hash of source as stored in hash-based bytecode files.
+
+The hash is the 8 bytes of the SipHash-2-4 of source, keyed with key, in
+little-endian order.
+[clinic start generated code]*/
+
+static PyObject *
+_imp_source_hash_impl(PyModuleDef *module, long key, Py_buffer *source)
+/*[clinic end generated code: output=601d05a6959c862c input=1b2dce133513cc9f]*/
+{
+    PY_UINT64_T hash = _Py_KeyedHash((PY_UINT64_T)key,
+                                     source->buf, source->len);
+    unsigned char bytes[8];
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        bytes[i] = (unsigned char)(hash & 0xff);
+        hash >>= 8;
+    }
+    return PyBytes_FromStringAndSize((char *)bytes, 8);
+}
+
 /*[clinic input]
 dump buffer
 [clinic start generated code]*/
@@ -1983,6 +2025,7 @@ static PyMethodDef imp_methods[] = {
     _IMP_IS_FROZEN_METHODDEF
     _IMP_LOAD_DYNAMIC_METHODDEF
     _IMP__FIX_CO_FILENAME_METHODDEF
+    _IMP_SOURCE_HASH_METHODDEF
     {NULL, NULL}  /* sentinel */
 };
 
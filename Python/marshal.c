@@ -4,7 +4,8 @@
    even though dicts, lists, sets and frozensets, not commonly seen in
    code objects, are supported.
    Version 3 of this protocol properly supports circular links
-   and sharing. */
+   and sharing.  Version 5 writes the body of nested code objects
+   separately so that it can be unmarshalled on first use. */
 
 #define PY_SSIZE_T_CLEAN
 
@@ -12,6 +13,7 @@
 #include "longintrepr.h"
 #include "code.h"
 #include "marshal.h"
+#include "opcode.h"
 
 /* High water mark to determine when the marshalled object is dangerously deep
  * and risks coring the interpreter.  When the object stack gets this deep,
@@ -54,6 +56,7 @@
 #define TYPE_SMALL_TUPLE        ')'
 #define TYPE_SHORT_ASCII        'z'
 #define TYPE_SHORT_ASCII_INTERNED 'Z'
+#define TYPE_LAZY_CODE          'C'
 
 #define WFERR_OK 0
 #define WFERR_UNMARSHALLABLE 1
@@ -74,8 +77,15 @@ typedef struct {
     Py_ssize_t buf_size;
     PyObject *refs; /* dict on marshal, list on unmarshal */
     int version;
+    /* On unmarshal, if not LAZY_OFF, the bodies of TYPE_LAZY_CODE objects
+       are only read on first use. */
+    int lazy;
 } WFILE;
 
+#define LAZY_OFF        0
+#define LAZY_COPY       1   /* copy each body to a bytes object of its own */
+#define LAZY_STATIC     2   /* static data: refer to the bodies in place */
+
 #define w_byte(c, p) if (((p)->fp)) putc((c), (p)->fp); \
                       else if ((p)->ptr != (p)->end) *(p)->ptr++ = (c); \
                            else w_more((c), p)
@@ -308,6 +318,59 @@ w_object(PyObject *v, WFILE *p)
     p->depth--;
 }
 
+/* Write the body of a code object to a new string with its own reference
+   table, so that it can be unmarshalled independently of the data around
+   it.  consts[0] is written beforehand, since functions need it for their
+   docstring. */
+static PyObject *
+w_code_body(PyCodeObject *co, WFILE *p)
+{
+    WFILE wf;
+    PyObject *consts;
+    char *base;
+
+    consts = PyTuple_GetSlice(co->co_consts, 1, PY_SSIZE_T_MAX);
+    if (consts == NULL) {
+        p->error = WFERR_NOMEMORY;
+        return NULL;
+    }
+    wf.fp = NULL;
+    wf.readable = NULL;
+    wf.str = PyBytes_FromStringAndSize((char *)NULL, 50);
+    wf.refs = PyDict_New();
+    if (wf.str == NULL || wf.refs == NULL) {
+        Py_XDECREF(wf.str);
+        Py_XDECREF(wf.refs);
+        Py_DECREF(consts);
+        p->error = WFERR_NOMEMORY;
+        return NULL;
+    }
+    wf.ptr = PyBytes_AS_STRING((PyBytesObject *)wf.str);
+    wf.end = wf.ptr + PyBytes_Size(wf.str);
+    wf.error = WFERR_OK;
+    wf.depth = p->depth;
+    wf.version = p->version;
+    w_object(co->co_code, &wf);
+    w_object(consts, &wf);
+    w_object(co->co_names, &wf);
+    w_object(co->co_lnotab, &wf);
+    Py_DECREF(wf.refs);
+    Py_DECREF(consts);
+    if (wf.str == NULL && wf.error == WFERR_OK)
+        wf.error = WFERR_NOMEMORY;
+    if (wf.error != WFERR_OK) {
+        Py_XDECREF(wf.str);
+        p->error = wf.error;
+        return NULL;
+    }
+    base = PyBytes_AS_STRING((PyBytesObject *)wf.str);
+    if (_PyBytes_Resize(&wf.str, (Py_ssize_t)(wf.ptr - base)) < 0) {
+        p->error = WFERR_NOMEMORY;
+        return NULL;
+    }
+    return wf.str;
+}
+
 static void
 w_complex_object(PyObject *v, char flag, WFILE *p)
 {
@@ -507,6 +570,45 @@ w_complex_object(PyObject *v, char flag, WFILE *p)
             return;
         }
     }
+    else if (_PyLazyCode_Check(v)) {
+        /* Written as the code object it stands for */
+        PyObject *code = _PyLazyCode_Materialize(v);
+        if (code == NULL) {
+            p->error = WFERR_UNMARSHALLABLE;
+            return;
+        }
+        w_complex_object(code, flag, p);
+        Py_DECREF(code);
+    }
+    else if (PyCode_Check(v) && p->version >= 5 && p->depth > 1) {
+        PyCodeObject *co = (PyCodeObject *)v;
+        PyObject *body;
+        body = w_code_body(co, p);
+        if (body == NULL)
+            return;
+        W_TYPE(TYPE_LAZY_CODE, p);
+        w_long(co->co_argcount, p);
+        w_long(co->co_kwonlyargcount, p);
+        w_long(co->co_nlocals, p);
+        w_long(co->co_stacksize, p);
+        w_long(co->co_flags, p);
+        w_object(co->co_varnames, p);
+        w_object(co->co_freevars, p);
+        w_object(co->co_cellvars, p);
+        w_object(co->co_filename, p);
+        w_object(co->co_name, p);
+        w_long(co->co_firstlineno, p);
+        w_object(PyTuple_GET_SIZE(co->co_consts) ?
+                 PyTuple_GET_ITEM(co->co_consts, 0) : NULL, p);
+        n = PyBytes_GET_SIZE(body);
+        if (n > SIZE32_MAX) {
+            Py_DECREF(body);
+            p->error = WFERR_UNMARSHALLABLE;
+            return;
+        }
+        w_pstring(PyBytes_AS_STRING(body), n, p);
+        Py_DECREF(body);
+    }
     else if (PyCode_Check(v)) {
         PyCodeObject *co = (PyCodeObject *)v;
         W_TYPE(TYPE_CODE, p);
@@ -835,6 +937,164 @@ r_ref(PyObject *o, int flag, RFILE *p)
     return o;
 }
 
+static PyObject *r_object(RFILE *p);
+
+/* Read the file name of a code object, shared by all the code objects of a
+   module. */
+static PyObject *
+r_filename(RFILE *p)
+{
+    PyObject *filename = r_object(p);
+    if (filename != NULL && PyUnicode_CheckExact(filename)) {
+        if (p->current_filename != NULL) {
+            if (!PyUnicode_Compare(filename, p->current_filename)) {
+                Py_DECREF(filename);
+                Py_INCREF(p->current_filename);
+                filename = p->current_filename;
+            }
+        }
+        else {
+            p->current_filename = filename;
+        }
+    }
+    return filename;
+}
+
+/* The eval loop only expects the stub of a code object in co_consts to be
+   loaded to make a function from it, which turns it into the code object (see
+   PyFunction_NewWithQualName()).  This is all the compiler does with code
+   constants, but crafted bytecode may load them for any other use: replace
+   the stubs loaded that way with their code objects right away. */
+static int
+r_materialize_loaded_consts(PyObject *code, PyObject *consts)
+{
+    const unsigned char *s;
+    Py_ssize_t i, n, nconsts, arg, ext = 0;
+    int op;
+
+    /* PyCode_New() rejects anything else */
+    if (!PyBytes_Check(code) || !PyTuple_Check(consts))
+        return 0;
+    s = (const unsigned char *)PyBytes_AS_STRING(code);
+    n = PyBytes_GET_SIZE(code);
+    nconsts = PyTuple_GET_SIZE(consts);
+    for (i = 0; i < n; ) {
+        PyObject *v, *co;
+        op = s[i++];
+        arg = 0;
+        if (HAS_ARG(op)) {
+            if (i + 2 > n)
+                break;
+            arg = ext | s[i] | (s[i + 1] << 8);
+            i += 2;
+        }
+        if (op == EXTENDED_ARG) {
+            ext = arg << 16;
+            continue;
+        }
+        ext = 0;
+        if (op != LOAD_CONST || arg >= nconsts ||
+            !_PyLazyCode_Check(PyTuple_GET_ITEM(consts, arg)))
+            continue;
+        /* LOAD_CONST code; LOAD_CONST qualname; MAKE_FUNCTION/MAKE_CLOSURE */
+        if (i + 4 <= n && s[i] == LOAD_CONST &&
+            (s[i + 3] == MAKE_FUNCTION || s[i + 3] == MAKE_CLOSURE))
+            continue;
+        co = _PyLazyCode_Materialize(PyTuple_GET_ITEM(consts, arg));
+        if (co == NULL)
+            return -1;
+        v = PyTuple_GET_ITEM(consts, arg);
+        PyTuple_SET_ITEM(consts, arg, co);
+        Py_DECREF(v);
+    }
+    return 0;
+}
+
+/* Read the body of a TYPE_LAZY_CODE object (see w_code_body()).  lazy tells
+   how the bodies of the code objects it contains are read, as in RFILE. */
+static int
+r_code_body(const char *body, Py_ssize_t size, PyObject *const0,
+            PyObject *filename, int lazy, int depth,
+            PyObject **code, PyObject **consts, PyObject **names,
+            PyObject **lnotab)
+{
+    RFILE rf;
+    PyObject *rest = NULL;
+    Py_ssize_t i, n;
+
+    *code = *consts = *names = *lnotab = NULL;
+    rf.fp = NULL;
+    rf.readable = NULL;
+    rf.current_filename = filename;
+    rf.lazy = lazy;
+    rf.ptr = (char *)body;
+    rf.end = (char *)body + size;
+    rf.buf = NULL;
+    rf.depth = depth;
+    rf.refs = PyList_New(0);
+    if (rf.refs == NULL)
+        return -1;
+    *code = r_object(&rf);
+    if (*code == NULL)
+        goto error;
+    rest = r_object(&rf);
+    if (rest == NULL)
+        goto error;
+    *names = r_object(&rf);
+    if (*names == NULL)
+        goto error;
+    *lnotab = r_object(&rf);
+    if (*lnotab == NULL)
+        goto error;
+    if (!PyTuple_Check(rest))
+        goto error;
+    if (const0 == NULL) {
+        *consts = rest;
+        rest = NULL;
+    }
+    else {
+        n = PyTuple_GET_SIZE(rest);
+        *consts = PyTuple_New(n + 1);
+        if (*consts == NULL)
+            goto error;
+        Py_INCREF(const0);
+        PyTuple_SET_ITEM(*consts, 0, const0);
+        for (i = 0; i < n; i++) {
+            PyObject *v = PyTuple_GET_ITEM(rest, i);
+            Py_INCREF(v);
+            PyTuple_SET_ITEM(*consts, i + 1, v);
+        }
+        Py_DECREF(rest);
+    }
+    if (lazy != LAZY_OFF && r_materialize_loaded_consts(*code, *consts) < 0)
+        goto error;
+    Py_DECREF(rf.refs);
+    return 0;
+
+  error:
+    if (!PyErr_Occurred())
+        PyErr_SetString(PyExc_ValueError,
+                        "bad marshal data (invalid code object body)");
+    Py_DECREF(rf.refs);
+    Py_XDECREF(rest);
+    Py_CLEAR(*code);
+    Py_CLEAR(*consts);
+    Py_CLEAR(*names);
+    Py_CLEAR(*lnotab);
+    return -1;
+}
+
+int
+_PyMarshal_ReadCodeBody(const char *body, Py_ssize_t size, PyObject *const0,
+                        PyObject *filename, PyObject *owner,
+                        PyObject **code, PyObject **consts,
+                        PyObject **names, PyObject **lnotab)
+{
+    return r_code_body(body, size, const0, filename,
+                       owner == Py_None ? LAZY_STATIC : LAZY_COPY, 0,
+                       code, consts, names, lnotab);
+}
+
 static PyObject *
 r_object(RFILE *p)
 {
@@ -1293,21 +1553,9 @@ r_object(RFILE *p)
             cellvars = r_object(p);
             if (cellvars == NULL)
                 goto code_error;
-            filename = r_object(p);
+            filename = r_filename(p);
             if (filename == NULL)
                 goto code_error;
-            if (PyUnicode_CheckExact(filename)) {
-                if (p->current_filename != NULL) {
-                    if (!PyUnicode_Compare(filename, p->current_filename)) {
-                        Py_DECREF(filename);
-                        Py_INCREF(p->current_filename);
-                        filename = p->current_filename;
-                    }
-                }
-                else {
-                    p->current_filename = filename;
-                }
-            }
             name = r_object(p);
             if (name == NULL)
                 goto code_error;
@@ -1317,6 +1565,9 @@ r_object(RFILE *p)
             lnotab = r_object(p);
             if (lnotab == NULL)
                 goto code_error;
+            if (p->lazy != LAZY_OFF &&
+                r_materialize_loaded_consts(code, consts) < 0)
+                goto code_error;
 
             v = (PyObject *) PyCode_New(
                             argcount, kwonlyargcount,
@@ -1340,6 +1591,127 @@ r_object(RFILE *p)
         retval = v;
         break;
 
+    case TYPE_LAZY_CODE:
+        {
+            int argcount;
+            int kwonlyargcount;
+            int nlocals;
+            int stacksize;
+            int flags;
+            PyObject *varnames = NULL;
+            PyObject *freevars = NULL;
+            PyObject *cellvars = NULL;
+            PyObject *filename = NULL;
+            PyObject *name = NULL;
+            int firstlineno;
+            PyObject *const0 = NULL;
+            const char *body;
+
+            idx = r_ref_reserve(flag, p);
+            if (idx < 0)
+                break;
+
+            v = NULL;
+
+            argcount = (int)r_long(p);
+            if (PyErr_Occurred())
+                goto lazy_code_error;
+            kwonlyargcount = (int)r_long(p);
+            if (PyErr_Occurred())
+                goto lazy_code_error;
+            nlocals = (int)r_long(p);
+            if (PyErr_Occurred())
+                goto lazy_code_error;
+            stacksize = (int)r_long(p);
+            if (PyErr_Occurred())
+                goto lazy_code_error;
+            flags = (int)r_long(p);
+            if (PyErr_Occurred())
+                goto lazy_code_error;
+            varnames = r_object(p);
+            if (varnames == NULL)
+                goto lazy_code_error;
+            freevars = r_object(p);
+            if (freevars == NULL)
+                goto lazy_code_error;
+            cellvars = r_object(p);
+            if (cellvars == NULL)
+                goto lazy_code_error;
+            filename = r_filename(p);
+            if (filename == NULL)
+                goto lazy_code_error;
+            name = r_object(p);
+            if (name == NULL)
+                goto lazy_code_error;
+            firstlineno = (int)r_long(p);
+            if (firstlineno == -1 && PyErr_Occurred())
+                goto lazy_code_error;
+            /* NULL if the code object has no constants */
+            const0 = r_object(p);
+            if (PyErr_Occurred())
+                goto lazy_code_error;
+            n = r_long(p);
+            if (n < 0 || n > SIZE32_MAX) {
+                if (!PyErr_Occurred())
+                    PyErr_SetString(PyExc_ValueError,
+                        "bad marshal data (code body size out of range)");
+                goto lazy_code_error;
+            }
+            body = r_string(n, p);
+            if (body == NULL)
+                goto lazy_code_error;
+
+            if (p->lazy != LAZY_OFF) {
+                PyObject *owner;
+                /* Refer to a copy of the body rather than to the whole
+                   data, which is then freed along with the code objects
+                   that are unmarshalled right away. */
+                if (p->lazy == LAZY_STATIC) {
+                    owner = Py_None;
+                    Py_INCREF(owner);
+                }
+                else {
+                    owner = PyBytes_FromStringAndSize(body, n);
+                    if (owner == NULL)
+                        goto lazy_code_error;
+                    body = PyBytes_AS_STRING(owner);
+                }
+                v = _PyLazyCode_New(argcount, kwonlyargcount,
+                                    nlocals, stacksize, flags,
+                                    varnames, freevars, cellvars,
+                                    filename, name, firstlineno,
+                                    owner, body, n, const0);
+                Py_DECREF(owner);
+            }
+            else {
+                PyObject *code, *consts, *names, *lnotab;
+                if (r_code_body(body, n, const0, filename, LAZY_OFF, p->depth,
+                                &code, &consts, &names, &lnotab) < 0)
+                    goto lazy_code_error;
+                v = (PyObject *) PyCode_New(
+                                argcount, kwonlyargcount,
+                                nlocals, stacksize, flags,
+                                code, consts, names, varnames,
+                                freevars, cellvars, filename, name,
+                                firstlineno, lnotab);
+                Py_DECREF(code);
+                Py_DECREF(consts);
+                Py_DECREF(names);
+                Py_DECREF(lnotab);
+            }
+            v = r_ref_insert(v, idx, flag, p);
+
+          lazy_code_error:
+            Py_XDECREF(varnames);
+            Py_XDECREF(freevars);
+            Py_XDECREF(cellvars);
+            Py_XDECREF(filename);
+            Py_XDECREF(name);
+            Py_XDECREF(const0);
+        }
+        retval = v;
+        break;
+
     case TYPE_REF:
         n = r_long(p);
         if (n < 0 || n >= PyList_GET_SIZE(p->refs)) {
@@ -1391,6 +1763,7 @@ PyMarshal_ReadShortFromFile(FILE *fp)
     rf.readable = NULL;
     rf.fp = fp;
     rf.current_filename = NULL;
+    rf.lazy = LAZY_OFF;
     rf.end = rf.ptr = NULL;
     rf.buf = NULL;
     res = r_short(&rf);
@@ -1407,6 +1780,7 @@ PyMarshal_ReadLongFromFile(FILE *fp)
     rf.fp = fp;
     rf.readable = NULL;
     rf.current_filename = NULL;
+    rf.lazy = LAZY_OFF;
     rf.ptr = rf.end = NULL;
     rf.buf = NULL;
     res = r_long(&rf);
@@ -1469,6 +1843,7 @@ PyMarshal_ReadObjectFromFile(FILE *fp)
     rf.fp = fp;
     rf.readable = NULL;
     rf.current_filename = NULL;
+    rf.lazy = LAZY_OFF;
     rf.depth = 0;
     rf.ptr = rf.end = NULL;
     rf.buf = NULL;
@@ -1490,6 +1865,7 @@ PyMarshal_ReadObjectFromString(const char *str, Py_ssize_t len)
     rf.fp = NULL;
     rf.readable = NULL;
     rf.current_filename = NULL;
+    rf.lazy = LAZY_OFF;
     rf.ptr = (char *)str;
     rf.end = (char *)str + len;
     rf.buf = NULL;
@@ -1504,6 +1880,31 @@ PyMarshal_ReadObjectFromString(const char *str, Py_ssize_t len)
     return result;
 }
 
+/* Like PyMarshal_ReadObjectFromString(), but leave the bodies of the nested
+   code objects to be read on first use.  They are copied out of str, unless
+   is_static is true: str must then stay valid and unchanged forever. */
+PyObject *
+_PyMarshal_ReadLazyObjectFromString(const char *str, Py_ssize_t len,
+                                    int is_static)
+{
+    RFILE rf;
+    PyObject *result;
+    rf.fp = NULL;
+    rf.readable = NULL;
+    rf.current_filename = NULL;
+    rf.lazy = is_static ? LAZY_STATIC : LAZY_COPY;
+    rf.ptr = (char *)str;
+    rf.end = (char *)str + len;
+    rf.buf = NULL;
+    rf.depth = 0;
+    rf.refs = PyList_New(0);
+    if (rf.refs == NULL)
+        return NULL;
+    result = read_object(&rf);
+    Py_DECREF(rf.refs);
+    return result;
+}
+
 PyObject *
 PyMarshal_WriteObjectToString(PyObject *x, int version)
 {
@@ -1614,6 +2015,7 @@ marshal_load(PyObject *self, PyObject *f)
         rf.fp = NULL;
         rf.readable = f;
         rf.current_filename = NULL;
+        rf.lazy = LAZY_OFF;
         rf.ptr = rf.end = NULL;
         rf.buf = NULL;
         if ((rf.refs = PyList_New(0)) != NULL) {
@@ -1669,13 +2071,20 @@ marshal_loads(PyObject *self, PyObject *args)
     char *s;
     Py_ssize_t n;
     PyObject* result;
-    if (!PyArg_ParseTuple(args, "y*:loads", &p))
+    int lazy = 0;
+    if (!PyArg_ParseTuple(args, "y*|p:loads", &p, &lazy))
         return NULL;
     s = p.buf;
     n = p.len;
+    if (lazy) {
+        result = _PyMarshal_ReadLazyObjectFromString(s, n, 0);
+        PyBuffer_Release(&p);
+        return result;
+    }
     rf.fp = NULL;
     rf.readable = NULL;
     rf.current_filename = NULL;
+    rf.lazy = LAZY_OFF;
     rf.ptr = s;
     rf.end = s + n;
     rf.depth = 0;
@@ -1688,11 +2097,14 @@ marshal_loads(PyObject *self, PyObject *args)
 }
 
 PyDoc_STRVAR(loads_doc,
-"loads(bytes)\n\
+"loads(bytes[, lazy])\n\
 \n\
 Convert the bytes object to a value. If no valid value is found, raise\n\
 EOFError, ValueError or TypeError. Extra characters in the input are\n\
-ignored.");
+ignored.\n\
+\n\
+If lazy is true, the bodies of nested code objects are only converted\n\
+when first needed, and kept in a copy until then.");
 
 static PyMethodDef marshal_methods[] = {
     {"dump",            marshal_dump,   METH_VARARGS,   dump_doc},
@@ -1724,6 +2136,8 @@ version -- indicates the format that the module uses. Version 0 is the\n\
     historical format, version 1 shares interned strings and version 2\n\
     uses a binary format for floating point numbers.\n\
     Version 3 shares common object references (New in version 3.4).\n\
+    Version 5 writes the body of nested code objects so that loads() can\n\
+    read it lazily (New in version 3.5).\n\
 \n\
 Functions:\n\
 \n\
@@ -25,6 +25,12 @@ extern PyHash_FuncDef PyHash_Func;
 static PyHash_FuncDef PyHash_Func;
 #endif
 
+#if Py_HASH_ALGORITHM == Py_HASH_SIPHASH13
+/* strings up to this length are hashed without calling PyHash_Func.hash */
+#define Py_HASH_INLINE_MAX 16
+Py_LOCAL_INLINE(Py_hash_t) pysiphash13(const void *src, Py_ssize_t src_sz);
+#endif
+
 /* Count _Py_HashBytes() calls */
 #ifdef Py_HASH_STATS
 #define Py_HASH_STATS_MAX 32
@@ -183,6 +189,11 @@ _Py_HashBytes(const void *src, Py_ssize_t len)
     }
     else
 #endif /* Py_HASH_CUTOFF */
+#ifdef Py_HASH_INLINE_MAX
+    if (len <= Py_HASH_INLINE_MAX)
+        x = pysiphash13(src, len);
+    else
+#endif
         x = PyHash_Func.hash(src, len);
 
     if (x == -1)
@@ -284,7 +295,6 @@ static PyHash_FuncDef PyHash_Func = {fnv, "fnv", 8 * SIZEOF_PY_HASH_T,
 #endif /* Py_HASH_ALGORITHM == Py_HASH_FNV */
 
 
-#if Py_HASH_ALGORITHM == Py_HASH_SIPHASH24
 /* **************************************************************************
  <MIT License>
  Copyright (c) 2013  Marek Majkowski <marek@popcount.org>
@@ -360,19 +370,108 @@ typedef unsigned char PY_UINT8_T;
     d = ROTATE(d, t) ^ c;           \
     a = ROTATE(a, 32);
 
-#define DOUBLE_ROUND(v0,v1,v2,v3)       \
-    HALF_ROUND(v0,v1,v2,v3,13,16);      \
-    HALF_ROUND(v2,v1,v0,v3,17,21);      \
+#define SINGLE_ROUND(v0,v1,v2,v3)       \
     HALF_ROUND(v0,v1,v2,v3,13,16);      \
     HALF_ROUND(v2,v1,v0,v3,17,21);
 
+#define DOUBLE_ROUND(v0,v1,v2,v3)       \
+    SINGLE_ROUND(v0,v1,v2,v3);          \
+    SINGLE_ROUND(v0,v1,v2,v3);
+
+
+#if Py_HASH_ALGORITHM == Py_HASH_SIPHASH13
+/* the last src_sz (0 to 7) bytes of a message of length len, as a little
+   endian integer.  On little endian machines, they are read with at most
+   two loads, which may overlap each other or the previous block. */
+Py_LOCAL_INLINE(PY_UINT64_T)
+siphash_tail(const PY_UINT8_T *in, Py_ssize_t src_sz, Py_ssize_t len)
+{
+    PY_UINT64_T t = 0;
+    PY_UINT8_T *pt = (PY_UINT8_T *)&t;
+#if PY_LITTLE_ENDIAN
+    PY_UINT32_T lo, hi;
+
+    if (src_sz == 0)
+        return 0;
+    if (len >= 8) {
+        Py_MEMCPY(&t, in + src_sz - 8, sizeof(t));
+        return t >> (8 * (8 - src_sz));
+    }
+    if (src_sz >= 4) {
+        Py_MEMCPY(&lo, in, sizeof(lo));
+        Py_MEMCPY(&hi, in + src_sz - 4, sizeof(hi));
+        return lo | ((PY_UINT64_T)hi << (8 * (src_sz - 4)));
+    }
+#endif
+    switch (src_sz) {
+        case 7: pt[6] = in[6];
+        case 6: pt[5] = in[5];
+        case 5: pt[4] = in[4];
+        case 4: Py_MEMCPY(pt, in, sizeof(PY_UINT32_T)); break;
+        case 3: pt[2] = in[2];
+        case 2: pt[1] = in[1];
+        case 1: pt[0] = in[0];
+    }
+    return _le64toh(t);
+}
+
+Py_LOCAL_INLINE(PY_UINT64_T)
+siphash13(PY_UINT64_T k0, PY_UINT64_T k1, const void *src, Py_ssize_t src_sz) {
+    PY_UINT64_T b = (PY_UINT64_T)src_sz << 56;
+    const PY_UINT8_T *in = (PY_UINT8_T*)src;
+    Py_ssize_t len = src_sz;
+
+    PY_UINT64_T v0 = k0 ^ 0x736f6d6570736575ULL;
+    PY_UINT64_T v1 = k1 ^ 0x646f72616e646f6dULL;
+    PY_UINT64_T v2 = k0 ^ 0x6c7967656e657261ULL;
+    PY_UINT64_T v3 = k1 ^ 0x7465646279746573ULL;
+
+    while (src_sz >= 8) {
+        PY_UINT64_T mi;
+        Py_MEMCPY(&mi, in, sizeof(mi));
+        mi = _le64toh(mi);
+        in += sizeof(mi);
+        src_sz -= 8;
+        v3 ^= mi;
+        SINGLE_ROUND(v0,v1,v2,v3);
+        v0 ^= mi;
+    }
+
+    b |= siphash_tail(in, src_sz, len);
+
+    v3 ^= b;
+    SINGLE_ROUND(v0,v1,v2,v3);
+    v0 ^= b;
+    v2 ^= 0xff;
+    SINGLE_ROUND(v0,v1,v2,v3);
+    SINGLE_ROUND(v0,v1,v2,v3);
+    SINGLE_ROUND(v0,v1,v2,v3);
+
+    /* modified */
+    return (v0 ^ v1) ^ (v2 ^ v3);
+}
+
+Py_LOCAL_INLINE(Py_hash_t)
+pysiphash13(const void *src, Py_ssize_t src_sz) {
+    return (Py_hash_t)siphash13(_le64toh(_Py_HashSecret.siphash.k0),
+                                _le64toh(_Py_HashSecret.siphash.k1),
+                                src, src_sz);
+}
 
 static Py_hash_t
-siphash24(const void *src, Py_ssize_t src_sz) {
-    PY_UINT64_T k0 = _le64toh(_Py_HashSecret.siphash.k0);
-    PY_UINT64_T k1 = _le64toh(_Py_HashSecret.siphash.k1);
+pysiphash13_func(const void *src, Py_ssize_t src_sz) {
+    return pysiphash13(src, src_sz);
+}
+
+static PyHash_FuncDef PyHash_Func = {pysiphash13_func, "siphash13", 64, 128};
+
+#endif /* Py_HASH_ALGORITHM == Py_HASH_SIPHASH13 */
+
+
+static PY_UINT64_T
+siphash24(PY_UINT64_T k0, PY_UINT64_T k1, const void *src, Py_ssize_t src_sz) {
     PY_UINT64_T b = (PY_UINT64_T)src_sz << 56;
-    const PY_UINT64_T *in = (PY_UINT64_T*)src;
+    const PY_UINT8_T *in = (PY_UINT8_T*)src;
 
     PY_UINT64_T v0 = k0 ^ 0x736f6d6570736575ULL;
     PY_UINT64_T v1 = k1 ^ 0x646f72616e646f6dULL;
@@ -384,8 +483,10 @@ siphash24(const void *src, Py_ssize_t src_sz) {
     PY_UINT8_T *m;
 
     while (src_sz >= 8) {
-        PY_UINT64_T mi = _le64toh(*in);
-        in += 1;
+        PY_UINT64_T mi;
+        Py_MEMCPY(&mi, in, sizeof(mi));
+        mi = _le64toh(mi);
+        in += sizeof(mi);
         src_sz -= 8;
         v3 ^= mi;
         DOUBLE_ROUND(v0,v1,v2,v3);
@@ -415,10 +516,24 @@ siphash24(const void *src, Py_ssize_t src_sz) {
 
     /* modified */
     t = (v0 ^ v1) ^ (v2 ^ v3);
-    return (Py_hash_t)t;
+    return t;
+}
+
+PY_UINT64_T
+_Py_KeyedHash(PY_UINT64_T key, const void *src, Py_ssize_t src_sz)
+{
+    return siphash24(key, 0, src, src_sz);
+}
+
+#if Py_HASH_ALGORITHM == Py_HASH_SIPHASH24
+static Py_hash_t
+pysiphash(const void *src, Py_ssize_t src_sz) {
+    return (Py_hash_t)siphash24(_le64toh(_Py_HashSecret.siphash.k0),
+                                _le64toh(_Py_HashSecret.siphash.k1),
+                                src, src_sz);
 }
 
-static PyHash_FuncDef PyHash_Func = {siphash24, "siphash24", 64, 128};
+static PyHash_FuncDef PyHash_Func = {pysiphash, "siphash24", 64, 128};
 
 #endif /* Py_HASH_ALGORITHM == Py_HASH_SIPHASH24 */
 
@@ -985,7 +985,8 @@ run_pyc_file(FILE *fp, const char *filename, PyObject *globals,
                    "Bad magic number in .pyc file");
         return NULL;
     }
-    /* Skip mtime and size */
+    /* Skip the flags and the mtime and size, or the source hash */
+    (void) PyMarshal_ReadLongFromFile(fp);
     (void) PyMarshal_ReadLongFromFile(fp);
     (void) PyMarshal_ReadLongFromFile(fp);
     v = PyMarshal_ReadLastObjectFromFile(fp);
@@ -1095,10 +1096,18 @@ PyParser_ASTFromStringObject(const char *s, PyObject *filename, int start,
     PyCompilerFlags localflags;
     perrdetail err;
     int iflags = PARSER_FLAGS(flags);
+    node *n;
+    /* The concrete syntax tree only lives until it has been converted,
+       so build it in an arena which is released in one go. */
+    node_arena *node_arena = _PyNodeArena_New();
 
-    node *n = PyParser_ParseStringObject(s, filename,
-                                         &_PyParser_Grammar, start, &err,
-                                         &iflags);
+    if (node_arena == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    n = _PyParser_ParseStringObjectInArena(s, filename,
+                                           &_PyParser_Grammar, start, &err,
+                                           &iflags, node_arena);
     if (flags == NULL) {
         localflags.cf_flags = 0;
         flags = &localflags;
@@ -1106,12 +1115,12 @@ PyParser_ASTFromStringObject(const char *s, PyObject *filename, int start,
     if (n) {
         flags->cf_flags |= iflags & PyCF_MASK;
         mod = PyAST_FromNodeObject(n, flags, filename, arena);
-        PyNode_Free(n);
     }
     else {
         err_input(&err);
         mod = NULL;
     }
+    _PyNodeArena_Free(node_arena);
     err_free(&err);
     return mod;
 }
@@ -1140,10 +1149,17 @@ PyParser_ASTFromFileObject(FILE *fp, PyObject *filename, const char* enc,
     PyCompilerFlags localflags;
     perrdetail err;
     int iflags = PARSER_FLAGS(flags);
+    node *n;
+    node_arena *node_arena = _PyNodeArena_New();
 
-    node *n = PyParser_ParseFileObject(fp, filename, enc,
-                                       &_PyParser_Grammar,
-                                       start, ps1, ps2, &err, &iflags);
+    if (node_arena == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    n = _PyParser_ParseFileObjectInArena(fp, filename, enc,
+                                         &_PyParser_Grammar,
+                                         start, ps1, ps2, &err, &iflags,
+                                         node_arena);
     if (flags == NULL) {
         localflags.cf_flags = 0;
         flags = &localflags;
@@ -1151,7 +1167,6 @@ PyParser_ASTFromFileObject(FILE *fp, PyObject *filename, const char* enc,
     if (n) {
         flags->cf_flags |= iflags & PyCF_MASK;
         mod = PyAST_FromNodeObject(n, flags, filename, arena);
-        PyNode_Free(n);
     }
     else {
         err_input(&err);
@@ -1159,6 +1174,7 @@ PyParser_ASTFromFileObject(FILE *fp, PyObject *filename, const char* enc,
             *errcode = err.error;
         mod = NULL;
     }
+    _PyNodeArena_Free(node_arena);
     err_free(&err);
     return mod;
 }
@@ -0,0 +1,158 @@
+"""Micro-benchmarks for the asyncio Future, Task and Handle machinery.
+
+Compare the C accelerated classes from the _asyncio module with the pure
+Python implementation:
+
+    ./python Tools/asynciobench/asynciobench.py
+    ./python Tools/asynciobench/asynciobench.py --impl python
+"""
+
+import argparse
+import time
+
+import asyncio
+from asyncio import events
+from asyncio import futures
+from asyncio import tasks
+
+
+def use_python_implementation():
+    futures.Future = asyncio.Future = futures._PyFuture
+    tasks.Task = asyncio.Task = tasks._PyTask
+    events.Handle = asyncio.Handle = events._PyHandle
+    events.TimerHandle = asyncio.TimerHandle = events._PyTimerHandle
+
+
+@asyncio.coroutine
+def ping_pong(loop, rounds):
+    """Two tasks bouncing a value through futures."""
+    @asyncio.coroutine
+    def player(inbox, outbox, n):
+        for i in range(n):
+            fut = inbox[0] = asyncio.Future(loop=loop)
+            value = yield from fut
+            if not outbox[0].done():
+                outbox[0].set_result(value + 1)
+
+    a = [None]
+    b = [None]
+    a[0] = asyncio.Future(loop=loop)
+    b[0] = asyncio.Future(loop=loop)
+    t1 = asyncio.Task(player(a, b, rounds), loop=loop)
+    t2 = asyncio.Task(player(b, a, rounds), loop=loop)
+    # Let both players wait on their first future, then serve.
+    yield
+    b[0].set_result(0)
+    yield from asyncio.wait([t1, t2], loop=loop)
+
+
+@asyncio.coroutine
+def many_small_tasks(loop, count):
+    """Spawn lots of trivial tasks and gather them."""
+    @asyncio.coroutine
+    def small(i):
+        yield
+        return i
+
+    yield from asyncio.gather(*[asyncio.Task(small(i), loop=loop)
+                                for i in range(count)], loop=loop)
+
+
+@asyncio.coroutine
+def future_callbacks(loop, count):
+    """Create futures, add callbacks, resolve them and yield from them."""
+    for i in range(count):
+        fut = asyncio.Future(loop=loop)
+        fut.add_done_callback(lambda f: None)
+        fut.set_result(i)
+        yield from fut
+
+
+@asyncio.coroutine
+def call_soon(loop, count):
+    """Run batches of callbacks scheduled with call_soon()."""
+    fut = asyncio.Future(loop=loop)
+    remaining = [count]
+
+    def callback():
+        remaining[0] -= 1
+        if not remaining[0]:
+            fut.set_result(None)
+
+    for i in range(count):
+        loop.call_soon(callback)
+    yield from fut
+
+
+@asyncio.coroutine
+def call_later(loop, count):
+    """Schedule timers, cancel half of them and run the others."""
+    fut = asyncio.Future(loop=loop)
+    remaining = [count // 2]
+
+    def callback():
+        remaining[0] -= 1
+        if not remaining[0]:
+            fut.set_result(None)
+
+    for i in range(count):
+        handle = loop.call_later(i * 1e-7, callback)
+        if i % 2:
+            handle.cancel()
+    yield from fut
+
+
+BENCHMARKS = [
+    ('ping_pong', ping_pong, 20000),
+    ('many_small_tasks', many_small_tasks, 20000),
+    ('future_callbacks', future_callbacks, 50000),
+    ('call_soon', call_soon, 100000),
+    ('call_later', call_later, 50000),
+]
+
+
+def run(name, func, n, repeat):
+    best = None
+    for i in range(repeat):
+        loop = asyncio.new_event_loop()
+        try:
+            t0 = time.perf_counter()
+            loop.run_until_complete(func(loop, n))
+            dt = time.perf_counter() - t0
+        finally:
+            loop.close()
+        if best is None or dt < best:
+            best = dt
+    print('%-20s %8d ops  %8.1f ms  %8.2f us/op'
+          % (name, n, best * 1e3, best * 1e6 / n))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--impl', choices=('c', 'python'), default='c',
+                        help='Future/Task/Handle implementation to benchmark '
+                             '(default: c)')
+    parser.add_argument('-r', '--repeat', type=int, default=5,
+                        help='number of repetitions, the best time is '
+                             'reported (default: 5)')
+    parser.add_argument('benchmarks', nargs='*',
+                        help='names of the benchmarks to run (default: all)')
+    args = parser.parse_args()
+
+    if args.impl == 'python':
+        use_python_implementation()
+    elif not hasattr(futures, '_CFuture'):
+        parser.error('the _asyncio accelerator module is not available')
+    print('Future: %s.%s, Task: %s.%s, Handle: %s.%s'
+          % (asyncio.Future.__module__, asyncio.Future.__name__,
+             asyncio.Task.__module__, asyncio.Task.__name__,
+             asyncio.Handle.__module__, asyncio.Handle.__name__))
+
+    for name, func, n in BENCHMARKS:
+        if args.benchmarks and name not in args.benchmarks:
+            continue
+        run(name, func, n, args.repeat)
+
+
+if __name__ == '__main__':
+    main()
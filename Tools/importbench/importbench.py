@@ -5,7 +5,6 @@ thus has no external changes made to import-related attributes in sys.
 
 """
 from test.test_importlib import util
-from test.test_importlib.source import util as source_util
 import decimal
 import imp
 import importlib
@@ -13,6 +12,7 @@ import importlib.machinery
 import json
 import os
 import py_compile
+import subprocess
 import sys
 import tabnanny
 import timeit
@@ -22,7 +22,13 @@ def bench(name, cleanup=lambda: None, *, seconds=1, repeat=3):
     """Bench the given statement as many times as necessary until total
     executions take one second."""
     stmt = "__import__({!r})".format(name)
-    timer = timeit.Timer(stmt)
+    yield from bench_timer(timeit.Timer(stmt), cleanup, seconds=seconds,
+                           repeat=repeat)
+
+
+def bench_timer(timer, cleanup=lambda: None, *, seconds=1, repeat=3):
+    """Run the given timer as many times as necessary until total executions
+    take one second."""
     for x in range(repeat):
         total_time = 0
         count = 0
@@ -38,6 +44,26 @@ def bench(name, cleanup=lambda: None, *, seconds=1, repeat=3):
                 count -= 1
         yield count // seconds
 
+def startup(seconds, repeat):
+    """Interpreter startup"""
+    # Mostly spent importing the modules which configure --with-frozen-stdlib
+    # freezes into the interpreter.
+    args = [sys.executable, '-I', '-c', 'pass']
+    timer = timeit.Timer(lambda: subprocess.check_call(args))
+    yield from bench_timer(timer, repeat=repeat, seconds=seconds)
+
+
+def startup_module(seconds, repeat):
+    """Startup module: stat"""
+    name = 'stat'
+    module = sys.modules.pop(name)
+    try:
+        yield from bench(name, lambda: sys.modules.pop(name), repeat=repeat,
+                         seconds=seconds)
+    finally:
+        sys.modules[name] = module
+
+
 def from_cache(seconds, repeat):
     """sys.modules"""
     name = '<benchmark import>'
@@ -65,7 +91,7 @@ def source_wo_bytecode(seconds, repeat):
     try:
         name = '__importlib_test_benchmark__'
         # Clears out sys.modules and puts an entry at the front of sys.path.
-        with source_util.create_modules(name) as mapping:
+        with util.create_modules(name) as mapping:
             assert not os.path.exists(imp.cache_from_source(mapping[name]))
             sys.meta_path.append(importlib.machinery.PathFinder)
             loader = (importlib.machinery.SourceFileLoader,
@@ -102,7 +128,7 @@ def source_writing_bytecode(seconds, repeat):
     """Source writing bytecode: small"""
     assert not sys.dont_write_bytecode
     name = '__importlib_test_benchmark__'
-    with source_util.create_modules(name) as mapping:
+    with util.create_modules(name) as mapping:
         sys.meta_path.append(importlib.machinery.PathFinder)
         loader = (importlib.machinery.SourceFileLoader,
                   importlib.machinery.SOURCE_SUFFIXES, True)
@@ -136,7 +162,7 @@ decimal_writing_bytecode = _writing_bytecode(decimal)
 def source_using_bytecode(seconds, repeat):
     """Source w/ bytecode: small"""
     name = '__importlib_test_benchmark__'
-    with source_util.create_modules(name) as mapping:
+    with util.create_modules(name) as mapping:
         sys.meta_path.append(importlib.machinery.PathFinder)
         loader = (importlib.machinery.SourceFileLoader,
                 importlib.machinery.SOURCE_SUFFIXES, True)
@@ -163,6 +189,26 @@ tabnanny_using_bytecode = _using_bytecode(tabnanny)
 decimal_using_bytecode = _using_bytecode(decimal)
 
 
+def path_search(seconds, repeat):
+    """Path search: 500 modules"""
+    # A fresh finder, as in a new interpreter, searching a directory holding
+    # many modules.  The directory is older than its index, so the index is
+    # written and then used.
+    names = ['__importlib_test_benchmark_{}__'.format(i) for i in range(500)]
+    with util.create_modules(*names) as mapping:
+        root = mapping['.root']
+        os.mkdir(os.path.join(root, '__pycache__'))
+        mtime = os.stat(root).st_mtime - 60
+        os.utime(root, (mtime, mtime))
+        loader = (importlib.machinery.SourceFileLoader,
+                  importlib.machinery.SOURCE_SUFFIXES)
+        def search():
+            finder = importlib.machinery.FileFinder(root, loader)
+            assert finder.find_spec(names[-1]) is not None
+        yield from bench_timer(timeit.Timer(search), repeat=repeat,
+                               seconds=seconds)
+
+
 def main(import_, options):
     if options.source_file:
         with options.source_file:
@@ -170,13 +216,14 @@ def main(import_, options):
     else:
         prev_results = {}
     __builtins__.__import__ = import_
-    benchmarks = (from_cache, builtin_mod,
+    benchmarks = (startup, startup_module, from_cache, builtin_mod,
                   source_writing_bytecode,
                   source_wo_bytecode, source_using_bytecode,
                   tabnanny_writing_bytecode,
                   tabnanny_wo_bytecode, tabnanny_using_bytecode,
                   decimal_writing_bytecode,
                   decimal_wo_bytecode, decimal_using_bytecode,
+                  path_search,
                 )
     if options.benchmark:
         for b in benchmarks:
@@ -0,0 +1,97 @@
+"""Benchmarks for JSON encoding of large API-style payloads.
+
+Compare json.dumps() with json.dumps_bytes() and with the pure Python
+encoder:
+
+    ./python Tools/jsonbench/jsonbench.py
+    ./python Tools/jsonbench/jsonbench.py --impl python
+"""
+
+import argparse
+import random
+import time
+
+from test import support
+
+
+def make_payload(count, seed=0):
+    """A list of records shaped like a typical REST API response."""
+    rnd = random.Random(seed)
+    words = ['alpha', 'beta', 'gamma', 'delta', 'caf\xe9', '€ uro',
+             'line\nbreak', 'quote"d', '日本']
+    records = []
+    for i in range(count):
+        records.append({
+            'id': i,
+            'uuid': '%032x' % rnd.getrandbits(128),
+            'name': ' '.join(rnd.choice(words) for j in range(3)),
+            'active': bool(i % 3),
+            'score': rnd.random() * 1000,
+            'balance': rnd.randint(-10**6, 10**6),
+            'tags': [rnd.choice(words) for j in range(rnd.randint(0, 5))],
+            'parent': None if i % 7 else i // 7,
+            'location': {'lat': rnd.uniform(-90, 90),
+                         'lon': rnd.uniform(-180, 180)},
+        })
+    return {'count': count, 'next': None, 'results': records}
+
+
+BENCHMARKS = [
+    ('dumps', lambda json, obj: json.dumps(obj)),
+    ('dumps_bytes', lambda json, obj: json.dumps_bytes(obj)),
+    ('dumps(ensure_ascii=False).encode',
+     lambda json, obj: json.dumps(obj, ensure_ascii=False).encode('utf-8')),
+    ('dumps_bytes(ensure_ascii=False)',
+     lambda json, obj: json.dumps_bytes(obj, ensure_ascii=False)),
+    ('dumps(indent=2, sort_keys=True)',
+     lambda json, obj: json.dumps(obj, indent=2, sort_keys=True)),
+    ('dumps_bytes(indent=2, sort_keys=True)',
+     lambda json, obj: json.dumps_bytes(obj, indent=2, sort_keys=True)),
+]
+
+
+def run(name, func, json, obj, repeat):
+    best = None
+    for i in range(repeat):
+        t0 = time.perf_counter()
+        data = func(json, obj)
+        dt = time.perf_counter() - t0
+        if best is None or dt < best:
+            best = dt
+    print('%-40s %8.1f ms  %8.1f MB/s'
+          % (name, best * 1e3, len(data) / best / 1e6))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--impl', choices=('c', 'python'), default='c',
+                        help='encoder implementation to benchmark '
+                             '(default: c)')
+    parser.add_argument('-n', '--records', type=int, default=20000,
+                        help='number of records in the payload '
+                             '(default: 20000)')
+    parser.add_argument('-r', '--repeat', type=int, default=5,
+                        help='number of repetitions, the best time is '
+                             'reported (default: 5)')
+    parser.add_argument('benchmarks', nargs='*',
+                        help='names of the benchmarks to run (default: all)')
+    args = parser.parse_args()
+
+    if args.impl == 'python':
+        json = support.import_fresh_module('json', blocked=['_json'])
+    else:
+        json = support.import_fresh_module('json', fresh=['_json'])
+        if json.encoder.c_make_encoder is None:
+            parser.error('the _json accelerator module is not available')
+    obj = make_payload(args.records)
+    print('payload: %d records, %d bytes'
+          % (args.records, len(json.dumps_bytes(obj))))
+
+    for name, func in BENCHMARKS:
+        if args.benchmarks and name not in args.benchmarks:
+            continue
+        run(name, func, json, obj, args.repeat)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,139 @@
+"""Benchmarks for pickling and unpickling representative object graphs.
+
+Most of the graphs are large collections of small objects, for which the
+cost of the memo dominates.  Compare the C accelerated pickler with the
+pure Python implementation, or run the script with two builds of Python
+to compare their pickle modules:
+
+    ./python Tools/picklebench/picklebench.py
+    ./python Tools/picklebench/picklebench.py --impl python -n 10000
+    ./python Tools/picklebench/picklebench.py --protocol 2 records
+    ./python Tools/picklebench/picklebench.py --workers 4 records tuples
+"""
+
+import argparse
+import random
+import time
+
+from test import support
+
+
+class Point:
+
+    def __init__(self, x, y, label):
+        self.x = x
+        self.y = y
+        self.label = label
+
+    def __eq__(self, other):
+        return self.__dict__ == other.__dict__
+
+
+def make_strings(n, rnd):
+    """Distinct short strings, as in a list of identifiers."""
+    return ['item_%d' % i for i in range(n)]
+
+def make_records(n, rnd):
+    """A list of dicts sharing the same keys, like rows of a query."""
+    return [{'id': i, 'name': 'user%d' % i, 'email': 'user%d@example.org' % i,
+             'active': bool(i % 3), 'score': rnd.random(),
+             'tags': ['a', 'b'] if i % 2 else []}
+            for i in range(n)]
+
+def make_tuples(n, rnd):
+    """A list of small tuples mixing numbers and strings."""
+    return [(i, i * 0.5, str(i), (i, -i)) for i in range(n)]
+
+def make_tree(n, rnd):
+    """A nested tree of small lists."""
+    def build(size):
+        if size <= 4:
+            return list(range(size))
+        return [build(size // 4) for i in range(4)]
+    return build(n * 4)
+
+def make_instances(n, rnd):
+    """Instances of a user class with a small __dict__."""
+    return [Point(rnd.random(), rnd.random(), 'p%d' % (i % 100))
+            for i in range(n)]
+
+def make_shared(n, rnd):
+    """Many references to a small set of objects: memo lookups hit."""
+    pool = [('shared', i, [i]) for i in range(100)]
+    return [rnd.choice(pool) for i in range(n)]
+
+def make_chars(n, rnd):
+    """Single-character strings, e.g. a string split into a list."""
+    return list(''.join(rnd.choice('abcdefghij \xe9') for i in range(n)))
+
+
+GRAPHS = [
+    ('strings', make_strings),
+    ('records', make_records),
+    ('tuples', make_tuples),
+    ('tree', make_tree),
+    ('instances', make_instances),
+    ('shared', make_shared),
+    ('chars', make_chars),
+]
+
+
+def best_time(func, arg, repeat):
+    best = None
+    for i in range(repeat):
+        t0 = time.perf_counter()
+        result = func(arg)
+        dt = time.perf_counter() - t0
+        if best is None or dt < best:
+            best = dt
+    return best, result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--impl', choices=('c', 'python'), default='c',
+                        help='pickle implementation to benchmark '
+                             '(default: c)')
+    parser.add_argument('-p', '--protocol', type=int, default=None,
+                        help='pickle protocol (default: highest)')
+    parser.add_argument('-n', '--objects', type=int, default=100000,
+                        help='number of objects in each graph '
+                             '(default: 100000)')
+    parser.add_argument('-r', '--repeat', type=int, default=5,
+                        help='number of repetitions, the best time is '
+                             'reported (default: 5)')
+    parser.add_argument('-w', '--workers', type=int, default=None,
+                        help='number of threads pickling the items of the '
+                             'graphs (default: 1)')
+    parser.add_argument('graphs', nargs='*',
+                        help='names of the graphs to benchmark '
+                             '(default: all)')
+    args = parser.parse_args()
+
+    if args.impl == 'python':
+        pickle = support.import_fresh_module('pickle', blocked=['_pickle'])
+        dumps, loads = pickle._dumps, pickle._loads
+    else:
+        pickle = support.import_fresh_module('pickle', fresh=['_pickle'])
+        if pickle.Pickler is pickle._Pickler:
+            parser.error('the _pickle accelerator module is not available')
+        dumps, loads = pickle.dumps, pickle.loads
+    protocol = args.protocol
+    if protocol is None:
+        protocol = pickle.HIGHEST_PROTOCOL
+
+    print('%-12s %10s %10s %10s' % ('graph', 'bytes', 'dumps ms', 'loads ms'))
+    for name, make in GRAPHS:
+        if args.graphs and name not in args.graphs:
+            continue
+        obj = make(args.objects, random.Random(0))
+        dump = lambda o: dumps(o, protocol, workers=args.workers)
+        dump_time, data = best_time(dump, obj, args.repeat)
+        load_time, new = best_time(loads, data, args.repeat)
+        assert new == obj, name
+        print('%-12s %10d %10.1f %10.1f'
+              % (name, len(data), dump_time * 1e3, load_time * 1e3))
+
+
+if __name__ == '__main__':
+    main()
@@ -218,6 +218,16 @@ def find_test_slow_match_100_characters_bis(STR):
     for x in _RANGE_100:
         s1_find(s2)
 
+@bench('s="A"*1000; ("A"*100000).find(s+"B"+s)',
+       "no match, periodic 2001 characters", 10)
+def find_test_no_match_periodic_2001_characters(STR):
+    s = STR("A"*1000)
+    s1 = STR("A"*100000)
+    s2 = s+STR("B")+s
+    s1_find = s1.find
+    for x in _RANGE_10:
+        s1_find(s2)
+
 
 #### Same tests for 'rfind'
 
@@ -1390,6 +1400,69 @@ def upper_conversion_dense(STR):
         s_upper()
 
 
+#### Benchmark decoding
+
+# Text which is mostly, but not entirely, ASCII
+_mostly_ascii = "Where in the world is Carmen San Diego? " * 20
+
+def get_utf8_data(STR, extra):
+    if STR is BYTES:
+        raise UnsupportedType
+    return (_mostly_ascii + extra).encode("utf-8") * 10
+
+@bench('(("Where in the world is Carmen San Diego? "*20)*10).encode("utf-8")'
+       '.decode("utf-8")', "decode UTF-8 -- ascii", 1000)
+def decode_utf8_ascii(STR):
+    s = get_utf8_data(STR, "")
+    s_decode = s.decode
+    for x in _RANGE_1000:
+        s_decode("utf-8")
+
+@bench('(("Where in the world is Carmen San Diego? "*20+"\\xe9")*10)'
+       '.encode("utf-8").decode("utf-8")', "decode UTF-8 -- latin-1", 1000)
+def decode_utf8_latin1(STR):
+    s = get_utf8_data(STR, "\xe9")
+    s_decode = s.decode
+    for x in _RANGE_1000:
+        s_decode("utf-8")
+
+@bench('(("Where in the world is Carmen San Diego? "*20+"\\u20ac")*10)'
+       '.encode("utf-8").decode("utf-8")', "decode UTF-8 -- BMP", 1000)
+def decode_utf8_bmp(STR):
+    s = get_utf8_data(STR, "\u20ac")
+    s_decode = s.decode
+    for x in _RANGE_1000:
+        s_decode("utf-8")
+
+@bench('(("Where in the world is Carmen San Diego? "*20+"\\U0001f600")*10)'
+       '.encode("utf-8").decode("utf-8")', "decode UTF-8 -- astral", 1000)
+def decode_utf8_astral(STR):
+    s = get_utf8_data(STR, "\U0001f600")
+    s_decode = s.decode
+    for x in _RANGE_1000:
+        s_decode("utf-8")
+
+@bench('(("Where in the world is Carmen San Diego? "*20)*10+"\\xe9")'
+       '.encode("latin-1").decode("latin-1")', "decode latin-1", 1000)
+def decode_latin1(STR):
+    if STR is BYTES:
+        raise UnsupportedType
+    s = (_mostly_ascii * 10 + "\xe9").encode("latin-1")
+    s_decode = s.decode
+    for x in _RANGE_1000:
+        s_decode("latin-1")
+
+@bench('("Where in the world is Carmen San Diego? "*200)+"\\u20ac"',
+       "concat widening to UCS-2", 1000)
+def concat_widening_ucs2(STR):
+    if STR is BYTES:
+        raise UnsupportedType
+    s1 = _mostly_ascii * 10
+    s2 = "\u20ac"
+    for x in _RANGE_1000:
+        s1 + s2
+
+
 # end of benchmarks
 
 #################